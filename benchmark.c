@@ -8,6 +8,10 @@
  * - Long-lived connections vs reconnect overhead
  * - Mixed read/write workloads
  * - Object size variations (1KB - 10MB)
+ *
+ * "benchmark load" instead runs an open-loop load generator with Zipf,
+ * uniform or hot-set keys, a configurable op mix and per-tier latency
+ * percentiles (see the Load Generator section).
  * 
  * Limits:
  * - Memory: 1GB backend
@@ -29,6 +33,8 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <stdatomic.h>
+#include <math.h>
+#include <signal.h>
 
 #include "lib/protocol/protocol.h"
 
@@ -67,6 +73,12 @@ typedef struct {
 
 static stats_t g_stats;
 
+/* Server socket, overridable in load mode */
+static const char *g_socket_path = SOCKET_PATH;
+
+/* Load mode: ask for the shared-memory ring (-R) */
+static uint16_t g_load_caps = 0;
+
 /* Test control */
 static atomic_bool g_stop_test = false;
 
@@ -142,7 +154,7 @@ static int connect_to_server(void) {
     
     struct sockaddr_un addr = {0};
     addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
+    strncpy(addr.sun_path, g_socket_path, sizeof(addr.sun_path) - 1);
     
     if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
         close(sock);
@@ -305,14 +317,15 @@ static int do_get_operation(objm_connection_t *conn, const char *uri,
     resp->fd = -1;  /* Prevent objm_response_free from closing our FD */
     objm_response_free(resp);
     
-    /* Read data */
+    /* Read data (pread: GET FDs share their offset with the server's cache) */
     size_t total_read = 0;
     while (total_read < buffer_size) {
-        ssize_t n = read(fd, buffer + total_read, buffer_size - total_read);
+        ssize_t n = pread(fd, buffer + total_read, buffer_size - total_read,
+                          total_read);
         if (n < 0) {
             static int printed_read_errno = 0;
             if (!printed_read_errno) {
-                fprintf(stderr, "read() failed: %s (errno=%d, fd=%d)\n",
+                fprintf(stderr, "pread() failed: %s (errno=%d, fd=%d)\n",
                         strerror(errno), errno, fd);
                 printed_read_errno = 1;
             }
@@ -544,11 +557,840 @@ static void cleanup_benchmark_objects(void) {
     disconnect_from_server(sock, conn);
 }
 
+/* ============================================================================
+ * Load Generator
+ *
+ * "benchmark load" drives the server the way a production fleet does rather
+ * than as fast as possible: every connection issues requests on a fixed
+ * schedule (open loop), so a server stall shows up as queueing delay instead
+ * of silently lowering the offered load. Latency is measured from the time a
+ * request was *due*, not from when it was actually sent, which avoids
+ * coordinated omission. Keys follow a configurable popularity distribution
+ * and a fraction of them is placed in the memory tier so the two backends
+ * can be compared under the same workload.
+ * ============================================================================ */
+
+#define LOAD_DEFAULT_THREADS   4
+#define LOAD_DEFAULT_RATE      1000     /* ops/sec, all connections combined */
+#define LOAD_DEFAULT_DURATION  10       /* seconds */
+#define LOAD_DEFAULT_KEYS      10000
+#define LOAD_DEFAULT_SIZE      4096
+#define LOAD_DEFAULT_MEM_PCT   20
+#define LOAD_URI_MAX           64
+
+/* Prime multiplier used to scatter popularity ranks over the key space;
+ * larger than any 32-bit key count, hence coprime to all of them */
+#define LOAD_SCRAMBLE_PRIME    2654435761ULL
+
+/*
+ * Log-linear latency histogram (HdrHistogram layout). Values below
+ * HIST_SUB are recorded exactly; above that each power of two is split into
+ * HIST_SUB linear buckets, bounding the relative error at 1/HIST_SUB
+ * (< 1%) over the full 64-bit range.
+ */
+#define HIST_SUB_BITS  7
+#define HIST_SUB       (1u << HIST_SUB_BITS)
+#define HIST_BUCKETS   ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+typedef struct {
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+} histogram_t;
+
+typedef enum {
+    LOAD_OP_GET = 0,
+    LOAD_OP_PUT,
+    LOAD_OP_DEL,
+    LOAD_NUM_OPS
+} load_op_t;
+
+typedef enum {
+    LOAD_TIER_MEMORY = 0,
+    LOAD_TIER_PERSISTENT,
+    LOAD_NUM_TIERS
+} load_tier_t;
+
+static const char *LOAD_OP_NAMES[LOAD_NUM_OPS] = {"get", "put", "del"};
+static const char *LOAD_TIER_NAMES[LOAD_NUM_TIERS] = {"memory", "persistent"};
+
+typedef enum {
+    DIST_UNIFORM = 0,
+    DIST_ZIPF,
+    DIST_HOTSET
+} load_dist_t;
+
+typedef struct {
+    int threads;
+    double rate;              /* 0 = closed loop */
+    int duration;
+    uint32_t keys;
+    size_t object_size;
+    int mix[LOAD_NUM_OPS];    /* Relative weights */
+    int mix_total;
+    int mem_pct;              /* Keys placed in the memory tier */
+    bool preload;
+    bool json;
+
+    load_dist_t dist;
+    double zipf_theta;
+    double hot_frac;          /* Fraction of keys in the hot set */
+    double hot_prob;          /* Probability an access targets the hot set */
+    char dist_name[64];
+
+    /* Zipf constants (Gray et al., as used by YCSB) */
+    double zipf_zetan;
+    double zipf_alpha;
+    double zipf_eta;
+} load_config_t;
+
+typedef struct {
+    histogram_t hist[LOAD_NUM_OPS][LOAD_NUM_TIERS];
+    uint64_t misses[LOAD_NUM_OPS][LOAD_NUM_TIERS];
+    uint64_t errors[LOAD_NUM_OPS][LOAD_NUM_TIERS];
+    uint64_t late;            /* Requests sent after their scheduled time */
+} load_stats_t;
+
+typedef struct {
+    const load_config_t *cfg;
+    int index;
+    uint64_t seed;
+    uint64_t start_ns;        /* Common schedule origin */
+    uint64_t end_ns;
+    load_stats_t stats;
+    uint64_t preloaded;
+    int failed;
+} load_worker_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t deadline) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(deadline / 1000000000ULL),
+        .tv_nsec = (long)(deadline % 1000000000ULL)
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+/* xorshift64*: cheap per-thread generator, no shared state */
+static uint64_t rng_next(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static double rng_double(uint64_t *state) {
+    return (double)(rng_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* ---- Histogram ---- */
+
+static void hist_init(histogram_t *h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+static unsigned hist_index(uint64_t v) {
+    if (v < HIST_SUB) {
+        return (unsigned)v;
+    }
+    unsigned msb = 63u - (unsigned)__builtin_clzll(v);
+    unsigned group = msb - HIST_SUB_BITS + 1;
+    unsigned mantissa = (unsigned)(v >> (msb - HIST_SUB_BITS)) & (HIST_SUB - 1);
+    return group * HIST_SUB + mantissa;
+}
+
+/* Highest value that maps to bucket @idx */
+static uint64_t hist_bucket_value(unsigned idx) {
+    unsigned group = idx / HIST_SUB;
+    uint64_t mantissa = idx % HIST_SUB;
+    if (group == 0) {
+        return mantissa;
+    }
+    uint64_t low = (HIST_SUB + mantissa) << (group - 1);
+    return low + (1ULL << (group - 1)) - 1;
+}
+
+static void hist_record(histogram_t *h, uint64_t v) {
+    h->counts[hist_index(v)]++;
+    h->total++;
+    h->sum += v;
+    if (v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+}
+
+static void hist_merge(histogram_t *dst, const histogram_t *src) {
+    if (src->total == 0) {
+        return;
+    }
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    dst->sum += src->sum;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+static uint64_t hist_percentile(const histogram_t *h, double pct) {
+    if (h->total == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)ceil(pct / 100.0 * (double)h->total);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t v = hist_bucket_value(i);
+            return v > h->max ? h->max : v;
+        }
+    }
+    return h->max;
+}
+
+/* ---- Key selection ---- */
+
+static double zeta(uint64_t n, double theta) {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; i++) {
+        sum += 1.0 / pow((double)i, theta);
+    }
+    return sum;
+}
+
+static void zipf_setup(load_config_t *cfg) {
+    double n = (double)cfg->keys;
+    double theta = cfg->zipf_theta;
+    double zeta2 = zeta(2, theta);
+
+    cfg->zipf_zetan = zeta(cfg->keys, theta);
+    cfg->zipf_alpha = 1.0 / (1.0 - theta);
+    cfg->zipf_eta = (1.0 - pow(2.0 / n, 1.0 - theta)) /
+                    (1.0 - zeta2 / cfg->zipf_zetan);
+}
+
+/* Popularity rank (0 = hottest) */
+static uint64_t zipf_rank(const load_config_t *cfg, uint64_t *rng) {
+    double u = rng_double(rng);
+    double uz = u * cfg->zipf_zetan;
+
+    if (uz < 1.0) {
+        return 0;
+    }
+    if (uz < 1.0 + pow(0.5, cfg->zipf_theta)) {
+        return 1;
+    }
+    uint64_t rank = (uint64_t)((double)cfg->keys *
+                               pow(cfg->zipf_eta * u - cfg->zipf_eta + 1.0,
+                                   cfg->zipf_alpha));
+    return rank < cfg->keys ? rank : cfg->keys - 1;
+}
+
+/*
+ * Map a popularity rank onto a key. Multiplying by a prime coprime to the
+ * key count is a bijection, so hot keys are spread over both tiers instead
+ * of clustering at the low ids.
+ */
+static uint32_t scramble_key(const load_config_t *cfg, uint64_t rank) {
+    return (uint32_t)((rank * LOAD_SCRAMBLE_PRIME) % cfg->keys);
+}
+
+static uint32_t pick_key(const load_config_t *cfg, uint64_t *rng) {
+    uint64_t rank;
+
+    switch (cfg->dist) {
+    case DIST_ZIPF:
+        rank = zipf_rank(cfg, rng);
+        break;
+    case DIST_HOTSET: {
+        uint64_t hot = (uint64_t)(cfg->hot_frac * cfg->keys);
+        if (hot == 0) hot = 1;
+        if (hot >= cfg->keys || rng_double(rng) < cfg->hot_prob) {
+            rank = rng_next(rng) % hot;
+        } else {
+            rank = hot + rng_next(rng) % (cfg->keys - hot);
+        }
+        break;
+    }
+    default:
+        rank = rng_next(rng) % cfg->keys;
+        break;
+    }
+    return scramble_key(cfg, rank);
+}
+
+static load_tier_t key_tier(const load_config_t *cfg, uint32_t key) {
+    return (int)(key % 100) < cfg->mem_pct ? LOAD_TIER_MEMORY : LOAD_TIER_PERSISTENT;
+}
+
+static load_op_t pick_op(const load_config_t *cfg, uint64_t *rng) {
+    int r = (int)(rng_next(rng) % (uint64_t)cfg->mix_total);
+    for (int op = 0; op < LOAD_NUM_OPS; op++) {
+        if (r < cfg->mix[op]) {
+            return (load_op_t)op;
+        }
+        r -= cfg->mix[op];
+    }
+    return LOAD_OP_GET;
+}
+
+static size_t key_uri(const load_config_t *cfg, uint32_t key, char *buf) {
+    int n = snprintf(buf, LOAD_URI_MAX, "/bench/load/%s/%u",
+                     key_tier(cfg, key) == LOAD_TIER_MEMORY ? "m" : "p", key);
+    return (size_t)n;
+}
+
+/* ---- Operations (V2, one request in flight per connection) ---- */
+
+static int load_connect(objm_connection_t **conn_out, int *sock_out) {
+    int sock = connect_to_server();
+    if (sock < 0) {
+        return -1;
+    }
+
+    objm_connection_t *conn = objm_client_create(sock, OBJM_PROTO_V2);
+    if (!conn) {
+        close(sock);
+        return -1;
+    }
+
+    objm_hello_t hello = {
+        .capabilities = g_load_caps,
+        .max_pipeline = 1,
+        .backend_parallelism = 1
+    };
+    if (objm_client_hello(conn, &hello, NULL) < 0) {
+        disconnect_from_server(sock, conn);
+        return -1;
+    }
+
+    *conn_out = conn;
+    *sock_out = sock;
+    return 0;
+}
+
+/**
+ * Issue one request and wait for its response.
+ *
+ * @return 0 on success, 1 if the object did not exist, -1 on error
+ */
+static int load_execute(objm_connection_t *conn, const load_config_t *cfg,
+                        load_op_t op, uint32_t key, uint32_t id,
+                        char *buf) {
+    char uri[LOAD_URI_MAX];
+    objm_request_t req = {
+        .id = id,
+        .mode = OBJM_MODE_FDPASS,
+        .uri = uri,
+        .uri_len = key_uri(cfg, key, uri)
+    };
+
+    switch (op) {
+    case LOAD_OP_GET:
+        req.op = OBJM_OP_GET;
+        break;
+    case LOAD_OP_PUT:
+        req.op = OBJM_OP_PUT;
+        /* Priority PUTs are placed on the ephemeral (memory) backend */
+        if (key_tier(cfg, key) == LOAD_TIER_MEMORY) {
+            req.flags = OBJM_REQ_PRIORITY;
+        }
+        break;
+    default:
+        req.op = OBJM_OP_DELETE;
+        break;
+    }
+
+    if (objm_client_send_request(conn, &req) < 0) {
+        return -1;
+    }
+
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0 || !resp) {
+        return -1;
+    }
+
+    int result = 0;
+    if (resp->status == OBJM_STATUS_NOT_FOUND) {
+        result = 1;
+    } else if (resp->status != OBJM_STATUS_OK) {
+        result = -1;
+    } else if (op == LOAD_OP_GET) {
+        if (resp->fd < 0) {
+            result = -1;
+        } else {
+            /* Consume the payload like a real reader would */
+            size_t done = 0;
+            while (done < cfg->object_size) {
+                ssize_t n = pread(resp->fd, buf, cfg->object_size - done,
+                                  (off_t)done);
+                if (n < 0) {
+                    result = -1;
+                    break;
+                }
+                if (n == 0) {
+                    break;
+                }
+                done += (size_t)n;
+            }
+        }
+    } else if (op == LOAD_OP_PUT) {
+        if (resp->fd < 0 ||
+            pwrite(resp->fd, buf, cfg->object_size, 0) != (ssize_t)cfg->object_size) {
+            result = -1;
+        }
+    }
+
+    objm_response_free(resp);
+    return result;
+}
+
+static void *load_preload_worker(void *arg) {
+    load_worker_t *w = arg;
+    const load_config_t *cfg = w->cfg;
+    objm_connection_t *conn;
+    int sock;
+
+    char *buf = malloc(cfg->object_size);
+    if (!buf || load_connect(&conn, &sock) < 0) {
+        free(buf);
+        w->failed = 1;
+        return NULL;
+    }
+    memset(buf, 'P', cfg->object_size);
+
+    uint32_t id = 1;
+    for (uint32_t key = (uint32_t)w->index; key < cfg->keys;
+         key += (uint32_t)cfg->threads) {
+        if (load_execute(conn, cfg, LOAD_OP_PUT, key, id++, buf) == 0) {
+            w->preloaded++;
+        }
+    }
+
+    disconnect_from_server(sock, conn);
+    free(buf);
+    return NULL;
+}
+
+static void *load_worker(void *arg) {
+    load_worker_t *w = arg;
+    const load_config_t *cfg = w->cfg;
+    objm_connection_t *conn;
+    int sock;
+
+    for (int op = 0; op < LOAD_NUM_OPS; op++) {
+        for (int t = 0; t < LOAD_NUM_TIERS; t++) {
+            hist_init(&w->stats.hist[op][t]);
+        }
+    }
+
+    char *buf = malloc(cfg->object_size);
+    if (!buf || load_connect(&conn, &sock) < 0) {
+        free(buf);
+        w->failed = 1;
+        return NULL;
+    }
+    memset(buf, 'L', cfg->object_size);
+
+    /* Each connection owns an equal share of the offered rate. Staggering
+     * the first send keeps the connections from firing in lock-step. */
+    uint64_t interval = 0;
+    uint64_t next = w->start_ns;
+    if (cfg->rate > 0) {
+        interval = (uint64_t)(1e9 * cfg->threads / cfg->rate);
+        if (interval == 0) interval = 1;
+        next += interval * (uint64_t)w->index / (uint64_t)cfg->threads;
+    }
+
+    uint32_t id = 1;
+    while (next < w->end_ns) {
+        uint64_t now = now_ns();
+        if (interval) {
+            if (now < next) {
+                sleep_until_ns(next);
+            } else if (now - next > interval) {
+                w->stats.late++;
+            }
+        } else {
+            next = now;
+            if (next >= w->end_ns) break;
+        }
+
+        load_op_t op = pick_op(cfg, &w->seed);
+        uint32_t key = pick_key(cfg, &w->seed);
+        load_tier_t tier = key_tier(cfg, key);
+
+        int rc = load_execute(conn, cfg, op, key, id++, buf);
+        uint64_t done = now_ns();
+
+        /* Measured from the scheduled send time (coordinated omission) */
+        hist_record(&w->stats.hist[op][tier], done - next);
+        if (rc > 0) {
+            w->stats.misses[op][tier]++;
+        } else if (rc < 0) {
+            w->stats.errors[op][tier]++;
+            /* A failed exchange may leave the stream misaligned */
+            disconnect_from_server(sock, conn);
+            if (load_connect(&conn, &sock) < 0) {
+                w->failed = 1;
+                free(buf);
+                return NULL;
+            }
+        }
+
+        if (interval) {
+            next += interval;
+        }
+    }
+
+    disconnect_from_server(sock, conn);
+    free(buf);
+    return NULL;
+}
+
+/* ---- Configuration and reporting ---- */
+
+static int parse_dist(load_config_t *cfg, const char *arg) {
+    snprintf(cfg->dist_name, sizeof(cfg->dist_name), "%s", arg);
+
+    if (strcmp(arg, "uniform") == 0) {
+        cfg->dist = DIST_UNIFORM;
+        return 0;
+    }
+    if (strncmp(arg, "zipf", 4) == 0) {
+        cfg->dist = DIST_ZIPF;
+        cfg->zipf_theta = 0.99;
+        if (arg[4] == ':') {
+            cfg->zipf_theta = atof(arg + 5);
+        } else if (arg[4] != '\0') {
+            return -1;
+        }
+        /* The closed-form sampler is undefined at theta == 1 */
+        if (cfg->zipf_theta <= 0 || cfg->zipf_theta >= 1) {
+            return -1;
+        }
+        return 0;
+    }
+    if (strncmp(arg, "hot", 3) == 0) {
+        cfg->dist = DIST_HOTSET;
+        cfg->hot_frac = 0.2;
+        cfg->hot_prob = 0.8;
+        if (arg[3] == ':') {
+            if (sscanf(arg + 4, "%lf:%lf", &cfg->hot_frac, &cfg->hot_prob) != 2) {
+                return -1;
+            }
+        } else if (arg[3] != '\0') {
+            return -1;
+        }
+        if (cfg->hot_frac <= 0 || cfg->hot_frac > 1 ||
+            cfg->hot_prob < 0 || cfg->hot_prob > 1) {
+            return -1;
+        }
+        return 0;
+    }
+    return -1;
+}
+
+static int parse_mix(load_config_t *cfg, const char *arg) {
+    int get, put, del;
+    if (sscanf(arg, "%d:%d:%d", &get, &put, &del) != 3 ||
+        get < 0 || put < 0 || del < 0 || get + put + del == 0) {
+        return -1;
+    }
+    cfg->mix[LOAD_OP_GET] = get;
+    cfg->mix[LOAD_OP_PUT] = put;
+    cfg->mix[LOAD_OP_DEL] = del;
+    cfg->mix_total = get + put + del;
+    return 0;
+}
+
+static void load_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s load [options]\n"
+            "  -S PATH     Server socket (default %s)\n"
+            "  -c N        Connections, one thread each (default %d)\n"
+            "  -r RATE     Offered load in ops/sec, 0 = closed loop (default %d)\n"
+            "  -d SEC      Measurement duration (default %d)\n"
+            "  -k N        Key space size (default %d)\n"
+            "  -s BYTES    Object size (default %d)\n"
+            "  -D DIST     uniform | zipf[:THETA] | hot[:FRAC:PROB] (default zipf:0.99)\n"
+            "  -m G:P:D    GET:PUT:DELETE weights (default 90:8:2)\n"
+            "  -M PCT      Percent of keys in the memory tier (default %d)\n"
+            "  -n          Skip preloading the key space\n"
+            "  -R          Use the shared-memory ring transport\n"
+            "  -j          Print results as JSON (default key=value lines)\n",
+            prog, SOCKET_PATH, LOAD_DEFAULT_THREADS, LOAD_DEFAULT_RATE,
+            LOAD_DEFAULT_DURATION, LOAD_DEFAULT_KEYS, LOAD_DEFAULT_SIZE,
+            LOAD_DEFAULT_MEM_PCT);
+}
+
+static void report_row(const load_config_t *cfg, bool *first,
+                       const char *op, const char *tier,
+                       const histogram_t *h, uint64_t misses, uint64_t errors,
+                       double elapsed) {
+    if (h->total == 0) {
+        return;
+    }
+
+    double mean = (double)h->sum / (double)h->total / 1000.0;
+    double p50 = hist_percentile(h, 50.0) / 1000.0;
+    double p90 = hist_percentile(h, 90.0) / 1000.0;
+    double p99 = hist_percentile(h, 99.0) / 1000.0;
+    double p999 = hist_percentile(h, 99.9) / 1000.0;
+    double max = h->max / 1000.0;
+    double rate = (double)h->total / elapsed;
+
+    if (cfg->json) {
+        printf("%s\n    {\"op\": \"%s\", \"tier\": \"%s\", \"count\": %llu, "
+               "\"misses\": %llu, \"errors\": %llu, \"ops_per_sec\": %.1f, "
+               "\"mean_us\": %.1f, \"p50_us\": %.1f, \"p90_us\": %.1f, "
+               "\"p99_us\": %.1f, \"p999_us\": %.1f, \"max_us\": %.1f}",
+               *first ? "" : ",", op, tier,
+               (unsigned long long)h->total, (unsigned long long)misses,
+               (unsigned long long)errors, rate, mean, p50, p90, p99, p999, max);
+    } else {
+        printf("op=%s tier=%s count=%llu misses=%llu errors=%llu "
+               "ops_per_sec=%.1f mean_us=%.1f p50_us=%.1f p90_us=%.1f "
+               "p99_us=%.1f p999_us=%.1f max_us=%.1f\n",
+               op, tier, (unsigned long long)h->total,
+               (unsigned long long)misses, (unsigned long long)errors,
+               rate, mean, p50, p90, p99, p999, max);
+    }
+    *first = false;
+}
+
+static int run_load(int argc, char **argv) {
+    load_config_t cfg = {
+        .threads = LOAD_DEFAULT_THREADS,
+        .rate = LOAD_DEFAULT_RATE,
+        .duration = LOAD_DEFAULT_DURATION,
+        .keys = LOAD_DEFAULT_KEYS,
+        .object_size = LOAD_DEFAULT_SIZE,
+        .mem_pct = LOAD_DEFAULT_MEM_PCT,
+        .preload = true
+    };
+    parse_dist(&cfg, "zipf:0.99");
+    parse_mix(&cfg, "90:8:2");
+
+    int opt;
+    while ((opt = getopt(argc, argv, "S:c:r:d:k:s:D:m:M:nRjh")) != -1) {
+        switch (opt) {
+        case 'S':
+            g_socket_path = optarg;
+            break;
+        case 'c':
+            cfg.threads = atoi(optarg);
+            break;
+        case 'r':
+            cfg.rate = atof(optarg);
+            break;
+        case 'd':
+            cfg.duration = atoi(optarg);
+            break;
+        case 'k':
+            cfg.keys = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            cfg.object_size = strtoul(optarg, NULL, 10);
+            break;
+        case 'D':
+            if (parse_dist(&cfg, optarg) < 0) {
+                fprintf(stderr, "Invalid distribution: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'm':
+            if (parse_mix(&cfg, optarg) < 0) {
+                fprintf(stderr, "Invalid op mix: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'M':
+            cfg.mem_pct = atoi(optarg);
+            break;
+        case 'n':
+            cfg.preload = false;
+            break;
+        case 'R':
+            g_load_caps |= OBJM_CAP_SHM_RING;
+            break;
+        case 'j':
+            cfg.json = true;
+            break;
+        default:
+            load_usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (cfg.threads <= 0 || cfg.duration <= 0 || cfg.keys < 2 ||
+        cfg.rate < 0 || cfg.object_size == 0 ||
+        cfg.object_size > MAX_OBJECT_SIZE ||
+        cfg.mem_pct < 0 || cfg.mem_pct > 100) {
+        load_usage(argv[0]);
+        return 1;
+    }
+    if (cfg.dist == DIST_ZIPF) {
+        zipf_setup(&cfg);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    load_worker_t *workers = calloc((size_t)cfg.threads, sizeof(*workers));
+    pthread_t *tids = calloc((size_t)cfg.threads, sizeof(*tids));
+    if (!workers || !tids) {
+        free(workers);
+        free(tids);
+        return 1;
+    }
+
+    uint64_t seed = now_ns() ^ (uint64_t)getpid();
+    for (int i = 0; i < cfg.threads; i++) {
+        workers[i].cfg = &cfg;
+        workers[i].index = i;
+        workers[i].seed = (seed + (uint64_t)i * 0x9E3779B97F4A7C15ULL) | 1;
+    }
+
+    if (cfg.preload) {
+        fprintf(stderr, "Preloading %u keys (%zu bytes each)...\n",
+                cfg.keys, cfg.object_size);
+        uint64_t loaded = 0;
+        for (int i = 0; i < cfg.threads; i++) {
+            pthread_create(&tids[i], NULL, load_preload_worker, &workers[i]);
+        }
+        for (int i = 0; i < cfg.threads; i++) {
+            pthread_join(tids[i], NULL);
+            loaded += workers[i].preloaded;
+            if (workers[i].failed) {
+                fprintf(stderr, "Preload failed: cannot connect to %s\n",
+                        g_socket_path);
+                free(workers);
+                free(tids);
+                return 1;
+            }
+        }
+        fprintf(stderr, "Preloaded %llu/%u keys\n",
+                (unsigned long long)loaded, cfg.keys);
+    }
+
+    fprintf(stderr, "Running %s load for %d s: %d connections, %.0f ops/sec, %s\n",
+            cfg.rate > 0 ? "open-loop" : "closed-loop", cfg.duration,
+            cfg.threads, cfg.rate, cfg.dist_name);
+
+    /* Give every thread time to connect before the schedule starts */
+    uint64_t start = now_ns() + 100000000ULL;
+    uint64_t end = start + (uint64_t)cfg.duration * 1000000000ULL;
+    for (int i = 0; i < cfg.threads; i++) {
+        workers[i].start_ns = start;
+        workers[i].end_ns = end;
+        pthread_create(&tids[i], NULL, load_worker, &workers[i]);
+    }
+
+    /* Merge per-thread results; no shared counters on the hot path */
+    static load_stats_t total;
+    histogram_t *all_tiers = malloc(sizeof(histogram_t) * LOAD_NUM_OPS);
+    for (int op = 0; op < LOAD_NUM_OPS; op++) {
+        hist_init(&all_tiers[op]);
+        for (int t = 0; t < LOAD_NUM_TIERS; t++) {
+            hist_init(&total.hist[op][t]);
+        }
+    }
+
+    int failed = 0;
+    for (int i = 0; i < cfg.threads; i++) {
+        pthread_join(tids[i], NULL);
+        failed += workers[i].failed;
+        total.late += workers[i].stats.late;
+        for (int op = 0; op < LOAD_NUM_OPS; op++) {
+            for (int t = 0; t < LOAD_NUM_TIERS; t++) {
+                hist_merge(&total.hist[op][t], &workers[i].stats.hist[op][t]);
+                hist_merge(&all_tiers[op], &workers[i].stats.hist[op][t]);
+                total.misses[op][t] += workers[i].stats.misses[op][t];
+                total.errors[op][t] += workers[i].stats.errors[op][t];
+            }
+        }
+    }
+    double elapsed = (double)(now_ns() - start) / 1e9;
+    if (elapsed > cfg.duration) {
+        /* Stragglers finishing their last request do not add offered load */
+        elapsed = cfg.duration;
+    }
+
+    uint64_t ops = 0;
+    for (int op = 0; op < LOAD_NUM_OPS; op++) {
+        ops += all_tiers[op].total;
+    }
+
+    if (cfg.json) {
+        printf("{\n  \"mode\": \"%s\", \"connections\": %d, \"offered_rate\": %.1f,\n"
+               "  \"achieved_rate\": %.1f, \"duration_s\": %d, \"keys\": %u,\n"
+               "  \"object_size\": %zu, \"distribution\": \"%s\",\n"
+               "  \"mix\": {\"get\": %d, \"put\": %d, \"del\": %d}, "
+               "\"memory_key_pct\": %d,\n"
+               "  \"late_requests\": %llu, \"failed_connections\": %d,\n"
+               "  \"results\": [",
+               cfg.rate > 0 ? "open_loop" : "closed_loop", cfg.threads,
+               cfg.rate, (double)ops / elapsed, cfg.duration, cfg.keys,
+               cfg.object_size, cfg.dist_name,
+               cfg.mix[LOAD_OP_GET], cfg.mix[LOAD_OP_PUT], cfg.mix[LOAD_OP_DEL],
+               cfg.mem_pct, (unsigned long long)total.late, failed);
+    } else {
+        printf("mode=%s connections=%d offered_rate=%.1f achieved_rate=%.1f "
+               "duration_s=%d keys=%u object_size=%zu distribution=%s "
+               "mix=%d:%d:%d memory_key_pct=%d late_requests=%llu "
+               "failed_connections=%d\n",
+               cfg.rate > 0 ? "open_loop" : "closed_loop", cfg.threads,
+               cfg.rate, (double)ops / elapsed, cfg.duration, cfg.keys,
+               cfg.object_size, cfg.dist_name,
+               cfg.mix[LOAD_OP_GET], cfg.mix[LOAD_OP_PUT], cfg.mix[LOAD_OP_DEL],
+               cfg.mem_pct, (unsigned long long)total.late, failed);
+    }
+
+    bool first = true;
+    for (int op = 0; op < LOAD_NUM_OPS; op++) {
+        uint64_t misses = 0, errors = 0;
+        for (int t = 0; t < LOAD_NUM_TIERS; t++) {
+            report_row(&cfg, &first, LOAD_OP_NAMES[op], LOAD_TIER_NAMES[t],
+                       &total.hist[op][t], total.misses[op][t],
+                       total.errors[op][t], elapsed);
+            misses += total.misses[op][t];
+            errors += total.errors[op][t];
+        }
+        report_row(&cfg, &first, LOAD_OP_NAMES[op], "all",
+                   &all_tiers[op], misses, errors, elapsed);
+    }
+
+    if (cfg.json) {
+        printf("\n  ]\n}\n");
+    }
+
+    free(all_tiers);
+    free(workers);
+    free(tids);
+    return failed ? 1 : 0;
+}
+
 /* ============================================================================
  * Main
  * ============================================================================ */
 
-int main(void) {
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "load") == 0) {
+        return run_load(argc - 1, argv + 1);
+    }
+    
     printf("=== FD Passing Performance Benchmark ===\n");
     printf("Configuration:\n");
     printf("  Duration per test: %d seconds\n", BENCHMARK_DURATION_SEC);
@@ -5,10 +5,16 @@
  * Command-line client for objmapper server:
  * - Connects via Unix socket
  * - Uses FD passing for zero-copy GET/PUT
+ * - COPY/SPLICE modes stream data through the socket instead (-m)
+ * - Cluster mode (-C): URIs are spread over several servers by the
+ *   cluster library; Unix nodes pass FDs, TCP nodes stream
  * - Simple command interface
  */
 
+#define _GNU_SOURCE
+
 #include "lib/protocol/protocol.h"
+#include "lib/cluster/cluster.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,21 +22,155 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <endian.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 #define DEFAULT_SOCKET_PATH "/tmp/objmapper.sock"
 #define BUFFER_SIZE (64 * 1024)
 
+/* Transfer mode for put/get (-m) */
+static char g_mode = OBJM_MODE_FDPASS;
+
+/* Server socket (mput opens a connection per worker) */
+static const char *g_socket_path = DEFAULT_SOCKET_PATH;
+
+static objm_connection_t *client_connect(const char *socket_path);
+static void client_disconnect(objm_connection_t *conn);
+
 /* ============================================================================
  * Client Commands
  * ============================================================================ */
 
+/**
+ * Streamed PUT: the file follows the request as a chunked body
+ */
+static int cmd_put_stream(objm_connection_t *conn, const char *uri,
+                          const char *source_path) {
+    int src_fd = open(source_path, O_RDONLY);
+    if (src_fd < 0) {
+        perror("open source file");
+        return -1;
+    }
+    
+    objm_request_t req = {
+        .id = 0,
+        .op = OBJM_OP_PUT,
+        .flags = OBJM_REQ_BODY,
+        .mode = g_mode,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri)
+    };
+    
+    printf("PUT %s <- %s (%s)\n", uri, source_path, objm_mode_name(g_mode));
+    
+    uint64_t sent = 0;
+    if (objm_client_send_request(conn, &req) < 0 ||
+        objm_send_body(conn, src_fd, g_mode, &sent) < 0) {
+        fprintf(stderr, "Failed to send PUT request\n");
+        close(src_fd);
+        return -1;
+    }
+    close(src_fd);
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0) {
+        fprintf(stderr, "Failed to receive response\n");
+        return -1;
+    }
+    
+    if (resp->status != OBJM_STATUS_OK) {
+        fprintf(stderr, "PUT failed (status=%d): %s\n", resp->status,
+                resp->error_msg ? resp->error_msg : "Unknown error");
+        objm_response_free(resp);
+        return -1;
+    }
+    
+    /* The acknowledgement is an empty streamed body */
+    int ret = 0;
+    if (resp->content_len == OBJM_CONTENT_CHUNKED &&
+        objm_recv_body(conn, -1, g_mode, NULL) < 0) {
+        fprintf(stderr, "Failed to receive acknowledgement\n");
+        ret = -1;
+    } else {
+        printf("Wrote %llu bytes\n", (unsigned long long)sent);
+    }
+    
+    objm_response_free(resp);
+    return ret;
+}
+
+/**
+ * Streamed GET: the object arrives as a chunked body
+ */
+static int cmd_get_stream(objm_connection_t *conn, const char *uri,
+                          const char *dest_path) {
+    objm_request_t req = {
+        .id = 0,
+        .op = OBJM_OP_GET,
+        .flags = 0,
+        .mode = g_mode,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri)
+    };
+    
+    printf("GET %s -> %s (%s)\n", uri, dest_path, objm_mode_name(g_mode));
+    
+    if (objm_client_send_request(conn, &req) < 0) {
+        fprintf(stderr, "Failed to send GET request\n");
+        return -1;
+    }
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0) {
+        fprintf(stderr, "Failed to receive response\n");
+        return -1;
+    }
+    
+    if (resp->status != OBJM_STATUS_OK || resp->content_len != OBJM_CONTENT_CHUNKED) {
+        fprintf(stderr, "GET failed: %s\n",
+                resp->error_msg ? resp->error_msg : "Unknown error");
+        objm_response_free(resp);
+        return -1;
+    }
+    objm_response_free(resp);
+    
+    int dest_fd = open(dest_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    
+    /* The body must be consumed even if the file cannot be opened */
+    uint64_t received = 0;
+    int ret = objm_recv_body(conn, dest_fd, g_mode, &received);
+    
+    if (dest_fd < 0) {
+        perror("open dest file");
+        return -1;
+    }
+    close(dest_fd);
+    
+    if (ret < 0) {
+        fprintf(stderr, "Failed to receive body\n");
+        return -1;
+    }
+    
+    printf("Read %llu bytes\n", (unsigned long long)received);
+    return 0;
+}
+
 static int cmd_put(objm_connection_t *conn, const char *uri, const char *source_path) {
+    if (g_mode != OBJM_MODE_FDPASS) {
+        return cmd_put_stream(conn, uri, source_path);
+    }
+    
     /* Send PUT request */
     objm_request_t req = {
         .id = 0,
+        .op = OBJM_OP_PUT,
         .flags = 0,
         .mode = OBJM_MODE_FDPASS,
         .uri = (char *)uri,
@@ -101,10 +241,19 @@ static int cmd_put(objm_connection_t *conn, const char *uri, const char *source_
     return 0;
 }
 
+static bool reply_range(const objm_response_t *resp, uint64_t range[3]);
+static int cmd_range(objm_connection_t *conn, const char *uri, uint64_t offset,
+                     uint64_t length, const char *dest_path);
+
 static int cmd_get(objm_connection_t *conn, const char *uri, const char *dest_path) {
+    if (g_mode != OBJM_MODE_FDPASS) {
+        return cmd_get_stream(conn, uri, dest_path);
+    }
+    
     /* Send GET request */
     objm_request_t req = {
         .id = 0,
+        .op = OBJM_OP_GET,
         .flags = 0,
         .mode = OBJM_MODE_FDPASS,
         .uri = (char *)uri,
@@ -140,6 +289,14 @@ static int cmd_get(objm_connection_t *conn, const char *uri, const char *dest_pa
         return -1;
     }
     
+    /* A chunked object comes one chunk per FD */
+    uint64_t range[3];
+    if (reply_range(resp, range) && range[1] < range[2]) {
+        close(src_fd);
+        objm_response_free(resp);
+        return cmd_range(conn, uri, 0, 0, dest_path);
+    }
+    
     size_t content_len = resp->content_len;
     printf("Content length: %zu bytes\n", content_len);
     
@@ -152,12 +309,12 @@ static int cmd_get(objm_connection_t *conn, const char *uri, const char *dest_pa
         return -1;
     }
     
-    /* Copy data */
+    /* Copy data - pread: the FD shares its offset with the server's cache */
     char buffer[BUFFER_SIZE];
     ssize_t total_read = 0;
     ssize_t bytes_read;
     
-    while ((bytes_read = read(src_fd, buffer, sizeof(buffer))) > 0) {
+    while ((bytes_read = pread(src_fd, buffer, sizeof(buffer), total_read)) > 0) {
         ssize_t bytes_written = write(dest_fd, buffer, bytes_read);
         if (bytes_written < 0) {
             perror("write");
@@ -179,16 +336,13 @@ static int cmd_get(objm_connection_t *conn, const char *uri, const char *dest_pa
 }
 
 static int cmd_delete(objm_connection_t *conn, const char *uri) {
-    /* Send DELETE request (via special URI prefix) */
-    char delete_uri[OBJM_MAX_URI_LEN];
-    snprintf(delete_uri, sizeof(delete_uri), "/delete%s", uri);
-    
     objm_request_t req = {
         .id = 0,
+        .op = OBJM_OP_DELETE,
         .flags = 0,
         .mode = OBJM_MODE_FDPASS,
-        .uri = delete_uri,
-        .uri_len = strlen(delete_uri)
+        .uri = (char *)uri,
+        .uri_len = strlen(uri)
     };
     
     printf("DELETE %s\n", uri);
@@ -218,38 +372,768 @@ static int cmd_delete(objm_connection_t *conn, const char *uri) {
     return 0;
 }
 
+/**
+ * Print the size, mtime, ETag and backend a reply carries
+ */
+static void print_metadata(const char *uri, const objm_response_t *resp) {
+    objm_metadata_entry_t *entries = NULL;
+    size_t num_entries = 0;
+    if (objm_metadata_parse(resp->metadata, resp->metadata_len,
+                            &entries, &num_entries) < 0) {
+        return;
+    }
+    
+    const objm_metadata_entry_t *size =
+        objm_metadata_get(entries, num_entries, OBJM_META_SIZE);
+    const objm_metadata_entry_t *mtime =
+        objm_metadata_get(entries, num_entries, OBJM_META_MTIME);
+    const objm_metadata_entry_t *etag =
+        objm_metadata_get(entries, num_entries, OBJM_META_ETAG);
+    const objm_metadata_entry_t *backend =
+        objm_metadata_get(entries, num_entries, OBJM_META_BACKEND);
+    uint64_t v;
+    
+    printf("%s\n", uri);
+    if (size && size->length == 8) {
+        memcpy(&v, size->data, 8);
+        printf("  Size:    %llu bytes\n", (unsigned long long)be64toh(v));
+    }
+    if (mtime && mtime->length == 8) {
+        memcpy(&v, mtime->data, 8);
+        printf("  Mtime:   %llu\n", (unsigned long long)be64toh(v));
+    }
+    if (etag) {
+        printf("  ETag:    %.*s\n", (int)etag->length, (const char *)etag->data);
+    }
+    if (backend && backend->length == 1) {
+        printf("  Backend: %u\n", backend->data[0]);
+    }
+    objm_metadata_free_entries(entries, num_entries);
+}
+
+static int cmd_stat(objm_connection_t *conn, const char *uri) {
+    objm_request_t req = {
+        .id = 0,
+        .op = OBJM_OP_STAT,
+        .flags = 0,
+        .mode = OBJM_MODE_FDPASS,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri)
+    };
+    
+    if (objm_client_send_request(conn, &req) < 0) {
+        fprintf(stderr, "Failed to send STAT request\n");
+        return -1;
+    }
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0) {
+        fprintf(stderr, "Failed to receive response\n");
+        return -1;
+    }
+    
+    if (resp->status != OBJM_STATUS_OK) {
+        fprintf(stderr, "STAT failed: %s\n",
+                resp->error_msg ? resp->error_msg : "Unknown error");
+        objm_response_free(resp);
+        return -1;
+    }
+    
+    print_metadata(uri, resp);
+    
+    objm_response_free(resp);
+    return 0;
+}
+
+/**
+ * Conditional GET: is the copy with this ETag still current?
+ */
+static int cmd_revalidate(objm_connection_t *conn, const char *uri, const char *etag) {
+    uint8_t conditions[OBJM_MAX_CONDITIONS];
+    if (strlen(etag) > OBJM_MAX_CONDITIONS - 3) {
+        fprintf(stderr, "ETag too long\n");
+        return -1;
+    }
+    
+    objm_request_t req = {
+        .id = 0,
+        .op = OBJM_OP_GET,
+        .flags = OBJM_REQ_CONDITIONAL,
+        .mode = g_mode,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri),
+        .conditions = conditions,
+        .conditions_len = objm_metadata_add_etag(conditions, 0, etag)
+    };
+    
+    if (objm_client_send_request(conn, &req) < 0) {
+        fprintf(stderr, "Failed to send GET request\n");
+        return -1;
+    }
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0) {
+        fprintf(stderr, "Failed to receive response\n");
+        return -1;
+    }
+    
+    if (resp->status != OBJM_STATUS_OK && resp->status != OBJM_STATUS_NOT_MODIFIED) {
+        fprintf(stderr, "GET failed: %s\n",
+                resp->error_msg ? resp->error_msg : "Unknown error");
+        objm_response_free(resp);
+        return -1;
+    }
+    
+    /* Changed: the object came anyway, and is not needed here */
+    int ret = 0;
+    if (resp->fd >= 0) close(resp->fd);
+    if (resp->content_len == OBJM_CONTENT_CHUNKED &&
+        objm_recv_body(conn, -1, g_mode, NULL) < 0) {
+        fprintf(stderr, "Failed to receive body\n");
+        ret = -1;
+    }
+    
+    printf("%s\n", resp->status == OBJM_STATUS_NOT_MODIFIED ? "Not modified" : "Modified");
+    print_metadata(uri, resp);
+    
+    objm_response_free(resp);
+    return ret;
+}
+
+/**
+ * Request a text report (STATS, LIST) and print it
+ */
+static int cmd_report(objm_connection_t *conn, uint8_t op, const char *uri) {
+    const char *name = objm_op_name(op);
+    objm_request_t req = {
+        .id = 0,
+        .op = op,
+        .flags = 0,
+        .mode = g_mode,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri)
+    };
+    
+    if (objm_client_send_request(conn, &req) < 0) {
+        fprintf(stderr, "Failed to send %s request\n", name);
+        return -1;
+    }
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0) {
+        fprintf(stderr, "Failed to receive response\n");
+        return -1;
+    }
+    
+    if (resp->status != OBJM_STATUS_OK) {
+        fprintf(stderr, "%s failed: %s\n", name,
+                resp->error_msg ? resp->error_msg : "Unknown error");
+        objm_response_free(resp);
+        return -1;
+    }
+    
+    /* A streamed report is spooled first: the body is written with pwrite() */
+    int fd = resp->fd;
+    resp->fd = -1;
+    if (fd < 0) {
+        fd = memfd_create("objmapper-report", MFD_CLOEXEC);
+        if (fd < 0 || objm_recv_body(conn, fd, g_mode, NULL) < 0) {
+            fprintf(stderr, "Failed to receive report\n");
+            if (fd >= 0) close(fd);
+            objm_response_free(resp);
+            return -1;
+        }
+    }
+    
+    char buffer[BUFFER_SIZE];
+    off_t off = 0;
+    ssize_t n;
+    while ((n = pread(fd, buffer, sizeof(buffer), off)) > 0) {
+        fwrite(buffer, 1, n, stdout);
+        off += n;
+    }
+    
+    close(fd);
+    objm_response_free(resp);
+    return 0;
+}
+
+static int cmd_purge(objm_connection_t *conn, const char *prefix) {
+    objm_request_t req = {
+        .id = 0,
+        .op = OBJM_OP_PURGE,
+        .flags = 0,
+        .mode = g_mode,
+        .uri = (char *)prefix,
+        .uri_len = strlen(prefix)
+    };
+    
+    if (objm_client_send_request(conn, &req) < 0) {
+        fprintf(stderr, "Failed to send PURGE request\n");
+        return -1;
+    }
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0) {
+        fprintf(stderr, "Failed to receive response\n");
+        return -1;
+    }
+    
+    if (resp->status != OBJM_STATUS_OK) {
+        fprintf(stderr, "PURGE failed: %s\n",
+                resp->error_msg ? resp->error_msg : "Unknown error");
+        objm_response_free(resp);
+        return -1;
+    }
+    
+    uint64_t purged = 0;
+    objm_metadata_entry_t *entries = NULL;
+    size_t num_entries = 0;
+    if (objm_metadata_parse(resp->metadata, resp->metadata_len,
+                            &entries, &num_entries) == 0) {
+        const objm_metadata_entry_t *count =
+            objm_metadata_get(entries, num_entries, OBJM_META_COUNT);
+        if (count && count->length == 8) {
+            memcpy(&purged, count->data, 8);
+            purged = be64toh(purged);
+        }
+        objm_metadata_free_entries(entries, num_entries);
+    }
+    
+    printf("Purged %llu objects under %s\n", (unsigned long long)purged, prefix);
+    objm_response_free(resp);
+    return 0;
+}
+
+static int cmd_mget(objm_connection_t *conn, const char *const *uris, size_t count) {
+    if (!objm_has_capability(conn, OBJM_CAP_BATCH)) {
+        fprintf(stderr, "Server does not support multi-GET\n");
+        return -1;
+    }
+    
+    printf("MGET %zu objects\n", count);
+    
+    if (objm_client_send_multi_get(conn, 1, 0, OBJM_MODE_FDPASS, uris, count) < 0) {
+        fprintf(stderr, "Failed to send multi-GET request\n");
+        return -1;
+    }
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0) {
+        fprintf(stderr, "Failed to receive response\n");
+        return -1;
+    }
+    
+    if (resp->num_items != count) {
+        fprintf(stderr, "MGET failed: %s\n",
+                resp->error_msg ? resp->error_msg : "Unknown error");
+        objm_response_free(resp);
+        return -1;
+    }
+    
+    int ret = 0;
+    for (size_t i = 0; i < count; i++) {
+        const objm_response_t *item = &resp->items[i];
+        struct stat st;
+        
+        if (item->status == OBJM_STATUS_OK && item->fd >= 0 &&
+            fstat(item->fd, &st) == 0) {
+            printf("  %s: %lld bytes\n", uris[i], (long long)st.st_size);
+        } else if (item->status == OBJM_STATUS_UNSUPPORTED_OP) {
+            printf("  %s: chunked, fetch it with get or range\n", uris[i]);
+            ret = -1;
+        } else {
+            printf("  %s: not found\n", uris[i]);
+            ret = -1;
+        }
+    }
+    
+    objm_response_free(resp);
+    return ret;
+}
+
+/**
+ * Object bytes a range reply holds (OBJM_META_RANGE): offset, length, size
+ */
+static bool reply_range(const objm_response_t *resp, uint64_t range[3]) {
+    objm_metadata_entry_t *entries = NULL;
+    size_t num_entries = 0;
+    if (objm_metadata_parse(resp->metadata, resp->metadata_len,
+                            &entries, &num_entries) < 0) {
+        return false;
+    }
+    
+    const objm_metadata_entry_t *entry =
+        objm_metadata_get(entries, num_entries, OBJM_META_RANGE);
+    bool found = entry && entry->length == 24;
+    for (int i = 0; found && i < 3; i++) {
+        uint64_t v;
+        memcpy(&v, entry->data + 8 * i, 8);
+        range[i] = be64toh(v);
+    }
+    objm_metadata_free_entries(entries, num_entries);
+    return found;
+}
+
+/* Append len bytes of fd from offset to dest_fd */
+static int copy_out(int fd, uint64_t offset, uint64_t len, int dest_fd) {
+    char buf[BUFFER_SIZE];
+    while (len > 0) {
+        ssize_t n = pread(fd, buf, len < sizeof(buf) ? len : sizeof(buf), offset);
+        if (n <= 0 || write(dest_fd, buf, n) != n) return -1;
+        offset += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * One ranged GET: append what the reply holds of [offset, offset + length)
+ * to dest_fd
+ * 
+ * @param got Output: bytes appended
+ * @param size Output: object size
+ */
+static int range_once(objm_connection_t *conn, const char *uri, uint64_t offset,
+                      uint64_t length, int dest_fd, uint64_t *got, uint64_t *size) {
+    objm_request_t req = {
+        .id = 0,
+        .op = OBJM_OP_GET,
+        .flags = OBJM_REQ_RANGE,
+        .mode = g_mode,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri),
+        .range_offset = offset,
+        .range_length = length
+    };
+    
+    if (objm_client_send_request(conn, &req) < 0) {
+        fprintf(stderr, "Failed to send GET request\n");
+        return -1;
+    }
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0) {
+        fprintf(stderr, "Failed to receive response\n");
+        return -1;
+    }
+    
+    uint64_t range[3];
+    if (resp->status != OBJM_STATUS_OK || !reply_range(resp, range)) {
+        fprintf(stderr, "GET failed (status=%d): %s\n", resp->status,
+                resp->error_msg ? resp->error_msg : "Unknown error");
+        if (resp->fd >= 0) close(resp->fd);
+        objm_response_free(resp);
+        return -1;
+    }
+    *size = range[2];
+    
+    int ret = 0;
+    if (resp->fd >= 0) {
+        /* FD pass: the FD holds object bytes [range[0], range[0] + range[1]) */
+        uint64_t end = range[0] + range[1];
+        uint64_t want = (length == 0 || offset + length > end) ? end - offset : length;
+        ret = copy_out(resp->fd, offset - range[0], want, dest_fd);
+        *got = want;
+        close(resp->fd);
+    } else {
+        /* Streamed: exactly the range; received lands at offset 0 */
+        ret = objm_recv_body(conn, dest_fd, g_mode, got);
+    }
+    
+    objm_response_free(resp);
+    return ret;
+}
+
+/**
+ * Ranged GET (length 0 = to the end)
+ * 
+ * An FD pass reply holds one chunk of a chunked object, so the command
+ * asks again from where it ends until the range is complete.
+ */
+static int cmd_range(objm_connection_t *conn, const char *uri, uint64_t offset,
+                     uint64_t length, const char *dest_path) {
+    int dest_fd = open(dest_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (dest_fd < 0) {
+        perror("open dest file");
+        return -1;
+    }
+    
+    printf("GET %s [%" PRIu64 ", +%" PRIu64 "] -> %s (%s)\n", uri, offset, length,
+           dest_path, objm_mode_name(g_mode));
+    
+    uint64_t done = 0, got, size;
+    int ret;
+    do {
+        ret = range_once(conn, uri, offset + done, length ? length - done : 0,
+                         dest_fd, &got, &size);
+        done += got;
+    } while (ret == 0 && got > 0 && offset + done < size &&
+             (length == 0 || done < length));
+    close(dest_fd);
+    
+    if (ret < 0) return -1;
+    printf("Read %" PRIu64 " bytes of %" PRIu64 "\n", done, size);
+    return 0;
+}
+
+typedef struct {
+    const char *uri;
+    int fd;                          /* Source file */
+    uint64_t size;
+    uint64_t num_parts;
+    atomic_uint_fast64_t next_part;
+    atomic_bool failed;
+} mput_job_t;
+
+/* Send one part as a PUT with OBJM_REQ_RANGE and wait for its ack (the
+ * first one declares the object's size) */
+static int put_part(objm_connection_t *conn, mput_job_t *job, uint64_t part) {
+    uint64_t offset = part * OBJM_PART_SIZE;
+    uint64_t length = job->size - offset < OBJM_PART_SIZE ? job->size - offset
+                                                          : OBJM_PART_SIZE;
+    char mode = (g_mode == OBJM_MODE_SPLICE) ? OBJM_MODE_SPLICE : OBJM_MODE_COPY;
+    objm_request_t req = {
+        .id = 0,
+        .op = OBJM_OP_PUT,
+        .flags = OBJM_REQ_BODY | OBJM_REQ_RANGE | (part == 0 ? OBJM_REQ_TOTAL : 0),
+        .mode = mode,
+        .uri = (char *)job->uri,
+        .uri_len = strlen(job->uri),
+        .range_offset = offset,
+        .range_length = length,
+        .range_total = job->size
+    };
+    objm_extent_t extent = { .fd = job->fd, .offset = offset, .length = length };
+    
+    if (objm_client_send_request(conn, &req) < 0 ||
+        objm_send_body_extents(conn, &extent, length > 0 ? 1 : 0, mode, NULL) < 0) {
+        fprintf(stderr, "Failed to send part %" PRIu64 "\n", part);
+        return -1;
+    }
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(conn, &resp) < 0) {
+        fprintf(stderr, "Failed to receive response\n");
+        return -1;
+    }
+    
+    int ret = 0;
+    if (resp->status != OBJM_STATUS_OK) {
+        fprintf(stderr, "Part %" PRIu64 " failed (status=%d): %s\n", part, resp->status,
+                resp->error_msg ? resp->error_msg : "Unknown error");
+        ret = -1;
+    } else if (resp->content_len == OBJM_CONTENT_CHUNKED &&
+               objm_recv_body(conn, -1, mode, NULL) < 0) {
+        fprintf(stderr, "Failed to receive acknowledgement\n");
+        ret = -1;
+    }
+    objm_response_free(resp);
+    return ret;
+}
+
+static void *mput_worker(void *arg) {
+    mput_job_t *job = arg;
+    objm_connection_t *conn = client_connect(g_socket_path);
+    if (!conn) {
+        atomic_store(&job->failed, true);
+        return NULL;
+    }
+    
+    uint64_t part;
+    while (!atomic_load(&job->failed) &&
+           (part = atomic_fetch_add(&job->next_part, 1)) < job->num_parts) {
+        if (put_part(conn, job, part) < 0) atomic_store(&job->failed, true);
+    }
+    
+    client_disconnect(conn);
+    return NULL;
+}
+
+/**
+ * Multipart PUT: the file goes up in OBJM_PART_SIZE parts, one connection
+ * per worker, and the server stores each part as a chunk of the object
+ */
+static int cmd_mput(const char *uri, const char *source_path, int connections) {
+    int src_fd = open(source_path, O_RDONLY);
+    struct stat st;
+    if (src_fd < 0 || fstat(src_fd, &st) < 0) {
+        perror("open source file");
+        if (src_fd >= 0) close(src_fd);
+        return -1;
+    }
+    
+    mput_job_t job = {
+        .uri = uri,
+        .fd = src_fd,
+        .size = st.st_size,
+        .num_parts = st.st_size > 0 ? (st.st_size + OBJM_PART_SIZE - 1) / OBJM_PART_SIZE : 1
+    };
+    if (connections < 1) connections = 1;
+    if ((uint64_t)connections > job.num_parts) connections = (int)job.num_parts;
+    
+    printf("MPUT %s <- %s (%" PRIu64 " parts, %d connections)\n", uri, source_path,
+           job.num_parts, connections);
+    
+    /* The first part goes up alone: it declares the size, which starts a
+     * new version (any older, longer one loses its tail), so the others
+     * fit the new version whatever order they land in */
+    objm_connection_t *conn = client_connect(g_socket_path);
+    if (!conn) {
+        close(src_fd);
+        return -1;
+    }
+    int first = put_part(conn, &job, 0);
+    client_disconnect(conn);
+    if (first < 0) {
+        close(src_fd);
+        return -1;
+    }
+    atomic_store(&job.next_part, 1);
+    
+    pthread_t *threads = calloc(connections, sizeof(*threads));
+    int started = 0;
+    while (threads && started < connections &&
+           pthread_create(&threads[started], NULL, mput_worker, &job) == 0) {
+        started++;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    close(src_fd);
+    
+    if (started == 0 || atomic_load(&job.failed)) {
+        fprintf(stderr, "MPUT failed\n");
+        return -1;
+    }
+    printf("Wrote %" PRIu64 " bytes\n", job.size);
+    return 0;
+}
+
 /* LIST command removed - should be management API
 static int cmd_list(objm_connection_t *conn) {
     ... implementation removed ...
 }
 */
 
+/* ============================================================================
+ * Cluster Commands
+ * ============================================================================ */
+
+/**
+ * Run put/get/delete/route against a cluster of servers
+ *
+ * @param nodes Comma-separated node specs (see objm_cluster_add_node_spec())
+ */
+static int run_cluster(const char *nodes, int argc, char **argv) {
+    objm_cluster_config_t config = {
+        .remote_mode = (g_mode == OBJM_MODE_SPLICE) ? OBJM_MODE_SPLICE : OBJM_MODE_COPY
+    };
+    objm_cluster_t *cluster = objm_cluster_create(&config);
+    if (!cluster) return 1;
+    
+    char *specs = strdup(nodes);
+    char *save = NULL;
+    for (char *spec = strtok_r(specs, ",", &save); spec;
+         spec = strtok_r(NULL, ",", &save)) {
+        if (objm_cluster_add_node_spec(cluster, spec) < 0) {
+            fprintf(stderr, "Bad node spec: %s\n", spec);
+            free(specs);
+            objm_cluster_destroy(cluster);
+            return 1;
+        }
+    }
+    free(specs);
+    
+    /* A dead node must fail the request, not kill the client */
+    signal(SIGPIPE, SIG_IGN);
+    
+    const char *command = argv[0];
+    const char *uri = argc > 1 ? argv[1] : NULL;
+    int ret = 0;
+    
+    if (!uri || ((strcmp(command, "put") == 0 || strcmp(command, "get") == 0) && argc < 3)) {
+        fprintf(stderr, "Usage: -C <nodes> put|get <uri> <file> | delete|route <uri>\n");
+        objm_cluster_destroy(cluster);
+        return 1;
+    }
+    
+    int node = objm_cluster_route(cluster, uri);
+    objm_cluster_node_status_t status;
+    objm_cluster_node_status(cluster, node, &status);
+    
+    if (strcmp(command, "route") == 0) {
+        printf("%s -> %s (%s)\n", uri, status.name, status.local ? "local" : "remote");
+    } else if (strcmp(command, "put") == 0) {
+        int src_fd = open(argv[2], O_RDONLY);
+        uint64_t written = 0;
+        if (src_fd < 0) {
+            perror("open source file");
+            ret = 1;
+        } else if (objm_cluster_put(cluster, uri, src_fd, &written) < 0) {
+            fprintf(stderr, "PUT %s on %s failed: %s\n", uri, status.name, strerror(errno));
+            ret = 1;
+        } else {
+            printf("PUT %s <- %s on %s: %llu bytes\n", uri, argv[2], status.name,
+                   (unsigned long long)written);
+        }
+        if (src_fd >= 0) close(src_fd);
+    } else if (strcmp(command, "get") == 0) {
+        int fd;
+        if (objm_cluster_get(cluster, uri, &fd) < 0) {
+            fprintf(stderr, "GET %s on %s failed: %s\n", uri, status.name, strerror(errno));
+            ret = 1;
+        } else {
+            int dest_fd = open(argv[2], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            char buffer[BUFFER_SIZE];
+            off_t off = 0;
+            ssize_t n;
+            
+            if (dest_fd < 0) {
+                perror("open dest file");
+                ret = 1;
+            } else {
+                while ((n = pread(fd, buffer, sizeof(buffer), off)) > 0) {
+                    if (write(dest_fd, buffer, n) != n) {
+                        perror("write");
+                        ret = 1;
+                        break;
+                    }
+                    off += n;
+                }
+                close(dest_fd);
+                printf("GET %s -> %s from %s: %lld bytes\n", uri, argv[2], status.name,
+                       (long long)off);
+            }
+            close(fd);
+        }
+    } else if (strcmp(command, "delete") == 0) {
+        if (objm_cluster_delete(cluster, uri) < 0) {
+            fprintf(stderr, "DELETE %s on %s failed: %s\n", uri, status.name, strerror(errno));
+            ret = 1;
+        } else {
+            printf("Deleted %s on %s\n", uri, status.name);
+        }
+    } else {
+        fprintf(stderr, "Command not available in cluster mode: %s\n", command);
+        ret = 1;
+    }
+    
+    objm_cluster_destroy(cluster);
+    return ret;
+}
+
 /* ============================================================================
  * Main
  * ============================================================================ */
 
+/**
+ * Connect to the server and say hello (V2: explicit operation codes)
+ */
+static objm_connection_t *client_connect(const char *socket_path) {
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return NULL;
+    }
+    
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        fprintf(stderr, "Failed to connect to %s\n", socket_path);
+        fprintf(stderr, "Is the server running?\n");
+        close(sock);
+        return NULL;
+    }
+    
+    objm_connection_t *conn = objm_client_create(sock, OBJM_PROTO_V2);
+    if (!conn) {
+        fprintf(stderr, "Failed to create client connection\n");
+        close(sock);
+        return NULL;
+    }
+    
+    objm_hello_t hello = {
+        .capabilities = OBJM_CAP_BATCH,
+        .max_pipeline = 1,
+        .backend_parallelism = 1
+    };
+    objm_params_t params;
+    if (objm_client_hello(conn, &hello, &params) < 0) {
+        fprintf(stderr, "Handshake failed\n");
+        objm_client_destroy(conn);
+        close(sock);
+        return NULL;
+    }
+    return conn;
+}
+
+static void client_disconnect(objm_connection_t *conn) {
+    int sock = objm_get_fd(conn);
+    objm_client_close(conn, OBJM_CLOSE_NORMAL);
+    objm_client_destroy(conn);
+    close(sock);
+}
+
 static void print_usage(const char *prog) {
-    printf("Usage: %s [socket_path] <command> [args]\n", prog);
+    printf("Usage: %s [socket_path] [-m fdpass|copy|splice] <command> [args]\n", prog);
+    printf("       %s -C <node>[,<node>...] [-m copy|splice] put|get|delete|route ...\n", prog);
     printf("\nCommands:\n");
     printf("  put <uri> <file>     Upload file to URI\n");
     printf("  get <uri> <file>     Download URI to file\n");
+    printf("  range <uri> <offset> <length> <file>  Download bytes (length 0 = to the end)\n");
+    printf("  mput <uri> <file> [connections]  Upload in parallel %d MB parts\n",
+           OBJM_PART_SIZE / (1024 * 1024));
     printf("  delete <uri>         Delete object at URI\n");
+    printf("  stat <uri>           Show size, mtime, ETag and backend\n");
+    printf("  revalidate <uri> <etag>  Conditional GET: is that version current?\n");
+    printf("  mget <uri>...        Fetch several FDs in one round trip\n");
+    printf("  stats                Show server counters and stage latencies\n");
+    printf("  list [prefix]        List objects: size, mtime, backend, URI\n");
+    printf("  purge <prefix>       Delete every object under a URI prefix\n");
+    printf("  route <uri>          Cluster mode: show the node that owns URI\n");
+    printf("\nNodes: [name=]unix:/path[@weight] or [name=]tcp:host:port[@weight]\n");
     printf("\nExamples:\n");
     printf("  %s put /data/test.txt myfile.txt\n", prog);
     printf("  %s get /data/test.txt output.txt\n", prog);
     printf("  %s delete /data/test.txt\n", prog);
-    printf("\nNote: Object listing is not supported in the main protocol.\n");
-    printf("      Use a separate management API for administrative tasks.\n");
+    printf("  %s mget /data/a.txt /data/b.txt\n", prog);
+    printf("  %s -m splice get /data/test.txt output.txt\n", prog);
+    printf("  %s -C a=unix:/tmp/objmapper.sock,b=tcp:10.0.0.2:7070@2 get /data/x out\n", prog);
 }
 
 int main(int argc, char **argv) {
     const char *socket_path = DEFAULT_SOCKET_PATH;
+    const char *cluster_nodes = NULL;
     int arg_offset = 1;
     
     /* Check if first arg is socket path */
     if (argc > 1 && argv[1][0] == '/') {
         socket_path = argv[1];
         arg_offset = 2;
+    } else if (argc > 2 && strcmp(argv[1], "-C") == 0) {
+        cluster_nodes = argv[2];
+        arg_offset = 3;
+    }
+    
+    /* Transfer mode: COPY/SPLICE stream through the socket (e.g. over TCP) */
+    if (argc > arg_offset + 1 && strcmp(argv[arg_offset], "-m") == 0) {
+        const char *mode = argv[arg_offset + 1];
+        if (strcmp(mode, "fdpass") == 0) {
+            g_mode = OBJM_MODE_FDPASS;
+        } else if (strcmp(mode, "copy") == 0) {
+            g_mode = OBJM_MODE_COPY;
+        } else if (strcmp(mode, "splice") == 0) {
+            g_mode = OBJM_MODE_SPLICE;
+        } else {
+            fprintf(stderr, "Unknown mode: %s\n", mode);
+            return 1;
+        }
+        arg_offset += 2;
     }
     
     if (argc < arg_offset + 1) {
@@ -259,34 +1143,23 @@ int main(int argc, char **argv) {
     
     const char *command = argv[arg_offset];
     
-    /* Connect to server */
-    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (sock < 0) {
-        perror("socket");
-        return 1;
-    }
-    
-    struct sockaddr_un addr = {0};
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
-    
-    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        perror("connect");
-        fprintf(stderr, "Failed to connect to %s\n", socket_path);
-        fprintf(stderr, "Is the server running?\n");
-        close(sock);
-        return 1;
+    if (cluster_nodes) {
+        return run_cluster(cluster_nodes, argc - arg_offset, &argv[arg_offset]);
     }
     
-    /* Create protocol connection */
-    objm_connection_t *conn = objm_client_create(sock, OBJM_PROTO_V1);
-    if (!conn) {
-        fprintf(stderr, "Failed to create client connection\n");
-        close(sock);
-        return 1;
+    /* Multipart PUT opens its own connections */
+    g_socket_path = socket_path;
+    if (strcmp(command, "mput") == 0) {
+        if (argc < arg_offset + 3) {
+            fprintf(stderr, "Usage: mput <uri> <file> [connections]\n");
+            return 1;
+        }
+        int connections = argc > arg_offset + 3 ? atoi(argv[arg_offset + 3]) : 4;
+        return cmd_mput(argv[arg_offset + 1], argv[arg_offset + 2], connections) < 0 ? 1 : 0;
     }
     
-    /* V1 protocol - no handshake needed */
+    objm_connection_t *conn = client_connect(socket_path);
+    if (!conn) return 1;
     
     /* Execute command */
     int ret = 0;
@@ -305,6 +1178,15 @@ int main(int argc, char **argv) {
         } else {
             ret = cmd_get(conn, argv[arg_offset + 1], argv[arg_offset + 2]);
         }
+    } else if (strcmp(command, "range") == 0) {
+        if (argc < arg_offset + 5) {
+            fprintf(stderr, "Usage: range <uri> <offset> <length> <file>\n");
+            ret = 1;
+        } else {
+            ret = cmd_range(conn, argv[arg_offset + 1],
+                            strtoull(argv[arg_offset + 2], NULL, 0),
+                            strtoull(argv[arg_offset + 3], NULL, 0), argv[arg_offset + 4]);
+        }
     } else if (strcmp(command, "delete") == 0) {
         if (argc < arg_offset + 2) {
             fprintf(stderr, "Usage: delete <uri>\n");
@@ -312,21 +1194,46 @@ int main(int argc, char **argv) {
         } else {
             ret = cmd_delete(conn, argv[arg_offset + 1]);
         }
+    } else if (strcmp(command, "stat") == 0) {
+        if (argc < arg_offset + 2) {
+            fprintf(stderr, "Usage: stat <uri>\n");
+            ret = 1;
+        } else {
+            ret = cmd_stat(conn, argv[arg_offset + 1]);
+        }
+    } else if (strcmp(command, "revalidate") == 0) {
+        if (argc < arg_offset + 3) {
+            fprintf(stderr, "Usage: revalidate <uri> <etag>\n");
+            ret = 1;
+        } else {
+            ret = cmd_revalidate(conn, argv[arg_offset + 1], argv[arg_offset + 2]);
+        }
+    } else if (strcmp(command, "mget") == 0) {
+        size_t count = argc - arg_offset - 1;
+        if (count == 0 || count > OBJM_MAX_BATCH) {
+            fprintf(stderr, "Usage: mget <uri>... (up to %d)\n", OBJM_MAX_BATCH);
+            ret = 1;
+        } else {
+            ret = cmd_mget(conn, (const char *const *)&argv[arg_offset + 1], count);
+        }
+    } else if (strcmp(command, "stats") == 0) {
+        ret = cmd_report(conn, OBJM_OP_STATS, "/stats");
     } else if (strcmp(command, "list") == 0) {
-        fprintf(stderr, "LIST command disabled - use management API instead\n");
-        fprintf(stderr, "Note: Object listing should be implemented via a separate\n");
-        fprintf(stderr, "      management interface, not the main storage protocol.\n");
-        ret = 1;
+        ret = cmd_report(conn, OBJM_OP_LIST,
+                         argc > arg_offset + 1 ? argv[arg_offset + 1] : "/");
+    } else if (strcmp(command, "purge") == 0) {
+        if (argc < arg_offset + 2) {
+            fprintf(stderr, "Usage: purge <prefix>\n");
+            ret = 1;
+        } else {
+            ret = cmd_purge(conn, argv[arg_offset + 1]);
+        }
     } else {
         fprintf(stderr, "Unknown command: %s\n", command);
         print_usage(argv[0]);
         ret = 1;
     }
     
-    /* Cleanup */
-    objm_client_close(conn, OBJM_CLOSE_NORMAL);
-    objm_client_destroy(conn);
-    close(sock);
-    
+    client_disconnect(conn);
     return ret;
 }
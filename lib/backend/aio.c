@@ -0,0 +1,549 @@
+/**
+ * @file aio.c
+ * @brief io_uring engine for persistent-tier opens, stats and reads
+ *
+ * The ring is driven with raw syscalls (the uapi header is all that is
+ * needed). Submitters share the SQ under a mutex; a single reaper thread
+ * drains the CQ, chains the optional warm-up READ and runs callbacks.
+ * Every slot has at most two SQEs or CQEs outstanding, and the ring is
+ * sized for that, so neither queue can overflow.
+ */
+
+#define _GNU_SOURCE
+#include "aio.h"
+#include "chunk.h"
+#include "compress.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define AIO_MAX_DEPTH   4096
+
+/* CQE user_data: slot address with the step in the low bits (0 = wakeup) */
+#define STEP_OPEN       1
+#define STEP_STATX      2
+#define STEP_READ       3
+#define STEP_MASK       3ULL
+
+typedef struct aio_slot {
+    char path[PATH_MAX];             /* Read by the kernel at submission */
+    struct statx stx;
+    index_entry_t *entry;            /* Reference held until the callback */
+    int generation;                  /* fd_generation before the open */
+    unsigned flags;
+    int open_res;
+    int statx_res;
+    unsigned pending;                /* Outstanding CQEs (reaper only) */
+    uint64_t start_ns;
+    backend_aio_result_t result;
+    backend_aio_cb_t cb;
+    void *arg;
+    struct aio_slot *next_free;
+} aio_slot_t;
+
+struct backend_aio {
+    backend_manager_t *mgr;
+    int ring_fd;
+    
+    /* Submission queue (lock) */
+    void *sq_ring;
+    size_t sq_ring_size;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    
+    /* Completion queue (reaper) */
+    void *cq_ring;
+    size_t cq_ring_size;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+    
+    pthread_mutex_t lock;            /* SQ, free list, stop */
+    unsigned unsubmitted;            /* Queued SQEs not yet entered */
+    aio_slot_t *slots;
+    aio_slot_t *free_slots;
+    unsigned depth;
+    bool stop;
+    
+    /* Warm-up reads land here and are thrown away */
+    void *sink;
+    size_t warm_bytes;
+    bool sink_registered;
+    
+    atomic_uint in_flight;
+    pthread_t reaper;
+};
+
+/* ============================================================================
+ * Ring Plumbing
+ * ============================================================================ */
+
+static int ring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int ring_enter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                      unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                        flags, NULL, 0);
+}
+
+static int ring_register(int ring_fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void ring_unmap(backend_aio_t *aio) {
+    if (aio->sqes) munmap(aio->sqes, aio->sqes_size);
+    if (aio->cq_ring && aio->cq_ring != aio->sq_ring) {
+        munmap(aio->cq_ring, aio->cq_ring_size);
+    }
+    if (aio->sq_ring) munmap(aio->sq_ring, aio->sq_ring_size);
+}
+
+static int ring_map(backend_aio_t *aio, const struct io_uring_params *p) {
+    aio->sq_ring_size = p->sq_off.array + p->sq_entries * sizeof(unsigned);
+    aio->cq_ring_size = p->cq_off.cqes + p->cq_entries * sizeof(struct io_uring_cqe);
+    
+    bool single = (p->features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && aio->cq_ring_size > aio->sq_ring_size) {
+        aio->sq_ring_size = aio->cq_ring_size;
+    }
+    
+    aio->sq_ring = mmap(NULL, aio->sq_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, aio->ring_fd, IORING_OFF_SQ_RING);
+    if (aio->sq_ring == MAP_FAILED) {
+        aio->sq_ring = NULL;
+        return -1;
+    }
+    
+    if (single) {
+        aio->cq_ring = aio->sq_ring;
+    } else {
+        aio->cq_ring = mmap(NULL, aio->cq_ring_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, aio->ring_fd, IORING_OFF_CQ_RING);
+        if (aio->cq_ring == MAP_FAILED) {
+            aio->cq_ring = NULL;
+            return -1;
+        }
+    }
+    
+    aio->sqes_size = p->sq_entries * sizeof(struct io_uring_sqe);
+    aio->sqes = mmap(NULL, aio->sqes_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, aio->ring_fd, IORING_OFF_SQES);
+    if (aio->sqes == MAP_FAILED) {
+        aio->sqes = NULL;
+        return -1;
+    }
+    
+    char *sq = aio->sq_ring;
+    aio->sq_head = (unsigned *)(sq + p->sq_off.head);
+    aio->sq_tail = (unsigned *)(sq + p->sq_off.tail);
+    aio->sq_mask = *(unsigned *)(sq + p->sq_off.ring_mask);
+    aio->sq_entries = *(unsigned *)(sq + p->sq_off.ring_entries);
+    aio->sq_array = (unsigned *)(sq + p->sq_off.array);
+    
+    char *cq = aio->cq_ring;
+    aio->cq_head = (unsigned *)(cq + p->cq_off.head);
+    aio->cq_tail = (unsigned *)(cq + p->cq_off.tail);
+    aio->cq_mask = *(unsigned *)(cq + p->cq_off.ring_mask);
+    aio->cqes = (struct io_uring_cqe *)(cq + p->cq_off.cqes);
+    return 0;
+}
+
+/**
+ * Check the kernel knows every opcode the engine issues
+ */
+static bool ring_supports_ops(int ring_fd) {
+    size_t len = sizeof(struct io_uring_probe) +
+                 IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, len);
+    if (!probe) return false;
+    
+    bool ok = false;
+    if (ring_register(ring_fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0) {
+        static const int needed[] = {
+            IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_NOP
+        };
+        ok = true;
+        for (size_t i = 0; i < sizeof(needed) / sizeof(needed[0]); i++) {
+            if (needed[i] > probe->last_op ||
+                !(probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED)) {
+                ok = false;
+            }
+        }
+    }
+    free(probe);
+    return ok;
+}
+
+/**
+ * Claim the next SQE (lock held)
+ *
+ * @return Zeroed SQE, or NULL if the ring is full
+ */
+static struct io_uring_sqe *sqe_get_locked(backend_aio_t *aio) {
+    unsigned tail = *aio->sq_tail;
+    unsigned head = __atomic_load_n(aio->sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head >= aio->sq_entries) return NULL;
+    
+    unsigned index = tail & aio->sq_mask;
+    struct io_uring_sqe *sqe = &aio->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    aio->sq_array[index] = index;
+    return sqe;
+}
+
+/* Publish the SQE claimed last (lock held) */
+static void sqe_push_locked(backend_aio_t *aio) {
+    __atomic_store_n(aio->sq_tail, *aio->sq_tail + 1, __ATOMIC_RELEASE);
+    aio->unsubmitted++;
+}
+
+/**
+ * Hand queued SQEs to the kernel (lock held)
+ *
+ * Whatever the kernel does not take now stays queued for the next flush;
+ * the reaper flushes after every pass, so nothing is stranded.
+ */
+static void flush_locked(backend_aio_t *aio) {
+    while (aio->unsubmitted > 0) {
+        int n = ring_enter(aio->ring_fd, aio->unsubmitted, 0, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        aio->unsubmitted -= (unsigned)n;
+    }
+}
+
+/* ============================================================================
+ * Completion
+ * ============================================================================ */
+
+/**
+ * The open and the stat are back: adopt the FD and start the warm-up
+ *
+ * @return true if a READ was queued (the slot completes with it)
+ */
+static bool slot_opened(backend_aio_t *aio, aio_slot_t *slot) {
+    backend_aio_result_t *result = &slot->result;
+    
+    if (slot->open_res < 0) {
+        result->error = -slot->open_res;
+        return false;
+    }
+    
+    result->fd = global_index_adopt_fd(aio->mgr->global_index, slot->entry,
+                                       slot->open_res, slot->generation,
+                                       &result->info);
+    if (result->fd < 0) {
+        result->error = errno ? errno : EIO;
+        return false;
+    }
+    
+    result->size = (slot->statx_res == 0) ? slot->stx.stx_size : result->info.size_bytes;
+    if (!(slot->flags & BACKEND_AIO_WARM) || result->size == 0) return false;
+    
+    pthread_mutex_lock(&aio->lock);
+    struct io_uring_sqe *sqe = sqe_get_locked(aio);
+    if (sqe) {
+        sqe->opcode = aio->sink_registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd = result->fd;
+        sqe->addr = (uintptr_t)aio->sink;
+        sqe->len = (unsigned)(result->size < aio->warm_bytes ? result->size
+                                                              : aio->warm_bytes);
+        sqe->off = 0;
+        sqe->buf_index = 0;
+        sqe->user_data = (uintptr_t)slot | STEP_READ;
+        sqe_push_locked(aio);
+        slot->pending = 1;
+    }
+    pthread_mutex_unlock(&aio->lock);
+    
+    return sqe != NULL;
+}
+
+static void slot_finish(backend_aio_t *aio, aio_slot_t *slot) {
+    if (slot->result.fd >= 0) {
+        backend_info_t *backend = backend_manager_get_backend(aio->mgr,
+                                                              slot->result.info.backend_id);
+        if (backend) atomic_fetch_add(&backend->reads, 1);
+    }
+    
+    slot->cb(slot->arg, &slot->result);
+    index_entry_put(slot->entry);
+    slot->entry = NULL;
+    
+    pthread_mutex_lock(&aio->lock);
+    slot->next_free = aio->free_slots;
+    aio->free_slots = slot;
+    pthread_mutex_unlock(&aio->lock);
+    
+    atomic_fetch_sub(&aio->in_flight, 1);
+}
+
+static void slot_step_done(backend_aio_t *aio, aio_slot_t *slot, unsigned step, int res) {
+    switch (step) {
+    case STEP_OPEN:
+        slot->open_res = res;
+        slot->result.info.open_ns = monotonic_ns() - slot->start_ns;
+        break;
+    case STEP_STATX:
+        slot->statx_res = res;
+        break;
+    default:
+        break;  /* READ only warms the page cache; a short one is harmless */
+    }
+    
+    if (--slot->pending > 0) return;
+    if (step != STEP_READ && slot_opened(aio, slot)) return;
+    slot_finish(aio, slot);
+}
+
+static void *reaper_thread(void *arg) {
+    backend_aio_t *aio = arg;
+    
+    for (;;) {
+        unsigned head = *aio->cq_head;
+        unsigned tail = __atomic_load_n(aio->cq_tail, __ATOMIC_ACQUIRE);
+        
+        if (head == tail) {
+            pthread_mutex_lock(&aio->lock);
+            bool done = aio->stop && atomic_load(&aio->in_flight) == 0;
+            pthread_mutex_unlock(&aio->lock);
+            if (done) break;
+            
+            if (ring_enter(aio->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+                errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                break;
+            }
+            continue;
+        }
+        
+        for (; head != tail; head++) {
+            const struct io_uring_cqe *cqe = &aio->cqes[head & aio->cq_mask];
+            uint64_t data = cqe->user_data;
+            int res = cqe->res;
+            __atomic_store_n(aio->cq_head, head + 1, __ATOMIC_RELEASE);
+            
+            if (data == 0) continue;  /* Wakeup */
+            slot_step_done(aio, (aio_slot_t *)(uintptr_t)(data & ~STEP_MASK),
+                           (unsigned)(data & STEP_MASK), res);
+        }
+        
+        /* Warm-up READs queued by this pass go out together */
+        pthread_mutex_lock(&aio->lock);
+        flush_locked(aio);
+        pthread_mutex_unlock(&aio->lock);
+    }
+    
+    return NULL;
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+backend_aio_t *backend_aio_create(backend_manager_t *mgr, const backend_aio_config_t *config) {
+    if (!mgr) {
+        errno = EINVAL;
+        return NULL;
+    }
+    
+    unsigned depth = (config && config->depth) ? config->depth : BACKEND_AIO_DEPTH;
+    if (depth > AIO_MAX_DEPTH) depth = AIO_MAX_DEPTH;
+    depth = (unsigned)index_next_power_of_2(depth);
+    
+    backend_aio_t *aio = calloc(1, sizeof(*aio));
+    if (!aio) return NULL;
+    aio->mgr = mgr;
+    aio->depth = depth;
+    aio->warm_bytes = (config && config->warm_bytes) ? config->warm_bytes
+                                                     : BACKEND_AIO_WARM_BYTES;
+    atomic_init(&aio->in_flight, 0);
+    
+    /* Two SQEs per slot at most: OPENAT + STATX, then one READ */
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    aio->ring_fd = ring_setup(depth * 2, &params);
+    if (aio->ring_fd < 0) {
+        free(aio);
+        return NULL;
+    }
+    
+    if (!ring_supports_ops(aio->ring_fd)) {
+        close(aio->ring_fd);
+        free(aio);
+        errno = ENOSYS;
+        return NULL;
+    }
+    
+    int saved_errno = ENOMEM;
+    if (ring_map(aio, &params) < 0) {
+        saved_errno = errno;
+        goto fail;
+    }
+    
+    aio->slots = calloc(depth, sizeof(*aio->slots));
+    aio->sink = aligned_alloc(4096, (aio->warm_bytes + 4095) & ~(size_t)4095);
+    if (!aio->slots || !aio->sink) goto fail;
+    
+    for (unsigned i = 0; i < depth; i++) {
+        aio->slots[i].next_free = aio->free_slots;
+        aio->free_slots = &aio->slots[i];
+    }
+    
+    /* Pinned once, so warm-up reads skip the per-I/O page mapping */
+    struct iovec iov = { .iov_base = aio->sink, .iov_len = aio->warm_bytes };
+    aio->sink_registered = (ring_register(aio->ring_fd, IORING_REGISTER_BUFFERS,
+                                          &iov, 1) == 0);
+    
+    pthread_mutex_init(&aio->lock, NULL);
+    if (pthread_create(&aio->reaper, NULL, reaper_thread, aio) != 0) {
+        pthread_mutex_destroy(&aio->lock);
+        goto fail;
+    }
+    
+    return aio;
+    
+fail:
+    free(aio->sink);
+    free(aio->slots);
+    ring_unmap(aio);
+    close(aio->ring_fd);
+    free(aio);
+    errno = saved_errno;
+    return NULL;
+}
+
+void backend_aio_destroy(backend_aio_t *aio) {
+    if (!aio) return;
+    
+    /* Refuse new opens and wake the reaper so it notices */
+    pthread_mutex_lock(&aio->lock);
+    aio->stop = true;
+    struct io_uring_sqe *sqe = sqe_get_locked(aio);
+    if (sqe) {
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = 0;
+        sqe_push_locked(aio);
+    }
+    flush_locked(aio);
+    pthread_mutex_unlock(&aio->lock);
+    
+    pthread_join(aio->reaper, NULL);
+    
+    pthread_mutex_destroy(&aio->lock);
+    free(aio->sink);
+    free(aio->slots);
+    ring_unmap(aio);
+    close(aio->ring_fd);
+    free(aio);
+}
+
+int backend_aio_open(backend_aio_t *aio, const char *uri, unsigned flags,
+                     backend_aio_cb_t cb, void *arg) {
+    if (!aio || !uri || !cb) return -1;
+    
+    index_entry_t *entry = global_index_get_entry(aio->mgr->global_index, uri);
+    if (!entry) return -1;  /* Possibly only in an image: the sync path faults it in */
+    
+    /* Cached FDs and memory tiers are answered faster inline; compressed
+     * objects need inflating and chunked ones are read by range, which the
+     * synchronous path does */
+    backend_info_t *backend = backend_manager_get_backend(aio->mgr, entry->backend_id);
+    if (!backend || backend->type == BACKEND_TYPE_MEMORY ||
+        backend->type == BACKEND_TYPE_MEMFD || atomic_load(&entry->fd) >= 0 ||
+        index_entry_anon_fd(entry) >= 0 || backend_flags_compressed(entry->flags) ||
+        backend_flags_chunked(entry->flags)) {
+        index_entry_put(entry);
+        return -1;
+    }
+    
+    pthread_mutex_lock(&aio->lock);
+    aio_slot_t *slot = aio->stop ? NULL : aio->free_slots;
+    if (slot) aio->free_slots = slot->next_free;
+    pthread_mutex_unlock(&aio->lock);
+    
+    if (!slot) {
+        index_entry_put(entry);
+        return -1;
+    }
+    
+    /* Sampled before the path: a relocation after it leaves the FD uncached */
+    slot->generation = atomic_load(&entry->fd_generation);
+    if (index_entry_path(entry, slot->path, sizeof(slot->path)) < 0) {
+        pthread_mutex_lock(&aio->lock);
+        slot->next_free = aio->free_slots;
+        aio->free_slots = slot;
+        pthread_mutex_unlock(&aio->lock);
+        index_entry_put(entry);
+        return -1;
+    }
+    
+    slot->entry = entry;
+    slot->flags = flags;
+    slot->open_res = -EIO;
+    slot->statx_res = -EIO;
+    slot->pending = 2;
+    slot->cb = cb;
+    slot->arg = arg;
+    memset(&slot->result, 0, sizeof(slot->result));
+    slot->result.fd = -1;
+    slot->start_ns = monotonic_ns();
+    
+    pthread_mutex_lock(&aio->lock);
+    
+    /* Room is guaranteed: slots bound the SQEs outstanding */
+    struct io_uring_sqe *sqe = sqe_get_locked(aio);
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uintptr_t)slot->path;
+    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+    sqe->user_data = (uintptr_t)slot | STEP_OPEN;
+    sqe_push_locked(aio);
+    
+    sqe = sqe_get_locked(aio);
+    sqe->opcode = IORING_OP_STATX;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uintptr_t)slot->path;
+    sqe->len = STATX_SIZE | STATX_MTIME;
+    sqe->off = (uintptr_t)&slot->stx;
+    sqe->user_data = (uintptr_t)slot | STEP_STATX;
+    sqe_push_locked(aio);
+    
+    atomic_fetch_add(&aio->in_flight, 1);
+    if (!(flags & BACKEND_AIO_MORE)) flush_locked(aio);
+    
+    pthread_mutex_unlock(&aio->lock);
+    return 0;
+}
+
+void backend_aio_flush(backend_aio_t *aio) {
+    if (!aio) return;
+    
+    pthread_mutex_lock(&aio->lock);
+    flush_locked(aio);
+    pthread_mutex_unlock(&aio->lock);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file aio.h
+ * @brief io_uring engine for persistent-tier opens, stats and reads
+ *
+ * Cold objects on a disk backend cost an open() (and, for streamed
+ * replies, page cache misses) that would block the thread serving the
+ * request. The engine moves that work into one io_uring:
+ * - OPENAT and STATX of an object are submitted together, and every
+ *   request queued before a backend_aio_flush() goes in the same
+ *   io_uring_enter(), so a deep queue reaches the device in parallel
+ * - Streamed replies may ask for the head of the object to be read into
+ *   the page cache first (READ_FIXED into a registered sink buffer)
+ * - Opened descriptors are adopted by the global index FD cache, and the
+ *   completion callback runs on the engine's reaper thread
+ *
+ * Only disk-backed entries without a cached FD are taken. Everything
+ * else (cached FDs, memory tiers, compressed objects, objects not yet
+ * indexed) is refused, and the caller serves it the usual way, so
+ * memory-tier hits never queue behind disk latency.
+ */
+
+#ifndef BACKEND_AIO_H
+#define BACKEND_AIO_H
+
+#include "backend.h"
+#include <stdint.h>
+
+/* Defaults (backend_aio_config_t fields left 0) */
+#define BACKEND_AIO_DEPTH        128            /* Opens in flight */
+#define BACKEND_AIO_WARM_BYTES   (128 * 1024)   /* Head read by BACKEND_AIO_WARM */
+
+/* backend_aio_open() flags */
+#define BACKEND_AIO_WARM   (1 << 0)  /* Read the object's head before completing */
+#define BACKEND_AIO_MORE   (1 << 1)  /* More follow: wait for backend_aio_flush() */
+
+typedef struct backend_aio backend_aio_t;
+
+/**
+ * Engine settings
+ */
+typedef struct {
+    unsigned depth;                  /* Opens in flight (rounded to a power of 2) */
+    size_t warm_bytes;               /* Head read for BACKEND_AIO_WARM */
+} backend_aio_config_t;
+
+/**
+ * Completed open
+ */
+typedef struct {
+    int fd;                          /* Private read-only FD (callback owns), or -1 */
+    int error;                       /* errno of the failed step, 0 on success */
+    uint64_t size;                   /* Size reported by STATX (entry size if it failed) */
+    index_entry_info_t info;         /* Entry snapshot; open_ns = submit to open done */
+} backend_aio_result_t;
+
+/**
+ * Completion callback
+ *
+ * Runs on the reaper thread, one completion at a time: hand anything that
+ * may block (slow peers, retries through the synchronous path) elsewhere.
+ */
+typedef void (*backend_aio_cb_t)(void *arg, const backend_aio_result_t *result);
+
+/**
+ * Set up the ring and start the reaper thread
+ *
+ * @param mgr Backend manager (must outlive the engine)
+ * @param config Settings (NULL = defaults)
+ * @return Engine, or NULL with errno set (ENOSYS/EPERM: no io_uring here)
+ */
+backend_aio_t *backend_aio_create(backend_manager_t *mgr, const backend_aio_config_t *config);
+
+/**
+ * Wait for every open in flight, then stop the engine
+ *
+ * Callbacks of outstanding opens still run. Nothing may be submitted once
+ * this has been called.
+ *
+ * @param aio Engine
+ */
+void backend_aio_destroy(backend_aio_t *aio);
+
+/**
+ * Open an object through the ring
+ *
+ * @param aio Engine
+ * @param uri Object URI
+ * @param flags BACKEND_AIO_*
+ * @param cb Completion callback (called exactly once if queued)
+ * @param arg Callback argument
+ * @return 0 if queued, -1 if the object is not a cold disk object or the
+ *         engine is full (serve it synchronously instead)
+ */
+int backend_aio_open(backend_aio_t *aio, const char *uri, unsigned flags,
+                     backend_aio_cb_t cb, void *arg);
+
+/**
+ * Submit everything queued with BACKEND_AIO_MORE
+ *
+ * @param aio Engine
+ */
+void backend_aio_flush(backend_aio_t *aio);
+
+#endif /* BACKEND_AIO_H */
@@ -3,18 +3,48 @@
  * @brief Backend manager implementation
  */
 
+#define _GNU_SOURCE
 #include "backend.h"
+#include "chunk.h"
+#include "compress.h"
+#include "durable.h"
+#include "numa.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/sendfile.h>
+#include <linux/fs.h>
 #include <errno.h>
 #include <time.h>
 #include <math.h>
-#include <dirent.h>
+
+/* Caching engine defaults */
+#define CACHE_DEFAULT_SCAN_BATCH      1024
+#define CACHE_DEFAULT_MAX_MIGRATIONS  64
+#define CACHE_DEFAULT_BYTES_PER_SEC   (128ULL * 1024 * 1024)
+#define CACHE_COLD_FACTOR             0.5f    /* Drop copies below threshold * factor */
+#define CACHE_WRITE_QUIESCE_SEC       2       /* Don't copy objects still being written */
+#define CACHE_SLEEP_SLICE_US          100000  /* Bounds stop latency */
+#define CACHE_ADMIT_MIN_FREQ          2       /* Sketch estimate to enter the cache at all */
+#define CACHE_ADMIT_VICTIMS           16      /* Resident copies a full cache may displace per tick */
+#define CACHE_REBALANCE_VOTES         INDEX_NODE_VOTES_MAX  /* Reader node settled */
+
+/* Migration */
+#define MIGRATE_STAGE_NAME            ".objmapper.mig.XXXXXX"  /* Hidden from scans */
+#define MIGRATE_MAX_ATTEMPTS          3       /* Copies restarted if the source changes */
+#define MIGRATE_QUEUE_MAX             4096    /* Pending async migrations */
+
+/* Anonymous objects */
+#define ANON_NAME_MAX                 250     /* memfd_create() name limit + NUL */
+
+/* Atomic PUT */
+#define PUT_STAGE_PREFIX              ".objmapper.put."        /* Hidden from scans */
+#define PUT_MAX_ATTEMPTS              8       /* Publish retries against racing writers */
 
 /* Helper to get monotonic time in microseconds */
 static uint64_t get_monotonic_us(void) {
@@ -28,12 +58,12 @@ static int mkdir_p(const char *path) {
     char tmp[1024];
     char *p = NULL;
     size_t len;
-
+    
     snprintf(tmp, sizeof(tmp), "%s", path);
     len = strlen(tmp);
     if (tmp[len - 1] == '/')
         tmp[len - 1] = 0;
-        
+    
     for (p = tmp + 1; *p; p++) {
         if (*p == '/') {
             *p = 0;
@@ -51,6 +81,91 @@ static int mkdir_p(const char *path) {
     return 0;
 }
 
+/* Slot of a directory in the backend's cache of directories known to exist */
+static atomic_uint_fast64_t *dir_cache_slot(backend_info_t *backend, const char *dir,
+                                            size_t len, uint64_t *hash) {
+    *hash = index_hash_bytes(dir, len) | 1;  /* 0 = empty slot */
+    return &backend->dir_cache[*hash % BACKEND_DIR_CACHE_SLOTS];
+}
+
+/* mkdir -p the parent of path unless it was created (or seen) before */
+static int ensure_parent_dir(backend_info_t *backend, const char *path) {
+    const char *last_slash = strrchr(path, '/');
+    if (!last_slash || last_slash == path) return 0;
+    
+    size_t len = last_slash - path;
+    uint64_t hash;
+    atomic_uint_fast64_t *slot = dir_cache_slot(backend, path, len, &hash);
+    if (atomic_load_explicit(slot, memory_order_relaxed) == hash) return 0;
+    
+    char dir_path[1024];
+    snprintf(dir_path, sizeof(dir_path), "%.*s", (int)len, path);
+    if (mkdir_p(dir_path) < 0) return -1;
+    
+    atomic_store_explicit(slot, hash, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * Recover from a cached parent directory that was removed behind our back
+ *
+ * @return true if errno was ENOENT and the directory was recreated (retry)
+ */
+static bool parent_dir_vanished(backend_info_t *backend, const char *path) {
+    if (errno != ENOENT) return false;
+    
+    const char *last_slash = strrchr(path, '/');
+    if (!last_slash || last_slash == path) return false;
+    
+    uint64_t hash;
+    atomic_uint_fast64_t *slot = dir_cache_slot(backend, path, last_slash - path, &hash);
+    uint_fast64_t expected = hash;
+    atomic_compare_exchange_strong(slot, &expected, 0);
+    
+    return ensure_parent_dir(backend, path) == 0;
+}
+
+/* Build <mount_path><uri>, optionally creating parent directories */
+static int build_object_path(backend_info_t *backend, const char *uri,
+                             char *path, size_t path_size, bool create_parents) {
+    int n = snprintf(path, path_size, "%s%s", backend->mount_path, uri);
+    if (n < 0 || (size_t)n >= path_size) return -1;
+    
+    if (create_parents && ensure_parent_dir(backend, path) < 0) return -1;
+    
+    return 0;
+}
+
+/* Apply an object size change to backend and manager byte counts */
+static void account_size_change(backend_manager_t *mgr, backend_info_t *backend,
+                                uint64_t old_size, uint64_t new_size) {
+    if (new_size > old_size) {
+        uint64_t delta = new_size - old_size;
+        atomic_fetch_add(&backend->used_bytes, delta);
+        atomic_fetch_add(&mgr->total_bytes, delta);
+    } else if (new_size < old_size) {
+        uint64_t delta = old_size - new_size;
+        atomic_fetch_sub(&backend->used_bytes, delta);
+        atomic_fetch_sub(&mgr->total_bytes, delta);
+    }
+}
+
+/* Take both backend write locks in ID order so opposite moves can't deadlock */
+static void lock_backend_pair(backend_info_t *a, backend_info_t *b) {
+    if (a->id < b->id) {
+        pthread_rwlock_wrlock(&a->rwlock);
+        pthread_rwlock_wrlock(&b->rwlock);
+    } else {
+        pthread_rwlock_wrlock(&b->rwlock);
+        pthread_rwlock_wrlock(&a->rwlock);
+    }
+}
+
+static void unlock_backend_pair(backend_info_t *a, backend_info_t *b) {
+    pthread_rwlock_unlock(&a->rwlock);
+    pthread_rwlock_unlock(&b->rwlock);
+}
+
 /* ============================================================================
  * Backend Type Utilities
  * ============================================================================ */
@@ -62,6 +177,7 @@ const char *backend_type_name(backend_type_t type) {
         case BACKEND_TYPE_SSD:     return "ssd";
         case BACKEND_TYPE_HDD:     return "hdd";
         case BACKEND_TYPE_NETWORK: return "network";
+        case BACKEND_TYPE_MEMFD:   return "memfd";
         default:                   return "unknown";
     }
 }
@@ -73,6 +189,7 @@ double backend_default_perf_factor(backend_type_t type) {
         case BACKEND_TYPE_SSD:     return 7.5;   /* Average of 5-10 */
         case BACKEND_TYPE_HDD:     return 80.0;
         case BACKEND_TYPE_NETWORK: return 500.0;
+        case BACKEND_TYPE_MEMFD:   return 1.0;
         default:                   return 1.0;
     }
 }
@@ -111,27 +228,62 @@ backend_manager_t *backend_manager_create(size_t index_buckets, size_t max_open_
     mgr->default_backend_id = -1;
     mgr->ephemeral_backend_id = -1;
     mgr->cache_backend_id = -1;
+    for (int node = 0; node < BACKEND_NUMA_MAX_NODES; node++) {
+        mgr->numa_backends[node] = -1;
+    }
     mgr->cache_check_interval_us = 5 * 1000000; /* 5 seconds default */
     mgr->cache_threshold = 0.7; /* Cache objects with hotness > 0.7 */
+    mgr->cache_scan_batch = CACHE_DEFAULT_SCAN_BATCH;
+    mgr->cache_max_migrations = CACHE_DEFAULT_MAX_MIGRATIONS;
+    mgr->cache_max_bytes_per_sec = CACHE_DEFAULT_BYTES_PER_SEC;
+    atomic_init(&mgr->cache_promotions, 0);
+    atomic_init(&mgr->cache_evictions, 0);
+    atomic_init(&mgr->cache_bytes_moved, 0);
+    atomic_init(&mgr->cache_bytes_per_sec, 0);
+    atomic_init(&mgr->cache_rebalances, 0);
     atomic_init(&mgr->cache_running, 0);
     atomic_init(&mgr->total_objects, 0);
     atomic_init(&mgr->total_bytes, 0);
+    atomic_init(&mgr->mapped_images, 0);
+    
+    mgr->chunk_bytes = BACKEND_CHUNK_DEFAULT_BYTES;
+    pthread_mutex_init(&mgr->chunk_lock, NULL);
     
+    pthread_mutex_init(&mgr->migrate_lock, NULL);
+    pthread_cond_init(&mgr->migrate_cond, NULL);
+    pthread_cond_init(&mgr->migrate_idle, NULL);
     pthread_rwlock_init(&mgr->backends_lock, NULL);
     
     return mgr;
 }
 
+static void migrate_stop(backend_manager_t *mgr);  /* Async Migration */
+
 void backend_manager_destroy(backend_manager_t *mgr) {
     if (!mgr) return;
     
     /* Stop caching thread if running */
     backend_stop_caching(mgr);
+    migrate_stop(mgr);
+    backend_durable_stop(mgr);
+    
+    /* Clean shutdown: fold changed journals into fresh images (a backend's
+     * image may take entries from every other index, so before any goes) */
+    for (size_t i = 0; i < mgr->num_backends; i++) {
+        backend_info_t *backend = mgr->backends[i];
+        if (backend && backend->journal &&
+            (backend->journal->replayed > 0 || atomic_load(&backend->journal->appended) > 0) &&
+            backend_manager_checkpoint(mgr, (int)i) < 0) {
+            fprintf(stderr, "Backend %d: failed to write index image\n", backend->id);
+        }
+    }
     
     /* Destroy all backends */
     for (size_t i = 0; i < mgr->num_backends; i++) {
         backend_info_t *backend = mgr->backends[i];
         if (backend) {
+            index_image_close(backend->image);
+            index_journal_close(backend->journal);
             if (backend->index) {
                 backend_index_destroy(backend->index);
             }
@@ -144,6 +296,10 @@ void backend_manager_destroy(backend_manager_t *mgr) {
     
     free(mgr->backends);
     global_index_destroy(mgr->global_index);
+    pthread_cond_destroy(&mgr->migrate_idle);
+    pthread_cond_destroy(&mgr->migrate_cond);
+    pthread_mutex_destroy(&mgr->migrate_lock);
+    pthread_mutex_destroy(&mgr->chunk_lock);
     pthread_rwlock_destroy(&mgr->backends_lock);
     free(mgr);
 }
@@ -181,6 +337,7 @@ int backend_manager_register(backend_manager_t *mgr,
     backend->name = strdup(name);
     backend->flags = flags | BACKEND_FLAG_ENABLED;
     backend->capacity_bytes = capacity_bytes;
+    backend->numa_node = -1;
     
     /* Set performance characteristics */
     backend->perf_factor = backend_default_perf_factor(type);
@@ -202,13 +359,18 @@ int backend_manager_register(backend_manager_t *mgr,
     atomic_init(&backend->writes, 0);
     atomic_init(&backend->migrations_in, 0);
     atomic_init(&backend->migrations_out, 0);
+    atomic_init(&backend->local_reads, 0);
+    atomic_init(&backend->remote_reads, 0);
     
     pthread_rwlock_init(&backend->rwlock, NULL);
     
-    /* Create backend index with persistence */
+    /* Create backend index with persistence (anonymous objects die with
+     * the process, so there is nothing to persist) */
     char index_path[512];
     snprintf(index_path, sizeof(index_path), "%s/.objmapper.idx", mount_path);
-    backend->index = backend_index_create(backend->id, index_path, 256 * 1024);
+    backend->index = backend_index_create(backend->id,
+                                          type == BACKEND_TYPE_MEMFD ? NULL : index_path,
+                                          256 * 1024);
     if (!backend->index) {
         free(backend->mount_path);
         free(backend->name);
@@ -218,21 +380,17 @@ int backend_manager_register(backend_manager_t *mgr,
         return -1;
     }
     
-    /* Try to load existing index */
-    int loaded = backend_index_load(backend->index);
-    if (loaded > 0) {
-        printf("Loaded %d objects from backend %d (%s)\n", loaded, backend->id, name);
-        
-        /* Add all entries to global index */
-        /* TODO: Iterate backend index and add to global index */
-    }
-    
     mgr->backends[mgr->num_backends] = backend;
     int backend_id = mgr->num_backends;
     mgr->num_backends++;
     
     pthread_rwlock_unlock(&mgr->backends_lock);
     
+    /* Entries stored at <mount><uri> need not carry their path */
+    if (type != BACKEND_TYPE_MEMFD) {
+        global_index_set_backend_root(mgr->global_index, backend_id, mount_path);
+    }
+    
     printf("Registered backend %d: %s (%s) at %s, capacity=%lu GB\n",
            backend_id, name, backend_type_name(type), mount_path,
            capacity_bytes / (1024UL * 1024 * 1024));
@@ -291,7 +449,7 @@ int backend_manager_set_cache(backend_manager_t *mgr, int backend_id) {
     if (!backend) return -1;
     
     /* Cache backend must be memory type */
-    if (backend->type != BACKEND_TYPE_MEMORY) {
+    if (backend->type != BACKEND_TYPE_MEMORY && backend->type != BACKEND_TYPE_MEMFD) {
         return -1;
     }
     
@@ -299,468 +457,2409 @@ int backend_manager_set_cache(backend_manager_t *mgr, int backend_id) {
     return 0;
 }
 
-/* ============================================================================
- * Object Operations
- * ============================================================================ */
-
-int backend_create_object(backend_manager_t *mgr,
-                          const object_create_req_t *req,
-                          fd_ref_t *ref_out) {
-    if (!mgr || !req || !req->uri || !ref_out) return -1;
-    
-    /* Determine target backend */
-    int backend_id = req->backend_id;
-    if (backend_id < 0) {
-        /* Auto-select based on ephemeral flag */
-        backend_id = req->ephemeral ? mgr->ephemeral_backend_id : mgr->default_backend_id;
-        if (backend_id < 0) return -1;
-    }
+int backend_manager_set_numa_node(backend_manager_t *mgr, int backend_id, int node) {
+    if (!mgr || node < 0 || node >= BACKEND_NUMA_MAX_NODES) return -1;
     
     backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
-    if (!backend || !(backend->flags & BACKEND_FLAG_ENABLED)) {
-        return -1;
-    }
+    if (!backend) return -1;
     
-    /* Security check: ephemeral objects only on ephemeral backends */
-    if (req->ephemeral && !(backend->flags & BACKEND_FLAG_EPHEMERAL_ONLY)) {
+    /* Only shmem pages can be placed */
+    if (backend->type != BACKEND_TYPE_MEMORY && backend->type != BACKEND_TYPE_MEMFD) {
         return -1;
     }
     
-    pthread_rwlock_rdlock(&backend->rwlock);
+    backend_info_t *old = backend_manager_get_backend(mgr, mgr->numa_backends[node]);
+    if (old && old != backend) old->numa_node = -1;
     
-    /* Build filesystem path */
-    char fs_path[1024];
-    snprintf(fs_path, sizeof(fs_path), "%s%s", backend->mount_path, req->uri);
+    backend->numa_node = node;
+    mgr->numa_backends[node] = backend_id;
+    return 0;
+}
+
+/* Memory tier of a node, if it has one that is enabled */
+static backend_info_t *numa_tier(backend_manager_t *mgr, int node) {
+    if (node < 0 || node >= BACKEND_NUMA_MAX_NODES) return NULL;
     
-    /* Create parent directories */
-    char dir_path[1024];
-    strncpy(dir_path, fs_path, sizeof(dir_path) - 1);
-    dir_path[sizeof(dir_path) - 1] = '\0';
-    char *last_slash = strrchr(dir_path, '/');
-    if (last_slash) {
-        *last_slash = '\0';
-        if (mkdir_p(dir_path) < 0) {
-            pthread_rwlock_unlock(&backend->rwlock);
-            return -1;
-        }
+    backend_info_t *tier = backend_manager_get_backend(mgr, mgr->numa_backends[node]);
+    return (tier && (tier->flags & BACKEND_FLAG_ENABLED)) ? tier : NULL;
+}
+
+/* Where a new ephemeral object goes: the calling thread's node's tier */
+static int ephemeral_backend_id(backend_manager_t *mgr) {
+    backend_info_t *local = numa_tier(mgr, backend_numa_thread_node());
+    if (local && (local->flags & BACKEND_FLAG_EPHEMERAL_ONLY)) return local->id;
+    return mgr->ephemeral_backend_id;
+}
+
+/* Where an object is cached: the tier of the node reading it most */
+static backend_info_t *cache_target(backend_manager_t *mgr, const index_entry_t *entry) {
+    backend_info_t *local = numa_tier(mgr, index_entry_reader_node(entry, NULL));
+    if (local && (local->flags & BACKEND_FLAG_MIGRATION_DST)) return local;
+    return backend_manager_get_backend(mgr, mgr->cache_backend_id);
+}
+
+/* The cache backend or a node's memory tier */
+static bool is_cache_tier(backend_manager_t *mgr, int backend_id) {
+    if (backend_id < 0) return false;
+    if (backend_id == mgr->cache_backend_id) return true;
+    
+    backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
+    return backend && backend->numa_node >= 0 &&
+           mgr->numa_backends[backend->numa_node] == backend_id;
+}
+
+/* Prefer the backend's node for a new object file, before it is written */
+static void place_object(backend_info_t *backend, int fd) {
+    if (backend->numa_node >= 0) {
+        backend_numa_bind_fd(fd, backend->numa_node, backend->capacity_bytes);
     }
+}
+
+/* A read served from backend, split local/remote on a node's tier */
+static void count_read(backend_info_t *backend) {
+    atomic_fetch_add(&backend->reads, 1);
+    if (backend->numa_node < 0) return;
     
-    /* Create file */
-    int fd = open(fs_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
-    if (fd < 0) {
+    if (backend_numa_thread_node() == backend->numa_node) {
+        atomic_fetch_add(&backend->local_reads, 1);
+    } else {
+        atomic_fetch_add(&backend->remote_reads, 1);
+    }
+}
+
+/* ============================================================================
+ * Persistent Index
+ * ============================================================================ */
+
+#define INDEX_FILE_PREFIX   "/.objmapper."        /* Reserved URI namespace */
+#define INDEX_JOURNAL_NAME  ".objmapper.journal"
+#define CHECKPOINT_BATCH    256
+
+/* @path receives the entry's current location (the record points at it) */
+static index_image_record_t entry_record(const index_entry_t *entry,
+                                         char *path, size_t path_size) {
+    if (index_entry_path(entry, path, path_size) < 0) path[0] = '\0';
+    return (index_image_record_t){
+        .uri = entry->uri,
+        .path = path,
+        .size_bytes = entry->size_bytes,
+        .mtime = entry->mtime,
+        .flags = entry->flags,
+        .home_backend_id = entry->home_backend_id,
+    };
+}
+
+static index_entry_t *entry_from_record(const backend_info_t *backend,
+                                        const index_image_record_t *rec) {
+    index_entry_t *entry = index_entry_create(rec->uri, backend->id, rec->path);
+    if (!entry) return NULL;
+    
+    entry->size_bytes = rec->size_bytes;
+    entry->mtime = rec->mtime;
+    entry->flags = rec->flags;
+    entry->home_backend_id = rec->home_backend_id;
+    return entry;
+}
+
+/* Whether nothing on the backend outlives the machine */
+static bool backend_is_volatile(const backend_info_t *backend) {
+    return backend->type == BACKEND_TYPE_MEMORY || backend->type == BACKEND_TYPE_MEMFD;
+}
+
+/**
+ * Append to the backend's journal (a no-op until restore/checkpoint)
+ *
+ * On a persistent backend the record and the directory of the object's
+ * file are synced by the next group commit round.
+ */
+static void journal_entry(backend_manager_t *mgr, backend_info_t *backend, int op,
+                          const index_entry_t *entry) {
+    if (!backend->journal) return;
+    
+    char path[1024];
+    index_image_record_t rec = entry_record(entry, path, sizeof(path));
+    if (index_journal_append(backend->journal, op, &rec) == 0 &&
+        !backend_is_volatile(backend)) {
+        backend_durable_note(mgr, backend->journal, rec.path);
+    }
+}
+
+/**
+ * Materialize a URI from the first backend image that still holds it
+ *
+ * @return true if the URI is now in the global index
+ */
+static bool index_fault_in(backend_manager_t *mgr, const char *uri) {
+    if (atomic_load(&mgr->mapped_images) == 0) return false;
+    
+    backend_info_t *backend;
+    for (int id = 0; (backend = backend_manager_get_backend(mgr, id)) != NULL; id++) {
+        bool found = false;
+        
+        /* Checkpoints swap the image under the write lock */
+        pthread_rwlock_rdlock(&backend->rwlock);
+        index_image_record_t rec;
+        int64_t slot = backend->image ? index_image_find(backend->image, uri, &rec) : -1;
+        if (slot >= 0) {
+            index_entry_t *entry = entry_from_record(backend, &rec);
+            if (entry && global_index_insert(mgr->global_index, entry) == 0) {
+                index_image_claim(backend->image, slot);
+                backend_index_insert(backend->index, entry);
+                found = true;
+            } else if (entry) {
+                /* A concurrent fault-in won */
+                index_entry_put(entry);
+                found = true;
+            }
+        }
         pthread_rwlock_unlock(&backend->rwlock);
-        return -1;
+        
+        if (found) return true;
     }
     
-    /* Create index entry */
-    index_entry_t *entry = index_entry_create(req->uri, backend_id, fs_path);
-    if (!entry) {
-        close(fd);
-        unlink(fs_path);
+    return false;
+}
+
+/* false if no backend image can hold the URI (negative filters) */
+static bool images_may_contain(backend_manager_t *mgr, const char *uri) {
+    if (atomic_load(&mgr->mapped_images) == 0) return false;
+    
+    backend_info_t *backend;
+    for (int id = 0; (backend = backend_manager_get_backend(mgr, id)) != NULL; id++) {
+        pthread_rwlock_rdlock(&backend->rwlock);
+        bool maybe = backend->image && index_image_may_contain(backend->image, uri);
         pthread_rwlock_unlock(&backend->rwlock);
-        return -1;
+        
+        if (maybe) return true;
     }
     
-    entry->size_bytes = 0;
-    entry->flags = req->flags;
-    if (req->ephemeral) {
-        entry->flags |= INDEX_FLAG_EPHEMERAL;
-    } else {
-        entry->flags |= INDEX_FLAG_PERSISTENT;
+    return false;
+}
+
+/* Global lookup falling back to the backend images */
+static index_entry_t *lookup_entry(backend_manager_t *mgr, const char *uri) {
+    index_entry_t *entry = global_index_get_entry(mgr->global_index, uri);
+    if (!entry && index_fault_in(mgr, uri)) {
+        entry = global_index_get_entry(mgr->global_index, uri);
+    }
+    return entry;
+}
+
+typedef struct {
+    backend_manager_t *mgr;
+    backend_info_t *backend;
+    int64_t objects;                 /* Live objects after replay */
+    int64_t bytes;
+} restore_ctx_t;
+
+static void restore_record(int op, const index_image_record_t *rec, void *data) {
+    restore_ctx_t *ctx = data;
+    backend_info_t *backend = ctx->backend;
+    global_index_t *gidx = ctx->mgr->global_index;
+    
+    /* The journal supersedes whatever the image says about this URI */
+    index_image_record_t old;
+    int64_t slot = index_image_find(backend->image, rec->uri, &old);
+    if (slot >= 0 && index_image_claim(backend->image, slot)) {
+        ctx->objects--;
+        ctx->bytes -= old.size_bytes;
     }
     
-    /* Insert into global index */
-    if (global_index_insert(mgr->global_index, entry) < 0) {
+    index_entry_t *entry = global_index_get_entry(gidx, rec->uri);
+    if (entry && entry->backend_id != (uint32_t)backend->id) {
+        /* Claimed by a backend restored earlier */
         index_entry_put(entry);
-        close(fd);
-        unlink(fs_path);
-        pthread_rwlock_unlock(&backend->rwlock);
-        return -1;
+        return;
     }
     
-    /* Insert into backend index */
-    backend_index_insert(backend->index, entry);
-    
-    /* Update statistics */
-    atomic_fetch_add(&backend->object_count, 1);
-    atomic_fetch_add(&backend->writes, 1);
-    atomic_fetch_add(&mgr->total_objects, 1);
-    
-    /* Store FD in entry */
-    atomic_store(&entry->fd, fd);
-    atomic_store(&entry->fd_refcount, 1);
-    
-    /* Return reference (increment entry refcount) */
-    index_entry_get(entry);
-    ref_out->entry = entry;
-    ref_out->fd = fd;
-    ref_out->generation = 0;
-    
-    pthread_rwlock_unlock(&backend->rwlock);
-    
-    return 0;
-}
-
-int backend_get_object(backend_manager_t *mgr,
-                       const char *uri,
-                       fd_ref_t *ref_out) {
-    if (!mgr || !uri || !ref_out) return -1;
+    if (op == INDEX_JOURNAL_DEL) {
+        if (entry) {
+            ctx->objects--;
+            ctx->bytes -= entry->size_bytes;
+            backend_index_remove(backend->index, rec->uri);
+            global_index_remove(gidx, rec->uri);
+            index_entry_put(entry);
+        }
+        return;
+    }
     
-    /* Fast path: lookup in global index */
-    int ret = global_index_lookup(mgr->global_index, uri, ref_out);
-    if (ret == 0) {
-        /* Update access statistics */
-        index_entry_record_access(ref_out->entry);
-        
-        backend_info_t *backend = backend_manager_get_backend(mgr, ref_out->entry->backend_id);
-        if (backend) {
-            atomic_fetch_add(&backend->reads, 1);
+    if (entry) {
+        ctx->bytes += (int64_t)rec->size_bytes - (int64_t)entry->size_bytes;
+        entry->size_bytes = rec->size_bytes;
+        entry->mtime = rec->mtime;
+        entry->flags = rec->flags;
+        entry->home_backend_id = rec->home_backend_id;
+        char path[1024];
+        if (index_entry_path(entry, path, sizeof(path)) < 0 ||
+            strcmp(path, rec->path) != 0) {
+            global_index_update_backend(gidx, rec->uri, backend->id, rec->path);
         }
-        
-        return 0;
+        index_entry_put(entry);
+        return;
     }
     
-    /* Not found */
-    return -1;
+    entry = entry_from_record(backend, rec);
+    if (!entry) return;
+    if (global_index_insert(gidx, entry) < 0) {
+        index_entry_put(entry);
+        return;
+    }
+    backend_index_insert(backend->index, entry);
+    ctx->objects++;
+    ctx->bytes += rec->size_bytes;
 }
 
-int backend_delete_object(backend_manager_t *mgr, const char *uri) {
-    if (!mgr || !uri) return -1;
+int backend_manager_restore(backend_manager_t *mgr, int backend_id) {
+    if (!mgr) return -1;
     
-    /* Lookup object */
-    fd_ref_t ref;
-    if (global_index_lookup(mgr->global_index, uri, &ref) < 0) {
-        return -1;  /* Not found */
-    }
+    backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
+    if (!backend || !backend->index || !backend->index->index_file_path) return -1;
     
-    backend_info_t *backend = backend_manager_get_backend(mgr, ref.entry->backend_id);
-    if (!backend) {
-        fd_ref_release(&ref);
+    index_image_t *img = index_image_open(backend->index->index_file_path);
+    if (!img) return -1;
+    if (img->header->backend_id != (uint32_t)backend->id) {
+        index_image_close(img);
         return -1;
     }
     
+    char journal_path[1024];
+    snprintf(journal_path, sizeof(journal_path), "%s/%s",
+             backend->mount_path, INDEX_JOURNAL_NAME);
+    
     pthread_rwlock_wrlock(&backend->rwlock);
     
-    /* Delete from filesystem */
-    unlink(ref.entry->backend_path);
+    if (backend->image) {
+        pthread_rwlock_unlock(&backend->rwlock);
+        index_image_close(img);
+        return -1;
+    }
     
-    /* Update statistics */
-    atomic_fetch_sub(&backend->object_count, 1);
-    atomic_fetch_sub(&backend->used_bytes, ref.entry->size_bytes);
-    atomic_fetch_sub(&mgr->total_objects, 1);
-    atomic_fetch_sub(&mgr->total_bytes, ref.entry->size_bytes);
+    restore_ctx_t ctx = {
+        .mgr = mgr,
+        .backend = backend,
+        .objects = (int64_t)img->header->num_entries,
+        .bytes = (int64_t)img->header->total_bytes,
+    };
+    backend->image = img;
+    backend->image_listed = false;
+    atomic_fetch_add(&mgr->mapped_images, 1);
+    backend->index->generation = img->header->generation;
+    backend->journal = index_journal_open(journal_path, img->header->generation,
+                                          restore_record, &ctx);
+    if (!backend->journal) {
+        fprintf(stderr, "Backend %d: no journal at %s, changes will not survive a crash\n",
+                backend->id, journal_path);
+    }
     
-    /* Remove from indexes */
-    backend_index_remove(backend->index, uri);
-    global_index_remove(mgr->global_index, uri);
+    if (ctx.objects < 0) ctx.objects = 0;
+    if (ctx.bytes < 0) ctx.bytes = 0;
+    atomic_fetch_add(&backend->object_count, ctx.objects);
+    atomic_fetch_add(&backend->used_bytes, ctx.bytes);
+    atomic_fetch_add(&mgr->total_objects, ctx.objects);
+    atomic_fetch_add(&mgr->total_bytes, ctx.bytes);
     
     pthread_rwlock_unlock(&backend->rwlock);
     
-    fd_ref_release(&ref);
-    
-    return 0;
+    return (int)ctx.objects;
 }
 
-int backend_manager_scan(backend_manager_t *mgr, int backend_id) {
-    if (!mgr) return -1;
+typedef struct {
+    index_image_record_t *records;   /* Strings owned by the list */
+    size_t count;
+    size_t capacity;
+} record_list_t;
+
+static int record_list_add(record_list_t *list, const index_image_record_t *rec,
+                           const char *path) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 1024;
+        index_image_record_t *grown = realloc(list->records, capacity * sizeof(*grown));
+        if (!grown) return -1;
+        list->records = grown;
+        list->capacity = capacity;
+    }
     
-    backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
-    if (!backend || !(backend->flags & BACKEND_FLAG_ENABLED)) {
+    index_image_record_t *out = &list->records[list->count];
+    *out = *rec;
+    out->uri = strdup(rec->uri);
+    out->path = strdup(path ? path : rec->path);
+    if (!out->uri || !out->path) {
+        free((char *)out->uri);
+        free((char *)out->path);
         return -1;
     }
-    
-    /* Helper function to recursively scan directory */
-    int count = 0;
-    size_t mount_path_len = strlen(backend->mount_path);
-    
-    int scan_dir_recursive(const char *dir_path) {
-        DIR *dir = opendir(dir_path);
-        if (!dir) return 0;
+    list->count++;
+    return 0;
+}
+
+static void record_list_free(record_list_t *list) {
+    for (size_t i = 0; i < list->count; i++) {
+        free((char *)list->records[i].uri);
+        free((char *)list->records[i].path);
+    }
+    free(list->records);
+}
+
+static void checkpoint_image_record(const index_image_record_t *rec, int64_t slot,
+                                    void *data) {
+    (void)slot;
+    record_list_add(data, rec, NULL);
+}
+
+/* Add the entries of src that belong in dst's image */
+static int checkpoint_collect(backend_info_t *dst, backend_info_t *src,
+                              record_list_t *list) {
+    index_entry_t *batch[CHECKPOINT_BATCH];
+    size_t cursor = 0;
+    int ret = 0;
+    
+    do {
+        size_t n = backend_index_collect(src->index, &cursor, batch, CHECKPOINT_BATCH);
         
-        struct dirent *entry;
-        while ((entry = readdir(dir)) != NULL) {
-            /* Skip . and .. */
-            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+        for (size_t i = 0; i < n; i++) {
+            index_entry_t *entry = batch[i];
+            char entry_path[1024];
+            index_image_record_t rec = entry_record(entry, entry_path,
+                                                    sizeof(entry_path));
+            char home_path[1024];
+            const char *path = NULL;
+            
+            if (entry->flags & INDEX_FLAG_CACHED) {
+                /* Cache copies are not persisted; their home copy is */
+                if (entry->home_backend_id != (uint32_t)dst->id ||
+                    build_object_path(dst, entry->uri, home_path,
+                                      sizeof(home_path), false) < 0) {
+                    continue;
+                }
+                path = home_path;
+                rec.flags &= ~INDEX_FLAG_CACHED;
+                
+                /* The plain cache copy does not have the home copy's size */
+                if (rec.flags & INDEX_FLAG_COMPRESSED) rec.size_bytes = 0;
+            } else if (src != dst) {
                 continue;
             }
             
-            /* Build full path */
-            char full_path[2048];
-            snprintf(full_path, sizeof(full_path), "%s/%s", dir_path, entry->d_name);
-            
+            /* Sizes are learned here: FD-pass writers never report them */
             struct stat st;
-            if (stat(full_path, &st) < 0) {
-                continue;
+            if (rec.size_bytes == 0 && stat(path ? path : rec.path, &st) == 0) {
+                rec.size_bytes = st.st_size;
             }
             
-            if (S_ISDIR(st.st_mode)) {
-                /* Recursively scan subdirectory */
-                scan_dir_recursive(full_path);
-            } else if (S_ISREG(st.st_mode)) {
-                /* Regular file - create index entry */
-                /* URI is the path relative to mount point */
-                const char *uri = full_path + mount_path_len;
-                
-                /* Create index entry */
-                index_entry_t *idx_entry = index_entry_create(uri, backend_id, full_path);
-                if (idx_entry) {
-                    idx_entry->size_bytes = st.st_size;
-                    idx_entry->flags = (backend->flags & BACKEND_FLAG_EPHEMERAL_ONLY) ? 
-                                       INDEX_FLAG_EPHEMERAL : INDEX_FLAG_PERSISTENT;
-                    
-                    /* Insert into global index */
-                    if (global_index_insert(mgr->global_index, idx_entry) >= 0) {
-                        /* Also insert into backend index */
-                        backend_index_insert(backend->index, idx_entry);
-                        count++;
-                        
-                        /* Update statistics */
-                        atomic_fetch_add(&backend->object_count, 1);
-                        atomic_fetch_add(&backend->used_bytes, st.st_size);
-                        atomic_fetch_add(&mgr->total_objects, 1);
-                        atomic_fetch_add(&mgr->total_bytes, st.st_size);
-                    }
-                    
-                    index_entry_put(idx_entry);  /* Release our reference */
-                }
-            }
+            if (ret == 0 && record_list_add(list, &rec, path) < 0) ret = -1;
         }
         
-        closedir(dir);
-        return 0;
-    }
-    
-    pthread_rwlock_wrlock(&backend->rwlock);
-    scan_dir_recursive(backend->mount_path);
-    pthread_rwlock_unlock(&backend->rwlock);
+        for (size_t i = 0; i < n; i++) {
+            index_entry_put(batch[i]);
+        }
+    } while (cursor != 0);
     
-    return count;
+    return ret;
 }
 
-int backend_get_metadata(backend_manager_t *mgr,
-                         const char *uri,
-                         object_metadata_t *metadata_out) {
-    if (!mgr || !uri || !metadata_out) return -1;
-    
-    fd_ref_t ref;
-    if (global_index_lookup(mgr->global_index, uri, &ref) < 0) {
-        return -1;
+/* Caller holds the write lock of backend */
+static int checkpoint_locked(backend_manager_t *mgr, backend_info_t *backend) {
+    record_list_t list = {0};
+    
+    backend_info_t *src;
+    for (int id = 0; (src = backend_manager_get_backend(mgr, id)) != NULL; id++) {
+        if (src->index && checkpoint_collect(backend, src, &list) < 0) {
+            record_list_free(&list);
+            return -1;
+        }
     }
     
-    index_entry_t *entry = ref.entry;
+    /* Objects never faulted in are carried over from the current image */
+    size_t resident = list.count;
+    if (backend->image) {
+        index_image_foreach(backend->image, checkpoint_image_record, &list);
+    }
+    
+    uint64_t generation = backend->index->generation + 1;
+    if (index_image_write(backend->index->index_file_path, backend->id,
+                          generation, list.records, list.count) < 0) {
+        record_list_free(&list);
+        return -1;
+    }
+    backend->index->generation = generation;
+    
+    /* The new image is durable and covers everything journaled so far */
+    if (!backend->journal) {
+        char journal_path[1024];
+        snprintf(journal_path, sizeof(journal_path), "%s/%s",
+                 backend->mount_path, INDEX_JOURNAL_NAME);
+        backend->journal = index_journal_open(journal_path, generation, NULL, NULL);
+    }
+    int ret = backend->journal ? index_journal_reset(backend->journal, generation) : -1;
+    
+    /* Keep faulting in the carried-over objects from the new image */
+    index_image_t *old = backend->image;
+    backend->image = NULL;
+    if (list.count > resident) {
+        backend->image = index_image_open(backend->index->index_file_path);
+        for (size_t i = 0; backend->image && i < resident; i++) {
+            index_image_claim(backend->image,
+                              index_image_find(backend->image, list.records[i].uri, NULL));
+        }
+    }
+    index_image_close(old);
+    atomic_fetch_add(&mgr->mapped_images, (backend->image != NULL) - (old != NULL));
+    
+    record_list_free(&list);
+    return ret;
+}
+
+int backend_manager_checkpoint(backend_manager_t *mgr, int backend_id) {
+    if (!mgr) return -1;
+    
+    backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
+    if (!backend || !backend->index || !backend->index->index_file_path) return -1;
+    
+    pthread_rwlock_wrlock(&backend->rwlock);
+    int ret = checkpoint_locked(mgr, backend);
+    pthread_rwlock_unlock(&backend->rwlock);
+    
+    return ret;
+}
+
+/* ============================================================================
+ * Object Operations
+ * ============================================================================ */
+
+/* Create a sealable anonymous file, named after the URI for /proc readers
+ * (placed on backend's node, if given) */
+static int anon_object_open(backend_info_t *backend, const char *uri, size_t size_hint) {
+    char name[ANON_NAME_MAX];
+    snprintf(name, sizeof(name), "objmapper:%s", uri);
+    
+    int fd = memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) return -1;
+    if (backend) place_object(backend, fd);
+    
+    /* Reserve the pages up front; the size stays 0 for the writer */
+    if (size_hint > 0 && fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size_hint) < 0 &&
+        errno == ENOSPC) {
+        close(fd);
+        return -1;
+    }
+    
+    return fd;
+}
+
+/* Give back blocks preallocated past the end of the data. Block
+ * filesystems trim them on truncate and ignore holes past EOF; shmem is
+ * the other way around. */
+static void release_preallocation(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (off_t)st.st_blocks * 512 <= st.st_size) return;
+    
+    if (ftruncate(fd, st.st_size) == 0 && fstat(fd, &st) == 0 &&
+        (off_t)st.st_blocks * 512 <= st.st_size) {
+        return;
+    }
+    fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+              st.st_size, (off_t)st.st_blocks * 512);
+}
+
+/**
+ * Seal a memfd's contents
+ *
+ * Unused preallocation is released first. Afterwards every descriptor of
+ * the object, writers included, is read-only and readers may share it.
+ * Fails with EBUSY while a writable shared mapping exists.
+ */
+static int anon_fd_seal(int fd) {
+    release_preallocation(fd);
+    return fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW |
+                                  F_SEAL_WRITE | F_SEAL_SEAL);
+}
+
+/* Seal an anonymous object (caller holds the backend write lock) */
+static int anon_object_seal(index_entry_t *entry, int fd) {
+    if (anon_fd_seal(fd) < 0) return -1;
+    
+    entry->flags |= INDEX_FLAG_SEALED;
+    return 0;
+}
+
+/**
+ * Create an anonymous object on a memfd backend
+ *
+ * The memfd is the object: it is allocated before the URI is claimed
+ * (a duplicate just closes it again), no path or directory is built and
+ * nothing is journaled. The writer gets its own descriptor of the file.
+ */
+static int create_anon_object(backend_manager_t *mgr, backend_info_t *backend,
+                              const object_create_req_t *req,
+                              fd_ref_t *ref_out, bool *exists) {
+    int anon_fd = anon_object_open(backend, req->uri, req->size_hint);
+    if (anon_fd < 0) return -1;
+    
+    index_entry_t *entry = index_entry_create_anon(req->uri, backend->id, anon_fd);
+    if (!entry) return -1;
+    
+    entry->size_bytes = 0;
+    entry->flags = (req->flags & ~INDEX_FLAG_COMPRESSED) | INDEX_FLAG_UNSETTLED;
+    entry->flags |= req->ephemeral ? INDEX_FLAG_EPHEMERAL : INDEX_FLAG_PERSISTENT;
+    
+    int fd = fcntl(anon_fd, F_DUPFD_CLOEXEC, 0);
+    if (fd < 0) {
+        index_entry_put(entry);
+        return -1;
+    }
+    
+    pthread_rwlock_rdlock(&backend->rwlock);
+    
+    if (global_index_insert(mgr->global_index, entry) < 0) {
+        pthread_rwlock_unlock(&backend->rwlock);
+        index_entry_put(entry);
+        close(fd);
+        *exists = true;
+        return -1;
+    }
+    
+    backend_index_insert(backend->index, entry);
+    
+    atomic_fetch_add(&backend->object_count, 1);
+    atomic_fetch_add(&backend->writes, 1);
+    atomic_fetch_add(&mgr->total_objects, 1);
+    
+    index_entry_get(entry);
+    ref_out->entry = entry;
+    ref_out->fd = fd;
+    ref_out->generation = atomic_load(&entry->fd_generation);
+    ref_out->idx = NULL;
+    
+    pthread_rwlock_unlock(&backend->rwlock);
+    
+    return 0;
+}
+
+/**
+ * Create one object (sets *exists when the URI is already indexed)
+ */
+static int create_object(backend_manager_t *mgr, const object_create_req_t *req,
+                         fd_ref_t *ref_out, bool *exists) {
+    *exists = false;
+    
+    /* Index files share the mount with objects */
+    if (strncmp(req->uri, INDEX_FILE_PREFIX, strlen(INDEX_FILE_PREFIX)) == 0) {
+        return -1;
+    }
+    
+    /* An object still only in an image must be seen as a duplicate */
+    index_fault_in(mgr, req->uri);
+    
+    /* Determine target backend */
+    int backend_id = req->backend_id;
+    if (backend_id < 0) {
+        /* Auto-select based on ephemeral flag */
+        backend_id = req->ephemeral ? ephemeral_backend_id(mgr) : mgr->default_backend_id;
+        if (backend_id < 0) return -1;
+    }
+    
+    backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
+    if (!backend || !(backend->flags & BACKEND_FLAG_ENABLED)) {
+        return -1;
+    }
+    
+    /* Security check: ephemeral objects only on ephemeral backends */
+    if (req->ephemeral && !(backend->flags & BACKEND_FLAG_EPHEMERAL_ONLY)) {
+        return -1;
+    }
+    
+    if (backend->type == BACKEND_TYPE_MEMFD) {
+        return create_anon_object(mgr, backend, req, ref_out, exists);
+    }
+    
+    pthread_rwlock_rdlock(&backend->rwlock);
+    
+    /* Build filesystem path and create parent directories */
+    char fs_path[1024];
+    if (build_object_path(backend, req->uri, fs_path, sizeof(fs_path), true) < 0) {
+        pthread_rwlock_unlock(&backend->rwlock);
+        return -1;
+    }
+    
+    /* Create index entry */
+    index_entry_t *entry = index_entry_create(req->uri, backend_id, fs_path);
+    if (!entry) {
+        pthread_rwlock_unlock(&backend->rwlock);
+        return -1;
+    }
+    
+    entry->size_bytes = 0;
+    /* Writers write plain bytes, and the size is theirs to report */
+    entry->flags = (req->flags & ~INDEX_FLAG_COMPRESSED) | INDEX_FLAG_UNSETTLED;
+    if (req->ephemeral) {
+        entry->flags |= INDEX_FLAG_EPHEMERAL;
+    } else {
+        entry->flags |= INDEX_FLAG_PERSISTENT;
+    }
+    
+    /* Claim the URI before touching the file: a duplicate must not
+     * truncate the existing object's data */
+    if (global_index_insert(mgr->global_index, entry) < 0) {
+        index_entry_put(entry);
+        pthread_rwlock_unlock(&backend->rwlock);
+        *exists = true;
+        return -1;
+    }
+    
+    /* Create file */
+    int fd = open(fs_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 && parent_dir_vanished(backend, fs_path)) {
+        fd = open(fs_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    }
+    if (fd < 0) {
+        global_index_remove(mgr->global_index, req->uri);
+        pthread_rwlock_unlock(&backend->rwlock);
+        return -1;
+    }
+    place_object(backend, fd);
+    
+    /* Insert into backend index */
+    backend_index_insert(backend->index, entry);
+    journal_entry(mgr, backend, INDEX_JOURNAL_PUT, entry);
+    
+    /* Update statistics */
+    atomic_fetch_add(&backend->object_count, 1);
+    atomic_fetch_add(&backend->writes, 1);
+    atomic_fetch_add(&mgr->total_objects, 1);
+    
+    /* Return reference with the private O_RDWR writer FD; the shared
+     * read-only FD cache is populated by the first lookup */
+    index_entry_get(entry);
+    ref_out->entry = entry;
+    ref_out->fd = fd;
+    ref_out->generation = atomic_load(&entry->fd_generation);
+    ref_out->idx = NULL;
+    
+    pthread_rwlock_unlock(&backend->rwlock);
+    
+    return 0;
+}
+
+int backend_create_object(backend_manager_t *mgr,
+                          const object_create_req_t *req,
+                          fd_ref_t *ref_out) {
+    if (!mgr || !req || !req->uri || !ref_out) return -1;
+    
+    bool exists;
+    int ret = create_object(mgr, req, ref_out, &exists);
+    if (ret < 0 && exists && req->replace) {
+        /* Only an overwrite pays for the delete */
+        backend_delete_object(mgr, req->uri);
+        ret = create_object(mgr, req, ref_out, &exists);
+    }
+    return ret;
+}
+
+int backend_get_object(backend_manager_t *mgr,
+                       const char *uri,
+                       fd_ref_t *ref_out) {
+    if (!mgr || !uri || !ref_out) return -1;
+    
+    /* Fast path: lookup in global index */
+    int ret = global_index_lookup(mgr->global_index, uri, ref_out);
+    if (ret < 0 && index_fault_in(mgr, uri)) {
+        ret = global_index_lookup(mgr->global_index, uri, ref_out);
+    }
+    if (ret == 0) {
+        /* The lookup already recorded the access */
+        backend_info_t *backend = backend_manager_get_backend(mgr, ref_out->entry->backend_id);
+        if (backend) {
+            count_read(backend);
+        }
+        
+        return 0;
+    }
+    
+    /* Not found */
+    return -1;
+}
+
+int backend_get_stored_fd(backend_manager_t *mgr,
+                          const char *uri,
+                          index_entry_info_t *info_out) {
+    if (!mgr || !uri) return -1;
+    
+    index_entry_info_t info;
+    int fd = global_index_lookup_fd(mgr->global_index, uri, &info);
+    if (fd < 0 && index_fault_in(mgr, uri)) {
+        fd = global_index_lookup_fd(mgr->global_index, uri, &info);
+    }
+    if (fd < 0) return -1;
+    
+    backend_info_t *backend = backend_manager_get_backend(mgr, info.backend_id);
+    if (backend) {
+        count_read(backend);
+    }
+    
+    if (info_out) *info_out = info;
+    return fd;
+}
+
+int backend_stat_object(backend_manager_t *mgr,
+                        const char *uri,
+                        index_entry_info_t *info_out) {
+    if (!mgr || !uri || !info_out) return -1;
+    
+    if (global_index_lookup_info(mgr->global_index, uri, info_out) < 0 &&
+        (!index_fault_in(mgr, uri) ||
+         global_index_lookup_info(mgr->global_index, uri, info_out) < 0)) {
+        return -1;
+    }
+    
+    /* The size of a chunked object is in its manifest */
+    if (backend_flags_chunked(info_out->flags)) {
+        uint64_t size;
+        if (backend_chunk_manifest(mgr, uri, NULL, &size) < 0) return -1;
+        info_out->size_bytes = size;
+    }
+    return 0;
+}
+
+/**
+ * Trade the FD of a compressed object for one that reads plain bytes
+ *
+ * Promoting the object into the cache backend inflates it once for every
+ * reader that follows. Where that is refused (no cache backend, no room,
+ * the object changed meanwhile) this reader gets a private inflated memfd.
+ */
+static int plain_object_fd(backend_manager_t *mgr, const char *uri, int fd,
+                           index_entry_info_t *info) {
+    if (backend_cache_object(mgr, uri) == 0) {
+        index_entry_info_t cached;
+        int cached_fd = global_index_lookup_fd(mgr->global_index, uri, &cached);
+        if (cached_fd >= 0 && !backend_flags_compressed(cached.flags)) {
+            close(fd);
+            *info = cached;
+            return cached_fd;
+        }
+        if (cached_fd >= 0) close(cached_fd);
+    }
+    
+    uint64_t size;
+    int anon_fd = -1;
+    if (backend_compressed_size(fd, &size) == 0 &&
+        (anon_fd = anon_object_open(NULL, uri, size)) >= 0 &&
+        (backend_decompress_fd(fd, anon_fd, NULL) < 0 || anon_fd_seal(anon_fd) < 0)) {
+        close(anon_fd);
+        anon_fd = -1;
+    }
+    close(fd);
+    
+    if (anon_fd >= 0) info->size_bytes = size;
+    return anon_fd;
+}
+
+int backend_get_object_fd(backend_manager_t *mgr,
+                          const char *uri,
+                          index_entry_info_t *info_out) {
+    index_entry_info_t info;
+    int fd = backend_get_stored_fd(mgr, uri, &info);
+    if (fd >= 0 && backend_flags_chunked(info.flags)) {
+        /* No one FD holds it: read it by range */
+        close(fd);
+        errno = EISDIR;
+        return -1;
+    }
+    if (fd >= 0 && backend_flags_compressed(info.flags)) {
+        fd = plain_object_fd(mgr, uri, fd, &info);
+    }
+    
+    if (fd >= 0 && info_out) *info_out = info;
+    return fd;
+}
+
+int backend_get_or_create_object_fd(backend_manager_t *mgr,
+                                    const object_create_req_t *req,
+                                    bool *created) {
+    if (!mgr || !req || !req->uri || !created) return -1;
+    
+    *created = false;
+    
+    /* Common case: one probe that also yields the cached FD */
+    int fd = backend_get_object_fd(mgr, req->uri, NULL);
+    if (fd >= 0) return fd;
+    
+    object_create_req_t create_req = *req;
+    create_req.replace = false;
+    
+    fd_ref_t ref;
+    bool exists;
+    if (create_object(mgr, &create_req, &ref, &exists) == 0) {
+        /* Hand the writer FD to the caller, drop only the entry reference */
+        fd = ref.fd;
+        ref.fd = -1;
+        fd_ref_release(&ref);
+        *created = true;
+        return fd;
+    }
+    
+    /* Lost a race with another creator: it is a GET after all */
+    return exists ? backend_get_object_fd(mgr, req->uri, NULL) : -1;
+}
+
+bool backend_object_is_fast(backend_manager_t *mgr, const char *uri) {
+    if (!mgr || !uri) return true;
+    
+    /* Never fault in here: an object only in an image is on disk */
+    index_entry_t *entry = global_index_get_entry(mgr->global_index, uri);
+    if (!entry) return !images_may_contain(mgr, uri);  /* Definite misses are fast */
+    
+    /* A compressed object is inflated on the way out; a chunked one is
+     * read chunk by chunk */
+    bool compressed = backend_flags_compressed(entry->flags) ||
+                      backend_flags_chunked(entry->flags);
+    bool fast = !compressed && atomic_load(&entry->fd) >= 0;
+    if (!fast && !compressed) {
+        backend_info_t *backend = backend_manager_get_backend(mgr, entry->backend_id);
+        fast = backend && (backend->type == BACKEND_TYPE_MEMORY ||
+                           backend->type == BACKEND_TYPE_MEMFD);
+    }
+    
+    index_entry_put(entry);
+    return fast;
+}
+
+/* Delete one entry (a manifest, but not its chunks) */
+static int delete_entry(backend_manager_t *mgr, const char *uri) {
+    /* Lookup object */
+    index_entry_t *entry = lookup_entry(mgr, uri);
+    if (!entry) {
+        return -1;  /* Not found */
+    }
+    
+    /* Lock where the entry lives (and its home, for cache copies); retry if
+     * the caching thread moved it before we got the locks */
+    backend_info_t *backend, *home;
+    for (;;) {
+        uint32_t backend_id = entry->backend_id;
+        uint32_t home_id = entry->home_backend_id;
+        
+        backend = backend_manager_get_backend(mgr, backend_id);
+        home = backend_manager_get_backend(mgr, home_id);
+        if (!backend || !home) {
+            index_entry_put(entry);
+            return -1;
+        }
+        
+        if (backend == home) {
+            pthread_rwlock_wrlock(&backend->rwlock);
+        } else {
+            lock_backend_pair(backend, home);
+        }
+        
+        if (entry->backend_id == backend_id && entry->home_backend_id == home_id) {
+            break;
+        }
+        
+        if (backend == home) {
+            pthread_rwlock_unlock(&backend->rwlock);
+        } else {
+            unlock_backend_pair(backend, home);
+        }
+    }
+    
+    /* Delete from filesystem, including a retained home copy; an anonymous
+     * object goes away with its last descriptor */
+    char path[1024];
+    if (index_entry_anon_fd(entry) < 0 &&
+        index_entry_path(entry, path, sizeof(path)) == 0) {
+        unlink(path);
+    }
+    uint64_t home_bytes = entry->size_bytes;  /* A compressed home copy is smaller */
+    if (entry->flags & INDEX_FLAG_CACHED) {
+        char home_path[1024];
+        if (build_object_path(home, uri, home_path, sizeof(home_path), false) == 0) {
+            struct stat st;
+            if ((entry->flags & INDEX_FLAG_COMPRESSED) && stat(home_path, &st) == 0) {
+                home_bytes = st.st_size;
+            }
+            unlink(home_path);
+        }
+        atomic_fetch_sub(&home->object_count, 1);
+        atomic_fetch_sub(&home->used_bytes, home_bytes);
+    }
+    
+    /* Update statistics */
+    atomic_fetch_sub(&backend->object_count, 1);
+    atomic_fetch_sub(&backend->used_bytes, entry->size_bytes);
+    atomic_fetch_sub(&mgr->total_objects, 1);
+    atomic_fetch_sub(&mgr->total_bytes, home_bytes);
+    
+    /* Remove from indexes */
+    backend_index_remove(backend->index, uri);
+    global_index_remove(mgr->global_index, uri);
+    journal_entry(mgr, backend, INDEX_JOURNAL_DEL, entry);
+    if (backend != home) {
+        journal_entry(mgr, home, INDEX_JOURNAL_DEL, entry);
+    }
+    
+    if (backend == home) {
+        pthread_rwlock_unlock(&backend->rwlock);
+    } else {
+        unlock_backend_pair(backend, home);
+    }
+    
+    index_entry_put(entry);
+    
+    return 0;
+}
+
+int backend_delete_object(backend_manager_t *mgr, const char *uri) {
+    if (!mgr || !uri) return -1;
+    
+    uint64_t chunk_bytes, size;
+    bool chunked = backend_chunk_manifest(mgr, uri, &chunk_bytes, &size) == 0;
+    if (delete_entry(mgr, uri) < 0) return -1;
+    
+    if (chunked) backend_chunk_drop(mgr, uri, chunk_bytes, 0, size);
+    return 0;
+}
+
+int backend_manager_scan(backend_manager_t *mgr, int backend_id) {
+    if (!mgr) return -1;
+    
+    backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
+    if (!backend || !(backend->flags & BACKEND_FLAG_ENABLED)) {
+        return -1;
+    }
+    
+    /* Nothing outlives the process on a memfd backend */
+    if (backend->type == BACKEND_TYPE_MEMFD) return 0;
+    
+    index_scan_opts_t opts = {
+        .global = mgr->global_index,
+        .entry_flags = (backend->flags & BACKEND_FLAG_EPHEMERAL_ONLY) ?
+                       INDEX_FLAG_EPHEMERAL : INDEX_FLAG_PERSISTENT,
+        .skip_prefix = INDEX_FILE_PREFIX + 1,  /* The index files */
+    };
+    
+    pthread_rwlock_wrlock(&backend->rwlock);
+    int count = backend_index_scan_parallel(backend->index, backend->mount_path, &opts);
+    pthread_rwlock_unlock(&backend->rwlock);
+    
+    if (count > 0) {
+        atomic_fetch_add(&backend->object_count, count);
+        atomic_fetch_add(&backend->used_bytes, opts.bytes_indexed);
+        atomic_fetch_add(&mgr->total_objects, count);
+        atomic_fetch_add(&mgr->total_bytes, opts.bytes_indexed);
+    }
+    
+    return count;
+}
+
+int backend_get_metadata(backend_manager_t *mgr,
+                         const char *uri,
+                         object_metadata_t *metadata_out) {
+    if (!mgr || !uri || !metadata_out) return -1;
+    
+    index_entry_t *entry = lookup_entry(mgr, uri);
+    if (!entry) {
+        return -1;
+    }
     
     metadata_out->uri = strdup(entry->uri);
     metadata_out->backend_id = entry->backend_id;
-    metadata_out->fs_path = strdup(entry->backend_path);
+    char path[1024];
+    metadata_out->fs_path = (index_entry_path(entry, path, sizeof(path)) == 0)
+                          ? strdup(path) : NULL;
     metadata_out->size_bytes = entry->size_bytes;
     metadata_out->mtime = entry->mtime;
     metadata_out->flags = entry->flags;
     metadata_out->hotness = entry->hotness_score;
     metadata_out->access_count = atomic_load(&entry->access_count);
     
-    fd_ref_release(&ref);
+    index_entry_put(entry);
+    
+    return 0;
+}
+
+int backend_update_size(backend_manager_t *mgr,
+                        const char *uri,
+                        size_t new_size) {
+    if (!mgr || !uri) return -1;
+    
+    index_entry_t *entry = lookup_entry(mgr, uri);
+    if (!entry) {
+        return -1;
+    }
+    
+    backend_info_t *backend = backend_manager_get_backend(mgr, entry->backend_id);
+    if (!backend) {
+        index_entry_put(entry);
+        return -1;
+    }
+    
+    /* Update size difference; the index now describes the object */
+    account_size_change(mgr, backend, entry->size_bytes, new_size);
+    entry->size_bytes = new_size;
+    if (entry->flags & INDEX_FLAG_UNSETTLED) {
+        entry->mtime = time(NULL);
+        entry->flags &= ~INDEX_FLAG_UNSETTLED;
+    }
+    if (!(entry->flags & INDEX_FLAG_CACHED)) {
+        journal_entry(mgr, backend, INDEX_JOURNAL_PUT, entry);
+    }
+    
+    /* The writer reports its size when it is done: freeze the contents */
+    int anon_fd = index_entry_anon_fd(entry);
+    if (anon_fd >= 0 && !(entry->flags & INDEX_FLAG_SEALED)) {
+        pthread_rwlock_wrlock(&backend->rwlock);
+        if (index_entry_anon_fd(entry) == anon_fd) {
+            anon_object_seal(entry, anon_fd);
+        }
+        pthread_rwlock_unlock(&backend->rwlock);
+    }
+    
+    index_entry_put(entry);
+    
+    return 0;
+}
+
+void object_metadata_free(object_metadata_t *metadata) {
+    if (!metadata) return;
+    free(metadata->uri);
+    free(metadata->fs_path);
+    memset(metadata, 0, sizeof(*metadata));
+}
+
+/* ============================================================================
+ * Atomic PUT
+ * ============================================================================ */
+
+static int cache_demote(backend_manager_t *mgr, index_entry_t *entry,
+                        uint64_t *bytes_out);  /* Migration */
+
+static atomic_uint g_put_seq;
+
+/* Where a PUT writes: an existing object is rewritten on its home backend */
+static backend_info_t *put_target(backend_manager_t *mgr, const object_create_req_t *req) {
+    int backend_id = req->backend_id;
+    if (backend_id < 0) {
+        index_entry_t *entry = lookup_entry(mgr, req->uri);
+        if (entry) {
+            if (((entry->flags & INDEX_FLAG_EPHEMERAL) != 0) == req->ephemeral) {
+                backend_id = entry->home_backend_id;
+            }
+            index_entry_put(entry);
+        }
+    }
+    if (backend_id < 0) {
+        backend_id = req->ephemeral ? ephemeral_backend_id(mgr) : mgr->default_backend_id;
+    }
+    
+    backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
+    if (!backend || !(backend->flags & BACKEND_FLAG_ENABLED)) return NULL;
+    
+    /* Security check: ephemeral objects only on ephemeral backends */
+    if (req->ephemeral && !(backend->flags & BACKEND_FLAG_EPHEMERAL_ONLY)) return NULL;
+    
+    return backend;
+}
+
+/**
+ * Open an unnamed inode in the directory of path: invisible until linked
+ *
+ * Filesystems without O_TMPFILE get a hidden named staging file instead,
+ * returned in *stage_path.
+ */
+static int put_stage_open(backend_info_t *backend, char *path, char **stage_path) {
+    char *last_slash = strrchr(path, '/');
+    *last_slash = '\0';
+    int fd = open(path, O_TMPFILE | O_RDWR | O_CLOEXEC, 0644);
+    *last_slash = '/';
+    if (fd < 0 && parent_dir_vanished(backend, path)) {
+        *last_slash = '\0';
+        fd = open(path, O_TMPFILE | O_RDWR | O_CLOEXEC, 0644);
+        *last_slash = '/';
+    }
+    
+    if (fd < 0 && (errno == EOPNOTSUPP || errno == EISDIR || errno == EINVAL)) {
+        char stage[1024];
+        if (snprintf(stage, sizeof(stage), "%.*s/" PUT_STAGE_PREFIX "XXXXXX",
+                     (int)(last_slash - path), path) >= (int)sizeof(stage)) {
+            return -1;
+        }
+        fd = mkostemp(stage, O_CLOEXEC);
+        if (fd < 0) return -1;
+        
+        fchmod(fd, 0644);
+        *stage_path = strdup(stage);
+        if (!*stage_path) {
+            unlink(stage);
+            close(fd);
+            return -1;
+        }
+    }
+    
+    return fd;
+}
+
+int backend_put_begin(backend_manager_t *mgr, const object_create_req_t *req,
+                      object_put_t *put) {
+    if (!mgr || !req || !req->uri || !put) return -1;
+    
+    memset(put, 0, sizeof(*put));
+    put->fd = -1;
+    
+    /* Index files share the mount with objects */
+    if (strncmp(req->uri, INDEX_FILE_PREFIX, strlen(INDEX_FILE_PREFIX)) == 0) {
+        return -1;
+    }
+    
+    /* An object still only in an image is an overwrite */
+    index_fault_in(mgr, req->uri);
+    
+    backend_info_t *backend = put_target(mgr, req);
+    if (!backend) return -1;
+    
+    put->uri = strdup(req->uri);
+    if (!put->uri) return -1;
+    put->backend_id = backend->id;
+    put->flags = (req->flags & ~(INDEX_FLAG_COMPRESSED | INDEX_FLAG_UNSETTLED)) |
+                 (req->ephemeral ? INDEX_FLAG_EPHEMERAL : INDEX_FLAG_PERSISTENT);
+    
+    if (backend->type == BACKEND_TYPE_MEMFD) {
+        put->fd = anon_object_open(backend, req->uri, req->size_hint);
+        if (put->fd < 0) goto fail;
+        return 0;
+    }
+    
+    char path[1024];
+    if (build_object_path(backend, req->uri, path, sizeof(path), true) < 0) goto fail;
+    
+    put->fd = put_stage_open(backend, path, &put->stage_path);
+    if (put->fd < 0) goto fail;
+    place_object(backend, put->fd);
+    
+    /* Allocate the whole object up front (one extent where the filesystem
+     * can); the size stays 0 until the data is written */
+    if (req->size_hint > 0) {
+        fallocate(put->fd, FALLOC_FL_KEEP_SIZE, 0, req->size_hint);
+    }
     
     return 0;
+    
+fail:
+    backend_put_abort(put);
+    return -1;
 }
 
-int backend_update_size(backend_manager_t *mgr,
-                        const char *uri,
-                        size_t new_size) {
-    if (!mgr || !uri) return -1;
+/* Give the unnamed file a hidden name next to path (rename() then swaps it in) */
+static int put_link_stage(object_put_t *put, const char *path) {
+    if (put->stage_path) return 0;
+    
+    const char *last_slash = strrchr(path, '/');
+    char stage[1024];
+    if (snprintf(stage, sizeof(stage), "%.*s/" PUT_STAGE_PREFIX "%d.%u",
+                 (int)(last_slash - path), path, (int)getpid(),
+                 atomic_fetch_add(&g_put_seq, 1)) >= (int)sizeof(stage)) {
+        return -1;
+    }
     
-    fd_ref_t ref;
-    if (global_index_lookup(mgr->global_index, uri, &ref) < 0) {
+    char proc_path[64];
+    snprintf(proc_path, sizeof(proc_path), "/proc/self/fd/%d", put->fd);
+    if (linkat(AT_FDCWD, proc_path, AT_FDCWD, stage, AT_SYMLINK_FOLLOW) < 0) {
         return -1;
     }
     
-    backend_info_t *backend = backend_manager_get_backend(mgr, ref.entry->backend_id);
-    if (!backend) {
-        fd_ref_release(&ref);
+    put->stage_path = strdup(stage);
+    if (!put->stage_path) {
+        unlink(stage);
         return -1;
     }
+    return 0;
+}
+
+/**
+ * Replace the written data with its compressed form, if that pays
+ *
+ * The compressed copy is a second staging file; the plain one is dropped
+ * once it is complete, so a failure leaves the PUT as written.
+ *
+ * @return 0 (compressed, or left plain), -1 on error
+ */
+static int put_compress(backend_info_t *backend, object_put_t *put, char *path,
+                        uint64_t *size) {
+    struct stat st;
+    if (fstat(put->fd, &st) < 0) return -1;
+    if ((uint64_t)st.st_size < BACKEND_COMPRESS_MIN_BYTES) return 0;
+    
+    char *stage_path = NULL;
+    int fd = put_stage_open(backend, path, &stage_path);
+    if (fd < 0) return -1;
+    
+    uint64_t stored;
+    int ret = backend_compress_fd(put->fd, st.st_size, fd, backend->compress_level, &stored);
+    if (ret != 0) {
+        close(fd);
+        if (stage_path) {
+            unlink(stage_path);
+            free(stage_path);
+        }
+        return ret < 0 ? -1 : 0;
+    }
     
-    /* Update size difference */
-    size_t old_size = ref.entry->size_bytes;
-    ref.entry->size_bytes = new_size;
+    close(put->fd);
+    if (put->stage_path) {
+        unlink(put->stage_path);
+        free(put->stage_path);
+    }
+    put->fd = fd;
+    put->stage_path = stage_path;
+    put->flags |= INDEX_FLAG_COMPRESSED;
+    *size = stored;
+    return 0;
+}
+
+/* Make the data reachable at path (memfd: hand a descriptor to the index) */
+static int put_finish(object_put_t *put, bool anon, const char *path) {
+    if (anon) return 0;
+    if (rename(put->stage_path, path) < 0) return -1;
+    free(put->stage_path);
+    put->stage_path = NULL;
+    return 0;
+}
+
+/**
+ * Publish a written PUT object under its URI
+ *
+ * A new URI gets a fresh entry. An existing object on the same backend
+ * keeps its entry and has its file replaced in one rename() (readers with
+ * open FDs keep the old version); cache copies are dropped first, an
+ * object that lives on another backend is deleted first.
+ */
+static int put_publish(backend_manager_t *mgr, backend_info_t *backend,
+                       object_put_t *put, const char *path, uint64_t size) {
+    bool anon = (backend->type == BACKEND_TYPE_MEMFD);
     
-    if (new_size > old_size) {
-        size_t delta = new_size - old_size;
-        atomic_fetch_add(&backend->used_bytes, delta);
-        atomic_fetch_add(&mgr->total_bytes, delta);
-    } else if (new_size < old_size) {
-        size_t delta = old_size - new_size;
-        atomic_fetch_sub(&backend->used_bytes, delta);
-        atomic_fetch_sub(&mgr->total_bytes, delta);
+    struct stat st;
+    if (fstat(put->fd, &st) < 0) return -1;
+    
+    for (int attempt = 0; attempt < PUT_MAX_ATTEMPTS; attempt++) {
+        index_entry_t *entry = lookup_entry(mgr, put->uri);
+        
+        if (entry && (entry->flags & INDEX_FLAG_CACHED)) {
+            cache_demote(mgr, entry, NULL);
+            index_entry_put(entry);
+            continue;
+        }
+        if (entry && entry->backend_id != (uint32_t)backend->id) {
+            /* Changing tiers: the old copy has to go (a chunked object's
+             * chunks stay; put commit decides about those) */
+            index_entry_put(entry);
+            delete_entry(mgr, put->uri);
+            continue;
+        }
+        
+        /* The index descriptor of a memfd is separate from the writer's */
+        int anon_fd = -1;
+        if (anon && (anon_fd = fcntl(put->fd, F_DUPFD_CLOEXEC, 0)) < 0) {
+            index_entry_put(entry);
+            return -1;
+        }
+        
+        if (!entry) {
+            index_entry_t *created = anon ?
+                index_entry_create_anon(put->uri, backend->id, anon_fd) :
+                index_entry_create(put->uri, backend->id, path);
+            if (!created) return -1;
+            created->size_bytes = size;
+            created->mtime = st.st_mtime;
+            created->flags = put->flags | (anon ? INDEX_FLAG_SEALED : 0);
+            
+            pthread_rwlock_wrlock(&backend->rwlock);
+            if (backend_index_lookup(backend->index, put->uri) ||
+                global_index_insert(mgr->global_index, created) < 0) {
+                /* Lost to another writer: this is an overwrite after all */
+                pthread_rwlock_unlock(&backend->rwlock);
+                index_entry_put(created);
+                continue;
+            }
+            if (put_finish(put, anon, path) < 0) {
+                global_index_remove(mgr->global_index, put->uri);
+                pthread_rwlock_unlock(&backend->rwlock);
+                return -1;
+            }
+            
+            backend_index_insert(backend->index, created);
+            journal_entry(mgr, backend, INDEX_JOURNAL_PUT, created);
+            
+            atomic_fetch_add(&backend->object_count, 1);
+            atomic_fetch_add(&backend->writes, 1);
+            atomic_fetch_add(&mgr->total_objects, 1);
+            account_size_change(mgr, backend, 0, size);
+            
+            pthread_rwlock_unlock(&backend->rwlock);
+            return 0;
+        }
+        
+        pthread_rwlock_wrlock(&backend->rwlock);
+        
+        /* Deleted, moved or cached since the lookup? */
+        if (entry->backend_id != (uint32_t)backend->id ||
+            (entry->flags & INDEX_FLAG_CACHED) ||
+            backend_index_lookup(backend->index, put->uri) != entry) {
+            pthread_rwlock_unlock(&backend->rwlock);
+            if (anon_fd >= 0) close(anon_fd);
+            index_entry_put(entry);
+            continue;
+        }
+        if (put_finish(put, anon, path) < 0) {
+            pthread_rwlock_unlock(&backend->rwlock);
+            if (anon_fd >= 0) close(anon_fd);
+            index_entry_put(entry);
+            return -1;
+        }
+        
+        account_size_change(mgr, backend, entry->size_bytes, size);
+        entry->size_bytes = size;
+        entry->mtime = st.st_mtime;
+        entry->flags = put->flags | (entry->flags & INDEX_FLAG_PINNED);
+        
+        /* New generation: cached FDs of the old version are dropped */
+        if (anon) {
+            global_index_update_backend_anon(mgr->global_index, put->uri, backend->id, anon_fd);
+            entry->flags |= INDEX_FLAG_SEALED;
+        } else {
+            global_index_update_backend(mgr->global_index, put->uri, backend->id, path);
+        }
+        journal_entry(mgr, backend, INDEX_JOURNAL_PUT, entry);
+        atomic_fetch_add(&backend->writes, 1);
+        
+        pthread_rwlock_unlock(&backend->rwlock);
+        index_entry_put(entry);
+        return 0;
     }
     
-    fd_ref_release(&ref);
+    return -1;
+}
+
+int backend_put_commit(backend_manager_t *mgr, object_put_t *put, uint64_t size) {
+    if (!mgr || !put || put->fd < 0) return -1;
+    if (put->part_of) return backend_chunk_commit(mgr, put, size);
+    
+    /* A plain object replacing a chunked one leaves its chunks behind */
+    index_entry_info_t old;
+    uint64_t chunk_bytes, old_size;
+    bool drop = !backend_flags_chunked(put->flags) &&
+                global_index_lookup_info(mgr->global_index, put->uri, &old) == 0 &&
+                backend_flags_chunked(old.flags) &&
+                backend_chunk_manifest(mgr, put->uri, &chunk_bytes, &old_size) == 0;
+    
+    int ret = -1;
+    backend_info_t *backend = backend_manager_get_backend(mgr, put->backend_id);
+    char path[1024] = "";
+    
+    if (backend && (backend->type == BACKEND_TYPE_MEMFD ||
+                    build_object_path(backend, put->uri, path, sizeof(path), false) == 0)) {
+        if (backend->type == BACKEND_TYPE_MEMFD) {
+            ret = anon_fd_seal(put->fd);
+        } else {
+            release_preallocation(put->fd);
+            ret = backend->compress_level > 0 ? put_compress(backend, put, path, &size) : 0;
+            
+            /* The data is on disk before any name points at it */
+            if (ret == 0 && mgr->durable && !backend_is_volatile(backend)) {
+                ret = backend_durable_sync_fd(mgr, put->fd);
+            }
+            if (ret == 0) ret = put_link_stage(put, path);
+        }
+        if (ret == 0) {
+            ret = put_publish(mgr, backend, put, path, size);
+        }
+    }
+    if (ret == 0 && drop) {
+        backend_chunk_drop(mgr, put->uri, chunk_bytes, 0, old_size);
+    }
     
-    return 0;
+    backend_put_abort(put);
+    return ret;
 }
 
-void object_metadata_free(object_metadata_t *metadata) {
-    if (!metadata) return;
-    free(metadata->uri);
-    free(metadata->fs_path);
-    memset(metadata, 0, sizeof(*metadata));
+void backend_put_abort(object_put_t *put) {
+    if (!put) return;
+    
+    if (put->fd >= 0) close(put->fd);
+    if (put->stage_path) {
+        unlink(put->stage_path);
+        free(put->stage_path);
+    }
+    free(put->uri);
+    free(put->part_of);
+    
+    memset(put, 0, sizeof(*put));
+    put->fd = -1;
 }
 
 /* ============================================================================
  * Migration Implementation
  * ============================================================================ */
 
+/**
+ * Copy size bytes between descriptors
+ *
+ * Tries a reflink first (tiers on one filesystem then share blocks until
+ * either side writes), then copy_file_range(), which stays in the kernel
+ * and lets the filesystem offload the copy, then sendfile() for pairs it
+ * refuses. Short copies resume where they stopped.
+ */
+static int copy_object_data(int src_fd, int dst_fd, uint64_t size) {
+    if (size > 0 && ioctl(dst_fd, FICLONE, src_fd) == 0) {
+        return 0;
+    }
+    
+    loff_t in = 0, out = 0;
+    bool use_cfr = true;
+    
+    while ((uint64_t)in < size) {
+        ssize_t n;
+        if (use_cfr) {
+            n = copy_file_range(src_fd, &in, dst_fd, &out, size - in, 0);
+            if (n < 0 && (errno == EXDEV || errno == EINVAL ||
+                          errno == ENOSYS || errno == EOPNOTSUPP)) {
+                /* sendfile() writes at the file offset */
+                if (lseek(dst_fd, out, SEEK_SET) < 0) return -1;
+                use_cfr = false;
+                continue;
+            }
+        } else {
+            off_t off = in;
+            n = sendfile(dst_fd, src_fd, &off, size - in);
+            if (n > 0) in = off;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return -1;  /* Source shrank under us */
+    }
+    
+    return 0;
+}
+
+/* How relocate_entry() moves an object's bytes */
+typedef enum {
+    XFER_COPY,                       /* As stored */
+    XFER_DEFLATE,                    /* Compressed for the destination, if it pays */
+    XFER_INFLATE,                    /* Plain copy of a compressed object */
+} xfer_mode_t;
+
+/**
+ * Move an object's bytes for relocate_entry()
+ *
+ * @param size Source size
+ * @param level Destination compression level (XFER_DEFLATE)
+ * @param stored_out Output: bytes written to dst_fd
+ * @param compressed_out Output: whether dst_fd holds the compressed form
+ * @return 0 on success, -1 on error
+ */
+static int transfer_object_data(int src_fd, int dst_fd, uint64_t size,
+                                xfer_mode_t mode, int level,
+                                uint64_t *stored_out, bool *compressed_out) {
+    *compressed_out = false;
+    
+    if (mode == XFER_INFLATE) {
+        return backend_decompress_fd(src_fd, dst_fd, stored_out);
+    }
+    
+    if (mode == XFER_DEFLATE) {
+        int ret = backend_compress_fd(src_fd, size, dst_fd, level, stored_out);
+        if (ret <= 0) {
+            *compressed_out = (ret == 0);
+            return ret;
+        }
+        
+        /* Incompressible: store it as is */
+        if (ftruncate(dst_fd, 0) < 0) return -1;
+    }
+    
+    *stored_out = size;
+    return copy_object_data(src_fd, dst_fd, size);
+}
+
+/* Did the source change since *before was taken? */
+static bool source_changed(int fd, const struct stat *before) {
+    struct stat now;
+    if (fstat(fd, &now) < 0) return true;
+    return now.st_size != before->st_size ||
+           now.st_mtim.tv_sec != before->st_mtim.tv_sec ||
+           now.st_mtim.tv_nsec != before->st_mtim.tv_nsec;
+}
+
+/**
+ * Copy an entry's data from src to dst and repoint the indexes
+ *
+ * The copy goes to a hidden staging file next to the destination with no
+ * locks held; a source modified meanwhile (size or mtime moved) restarts
+ * it, up to MIGRATE_MAX_ATTEMPTS times. Only the final check, the rename
+ * into place and the index swap run under the two backend locks.
+ *
+ * With keep_source the source file stays as the durable home copy and the
+ * entry is marked INDEX_FLAG_CACHED; otherwise the source is unlinked.
+ * A memfd destination is copied into a fresh memfd instead, sealed before
+ * it is published; an anonymous source is simply released.
+ * A compressed object is inflated unless the destination compresses too
+ * (cache copies are always plain); a plain one moving to a compressing
+ * backend is compressed if that pays.
+ * Objects larger than max_bytes, or (with keep_source) written within the
+ * last CACHE_WRITE_QUIESCE_SEC seconds, are skipped.
+ *
+ * @return 0 if moved, 1 if skipped (busy, too large, raced), -1 on error
+ */
+static int relocate_entry(backend_manager_t *mgr,
+                          index_entry_t *entry,
+                          backend_info_t *src,
+                          backend_info_t *dst,
+                          bool keep_source,
+                          uint64_t max_bytes,
+                          uint64_t *bytes_out) {
+    if (src == dst) return -1;
+    if (entry->flags & INDEX_FLAG_PINNED) return -1;
+    
+    /* Security check: ephemeral objects cannot migrate to persistent backends */
+    if ((entry->flags & INDEX_FLAG_EPHEMERAL) &&
+        !(dst->flags & BACKEND_FLAG_EPHEMERAL_ONLY)) {
+        return -1;
+    }
+    
+    /* Check migration flags */
+    if (!(src->flags & BACKEND_FLAG_MIGRATION_SRC) ||
+        !(dst->flags & BACKEND_FLAG_MIGRATION_DST) ||
+        !(dst->flags & BACKEND_FLAG_ENABLED)) {
+        return -1;
+    }
+    
+    /* An anonymous object has no home copy to keep */
+    bool anon_src = (src->type == BACKEND_TYPE_MEMFD);
+    bool anon_dst = (dst->type == BACKEND_TYPE_MEMFD);
+    if (anon_src && keep_source) return -1;
+    
+    char dst_path[1024] = "";
+    char stage_path[1024] = "";
+    if (!anon_dst) {
+        if (build_object_path(dst, entry->uri, dst_path, sizeof(dst_path), true) < 0) {
+            return -1;
+        }
+        
+        /* Staging file in the destination directory, so the rename is atomic */
+        const char *slash = strrchr(dst_path, '/');
+        int dir_len = slash ? (int)(slash - dst_path) : 0;
+        if (snprintf(stage_path, sizeof(stage_path), "%.*s/" MIGRATE_STAGE_NAME,
+                     dir_len, dst_path) >= (int)sizeof(stage_path)) {
+            return -1;
+        }
+    }
+    
+    /* The path is only swapped under the backend locks. An anonymous
+     * source is opened right here: its descriptor is retired on swap. */
+    pthread_rwlock_rdlock(&src->rwlock);
+    char *src_path = NULL;
+    char path[1024];
+    int src_fd = -1;
+    bool src_compressed = false;
+    if (entry->backend_id == (uint32_t)src->id &&
+        backend_index_lookup(src->index, entry->uri) == entry &&
+        index_entry_path(entry, path, sizeof(path)) == 0) {
+        src_path = strdup(path);
+        src_compressed = backend_flags_compressed(entry->flags);
+        if (src_path && anon_src) src_fd = open(src_path, O_RDONLY | O_CLOEXEC);
+    }
+    pthread_rwlock_unlock(&src->rwlock);
+    if (!src_path) return 1;
+    
+    xfer_mode_t mode = XFER_COPY;
+    if (src_compressed && dst->compress_level == 0) {
+        mode = XFER_INFLATE;
+    } else if (!src_compressed && dst->compress_level > 0) {
+        mode = XFER_DEFLATE;
+    }
+    
+    if (!anon_src) src_fd = open(src_path, O_RDONLY | O_CLOEXEC);
+    if (src_fd < 0) {
+        free(src_path);
+        return -1;
+    }
+    
+    int stage_fd;
+    if (anon_dst) {
+        stage_fd = anon_object_open(dst, entry->uri, 0);
+    } else {
+        stage_fd = mkostemp(stage_path, O_CLOEXEC);
+        if (stage_fd < 0 && parent_dir_vanished(dst, dst_path)) {
+            memcpy(stage_path + strlen(stage_path) - 6, "XXXXXX", 6);
+            stage_fd = mkostemp(stage_path, O_CLOEXEC);
+        }
+        if (stage_fd >= 0) {
+            fchmod(stage_fd, 0644);
+            place_object(dst, stage_fd);
+        }
+    }
+    if (stage_fd < 0) {
+        close(src_fd);
+        free(src_path);
+        return -1;
+    }
+    
+    int ret = 1;
+    struct stat st;
+    uint64_t size = 0;
+    bool dst_compressed = false;
+    for (int attempt = 0; attempt < MIGRATE_MAX_ATTEMPTS; attempt++) {
+        if (fstat(src_fd, &st) < 0) {
+            ret = -1;
+            break;
+        }
+        
+        /* Sizes are learned here: FD-pass writers never report them.
+         * Compressed files are only ever written whole. */
+        uint64_t need = st.st_size;
+        if (mode == XFER_INFLATE && backend_compressed_size(src_fd, &need) < 0) {
+            ret = -1;
+            break;
+        }
+        if (need > max_bytes ||
+            (keep_source && !src_compressed &&
+             time(NULL) - st.st_mtime < CACHE_WRITE_QUIESCE_SEC)) {
+            ret = 1;
+            break;
+        }
+        if (mode == XFER_DEFLATE && need < BACKEND_COMPRESS_MIN_BYTES) {
+            mode = XFER_COPY;
+        }
+        
+        if (attempt > 0 && (ftruncate(stage_fd, 0) < 0 ||
+                            lseek(stage_fd, 0, SEEK_SET) < 0)) {
+            ret = -1;
+            break;
+        }
+        
+        if (transfer_object_data(src_fd, stage_fd, st.st_size, mode,
+                                 dst->compress_level, &size, &dst_compressed) < 0) {
+            /* A source that shrank mid-copy is just another change */
+            ret = source_changed(src_fd, &st) ? 1 : -1;
+            if (ret < 0) break;
+            continue;
+        }
+        
+        if (!source_changed(src_fd, &st)) {
+            ret = 0;
+            break;
+        }
+    }
+    
+    /* A moved object must survive a crash once the journal points at it;
+     * an anonymous copy is final once sealed */
+    if (ret == 0 && anon_dst) {
+        if (anon_fd_seal(stage_fd) < 0) ret = -1;
+    } else if (ret == 0 && !keep_source && backend_durable_sync_fd(mgr, stage_fd) < 0) {
+        ret = -1;
+    }
+    if (!anon_dst || ret != 0) {
+        close(stage_fd);
+    }
+    
+    if (ret != 0) {
+        close(src_fd);
+        if (!anon_dst) unlink(stage_path);
+        free(src_path);
+        return ret;
+    }
+    uint64_t src_size = st.st_size;
+    if (mode == XFER_COPY) dst_compressed = src_compressed;
+    
+    lock_backend_pair(src, dst);
+    
+    /* Deleted, replaced, moved or written since the copy finished? */
+    if (entry->backend_id != (uint32_t)src->id ||
+        backend_index_lookup(src->index, entry->uri) != entry ||
+        source_changed(src_fd, &st) ||
+        (!anon_dst && rename(stage_path, dst_path) < 0)) {
+        unlock_backend_pair(src, dst);
+        close(src_fd);
+        if (anon_dst) {
+            close(stage_fd);
+        } else {
+            unlink(stage_path);
+        }
+        free(src_path);
+        return 1;
+    }
+    close(src_fd);
+    
+    account_size_change(mgr, src, entry->size_bytes, src_size);
+    entry->size_bytes = size;
+    
+    /* Insert before remove: the source index may hold the last index ref */
+    backend_index_insert(dst->index, entry);
+    backend_index_remove(src->index, entry->uri);
+    
+    /* A cache copy keeps COMPRESSED: it describes the home copy */
+    if (keep_source) {
+        entry->flags |= INDEX_FLAG_CACHED;
+    } else {
+        atomic_fetch_sub(&src->object_count, 1);
+        atomic_fetch_sub(&src->used_bytes, src_size);
+        atomic_fetch_sub(&mgr->total_bytes, src_size);
+        atomic_fetch_add(&mgr->total_bytes, size);
+        entry->home_backend_id = dst->id;
+        if (dst_compressed) {
+            entry->flags |= INDEX_FLAG_COMPRESSED;
+        } else {
+            entry->flags &= ~INDEX_FLAG_COMPRESSED;
+        }
+    }
+    atomic_fetch_add(&src->migrations_out, 1);
+    
+    atomic_fetch_add(&dst->object_count, 1);
+    atomic_fetch_add(&dst->used_bytes, size);
+    atomic_fetch_add(&dst->migrations_in, 1);
+    
+    /* Swap path; held refs see the generation bump and re-acquire */
+    if (anon_dst) {
+        global_index_update_backend_anon(mgr->global_index, entry->uri, dst->id, stage_fd);
+        entry->flags |= INDEX_FLAG_SEALED;
+    } else {
+        global_index_update_backend(mgr->global_index, entry->uri, dst->id, dst_path);
+        entry->flags &= ~INDEX_FLAG_SEALED;
+    }
+    
+    /* Cache copies are not journaled: the home copy stays authoritative */
+    if (!keep_source) {
+        journal_entry(mgr, src, INDEX_JOURNAL_DEL, entry);
+        journal_entry(mgr, dst, INDEX_JOURNAL_PUT, entry);
+    }
+    
+    unlock_backend_pair(src, dst);
+    
+    /* Readers holding old FDs keep reading the unlinked inode */
+    if (!keep_source && !anon_src) {
+        unlink(src_path);
+    }
+    free(src_path);
+    
+    if (bytes_out) *bytes_out = size;
+    return 0;
+}
+
+/**
+ * Drop a cache copy and repoint the entry at its retained home copy
+ *
+ * No data is copied. Falls back to a full move if the home copy vanished.
+ *
+ * @return 0 if demoted, 1 if skipped (raced), -1 on error
+ */
+static int cache_demote(backend_manager_t *mgr, index_entry_t *entry,
+                        uint64_t *bytes_out) {
+    backend_info_t *cache = backend_manager_get_backend(mgr, entry->backend_id);
+    backend_info_t *home = backend_manager_get_backend(mgr, entry->home_backend_id);
+    if (!cache || !home || cache == home) return -1;
+    
+    if (bytes_out) *bytes_out = 0;
+    
+    char home_path[1024];
+    if (build_object_path(home, entry->uri, home_path, sizeof(home_path), false) < 0) {
+        return -1;
+    }
+    
+    lock_backend_pair(cache, home);
+    
+    if (!(entry->flags & INDEX_FLAG_CACHED) ||
+        entry->backend_id != (uint32_t)cache->id ||
+        backend_index_lookup(cache->index, entry->uri) != entry) {
+        unlock_backend_pair(cache, home);
+        return 1;
+    }
+    
+    /* Home copy vanished: stop counting it and copy the data back */
+    struct stat st;
+    if (stat(home_path, &st) < 0) {
+        entry->flags &= ~(INDEX_FLAG_CACHED | INDEX_FLAG_COMPRESSED);
+        atomic_fetch_sub(&home->object_count, 1);
+        atomic_fetch_sub(&home->used_bytes, entry->size_bytes);
+        unlock_backend_pair(cache, home);
+        return relocate_entry(mgr, entry, cache, home, false, UINT64_MAX, bytes_out);
+    }
+    
+    /* An anonymous copy is released with its descriptor */
+    char path[1024];
+    char *cache_path = (index_entry_anon_fd(entry) < 0 &&
+                        index_entry_path(entry, path, sizeof(path)) == 0)
+                     ? strdup(path) : NULL;
+    
+    backend_index_insert(home->index, entry);
+    backend_index_remove(cache->index, entry->uri);
+    entry->flags &= ~(INDEX_FLAG_CACHED | INDEX_FLAG_SEALED);
+    
+    atomic_fetch_sub(&cache->object_count, 1);
+    atomic_fetch_sub(&cache->used_bytes, entry->size_bytes);
+    atomic_fetch_add(&cache->migrations_out, 1);
+    atomic_fetch_add(&home->migrations_in, 1);
+    entry->size_bytes = st.st_size;  /* The home copy may be compressed */
+    
+    global_index_update_backend(mgr->global_index, entry->uri, home->id, home_path);
+    
+    unlock_backend_pair(cache, home);
+    
+    if (cache_path) {
+        unlink(cache_path);
+        free(cache_path);
+    }
+    
+    return 0;
+}
+
 int backend_migrate_object(backend_manager_t *mgr,
                            const char *uri,
                            int target_backend_id) {
     if (!mgr || !uri) return -1;
     
-    /* Get source object */
-    fd_ref_t src_ref;
-    if (global_index_lookup(mgr->global_index, uri, &src_ref) < 0) {
+    index_entry_t *entry = lookup_entry(mgr, uri);
+    if (!entry) {
         return -1;
     }
     
-    index_entry_t *src_entry = src_ref.entry;
-    int src_backend_id = src_entry->backend_id;
+    /* A cache copy goes home first; from there the durable copy moves */
+    if (entry->flags & INDEX_FLAG_CACHED) {
+        if (cache_demote(mgr, entry, NULL) != 0) {
+            index_entry_put(entry);
+            return -1;
+        }
+        if (entry->backend_id == (uint32_t)target_backend_id) {
+            index_entry_put(entry);
+            return 0;
+        }
+    }
+    
+    backend_info_t *src = backend_manager_get_backend(mgr, entry->backend_id);
+    backend_info_t *dst = backend_manager_get_backend(mgr, target_backend_id);
+    
+    int ret = -1;
+    if (src && dst) {
+        ret = relocate_entry(mgr, entry, src, dst, false, UINT64_MAX, NULL);
+    }
+    
+    index_entry_put(entry);
+    return ret == 0 ? 0 : -1;
+}
+
+/* ============================================================================
+ * Async Migration
+ * ============================================================================ */
+
+typedef struct migrate_job {
+    struct migrate_job *next;
+    int target_backend_id;
+    backend_migrate_cb cb;
+    void *arg;
+    char uri[];
+} migrate_job_t;
+
+static void *migrate_thread_func(void *arg) {
+    backend_manager_t *mgr = arg;
+    
+    pthread_mutex_lock(&mgr->migrate_lock);
+    while (1) {
+        while (!mgr->migrate_head && !mgr->migrate_stop) {
+            pthread_cond_wait(&mgr->migrate_cond, &mgr->migrate_lock);
+        }
+        
+        migrate_job_t *job = mgr->migrate_head;
+        if (!job) break;  /* Stopping with nothing left */
+        mgr->migrate_head = job->next;
+        if (!mgr->migrate_head) mgr->migrate_tail = NULL;
+        bool stopping = mgr->migrate_stop;
+        pthread_mutex_unlock(&mgr->migrate_lock);
+        
+        /* Shutdown cancels what has not started */
+        int result = stopping ? -1 :
+                     backend_migrate_object(mgr, job->uri, job->target_backend_id);
+        if (job->cb) job->cb(job->uri, job->target_backend_id, result, job->arg);
+        free(job);
+        
+        pthread_mutex_lock(&mgr->migrate_lock);
+        if (--mgr->migrate_pending == 0) {
+            pthread_cond_broadcast(&mgr->migrate_idle);
+        }
+    }
+    pthread_mutex_unlock(&mgr->migrate_lock);
+    
+    return NULL;
+}
+
+static void migrate_stop(backend_manager_t *mgr) {
+    pthread_mutex_lock(&mgr->migrate_lock);
+    bool started = mgr->migrate_started;
+    mgr->migrate_stop = true;
+    pthread_cond_signal(&mgr->migrate_cond);
+    pthread_mutex_unlock(&mgr->migrate_lock);
+    
+    if (started) {
+        pthread_join(mgr->migrate_thread, NULL);
+    }
+}
+
+int backend_migrate_object_async(backend_manager_t *mgr,
+                                 const char *uri,
+                                 int target_backend_id,
+                                 backend_migrate_cb cb,
+                                 void *arg) {
+    if (!mgr || !uri) return -1;
+    
+    size_t len = strlen(uri);
+    migrate_job_t *job = malloc(sizeof(*job) + len + 1);
+    if (!job) return -1;
+    
+    job->next = NULL;
+    job->target_backend_id = target_backend_id;
+    job->cb = cb;
+    job->arg = arg;
+    memcpy(job->uri, uri, len + 1);
+    
+    pthread_mutex_lock(&mgr->migrate_lock);
     
-    /* Can't migrate to same backend */
-    if (src_backend_id == target_backend_id) {
-        fd_ref_release(&src_ref);
+    if (mgr->migrate_stop || mgr->migrate_pending >= MIGRATE_QUEUE_MAX) {
+        pthread_mutex_unlock(&mgr->migrate_lock);
+        free(job);
         return -1;
     }
     
-    /* Security check: ephemeral objects cannot migrate to persistent backends */
-    if (src_entry->flags & INDEX_FLAG_EPHEMERAL) {
-        backend_info_t *target = backend_manager_get_backend(mgr, target_backend_id);
-        if (!target || !(target->flags & BACKEND_FLAG_EPHEMERAL_ONLY)) {
-            fd_ref_release(&src_ref);
+    if (!mgr->migrate_started) {
+        if (pthread_create(&mgr->migrate_thread, NULL, migrate_thread_func, mgr) != 0) {
+            pthread_mutex_unlock(&mgr->migrate_lock);
+            free(job);
             return -1;
         }
+        mgr->migrate_started = true;
     }
     
-    backend_info_t *src_backend = backend_manager_get_backend(mgr, src_backend_id);
-    backend_info_t *dst_backend = backend_manager_get_backend(mgr, target_backend_id);
-    
-    if (!src_backend || !dst_backend) {
-        fd_ref_release(&src_ref);
-        return -1;
+    if (mgr->migrate_tail) {
+        mgr->migrate_tail->next = job;
+    } else {
+        mgr->migrate_head = job;
     }
+    mgr->migrate_tail = job;
+    mgr->migrate_pending++;
     
-    /* Check migration flags */
-    if (!(src_backend->flags & BACKEND_FLAG_MIGRATION_SRC) ||
-        !(dst_backend->flags & BACKEND_FLAG_MIGRATION_DST)) {
-        fd_ref_release(&src_ref);
-        return -1;
-    }
+    pthread_cond_signal(&mgr->migrate_cond);
+    pthread_mutex_unlock(&mgr->migrate_lock);
     
-    /* Build destination path */
-    char dst_path[1024];
-    snprintf(dst_path, sizeof(dst_path), "%s%s", dst_backend->mount_path, uri);
+    return 0;
+}
+
+void backend_migrate_drain(backend_manager_t *mgr) {
+    if (!mgr) return;
     
-    /* Create destination file */
-    int dst_fd = open(dst_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (dst_fd < 0) {
-        fd_ref_release(&src_ref);
-        return -1;
+    pthread_mutex_lock(&mgr->migrate_lock);
+    while (mgr->migrate_pending > 0) {
+        pthread_cond_wait(&mgr->migrate_idle, &mgr->migrate_lock);
     }
-    
-    /* Copy data using sendfile */
-    int src_fd = fd_ref_acquire(&src_ref);
-    if (src_fd < 0) {
-        close(dst_fd);
-        unlink(dst_path);
-        fd_ref_release(&src_ref);
-        return -1;
+    pthread_mutex_unlock(&mgr->migrate_lock);
+}
+
+/* ============================================================================
+ * Caching Implementation (Local Migration)
+ * ============================================================================ */
+
+typedef struct {
+    index_entry_t *entry;
+    float hotness;
+} cache_candidate_t;
+
+typedef struct {
+    index_entry_t *entry;
+    uint32_t freq;                   /* Sketch estimate when sampled */
+} cache_victim_t;
+
+/* Per-thread engine state */
+typedef struct {
+    index_entry_t **batch;           /* backend_index_collect() scratch */
+    cache_candidate_t *candidates;
+    size_t batch_size;
+    
+    size_t migrations_left;          /* Object budget for this tick */
+    int64_t byte_credit;             /* Token bucket (bytes); unused if unlimited */
+    
+    /* Least frequent cache copies of this tick, for TinyLFU admission */
+    cache_victim_t victims[CACHE_ADMIT_VICTIMS];
+    size_t num_victims;
+    size_t next_victim;
+} cache_engine_t;
+
+static int candidate_cmp_coldest(const void *a, const void *b) {
+    float ha = ((const cache_candidate_t *)a)->hotness;
+    float hb = ((const cache_candidate_t *)b)->hotness;
+    return (ha > hb) - (ha < hb);
+}
+
+static int candidate_cmp_hottest(const void *a, const void *b) {
+    return candidate_cmp_coldest(b, a);
+}
+
+static bool engine_has_budget(const backend_manager_t *mgr, const cache_engine_t *eng) {
+    return eng->migrations_left > 0 &&
+           (mgr->cache_max_bytes_per_sec == 0 || eng->byte_credit > 0);
+}
+
+static void engine_charge(cache_engine_t *eng, uint64_t bytes) {
+    if (eng->migrations_left > 0) eng->migrations_left--;
+    eng->byte_credit -= (int64_t)bytes;
+}
+
+/* Sample the next batch of a backend index and score it */
+static size_t engine_sample(backend_manager_t *mgr, cache_engine_t *eng,
+                            backend_info_t *backend, uint64_t now) {
+    size_t n = backend_index_collect(backend->index, &backend->scan_cursor,
+                                     eng->batch, eng->batch_size);
+    
+    uint32_t halflife_s = backend->hotness_halflife_us / 1000000;
+    if (halflife_s == 0) halflife_s = 1;
+    
+    for (size_t i = 0; i < n; i++) {
+        index_entry_t *entry = eng->batch[i];
+        float hotness = global_index_hotness(mgr->global_index, entry, now, halflife_s);
+        entry->hotness_score = hotness;
+        eng->candidates[i].entry = entry;
+        eng->candidates[i].hotness = hotness;
     }
     
-    off_t offset = 0;
-    ssize_t copied = sendfile(dst_fd, src_fd, &offset, src_entry->size_bytes);
-    
-    fd_ref_release(&src_ref);
-    close(dst_fd);
-    
-    if (copied != (ssize_t)src_entry->size_bytes) {
-        unlink(dst_path);
-        return -1;
+    return n;
+}
+
+static void engine_release(cache_engine_t *eng, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        index_entry_put(eng->candidates[i].entry);
+    }
+}
+
+static int victim_cmp_rarest(const void *a, const void *b) {
+    uint32_t fa = ((const cache_victim_t *)a)->freq;
+    uint32_t fb = ((const cache_victim_t *)b)->freq;
+    return (fa > fb) - (fa < fb);
+}
+
+/* Keep the least frequent cache copies of a cache sample */
+static void engine_collect_victims(backend_manager_t *mgr, cache_engine_t *eng, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        index_entry_t *entry = eng->candidates[i].entry;
+        if ((entry->flags & (INDEX_FLAG_CACHED | INDEX_FLAG_PINNED)) != INDEX_FLAG_CACHED) {
+            continue;
+        }
+        
+        uint32_t freq = global_index_frequency(mgr->global_index, entry);
+        size_t slot = eng->num_victims;
+        if (slot == CACHE_ADMIT_VICTIMS) {
+            /* Replace the most frequent victim if this one is rarer */
+            slot = 0;
+            for (size_t v = 1; v < eng->num_victims; v++) {
+                if (eng->victims[v].freq > eng->victims[slot].freq) slot = v;
+            }
+            if (freq >= eng->victims[slot].freq) continue;
+            index_entry_put(eng->victims[slot].entry);
+        } else {
+            eng->num_victims++;
+        }
+        
+        index_entry_get(entry);
+        eng->victims[slot].entry = entry;
+        eng->victims[slot].freq = freq;
     }
     
-    /* Update entry */
-    pthread_rwlock_wrlock(&src_backend->rwlock);
-    pthread_rwlock_wrlock(&dst_backend->rwlock);
-    
-    /* Remove from source backend index */
-    backend_index_remove(src_backend->index, uri);
-    atomic_fetch_sub(&src_backend->object_count, 1);
-    atomic_fetch_sub(&src_backend->used_bytes, src_entry->size_bytes);
-    atomic_fetch_add(&src_backend->migrations_out, 1);
-    
-    /* Update entry path and backend */
-    free(src_entry->backend_path);
-    src_entry->backend_path = strdup(dst_path);
-    src_entry->backend_id = target_backend_id;
+    qsort(eng->victims, eng->num_victims, sizeof(*eng->victims), victim_cmp_rarest);
+}
+
+static void engine_release_victims(cache_engine_t *eng) {
+    for (size_t i = 0; i < eng->num_victims; i++) {
+        index_entry_put(eng->victims[i].entry);
+    }
+    eng->num_victims = 0;
+    eng->next_victim = 0;
+}
+
+/**
+ * TinyLFU admission into a full cache
+ * Drops cache copies that are less frequent than the candidate until the
+ * cache is below low, so a burst of one-off reads cannot flush the
+ * objects that are read over and over.
+ *
+ * @return true if the candidate may be promoted
+ */
+static bool engine_make_room(backend_manager_t *mgr, cache_engine_t *eng,
+                             backend_info_t *cache, uint64_t low, uint32_t freq) {
+    while (atomic_load(&cache->used_bytes) >= low) {
+        if (eng->next_victim == eng->num_victims || !engine_has_budget(mgr, eng)) {
+            return false;
+        }
+        
+        cache_victim_t *victim = &eng->victims[eng->next_victim];
+        if (victim->freq >= freq) return false;
+        eng->next_victim++;
+        
+        uint64_t bytes = 0;
+        if (cache_demote(mgr, victim->entry, &bytes) == 0) {
+            engine_charge(eng, bytes);
+            atomic_fetch_add(&mgr->cache_evictions, 1);
+        }
+    }
     
-    /* Update global index */
-    global_index_update_backend(mgr->global_index, uri, target_backend_id, dst_path);
+    return true;
+}
+
+/**
+ * Move sampled residents to the tier of the node that reads them
+ *
+ * Only entries whose reader node vote has settled on another node with a
+ * tier of its own move. A cache copy is just dropped (promotion copies it
+ * again, on the right node); an ephemeral object, which has no other
+ * home, is copied over if that tier is below its low watermark.
+ */
+static void engine_rebalance(backend_manager_t *mgr, cache_engine_t *eng,
+                             backend_info_t *cache, size_t n) {
+    for (size_t i = 0; i < n && engine_has_budget(mgr, eng); i++) {
+        if (!atomic_load(&mgr->cache_running)) break;
+        
+        index_entry_t *entry = eng->candidates[i].entry;
+        if (entry->flags & INDEX_FLAG_PINNED) continue;
+        
+        uint32_t votes = 0;
+        int node = index_entry_reader_node(entry, &votes);
+        if (node < 0 || node == cache->numa_node || votes < CACHE_REBALANCE_VOTES) continue;
+        
+        backend_info_t *target = numa_tier(mgr, node);
+        if (!target || target == cache) continue;
+        
+        uint64_t bytes = 0;
+        int ret;
+        if (entry->flags & INDEX_FLAG_CACHED) {
+            ret = cache_demote(mgr, entry, &bytes);
+        } else {
+            uint64_t used = atomic_load(&target->used_bytes);
+            uint64_t low = target->capacity_bytes * target->low_watermark;
+            if (target->draining || used >= low) continue;
+            ret = relocate_entry(mgr, entry, cache, target, false, low - used, &bytes);
+        }
+        
+        if (ret == 0) {
+            engine_charge(eng, bytes);
+            atomic_fetch_add(&mgr->cache_rebalances, 1);
+            atomic_fetch_add(&mgr->cache_bytes_moved, bytes);
+        }
+    }
+}
+
+/* Evict coldest residents while draining; drop cold cache copies anytime */
+static void engine_evict(backend_manager_t *mgr, cache_engine_t *eng,
+                         backend_info_t *cache, uint64_t now) {
+    migration_policy_t policy = cache->migration_policy;
+    bool capacity = (policy == MIGRATION_POLICY_CAPACITY || policy == MIGRATION_POLICY_HYBRID);
+    bool hotness = (policy == MIGRATION_POLICY_HOTNESS || policy == MIGRATION_POLICY_HYBRID);
+    if (!capacity && !hotness) return;
+    
+    uint64_t high = cache->capacity_bytes * cache->high_watermark;
+    uint64_t low = cache->capacity_bytes * cache->low_watermark;
+    float cold_limit = mgr->cache_threshold * CACHE_COLD_FACTOR;
+    
+    if (capacity && atomic_load(&cache->used_bytes) > high) {
+        cache->draining = true;
+    }
     
-    /* Add to destination backend index */
-    backend_index_insert(dst_backend->index, src_entry);
-    atomic_fetch_add(&dst_backend->object_count, 1);
-    atomic_fetch_add(&dst_backend->used_bytes, src_entry->size_bytes);
-    atomic_fetch_add(&dst_backend->migrations_in, 1);
+    size_t n = engine_sample(mgr, eng, cache, now);
+    engine_rebalance(mgr, eng, cache, n);
+    if (hotness) engine_collect_victims(mgr, eng, n);
+    qsort(eng->candidates, n, sizeof(*eng->candidates), candidate_cmp_coldest);
     
-    pthread_rwlock_unlock(&dst_backend->rwlock);
-    pthread_rwlock_unlock(&src_backend->rwlock);
+    for (size_t i = 0; i < n && engine_has_budget(mgr, eng); i++) {
+        if (!atomic_load(&mgr->cache_running)) break;
+        
+        index_entry_t *entry = eng->candidates[i].entry;
+        bool cached = (entry->flags & INDEX_FLAG_CACHED) != 0;
+        
+        if (cache->draining && atomic_load(&cache->used_bytes) <= low) {
+            cache->draining = false;
+        }
+        
+        bool cold = hotness && cached && eng->candidates[i].hotness < cold_limit;
+        if (!cache->draining && !cold) {
+            if (!hotness || eng->candidates[i].hotness >= cold_limit) break;
+            continue;
+        }
+        
+        /* Ephemeral objects have nowhere else to live */
+        if (entry->flags & (INDEX_FLAG_PINNED | INDEX_FLAG_EPHEMERAL)) continue;
+        
+        uint64_t bytes = 0;
+        int ret;
+        if (cached) {
+            ret = cache_demote(mgr, entry, &bytes);
+        } else {
+            backend_info_t *home = backend_manager_get_backend(mgr, mgr->default_backend_id);
+            if (!home) continue;
+            ret = relocate_entry(mgr, entry, cache, home, false, UINT64_MAX, &bytes);
+        }
+        
+        if (ret == 0) {
+            engine_charge(eng, bytes);
+            atomic_fetch_add(&mgr->cache_evictions, 1);
+            atomic_fetch_add(&mgr->cache_bytes_moved, bytes);
+        }
+    }
     
-    /* Delete source file */
-    unlink(src_entry->backend_path);
+    if (cache->draining && atomic_load(&cache->used_bytes) <= low) {
+        cache->draining = false;
+    }
     
-    return 0;
+    engine_release(eng, n);
 }
 
-/* ============================================================================
- * Caching Implementation (Local Migration)
- * ============================================================================ */
+/**
+ * Promote the hottest sampled objects
+ *
+ * Candidates must have been seen at least CACHE_ADMIT_MIN_FREQ times in
+ * the sketch's window. Below the low watermark that is enough; a full
+ * cache only admits a candidate by dropping less frequent cache copies.
+ */
+static void engine_promote(backend_manager_t *mgr, cache_engine_t *eng,
+                           backend_info_t *cache, uint64_t now) {
+    migration_policy_t policy = cache->migration_policy;
+    if (policy != MIGRATION_POLICY_HOTNESS && policy != MIGRATION_POLICY_HYBRID) return;
+    if (cache->draining) return;
+    
+    uint64_t low = cache->capacity_bytes * cache->low_watermark;
+    
+    for (size_t b = 0; b < mgr->num_backends; b++) {
+        backend_info_t *backend = backend_manager_get_backend(mgr, b);
+        if (!backend || backend == cache) continue;
+        if (backend->flags & BACKEND_FLAG_EPHEMERAL_ONLY) continue;
+        if (!(backend->flags & BACKEND_FLAG_MIGRATION_SRC)) continue;
+        
+        if (!engine_has_budget(mgr, eng)) return;
+        
+        size_t n = engine_sample(mgr, eng, backend, now);
+        qsort(eng->candidates, n, sizeof(*eng->candidates), candidate_cmp_hottest);
+        
+        for (size_t i = 0; i < n && engine_has_budget(mgr, eng); i++) {
+            if (!atomic_load(&mgr->cache_running)) break;
+            if (eng->candidates[i].hotness < mgr->cache_threshold) break;
+            
+            index_entry_t *entry = eng->candidates[i].entry;
+            if (entry->flags & (INDEX_FLAG_PINNED | INDEX_FLAG_EPHEMERAL)) continue;
+            
+            /* Objects read mostly from another node wait for its tier's pass */
+            if (cache_target(mgr, entry) != cache) continue;
+            
+            /* One-hit wonders stay where they are */
+            uint32_t freq = global_index_frequency(mgr->global_index, entry);
+            if (freq < CACHE_ADMIT_MIN_FREQ) continue;
+            if (!engine_make_room(mgr, eng, cache, low, freq)) continue;
+            
+            uint64_t used = atomic_load(&cache->used_bytes);
+            if (used >= low) break;
+            
+            uint64_t bytes = 0;
+            if (relocate_entry(mgr, entry, backend, cache, true, low - used, &bytes) == 0) {
+                engine_charge(eng, bytes);
+                atomic_fetch_add(&mgr->cache_promotions, 1);
+                atomic_fetch_add(&mgr->cache_bytes_moved, bytes);
+            }
+        }
+        
+        engine_release(eng, n);
+    }
+}
+
+/* Sleep one check interval in slices so stop requests are seen quickly */
+static void cache_sleep(backend_manager_t *mgr) {
+    uint64_t remaining = mgr->cache_check_interval_us;
+    
+    while (remaining > 0 && atomic_load(&mgr->cache_running)) {
+        uint64_t slice = remaining < CACHE_SLEEP_SLICE_US ? remaining : CACHE_SLEEP_SLICE_US;
+        usleep(slice);
+        remaining -= slice;
+    }
+}
 
 /* Caching thread function */
 static void *cache_thread_func(void *arg) {
     backend_manager_t *mgr = (backend_manager_t *)arg;
+    cache_engine_t eng = {0};
+    uint64_t last_tick = get_monotonic_us();
     
     while (atomic_load(&mgr->cache_running)) {
-        /* Check if we have a cache backend */
-        if (mgr->cache_backend_id < 0) {
-            usleep(mgr->cache_check_interval_us);
-            continue;
-        }
+        uint64_t now = get_monotonic_us();
+        uint64_t elapsed = now - last_tick;
+        last_tick = now;
         
-        backend_info_t *cache = backend_manager_get_backend(mgr, mgr->cache_backend_id);
-        if (!cache) {
-            usleep(mgr->cache_check_interval_us);
+        /* The cache backend and every node's memory tier, each once */
+        backend_info_t *tiers[1 + BACKEND_NUMA_MAX_NODES];
+        size_t num_tiers = 0;
+        for (int t = -1; t < BACKEND_NUMA_MAX_NODES; t++) {
+            backend_info_t *tier = (t < 0)
+                ? backend_manager_get_backend(mgr, mgr->cache_backend_id)
+                : numa_tier(mgr, t);
+            if (!tier || !tier->capacity_bytes) continue;
+            
+            bool seen = false;
+            for (size_t i = 0; i < num_tiers; i++) seen |= (tiers[i] == tier);
+            if (!seen) tiers[num_tiers++] = tier;
+        }
+        if (num_tiers == 0) {
+            cache_sleep(mgr);
             continue;
         }
         
-        /* Calculate cache utilization */
-        uint64_t used = atomic_load(&cache->used_bytes);
-        double utilization = (double)used / cache->capacity_bytes;
+        /* (Re)size scratch arrays if the batch limit changed */
+        if (eng.batch_size != mgr->cache_scan_batch) {
+            free(eng.batch);
+            free(eng.candidates);
+            eng.batch_size = mgr->cache_scan_batch;
+            eng.batch = malloc(eng.batch_size * sizeof(*eng.batch));
+            eng.candidates = malloc(eng.batch_size * sizeof(*eng.candidates));
+            if (!eng.batch || !eng.candidates) {
+                free(eng.batch);
+                free(eng.candidates);
+                eng.batch = NULL;
+                eng.candidates = NULL;
+                eng.batch_size = 0;
+                cache_sleep(mgr);
+                continue;
+            }
+        }
         
-        /* If cache is full, evict cold objects */
-        if (utilization > cache->high_watermark) {
-            /* TODO: Find coldest objects in cache and evict them */
+        /* Refill budgets: objects per tick, bytes as a token bucket
+         * with at most one second of burst; overdraft carries over */
+        eng.migrations_left = mgr->cache_max_migrations;
+        uint64_t rate = mgr->cache_max_bytes_per_sec;
+        if (rate > 0) {
+            int64_t refill = (int64_t)(rate * (double)elapsed / 1000000.0);
+            eng.byte_credit += refill;
+            if (eng.byte_credit > (int64_t)rate) eng.byte_credit = rate;
         }
         
-        /* Scan persistent backends for hot objects to cache */
-        if (utilization < cache->low_watermark) {
-            for (size_t i = 0; i < mgr->num_backends; i++) {
-                backend_info_t *backend = mgr->backends[i];
-                if (!backend || backend->id == mgr->cache_backend_id) continue;
-                if (backend->flags & BACKEND_FLAG_EPHEMERAL_ONLY) continue;
-                
-                /* TODO: Find hot objects and cache them */
-            }
+        uint64_t moved_before = atomic_load(&mgr->cache_bytes_moved);
+        
+        /* Frequencies must include the reads since the last tick */
+        global_index_drain_accesses(mgr->global_index);
+        
+        for (size_t i = 0; i < num_tiers; i++) {
+            engine_evict(mgr, &eng, tiers[i], now);
+            engine_promote(mgr, &eng, tiers[i], now);
+            engine_release_victims(&eng);
         }
         
-        usleep(mgr->cache_check_interval_us);
+        uint64_t moved = atomic_load(&mgr->cache_bytes_moved) - moved_before;
+        uint64_t window = elapsed > 0 ? elapsed : mgr->cache_check_interval_us;
+        atomic_store(&mgr->cache_bytes_per_sec,
+                     window > 0 ? (uint64_t)(moved * 1000000.0 / window) : 0);
+        
+        cache_sleep(mgr);
     }
     
+    free(eng.batch);
+    free(eng.candidates);
     return NULL;
 }
 
@@ -794,48 +2893,118 @@ void backend_stop_caching(backend_manager_t *mgr) {
     }
 }
 
+int backend_set_cache_limits(backend_manager_t *mgr,
+                             size_t scan_batch,
+                             size_t max_migrations,
+                             uint64_t max_bytes_per_sec) {
+    if (!mgr) return -1;
+    
+    if (scan_batch > 0) mgr->cache_scan_batch = scan_batch;
+    if (max_migrations > 0) mgr->cache_max_migrations = max_migrations;
+    mgr->cache_max_bytes_per_sec = max_bytes_per_sec;
+    
+    return 0;
+}
+
+int backend_get_cache_stats(backend_manager_t *mgr, cache_stats_t *stats_out) {
+    if (!mgr || !stats_out) return -1;
+    
+    stats_out->promotions = atomic_load(&mgr->cache_promotions);
+    stats_out->evictions = atomic_load(&mgr->cache_evictions);
+    stats_out->bytes_moved = atomic_load(&mgr->cache_bytes_moved);
+    stats_out->bytes_per_sec = atomic_load(&mgr->cache_bytes_per_sec);
+    stats_out->rebalances = atomic_load(&mgr->cache_rebalances);
+    
+    return 0;
+}
+
+int backend_get_numa_stats(backend_manager_t *mgr, int node, numa_stats_t *stats_out) {
+    if (!mgr || !stats_out) return -1;
+    
+    backend_info_t *tier = numa_tier(mgr, node);
+    if (!tier) return -1;
+    
+    stats_out->backend_id = tier->id;
+    stats_out->objects = atomic_load(&tier->object_count);
+    stats_out->used_bytes = atomic_load(&tier->used_bytes);
+    stats_out->local_reads = atomic_load(&tier->local_reads);
+    stats_out->remote_reads = atomic_load(&tier->remote_reads);
+    
+    return 0;
+}
+
 int backend_cache_object(backend_manager_t *mgr, const char *uri) {
     if (!mgr || !uri) return -1;
-    if (mgr->cache_backend_id < 0) return -1;
     
     /* Get object info */
-    fd_ref_t ref;
-    if (global_index_lookup(mgr->global_index, uri, &ref) < 0) {
+    index_entry_t *entry = lookup_entry(mgr, uri);
+    if (!entry) {
         return -1;
     }
     
-    int current_backend = ref.entry->backend_id;
-    fd_ref_release(&ref);
+    /* Already in a memory tier? */
+    backend_info_t *cache = cache_target(mgr, entry);
+    if (!cache || is_cache_tier(mgr, entry->backend_id)) {
+        index_entry_put(entry);
+        return cache ? 0 : -1;
+    }
     
-    /* Already in cache? */
-    if (current_backend == mgr->cache_backend_id) {
-        return 0;
+    backend_info_t *src = backend_manager_get_backend(mgr, entry->backend_id);
+    uint64_t used = atomic_load(&cache->used_bytes);
+    uint64_t room = cache->capacity_bytes > used ? cache->capacity_bytes - used : 0;
+    
+    /* Copy persistent objects and keep the durable home copy */
+    int ret = -1;
+    uint64_t bytes = 0;
+    if (src) {
+        bool keep_source = !(src->flags & BACKEND_FLAG_EPHEMERAL_ONLY);
+        ret = relocate_entry(mgr, entry, src, cache, keep_source, room, &bytes);
     }
     
-    /* Migrate to cache */
-    return backend_migrate_object(mgr, uri, mgr->cache_backend_id);
+    index_entry_put(entry);
+    
+    if (ret != 0) return -1;
+    
+    atomic_fetch_add(&mgr->cache_promotions, 1);
+    atomic_fetch_add(&mgr->cache_bytes_moved, bytes);
+    return 0;
 }
 
 int backend_evict_object(backend_manager_t *mgr, const char *uri) {
     if (!mgr || !uri) return -1;
-    if (mgr->default_backend_id < 0) return -1;
     
     /* Get object info */
-    fd_ref_t ref;
-    if (global_index_lookup(mgr->global_index, uri, &ref) < 0) {
+    index_entry_t *entry = lookup_entry(mgr, uri);
+    if (!entry) {
         return -1;
     }
     
-    int current_backend = ref.entry->backend_id;
-    fd_ref_release(&ref);
-    
     /* Not in cache? */
-    if (current_backend != mgr->cache_backend_id) {
+    if (!is_cache_tier(mgr, entry->backend_id)) {
+        index_entry_put(entry);
         return 0;
     }
     
-    /* Migrate back to default backend */
-    return backend_migrate_object(mgr, uri, mgr->default_backend_id);
+    /* Repoint cache copies home; migrate anything else to the default backend */
+    int ret = -1;
+    uint64_t bytes = 0;
+    if (entry->flags & INDEX_FLAG_CACHED) {
+        ret = cache_demote(mgr, entry, &bytes);
+    } else {
+        backend_info_t *cache = backend_manager_get_backend(mgr, entry->backend_id);
+        backend_info_t *home = backend_manager_get_backend(mgr, mgr->default_backend_id);
+        if (cache && home) {
+            ret = relocate_entry(mgr, entry, cache, home, false, UINT64_MAX, &bytes);
+        }
+    }
+    
+    index_entry_put(entry);
+    
+    if (ret != 0) return -1;
+    
+    atomic_fetch_add(&mgr->cache_evictions, 1);
+    atomic_fetch_add(&mgr->cache_bytes_moved, bytes);
+    return 0;
 }
 
 /* ============================================================================
@@ -861,6 +3030,80 @@ int backend_get_status(backend_manager_t *mgr,
     return 0;
 }
 
+/* Double the capacity of the parallel URI/score arrays */
+static int grow_object_list(char ***uris, double **scores, size_t *capacity) {
+    size_t new_capacity = *capacity ? *capacity * 2 : 256;
+    
+    char **new_uris = realloc(*uris, new_capacity * sizeof(**uris));
+    if (!new_uris) return -1;
+    *uris = new_uris;
+    
+    if (scores) {
+        double *new_scores = realloc(*scores, new_capacity * sizeof(**scores));
+        if (!new_scores) return -1;
+        *scores = new_scores;
+    }
+    
+    *capacity = new_capacity;
+    return 0;
+}
+
+/* Walk a backend index in batches, copying URIs and optionally hotness */
+static int collect_backend_objects(backend_manager_t *mgr, backend_info_t *backend,
+                                   char ***uris_out,
+                                   double **scores_out,
+                                   size_t *count_out) {
+    enum { BATCH = 256 };
+    index_entry_t *batch[BATCH];
+    
+    char **uris = NULL;
+    double *scores = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    size_t cursor = 0;
+    uint64_t now = get_monotonic_us();
+    uint32_t halflife_s = backend->hotness_halflife_us / 1000000;
+    if (halflife_s == 0) halflife_s = 1;
+    int ret = 0;
+    
+    do {
+        size_t n = backend_index_collect(backend->index, &cursor, batch, BATCH);
+        
+        for (size_t i = 0; i < n; i++) {
+            if (ret == 0 && count == capacity) {
+                ret = grow_object_list(&uris, scores_out ? &scores : NULL, &capacity);
+            }
+            
+            if (ret == 0) {
+                uris[count] = strdup(batch[i]->uri);
+                if (!uris[count]) {
+                    ret = -1;
+                } else {
+                    if (scores_out) {
+                        scores[count] = global_index_hotness(mgr->global_index, batch[i],
+                                                             now, halflife_s);
+                    }
+                    count++;
+                }
+            }
+            
+            index_entry_put(batch[i]);
+        }
+    } while (cursor != 0);
+    
+    if (ret < 0) {
+        for (size_t i = 0; i < count; i++) free(uris[i]);
+        free(uris);
+        free(scores);
+        return -1;
+    }
+    
+    *uris_out = uris;
+    if (scores_out) *scores_out = scores;
+    *count_out = count;
+    return 0;
+}
+
 int backend_list_objects(backend_manager_t *mgr,
                         int backend_id,
                         char ***uris_out,
@@ -870,12 +3113,7 @@ int backend_list_objects(backend_manager_t *mgr,
     backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
     if (!backend || !backend->index) return -1;
     
-    /* TODO: Implement iteration over backend index */
-    /* For now, return empty list */
-    *uris_out = NULL;
-    *count_out = 0;
-    
-    return 0;
+    return collect_backend_objects(mgr, backend, uris_out, NULL, count_out);
 }
 
 int backend_get_hotness_map(backend_manager_t *mgr,
@@ -888,13 +3126,7 @@ int backend_get_hotness_map(backend_manager_t *mgr,
     backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
     if (!backend || !backend->index) return -1;
     
-    /* TODO: Implement iteration with hotness calculation */
-    /* For now, return empty list */
-    *uris_out = NULL;
-    *scores_out = NULL;
-    *count_out = 0;
-    
-    return 0;
+    return collect_backend_objects(mgr, backend, uris_out, scores_out, count_out);
 }
 
 int backend_get_index_stats(backend_manager_t *mgr, index_stats_t *stats_out) {
@@ -904,6 +3136,185 @@ int backend_get_index_stats(backend_manager_t *mgr, index_stats_t *stats_out) {
     return 0;
 }
 
+/* ============================================================================
+ * Prefix Listing and Purge
+ * ============================================================================ */
+
+/* Prefix index reads per listing batch */
+#define LIST_BATCH 256
+
+struct backend_list {
+    backend_manager_t *mgr;
+    index_prefix_iter_t *iter;
+};
+
+static void list_image_record(const index_image_record_t *rec, int64_t slot, void *data) {
+    (void)slot;
+    global_index_t *gidx = data;
+    size_t len = strlen(rec->uri);
+    index_prefix_add(&gidx->prefix, rec->uri, len, index_hash_bytes(rec->uri, len));
+}
+
+/**
+ * Add the URIs still only in backend images to the prefix index
+ *
+ * Images are faulted in on demand, so their URIs join the prefix index
+ * the first time it is iterated. The write lock keeps fault-ins, which
+ * claim slots under the read lock, out while the image is walked: a URI
+ * faulted in and deleted before cannot come back.
+ */
+static void list_images(backend_manager_t *mgr) {
+    if (atomic_load(&mgr->mapped_images) == 0) return;
+    
+    backend_info_t *backend;
+    for (int id = 0; (backend = backend_manager_get_backend(mgr, id)) != NULL; id++) {
+        pthread_rwlock_rdlock(&backend->rwlock);
+        bool listed = !backend->image || backend->image_listed;
+        pthread_rwlock_unlock(&backend->rwlock);
+        if (listed) continue;
+        
+        pthread_rwlock_wrlock(&backend->rwlock);
+        if (backend->image && !backend->image_listed) {
+            index_image_foreach(backend->image, list_image_record, mgr->global_index);
+            backend->image_listed = true;
+        }
+        pthread_rwlock_unlock(&backend->rwlock);
+    }
+}
+
+/* Plain size and, for an FD writer's object, mtime from the stored file */
+static void list_file_info(int fd, index_entry_info_t *info) {
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        info->size_bytes = st.st_size;
+        if (info->flags & INDEX_FLAG_UNSETTLED) info->mtime = st.st_mtime;
+    }
+    if (backend_flags_compressed(info->flags)) {
+        backend_compressed_size(fd, &info->size_bytes);
+    }
+}
+
+/* Metadata of a listed URI, without faulting it in; -1 if it is gone */
+static int list_item_info(backend_manager_t *mgr, const char *uri,
+                          index_entry_info_t *info) {
+    bool resident = global_index_lookup_info(mgr->global_index, uri, info) == 0;
+    bool found = resident;
+    int fd = -1;
+    
+    backend_info_t *backend;
+    for (int id = 0; !found && (backend = backend_manager_get_backend(mgr, id)) != NULL;
+         id++) {
+        pthread_rwlock_rdlock(&backend->rwlock);
+        index_image_record_t rec;
+        if (backend->image && index_image_find(backend->image, uri, &rec) >= 0) {
+            *info = (index_entry_info_t){
+                .backend_id = backend->id,
+                .size_bytes = rec.size_bytes,
+                .mtime = rec.mtime,
+                .flags = rec.flags,
+            };
+            if (rec.flags & INDEX_FLAG_UNSETTLED || backend_flags_compressed(rec.flags)) {
+                fd = open(rec.path, O_RDONLY | O_CLOEXEC);
+            }
+            found = true;
+        }
+        pthread_rwlock_unlock(&backend->rwlock);
+    }
+    if (!found) return -1;
+    
+    if (backend_flags_chunked(info->flags)) {
+        if (fd >= 0) close(fd);
+        uint64_t size;
+        if (backend_chunk_manifest(mgr, uri, NULL, &size) < 0) return -1;
+        info->size_bytes = size;
+        return 0;
+    }
+    
+    /* Only the file knows an FD writer's size, or a compressed object's */
+    if (resident && (info->flags & INDEX_FLAG_UNSETTLED ||
+                     backend_flags_compressed(info->flags))) {
+        fd = backend_get_stored_fd(mgr, uri, NULL);
+    }
+    if (fd >= 0) {
+        list_file_info(fd, info);
+        close(fd);
+    }
+    return 0;
+}
+
+backend_list_t *backend_list_open(backend_manager_t *mgr, const char *prefix) {
+    if (!mgr || !prefix) return NULL;
+    
+    backend_list_t *list = calloc(1, sizeof(*list));
+    if (!list) return NULL;
+    
+    list_images(mgr);
+    list->mgr = mgr;
+    list->iter = index_prefix_iter_open(&mgr->global_index->prefix, prefix);
+    if (!list->iter) {
+        free(list);
+        return NULL;
+    }
+    return list;
+}
+
+size_t backend_list_next(backend_list_t *list, backend_list_item_t *items, size_t max) {
+    if (!list || !items || max == 0) return 0;
+    if (max > LIST_BATCH) max = LIST_BATCH;
+    
+    char *uris[LIST_BATCH];
+    size_t count = 0;
+    size_t n;
+    
+    /* A batch may be all chunks or deleted objects: read on until one
+     * object remains or the prefix runs out */
+    while (count == 0 && (n = index_prefix_iter_next(list->iter, uris, max)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (backend_uri_is_chunk(uris[i]) ||
+                list_item_info(list->mgr, uris[i], &items[count].info) < 0) {
+                free(uris[i]);
+                continue;
+            }
+            items[count++].uri = uris[i];
+        }
+    }
+    return count;
+}
+
+void backend_list_close(backend_list_t *list) {
+    if (!list) return;
+    
+    index_prefix_iter_close(list->iter);
+    free(list);
+}
+
+int backend_purge_prefix(backend_manager_t *mgr, const char *prefix, size_t *purged_out) {
+    if (!mgr || !prefix) return -1;
+    
+    list_images(mgr);
+    index_prefix_iter_t *iter = index_prefix_iter_open(&mgr->global_index->prefix, prefix);
+    if (!iter) return -1;
+    
+    /* Chunks go with their object, which sorts before them; a chunk whose
+     * object is gone is deleted on its own */
+    char *uris[BACKEND_PURGE_BATCH];
+    size_t purged = 0;
+    size_t n;
+    while ((n = index_prefix_iter_next(iter, uris, BACKEND_PURGE_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (backend_delete_object(mgr, uris[i]) == 0 &&
+                !backend_uri_is_chunk(uris[i])) {
+                purged++;
+            }
+            free(uris[i]);
+        }
+    }
+    
+    index_prefix_iter_close(iter);
+    if (purged_out) *purged_out = purged;
+    return 0;
+}
+
 /* ============================================================================
  * Backend Management
  * ============================================================================ */
@@ -946,6 +3357,23 @@ int backend_set_watermarks(backend_manager_t *mgr,
     return 0;
 }
 
+int backend_set_compression(backend_manager_t *mgr, int backend_id, int level) {
+    backend_info_t *backend = backend_manager_get_backend(mgr, backend_id);
+    if (!backend || level < 0 || level > BACKEND_COMPRESS_MAX_LEVEL) return -1;
+    
+    /* Memory tiers hold the plain copies FD-passing readers get */
+    if (level > 0 && (backend->type == BACKEND_TYPE_MEMORY ||
+                      backend->type == BACKEND_TYPE_MEMFD)) {
+        return -1;
+    }
+    
+    pthread_rwlock_wrlock(&backend->rwlock);
+    backend->compress_level = level;
+    pthread_rwlock_unlock(&backend->rwlock);
+    
+    return 0;
+}
+
 int backend_set_migration_policy(backend_manager_t *mgr,
                                  int backend_id,
                                  migration_policy_t policy,
@@ -25,6 +25,7 @@ typedef enum {
     BACKEND_TYPE_SSD,        /* SATA SSD - medium persistent */
     BACKEND_TYPE_HDD,        /* Hard disk - slow persistent */
     BACKEND_TYPE_NETWORK,    /* Network storage - slowest */
+    BACKEND_TYPE_MEMFD,      /* Anonymous memory (memfd) - volatile, no paths */
 } backend_type_t;
 
 /* Backend flags */
@@ -35,6 +36,12 @@ typedef enum {
 #define BACKEND_FLAG_MIGRATION_SRC   (1 << 4)  /* Can migrate objects out */
 #define BACKEND_FLAG_MIGRATION_DST   (1 << 5)  /* Can migrate objects in */
 
+/* Directories known to exist under a backend mount (skips mkdir on create) */
+#define BACKEND_DIR_CACHE_SLOTS      1024
+
+/* NUMA nodes with a memory tier of their own (see numa.h) */
+#define BACKEND_NUMA_MAX_NODES       8
+
 /* Migration policy */
 typedef enum {
     MIGRATION_POLICY_NONE,       /* No automatic migration */
@@ -71,14 +78,32 @@ typedef struct backend_info {
     double hotness_threshold;        /* Minimum hotness for migration in */
     uint64_t hotness_halflife_us;    /* Hotness decay halflife */
     
+    /* Stored compression (see compress.h), 0 = objects stored as written */
+    int compress_level;
+    
+    /* NUMA node the objects' pages are placed on (-1 = first touch) */
+    int numa_node;
+    
     /* Associated index */
     backend_index_t *index;          /* Object index for this backend */
+    size_t scan_cursor;              /* Tiering engine resume bucket */
+    bool draining;                   /* Tiering engine: above high watermark until low */
+    
+    /* Persistent index (see backend_manager_restore) */
+    index_image_t *image;            /* Mapped image, faulted in on lookup misses */
+    index_journal_t *journal;        /* Mutations since the image was written */
+    bool image_listed;               /* Unclaimed image URIs are in the prefix index */
     
     /* Statistics */
     atomic_size_t reads;             /* Total read operations */
     atomic_size_t writes;            /* Total write operations */
     atomic_size_t migrations_in;     /* Objects migrated in */
     atomic_size_t migrations_out;    /* Objects migrated out */
+    atomic_size_t local_reads;       /* Reads by threads on numa_node */
+    atomic_size_t remote_reads;      /* Reads by threads on other nodes */
+    
+    /* Directory cache: hashes of parent directories already created */
+    atomic_uint_fast64_t dir_cache[BACKEND_DIR_CACHE_SLOTS];
     
     /* Thread safety */
     pthread_rwlock_t rwlock;         /* Protects backend state */
@@ -99,6 +124,7 @@ typedef struct backend_manager {
     int default_backend_id;
     int ephemeral_backend_id;        /* For ephemeral objects */
     int cache_backend_id;            /* Memory backend for caching (-1 if none) */
+    int numa_backends[BACKEND_NUMA_MAX_NODES]; /* Memory tier of each node (-1 if none) */
     
     /* Caching thread (local migration) */
     pthread_t cache_thread;
@@ -106,8 +132,39 @@ typedef struct backend_manager {
     uint64_t cache_check_interval_us; /* How often to check for cache promotion */
     double cache_threshold;           /* Minimum hotness for caching */
     
+    /* Caching work bounds (per check interval unless noted) */
+    size_t cache_scan_batch;          /* Entries sampled per backend */
+    size_t cache_max_migrations;      /* Objects promoted/evicted */
+    uint64_t cache_max_bytes_per_sec; /* Copy bandwidth cap (0 = unlimited) */
+    
+    /* Caching statistics */
+    atomic_uint_fast64_t cache_promotions;
+    atomic_uint_fast64_t cache_evictions;
+    atomic_uint_fast64_t cache_bytes_moved;
+    atomic_uint_fast64_t cache_bytes_per_sec; /* Rate over the last interval */
+    atomic_uint_fast64_t cache_rebalances;    /* Moved to their readers' node */
+    
+    /* Chunked objects (see chunk.h) */
+    uint64_t chunk_bytes;             /* Chunk size of new chunked objects */
+    pthread_mutex_t chunk_lock;       /* Serializes manifest updates */
+    
+    /* Async migration queue (backend_migrate_object_async) */
+    pthread_mutex_t migrate_lock;
+    pthread_cond_t migrate_cond;     /* Job queued, or stop requested */
+    pthread_cond_t migrate_idle;     /* Queue drained */
+    struct migrate_job *migrate_head;
+    struct migrate_job *migrate_tail;
+    size_t migrate_pending;          /* Jobs queued or running */
+    pthread_t migrate_thread;
+    bool migrate_started;            /* Worker created (on first submit) */
+    bool migrate_stop;
+    
+    /* Group commit and background checkpoints (see durable.h), NULL = off */
+    struct backend_durable *durable;
+    
     /* Thread safety */
     pthread_rwlock_t backends_lock;  /* Protects backends array */
+    atomic_int mapped_images;        /* Backends with an image to fault in from */
     
     /* Statistics */
     atomic_size_t total_objects;
@@ -115,6 +172,28 @@ typedef struct backend_manager {
     
 } backend_manager_t;
 
+/**
+ * Caching engine statistics
+ */
+typedef struct cache_stats {
+    uint64_t promotions;             /* Objects copied into the cache */
+    uint64_t evictions;              /* Objects dropped from the cache */
+    uint64_t bytes_moved;            /* Total bytes copied by the engine */
+    uint64_t bytes_per_sec;          /* Copy rate over the last interval */
+    uint64_t rebalances;             /* Objects moved to the node reading them */
+} cache_stats_t;
+
+/**
+ * Memory tier statistics of a NUMA node
+ */
+typedef struct numa_stats {
+    int backend_id;                  /* The node's memory backend */
+    size_t objects;
+    uint64_t used_bytes;
+    uint64_t local_reads;            /* Reads by threads on the node */
+    uint64_t remote_reads;           /* Reads by threads on other nodes */
+} numa_stats_t;
+
 /**
  * Object creation request
  */
@@ -124,8 +203,24 @@ typedef struct object_create_req {
     bool ephemeral;                  /* Ephemeral vs persistent */
     size_t size_hint;                /* Expected size (for allocation) */
     uint32_t flags;                  /* Additional flags */
+    bool replace;                    /* Drop an existing object first */
+    uint64_t part_total;             /* First part: size of the new version (0 = none) */
 } object_create_req_t;
 
+/**
+ * An object being written by PUT, not yet visible under its URI
+ */
+typedef struct object_put {
+    int fd;                          /* Writable FD of the new contents */
+    int backend_id;                  /* Backend the object is written on */
+    uint32_t flags;                  /* INDEX_FLAG_* of the published entry */
+    char *uri;                       /* Object URI (owned) */
+    char *stage_path;                /* Named staging file, NULL while unnamed */
+    char *part_of;                   /* Part of a chunked object: its URI (owned) */
+    uint64_t part_offset;            /* Part: object offset of the chunk */
+    uint64_t part_total;             /* Part: declared object size (0 = none) */
+} object_put_t;
+
 /**
  * Object metadata
  */
@@ -163,6 +258,10 @@ void backend_manager_destroy(backend_manager_t *mgr);
 /**
  * Register a new backend
  *
+ * A BACKEND_TYPE_MEMFD backend keeps each object in a memfd, which is the
+ * object's identity in the index; mount_path is only a label and nothing
+ * is persisted or scanned.
+ *
  * @param mgr Backend manager
  * @param type Backend type
  * @param mount_path Filesystem mount point
@@ -214,6 +313,22 @@ int backend_manager_set_ephemeral(backend_manager_t *mgr, int backend_id);
  */
 int backend_manager_set_cache(backend_manager_t *mgr, int backend_id);
 
+/**
+ * Make a memory backend the memory tier of a NUMA node
+ *
+ * The backend's objects get their pages on the node (see numa.h). New
+ * ephemeral objects created by threads on the node go to it rather than
+ * to the ephemeral backend, and the caching engine promotes objects read
+ * mostly from the node into it rather than into the cache backend. A node
+ * has one tier; binding another backend replaces it.
+ *
+ * @param mgr Backend manager
+ * @param backend_id Memory or memfd backend
+ * @param node NUMA node (below BACKEND_NUMA_MAX_NODES)
+ * @return 0 on success, -1 on error
+ */
+int backend_manager_set_numa_node(backend_manager_t *mgr, int backend_id, int node);
+
 /* ============================================================================
  * Object Operations API
  * ============================================================================ */
@@ -221,15 +336,57 @@ int backend_manager_set_cache(backend_manager_t *mgr, int backend_id);
 /**
  * Create a new object
  *
+ * The URI is claimed in the index before the file is opened, so creating
+ * an existing object fails without truncating it (unless req->replace).
+ *
  * @param mgr Backend manager
  * @param req Creation request
- * @param ref_out Output FD reference
+ * @param ref_out Output FD reference (O_RDWR writer FD)
  * @return 0 on success, -1 on error
  */
 int backend_create_object(backend_manager_t *mgr,
                           const object_create_req_t *req,
                           fd_ref_t *ref_out);
 
+/**
+ * Start an atomic PUT
+ *
+ * The contents are written to put->fd: an unnamed O_TMPFILE inode in the
+ * object's directory (a hidden staging file where unsupported, a memfd on
+ * MEMFD backends), preallocated to req->size_hint. Readers keep seeing the
+ * previous version until backend_put_commit(). req->replace is implied.
+ *
+ * @param mgr Backend manager
+ * @param req Creation request
+ * @param put Output PUT state
+ * @return 0 on success, -1 on error
+ */
+int backend_put_begin(backend_manager_t *mgr, const object_create_req_t *req,
+                      object_put_t *put);
+
+/**
+ * Publish a PUT under its URI
+ *
+ * Links the new file over the old one with a single rename() and swaps the
+ * index entry to a new generation; an overwrite takes no object lock and
+ * deletes nothing first. Overwriting a chunked object drops its chunks;
+ * a part (backend_put_part_begin()) extends its chunked object. Releases
+ * put whether or not it succeeds.
+ *
+ * @param mgr Backend manager
+ * @param put PUT from backend_put_begin()
+ * @param size Bytes written
+ * @return 0 on success, -1 on error
+ */
+int backend_put_commit(backend_manager_t *mgr, object_put_t *put, uint64_t size);
+
+/**
+ * Discard a PUT, leaving any previous version in place
+ *
+ * @param put PUT from backend_put_begin()
+ */
+void backend_put_abort(object_put_t *put);
+
 /**
  * Get an existing object
  *
@@ -242,6 +399,94 @@ int backend_get_object(backend_manager_t *mgr,
                        const char *uri,
                        fd_ref_t *ref_out);
 
+/**
+ * Get a private read-only FD for an existing object
+ *
+ * Lock-free fast path for readers that only need the descriptor: no
+ * entry reference is taken, so nothing has to be released afterwards.
+ * The FD always reads plain bytes: an object stored compressed is first
+ * promoted into the cache backend (inflated on the way), or, if it cannot
+ * be, inflated into a private sealed memfd. A chunked object has no such
+ * FD (errno EISDIR): read it with backend_get_range().
+ *
+ * @param mgr Backend manager
+ * @param uri Object URI
+ * @param info_out Output entry snapshot (may be NULL)
+ * @return FD (caller closes) on success, -1 on error
+ */
+int backend_get_object_fd(backend_manager_t *mgr,
+                          const char *uri,
+                          index_entry_info_t *info_out);
+
+/**
+ * Get a private read-only FD for the bytes an object is stored as
+ *
+ * Like backend_get_object_fd(), but a compressed object is returned as
+ * is: backend_flags_compressed(info_out->flags) tells the caller it reads
+ * the gzip form described in compress.h, backend_flags_chunked() that it
+ * reads a chunked object's manifest (chunk.h).
+ *
+ * @param mgr Backend manager
+ * @param uri Object URI
+ * @param info_out Output entry snapshot (may be NULL)
+ * @return FD (caller closes) on success, -1 on error
+ */
+int backend_get_stored_fd(backend_manager_t *mgr,
+                          const char *uri,
+                          index_entry_info_t *info_out);
+
+/**
+ * Read an object's index metadata without opening it
+ *
+ * No FD is opened and the lookup counts as neither a read nor an access.
+ * size_bytes and mtime describe the object unless info_out->flags has
+ * INDEX_FLAG_UNSETTLED (an FD writer that has not reported its size; the
+ * file itself must be asked) or the stored copy is compressed
+ * (size_bytes is then the stored size). For a chunked object size_bytes
+ * is the object size, read from its manifest.
+ *
+ * @param mgr Backend manager
+ * @param uri Object URI
+ * @param info_out Output entry snapshot
+ * @return 0 on success, -1 if not found
+ */
+int backend_stat_object(backend_manager_t *mgr,
+                        const char *uri,
+                        index_entry_info_t *info_out);
+
+/**
+ * Get an object's FD, creating the object if it does not exist
+ *
+ * Resolves with a single index probe when the object exists, replacing
+ * the exists-then-get-or-create sequence of separate lookups.
+ *
+ * @param mgr Backend manager
+ * @param req Creation request (uri names the object; replace is ignored)
+ * @param created Output: true if the object was created
+ * @return FD (caller closes) on success, -1 on error: a read-only FD for an
+ *         existing object, the O_RDWR writer FD for a new one
+ */
+int backend_get_or_create_object_fd(backend_manager_t *mgr,
+                                    const object_create_req_t *req,
+                                    bool *created);
+
+/**
+ * Check whether a lookup can complete without touching a slow device
+ *
+ * True when the object lives on a memory backend, already has a cached
+ * FD, or is not indexed at all (the miss is answered from the index).
+ * Objects stored compressed are slow: reading them inflates them.
+ * While a restored image is mapped, unindexed objects count as slow:
+ * faulting them in may read the image from disk.
+ * Servers use this to keep fast hits on the event loop and hand the
+ * rest to blocking worker threads.
+ *
+ * @param mgr Backend manager
+ * @param uri Object URI
+ * @return true if the lookup is cheap
+ */
+bool backend_object_is_fast(backend_manager_t *mgr, const char *uri);
+
 /**
  * Delete an object
  *
@@ -260,6 +505,34 @@ int backend_delete_object(backend_manager_t *mgr, const char *uri);
  */
 int backend_manager_scan(backend_manager_t *mgr, int backend_id);
 
+/**
+ * Restore a backend's index from its image and journal (warm start)
+ *
+ * Maps <mount>/.objmapper.idx without reading its slots and replays
+ * <mount>/.objmapper.journal. Objects in the image become index entries
+ * the first time a lookup misses on them, so startup cost follows the
+ * journal length and the hot set rather than the object count. From here
+ * on every mutation of the backend is journaled.
+ *
+ * @param mgr Backend manager
+ * @param backend_id Backend to restore
+ * @return Number of objects restored, or -1 if there is no usable image
+ *         (the caller should scan and checkpoint)
+ */
+int backend_manager_restore(backend_manager_t *mgr, int backend_id);
+
+/**
+ * Write a fresh image of a backend and truncate its journal
+ *
+ * Enables journaling if restore did not. backend_manager_destroy()
+ * checkpoints every journaled backend that changed.
+ *
+ * @param mgr Backend manager
+ * @param backend_id Backend to checkpoint
+ * @return 0 on success, -1 on error
+ */
+int backend_manager_checkpoint(backend_manager_t *mgr, int backend_id);
+
 /**
  * Get object metadata
  *
@@ -275,6 +548,11 @@ int backend_get_metadata(backend_manager_t *mgr,
 /**
  * Update object size (after write)
  *
+ * Marks the end of the write: an object on a memfd backend is sealed
+ * against writes, truncation and growth, so its FDs can be handed out and
+ * mapped shared read-only. The index takes over the size, and the mtime
+ * of the report, from then on (INDEX_FLAG_UNSETTLED is cleared).
+ *
  * @param mgr Backend manager
  * @param uri Object URI
  * @param new_size New size in bytes
@@ -291,18 +569,69 @@ int backend_update_size(backend_manager_t *mgr,
 /**
  * Migrate an object to a different backend
  *
+ * The data is copied without any backend lock held (reflink or
+ * copy_file_range where the filesystems allow), into a staging file that is
+ * renamed into place when the entry is repointed. Creates and lookups on
+ * either backend only wait for that final swap.
+ *
  * @param mgr Backend manager
  * @param uri Object URI
  * @param target_backend_id Destination backend
- * @return 0 on success, -1 on error
+ * @return 0 on success, -1 on error (or if the object kept changing)
  */
 int backend_migrate_object(backend_manager_t *mgr,
                            const char *uri,
                            int target_backend_id);
 
+/**
+ * Migration completion callback
+ *
+ * Runs on the migration thread; result is backend_migrate_object()'s.
+ */
+typedef void (*backend_migrate_cb)(const char *uri, int target_backend_id,
+                                   int result, void *arg);
+
+/**
+ * Queue a migration for the background migration thread
+ *
+ * The thread is started on first use and stopped by
+ * backend_manager_destroy(); jobs still queued then complete with -1.
+ *
+ * @param mgr Backend manager
+ * @param uri Object URI (copied)
+ * @param target_backend_id Destination backend
+ * @param cb Completion callback (NULL = none)
+ * @param arg Passed to cb
+ * @return 0 if queued, -1 on error (queue full)
+ */
+int backend_migrate_object_async(backend_manager_t *mgr,
+                                 const char *uri,
+                                 int target_backend_id,
+                                 backend_migrate_cb cb,
+                                 void *arg);
+
+/**
+ * Wait until every queued migration has completed
+ *
+ * @param mgr Backend manager
+ */
+void backend_migrate_drain(backend_manager_t *mgr);
+
 /**
  * Start automatic caching (hot objects to memory backend)
  *
+ * Every check interval the caching thread samples a batch of each backend
+ * index. Cache residents are evicted coldest-first while the cache is above
+ * its high watermark (down to the low watermark), and residents whose
+ * hotness fell below half of cache_threshold are dropped regardless. Below
+ * the low watermark the hottest sampled objects at or above cache_threshold
+ * are promoted until the low watermark would be crossed.
+ *
+ * Promoting a persistent object copies it and keeps the durable copy on its
+ * home backend (INDEX_FLAG_CACHED), so eviction is just a repoint back.
+ * The cache backend's migration policy gates the engine: CAPACITY evicts
+ * only, HOTNESS promotes only, HYBRID does both, NONE does nothing.
+ *
  * @param mgr Backend manager
  * @param check_interval_us How often to check for cache promotion (microseconds)
  * @param cache_threshold Minimum hotness for caching (0.0-1.0)
@@ -319,9 +648,45 @@ int backend_start_caching(backend_manager_t *mgr,
  */
 void backend_stop_caching(backend_manager_t *mgr);
 
+/**
+ * Set bounds on caching thread work
+ *
+ * @param mgr Backend manager
+ * @param scan_batch Entries sampled per backend per interval (0 = keep)
+ * @param max_migrations Objects moved per interval (0 = keep)
+ * @param max_bytes_per_sec Copy bandwidth cap (0 = unlimited)
+ * @return 0 on success, -1 on error
+ */
+int backend_set_cache_limits(backend_manager_t *mgr,
+                             size_t scan_batch,
+                             size_t max_migrations,
+                             uint64_t max_bytes_per_sec);
+
+/**
+ * Get caching engine statistics
+ *
+ * @param mgr Backend manager
+ * @param stats_out Output statistics
+ * @return 0 on success, -1 on error
+ */
+int backend_get_cache_stats(backend_manager_t *mgr, cache_stats_t *stats_out);
+
+/**
+ * Memory tier statistics of a NUMA node
+ *
+ * @param mgr Backend manager
+ * @param node NUMA node
+ * @param stats_out Output statistics
+ * @return 0 on success, -1 if the node has no memory tier
+ */
+int backend_get_numa_stats(backend_manager_t *mgr, int node, numa_stats_t *stats_out);
+
 /**
  * Manually promote object to cache (memory backend)
  *
+ * Goes to the memory tier of the node that reads the object most, if it
+ * has one.
+ *
  * @param mgr Backend manager
  * @param uri Object URI
  * @return 0 on success, -1 on error
@@ -365,6 +730,22 @@ int backend_set_watermarks(backend_manager_t *mgr,
                            double high_watermark,
                            double low_watermark);
 
+/**
+ * Set the compression level of a persistent backend
+ *
+ * Objects committed by backend_put_commit() or migrated in are stored
+ * compressed from then on (see compress.h); objects already stored keep
+ * their form. FD-pass writers write the live file and are never
+ * compressed. Memory backends cannot compress: they hold the plain copies
+ * FD-passing readers are given.
+ *
+ * @param mgr Backend manager
+ * @param backend_id Backend ID
+ * @param level 1 (fastest) to BACKEND_COMPRESS_MAX_LEVEL, 0 = off
+ * @return 0 on success, -1 on error
+ */
+int backend_set_compression(backend_manager_t *mgr, int backend_id, int level);
+
 /**
  * Set migration policy for backend
  *
@@ -445,6 +826,70 @@ int backend_get_hotness_map(backend_manager_t *mgr,
                             double **scores_out,
                             size_t *count_out);
 
+/**
+ * Streaming listing of the objects under a URI prefix
+ */
+typedef struct backend_list backend_list_t;
+
+/**
+ * An object of a prefix listing
+ */
+typedef struct backend_list_item {
+    char *uri;                       /* Caller frees */
+    index_entry_info_t info;         /* size_bytes is the object size */
+} backend_list_item_t;
+
+/* URIs a purge deletes per prefix index read */
+#define BACKEND_PURGE_BATCH 256
+
+/**
+ * Start listing the objects whose URI starts with prefix
+ *
+ * Every backend and every object still only in a backend image is covered
+ * (image URIs join the prefix index on the first listing or purge). The
+ * listing is of the URIs present now: objects created later are left out,
+ * and objects deleted before their batch is read are skipped. Chunks of
+ * chunked objects are not listed; their object is.
+ *
+ * @param mgr Backend manager
+ * @param prefix URI prefix ("" for every object)
+ * @return Listing (close with backend_list_close()), NULL on error
+ */
+backend_list_t *backend_list_open(backend_manager_t *mgr, const char *prefix);
+
+/**
+ * Next batch of a listing, in URI byte order
+ *
+ * @param list Listing
+ * @param items Output: up to max objects
+ * @param max Batch size
+ * @return Objects returned, 0 once the listing is complete
+ */
+size_t backend_list_next(backend_list_t *list, backend_list_item_t *items, size_t max);
+
+/**
+ * End a listing
+ *
+ * @param list Listing (NULL is ignored)
+ */
+void backend_list_close(backend_list_t *list);
+
+/**
+ * Delete every object whose URI starts with prefix
+ *
+ * The URIs present when the purge starts are deleted in batches of
+ * BACKEND_PURGE_BATCH, like backend_delete_object(); the prefix index is
+ * only locked while a batch is read, and lookups never wait on it. Work is
+ * proportional to the objects matched, not to the index. Objects created
+ * under the prefix meanwhile survive.
+ *
+ * @param mgr Backend manager
+ * @param prefix URI prefix ("" purges everything)
+ * @param purged_out Output: objects deleted (may be NULL)
+ * @return 0 on success, -1 on error
+ */
+int backend_purge_prefix(backend_manager_t *mgr, const char *prefix, size_t *purged_out);
+
 /**
  * Get global index statistics
  *
@@ -0,0 +1,397 @@
+/**
+ * @file chunk.c
+ * @brief Chunked storage of large objects and byte-range reads
+ *
+ * Built on the object API: chunks and manifests are written with atomic
+ * PUTs and read through the index's FD cache, so everything else in the
+ * backend (tiering, caching, journaling) only ever sees ordinary objects.
+ */
+
+#define _GNU_SOURCE
+#include "chunk.h"
+#include "compress.h"
+#include <endian.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define CHUNK_MAGIC         "OBJCHUNK"
+#define CHUNK_MAGIC_LEN     8
+#define CHUNK_URI_MAX       1024
+
+bool backend_flags_chunked(uint32_t flags) {
+    return (flags & INDEX_FLAG_CHUNKED) != 0;
+}
+
+int backend_chunk_uri(const char *uri, uint64_t index, char *buf, size_t size) {
+    int n = snprintf(buf, size, "%s" BACKEND_CHUNK_SUFFIX "%08" PRIx64, uri, index);
+    return (n < 0 || (size_t)n >= size) ? -1 : 0;
+}
+
+bool backend_uri_is_chunk(const char *uri) {
+    if (!uri) return false;
+    
+    const char *suffix = strstr(uri, BACKEND_CHUNK_SUFFIX);
+    if (!suffix) return false;
+    
+    /* The last ".chunks/" counts: an object URI may contain one too */
+    const char *next;
+    while ((next = strstr(suffix + 1, BACKEND_CHUNK_SUFFIX)) != NULL) suffix = next;
+    
+    const char *digits = suffix + strlen(BACKEND_CHUNK_SUFFIX);
+    size_t len = strlen(digits);
+    return len >= 8 && strspn(digits, "0123456789abcdef") == len;
+}
+
+int backend_set_chunk_size(backend_manager_t *mgr, uint64_t chunk_bytes) {
+    if (!mgr || chunk_bytes < BACKEND_CHUNK_MIN_BYTES) return -1;
+    
+    mgr->chunk_bytes = chunk_bytes;
+    return 0;
+}
+
+/* ============================================================================
+ * Manifest
+ * ============================================================================ */
+
+static int manifest_parse(int fd, uint64_t *chunk_bytes, uint64_t *size) {
+    uint8_t buf[BACKEND_CHUNK_MANIFEST_BYTES];
+    ssize_t n;
+    do {
+        n = pread(fd, buf, sizeof(buf), 0);
+    } while (n < 0 && errno == EINTR);
+    if (n != (ssize_t)sizeof(buf) || memcmp(buf, CHUNK_MAGIC, CHUNK_MAGIC_LEN) != 0) {
+        return -1;
+    }
+    
+    uint64_t le[2];
+    memcpy(le, buf + CHUNK_MAGIC_LEN, sizeof(le));
+    *chunk_bytes = le64toh(le[0]);
+    *size = le64toh(le[1]);
+    return *chunk_bytes > 0 ? 0 : -1;
+}
+
+/* Manifest of uri, and its entry (info may be NULL) */
+static int manifest_read(backend_manager_t *mgr, const char *uri, uint64_t *chunk_bytes,
+                         uint64_t *size, index_entry_info_t *info) {
+    index_entry_info_t local;
+    if (!info) info = &local;
+    
+    int fd = backend_get_stored_fd(mgr, uri, info);
+    if (fd < 0) return -1;
+    
+    int ret = backend_flags_chunked(info->flags) ? manifest_parse(fd, chunk_bytes, size) : -1;
+    close(fd);
+    return ret;
+}
+
+/* Publish a new manifest (an atomic PUT like any other) */
+static int manifest_write(backend_manager_t *mgr, const char *uri, bool ephemeral,
+                          uint64_t chunk_bytes, uint64_t size) {
+    object_create_req_t req = {
+        .uri = uri,
+        .backend_id = -1,
+        .ephemeral = ephemeral,
+        .size_hint = 0,
+        .flags = INDEX_FLAG_CHUNKED,
+        .replace = true
+    };
+    
+    uint8_t buf[BACKEND_CHUNK_MANIFEST_BYTES];
+    uint64_t le[2] = { htole64(chunk_bytes), htole64(size) };
+    memcpy(buf, CHUNK_MAGIC, CHUNK_MAGIC_LEN);
+    memcpy(buf + CHUNK_MAGIC_LEN, le, sizeof(le));
+    
+    object_put_t put;
+    if (backend_put_begin(mgr, &req, &put) < 0) return -1;
+    if (pwrite(put.fd, buf, sizeof(buf), 0) != (ssize_t)sizeof(buf)) {
+        backend_put_abort(&put);
+        return -1;
+    }
+    return backend_put_commit(mgr, &put, sizeof(buf));
+}
+
+int backend_chunk_manifest(backend_manager_t *mgr, const char *uri,
+                           uint64_t *chunk_bytes_out, uint64_t *size_out) {
+    if (!mgr || !uri) return -1;
+    
+    uint64_t chunk_bytes, size;
+    if (manifest_read(mgr, uri, &chunk_bytes, &size, NULL) < 0) return -1;
+    
+    if (chunk_bytes_out) *chunk_bytes_out = chunk_bytes;
+    if (size_out) *size_out = size;
+    return 0;
+}
+
+/* ============================================================================
+ * Parts
+ * ============================================================================ */
+
+/**
+ * Object size after a part lands, or -1 if the part is not allowed
+ *
+ * The chunk at or past the current end is the last one and sets the size
+ * (it may shorten the object). Any other part must fill its chunk, and no
+ * part may start past a short last chunk. A first part that declares the
+ * total is checked against that instead of the current end.
+ */
+static int part_new_size(uint64_t chunk_bytes, uint64_t cur, uint64_t offset,
+                         uint64_t size, uint64_t *new_size) {
+    if (offset % chunk_bytes != 0 || size > chunk_bytes) return -1;
+    if (cur % chunk_bytes != 0 && offset >= cur) return -1;
+    
+    bool last = offset + chunk_bytes >= cur;
+    if (!last && size < chunk_bytes) return -1;
+    
+    *new_size = last ? offset + size : cur;
+    return 0;
+}
+
+int backend_put_part_begin(backend_manager_t *mgr, const object_create_req_t *req,
+                           uint64_t offset, object_put_t *put) {
+    if (!mgr || !req || !req->uri || !put) return -1;
+    
+    memset(put, 0, sizeof(*put));
+    put->fd = -1;
+    
+    /* An existing chunked object keeps its chunk size and its tier class */
+    uint64_t chunk_bytes = mgr->chunk_bytes, cur;
+    index_entry_info_t info;
+    if (manifest_read(mgr, req->uri, &chunk_bytes, &cur, &info) == 0 &&
+        ((info.flags & INDEX_FLAG_EPHEMERAL) != 0) != req->ephemeral) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (offset % chunk_bytes != 0 || (req->part_total > 0 && offset != 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+    
+    char chunk_uri[CHUNK_URI_MAX];
+    if (backend_chunk_uri(req->uri, offset / chunk_bytes, chunk_uri, sizeof(chunk_uri)) < 0) {
+        return -1;
+    }
+    
+    object_create_req_t chunk_req = *req;
+    chunk_req.uri = chunk_uri;
+    chunk_req.size_hint = chunk_bytes;
+    chunk_req.flags &= ~INDEX_FLAG_CHUNKED;
+    chunk_req.part_total = 0;
+    if (backend_put_begin(mgr, &chunk_req, put) < 0) return -1;
+    
+    put->part_of = strdup(req->uri);
+    if (!put->part_of) {
+        backend_put_abort(put);
+        return -1;
+    }
+    put->part_offset = offset;
+    put->part_total = req->part_total;
+    return 0;
+}
+
+int backend_chunk_commit(backend_manager_t *mgr, object_put_t *put, uint64_t size) {
+    if (!mgr || !put || !put->part_of) {
+        backend_put_abort(put);
+        return -1;
+    }
+    
+    /* From here on put is a plain PUT of the chunk */
+    char *uri = put->part_of;
+    put->part_of = NULL;
+    uint64_t offset = put->part_offset;
+    uint64_t total = put->part_total;
+    bool ephemeral = (put->flags & INDEX_FLAG_EPHEMERAL) != 0;
+    
+    /* A first part that declares the total starts a new version: it fits
+     * an object of that size, whatever is there now */
+    uint64_t chunk_bytes = mgr->chunk_bytes, cur = 0, new_size;
+    pthread_mutex_lock(&mgr->chunk_lock);
+    manifest_read(mgr, uri, &chunk_bytes, &cur, NULL);
+    int ret = part_new_size(chunk_bytes, total > 0 ? total : cur, offset, size, &new_size);
+    pthread_mutex_unlock(&mgr->chunk_lock);
+    
+    if (ret < 0) {
+        backend_put_abort(put);
+        free(uri);
+        errno = EINVAL;
+        return -1;
+    }
+    
+    /* The chunk is published (and compressed) without the lock, so parts
+     * land in parallel; only the manifest update is serialized */
+    if (backend_put_commit(mgr, put, size) < 0) {
+        free(uri);
+        return -1;
+    }
+    
+    pthread_mutex_lock(&mgr->chunk_lock);
+    cur = 0;
+    manifest_read(mgr, uri, &chunk_bytes, &cur, NULL);
+    if (total == 0 && part_new_size(chunk_bytes, cur, offset, size, &new_size) < 0) {
+        new_size = cur > offset + size ? cur : offset + size;
+    }
+    ret = manifest_write(mgr, uri, ephemeral, chunk_bytes, new_size);
+    pthread_mutex_unlock(&mgr->chunk_lock);
+    
+    /* A shorter new version leaves the old one's tail behind */
+    if (ret == 0 && total > 0 && cur > new_size) {
+        backend_chunk_drop(mgr, uri, chunk_bytes, new_size, cur);
+    }
+    
+    free(uri);
+    return ret;
+}
+
+void backend_chunk_drop(backend_manager_t *mgr, const char *uri,
+                        uint64_t chunk_bytes, uint64_t from, uint64_t size) {
+    if (!mgr || !uri || chunk_bytes == 0) return;
+    
+    char chunk_uri[CHUNK_URI_MAX];
+    uint64_t count = (size + chunk_bytes - 1) / chunk_bytes;
+    for (uint64_t i = (from + chunk_bytes - 1) / chunk_bytes; i < count; i++) {
+        if (backend_chunk_uri(uri, i, chunk_uri, sizeof(chunk_uri)) == 0) {
+            backend_delete_object(mgr, chunk_uri);  /* Parts never written are missing */
+        }
+    }
+}
+
+/* ============================================================================
+ * Ranges
+ * ============================================================================ */
+
+/* Open chunk index of a chunked object as an extent clipped to [offset, end) */
+static int chunk_extent(backend_manager_t *mgr, const char *uri, uint64_t index,
+                        uint64_t chunk_bytes, uint64_t size, uint64_t offset,
+                        uint64_t end, backend_extent_t *extent) {
+    char chunk_uri[CHUNK_URI_MAX];
+    if (backend_chunk_uri(uri, index, chunk_uri, sizeof(chunk_uri)) < 0) return -1;
+    
+    int fd = backend_get_object_fd(mgr, chunk_uri, NULL);
+    if (fd < 0) {
+        errno = ENODATA;
+        return -1;
+    }
+    
+    uint64_t base = index * chunk_bytes;
+    uint64_t span = size - base < chunk_bytes ? size - base : chunk_bytes;
+    
+    /* A chunk still shorter than the manifest says is being rewritten */
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (uint64_t)st.st_size < span) {
+        close(fd);
+        errno = ENODATA;
+        return -1;
+    }
+    
+    extent->fd = fd;
+    extent->base = base;
+    extent->span = span;
+    extent->offset = offset > base ? offset : base;
+    extent->length = (end < base + span ? end : base + span) - extent->offset;
+    return 0;
+}
+
+int backend_get_range(backend_manager_t *mgr, const char *uri,
+                      uint64_t offset, uint64_t length, size_t max_extents,
+                      backend_range_t *range_out) {
+    if (!mgr || !uri || !range_out) return -1;
+    
+    memset(range_out, 0, sizeof(*range_out));
+    index_entry_info_t *info = &range_out->info;
+    
+    int fd = backend_get_stored_fd(mgr, uri, info);
+    if (fd < 0) {
+        errno = ENOENT;
+        return -1;
+    }
+    
+    uint64_t chunk_bytes = 0, size;
+    bool chunked = backend_flags_chunked(info->flags);
+    if (chunked) {
+        int ret = manifest_parse(fd, &chunk_bytes, &size);
+        close(fd);
+        fd = -1;
+        if (ret < 0) {
+            errno = EIO;
+            return -1;
+        }
+    } else {
+        if (backend_flags_compressed(info->flags)) {
+            close(fd);
+            fd = backend_get_object_fd(mgr, uri, info);
+            if (fd < 0) {
+                errno = ENOENT;
+                return -1;
+            }
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            close(fd);
+            return -1;
+        }
+        size = st.st_size;
+    }
+    
+    /* As in HTTP, a range must start inside the object (an empty object
+     * has the empty range) */
+    if (offset > size || (offset == size && size > 0)) {
+        if (fd >= 0) close(fd);
+        errno = ERANGE;
+        return -1;
+    }
+    uint64_t end = (length == 0 || length > size - offset) ? size : offset + length;
+    
+    range_out->size = size;
+    range_out->offset = offset;
+    info->size_bytes = size;
+    
+    if (!chunked) {
+        range_out->extents = malloc(sizeof(*range_out->extents));
+        if (!range_out->extents) {
+            close(fd);
+            return -1;
+        }
+        range_out->extents[0] = (backend_extent_t){
+            .fd = fd, .base = 0, .span = size, .offset = offset, .length = end - offset
+        };
+        range_out->num_extents = 1;
+        range_out->length = end - offset;
+        return 0;
+    }
+    
+    uint64_t first = offset / chunk_bytes;
+    uint64_t last = (end > offset) ? (end - 1) / chunk_bytes : first;
+    size_t count = last - first + 1;
+    if (max_extents > 0 && count > max_extents) count = max_extents;
+    
+    range_out->extents = calloc(count, sizeof(*range_out->extents));
+    if (!range_out->extents) return -1;
+    
+    for (size_t i = 0; i < count; i++) {
+        backend_extent_t *extent = &range_out->extents[i];
+        if (chunk_extent(mgr, uri, first + i, chunk_bytes, size, offset, end, extent) < 0) {
+            int saved_errno = errno;
+            backend_range_release(range_out);
+            errno = saved_errno;
+            return -1;
+        }
+        range_out->num_extents++;
+        range_out->length += extent->length;
+    }
+    return 0;
+}
+
+void backend_range_release(backend_range_t *range) {
+    if (!range) return;
+    
+    for (size_t i = 0; i < range->num_extents; i++) {
+        if (range->extents[i].fd >= 0) close(range->extents[i].fd);
+    }
+    free(range->extents);
+    range->extents = NULL;
+    range->num_extents = 0;
+}
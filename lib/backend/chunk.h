@@ -0,0 +1,198 @@
+/**
+ * @file chunk.h
+ * @brief Chunked storage of large objects and byte-range reads
+ *
+ * A chunked object is a run of ordinary objects, its chunks, plus a small
+ * manifest under its own URI whose entry is flagged INDEX_FLAG_CHUNKED.
+ * Chunk n of <uri> is the object <uri>.chunks/<n as 8 hex digits> and
+ * holds bytes [n * chunk_bytes, (n + 1) * chunk_bytes). Chunks are indexed,
+ * journaled, promoted and evicted like any other object, so the caching
+ * engine keeps only the hot parts of a large object in the memory tier.
+ *
+ * The manifest is BACKEND_CHUNK_MANIFEST_BYTES bytes:
+ * - magic "OBJCHUNK"
+ * - chunk size, little-endian (8 bytes)
+ * - object size, little-endian (8 bytes)
+ *
+ * Chunked objects are written in parts, one chunk per part, in any order
+ * and from any number of writers at once (backend_put_part_begin()). The
+ * object size is the end of the furthest part committed; every part but
+ * the last must fill its chunk. A first part that declares the object's
+ * total size (object_create_req_t.part_total) starts a new version: the
+ * size is reset to the total and chunks past it are dropped, so a shorter
+ * version needs no DELETE first. Deleting or overwriting the object with a
+ * plain PUT drops its chunks. A chunked object has no single FD: it is
+ * read by range (backend_get_range()), and backend_get_object_fd() fails
+ * on it. backend_get_stored_fd() returns its manifest.
+ */
+
+#ifndef BACKEND_CHUNK_H
+#define BACKEND_CHUNK_H
+
+#include "backend.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Chunk size of new chunked objects (backend_set_chunk_size()) */
+#define BACKEND_CHUNK_DEFAULT_BYTES  (8ULL * 1024 * 1024)
+#define BACKEND_CHUNK_MIN_BYTES      (64 * 1024)
+
+/* Chunk n of <uri> is <uri>.chunks/%08x */
+#define BACKEND_CHUNK_SUFFIX         ".chunks/"
+
+/* Magic, chunk size, object size */
+#define BACKEND_CHUNK_MANIFEST_BYTES 24
+
+/**
+ * Part of an object held by one FD
+ *
+ * The FD holds object bytes [base, base + span) from file offset 0; the
+ * extent is bytes [offset, offset + length) of them.
+ */
+typedef struct backend_extent {
+    int fd;                          /* Read-only FD, plain bytes */
+    uint64_t base;                   /* Object offset of the FD's first byte */
+    uint64_t span;                   /* Object bytes the FD holds */
+    uint64_t offset;                 /* Object offset of the extent */
+    uint64_t length;                 /* Extent bytes */
+} backend_extent_t;
+
+/**
+ * A byte range of an object, as FD extents
+ */
+typedef struct backend_range {
+    uint64_t size;                   /* Object size */
+    uint64_t offset;                 /* First byte of the range */
+    uint64_t length;                 /* Bytes the extents cover (clamped to the object) */
+    index_entry_info_t info;         /* Object (or manifest) entry; size_bytes = size */
+    backend_extent_t *extents;       /* In object order */
+    size_t num_extents;
+} backend_range_t;
+
+/**
+ * Whether an entry is the manifest of a chunked object
+ *
+ * @param flags INDEX_FLAG_* of the entry (or of an index_entry_info_t)
+ * @return true if the object is chunked
+ */
+bool backend_flags_chunked(uint32_t flags);
+
+/**
+ * URI of a chunk
+ *
+ * @param uri Object URI
+ * @param index Chunk number
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @return 0 on success, -1 if it does not fit
+ */
+int backend_chunk_uri(const char *uri, uint64_t index, char *buf, size_t size);
+
+/**
+ * Whether a URI names a chunk of a chunked object
+ *
+ * @param uri URI
+ * @return true for <uri>.chunks/<8 hex digits>
+ */
+bool backend_uri_is_chunk(const char *uri);
+
+/**
+ * Set the chunk size of new chunked objects
+ *
+ * Objects already chunked keep theirs (it is in their manifest).
+ *
+ * @param mgr Backend manager
+ * @param chunk_bytes At least BACKEND_CHUNK_MIN_BYTES
+ * @return 0 on success, -1 on error
+ */
+int backend_set_chunk_size(backend_manager_t *mgr, uint64_t chunk_bytes);
+
+/**
+ * Read a chunked object's manifest
+ *
+ * @param mgr Backend manager
+ * @param uri Object URI
+ * @param chunk_bytes_out Output: chunk size (may be NULL)
+ * @param size_out Output: object size (may be NULL)
+ * @return 0 on success, -1 if the object is missing or not chunked
+ */
+int backend_chunk_manifest(backend_manager_t *mgr, const char *uri,
+                           uint64_t *chunk_bytes_out, uint64_t *size_out);
+
+/**
+ * Start writing one part of a chunked object
+ *
+ * offset must be a multiple of the object's chunk size (the manager's for
+ * a new object) and the part may be at most one chunk long. The part is
+ * an atomic PUT of its chunk (see backend_put_begin()); committing it with
+ * backend_put_commit() also extends the object. A plain object under the
+ * URI is replaced by the chunked one when the first part commits. With
+ * req->part_total (offset 0 only) the commit instead sets the object's size
+ * to the total and drops the chunks of an older version past it.
+ *
+ * @param mgr Backend manager
+ * @param req Creation request for the object (not the chunk)
+ * @param offset Object offset of the part
+ * @param put Output PUT state
+ * @return 0 on success, -1 on error (errno EINVAL: misaligned offset, a
+ *         total on a part other than the first, or ephemeral flag
+ *         different from the existing chunked object)
+ */
+int backend_put_part_begin(backend_manager_t *mgr, const object_create_req_t *req,
+                           uint64_t offset, object_put_t *put);
+
+/**
+ * Commit a part (backend_put_commit() for puts with part_of set)
+ *
+ * @param mgr Backend manager
+ * @param put PUT from backend_put_part_begin()
+ * @param size Bytes written
+ * @return 0 on success, -1 on error (errno EINVAL: longer than a chunk,
+ *         or a short part that is not the last)
+ */
+int backend_chunk_commit(backend_manager_t *mgr, object_put_t *put, uint64_t size);
+
+/**
+ * Delete the chunks of a chunked object past a new end
+ *
+ * Used with from = 0 once the manifest is gone, and with the new size
+ * when a new version is shorter than the old one.
+ *
+ * @param mgr Backend manager
+ * @param uri Object URI
+ * @param chunk_bytes Chunk size from the manifest
+ * @param from Bytes to keep (chunks holding any of them stay)
+ * @param size Old object size from the manifest
+ */
+void backend_chunk_drop(backend_manager_t *mgr, const char *uri,
+                        uint64_t chunk_bytes, uint64_t from, uint64_t size);
+
+/**
+ * Open a byte range of an object
+ *
+ * Works on plain and chunked objects alike: a plain object is one extent,
+ * a chunked one an extent per chunk the range touches. Every FD reads
+ * plain bytes, and each chunk read counts as an access to that chunk.
+ *
+ * @param mgr Backend manager
+ * @param uri Object URI
+ * @param offset First byte
+ * @param length Bytes (0 = to the end; clamped to the object)
+ * @param max_extents Stop after this many extents (0 = the whole range;
+ *        1 gives the FD holding offset, e.g. to pass it)
+ * @param range_out Output range (release with backend_range_release())
+ * @return 0 on success, -1 on error (errno ENOENT: no such object,
+ *         ERANGE: offset past the end, ENODATA: a chunk is not written yet)
+ */
+int backend_get_range(backend_manager_t *mgr, const char *uri,
+                      uint64_t offset, uint64_t length, size_t max_extents,
+                      backend_range_t *range_out);
+
+/**
+ * Close a range's FDs and free its extents
+ *
+ * @param range Range from backend_get_range()
+ */
+void backend_range_release(backend_range_t *range);
+
+#endif /* BACKEND_CHUNK_H */
@@ -0,0 +1,199 @@
+/**
+ * @file compress.c
+ * @brief Compressed object storage for persistent backends
+ *
+ * zlib in gzip mode, streamed through two fixed buffers with pread() and
+ * pwrite(), so objects of any size compress in constant memory and the
+ * descriptors' file offsets are never touched.
+ */
+
+#define _GNU_SOURCE
+#include "compress.h"
+#include "backend.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define COMPRESS_CHUNK      (256 * 1024)
+#define COMPRESS_GZIP_BITS  (15 + 16)  /* Largest window, gzip wrapper */
+#define COMPRESS_OS_UNIX    3          /* gzip header OS field */
+
+/* Size subfield: 'O' 'M', LEN = 8 */
+#define SUBFIELD_ID1        'O'
+#define SUBFIELD_ID2        'M'
+#define SUBFIELD_LEN        8
+#define EXTRA_LEN           (4 + SUBFIELD_LEN)
+
+bool backend_flags_compressed(uint32_t flags) {
+    return (flags & INDEX_FLAG_COMPRESSED) && !(flags & INDEX_FLAG_CACHED);
+}
+
+static ssize_t pread_full(int fd, void *buf, size_t len, off_t off) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pread(fd, (uint8_t *)buf + done, len - done, off + done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        done += n;
+    }
+    return done;
+}
+
+static int pwrite_full(int fd, const void *buf, size_t len, off_t off) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pwrite(fd, (const uint8_t *)buf + done, len - done, off + done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        done += n;
+    }
+    return 0;
+}
+
+int backend_compress_fd(int src_fd, uint64_t size, int dst_fd, int level,
+                        uint64_t *stored_out) {
+    if (level < 1) level = 1;
+    if (level > BACKEND_COMPRESS_MAX_LEVEL) level = BACKEND_COMPRESS_MAX_LEVEL;
+    
+    uint8_t extra[EXTRA_LEN] = { SUBFIELD_ID1, SUBFIELD_ID2, SUBFIELD_LEN, 0 };
+    for (int i = 0; i < 8; i++) {
+        extra[4 + i] = (uint8_t)(size >> (8 * i));
+    }
+    gz_header header = {
+        .extra = extra,
+        .extra_len = EXTRA_LEN,
+        .os = COMPRESS_OS_UNIX,
+    };
+    
+    uint8_t *in = malloc(COMPRESS_CHUNK);
+    uint8_t *out = malloc(COMPRESS_CHUNK);
+    z_stream zs = {0};
+    bool ready = in && out &&
+                 deflateInit2(&zs, level, Z_DEFLATED, COMPRESS_GZIP_BITS, 8,
+                              Z_DEFAULT_STRATEGY) == Z_OK;
+    if (!ready) {
+        free(in);
+        free(out);
+        return -1;
+    }
+    
+    int ret = -1;
+    if (deflateSetHeader(&zs, &header) != Z_OK) goto out;
+    
+    uint64_t limit = size - size / BACKEND_COMPRESS_MIN_SAVING;
+    uint64_t read_off = 0, write_off = 0;
+    int flush = Z_NO_FLUSH;
+    
+    do {
+        if (zs.avail_in == 0 && flush == Z_NO_FLUSH) {
+            size_t want = size - read_off < COMPRESS_CHUNK ? size - read_off
+                                                           : COMPRESS_CHUNK;
+            ssize_t n = pread_full(src_fd, in, want, read_off);
+            if (n < 0 || (size_t)n < want) goto out;  /* Error, or the source shrank */
+            read_off += n;
+            zs.next_in = in;
+            zs.avail_in = n;
+            if (read_off == size) flush = Z_FINISH;
+        }
+        
+        zs.next_out = out;
+        zs.avail_out = COMPRESS_CHUNK;
+        int zret = deflate(&zs, flush);
+        if (zret == Z_STREAM_ERROR) goto out;
+        
+        size_t produced = COMPRESS_CHUNK - zs.avail_out;
+        if (write_off + produced > limit) {
+            ret = 1;
+            goto out;
+        }
+        if (produced > 0 && pwrite_full(dst_fd, out, produced, write_off) < 0) goto out;
+        write_off += produced;
+        
+        if (zret == Z_STREAM_END) {
+            if (stored_out) *stored_out = write_off;
+            ret = 0;
+        }
+    } while (ret < 0);
+    
+out:
+    deflateEnd(&zs);
+    free(in);
+    free(out);
+    return ret;
+}
+
+int backend_compressed_size(int fd, uint64_t *size_out) {
+    uint8_t hdr[BACKEND_COMPRESS_HEADER_BYTES];
+    if (pread_full(fd, hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)) return -1;
+    
+    /* Magic, deflate, FEXTRA and our subfield first */
+    if (hdr[0] != 0x1f || hdr[1] != 0x8b || hdr[2] != Z_DEFLATED ||
+        !(hdr[3] & 0x04) || hdr[10] < EXTRA_LEN || hdr[11] != 0 ||
+        hdr[12] != SUBFIELD_ID1 || hdr[13] != SUBFIELD_ID2 ||
+        hdr[14] != SUBFIELD_LEN || hdr[15] != 0) {
+        return -1;
+    }
+    
+    uint64_t size = 0;
+    for (int i = 0; i < 8; i++) {
+        size |= (uint64_t)hdr[16 + i] << (8 * i);
+    }
+    if (size_out) *size_out = size;
+    return 0;
+}
+
+int backend_decompress_fd(int src_fd, int dst_fd, uint64_t *size_out) {
+    uint64_t size;
+    if (backend_compressed_size(src_fd, &size) < 0) return -1;
+    
+    uint8_t *in = malloc(COMPRESS_CHUNK);
+    uint8_t *out = malloc(COMPRESS_CHUNK);
+    z_stream zs = {0};
+    if (!in || !out || inflateInit2(&zs, COMPRESS_GZIP_BITS) != Z_OK) {
+        free(in);
+        free(out);
+        return -1;
+    }
+    
+    int ret = -1;
+    uint64_t read_off = 0, write_off = 0;
+    
+    for (;;) {
+        if (zs.avail_in == 0) {
+            ssize_t n = pread_full(src_fd, in, COMPRESS_CHUNK, read_off);
+            if (n <= 0) break;  /* Error, or truncated */
+            read_off += n;
+            zs.next_in = in;
+            zs.avail_in = n;
+        }
+        
+        zs.next_out = out;
+        zs.avail_out = COMPRESS_CHUNK;
+        int zret = inflate(&zs, Z_NO_FLUSH);
+        if (zret != Z_OK && zret != Z_STREAM_END) break;
+        
+        size_t produced = COMPRESS_CHUNK - zs.avail_out;
+        if (write_off + produced > size) break;
+        if (produced > 0 && pwrite_full(dst_fd, out, produced, write_off) < 0) break;
+        write_off += produced;
+        
+        if (zret == Z_STREAM_END) {
+            if (write_off == size) ret = 0;
+            break;
+        }
+    }
+    
+    inflateEnd(&zs);
+    free(in);
+    free(out);
+    
+    if (ret == 0 && size_out) *size_out = write_off;
+    return ret;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file compress.h
+ * @brief Compressed object storage for persistent backends
+ *
+ * Backends with a compression level (backend_set_compression()) store
+ * objects written by a PUT commit or moved in by migration compressed,
+ * and mark their entries INDEX_FLAG_COMPRESSED. The stored file is a
+ * single gzip member (RFC 1952), so it can go to a client that accepts
+ * gzip as is; its extra field carries the uncompressed size, so a reader
+ * knows it without inflating anything:
+ * - 10-byte gzip header with FEXTRA set, XLEN = 12
+ * - subfield 'O' 'M', length 8: uncompressed size, little-endian
+ *
+ * The flag describes the durable copy. A cache copy (INDEX_FLAG_CACHED)
+ * is always plain: objects are inflated when they are promoted into the
+ * memory tier, so FD-passing clients only ever see plain bytes.
+ */
+
+#ifndef BACKEND_COMPRESS_H
+#define BACKEND_COMPRESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Compression levels (zlib: 1 = fastest, 9 = smallest; 0 = off) */
+#define BACKEND_COMPRESS_DEFAULT_LEVEL  3
+#define BACKEND_COMPRESS_MAX_LEVEL      9
+
+/* Smaller objects are stored as is: they occupy a block either way */
+#define BACKEND_COMPRESS_MIN_BYTES      4096
+
+/* Stored compressed only if that saves at least 1/8 of the size */
+#define BACKEND_COMPRESS_MIN_SAVING     8
+
+/* Bytes before the deflate data (gzip header and size subfield) */
+#define BACKEND_COMPRESS_HEADER_BYTES   24
+
+/**
+ * Whether the bytes an entry's location holds are compressed
+ *
+ * @param flags INDEX_FLAG_* of the entry (or of an index_entry_info_t)
+ * @return true for a compressed durable copy that is not cached
+ */
+bool backend_flags_compressed(uint32_t flags);
+
+/**
+ * Compress size bytes of src_fd into dst_fd
+ *
+ * Both files are accessed at explicit offsets from 0; dst_fd should be
+ * empty. Gives up as soon as the output can no longer save
+ * 1/BACKEND_COMPRESS_MIN_SAVING of the input.
+ *
+ * @param src_fd Plain object
+ * @param size Bytes to compress
+ * @param dst_fd Destination file
+ * @param level Compression level (1 to BACKEND_COMPRESS_MAX_LEVEL)
+ * @param stored_out Output: compressed bytes written (may be NULL)
+ * @return 0 if compressed, 1 if not worth it (dst_fd holds garbage),
+ *         -1 on error or if src_fd is shorter than size
+ */
+int backend_compress_fd(int src_fd, uint64_t size, int dst_fd, int level,
+                        uint64_t *stored_out);
+
+/**
+ * Inflate a compressed object into dst_fd
+ *
+ * The gzip CRC and the recorded size are both checked.
+ *
+ * @param src_fd Compressed object
+ * @param dst_fd Destination file (written from offset 0)
+ * @param size_out Output: plain bytes written (may be NULL)
+ * @return 0 on success, -1 on error or corrupt data
+ */
+int backend_decompress_fd(int src_fd, int dst_fd, uint64_t *size_out);
+
+/**
+ * Read the uncompressed size of a compressed object from its header
+ *
+ * @param fd Compressed object
+ * @param size_out Output: uncompressed size
+ * @return 0 on success, -1 if fd does not hold a compressed object
+ */
+int backend_compressed_size(int fd, uint64_t *size_out);
+
+#endif /* BACKEND_COMPRESS_H */
@@ -0,0 +1,448 @@
+/**
+ * @file durable.c
+ * @brief Group commit of persistent writes and background checkpoints
+ *
+ * Callers queue waiters (and notes of what changed) under the engine lock
+ * and sleep on it; the committer takes the whole round at once, syncs
+ * without the lock and wakes the round's waiters together.
+ */
+
+#define _GNU_SOURCE
+#include "durable.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * A caller sleeping until its round commits (on the caller's stack)
+ */
+typedef struct durable_waiter {
+    int result;
+    bool done;
+    struct durable_waiter *next;
+} durable_waiter_t;
+
+/**
+ * A file system whose data a round syncs, through one of its waiters' files
+ */
+typedef struct durable_data {
+    dev_t dev;
+    int fd;                          /* Open until its waiter wakes */
+} durable_data_t;
+
+/**
+ * What one round syncs
+ */
+typedef struct durable_round {
+    durable_waiter_t *waiters;
+    size_t num_waiters;
+    durable_data_t *data;            /* Distinct file systems */
+    size_t num_data;
+    size_t data_cap;
+    char **dirs;                     /* Owned; may repeat */
+    size_t num_dirs;
+    size_t dirs_cap;
+    index_journal_t **journals;      /* Distinct */
+    size_t num_journals;
+    size_t journals_cap;
+} durable_round_t;
+
+struct backend_durable {
+    backend_manager_t *mgr;
+    backend_durable_config_t config;
+    
+    pthread_mutex_t lock;
+    pthread_cond_t kick;             /* Committer: round opened or full, or stop */
+    pthread_cond_t done;             /* Waiters: a round committed */
+    pthread_cond_t tick;             /* Checkpointer: stop */
+    durable_round_t round;           /* Collecting */
+    uint64_t round_opened_us;        /* 0 = nothing to commit */
+    bool stop;
+    bool stopped;                    /* Committer gone: data syncs inline */
+    
+    pthread_t committer;
+    pthread_t checkpointer;
+    
+    atomic_uint_fast64_t rounds;
+    atomic_uint_fast64_t waits;
+    atomic_uint_fast64_t data_syncs;
+    atomic_uint_fast64_t dir_syncs;
+    atomic_uint_fast64_t journal_syncs;
+    atomic_uint_fast64_t errors;
+    atomic_uint_fast64_t checkpoints;
+    atomic_uint_fast64_t checkpoint_records;
+};
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void deadline_at(struct timespec *ts, uint64_t us) {
+    ts->tv_sec = us / 1000000;
+    ts->tv_nsec = (us % 1000000) * 1000;
+}
+
+/* The first change opens the round (caller holds the lock) */
+static void round_open(struct backend_durable *d) {
+    if (d->round_opened_us != 0) return;
+    d->round_opened_us = monotonic_us();
+    pthread_cond_signal(&d->kick);
+}
+
+static int dir_cmp(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static void round_free(durable_round_t *round) {
+    for (size_t i = 0; i < round->num_dirs; i++) {
+        free(round->dirs[i]);
+    }
+    free(round->dirs);
+    free(round->journals);
+    free(round->data);
+}
+
+/* Sync everything the round collected; returns -1 if any sync failed */
+static int round_commit(struct backend_durable *d, durable_round_t *round) {
+    int ret = 0;
+    
+    /* Object data, its writeback started when each file was queued */
+    for (size_t i = 0; i < round->num_data; i++) {
+        if (syncfs(round->data[i].fd) < 0) ret = -1;
+        atomic_fetch_add(&d->data_syncs, 1);
+    }
+    
+    /* Directory entries of published and removed objects */
+    if (round->num_dirs > 1) {
+        qsort(round->dirs, round->num_dirs, sizeof(*round->dirs), dir_cmp);
+    }
+    for (size_t i = 0; i < round->num_dirs; i++) {
+        if (i > 0 && strcmp(round->dirs[i], round->dirs[i - 1]) == 0) continue;
+    
+        int fd = open(round->dirs[i], O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            /* Removed with its last object: nothing left to persist */
+            if (errno != ENOENT) ret = -1;
+            continue;
+        }
+        if (fsync(fd) < 0) ret = -1;
+        close(fd);
+        atomic_fetch_add(&d->dir_syncs, 1);
+    }
+    
+    /* Records reach the journal before their round; one sync covers them */
+    for (size_t i = 0; i < round->num_journals; i++) {
+        if (index_journal_sync(round->journals[i]) < 0) ret = -1;
+        atomic_fetch_add(&d->journal_syncs, 1);
+    }
+    
+    if (ret < 0) atomic_fetch_add(&d->errors, 1);
+    return ret;
+}
+
+static void *committer_func(void *arg) {
+    struct backend_durable *d = arg;
+    
+    pthread_mutex_lock(&d->lock);
+    while (1) {
+        while (d->round_opened_us == 0 && !d->stop) {
+            pthread_cond_wait(&d->kick, &d->lock);
+        }
+        if (d->round_opened_us == 0) break;  /* Stopping with nothing open */
+    
+        /* Let the round fill until the budget is spent or the batch is full */
+        struct timespec deadline;
+        deadline_at(&deadline, d->round_opened_us + d->config.budget_us);
+        while (!d->stop && d->round.num_waiters < d->config.batch &&
+               pthread_cond_timedwait(&d->kick, &d->lock, &deadline) != ETIMEDOUT) {
+        }
+    
+        durable_round_t round = d->round;
+        memset(&d->round, 0, sizeof(d->round));
+        d->round_opened_us = 0;
+        pthread_mutex_unlock(&d->lock);
+    
+        int ret = round_commit(d, &round);
+        atomic_fetch_add(&d->rounds, 1);
+        atomic_fetch_add(&d->waits, round.num_waiters);
+    
+        pthread_mutex_lock(&d->lock);
+        for (durable_waiter_t *w = round.waiters; w; w = w->next) {
+            if (w->result == 0) w->result = ret;
+            w->done = true;
+        }
+        pthread_cond_broadcast(&d->done);
+        round_free(&round);
+    }
+    d->stopped = true;
+    pthread_mutex_unlock(&d->lock);
+    
+    return NULL;
+}
+
+/* Whether a backend's journal is long enough to fold into its image */
+static bool checkpoint_due(const struct backend_durable *d, backend_info_t *backend) {
+    if (!backend->journal || !backend->index || !backend->index->index_file_path) {
+        return false;
+    }
+    
+    uint64_t records = backend->journal->replayed + atomic_load(&backend->journal->appended);
+    uint64_t objects = atomic_load(&backend->object_count);
+    return records >= d->config.checkpoint_records &&
+           records * BACKEND_DURABLE_CHECKPOINT_DIVISOR >= objects;
+}
+
+static void *checkpointer_func(void *arg) {
+    struct backend_durable *d = arg;
+    backend_manager_t *mgr = d->mgr;
+    
+    pthread_mutex_lock(&d->lock);
+    while (!d->stop) {
+        struct timespec deadline;
+        deadline_at(&deadline, monotonic_us() + d->config.checkpoint_interval_us);
+        pthread_cond_timedwait(&d->tick, &d->lock, &deadline);
+        if (d->stop) break;
+        pthread_mutex_unlock(&d->lock);
+    
+        backend_info_t *backend;
+        for (int id = 0; (backend = backend_manager_get_backend(mgr, id)) != NULL; id++) {
+            if (!checkpoint_due(d, backend)) continue;
+    
+            /* The image may name files whose directories are not synced yet */
+            uint64_t records = backend->journal->replayed +
+                               atomic_load(&backend->journal->appended);
+            if (backend_durable_wait(mgr) < 0 ||
+                backend_manager_checkpoint(mgr, id) < 0) {
+                fprintf(stderr, "Backend %d: background checkpoint failed\n", id);
+                atomic_fetch_add(&d->errors, 1);
+                continue;
+            }
+            atomic_fetch_add(&d->checkpoints, 1);
+            atomic_fetch_add(&d->checkpoint_records, records);
+        }
+    
+        pthread_mutex_lock(&d->lock);
+    }
+    pthread_mutex_unlock(&d->lock);
+    
+    return NULL;
+}
+
+int backend_durable_start(backend_manager_t *mgr, const backend_durable_config_t *config) {
+    if (!mgr) return -1;
+    if (mgr->durable) return 0;  /* Already running */
+    
+    struct backend_durable *d = calloc(1, sizeof(*d));
+    if (!d) return -1;
+    
+    d->mgr = mgr;
+    if (config) d->config = *config;
+    if (d->config.budget_us == 0) d->config.budget_us = BACKEND_DURABLE_DEFAULT_BUDGET_US;
+    if (d->config.batch == 0) d->config.batch = BACKEND_DURABLE_DEFAULT_BATCH;
+    if (d->config.checkpoint_records == 0) {
+        d->config.checkpoint_records = BACKEND_DURABLE_DEFAULT_CKPT_RECORDS;
+    }
+    if (d->config.checkpoint_interval_us == 0) {
+        d->config.checkpoint_interval_us = BACKEND_DURABLE_DEFAULT_CKPT_INTERVAL_US;
+    }
+    
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&d->lock, NULL);
+    pthread_cond_init(&d->kick, &attr);
+    pthread_cond_init(&d->done, &attr);
+    pthread_cond_init(&d->tick, &attr);
+    pthread_condattr_destroy(&attr);
+    
+    if (pthread_create(&d->committer, NULL, committer_func, d) != 0) {
+        goto fail;
+    }
+    if (pthread_create(&d->checkpointer, NULL, checkpointer_func, d) != 0) {
+        pthread_mutex_lock(&d->lock);
+        d->stop = true;
+        pthread_cond_signal(&d->kick);
+        pthread_mutex_unlock(&d->lock);
+        pthread_join(d->committer, NULL);
+        goto fail;
+    }
+    
+    mgr->durable = d;
+    return 0;
+
+fail:
+    pthread_cond_destroy(&d->tick);
+    pthread_cond_destroy(&d->done);
+    pthread_cond_destroy(&d->kick);
+    pthread_mutex_destroy(&d->lock);
+    free(d);
+    return -1;
+}
+
+void backend_durable_stop(backend_manager_t *mgr) {
+    if (!mgr || !mgr->durable) return;
+    
+    struct backend_durable *d = mgr->durable;
+    
+    /* The checkpointer waits on rounds: it goes first */
+    pthread_mutex_lock(&d->lock);
+    d->stop = true;
+    pthread_cond_signal(&d->tick);
+    pthread_mutex_unlock(&d->lock);
+    pthread_join(d->checkpointer, NULL);
+    
+    pthread_mutex_lock(&d->lock);
+    pthread_cond_signal(&d->kick);
+    pthread_mutex_unlock(&d->lock);
+    pthread_join(d->committer, NULL);
+    
+    mgr->durable = NULL;
+    round_free(&d->round);
+    pthread_cond_destroy(&d->tick);
+    pthread_cond_destroy(&d->done);
+    pthread_cond_destroy(&d->kick);
+    pthread_mutex_destroy(&d->lock);
+    free(d);
+}
+
+/* Queue a file whose data the round must sync (caller holds the lock);
+ * one file per file system is enough */
+static int round_add_data(durable_round_t *round, int fd, dev_t dev) {
+    for (size_t i = 0; i < round->num_data; i++) {
+        if (round->data[i].dev == dev) return 0;
+    }
+    if (round->num_data == round->data_cap) {
+        size_t cap = round->data_cap ? round->data_cap * 2 : 4;
+        durable_data_t *grown = realloc(round->data, cap * sizeof(*grown));
+        if (!grown) return -1;
+        round->data = grown;
+        round->data_cap = cap;
+    }
+    round->data[round->num_data++] = (durable_data_t){ .dev = dev, .fd = fd };
+    return 0;
+}
+
+/* Join the next round and sleep until it commits; data_fd (-1 = none) is
+ * a file whose data the round syncs too */
+static int round_wait(struct backend_durable *d, int data_fd, dev_t dev) {
+    durable_waiter_t w = { .result = 0, .done = false };
+    
+    pthread_mutex_lock(&d->lock);
+    if (d->stopped) {
+        /* Journals and directories are left to the final checkpoint */
+        pthread_mutex_unlock(&d->lock);
+        return data_fd >= 0 ? fdatasync(data_fd) : 0;
+    }
+    if (data_fd >= 0 && round_add_data(&d->round, data_fd, dev) < 0) {
+        pthread_mutex_unlock(&d->lock);
+        return fdatasync(data_fd);
+    }
+    w.next = d->round.waiters;
+    d->round.waiters = &w;
+    d->round.num_waiters++;
+    round_open(d);
+    if (d->round.num_waiters >= d->config.batch) pthread_cond_signal(&d->kick);
+    
+    while (!w.done) {
+        pthread_cond_wait(&d->done, &d->lock);
+    }
+    pthread_mutex_unlock(&d->lock);
+    
+    return w.result;
+}
+
+int backend_durable_sync_fd(backend_manager_t *mgr, int fd) {
+    if (!mgr || fd < 0) return -1;
+    
+    struct backend_durable *d = mgr->durable;
+    if (!d) return fdatasync(fd);
+    
+    /* Writeback runs while the round fills; the round waits for it */
+    struct stat st;
+    if (fstat(fd, &st) < 0) return -1;
+    sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+    return round_wait(d, fd, st.st_dev);
+}
+
+int backend_durable_wait(backend_manager_t *mgr) {
+    if (!mgr) return -1;
+    if (!mgr->durable) return 0;
+    return round_wait(mgr->durable, -1, 0);
+}
+
+void backend_durable_note(backend_manager_t *mgr, index_journal_t *journal,
+                          const char *path) {
+    if (!mgr || !mgr->durable || !journal) return;
+    
+    struct backend_durable *d = mgr->durable;
+    durable_round_t *round = &d->round;
+    
+    /* Parent directory of the object file */
+    char *dir = NULL;
+    const char *slash = path ? strrchr(path, '/') : NULL;
+    if (slash && slash > path) dir = strndup(path, slash - path);
+    
+    pthread_mutex_lock(&d->lock);
+    
+    bool listed = false;
+    for (size_t i = 0; i < round->num_journals && !listed; i++) {
+        listed = (round->journals[i] == journal);
+    }
+    if (!listed && round->num_journals == round->journals_cap) {
+        size_t cap = round->journals_cap ? round->journals_cap * 2 : 4;
+        index_journal_t **grown = realloc(round->journals, cap * sizeof(*grown));
+        if (grown) {
+            round->journals = grown;
+            round->journals_cap = cap;
+        }
+    }
+    if (!listed && round->num_journals < round->journals_cap) {
+        round->journals[round->num_journals++] = journal;
+    }
+    
+    /* Consecutive changes mostly share a directory; the rest is sorted out
+     * at commit */
+    if (dir && round->num_dirs > 0 && strcmp(round->dirs[round->num_dirs - 1], dir) == 0) {
+        free(dir);
+        dir = NULL;
+    }
+    if (dir && round->num_dirs == round->dirs_cap) {
+        size_t cap = round->dirs_cap ? round->dirs_cap * 2 : 16;
+        char **grown = realloc(round->dirs, cap * sizeof(*grown));
+        if (grown) {
+            round->dirs = grown;
+            round->dirs_cap = cap;
+        }
+    }
+    if (dir && round->num_dirs < round->dirs_cap) {
+        round->dirs[round->num_dirs++] = dir;
+        dir = NULL;
+    }
+    
+    round_open(d);
+    pthread_mutex_unlock(&d->lock);
+    
+    free(dir);
+}
+
+int backend_durable_get_stats(backend_manager_t *mgr, durable_stats_t *stats_out) {
+    if (!mgr || !stats_out || !mgr->durable) return -1;
+    
+    struct backend_durable *d = mgr->durable;
+    stats_out->rounds = atomic_load(&d->rounds);
+    stats_out->waits = atomic_load(&d->waits);
+    stats_out->data_syncs = atomic_load(&d->data_syncs);
+    stats_out->dir_syncs = atomic_load(&d->dir_syncs);
+    stats_out->journal_syncs = atomic_load(&d->journal_syncs);
+    stats_out->errors = atomic_load(&d->errors);
+    stats_out->checkpoints = atomic_load(&d->checkpoints);
+    stats_out->checkpoint_records = atomic_load(&d->checkpoint_records);
+    return 0;
+}
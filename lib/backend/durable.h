@@ -0,0 +1,134 @@
+/**
+ * @file durable.h
+ * @brief Group commit of persistent writes and background checkpoints
+ *
+ * A persistent object is durable once its data, the directory entry that
+ * publishes it and the journal record that indexes it are all on disk.
+ * The engine batches the syncs that get them there into rounds. The first
+ * change after an idle spell opens a round, and the round commits when the
+ * latency budget runs out or enough waiters have joined, whichever comes
+ * first. A round:
+ * - syncfs()s each file system holding object data queued for it, once
+ *   however many files it holds
+ * - fsync()s each directory that gained or lost an object since the last
+ *   round, once however many objects it gained
+ * - fdatasync()s each journal appended to since the last round, once
+ *
+ * Object data is synced by a round before it is published
+ * (backend_durable_sync_fd()). Its writeback is started when it is queued,
+ * so the round mostly waits for I/O already under way. Every change that
+ * appends to a persistent backend's journal is committed by a later round
+ * within the budget; a caller that must not acknowledge a change before
+ * that waits for it with backend_durable_wait(), once. Memory tiers are
+ * never synced.
+ *
+ * A second thread keeps journals short: once a backend's journal holds at
+ * least checkpoint_records records and at least one per
+ * BACKEND_DURABLE_CHECKPOINT_DIVISOR objects of the backend, it is folded
+ * into a new image (backend_manager_checkpoint()). Each checkpoint writes
+ * every object once, and it waits for a proportional number of changes,
+ * so index persistence costs a few records per change at any index size.
+ */
+
+#ifndef BACKEND_DURABLE_H
+#define BACKEND_DURABLE_H
+
+#include "backend.h"
+#include <stdint.h>
+
+/* Round defaults */
+#define BACKEND_DURABLE_DEFAULT_BUDGET_US      2000
+#define BACKEND_DURABLE_DEFAULT_BATCH          64
+
+/* Checkpoint defaults */
+#define BACKEND_DURABLE_DEFAULT_CKPT_RECORDS   16384
+#define BACKEND_DURABLE_DEFAULT_CKPT_INTERVAL_US 1000000
+#define BACKEND_DURABLE_CHECKPOINT_DIVISOR     4
+
+/**
+ * Engine settings (0 picks the default)
+ */
+typedef struct backend_durable_config {
+    uint64_t budget_us;              /* Longest a change waits for its round */
+    size_t batch;                    /* Waiters that end a round early */
+    size_t checkpoint_records;       /* Smallest journal worth a checkpoint */
+    uint64_t checkpoint_interval_us; /* How often journal lengths are checked */
+} backend_durable_config_t;
+
+/**
+ * Engine statistics
+ */
+typedef struct durable_stats {
+    uint64_t rounds;                 /* Rounds committed */
+    uint64_t waits;                  /* Waits served by them */
+    uint64_t data_syncs;             /* File systems synced for object data */
+    uint64_t dir_syncs;              /* Directories synced */
+    uint64_t journal_syncs;          /* Journals synced */
+    uint64_t errors;                 /* Failed syncs */
+    uint64_t checkpoints;            /* Background checkpoints */
+    uint64_t checkpoint_records;     /* Journal records they folded */
+} durable_stats_t;
+
+/**
+ * Start the engine
+ *
+ * @param mgr Backend manager (backends restored or scanned already)
+ * @param config Settings (NULL for the defaults)
+ * @return 0 on success (or already running), -1 on error
+ */
+int backend_durable_start(backend_manager_t *mgr, const backend_durable_config_t *config);
+
+/**
+ * Stop the engine, committing the open round first
+ *
+ * Called by backend_manager_destroy(). Afterwards object data is synced
+ * inline again and journals are left to the final checkpoint.
+ *
+ * @param mgr Backend manager
+ */
+void backend_durable_stop(backend_manager_t *mgr);
+
+/**
+ * Sync a file's data before a name is published for it
+ *
+ * Starts the file's writeback and waits for the next round, which syncs
+ * it with every other file queued on the same file system. Without the
+ * engine (or once it stopped) the data is synced inline.
+ *
+ * @param mgr Backend manager
+ * @param fd File to sync (kept open by the caller until this returns)
+ * @return 0 once the data is on disk, -1 on error
+ */
+int backend_durable_sync_fd(backend_manager_t *mgr, int fd);
+
+/**
+ * Wait until every change made so far is durable
+ *
+ * @param mgr Backend manager
+ * @return 0 on success (at once without the engine), -1 if a sync of the
+ *         round failed
+ */
+int backend_durable_wait(backend_manager_t *mgr);
+
+/**
+ * Queue a journal and the directory of a changed object for the next round
+ *
+ * Called by the object operations after a journal append.
+ *
+ * @param mgr Backend manager (no-op without the engine)
+ * @param journal Journal appended to
+ * @param path Object file created, replaced or removed (NULL = none)
+ */
+void backend_durable_note(backend_manager_t *mgr, index_journal_t *journal,
+                          const char *path);
+
+/**
+ * Get engine statistics
+ *
+ * @param mgr Backend manager
+ * @param stats_out Output statistics
+ * @return 0 on success, -1 if the engine is not running
+ */
+int backend_durable_get_stats(backend_manager_t *mgr, durable_stats_t *stats_out);
+
+#endif /* BACKEND_DURABLE_H */
@@ -0,0 +1,153 @@
+/**
+ * @file numa.c
+ * @brief NUMA topology and placement for memory backends
+ *
+ * The topology is read from /sys/devices/system/node once. Memory policies
+ * are set with the mbind() and set_mempolicy() system calls directly.
+ */
+
+#define _GNU_SOURCE
+#include "numa.h"
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUMA_SYSFS          "/sys/devices/system/node"
+#define NUMA_LIST_MAX       4096
+
+static struct {
+    pthread_once_t once;
+    int num_nodes;
+    uint32_t mask;                   /* Nodes with memory */
+    cpu_set_t cpus[BACKEND_NUMA_MAX_NODES];
+} g_topology = { .once = PTHREAD_ONCE_INIT };
+
+static __thread int t_numa_node = -1;  /* Declared by backend_numa_bind_thread() */
+
+/* Parse a sysfs list ("0-3,8,10-11") into set, ignoring values >= limit */
+static int parse_list(const char *path, cpu_set_t *set, int limit) {
+    FILE *f = fopen(path, "re");
+    if (!f) return -1;
+    
+    char buf[NUMA_LIST_MAX];
+    bool ok = fgets(buf, sizeof(buf), f) != NULL;
+    fclose(f);
+    if (!ok) return -1;
+    
+    CPU_ZERO(set);
+    char *p = buf;
+    while (*p && *p != '\n') {
+        char *end;
+        long lo = strtol(p, &end, 10);
+        if (end == p) return -1;
+        long hi = lo;
+        if (*end == '-') {
+            p = end + 1;
+            hi = strtol(p, &end, 10);
+            if (end == p) return -1;
+        }
+        for (long v = lo; v <= hi && v < limit; v++) {
+            CPU_SET(v, set);
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return 0;
+}
+
+static void topology_load(void) {
+    cpu_set_t nodes;
+    if (parse_list(NUMA_SYSFS "/has_memory", &nodes, BACKEND_NUMA_MAX_NODES) < 0) {
+        CPU_ZERO(&nodes);
+        CPU_SET(0, &nodes);
+    }
+    
+    for (int node = 0; node < BACKEND_NUMA_MAX_NODES; node++) {
+        if (!CPU_ISSET(node, &nodes)) continue;
+        
+        char path[64];
+        snprintf(path, sizeof(path), NUMA_SYSFS "/node%d/cpulist", node);
+        if (parse_list(path, &g_topology.cpus[node], CPU_SETSIZE) < 0) {
+            CPU_ZERO(&g_topology.cpus[node]);
+        }
+        g_topology.mask |= 1u << node;
+        g_topology.num_nodes++;
+    }
+    
+    if (g_topology.num_nodes == 0) {
+        /* No sysfs: one node with every CPU */
+        sched_getaffinity(0, sizeof(g_topology.cpus[0]), &g_topology.cpus[0]);
+        g_topology.mask = 1;
+        g_topology.num_nodes = 1;
+    }
+}
+
+int backend_numa_nodes(uint32_t *mask_out) {
+    pthread_once(&g_topology.once, topology_load);
+    if (mask_out) *mask_out = g_topology.mask;
+    return g_topology.num_nodes;
+}
+
+int backend_numa_cpu_node(int cpu) {
+    pthread_once(&g_topology.once, topology_load);
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return -1;
+    
+    for (int node = 0; node < BACKEND_NUMA_MAX_NODES; node++) {
+        if ((g_topology.mask & (1u << node)) && CPU_ISSET(cpu, &g_topology.cpus[node])) {
+            return node;
+        }
+    }
+    return -1;
+}
+
+int backend_numa_bind_thread(int node, int cpu) {
+    if (node < 0 || node >= BACKEND_NUMA_MAX_NODES) return -1;
+    pthread_once(&g_topology.once, topology_load);
+    
+    t_numa_node = node;
+    index_set_thread_node(node);
+    
+    /* Best effort: kernels without NUMA reject the policy */
+    unsigned long nodemask = 1UL << node;
+    syscall(SYS_set_mempolicy, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8);
+    
+    cpu_set_t set;
+    if (cpu >= 0) {
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+    } else {
+        set = g_topology.cpus[node];
+        if (CPU_COUNT(&set) == 0) return -1;
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0 : -1;
+}
+
+int backend_numa_thread_node(void) {
+    if (t_numa_node >= 0) return t_numa_node;
+    
+    unsigned cpu, node;
+    if (getcpu(&cpu, &node) < 0) return -1;
+    return (int)node;
+}
+
+int backend_numa_bind_fd(int fd, int node, uint64_t len) {
+    if (fd < 0 || node < 0 || node >= BACKEND_NUMA_MAX_NODES || len == 0) return -1;
+    
+    /* The policy belongs to the shmem inode, not to this mapping: it
+     * outlives the munmap() and applies to every later fault or write */
+    long page = sysconf(_SC_PAGESIZE);
+    len = (len + page - 1) & ~(uint64_t)(page - 1);
+    void *addr = mmap(NULL, len, PROT_NONE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) return -1;
+    
+    unsigned long nodemask = 1UL << node;
+    long ret = syscall(SYS_mbind, addr, len, MPOL_PREFERRED, &nodemask,
+                       sizeof(nodemask) * 8, 0);
+    munmap(addr, len);
+    return ret == 0 ? 0 : -1;
+}
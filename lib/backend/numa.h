@@ -0,0 +1,77 @@
+/**
+ * @file numa.h
+ * @brief NUMA topology and placement for memory backends
+ *
+ * A memory backend bound to a node (backend_manager_set_numa_node()) is
+ * that node's memory tier. Its objects get a shared memory policy that
+ * prefers the node before anything is written to them, so their pages
+ * land there whichever thread or client process touches them first. New
+ * ephemeral objects go to the tier of the calling thread's node, and the
+ * caching engine promotes an object into the tier of the node that reads
+ * it most (the index keeps a per-entry reader node vote).
+ *
+ * Threads declare their node with backend_numa_bind_thread(). For threads
+ * that did not, getcpu() is asked. The topology comes from sysfs and
+ * placement uses raw system calls, so there is no libnuma dependency. A
+ * kernel without NUMA support reports a single node.
+ */
+
+#ifndef BACKEND_NUMA_H
+#define BACKEND_NUMA_H
+
+#include "backend.h"
+#include <stdint.h>
+
+/**
+ * Nodes with memory
+ *
+ * @param mask_out Output: bit n set for node n (may be NULL)
+ * @return Number of nodes (at least 1; nodes from BACKEND_NUMA_MAX_NODES
+ *         on are ignored)
+ */
+int backend_numa_nodes(uint32_t *mask_out);
+
+/**
+ * Node of a CPU
+ *
+ * @param cpu CPU number
+ * @return Node, or -1 if unknown
+ */
+int backend_numa_cpu_node(int cpu);
+
+/**
+ * Run the calling thread on a node
+ *
+ * Pins the thread (to cpu, or to all of the node's CPUs when cpu < 0),
+ * makes its own allocations prefer the node, and records the node for
+ * backend_numa_thread_node() and the index's reader node votes.
+ *
+ * @param node NUMA node
+ * @param cpu CPU of the node to pin to, or -1
+ * @return 0 on success, -1 if the thread could not be pinned (the node is
+ *         recorded anyway)
+ */
+int backend_numa_bind_thread(int node, int cpu);
+
+/**
+ * Node of the calling thread
+ *
+ * @return The node given to backend_numa_bind_thread(), else the node of
+ *         the CPU the thread runs on
+ */
+int backend_numa_thread_node(void);
+
+/**
+ * Place a shmem file's pages on a node
+ *
+ * Sets a shared policy preferring node over the first len bytes of the
+ * file (tmpfs or memfd). Pages already allocated stay where they are.
+ *
+ * @param fd File descriptor
+ * @param node NUMA node
+ * @param len Bytes covered (may exceed the file size)
+ * @return 0 on success, -1 on error
+ */
+int backend_numa_bind_fd(int fd, int node, uint64_t len);
+
+#endif /* BACKEND_NUMA_H */
@@ -3,12 +3,25 @@
  * @brief Test suite for backend manager
  */
 
+#define _GNU_SOURCE
 #include "backend.h"
+#include "aio.h"
+#include "chunk.h"
+#include "compress.h"
+#include "durable.h"
+#include "numa.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
 
 /* Test directory setup */
 static void setup_test_dirs(void) {
@@ -145,6 +158,12 @@ static void test_object_operations(void) {
     assert(ref.entry != NULL);
     assert(ref.entry->backend_id == nvme_id);
     
+    /* Until the writer reports, only the file knows the size */
+    index_entry_info_t info;
+    assert(backend_stat_object(mgr, "/test/object1.txt", &info) == 0);
+    assert(info.flags & INDEX_FLAG_UNSETTLED);
+    assert(backend_stat_object(mgr, "/test/missing.txt", &info) == -1);
+    
     /* Write some data */
     int fd = fd_ref_acquire(&ref);
     assert(fd >= 0);
@@ -153,10 +172,16 @@ static void test_object_operations(void) {
     ssize_t written = write(fd, data, strlen(data));
     assert(written == (ssize_t)strlen(data));
     
+    time_t reported = time(NULL);
     backend_update_size(mgr, "/test/object1.txt", strlen(data));
     
     fd_ref_release(&ref);
     
+    assert(backend_stat_object(mgr, "/test/object1.txt", &info) == 0);
+    assert(!(info.flags & INDEX_FLAG_UNSETTLED));
+    assert(info.size_bytes == strlen(data));
+    assert(info.mtime >= (uint64_t)reported && info.backend_id == (uint32_t)nvme_id);
+    
     printf("  ✓ Created persistent object\n");
     
     /* Get object */
@@ -190,6 +215,50 @@ static void test_object_operations(void) {
     
     printf("  ✓ Metadata retrieval works\n");
     
+    /* Creating an existing object fails without truncating it */
+    ret = backend_create_object(mgr, &req, &ref);
+    assert(ret < 0);
+    fd = backend_get_object_fd(mgr, "/test/object1.txt", NULL);
+    assert(fd >= 0);
+    assert(pread(fd, buf, sizeof(buf), 0) == (ssize_t)strlen(data));
+    close(fd);
+    
+    printf("  ✓ Duplicate create leaves data intact\n");
+    
+    /* Get-or-create: an existing object resolves to a read FD */
+    bool created = true;
+    fd = backend_get_or_create_object_fd(mgr, &req, &created);
+    assert(fd >= 0);
+    assert(!created);
+    assert(pread(fd, buf, sizeof(buf), 0) == (ssize_t)strlen(data));
+    close(fd);
+    
+    /* ...and a missing one is created with a writer FD */
+    object_create_req_t new_req = req;
+    new_req.uri = "/test/created.txt";
+    fd = backend_get_or_create_object_fd(mgr, &new_req, &created);
+    assert(fd >= 0);
+    assert(created);
+    assert(write(fd, "x", 1) == 1);
+    close(fd);
+    fd = backend_get_or_create_object_fd(mgr, &new_req, &created);
+    assert(fd >= 0);
+    assert(!created);
+    close(fd);
+    
+    printf("  ✓ Get-or-create works\n");
+    
+    /* Replace drops the old version */
+    new_req.replace = true;
+    ret = backend_create_object(mgr, &new_req, &ref);
+    assert(ret == 0);
+    struct stat st;
+    assert(fstat(ref.fd, &st) == 0 && st.st_size == 0);
+    fd_ref_release(&ref);
+    backend_delete_object(mgr, "/test/created.txt");
+    
+    printf("  ✓ Create with replace works\n");
+    
     /* Create ephemeral object */
     object_create_req_t eph_req = {
         .uri = "/tmp/ephemeral.dat",
@@ -319,6 +388,1566 @@ static void test_backend_management(void) {
     printf("✓ Backend management test passed\n\n");
 }
 
+/* Create a persistent object with content and an mtime old enough to copy */
+static void create_aged_object(backend_manager_t *mgr, const char *uri,
+                               const char *data, size_t len) {
+    object_create_req_t req = {
+        .uri = uri,
+        .backend_id = -1,
+        .ephemeral = false,
+        .size_hint = len,
+        .flags = 0
+    };
+    
+    fd_ref_t ref;
+    assert(backend_create_object(mgr, &req, &ref) == 0);
+    assert(write(ref.fd, data, len) == (ssize_t)len);
+    
+    struct timespec times[2] = {
+        { .tv_sec = time(NULL) - 60, .tv_nsec = 0 },
+        { .tv_sec = time(NULL) - 60, .tv_nsec = 0 }
+    };
+    futimens(ref.fd, times);
+    
+    backend_update_size(mgr, uri, len);
+    fd_ref_release(&ref);
+}
+
+static void test_caching_engine(void) {
+    printf("Testing caching engine...\n");
+    
+    backend_manager_t *mgr = backend_manager_create(1024, 100);
+    assert(mgr != NULL);
+    
+    int mem_id = backend_manager_register(
+        mgr, BACKEND_TYPE_MEMORY, "/tmp/objmapper_test_memory",
+        "Memory", 1024 * 1024,
+        BACKEND_FLAG_EPHEMERAL_ONLY | BACKEND_FLAG_MIGRATION_SRC | BACKEND_FLAG_MIGRATION_DST
+    );
+    int ssd_id = backend_manager_register(
+        mgr, BACKEND_TYPE_SSD, "/tmp/objmapper_test_ssd",
+        "SSD", 10ULL * 1024 * 1024 * 1024,
+        BACKEND_FLAG_PERSISTENT | BACKEND_FLAG_MIGRATION_SRC | BACKEND_FLAG_MIGRATION_DST
+    );
+    
+    backend_manager_set_ephemeral(mgr, mem_id);
+    backend_manager_set_default(mgr, ssd_id);
+    assert(backend_manager_set_cache(mgr, mem_id) == 0);
+    
+    char data[4096];
+    memset(data, 'h', sizeof(data));
+    create_aged_object(mgr, "/cache/hot", data, sizeof(data));
+    create_aged_object(mgr, "/cache/cold1", data, sizeof(data));
+    create_aged_object(mgr, "/cache/cold2", data, sizeof(data));
+    
+    /* /cache/hot is read repeatedly, /cache/cold1 once (recent, but a
+     * one-hit wonder: not admitted) */
+    fd_ref_t ref;
+    for (int i = 0; i < 10; i++) {
+        assert(backend_get_object(mgr, "/cache/hot", &ref) == 0);
+        fd_ref_release(&ref);
+    }
+    assert(backend_get_object(mgr, "/cache/cold1", &ref) == 0);
+    fd_ref_release(&ref);
+    
+    assert(backend_set_cache_limits(mgr, 64, 8, 0) == 0);
+    assert(backend_start_caching(mgr, 10000, 0.5) == 0);
+    
+    cache_stats_t stats;
+    for (int i = 0; i < 200; i++) {
+        backend_get_cache_stats(mgr, &stats);
+        if (stats.promotions > 0) break;
+        usleep(10000);
+    }
+    usleep(50000);
+    backend_stop_caching(mgr);
+    backend_get_cache_stats(mgr, &stats);
+    
+    assert(stats.promotions == 1);
+    assert(stats.bytes_moved == sizeof(data));
+    
+    object_metadata_t meta;
+    assert(backend_get_metadata(mgr, "/cache/hot", &meta) == 0);
+    assert(meta.backend_id == mem_id);
+    assert(meta.flags & INDEX_FLAG_CACHED);
+    object_metadata_free(&meta);
+    
+    assert(backend_get_metadata(mgr, "/cache/cold1", &meta) == 0);
+    assert(meta.backend_id == ssd_id);
+    object_metadata_free(&meta);
+    
+    /* Served from memory, durable copy retained */
+    assert(backend_get_object(mgr, "/cache/hot", &ref) == 0);
+    char buf[16];
+    assert(pread(ref.fd, buf, sizeof(buf), 0) == sizeof(buf));
+    assert(buf[0] == 'h');
+    fd_ref_release(&ref);
+    assert(access("/tmp/objmapper_test_memory/cache/hot", F_OK) == 0);
+    assert(access("/tmp/objmapper_test_ssd/cache/hot", F_OK) == 0);
+    
+    printf("  ✓ Hot object promoted, home copy kept\n");
+    
+    /* Eviction repoints without copying */
+    assert(backend_evict_object(mgr, "/cache/hot") == 0);
+    assert(backend_get_metadata(mgr, "/cache/hot", &meta) == 0);
+    assert(meta.backend_id == ssd_id);
+    assert(!(meta.flags & INDEX_FLAG_CACHED));
+    object_metadata_free(&meta);
+    assert(access("/tmp/objmapper_test_memory/cache/hot", F_OK) < 0);
+    assert(access("/tmp/objmapper_test_ssd/cache/hot", F_OK) == 0);
+    
+    printf("  ✓ Eviction drops the cache copy\n");
+    
+    /* Above the high watermark the engine drains to the low watermark */
+    assert(backend_cache_object(mgr, "/cache/hot") == 0);
+    assert(backend_cache_object(mgr, "/cache/cold1") == 0);
+    assert(backend_cache_object(mgr, "/cache/cold2") == 0);
+    
+    uint64_t used;
+    backend_get_status(mgr, mem_id, NULL, &used, NULL, NULL);
+    assert(used == 3 * sizeof(data));
+    
+    /* high = 10KB, low = 5KB of 1MB */
+    assert(backend_set_watermarks(mgr, mem_id, 0.01, 0.005) == 0);
+    assert(backend_set_migration_policy(mgr, mem_id, MIGRATION_POLICY_CAPACITY, 0.5) == 0);
+    assert(backend_start_caching(mgr, 10000, 0.5) == 0);
+    for (int i = 0; i < 200; i++) {
+        backend_get_status(mgr, mem_id, NULL, &used, NULL, NULL);
+        if (used <= 5 * 1024) break;
+        usleep(10000);
+    }
+    backend_stop_caching(mgr);
+    
+    assert(used == sizeof(data));
+    assert(backend_get_metadata(mgr, "/cache/hot", &meta) == 0);
+    assert(meta.backend_id == mem_id);
+    object_metadata_free(&meta);
+    
+    printf("  ✓ Watermark eviction removes coldest first\n");
+    
+    /* Deleting a cache copy removes the home copy too */
+    size_t ssd_objects;
+    assert(backend_delete_object(mgr, "/cache/hot") == 0);
+    assert(access("/tmp/objmapper_test_memory/cache/hot", F_OK) < 0);
+    assert(access("/tmp/objmapper_test_ssd/cache/hot", F_OK) < 0);
+    backend_get_status(mgr, ssd_id, NULL, NULL, &ssd_objects, NULL);
+    assert(ssd_objects == 2);
+    
+    printf("  ✓ Delete removes both copies\n");
+    
+    /* A full cache (used == low) admits only by displacing a copy that is
+     * read less often than the candidate */
+    assert(backend_cache_object(mgr, "/cache/cold1") == 0);
+    for (int i = 0; i < 5; i++) {
+        assert(backend_get_object(mgr, "/cache/cold2", &ref) == 0);
+        fd_ref_release(&ref);
+    }
+    assert(backend_set_watermarks(mgr, mem_id, 0.01, 4096.0 / (1024 * 1024)) == 0);
+    assert(backend_set_migration_policy(mgr, mem_id, MIGRATION_POLICY_HYBRID, 0.5) == 0);
+    
+    cache_stats_t before;
+    backend_get_cache_stats(mgr, &before);
+    assert(backend_start_caching(mgr, 10000, 0.5) == 0);
+    for (int i = 0; i < 200; i++) {
+        backend_get_cache_stats(mgr, &stats);
+        if (stats.promotions > before.promotions) break;
+        usleep(10000);
+    }
+    backend_stop_caching(mgr);
+    
+    assert(stats.evictions == before.evictions + 1);
+    assert(backend_get_metadata(mgr, "/cache/cold2", &meta) == 0);
+    assert(meta.backend_id == mem_id);
+    object_metadata_free(&meta);
+    assert(backend_get_metadata(mgr, "/cache/cold1", &meta) == 0);
+    assert(meta.backend_id == ssd_id);
+    object_metadata_free(&meta);
+    
+    printf("  ✓ TinyLFU admission swaps a rarer copy for a frequent object\n");
+    
+    backend_manager_destroy(mgr);
+    printf("✓ Caching engine test passed\n\n");
+}
+
+static void put_object(backend_manager_t *mgr, const char *uri, const char *data) {
+    object_create_req_t req = { .uri = uri, .backend_id = -1, .replace = true };
+    fd_ref_t ref;
+    assert(backend_create_object(mgr, &req, &ref) == 0);
+    assert(write(ref.fd, data, strlen(data)) == (ssize_t)strlen(data));
+    backend_update_size(mgr, uri, strlen(data));
+    fd_ref_release(&ref);
+}
+
+static backend_manager_t *persist_manager(void) {
+    backend_manager_t *mgr = backend_manager_create(1024, 100);
+    assert(mgr != NULL);
+    int nvme_id = backend_manager_register(
+        mgr, BACKEND_TYPE_NVME, "/tmp/objmapper_test_nvme",
+        "NVMe", 10ULL * 1024 * 1024 * 1024, BACKEND_FLAG_PERSISTENT
+    );
+    assert(nvme_id == 0);
+    backend_manager_set_default(mgr, nvme_id);
+    return mgr;
+}
+
+static void test_index_persistence(void) {
+    printf("Testing persistent index restore...\n");
+    
+    system("rm -rf /tmp/objmapper_test_nvme/*");
+    
+    /* Cold start: nothing to restore, scan and save */
+    backend_manager_t *mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == -1);
+    put_object(mgr, "/p/a", "alpha");
+    put_object(mgr, "/p/b", "bravo");
+    assert(backend_manager_checkpoint(mgr, 0) == 0);
+    backend_manager_destroy(mgr);
+    
+    /* Warm start maps the image; lookups fault objects in */
+    mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == 2);
+    
+    index_stats_t stats;
+    backend_get_index_stats(mgr, &stats);
+    assert(stats.num_entries == 0);
+    
+    /* Image-only objects are on disk; definite misses skip the images */
+    assert(!backend_object_is_fast(mgr, "/p/a"));
+    assert(backend_object_is_fast(mgr, "/p/missing"));
+    
+    object_metadata_t meta;
+    assert(backend_get_metadata(mgr, "/p/a", &meta) == 0);
+    assert(meta.size_bytes == 5);
+    object_metadata_free(&meta);
+    backend_get_index_stats(mgr, &stats);
+    assert(stats.num_entries == 1);
+    
+    printf("  ✓ Warm start faults objects in on first lookup\n");
+    printf("  ✓ Negative filters make misses fast\n");
+    
+    /* A PUT over an image-only object replaces it */
+    put_object(mgr, "/p/b", "bravo2");
+    int fd = backend_get_object_fd(mgr, "/p/b", NULL);
+    assert(fd >= 0);
+    char buf[16] = {0};
+    assert(pread(fd, buf, sizeof(buf), 0) == 6);
+    assert(memcmp(buf, "bravo2", 6) == 0);
+    close(fd);
+    
+    /* Crash after journaling: keep the files the manager would rewrite */
+    put_object(mgr, "/p/c", "charlie");
+    assert(backend_delete_object(mgr, "/p/a") == 0);
+    system("cp /tmp/objmapper_test_nvme/.objmapper.idx /tmp/objmapper_test_nvme/.objmapper.journal /tmp/objmapper_test_memory/");
+    backend_manager_destroy(mgr);
+    system("cp /tmp/objmapper_test_memory/.objmapper.idx /tmp/objmapper_test_memory/.objmapper.journal /tmp/objmapper_test_nvme/");
+    system("rm -f /tmp/objmapper_test_memory/.objmapper.*");
+    
+    mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == 2);
+    assert(backend_get_metadata(mgr, "/p/a", &meta) == -1);
+    assert(backend_get_metadata(mgr, "/p/b", &meta) == 0);
+    assert(meta.size_bytes == 6);
+    object_metadata_free(&meta);
+    assert(backend_get_metadata(mgr, "/p/c", &meta) == 0);
+    assert(meta.size_bytes == 7);
+    object_metadata_free(&meta);
+    
+    printf("  ✓ Journal replay recovers a dirty shutdown\n");
+    
+    /* Index files are not objects */
+    object_create_req_t req = { .uri = "/.objmapper.idx", .backend_id = -1 };
+    fd_ref_t ref;
+    assert(backend_create_object(mgr, &req, &ref) == -1);
+    
+    backend_manager_destroy(mgr);
+    
+    /* A corrupt image falls back to a scan */
+    int ifd = open("/tmp/objmapper_test_nvme/.objmapper.idx", O_WRONLY);
+    assert(ifd >= 0);
+    assert(pwrite(ifd, "X", 1, 0) == 1);
+    close(ifd);
+    
+    mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == -1);
+    assert(backend_manager_scan(mgr, 0) == 2);  /* Index files are skipped */
+    backend_manager_destroy(mgr);
+    
+    printf("  ✓ Corrupt images are rejected\n");
+    
+    printf("✓ Persistent index restore passed\n\n");
+}
+
+/* Count migration staging files left in a directory */
+static int count_staging(const char *dir) {
+    DIR *d = opendir(dir);
+    if (!d) return 0;
+    int n = 0;
+    struct dirent *de;
+    while ((de = readdir(d))) {
+        if (strncmp(de->d_name, ".objmapper.mig.", 15) == 0) n++;
+    }
+    closedir(d);
+    return n;
+}
+
+typedef struct {
+    int done;
+    int failed;
+} migrate_counts_t;
+
+static void count_migration(const char *uri, int target, int result, void *arg) {
+    (void)uri;
+    (void)target;
+    migrate_counts_t *counts = arg;
+    if (result == 0) counts->done++;
+    else counts->failed++;
+}
+
+static void test_migration(void) {
+    printf("Testing object migration...\n");
+    
+    system("rm -rf /tmp/objmapper_test_nvme/* /tmp/objmapper_test_ssd/*");
+    
+    backend_manager_t *mgr = backend_manager_create(1024, 100);
+    assert(mgr != NULL);
+    uint32_t flags = BACKEND_FLAG_PERSISTENT | BACKEND_FLAG_MIGRATION_SRC |
+                     BACKEND_FLAG_MIGRATION_DST;
+    int nvme_id = backend_manager_register(
+        mgr, BACKEND_TYPE_NVME, "/tmp/objmapper_test_nvme",
+        "NVMe", 10ULL * 1024 * 1024 * 1024, flags
+    );
+    int ssd_id = backend_manager_register(
+        mgr, BACKEND_TYPE_SSD, "/tmp/objmapper_test_ssd",
+        "SSD", 10ULL * 1024 * 1024 * 1024, flags
+    );
+    backend_manager_set_default(mgr, nvme_id);
+    
+    put_object(mgr, "/mig/a", "migrated contents");
+    
+    fd_ref_t held;
+    assert(backend_get_object(mgr, "/mig/a", &held) == 0);
+    
+    assert(backend_migrate_object(mgr, "/mig/a", ssd_id) == 0);
+    
+    object_metadata_t meta;
+    assert(backend_get_metadata(mgr, "/mig/a", &meta) == 0);
+    assert(meta.backend_id == ssd_id);
+    assert(meta.size_bytes == strlen("migrated contents"));
+    object_metadata_free(&meta);
+    assert(access("/tmp/objmapper_test_nvme/mig/a", F_OK) < 0);
+    assert(count_staging("/tmp/objmapper_test_ssd/mig") == 0);
+    
+    /* The FD taken before the move still reads the old inode */
+    char buf[32] = {0};
+    assert(pread(held.fd, buf, sizeof(buf) - 1, 0) == (ssize_t)strlen("migrated contents"));
+    assert(strcmp(buf, "migrated contents") == 0);
+    fd_ref_release(&held);
+    
+    fd_ref_t ref;
+    memset(buf, 0, sizeof(buf));
+    assert(backend_get_object(mgr, "/mig/a", &ref) == 0);
+    assert(pread(ref.fd, buf, sizeof(buf) - 1, 0) == (ssize_t)strlen("migrated contents"));
+    assert(strcmp(buf, "migrated contents") == 0);
+    fd_ref_release(&ref);
+    
+    printf("  ✓ Synchronous move copies, renames into place and repoints\n");
+    
+    /* Queued moves run on the migration thread */
+    put_object(mgr, "/mig/b", "b");
+    put_object(mgr, "/mig/c", "c");
+    
+    migrate_counts_t counts = {0};
+    assert(backend_migrate_object_async(mgr, "/mig/a", nvme_id, count_migration, &counts) == 0);
+    assert(backend_migrate_object_async(mgr, "/mig/b", ssd_id, count_migration, &counts) == 0);
+    assert(backend_migrate_object_async(mgr, "/mig/c", ssd_id, count_migration, &counts) == 0);
+    assert(backend_migrate_object_async(mgr, "/mig/none", ssd_id, count_migration, &counts) == 0);
+    backend_migrate_drain(mgr);
+    
+    assert(counts.done == 3);
+    assert(counts.failed == 1);
+    
+    assert(backend_get_metadata(mgr, "/mig/a", &meta) == 0);
+    assert(meta.backend_id == nvme_id);
+    object_metadata_free(&meta);
+    assert(backend_get_metadata(mgr, "/mig/c", &meta) == 0);
+    assert(meta.backend_id == ssd_id);
+    object_metadata_free(&meta);
+    
+    size_t nvme_objects, ssd_objects;
+    backend_get_status(mgr, nvme_id, NULL, NULL, &nvme_objects, NULL);
+    backend_get_status(mgr, ssd_id, NULL, NULL, &ssd_objects, NULL);
+    assert(nvme_objects == 1);
+    assert(ssd_objects == 2);
+    
+    printf("  ✓ Async migrations complete through callbacks\n");
+    
+    backend_manager_destroy(mgr);
+    printf("✓ Migration test passed\n\n");
+}
+
+static void test_memfd_backend(void) {
+    printf("Testing memfd backend...\n");
+    
+    system("rm -rf /tmp/objmapper_test_nvme/*");
+    
+    backend_manager_t *mgr = backend_manager_create(1024, 100);
+    assert(mgr != NULL);
+    uint32_t flags = BACKEND_FLAG_MIGRATION_SRC | BACKEND_FLAG_MIGRATION_DST;
+    int mem_id = backend_manager_register(
+        mgr, BACKEND_TYPE_MEMFD, "memfd", "Anonymous",
+        1ULL * 1024 * 1024 * 1024, flags | BACKEND_FLAG_EPHEMERAL_ONLY
+    );
+    int nvme_id = backend_manager_register(
+        mgr, BACKEND_TYPE_NVME, "/tmp/objmapper_test_nvme",
+        "NVMe", 10ULL * 1024 * 1024 * 1024, flags | BACKEND_FLAG_PERSISTENT
+    );
+    assert(backend_manager_set_ephemeral(mgr, mem_id) == 0);
+    assert(backend_manager_set_cache(mgr, mem_id) == 0);
+    assert(backend_manager_scan(mgr, mem_id) == 0);
+    assert(backend_manager_checkpoint(mgr, mem_id) < 0);
+    
+    const char *data = "anonymous contents";
+    size_t len = strlen(data);
+    object_create_req_t req = {
+        .uri = "/anon/a", .backend_id = -1, .ephemeral = true, .size_hint = 64 * 1024
+    };
+    fd_ref_t ref;
+    assert(backend_create_object(mgr, &req, &ref) == 0);
+    
+    /* Readers see the object while it is still being written */
+    assert(pwrite(ref.fd, data, 5, 0) == 5);
+    int fd = backend_get_object_fd(mgr, "/anon/a", NULL);
+    assert(fd >= 0);
+    assert(fcntl(fd, F_GET_SEALS) == 0);
+    assert(write(fd, "x", 1) < 0);
+    close(fd);
+    
+    assert(pwrite(ref.fd, data, len, 0) == (ssize_t)len);
+    assert(backend_update_size(mgr, "/anon/a", len) == 0);
+    
+    /* Finished: sealed, so even the writer FD is read-only */
+    errno = 0;
+    assert(write(ref.fd, "x", 1) < 0 && errno == EPERM);
+    assert(ftruncate(ref.fd, 0) < 0);
+    fd_ref_release(&ref);
+    
+    printf("  ✓ Objects are memfds with no path, sealed when the writer finishes\n");
+    
+    fd = backend_get_object_fd(mgr, "/anon/a", NULL);
+    assert(fd >= 0);
+    int seals = fcntl(fd, F_GET_SEALS);
+    assert((seals & F_SEAL_WRITE) && (seals & F_SEAL_SHRINK));
+    assert(mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) == MAP_FAILED);
+    char *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    assert(map != MAP_FAILED);
+    assert(memcmp(map, data, len) == 0);
+    munmap(map, len);
+    close(fd);
+    
+    assert(backend_get_object(mgr, "/anon/a", &ref) == 0);
+    char buf[32] = {0};
+    assert(pread(ref.fd, buf, sizeof(buf) - 1, 0) == (ssize_t)len);
+    assert(strcmp(buf, data) == 0);
+    fd_ref_release(&ref);
+    assert(backend_object_is_fast(mgr, "/anon/a"));
+    
+    printf("  ✓ Sealed objects map shared read-only\n");
+    
+    /* Moves copy between memfds and paths in both directions */
+    assert(backend_manager_set_default(mgr, nvme_id) == 0);
+    create_aged_object(mgr, "/anon/p", data, len);
+    
+    assert(backend_cache_object(mgr, "/anon/p") == 0);
+    object_metadata_t meta;
+    assert(backend_get_metadata(mgr, "/anon/p", &meta) == 0);
+    assert(meta.backend_id == mem_id);
+    assert(meta.flags & INDEX_FLAG_SEALED);
+    object_metadata_free(&meta);
+    assert(access("/tmp/objmapper_test_nvme/anon/p", F_OK) == 0);
+    
+    fd = backend_get_object_fd(mgr, "/anon/p", NULL);
+    assert(fd >= 0);
+    memset(buf, 0, sizeof(buf));
+    assert(pread(fd, buf, sizeof(buf) - 1, 0) == (ssize_t)len);
+    assert(strcmp(buf, data) == 0);
+    close(fd);
+    
+    assert(backend_evict_object(mgr, "/anon/p") == 0);
+    assert(backend_get_metadata(mgr, "/anon/p", &meta) == 0);
+    assert(meta.backend_id == nvme_id);
+    assert(!(meta.flags & INDEX_FLAG_SEALED));
+    object_metadata_free(&meta);
+    
+    printf("  ✓ Cache copies live in sealed memfds\n");
+    
+    assert(backend_delete_object(mgr, "/anon/a") == 0);
+    assert(backend_get_object_fd(mgr, "/anon/a", NULL) < 0);
+    size_t mem_objects;
+    backend_get_status(mgr, mem_id, NULL, NULL, &mem_objects, NULL);
+    assert(mem_objects == 0);
+    
+    backend_manager_destroy(mgr);
+    printf("✓ memfd backend test passed\n\n");
+}
+
+/* Write a complete PUT body */
+static int put_atomic(backend_manager_t *mgr, const char *uri, const char *data,
+                      bool ephemeral) {
+    object_create_req_t req = {
+        .uri = uri, .backend_id = -1, .ephemeral = ephemeral, .size_hint = 1 << 20
+    };
+    object_put_t put;
+    if (backend_put_begin(mgr, &req, &put) < 0) return -1;
+    size_t len = strlen(data);
+    if (pwrite(put.fd, data, len, 0) != (ssize_t)len) {
+        backend_put_abort(&put);
+        return -1;
+    }
+    return backend_put_commit(mgr, &put, len);
+}
+
+/* Read a whole small object through the index */
+static void assert_contents(backend_manager_t *mgr, const char *uri, const char *data) {
+    char buf[64] = {0};
+    int fd = backend_get_object_fd(mgr, uri, NULL);
+    assert(fd >= 0);
+    assert(pread(fd, buf, sizeof(buf) - 1, 0) == (ssize_t)strlen(data));
+    assert(strcmp(buf, data) == 0);
+    close(fd);
+}
+
+static bool has_stage_files(const char *dir) {
+    DIR *d = opendir(dir);
+    assert(d != NULL);
+    struct dirent *de;
+    bool found = false;
+    while ((de = readdir(d)) != NULL) {
+        if (strncmp(de->d_name, ".objmapper.put.", 15) == 0) found = true;
+    }
+    closedir(d);
+    return found;
+}
+
+static void test_atomic_put(void) {
+    printf("Testing atomic PUT...\n");
+    
+    system("rm -rf /tmp/objmapper_test_nvme/*");
+    
+    backend_manager_t *mgr = backend_manager_create(1024, 100);
+    assert(mgr != NULL);
+    int nvme_id = backend_manager_register(
+        mgr, BACKEND_TYPE_NVME, "/tmp/objmapper_test_nvme", "NVMe",
+        10ULL * 1024 * 1024 * 1024, BACKEND_FLAG_PERSISTENT
+    );
+    int mem_id = backend_manager_register(
+        mgr, BACKEND_TYPE_MEMFD, "memfd", "Anonymous",
+        1ULL * 1024 * 1024 * 1024, BACKEND_FLAG_EPHEMERAL_ONLY
+    );
+    assert(backend_manager_set_default(mgr, nvme_id) == 0);
+    assert(backend_manager_set_ephemeral(mgr, mem_id) == 0);
+    
+    /* Nothing is visible before the commit */
+    object_create_req_t req = {
+        .uri = "/put/dir/a", .backend_id = -1, .size_hint = 1 << 20
+    };
+    object_put_t put;
+    assert(backend_put_begin(mgr, &req, &put) == 0);
+    assert(pwrite(put.fd, "first", 5, 0) == 5);
+    assert(backend_get_object_fd(mgr, "/put/dir/a", NULL) < 0);
+    assert(access("/tmp/objmapper_test_nvme/put/dir/a", F_OK) < 0);
+    assert(backend_put_commit(mgr, &put, 5) == 0);
+    assert(put.fd < 0 && put.uri == NULL);
+    assert_contents(mgr, "/put/dir/a", "first");
+    
+    /* The preallocation was handed back */
+    struct stat st;
+    assert(stat("/tmp/objmapper_test_nvme/put/dir/a", &st) == 0);
+    assert(st.st_size == 5 && st.st_blocks * 512 < (1 << 20));
+    
+    printf("  ✓ New objects appear only on commit\n");
+    
+    /* Overwrite: readers see the old version until the swap, and an FD
+     * they already hold keeps it afterwards */
+    int old_fd = backend_get_object_fd(mgr, "/put/dir/a", NULL);
+    assert(old_fd >= 0);
+    assert(backend_put_begin(mgr, &req, &put) == 0);
+    assert(pwrite(put.fd, "second", 6, 0) == 6);
+    assert_contents(mgr, "/put/dir/a", "first");
+    assert(backend_put_commit(mgr, &put, 6) == 0);
+    assert_contents(mgr, "/put/dir/a", "second");
+    
+    char buf[16] = {0};
+    assert(pread(old_fd, buf, sizeof(buf) - 1, 0) == 5);
+    assert(strcmp(buf, "first") == 0);
+    close(old_fd);
+    
+    object_metadata_t meta;
+    assert(backend_get_metadata(mgr, "/put/dir/a", &meta) == 0);
+    assert(meta.size_bytes == 6 && !(meta.flags & INDEX_FLAG_UNSETTLED));
+    object_metadata_free(&meta);
+    size_t objects;
+    backend_get_status(mgr, nvme_id, NULL, NULL, &objects, NULL);
+    assert(objects == 1);
+    
+    /* Aborting leaves the published version alone */
+    assert(backend_put_begin(mgr, &req, &put) == 0);
+    assert(pwrite(put.fd, "third", 5, 0) == 5);
+    backend_put_abort(&put);
+    assert_contents(mgr, "/put/dir/a", "second");
+    assert(!has_stage_files("/tmp/objmapper_test_nvme/put/dir"));
+    
+    printf("  ✓ Overwrites swap in atomically, aborts discard\n");
+    
+    /* A cached directory removed behind our back is recreated */
+    assert(put_atomic(mgr, "/put/gone/b", "b1", false) == 0);
+    assert(backend_delete_object(mgr, "/put/gone/b") == 0);
+    assert(rmdir("/tmp/objmapper_test_nvme/put/gone") == 0);
+    assert(put_atomic(mgr, "/put/gone/b", "b2", false) == 0);
+    assert_contents(mgr, "/put/gone/b", "b2");
+    
+    req.uri = "/put/gone/c";
+    fd_ref_t ref;
+    assert(backend_delete_object(mgr, "/put/gone/b") == 0);
+    assert(rmdir("/tmp/objmapper_test_nvme/put/gone") == 0);
+    assert(backend_create_object(mgr, &req, &ref) == 0);
+    fd_ref_release(&ref);
+    
+    printf("  ✓ Directory cache recovers from removed directories\n");
+    
+    /* Ephemeral PUTs become sealed memfds */
+    assert(put_atomic(mgr, "/put/eph", "volatile", true) == 0);
+    assert_contents(mgr, "/put/eph", "volatile");
+    assert(put_atomic(mgr, "/put/eph", "replaced", true) == 0);
+    assert_contents(mgr, "/put/eph", "replaced");
+    int fd = backend_get_object_fd(mgr, "/put/eph", NULL);
+    assert(fd >= 0);
+    assert(fcntl(fd, F_GET_SEALS) & F_SEAL_WRITE);
+    close(fd);
+    backend_get_status(mgr, mem_id, NULL, NULL, &objects, NULL);
+    assert(objects == 1);
+    
+    /* Changing class moves the object to the other backend */
+    assert(put_atomic(mgr, "/put/eph", "durable", false) == 0);
+    assert(backend_get_metadata(mgr, "/put/eph", &meta) == 0);
+    assert(meta.backend_id == nvme_id);
+    assert(!(meta.flags & INDEX_FLAG_SEALED));
+    object_metadata_free(&meta);
+    backend_get_status(mgr, mem_id, NULL, NULL, &objects, NULL);
+    assert(objects == 0);
+    assert_contents(mgr, "/put/eph", "durable");
+    
+    printf("  ✓ memfd PUTs are sealed on commit\n");
+    
+    backend_manager_destroy(mgr);
+    printf("✓ Atomic PUT test passed\n\n");
+}
+
+/* PUT len arbitrary bytes */
+static void put_bytes(backend_manager_t *mgr, const char *uri, const void *data, size_t len) {
+    object_create_req_t req = { .uri = uri, .backend_id = -1 };
+    object_put_t put;
+    assert(backend_put_begin(mgr, &req, &put) == 0);
+    assert(pwrite(put.fd, data, len, 0) == (ssize_t)len);
+    assert(backend_put_commit(mgr, &put, len) == 0);
+}
+
+/* Whether fd reads exactly data */
+static bool fd_holds(int fd, const void *data, size_t len) {
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size != len) return false;
+    
+    char *buf = malloc(len);
+    assert(buf != NULL);
+    bool same = pread(fd, buf, len, 0) == (ssize_t)len && memcmp(buf, data, len) == 0;
+    free(buf);
+    return same;
+}
+
+static uint64_t used_bytes(backend_manager_t *mgr, int backend_id) {
+    uint64_t used;
+    assert(backend_get_status(mgr, backend_id, NULL, &used, NULL, NULL) == 0);
+    return used;
+}
+
+static void test_compression(void) {
+    printf("Testing compressed persistent tier...\n");
+    
+    system("rm -rf /tmp/objmapper_test_memory/* /tmp/objmapper_test_nvme/* "
+           "/tmp/objmapper_test_ssd/*");
+    
+    backend_manager_t *mgr = backend_manager_create(1024, 100);
+    assert(mgr != NULL);
+    uint32_t flags = BACKEND_FLAG_MIGRATION_SRC | BACKEND_FLAG_MIGRATION_DST;
+    int mem_id = backend_manager_register(
+        mgr, BACKEND_TYPE_MEMORY, "/tmp/objmapper_test_memory", "Memory",
+        1ULL * 1024 * 1024 * 1024, BACKEND_FLAG_EPHEMERAL_ONLY | flags
+    );
+    int nvme_id = backend_manager_register(
+        mgr, BACKEND_TYPE_NVME, "/tmp/objmapper_test_nvme", "NVMe",
+        10ULL * 1024 * 1024 * 1024, BACKEND_FLAG_PERSISTENT | flags
+    );
+    int ssd_id = backend_manager_register(
+        mgr, BACKEND_TYPE_SSD, "/tmp/objmapper_test_ssd", "SSD",
+        10ULL * 1024 * 1024 * 1024, BACKEND_FLAG_PERSISTENT | flags
+    );
+    assert(backend_manager_set_default(mgr, ssd_id) == 0);
+    assert(backend_manager_set_cache(mgr, mem_id) == 0);
+    
+    /* Memory tiers hold the plain copies */
+    assert(backend_set_compression(mgr, mem_id, 1) < 0);
+    assert(backend_set_compression(mgr, ssd_id, BACKEND_COMPRESS_MAX_LEVEL + 1) < 0);
+    assert(backend_set_compression(mgr, ssd_id, BACKEND_COMPRESS_DEFAULT_LEVEL) == 0);
+    
+    size_t text_len = 64 * 1024;
+    char *text = malloc(text_len);
+    assert(text != NULL);
+    for (size_t i = 0; i < text_len; i++) {
+        text[i] = "<li class=\"item\">objmapper</li>\n"[i % 32];
+    }
+    char *noise = malloc(text_len);
+    assert(noise != NULL);
+    srand(42);
+    for (size_t i = 0; i < text_len; i++) {
+        noise[i] = (char)rand();
+    }
+    
+    /* Commits are stored compressed when that pays */
+    put_bytes(mgr, "/z/text", text, text_len);
+    put_bytes(mgr, "/z/noise", noise, text_len);
+    put_bytes(mgr, "/z/small", text, 1000);
+    
+    object_metadata_t meta;
+    assert(backend_get_metadata(mgr, "/z/text", &meta) == 0);
+    assert(meta.flags & INDEX_FLAG_COMPRESSED);
+    uint64_t stored = meta.size_bytes;
+    assert(stored < text_len / 8);
+    object_metadata_free(&meta);
+    assert(used_bytes(mgr, ssd_id) == stored + text_len + 1000);
+    
+    assert(backend_get_metadata(mgr, "/z/noise", &meta) == 0);
+    assert(!(meta.flags & INDEX_FLAG_COMPRESSED) && meta.size_bytes == text_len);
+    object_metadata_free(&meta);
+    assert(backend_get_metadata(mgr, "/z/small", &meta) == 0);
+    assert(!(meta.flags & INDEX_FLAG_COMPRESSED));
+    object_metadata_free(&meta);
+    
+    /* The stored form is a gzip member that records the plain size */
+    index_entry_info_t info;
+    int fd = backend_get_stored_fd(mgr, "/z/text", &info);
+    assert(fd >= 0 && backend_flags_compressed(info.flags));
+    uint8_t magic[2];
+    assert(pread(fd, magic, 2, 0) == 2 && magic[0] == 0x1f && magic[1] == 0x8b);
+    uint64_t plain;
+    assert(backend_compressed_size(fd, &plain) == 0 && plain == text_len);
+    close(fd);
+    assert(!backend_object_is_fast(mgr, "/z/text"));
+    
+    printf("  ✓ PUT commits compress, small and incompressible objects stay plain\n");
+    
+    /* Reading promotes into the memory tier, inflated */
+    fd = backend_get_object_fd(mgr, "/z/text", &info);
+    assert(fd >= 0 && fd_holds(fd, text, text_len));
+    close(fd);
+    assert(info.backend_id == (uint32_t)mem_id && !backend_flags_compressed(info.flags));
+    assert(used_bytes(mgr, mem_id) == text_len);
+    assert(backend_object_is_fast(mgr, "/z/text"));
+    
+    /* Demotion repoints at the compressed home copy */
+    assert(backend_evict_object(mgr, "/z/text") == 0);
+    assert(used_bytes(mgr, mem_id) == 0);
+    assert(backend_get_metadata(mgr, "/z/text", &meta) == 0);
+    assert(meta.backend_id == ssd_id && meta.size_bytes == stored);
+    assert(meta.flags & INDEX_FLAG_COMPRESSED);
+    object_metadata_free(&meta);
+    
+    /* No promotion possible: the reader gets a private sealed copy */
+    assert(backend_set_enabled(mgr, mem_id, false) == 0);
+    fd = backend_get_object_fd(mgr, "/z/text", &info);
+    assert(fd >= 0 && fd_holds(fd, text, text_len));
+    assert(fcntl(fd, F_GET_SEALS) & F_SEAL_WRITE);
+    close(fd);
+    assert(info.backend_id == (uint32_t)ssd_id);
+    assert(backend_set_enabled(mgr, mem_id, true) == 0);
+    
+    printf("  ✓ FD readers get plain bytes, promoted or privately inflated\n");
+    
+    /* Migration compresses into a compressing backend and inflates out of it */
+    assert(backend_migrate_object(mgr, "/z/text", nvme_id) == 0);
+    assert(backend_get_metadata(mgr, "/z/text", &meta) == 0);
+    assert(!(meta.flags & INDEX_FLAG_COMPRESSED) && meta.size_bytes == text_len);
+    object_metadata_free(&meta);
+    fd = backend_get_stored_fd(mgr, "/z/text", NULL);
+    assert(fd >= 0 && fd_holds(fd, text, text_len));
+    close(fd);
+    assert(used_bytes(mgr, ssd_id) == text_len + 1000);
+    
+    assert(backend_migrate_object(mgr, "/z/text", ssd_id) == 0);
+    assert(backend_get_metadata(mgr, "/z/text", &meta) == 0);
+    assert((meta.flags & INDEX_FLAG_COMPRESSED) && meta.size_bytes == stored);
+    object_metadata_free(&meta);
+    assert(used_bytes(mgr, nvme_id) == 0);
+    
+    printf("  ✓ Migration compresses in and inflates out\n");
+    
+    /* Deleting a promoted object releases both copies */
+    fd = backend_get_object_fd(mgr, "/z/text", NULL);
+    assert(fd >= 0);
+    close(fd);
+    assert(backend_delete_object(mgr, "/z/text") == 0);
+    assert(used_bytes(mgr, mem_id) == 0);
+    assert(used_bytes(mgr, ssd_id) == text_len + 1000);
+    assert(access("/tmp/objmapper_test_ssd/z/text", F_OK) < 0);
+    
+    printf("  ✓ Deletes account for the compressed home copy\n");
+    
+    free(text);
+    free(noise);
+    backend_manager_destroy(mgr);
+    printf("✓ Compressed persistent tier test passed\n\n");
+}
+
+/* Completions collected by test_aio */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int done;
+    int fds[8];
+    int errors[8];
+    uint64_t sizes[8];
+} aio_results_t;
+
+static void aio_collect(void *arg, const backend_aio_result_t *result) {
+    aio_results_t *r = arg;
+    pthread_mutex_lock(&r->lock);
+    r->fds[r->done] = result->fd;
+    r->errors[r->done] = result->error;
+    r->sizes[r->done] = result->size;
+    r->done++;
+    pthread_cond_signal(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+}
+
+static void aio_wait(aio_results_t *r, int count) {
+    pthread_mutex_lock(&r->lock);
+    while (r->done < count) pthread_cond_wait(&r->cond, &r->lock);
+    pthread_mutex_unlock(&r->lock);
+}
+
+/* Drop an entry's cached FD so the next open goes to disk */
+static void make_cold(backend_manager_t *mgr, const char *uri) {
+    index_entry_t *entry = global_index_get_entry(mgr->global_index, uri);
+    assert(entry != NULL);
+    index_entry_close_fd(entry);
+    index_entry_put(entry);
+}
+
+static void test_aio(void) {
+    printf("Testing io_uring engine...\n");
+    
+    system("rm -rf /tmp/objmapper_test_nvme/*");
+    
+    backend_manager_t *mgr = persist_manager();
+    int mem_id = backend_manager_register(
+        mgr, BACKEND_TYPE_MEMFD, "memfd", "Anonymous",
+        1ULL * 1024 * 1024 * 1024, BACKEND_FLAG_EPHEMERAL_ONLY
+    );
+    assert(backend_manager_set_ephemeral(mgr, mem_id) == 0);
+    
+    backend_aio_t *aio = backend_aio_create(mgr, &(backend_aio_config_t){ .depth = 4 });
+    if (!aio) {
+        assert(errno == ENOSYS || errno == EPERM || errno == ENOMEM);
+        backend_manager_destroy(mgr);
+        printf("  - io_uring unavailable (%s), skipped\n", strerror(errno));
+        printf("✓ io_uring engine test passed\n\n");
+        return;
+    }
+    
+    const char *uris[] = { "/aio/a", "/aio/b", "/aio/c", "/aio/d" };
+    const char *data[] = { "alpha", "bravo", "charlie", "" };
+    for (int i = 0; i < 4; i++) {
+        put_object(mgr, uris[i], data[i]);
+        make_cold(mgr, uris[i]);
+    }
+    
+    /* One batch: nothing reaches the ring before the flush */
+    aio_results_t r = {
+        .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER
+    };
+    for (int i = 0; i < 4; i++) {
+        unsigned flags = BACKEND_AIO_MORE | (i % 2 ? BACKEND_AIO_WARM : 0);
+        assert(backend_aio_open(aio, uris[i], flags, aio_collect, &r) == 0);
+    }
+    
+    /* Every slot is taken */
+    put_object(mgr, "/aio/e", "echo");
+    make_cold(mgr, "/aio/e");
+    assert(backend_aio_open(aio, "/aio/e", 0, aio_collect, &r) < 0);
+    
+    index_stats_t before, after;
+    global_index_get_stats(mgr->global_index, &before);
+    backend_aio_flush(aio);
+    aio_wait(&r, 4);
+    global_index_get_stats(mgr->global_index, &after);
+    assert(after.fd_opens == before.fd_opens + 4);
+    
+    for (int i = 0; i < 4; i++) {
+        assert(r.errors[i] == 0 && r.fds[i] >= 0);
+        char buf[16] = {0};
+        ssize_t n = pread(r.fds[i], buf, sizeof(buf) - 1, 0);
+        
+        /* Completion order is the device's: match by contents */
+        bool matched = false;
+        for (int j = 0; j < 4; j++) {
+            if (n == (ssize_t)strlen(data[j]) && strcmp(buf, data[j]) == 0 &&
+                r.sizes[i] == strlen(data[j])) {
+                matched = true;
+            }
+        }
+        assert(matched);
+        close(r.fds[i]);
+    }
+    
+    printf("  ✓ Batched OPENAT/STATX (and warm-up READs) complete\n");
+    
+    /* The FDs were adopted: the same lookups are now cache hits, and
+     * therefore refused by the engine */
+    assert(backend_object_is_fast(mgr, "/aio/a"));
+    assert(backend_aio_open(aio, "/aio/a", 0, aio_collect, &r) < 0);
+    
+    /* Memory tiers and unknown objects are never queued */
+    object_create_req_t req = { .uri = "/aio/eph", .backend_id = -1, .ephemeral = true };
+    fd_ref_t ref;
+    assert(backend_create_object(mgr, &req, &ref) == 0);
+    fd_ref_release(&ref);
+    assert(backend_aio_open(aio, "/aio/eph", 0, aio_collect, &r) < 0);
+    assert(backend_aio_open(aio, "/aio/missing", 0, aio_collect, &r) < 0);
+    
+    printf("  ✓ Cached, in-memory and unknown objects are refused\n");
+    
+    /* A file removed behind the index reports the open's error */
+    r.done = 0;
+    assert(unlink("/tmp/objmapper_test_nvme/aio/e") == 0);
+    assert(backend_aio_open(aio, "/aio/e", 0, aio_collect, &r) == 0);
+    aio_wait(&r, 1);
+    assert(r.fds[0] < 0 && r.errors[0] == ENOENT);
+    
+    printf("  ✓ Failed opens complete with their errno\n");
+    
+    /* Destroy waits for what is still in flight */
+    r.done = 0;
+    make_cold(mgr, "/aio/b");
+    assert(backend_aio_open(aio, "/aio/b", BACKEND_AIO_WARM, aio_collect, &r) == 0);
+    backend_aio_destroy(aio);
+    assert(r.done == 1 && r.fds[0] >= 0);
+    close(r.fds[0]);
+    
+    printf("  ✓ Destroy drains outstanding opens\n");
+    
+    backend_manager_destroy(mgr);
+    printf("✓ io_uring engine test passed\n\n");
+}
+
+/* Work done by a thread that declared its node */
+typedef struct {
+    backend_manager_t *mgr;
+    int node;
+    const char *create_uri;          /* Ephemeral object to write, or NULL */
+    const char *read_uri;            /* Object to read, or NULL */
+    int reads;
+} numa_job_t;
+
+static void *numa_job_thread(void *arg) {
+    numa_job_t *job = arg;
+    
+    /* Nodes without CPUs here cannot be pinned to, but are recorded */
+    backend_numa_bind_thread(job->node, -1);
+    
+    if (job->create_uri) {
+        object_create_req_t req = { .uri = job->create_uri, .backend_id = -1, .ephemeral = true };
+        fd_ref_t ref;
+        assert(backend_create_object(job->mgr, &req, &ref) == 0);
+        assert(write(ref.fd, "numa", 4) == 4);
+        assert(backend_update_size(job->mgr, job->create_uri, 4) == 0);
+        fd_ref_release(&ref);
+    }
+    for (int i = 0; i < job->reads; i++) {
+        fd_ref_t ref;
+        assert(backend_get_object(job->mgr, job->read_uri, &ref) == 0);
+        fd_ref_release(&ref);
+    }
+    return NULL;
+}
+
+static void run_on_node(numa_job_t job) {
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, numa_job_thread, &job) == 0);
+    pthread_join(thread, NULL);
+}
+
+static int backend_of(backend_manager_t *mgr, const char *uri) {
+    object_metadata_t meta;
+    assert(backend_get_metadata(mgr, uri, &meta) == 0);
+    int id = meta.backend_id;
+    object_metadata_free(&meta);
+    return id;
+}
+
+static void test_numa(void) {
+    printf("Testing NUMA memory tiers...\n");
+    
+    system("rm -rf /tmp/objmapper_test_ssd/*");
+    
+    uint32_t mask;
+    assert(backend_numa_nodes(&mask) >= 1 && (mask & 1));
+    assert(backend_numa_cpu_node(0) >= 0);
+    
+    backend_manager_t *mgr = backend_manager_create(1024, 100);
+    assert(mgr != NULL);
+    uint32_t flags = BACKEND_FLAG_MIGRATION_SRC | BACKEND_FLAG_MIGRATION_DST;
+    int mem0 = backend_manager_register(mgr, BACKEND_TYPE_MEMFD, "node0", "Node 0",
+                                        1ULL << 30, flags | BACKEND_FLAG_EPHEMERAL_ONLY);
+    int mem1 = backend_manager_register(mgr, BACKEND_TYPE_MEMFD, "node1", "Node 1",
+                                        1ULL << 30, flags | BACKEND_FLAG_EPHEMERAL_ONLY);
+    int ssd_id = backend_manager_register(mgr, BACKEND_TYPE_SSD, "/tmp/objmapper_test_ssd",
+                                          "SSD", 10ULL << 30, flags | BACKEND_FLAG_PERSISTENT);
+    assert(backend_manager_set_default(mgr, ssd_id) == 0);
+    assert(backend_manager_set_ephemeral(mgr, mem0) == 0);
+    assert(backend_manager_set_cache(mgr, mem0) == 0);
+    assert(backend_manager_set_numa_node(mgr, mem0, 0) == 0);
+    assert(backend_manager_set_numa_node(mgr, mem1, 1) == 0);
+    assert(backend_manager_set_numa_node(mgr, ssd_id, 2) < 0);
+    assert(backend_manager_set_numa_node(mgr, mem1, BACKEND_NUMA_MAX_NODES) < 0);
+    
+    /* New ephemeral objects land on the creating thread's node */
+    run_on_node((numa_job_t){ .mgr = mgr, .node = 0, .create_uri = "/numa/e0" });
+    run_on_node((numa_job_t){ .mgr = mgr, .node = 1, .create_uri = "/numa/e1" });
+    assert(backend_of(mgr, "/numa/e0") == mem0);
+    assert(backend_of(mgr, "/numa/e1") == mem1);
+    
+    printf("  ✓ Ephemeral objects are created on the caller's node\n");
+    
+    /* Promotion follows the node that reads the object */
+    char data[4096];
+    memset(data, 'n', sizeof(data));
+    create_aged_object(mgr, "/numa/p", data, sizeof(data));
+    run_on_node((numa_job_t){ .mgr = mgr, .node = 1, .read_uri = "/numa/p", .reads = 4 });
+    assert(backend_cache_object(mgr, "/numa/p") == 0);
+    assert(backend_of(mgr, "/numa/p") == mem1);
+    
+    numa_stats_t stats;
+    run_on_node((numa_job_t){ .mgr = mgr, .node = 1, .read_uri = "/numa/p", .reads = 3 });
+    run_on_node((numa_job_t){ .mgr = mgr, .node = 0, .read_uri = "/numa/p", .reads = 1 });
+    assert(backend_get_numa_stats(mgr, 1, &stats) == 0);
+    assert(stats.backend_id == mem1 && stats.objects == 2);
+    assert(stats.local_reads == 3 && stats.remote_reads == 1);
+    assert(backend_get_numa_stats(mgr, 2, &stats) < 0);
+    
+    printf("  ✓ Cache copies go to the reading node, reads counted per node\n");
+    
+    /* An object read from the other node moves there once the vote settles */
+    run_on_node((numa_job_t){ .mgr = mgr, .node = 1, .read_uri = "/numa/e0",
+                              .reads = INDEX_NODE_VOTES_MAX });
+    assert(backend_start_caching(mgr, 10000, 0.5) == 0);
+    cache_stats_t cstats;
+    for (int i = 0; i < 200; i++) {
+        backend_get_cache_stats(mgr, &cstats);
+        if (cstats.rebalances > 0) break;
+        usleep(10000);
+    }
+    backend_stop_caching(mgr);
+    assert(cstats.rebalances == 1);
+    assert(backend_of(mgr, "/numa/e0") == mem1);
+    
+    char buf[8] = {0};
+    int fd = backend_get_object_fd(mgr, "/numa/e0", NULL);
+    assert(fd >= 0 && pread(fd, buf, sizeof(buf), 0) == 4);
+    assert(memcmp(buf, "numa", 4) == 0);
+    close(fd);
+    assert(backend_of(mgr, "/numa/p") == mem1);
+    
+    printf("  ✓ Objects move to the node that reads them\n");
+    
+    backend_manager_destroy(mgr);
+    printf("✓ NUMA test passed\n\n");
+}
+
+/* Write data as the part of uri at offset; returns the commit's result */
+static int put_part_total(backend_manager_t *mgr, const char *uri, uint64_t offset,
+                          const void *data, size_t len, uint64_t total) {
+    object_create_req_t req = { .uri = uri, .backend_id = -1, .part_total = total };
+    object_put_t put;
+    if (backend_put_part_begin(mgr, &req, offset, &put) < 0) return -1;
+    assert(put.fd >= 0 && put.part_of != NULL);
+    assert(pwrite(put.fd, data, len, 0) == (ssize_t)len);
+    return backend_put_commit(mgr, &put, len);
+}
+
+static int put_part(backend_manager_t *mgr, const char *uri, uint64_t offset,
+                    const void *data, size_t len) {
+    return put_part_total(mgr, uri, offset, data, len, 0);
+}
+
+/* Whether the extents of range read the matching bytes of data */
+static bool range_holds(const backend_range_t *range, const char *data) {
+    uint64_t next = range->offset;
+    for (size_t i = 0; i < range->num_extents; i++) {
+        const backend_extent_t *extent = &range->extents[i];
+        if (extent->offset != next || extent->offset < extent->base ||
+            extent->offset + extent->length > extent->base + extent->span) {
+            return false;
+        }
+        
+        char *buf = malloc(extent->length + 1);
+        assert(buf != NULL);
+        bool same = pread(extent->fd, buf, extent->length, extent->offset - extent->base) ==
+                    (ssize_t)extent->length &&
+                    memcmp(buf, data + extent->offset, extent->length) == 0;
+        free(buf);
+        if (!same) return false;
+        next += extent->length;
+    }
+    return next == range->offset + range->length;
+}
+
+static void test_chunked(void) {
+    printf("Testing chunked objects and ranges...\n");
+    
+    system("rm -rf /tmp/objmapper_test_memory/* /tmp/objmapper_test_ssd/*");
+    
+    backend_manager_t *mgr = backend_manager_create(1024, 100);
+    assert(mgr != NULL);
+    uint32_t flags = BACKEND_FLAG_MIGRATION_SRC | BACKEND_FLAG_MIGRATION_DST;
+    int mem_id = backend_manager_register(
+        mgr, BACKEND_TYPE_MEMORY, "/tmp/objmapper_test_memory", "Memory",
+        1ULL * 1024 * 1024 * 1024, BACKEND_FLAG_EPHEMERAL_ONLY | flags
+    );
+    int ssd_id = backend_manager_register(
+        mgr, BACKEND_TYPE_SSD, "/tmp/objmapper_test_ssd", "SSD",
+        10ULL * 1024 * 1024 * 1024, BACKEND_FLAG_PERSISTENT | flags
+    );
+    assert(backend_manager_set_default(mgr, ssd_id) == 0);
+    assert(backend_manager_set_cache(mgr, mem_id) == 0);
+    
+    assert(backend_set_chunk_size(mgr, BACKEND_CHUNK_MIN_BYTES - 1) < 0);
+    assert(backend_set_chunk_size(mgr, BACKEND_CHUNK_MIN_BYTES) == 0);
+    const uint64_t chunk = BACKEND_CHUNK_MIN_BYTES;
+    
+    size_t len = 3 * chunk + 1000;
+    char *data = malloc(len);
+    assert(data != NULL);
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (char)(i * 7 + i / chunk);
+    }
+    
+    /* Parts land in any order; the object ends where the furthest one does */
+    assert(put_part(mgr, "/c/big", 2 * chunk, data + 2 * chunk, chunk) == 0);
+    assert(put_part(mgr, "/c/big", 3 * chunk, data + 3 * chunk, 1000) == 0);
+    assert(put_part(mgr, "/c/big", 0, data, chunk) == 0);
+    
+    uint64_t chunk_bytes, size;
+    assert(backend_chunk_manifest(mgr, "/c/big", &chunk_bytes, &size) == 0);
+    assert(chunk_bytes == chunk && size == len);
+    index_entry_info_t info;
+    assert(backend_stat_object(mgr, "/c/big", &info) == 0);
+    assert(backend_flags_chunked(info.flags) && info.size_bytes == len);
+    
+    /* No single FD holds it */
+    errno = 0;
+    assert(backend_get_object_fd(mgr, "/c/big", NULL) < 0 && errno == EISDIR);
+    assert(!backend_object_is_fast(mgr, "/c/big"));
+    
+    /* Reading a part not written yet fails; parts elsewhere already read */
+    backend_range_t range;
+    errno = 0;
+    assert(backend_get_range(mgr, "/c/big", chunk + 5, 10, 0, &range) < 0 && errno == ENODATA);
+    assert(backend_get_range(mgr, "/c/big", 2 * chunk - 5, 10, 0, &range) < 0);
+    assert(backend_get_range(mgr, "/c/big", 2 * chunk + 5, 10, 0, &range) == 0);
+    assert(range.num_extents == 1 && range_holds(&range, data));
+    backend_range_release(&range);
+    
+    /* Misfitting parts are refused */
+    object_create_req_t req = { .uri = "/c/big", .backend_id = -1 };
+    object_put_t put;
+    errno = 0;
+    assert(backend_put_part_begin(mgr, &req, chunk + 1, &put) < 0 && errno == EINVAL);
+    req.ephemeral = true;
+    errno = 0;
+    assert(backend_put_part_begin(mgr, &req, chunk, &put) < 0 && errno == EINVAL);
+    errno = 0;
+    assert(put_part(mgr, "/c/big", chunk, data + chunk, 100) < 0 && errno == EINVAL);
+    errno = 0;
+    assert(put_part(mgr, "/c/big", 4 * chunk, data, 100) < 0 && errno == EINVAL);
+    
+    assert(put_part(mgr, "/c/big", chunk, data + chunk, chunk) == 0);
+    assert(backend_chunk_manifest(mgr, "/c/big", NULL, &size) == 0 && size == len);
+    
+    printf("  ✓ Parts commit in any order, misfits refused\n");
+    
+    /* Ranges span chunks, clamp to the end and must start inside */
+    assert(backend_get_range(mgr, "/c/big", chunk - 10, 20, 0, &range) == 0);
+    assert(range.size == len && range.length == 20 && range.num_extents == 2);
+    assert(range_holds(&range, data));
+    backend_range_release(&range);
+    
+    assert(backend_get_range(mgr, "/c/big", 0, 0, 0, &range) == 0);
+    assert(range.length == len && range.num_extents == 4 && range_holds(&range, data));
+    assert(backend_flags_chunked(range.info.flags) && range.info.size_bytes == len);
+    backend_range_release(&range);
+    
+    assert(backend_get_range(mgr, "/c/big", 3 * chunk + 900, 500, 0, &range) == 0);
+    assert(range.length == 100 && range_holds(&range, data));
+    backend_range_release(&range);
+    
+    errno = 0;
+    assert(backend_get_range(mgr, "/c/big", len, 0, 0, &range) < 0 && errno == ERANGE);
+    errno = 0;
+    assert(backend_get_range(mgr, "/c/none", 0, 0, 0, &range) < 0 && errno == ENOENT);
+    
+    /* One extent is the whole chunk holding the offset, e.g. to pass its FD */
+    assert(backend_get_range(mgr, "/c/big", chunk + 100, 0, 1, &range) == 0);
+    assert(range.num_extents == 1 && range.extents[0].base == chunk);
+    assert(range.extents[0].span == chunk && range.length == chunk - 100);
+    assert(range_holds(&range, data));
+    backend_range_release(&range);
+    
+    /* A plain object is a single extent */
+    put_bytes(mgr, "/c/plain", data, 5000);
+    assert(backend_get_range(mgr, "/c/plain", 100, 50, 0, &range) == 0);
+    assert(range.num_extents == 1 && range.extents[0].base == 0);
+    assert(range.extents[0].span == 5000 && range.size == 5000);
+    assert(range_holds(&range, data));
+    backend_range_release(&range);
+    
+    printf("  ✓ Ranges read across chunks and plain objects\n");
+    
+    /* Chunks are objects of their own: one is promoted, the rest stay */
+    char chunk_uri[256];
+    assert(backend_chunk_uri("/c/big", 1, chunk_uri, sizeof(chunk_uri)) == 0);
+    assert(strcmp(chunk_uri, "/c/big.chunks/00000001") == 0);
+    object_metadata_t meta;
+    assert(backend_get_metadata(mgr, chunk_uri, &meta) == 0 && meta.fs_path != NULL);
+    struct timespec times[2] = {
+        { .tv_sec = time(NULL) - 60, .tv_nsec = 0 },
+        { .tv_sec = time(NULL) - 60, .tv_nsec = 0 }
+    };
+    assert(utimensat(AT_FDCWD, meta.fs_path, times, 0) == 0);
+    object_metadata_free(&meta);
+    assert(backend_cache_object(mgr, chunk_uri) == 0);
+    assert(backend_of(mgr, chunk_uri) == mem_id);
+    assert(backend_of(mgr, "/c/big.chunks/00000000") == ssd_id);
+    assert(used_bytes(mgr, mem_id) == chunk);
+    
+    assert(backend_get_range(mgr, "/c/big", chunk - 10, 20, 0, &range) == 0);
+    assert(range_holds(&range, data));
+    backend_range_release(&range);
+    assert(backend_evict_object(mgr, chunk_uri) == 0);
+    assert(used_bytes(mgr, mem_id) == 0);
+    
+    printf("  ✓ Chunks are promoted and evicted on their own\n");
+    
+    /* A first part declaring a shorter total starts a new version */
+    assert(put_part(mgr, "/c/shrink", 0, data, chunk) == 0);
+    assert(put_part(mgr, "/c/shrink", chunk, data + chunk, chunk) == 0);
+    assert(put_part(mgr, "/c/shrink", 2 * chunk, data + 2 * chunk, chunk) == 0);
+    errno = 0;
+    assert(put_part_total(mgr, "/c/shrink", chunk, data, chunk, chunk) < 0 && errno == EINVAL);
+    errno = 0;
+    assert(put_part_total(mgr, "/c/shrink", 0, data, 100, 2 * chunk) < 0 && errno == EINVAL);
+    assert(backend_chunk_manifest(mgr, "/c/shrink", NULL, &size) == 0 && size == 3 * chunk);
+    
+    assert(put_part_total(mgr, "/c/shrink", 0, data, chunk, chunk + 10) == 0);
+    assert(backend_chunk_manifest(mgr, "/c/shrink", NULL, &size) == 0);
+    assert(size == chunk + 10);
+    assert(backend_stat_object(mgr, "/c/shrink.chunks/00000001", &info) == 0);
+    assert(backend_stat_object(mgr, "/c/shrink.chunks/00000002", &info) < 0);
+    assert(put_part(mgr, "/c/shrink", chunk, data + chunk, 10) == 0);
+    assert(backend_get_range(mgr, "/c/shrink", 0, 0, 0, &range) == 0);
+    assert(range.length == chunk + 10 && range_holds(&range, data));
+    backend_range_release(&range);
+    
+    /* A single short part shrinks it to that part */
+    assert(put_part_total(mgr, "/c/shrink", 0, data, 50, 50) == 0);
+    assert(backend_chunk_manifest(mgr, "/c/shrink", NULL, &size) == 0 && size == 50);
+    assert(backend_stat_object(mgr, "/c/shrink.chunks/00000001", &info) < 0);
+    assert(backend_delete_object(mgr, "/c/shrink") == 0);
+    
+    printf("  ✓ A declared total shrinks the object and drops stale chunks\n");
+    
+    /* Deleting or overwriting with a plain object drops the chunks */
+    assert(backend_delete_object(mgr, "/c/big") == 0);
+    assert(backend_stat_object(mgr, chunk_uri, &info) < 0);
+    assert(backend_stat_object(mgr, "/c/big.chunks/00000003", &info) < 0);
+    
+    assert(put_part(mgr, "/c/over", 0, data, chunk) == 0);
+    assert(put_part(mgr, "/c/over", chunk, data + chunk, 10) == 0);
+    put_bytes(mgr, "/c/over", data, 100);
+    assert(backend_stat_object(mgr, "/c/over.chunks/00000000", &info) < 0);
+    assert(backend_stat_object(mgr, "/c/over.chunks/00000001", &info) < 0);
+    int fd = backend_get_object_fd(mgr, "/c/over", NULL);
+    assert(fd >= 0 && fd_holds(fd, data, 100));
+    close(fd);
+    assert(used_bytes(mgr, ssd_id) == 5000 + 100);
+    
+    printf("  ✓ Delete and plain overwrite drop the chunks\n");
+    
+    free(data);
+    backend_manager_destroy(mgr);
+    printf("✓ Chunked object test passed\n\n");
+}
+
+/* Drain a listing into "uri:size uri:size ..." */
+static void list_drain(backend_list_t *list, size_t batch, char *out, size_t size) {
+    backend_list_item_t items[8];
+    size_t n;
+    out[0] = '\0';
+    while ((n = backend_list_next(list, items, batch)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            size_t used = strlen(out);
+            snprintf(out + used, size - used, "%s%s:%lu", used ? " " : "",
+                     items[i].uri, items[i].info.size_bytes);
+            free(items[i].uri);
+        }
+    }
+}
+
+static void test_prefix_listing(void) {
+    printf("Testing prefix listing and purge...\n");
+    
+    system("rm -rf /tmp/objmapper_test_nvme/*");
+    
+    backend_manager_t *mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == -1);
+    put_object(mgr, "/l/a", "alpha");
+    put_object(mgr, "/l/b", "bravo");
+    put_object(mgr, "/l/c/1", "charlie");
+    put_object(mgr, "/m/x", "xray");
+    assert(backend_manager_checkpoint(mgr, 0) == 0);
+    backend_manager_destroy(mgr);
+    
+    /* Image-only objects are listed without being faulted in */
+    mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == 4);
+    put_object(mgr, "/l/d", "delta");
+    
+    assert(backend_set_chunk_size(mgr, BACKEND_CHUNK_MIN_BYTES) == 0);
+    const uint64_t chunk = BACKEND_CHUNK_MIN_BYTES;
+    char *data = calloc(1, chunk);
+    assert(data != NULL);
+    assert(put_part(mgr, "/l/big", 0, data, chunk) == 0);
+    assert(put_part(mgr, "/l/big", chunk, data, 10) == 0);
+    
+    char out[1024];
+    backend_list_t *list = backend_list_open(mgr, "/l/");
+    assert(list != NULL);
+    list_drain(list, 2, out, sizeof(out));
+    backend_list_close(list);
+    char want[256];
+    snprintf(want, sizeof(want), "/l/a:5 /l/b:5 /l/big:%lu /l/c/1:7 /l/d:5", chunk + 10);
+    assert(strcmp(out, want) == 0);
+    
+    index_stats_t stats;
+    backend_get_index_stats(mgr, &stats);
+    assert(stats.num_entries == 4);  /* /l/d, /l/big and its two chunks */
+    
+    printf("  ✓ Listings stream in URI order, image objects included\n");
+    printf("  ✓ Chunked objects are listed once, at their object size\n");
+    
+    /* A purge deletes what matched when it started; a listing open across
+     * it skips what is gone */
+    list = backend_list_open(mgr, "/l/");
+    backend_list_item_t item;
+    assert(backend_list_next(list, &item, 1) == 1);
+    assert(strcmp(item.uri, "/l/a") == 0);
+    free(item.uri);
+    
+    size_t purged = 0;
+    assert(backend_purge_prefix(mgr, "/l/", &purged) == 0);
+    assert(purged == 5);
+    assert(backend_list_next(list, &item, 1) == 0);
+    backend_list_close(list);
+    
+    index_entry_info_t info;
+    assert(backend_stat_object(mgr, "/l/b", &info) < 0);
+    assert(backend_stat_object(mgr, "/l/big.chunks/00000001", &info) < 0);
+    assert(backend_stat_object(mgr, "/m/x", &info) == 0);
+    
+    size_t num_keys, tombstones;
+    index_prefix_counts(&mgr->global_index->prefix, &num_keys, &tombstones);
+    assert(num_keys == 1 && tombstones == 0);
+    
+    printf("  ✓ Purge by prefix deletes the matched objects and their chunks\n");
+    
+    /* The deletes are journaled like any other */
+    backend_manager_destroy(mgr);
+    mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) >= 1);
+    list = backend_list_open(mgr, "");
+    list_drain(list, 8, out, sizeof(out));
+    backend_list_close(list);
+    assert(strcmp(out, "/m/x:4") == 0);
+    
+    printf("  ✓ Purged objects stay gone after a restart\n");
+    
+    free(data);
+    backend_manager_destroy(mgr);
+    printf("✓ Prefix listing test passed\n\n");
+}
+
+typedef struct {
+    backend_manager_t *mgr;
+    int n;
+} durable_job_t;
+
+/* A persistent PUT acknowledged the way the server does it */
+static void *durable_put_thread(void *arg) {
+    durable_job_t *job = arg;
+    char uri[64], data[32];
+    snprintf(uri, sizeof(uri), "/d/%d/obj", job->n % 2);
+    snprintf(uri + strlen(uri), sizeof(uri) - strlen(uri), "%d", job->n);
+    snprintf(data, sizeof(data), "durable %d", job->n);
+    
+    object_create_req_t req = { .uri = uri, .backend_id = -1, .replace = true };
+    object_put_t put;
+    assert(backend_put_begin(job->mgr, &req, &put) == 0);
+    assert(write(put.fd, data, strlen(data)) == (ssize_t)strlen(data));
+    assert(backend_put_commit(job->mgr, &put, strlen(data)) == 0);
+    assert(backend_durable_wait(job->mgr) == 0);
+    return NULL;
+}
+
+static void test_durable(void) {
+    printf("Testing group commit durability...\n");
+    
+    /* The earlier tests' image and journal too */
+    system("rm -rf /tmp/objmapper_test_nvme/* /tmp/objmapper_test_nvme/.objmapper.*");
+    
+    backend_manager_t *mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == -1);
+    assert(backend_manager_checkpoint(mgr, 0) == 0);
+    
+    durable_stats_t stats;
+    assert(backend_durable_get_stats(mgr, &stats) < 0);
+    assert(backend_durable_wait(mgr) == 0);
+    
+    backend_durable_config_t config = {
+        .budget_us = 50000,
+        .batch = 4,
+        .checkpoint_records = 8,
+        .checkpoint_interval_us = 10000,
+    };
+    assert(backend_durable_start(mgr, &config) == 0);
+    assert(backend_durable_start(mgr, &config) == 0);
+    
+    /* Concurrent PUTs share the rounds that sync their data and their names */
+    enum { NUM_PUTS = 8 };
+    pthread_t threads[NUM_PUTS];
+    durable_job_t jobs[NUM_PUTS];
+    for (int i = 0; i < NUM_PUTS; i++) {
+        jobs[i] = (durable_job_t){ .mgr = mgr, .n = i };
+        assert(pthread_create(&threads[i], NULL, durable_put_thread, &jobs[i]) == 0);
+    }
+    for (int i = 0; i < NUM_PUTS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    
+    assert(backend_durable_get_stats(mgr, &stats) == 0);
+    assert(stats.data_syncs >= 1 && stats.data_syncs < NUM_PUTS);
+    assert(stats.waits >= 2 * NUM_PUTS);
+    assert(stats.rounds < stats.waits);
+    assert(stats.journal_syncs >= 1 && stats.journal_syncs < NUM_PUTS);
+    assert(stats.dir_syncs >= 1 && stats.dir_syncs <= NUM_PUTS);
+    assert(stats.errors == 0);
+    
+    printf("  ✓ Concurrent PUTs are synced in shared rounds\n");
+    
+    /* A full journal is folded into the image in the background */
+    for (int i = 0; i < 200 && stats.checkpoints == 0; i++) {
+        usleep(10000);
+        assert(backend_durable_get_stats(mgr, &stats) == 0);
+    }
+    assert(stats.checkpoints >= 1 && stats.checkpoint_records >= NUM_PUTS);
+    backend_info_t *nvme = backend_manager_get_backend(mgr, 0);
+    assert(atomic_load(&nvme->journal->appended) < (uint64_t)NUM_PUTS);
+    
+    printf("  ✓ Long journals are checkpointed in the background\n");
+    
+    /* Stopped: data is synced inline, nothing waits */
+    backend_durable_stop(mgr);
+    assert(backend_durable_get_stats(mgr, &stats) < 0);
+    int fd = open("/tmp/objmapper_test_nvme/d/0/obj0", O_RDONLY);
+    assert(fd >= 0);
+    assert(backend_durable_sync_fd(mgr, fd) == 0);
+    close(fd);
+    assert(backend_durable_wait(mgr) == 0);
+    backend_manager_destroy(mgr);
+    
+    mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == NUM_PUTS);
+    assert_contents(mgr, "/d/1/obj7", "durable 7");
+    backend_manager_destroy(mgr);
+    
+    printf("  ✓ Committed objects are restored\n");
+    printf("✓ Durability test passed\n\n");
+}
+
+/* Put back the index files saved under the memory tier's directory */
+static void crash_restore_files(const char *image, const char *journal) {
+    char cmd[512];
+    snprintf(cmd, sizeof(cmd),
+             "cp /tmp/objmapper_test_memory/%s /tmp/objmapper_test_nvme/.objmapper.idx && "
+             "cp /tmp/objmapper_test_memory/%s /tmp/objmapper_test_nvme/.objmapper.journal",
+             image, journal);
+    assert(system(cmd) == 0);
+}
+
+static void test_checkpoint_crash(void) {
+    printf("Testing crashes during a checkpoint...\n");
+    
+    system("rm -rf /tmp/objmapper_test_nvme/* /tmp/objmapper_test_nvme/.objmapper.*");
+    
+    index_entry_info_t info;
+    backend_manager_t *mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == -1);
+    put_object(mgr, "/k/a", "alpha");
+    put_object(mgr, "/k/b", "bravo");
+    assert(backend_manager_checkpoint(mgr, 0) == 0);
+    put_object(mgr, "/k/c", "charlie");
+    assert(backend_delete_object(mgr, "/k/a") == 0);
+    
+    /* The files before and after the next checkpoint */
+    system("cp /tmp/objmapper_test_nvme/.objmapper.idx /tmp/objmapper_test_memory/old.idx");
+    system("cp /tmp/objmapper_test_nvme/.objmapper.journal /tmp/objmapper_test_memory/old.journal");
+    assert(backend_manager_checkpoint(mgr, 0) == 0);
+    system("cp /tmp/objmapper_test_nvme/.objmapper.idx /tmp/objmapper_test_memory/new.idx");
+    backend_manager_destroy(mgr);
+    
+    /* The rename never reached the disk: the journal is only reset once
+     * the directory is synced, so the old image still has its records */
+    crash_restore_files("old.idx", "old.journal");
+    system("cp /tmp/objmapper_test_memory/new.idx /tmp/objmapper_test_nvme/.objmapper.idx.tmp");
+    mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == 2);
+    assert(backend_stat_object(mgr, "/k/a", &info) < 0);
+    assert_contents(mgr, "/k/b", "bravo");
+    assert_contents(mgr, "/k/c", "charlie");
+    backend_manager_destroy(mgr);
+    
+    printf("  ✓ An image not yet renamed durably leaves the journal intact\n");
+    
+    /* The new image is durable, the journal not yet reset */
+    crash_restore_files("new.idx", "old.journal");
+    mgr = persist_manager();
+    assert(backend_manager_restore(mgr, 0) == 2);
+    assert(backend_stat_object(mgr, "/k/a", &info) < 0);
+    assert_contents(mgr, "/k/c", "charlie");
+    backend_manager_destroy(mgr);
+    
+    system("rm -f /tmp/objmapper_test_memory/*.idx /tmp/objmapper_test_memory/*.journal");
+    
+    printf("  ✓ A journal older than the image is discarded\n");
+    printf("✓ Checkpoint crash test passed\n\n");
+}
+
 int main(void) {
     printf("=== objmapper Backend Tests ===\n\n");
     
@@ -329,6 +1958,18 @@ int main(void) {
     test_object_operations();
     test_backend_stats();
     test_backend_management();
+    test_caching_engine();
+    test_index_persistence();
+    test_migration();
+    test_memfd_backend();
+    test_atomic_put();
+    test_compression();
+    test_aio();
+    test_numa();
+    test_chunked();
+    test_prefix_listing();
+    test_durable();
+    test_checkpoint_crash();
     
     cleanup_test_dirs();
     
@@ -0,0 +1,588 @@
+/**
+ * @file async.c
+ * @brief Asynchronous, pooled client for one objmapper server
+ */
+
+#define _GNU_SOURCE
+#include "async.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+/* Request IDs: slot in the low bits, a per-connection sequence above */
+#define ASYNC_SLOT_BITS   10
+#define ASYNC_MAX_DEPTH   (1u << ASYNC_SLOT_BITS)
+
+_Static_assert(OBJM_MAX_PIPELINE <= ASYNC_MAX_DEPTH, "slot bits must cover the pipeline");
+
+/* ============================================================================
+ * Internal Structures
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t id;                     /* Request ID on the wire */
+    bool busy;
+    uint8_t op;
+    objm_async_cb_t cb;
+    void *arg;
+    int next_free;                   /* Free list, -1 = end */
+} async_slot_t;
+
+typedef enum {
+    LINK_DOWN,                       /* No session (reader joined or never started) */
+    LINK_CONNECTING,                 /* A submitter is opening it */
+    LINK_UP,                         /* Takes requests */
+    LINK_CLOSING,                    /* Broken: the reader fails what is in flight */
+} link_state_t;
+
+/* One pooled session; everything but the socket I/O is under client->lock */
+typedef struct {
+    link_state_t state;
+    transport_t *transport;
+    objm_connection_t *conn;
+    pthread_t reader;
+    bool has_reader;                 /* reader needs joining */
+    
+    async_slot_t *slots;             /* depth entries */
+    unsigned depth;                  /* Negotiated pipeline depth */
+    unsigned in_flight;
+    int free_head;
+    uint32_t seq;
+    unsigned senders;                /* Submitters writing to conn */
+    
+    pthread_mutex_t send_lock;       /* Keeps batches whole on the socket */
+} async_link_t;
+
+typedef struct async_completion {
+    objm_async_result_t result;
+    struct async_completion *next;
+} async_completion_t;
+
+typedef struct {
+    objm_async_t *client;
+    async_link_t *link;
+} reader_arg_t;
+
+struct objm_async {
+    objm_async_config_t config;
+    char addr[256];                  /* Copy of the socket path / host */
+    
+    pthread_mutex_t lock;
+    pthread_cond_t changed;          /* Room, link state, outstanding */
+    pthread_cond_t completed;        /* Completion queue */
+    async_link_t *links;
+    size_t num_links;
+    size_t next_link;                /* Round-robin start */
+    size_t outstanding;
+    bool stopping;
+    
+    async_completion_t *queue_head;
+    async_completion_t *queue_tail;
+};
+
+/* ============================================================================
+ * Connections
+ * ============================================================================ */
+
+static void *reader_thread(void *arg);
+
+/* Connect and handshake a link (client->lock not held, state CONNECTING) */
+static int link_open(objm_async_t *client, async_link_t *link) {
+    transport_t *transport = transport_client_connect(&client->config.transport);
+    if (!transport) return -1;
+    
+    int fd = transport_get_fd(transport);
+    if (client->config.transport.type == TRANSPORT_TCP) {
+        /* Batches are flushed by sendmsg, not by Nagle */
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    
+    objm_connection_t *conn = objm_client_create(fd, OBJM_PROTO_V2);
+    objm_hello_t hello = {
+        .capabilities = OBJM_CAP_OOO_REPLIES | OBJM_CAP_PIPELINING |
+                        (client->config.transport.type == TRANSPORT_UNIX ?
+                         OBJM_CAP_SHM_RING : 0),
+        .max_pipeline = client->config.depth,
+        .backend_parallelism = 1
+    };
+    objm_params_t params;
+    if (!conn || objm_client_hello(conn, &hello, &params) < 0) goto fail;
+    
+    /* Pipelining is what the server granted, never more than we asked */
+    unsigned depth = params.max_pipeline;
+    if (!(params.capabilities & OBJM_CAP_PIPELINING) || depth == 0) depth = 1;
+    if (depth > client->config.depth) depth = client->config.depth;
+    
+    async_slot_t *slots = calloc(depth, sizeof(*slots));
+    if (!slots) goto fail;
+    for (unsigned i = 0; i < depth; i++) {
+        slots[i].next_free = (i + 1 < depth) ? (int)i + 1 : -1;
+    }
+    
+    /* The previous session's reader has finished (state was DOWN) */
+    if (link->has_reader) {
+        pthread_join(link->reader, NULL);
+        link->has_reader = false;
+    }
+    
+    link->transport = transport;
+    link->conn = conn;
+    link->slots = slots;
+    link->depth = depth;
+    link->in_flight = 0;
+    link->free_head = 0;
+    
+    reader_arg_t *rarg = malloc(sizeof(*rarg));
+    if (!rarg) goto fail_slots;
+    rarg->client = client;
+    rarg->link = link;
+    if (pthread_create(&link->reader, NULL, reader_thread, rarg) != 0) {
+        free(rarg);
+        goto fail_slots;
+    }
+    link->has_reader = true;
+    return 0;
+    
+fail_slots:
+    free(slots);
+    link->slots = NULL;
+    link->conn = NULL;
+    link->transport = NULL;
+fail:
+    {
+        int saved = errno;
+        if (conn) objm_client_destroy(conn);
+        transport_close(transport);
+        errno = saved ? saved : ECONNREFUSED;
+    }
+    return -1;
+}
+
+/* Hand a result to its callback or the completion queue */
+static void deliver(objm_async_t *client, const objm_async_result_t *result,
+                    objm_async_cb_t cb) {
+    if (cb) {
+        cb(result);
+        pthread_mutex_lock(&client->lock);
+    } else {
+        async_completion_t *c = malloc(sizeof(*c));
+        pthread_mutex_lock(&client->lock);
+        if (c) {
+            c->result = *result;
+            c->next = NULL;
+            if (client->queue_tail) client->queue_tail->next = c;
+            else client->queue_head = c;
+            client->queue_tail = c;
+            pthread_cond_broadcast(&client->completed);
+        } else {
+            objm_response_free(result->resp);  /* Nowhere to put it */
+        }
+    }
+    
+    client->outstanding--;
+    pthread_cond_broadcast(&client->changed);
+    pthread_mutex_unlock(&client->lock);
+}
+
+/* Free a slot (lock held); returns its completion target */
+static async_slot_t slot_release_locked(async_link_t *link, int index) {
+    async_slot_t done = link->slots[index];
+    link->slots[index].busy = false;
+    link->slots[index].next_free = link->free_head;
+    link->free_head = index;
+    link->in_flight--;
+    return done;
+}
+
+/* Streamed bodies sit in front of the next reply: spool them now */
+static int spool_body(objm_connection_t *conn, objm_response_t *resp, char mode) {
+    int fd = memfd_create("objmapper-async", MFD_CLOEXEC);
+    uint64_t len = 0;
+    if (objm_recv_body(conn, fd, mode, &len) < 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    if (fd < 0) {
+        /* Body consumed, but there is nowhere to keep it */
+        resp->status = OBJM_STATUS_OUT_OF_MEMORY;
+        resp->content_len = OBJM_CONTENT_NONE;
+        return 0;
+    }
+    
+    resp->fd = fd;
+    resp->content_len = len;
+    return 0;
+}
+
+static void *reader_thread(void *arg) {
+    reader_arg_t *rarg = arg;
+    objm_async_t *client = rarg->client;
+    async_link_t *link = rarg->link;
+    free(rarg);
+    
+    char mode = client->config.mode;
+    int error = EPIPE;
+    
+    for (;;) {
+        objm_response_t *resp;
+        if (objm_client_recv_response(link->conn, &resp) < 0) {
+            if (errno) error = errno;
+            break;
+        }
+        
+        if (resp->status == OBJM_STATUS_OK && resp->content_len == OBJM_CONTENT_CHUNKED &&
+            spool_body(link->conn, resp, mode) < 0) {
+            if (errno) error = errno;
+            objm_response_free(resp);
+            break;
+        }
+        
+        pthread_mutex_lock(&client->lock);
+        int index = resp->request_id & (ASYNC_MAX_DEPTH - 1);
+        if ((unsigned)index >= link->depth || !link->slots[index].busy ||
+            link->slots[index].id != resp->request_id) {
+            pthread_mutex_unlock(&client->lock);
+            objm_response_free(resp);
+            error = EPROTO;  /* Reply to nothing we sent */
+            break;
+        }
+        async_slot_t done = slot_release_locked(link, index);
+        pthread_cond_broadcast(&client->changed);
+        pthread_mutex_unlock(&client->lock);
+        
+        objm_async_result_t result = { .arg = done.arg, .op = done.op, .resp = resp };
+        deliver(client, &result, done.cb);
+    }
+    
+    /* Broken (or shut down): no new requests; wait out writers mid-batch */
+    pthread_mutex_lock(&client->lock);
+    link->state = LINK_CLOSING;
+    shutdown(objm_get_fd(link->conn), SHUT_RDWR);
+    while (link->senders > 0) pthread_cond_wait(&client->changed, &client->lock);
+    
+    /* Fail whatever is still in flight */
+    for (unsigned i = 0; i < link->depth; i++) {
+        if (!link->slots[i].busy) continue;
+        
+        async_slot_t done = slot_release_locked(link, i);
+        pthread_mutex_unlock(&client->lock);
+        objm_async_result_t result = { .arg = done.arg, .op = done.op, .error = error };
+        deliver(client, &result, done.cb);
+        pthread_mutex_lock(&client->lock);
+    }
+    
+    objm_client_destroy(link->conn);
+    transport_close(link->transport);
+    free(link->slots);
+    link->conn = NULL;
+    link->transport = NULL;
+    link->slots = NULL;
+    link->depth = 0;
+    link->state = LINK_DOWN;
+    pthread_cond_broadcast(&client->changed);
+    pthread_mutex_unlock(&client->lock);
+    return NULL;
+}
+
+/* ============================================================================
+ * Client
+ * ============================================================================ */
+
+objm_async_t *objm_async_create(const objm_async_config_t *config) {
+    if (!config) return NULL;
+    
+    objm_async_t *client = calloc(1, sizeof(*client));
+    if (!client) return NULL;
+    client->config = *config;
+    
+    /* The address is copied: the caller's strings need not outlive us */
+    int n;
+    switch (config->transport.type) {
+    case TRANSPORT_UNIX:
+        n = snprintf(client->addr, sizeof(client->addr), "%s",
+                     config->transport.unix_cfg.path ? config->transport.unix_cfg.path : "");
+        client->config.transport.unix_cfg.path = client->addr;
+        if (!client->config.mode) client->config.mode = OBJM_MODE_FDPASS;
+        break;
+    case TRANSPORT_TCP:
+        n = snprintf(client->addr, sizeof(client->addr), "%s",
+                     config->transport.tcp_cfg.host ? config->transport.tcp_cfg.host : "");
+        client->config.transport.tcp_cfg.host = client->addr;
+        if (!client->config.mode) client->config.mode = OBJM_MODE_COPY;
+        if (client->config.mode == OBJM_MODE_FDPASS) n = -1;  /* No SCM_RIGHTS */
+        break;
+    default:
+        n = -1;
+        break;
+    }
+    if (n <= 0 || (size_t)n >= sizeof(client->addr)) {
+        free(client);
+        errno = EINVAL;
+        return NULL;
+    }
+    
+    if (!client->config.connections) client->config.connections = OBJM_ASYNC_CONNECTIONS;
+    if (!client->config.depth) client->config.depth = OBJM_ASYNC_DEPTH;
+    if (client->config.depth > OBJM_MAX_PIPELINE) client->config.depth = OBJM_MAX_PIPELINE;
+    
+    client->links = calloc(client->config.connections, sizeof(async_link_t));
+    if (!client->links) {
+        free(client);
+        return NULL;
+    }
+    client->num_links = client->config.connections;
+    for (size_t i = 0; i < client->num_links; i++) {
+        pthread_mutex_init(&client->links[i].send_lock, NULL);
+    }
+    
+    pthread_mutex_init(&client->lock, NULL);
+    pthread_cond_init(&client->changed, NULL);
+    pthread_cond_init(&client->completed, NULL);
+    return client;
+}
+
+void objm_async_destroy(objm_async_t *client) {
+    if (!client) return;
+    
+    objm_async_drain(client);
+    
+    /* Readers see EOF and tear their sessions down */
+    pthread_mutex_lock(&client->lock);
+    client->stopping = true;
+    for (size_t i = 0; i < client->num_links; i++) {
+        async_link_t *link = &client->links[i];
+        if (link->state == LINK_UP) shutdown(objm_get_fd(link->conn), SHUT_RDWR);
+    }
+    pthread_mutex_unlock(&client->lock);
+    
+    for (size_t i = 0; i < client->num_links; i++) {
+        async_link_t *link = &client->links[i];
+        if (link->has_reader) pthread_join(link->reader, NULL);
+        pthread_mutex_destroy(&link->send_lock);
+    }
+    
+    /* Results nobody reaped */
+    async_completion_t *c = client->queue_head;
+    while (c) {
+        async_completion_t *next = c->next;
+        objm_response_free(c->result.resp);
+        free(c);
+        c = next;
+    }
+    
+    pthread_cond_destroy(&client->completed);
+    pthread_cond_destroy(&client->changed);
+    pthread_mutex_destroy(&client->lock);
+    free(client->links);
+    free(client);
+}
+
+/**
+ * Pick a link with room, opening one if needed (lock held)
+ *
+ * Fills the emptiest open link first; another session is only opened when
+ * every open one is full, so a light load stays on one connection.
+ *
+ * @return Link with at least one free slot, or NULL with errno set
+ */
+static async_link_t *link_pick_locked(objm_async_t *client) {
+    for (;;) {
+        if (client->stopping) {
+            errno = ESHUTDOWN;
+            return NULL;
+        }
+        
+        async_link_t *best = NULL, *down = NULL;
+        bool busy = false;               /* Something will change the picture */
+        for (size_t n = 0; n < client->num_links; n++) {
+            async_link_t *link = &client->links[(client->next_link + n) % client->num_links];
+            switch (link->state) {
+            case LINK_UP:
+                if (link->in_flight < link->depth &&
+                    (!best || link->depth - link->in_flight > best->depth - best->in_flight)) {
+                    best = link;
+                }
+                busy = true;
+                break;
+            case LINK_DOWN:
+                if (!down) down = link;
+                break;
+            default:
+                busy = true;
+                break;
+            }
+        }
+        
+        if (best) {
+            client->next_link = (best - client->links + 1) % client->num_links;
+            return best;
+        }
+        
+        if (down) {
+            down->state = LINK_CONNECTING;
+            pthread_mutex_unlock(&client->lock);
+            int ret = link_open(client, down);
+            int saved = errno;
+            pthread_mutex_lock(&client->lock);
+            
+            down->state = (ret == 0) ? LINK_UP : LINK_DOWN;
+            pthread_cond_broadcast(&client->changed);
+            if (ret == 0) continue;
+            if (!busy) {
+                errno = saved;  /* Nothing is connected: the server is unreachable */
+                return NULL;
+            }
+        }
+        
+        pthread_cond_wait(&client->changed, &client->lock);
+    }
+}
+
+static bool op_valid(const objm_async_t *client, const objm_async_op_t *op) {
+    if (!op->uri || strlen(op->uri) > OBJM_MAX_URI_LEN) return false;
+    switch (op->op) {
+    case OBJM_OP_GET:
+    case OBJM_OP_DELETE:
+    case OBJM_OP_STAT:
+        return true;
+    case OBJM_OP_PUT:
+        /* The reply is the writer FD; streamed PUTs need a body after the request */
+        return client->config.mode == OBJM_MODE_FDPASS;
+    default:
+        return false;
+    }
+}
+
+size_t objm_async_submit(objm_async_t *client, const objm_async_op_t *ops, size_t count) {
+    if (!client || (count && !ops)) {
+        errno = EINVAL;
+        return 0;
+    }
+    
+    objm_request_t reqs[OBJM_SEND_BATCH];
+    size_t submitted = 0;
+    
+    while (submitted < count) {
+        if (!op_valid(client, &ops[submitted])) {
+            errno = EINVAL;
+            break;
+        }
+        
+        pthread_mutex_lock(&client->lock);
+        async_link_t *link = link_pick_locked(client);
+        if (!link) {
+            pthread_mutex_unlock(&client->lock);
+            break;
+        }
+        
+        /* As much of the batch as the link has room for */
+        size_t n = 0;
+        while (submitted + n < count && n < OBJM_SEND_BATCH &&
+               link->in_flight < link->depth && op_valid(client, &ops[submitted + n])) {
+            const objm_async_op_t *op = &ops[submitted + n];
+            int index = link->free_head;
+            async_slot_t *slot = &link->slots[index];
+            link->free_head = slot->next_free;
+            link->in_flight++;
+            
+            slot->id = (++link->seq << ASYNC_SLOT_BITS) | (uint32_t)index;
+            slot->busy = true;
+            slot->op = op->op;
+            slot->cb = op->cb;
+            slot->arg = op->arg;
+            
+            reqs[n] = (objm_request_t){
+                .id = slot->id,
+                .op = op->op,
+                .flags = op->flags & (OBJM_REQ_ORDERED | OBJM_REQ_PRIORITY),
+                .mode = client->config.mode,
+                .uri = (char *)op->uri,
+                .uri_len = strlen(op->uri)
+            };
+            n++;
+        }
+        link->senders++;
+        client->outstanding += n;
+        pthread_mutex_unlock(&client->lock);
+        
+        pthread_mutex_lock(&link->send_lock);
+        int ret = objm_client_send_requests(link->conn, reqs, n);
+        pthread_mutex_unlock(&link->send_lock);
+        
+        /* A failed write breaks the session; its reader fails the batch */
+        if (ret < 0) shutdown(objm_get_fd(link->conn), SHUT_RDWR);
+        
+        pthread_mutex_lock(&client->lock);
+        link->senders--;
+        pthread_cond_broadcast(&client->changed);
+        pthread_mutex_unlock(&client->lock);
+        
+        submitted += n;
+    }
+    
+    return submitted;
+}
+
+size_t objm_async_reap(objm_async_t *client, objm_async_result_t *results, size_t max,
+                       int timeout_ms) {
+    if (!client || !results || max == 0) return 0;
+    
+    struct timespec deadline;
+    if (timeout_ms > 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+    
+    pthread_mutex_lock(&client->lock);
+    while (!client->queue_head && timeout_ms != 0) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&client->completed, &client->lock);
+        } else if (pthread_cond_timedwait(&client->completed, &client->lock,
+                                          &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    
+    size_t n = 0;
+    while (n < max && client->queue_head) {
+        async_completion_t *c = client->queue_head;
+        client->queue_head = c->next;
+        if (!client->queue_head) client->queue_tail = NULL;
+        results[n++] = c->result;
+        free(c);
+    }
+    pthread_mutex_unlock(&client->lock);
+    
+    return n;
+}
+
+void objm_async_drain(objm_async_t *client) {
+    if (!client) return;
+    
+    pthread_mutex_lock(&client->lock);
+    while (client->outstanding > 0) pthread_cond_wait(&client->changed, &client->lock);
+    pthread_mutex_unlock(&client->lock);
+}
+
+size_t objm_async_outstanding(objm_async_t *client) {
+    if (!client) return 0;
+    
+    pthread_mutex_lock(&client->lock);
+    size_t n = client->outstanding;
+    pthread_mutex_unlock(&client->lock);
+    return n;
+}
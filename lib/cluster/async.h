@@ -0,0 +1,136 @@
+/**
+ * @file async.h
+ * @brief Asynchronous, pooled client for one objmapper server
+ *
+ * The blocking client API costs a round trip per request and a connection
+ * per caller. This client keeps a small pool of V2 sessions instead and
+ * keeps many requests in flight on each:
+ * - Requests are submitted in batches; a batch that goes to one connection
+ *   is written with a single sendmsg() (objm_client_send_requests())
+ * - Each connection asks for pipelining and out-of-order replies and uses
+ *   whatever depth the server grants; replies are matched by request ID
+ * - A reader thread per connection receives replies and completes them
+ *   through a callback, or through a completion queue drained with
+ *   objm_async_reap()
+ * - A connection that breaks fails its outstanding requests and is
+ *   reconnected by the next submission
+ */
+
+#ifndef CLUSTER_ASYNC_H
+#define CLUSTER_ASYNC_H
+
+#include "../protocol/protocol.h"
+#include "../transport/transport.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defaults (objm_async_config_t fields left 0) */
+#define OBJM_ASYNC_CONNECTIONS  4        /* Sessions in the pool */
+#define OBJM_ASYNC_DEPTH        128      /* Requests in flight per session asked for */
+
+typedef struct objm_async objm_async_t;
+
+/**
+ * Client settings
+ */
+typedef struct {
+    transport_config_t transport;    /* TRANSPORT_UNIX or TRANSPORT_TCP */
+    size_t connections;              /* Pool size */
+    unsigned depth;                  /* Pipeline depth asked for (server may cap) */
+    char mode;                       /* Transfer mode (0 = FDPASS on Unix, COPY on TCP) */
+} objm_async_config_t;
+
+/**
+ * A request to submit
+ */
+typedef struct objm_async_op objm_async_op_t;
+
+/**
+ * A completed request
+ *
+ * resp is the server's reply and belongs to whoever receives the result
+ * (free it with objm_response_free()). Streamed GET bodies are spooled
+ * into a memfd: resp->fd holds the body and resp->content_len its size,
+ * as if the object had been passed.
+ */
+typedef struct {
+    void *arg;                       /* From the op */
+    uint8_t op;                      /* OBJM_OP_* */
+    int error;                       /* 0, or errno of the broken connection */
+    objm_response_t *resp;           /* Reply, NULL if error is set */
+} objm_async_result_t;
+
+/**
+ * Completion callback
+ *
+ * Runs on a connection's reader thread: replies behind it wait until it
+ * returns, so hand slow work elsewhere. It may submit more requests unless
+ * the client is full, which would wait for this very thread.
+ */
+typedef void (*objm_async_cb_t)(const objm_async_result_t *result);
+
+struct objm_async_op {
+    uint8_t op;                      /* GET, PUT (FD pass only), DELETE or STAT */
+    uint8_t flags;                   /* OBJM_REQ_ORDERED / OBJM_REQ_PRIORITY */
+    const char *uri;                 /* Copied into the request before submit returns */
+    objm_async_cb_t cb;              /* NULL = deliver to the completion queue */
+    void *arg;
+};
+
+/**
+ * Create a client (connections are opened when first needed)
+ *
+ * @param config Settings
+ * @return Client, or NULL on error
+ */
+objm_async_t *objm_async_create(const objm_async_config_t *config);
+
+/**
+ * Complete every outstanding request, then close the pool
+ *
+ * @param client Client
+ */
+void objm_async_destroy(objm_async_t *client);
+
+/**
+ * Submit requests
+ *
+ * Requests are spread over the pool's connections; the share that goes to
+ * one connection is written at once. When every connection is full this
+ * waits for replies to make room.
+ *
+ * @param client Client
+ * @param ops Requests
+ * @param count Number of requests
+ * @return Number of requests submitted (each completes exactly once); less
+ *         than count, with errno set, if the server cannot be reached or an
+ *         op is invalid (EINVAL: unknown op, PUT without FD passing)
+ */
+size_t objm_async_submit(objm_async_t *client, const objm_async_op_t *ops, size_t count);
+
+/**
+ * Take results from the completion queue
+ *
+ * @param client Client
+ * @param results Output array
+ * @param max Capacity of results
+ * @param timeout_ms Wait for at least one result (-1 = forever, 0 = poll)
+ * @return Number of results stored
+ */
+size_t objm_async_reap(objm_async_t *client, objm_async_result_t *results, size_t max,
+                       int timeout_ms);
+
+/**
+ * Wait until no request is outstanding
+ *
+ * @param client Client
+ */
+void objm_async_drain(objm_async_t *client);
+
+/**
+ * @param client Client
+ * @return Requests submitted and not yet completed
+ */
+size_t objm_async_outstanding(objm_async_t *client);
+
+#endif /* CLUSTER_ASYNC_H */
@@ -0,0 +1,732 @@
+/**
+ * @file cluster.c
+ * @brief Client-side routing across several objmapper servers
+ */
+
+#define _GNU_SOURCE
+#include "cluster.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+/* ============================================================================
+ * Internal Structures
+ * ============================================================================ */
+
+/* A connected, handshaken V2 session */
+struct objm_cluster_link {
+    transport_t *transport;
+    objm_connection_t *conn;
+    objm_cluster_link_t *next;       /* Pool free list */
+};
+
+typedef struct {
+    char name[OBJM_CLUSTER_NAME_MAX];
+    uint32_t weight;
+    uint64_t seed;                   /* Hash of the name */
+    transport_config_t transport;    /* Strings point at addr */
+    char addr[OBJM_CLUSTER_NAME_MAX];
+    bool local;
+    
+    /* Connection pool (lock) */
+    pthread_mutex_t lock;
+    objm_cluster_link_t *idle;
+    size_t num_idle;
+    
+    /* Health */
+    atomic_uint failures;            /* Consecutive */
+    atomic_uint ejections;           /* Since the last success */
+    atomic_uint_fast64_t ejected_until_us;
+} cluster_node_t;
+
+struct objm_cluster {
+    objm_cluster_config_t config;
+    cluster_node_t *nodes[OBJM_CLUSTER_MAX_NODES];
+    size_t num_nodes;
+};
+
+/* ============================================================================
+ * Helpers
+ * ============================================================================ */
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/* 64-bit finalizer (splitmix64): spreads every input bit over the word */
+static uint64_t hash_mix(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+/* FNV-1a over a string; every client computes the same value */
+static uint64_t hash_string(const char *s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (; *s; s++) {
+        h ^= (uint8_t)*s;
+        h *= 0x100000001b3ULL;
+    }
+    return hash_mix(h);
+}
+
+/**
+ * Weighted rendezvous score of a key on a node
+ *
+ * weight / -ln(u) with u uniform in (0, 1): the node with the highest
+ * score wins, and each node wins a share of the keys proportional to its
+ * weight (Schindelhauer & Schomaker's logarithmic method).
+ */
+static double node_score(const cluster_node_t *node, uint64_t key_hash) {
+    uint64_t h = hash_mix(key_hash ^ node->seed);
+    double u = ((double)(h >> 11) + 0.5) * (1.0 / 9007199254740992.0);  /* 2^53 */
+    return node->weight / -log(u);
+}
+
+static bool node_ejected(cluster_node_t *node, uint64_t now) {
+    return now < atomic_load_explicit(&node->ejected_until_us, memory_order_relaxed);
+}
+
+static void link_close(objm_cluster_link_t *link, bool graceful) {
+    if (!link) return;
+    if (graceful) objm_client_close(link->conn, OBJM_CLOSE_NORMAL);
+    objm_client_destroy(link->conn);
+    transport_close(link->transport);
+    free(link);
+}
+
+/* Close every pooled connection of a node */
+static void node_drain_pool(cluster_node_t *node) {
+    pthread_mutex_lock(&node->lock);
+    objm_cluster_link_t *link = node->idle;
+    node->idle = NULL;
+    node->num_idle = 0;
+    pthread_mutex_unlock(&node->lock);
+    
+    while (link) {
+        objm_cluster_link_t *next = link->next;
+        link_close(link, false);
+        link = next;
+    }
+}
+
+/* ============================================================================
+ * Health
+ * ============================================================================ */
+
+static void node_succeeded(cluster_node_t *node) {
+    if (atomic_load_explicit(&node->failures, memory_order_relaxed) != 0) {
+        atomic_store_explicit(&node->failures, 0, memory_order_relaxed);
+    }
+    if (atomic_load_explicit(&node->ejections, memory_order_relaxed) != 0) {
+        atomic_store_explicit(&node->ejections, 0, memory_order_relaxed);
+    }
+}
+
+/**
+ * Count a failure; the threshold ejects the node
+ *
+ * An ejected node returns after its backoff with one failure of credit
+ * left, so a still-dead node is ejected again (for twice as long) by the
+ * first request that probes it.
+ */
+static void node_failed(objm_cluster_t *cluster, cluster_node_t *node) {
+    unsigned threshold = cluster->config.eject_failures;
+    unsigned failures = atomic_fetch_add(&node->failures, 1) + 1;
+    if (failures < threshold) return;
+    
+    uint64_t now = now_us();
+    if (node_ejected(node, now)) return;  /* Racing failure, already out */
+    
+    unsigned ejections = atomic_fetch_add(&node->ejections, 1);
+    uint64_t backoff = cluster->config.eject_base_us;
+    for (unsigned i = 0; i < ejections && backoff < cluster->config.eject_max_us; i++) {
+        backoff *= 2;
+    }
+    if (backoff > cluster->config.eject_max_us) backoff = cluster->config.eject_max_us;
+    
+    atomic_store(&node->failures, threshold > 0 ? threshold - 1 : 0);
+    atomic_store(&node->ejected_until_us, now + backoff);
+    
+    /* Whatever broke the node broke its idle connections too */
+    node_drain_pool(node);
+}
+
+/* ============================================================================
+ * Membership
+ * ============================================================================ */
+
+objm_cluster_t *objm_cluster_create(const objm_cluster_config_t *config) {
+    objm_cluster_t *cluster = calloc(1, sizeof(*cluster));
+    if (!cluster) return NULL;
+    
+    if (config) cluster->config = *config;
+    objm_cluster_config_t *c = &cluster->config;
+    if (c->pool_size == 0) c->pool_size = OBJM_CLUSTER_POOL_SIZE;
+    if (c->remote_mode != OBJM_MODE_SPLICE) c->remote_mode = OBJM_MODE_COPY;
+    if (c->eject_failures == 0) c->eject_failures = OBJM_CLUSTER_EJECT_FAILURES;
+    if (c->eject_base_us == 0) c->eject_base_us = OBJM_CLUSTER_EJECT_BASE_US;
+    if (c->eject_max_us < c->eject_base_us) {
+        c->eject_max_us = c->eject_base_us > OBJM_CLUSTER_EJECT_MAX_US ?
+                          c->eject_base_us : OBJM_CLUSTER_EJECT_MAX_US;
+    }
+    
+    return cluster;
+}
+
+int objm_cluster_add_node(objm_cluster_t *cluster, const objm_cluster_node_config_t *config) {
+    if (!cluster || !config || cluster->num_nodes >= OBJM_CLUSTER_MAX_NODES) return -1;
+    
+    cluster_node_t *node = calloc(1, sizeof(*node));
+    if (!node) return -1;
+    
+    /* The address is copied: the caller's strings need not outlive us */
+    node->transport = config->transport;
+    int n;
+    switch (config->transport.type) {
+    case TRANSPORT_UNIX:
+        n = snprintf(node->addr, sizeof(node->addr), "%s",
+                     config->transport.unix_cfg.path ? config->transport.unix_cfg.path : "");
+        node->transport.unix_cfg.path = node->addr;
+        node->local = true;
+        break;
+    case TRANSPORT_TCP:
+        n = snprintf(node->addr, sizeof(node->addr), "%s",
+                     config->transport.tcp_cfg.host ? config->transport.tcp_cfg.host : "");
+        node->transport.tcp_cfg.host = node->addr;
+        break;
+    default:
+        n = -1;  /* Datagrams cannot carry a stream protocol */
+        break;
+    }
+    if (n <= 0 || (size_t)n >= sizeof(node->addr)) {
+        free(node);
+        return -1;
+    }
+    
+    if (config->name) {
+        n = snprintf(node->name, sizeof(node->name), "%s", config->name);
+    } else if (node->local) {
+        n = snprintf(node->name, sizeof(node->name), "unix:%s", node->addr);
+    } else {
+        n = snprintf(node->name, sizeof(node->name), "tcp:%s:%u", node->addr,
+                     (unsigned)config->transport.tcp_cfg.port);
+    }
+    if (n <= 0 || (size_t)n >= sizeof(node->name)) {
+        free(node);
+        return -1;
+    }
+    
+    /* Same name twice would split the node's keys between two entries */
+    for (size_t i = 0; i < cluster->num_nodes; i++) {
+        if (strcmp(cluster->nodes[i]->name, node->name) == 0) {
+            free(node);
+            return -1;
+        }
+    }
+    
+    node->weight = config->weight ? config->weight : 1;
+    node->seed = hash_string(node->name);
+    pthread_mutex_init(&node->lock, NULL);
+    
+    cluster->nodes[cluster->num_nodes] = node;
+    return (int)cluster->num_nodes++;
+}
+
+int objm_cluster_add_node_spec(objm_cluster_t *cluster, const char *spec) {
+    if (!cluster || !spec) return -1;
+    
+    char buf[OBJM_CLUSTER_NAME_MAX * 2];
+    if (snprintf(buf, sizeof(buf), "%s", spec) >= (int)sizeof(buf)) return -1;
+    
+    objm_cluster_node_config_t config = { .weight = 1 };
+    char *addr = buf;
+    
+    /* [name=] */
+    char *eq = strchr(buf, '=');
+    if (eq) {
+        *eq = '\0';
+        config.name = buf;
+        addr = eq + 1;
+    }
+    
+    /* [@weight] */
+    char *at = strrchr(addr, '@');
+    if (at) {
+        char *end;
+        unsigned long weight = strtoul(at + 1, &end, 10);
+        if (*end != '\0' || weight == 0 || weight > UINT32_MAX) return -1;
+        config.weight = (uint32_t)weight;
+        *at = '\0';
+    }
+    
+    if (strncmp(addr, "unix:", 5) == 0) {
+        config.transport.type = TRANSPORT_UNIX;
+        config.transport.unix_cfg.path = addr + 5;
+    } else if (strncmp(addr, "tcp:", 4) == 0) {
+        char *colon = strrchr(addr + 4, ':');
+        if (!colon) return -1;
+        char *end;
+        unsigned long port = strtoul(colon + 1, &end, 10);
+        if (*end != '\0' || port == 0 || port > 65535) return -1;
+        *colon = '\0';
+        config.transport.type = TRANSPORT_TCP;
+        config.transport.tcp_cfg.host = addr + 4;
+        config.transport.tcp_cfg.port = (uint16_t)port;
+    } else {
+        return -1;
+    }
+    
+    return objm_cluster_add_node(cluster, &config);
+}
+
+void objm_cluster_destroy(objm_cluster_t *cluster) {
+    if (!cluster) return;
+    
+    for (size_t i = 0; i < cluster->num_nodes; i++) {
+        cluster_node_t *node = cluster->nodes[i];
+        objm_cluster_link_t *link = node->idle;
+        while (link) {
+            objm_cluster_link_t *next = link->next;
+            link_close(link, true);
+            link = next;
+        }
+        pthread_mutex_destroy(&node->lock);
+        free(node);
+    }
+    
+    free(cluster);
+}
+
+size_t objm_cluster_num_nodes(const objm_cluster_t *cluster) {
+    return cluster ? cluster->num_nodes : 0;
+}
+
+int objm_cluster_node_status(objm_cluster_t *cluster, int node_id,
+                             objm_cluster_node_status_t *status) {
+    if (!cluster || !status || node_id < 0 || (size_t)node_id >= cluster->num_nodes) {
+        return -1;
+    }
+    
+    cluster_node_t *node = cluster->nodes[node_id];
+    status->name = node->name;
+    status->weight = node->weight;
+    status->local = node->local;
+    status->ejected = node_ejected(node, now_us());
+    status->failures = atomic_load(&node->failures);
+    status->ejections = atomic_load(&node->ejections);
+    
+    pthread_mutex_lock(&node->lock);
+    status->idle = node->num_idle;
+    pthread_mutex_unlock(&node->lock);
+    
+    return 0;
+}
+
+/* ============================================================================
+ * Routing
+ * ============================================================================ */
+
+int objm_cluster_route(objm_cluster_t *cluster, const char *uri) {
+    if (!cluster || !uri || cluster->num_nodes == 0) return -1;
+    
+    uint64_t key = hash_string(uri);
+    uint64_t now = now_us();
+    int best = -1, best_any = -1;
+    double best_score = -1.0, best_any_score = -1.0;
+    
+    for (size_t i = 0; i < cluster->num_nodes; i++) {
+        cluster_node_t *node = cluster->nodes[i];
+        double score = node_score(node, key);
+        
+        if (score > best_any_score) {
+            best_any_score = score;
+            best_any = (int)i;
+        }
+        if (score > best_score && !node_ejected(node, now)) {
+            best_score = score;
+            best = (int)i;
+        }
+    }
+    
+    return best >= 0 ? best : best_any;
+}
+
+/* Connect and handshake a new session */
+static objm_cluster_link_t *link_open(cluster_node_t *node) {
+    objm_cluster_link_t *link = calloc(1, sizeof(*link));
+    if (!link) return NULL;
+    
+    link->transport = transport_client_connect(&node->transport);
+    if (!link->transport) goto fail;
+    
+    int fd = transport_get_fd(link->transport);
+    if (!node->local) {
+        /* Requests are small writes followed by a wait for the reply */
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    
+    link->conn = objm_client_create(fd, OBJM_PROTO_V2);
+    if (!link->conn) goto fail;
+    
+    /* Local nodes move requests and replies through a shared-memory ring */
+    objm_hello_t hello = {
+        .capabilities = OBJM_CAP_BATCH | (node->local ? OBJM_CAP_SHM_RING : 0),
+        .max_pipeline = 1,
+        .backend_parallelism = 1
+    };
+    if (objm_client_hello(link->conn, &hello, NULL) < 0) goto fail;
+    
+    return link;
+    
+fail:
+    {
+        int saved = errno;
+        if (link->conn) objm_client_destroy(link->conn);
+        transport_close(link->transport);
+        free(link);
+        errno = saved ? saved : ECONNREFUSED;
+    }
+    return NULL;
+}
+
+/* Lease a connection to one node, pooled if allowed */
+static int node_acquire(objm_cluster_t *cluster, int node_id, bool allow_pooled,
+                        objm_cluster_lease_t *lease) {
+    cluster_node_t *node = cluster->nodes[node_id];
+    objm_cluster_link_t *link = NULL;
+    bool reused = false;
+    
+    if (allow_pooled) {
+        pthread_mutex_lock(&node->lock);
+        link = node->idle;
+        if (link) {
+            node->idle = link->next;
+            node->num_idle--;
+        }
+        pthread_mutex_unlock(&node->lock);
+        reused = (link != NULL);
+    }
+    
+    if (!link) {
+        link = link_open(node);
+        if (!link) {
+            node_failed(cluster, node);
+            return -1;
+        }
+    }
+    
+    link->next = NULL;
+    lease->conn = link->conn;
+    lease->node = node_id;
+    lease->mode = node->local ? OBJM_MODE_FDPASS : cluster->config.remote_mode;
+    lease->reused = reused;
+    lease->link = link;
+    return 0;
+}
+
+int objm_cluster_acquire(objm_cluster_t *cluster, const char *uri,
+                         objm_cluster_lease_t *lease) {
+    if (!lease) return -1;
+    memset(lease, 0, sizeof(*lease));
+    lease->node = -1;
+    
+    int node_id = objm_cluster_route(cluster, uri);
+    if (node_id < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    
+    return node_acquire(cluster, node_id, true, lease);
+}
+
+void objm_cluster_release(objm_cluster_t *cluster, objm_cluster_lease_t *lease,
+                          bool failed) {
+    if (!cluster || !lease || !lease->link) return;
+    
+    cluster_node_t *node = cluster->nodes[lease->node];
+    objm_cluster_link_t *link = lease->link;
+    lease->link = NULL;
+    lease->conn = NULL;
+    
+    if (failed) {
+        link_close(link, false);
+        /* A pooled connection may simply have idled out on the server */
+        if (!lease->reused) node_failed(cluster, node);
+        return;
+    }
+    
+    node_succeeded(node);
+    
+    pthread_mutex_lock(&node->lock);
+    if (node->num_idle < cluster->config.pool_size) {
+        link->next = node->idle;
+        node->idle = link;
+        node->num_idle++;
+        link = NULL;
+    }
+    pthread_mutex_unlock(&node->lock);
+    
+    link_close(link, true);  /* Pool full */
+}
+
+/* ============================================================================
+ * Object Operations
+ * ============================================================================ */
+
+/* Outcome of one attempt: the connection broke, or the server answered */
+typedef enum {
+    OP_DONE,                         /* Success */
+    OP_REFUSED,                      /* Server error reply (errno set) */
+    OP_BROKEN,                       /* Transport failure */
+} op_result_t;
+
+typedef op_result_t (*cluster_op_fn)(objm_cluster_lease_t *lease, const char *uri,
+                                     void *arg);
+
+static void set_status_errno(uint8_t status) {
+    errno = (status == OBJM_STATUS_NOT_FOUND) ? ENOENT : EIO;
+}
+
+/* Send a request and receive its response */
+static op_result_t op_exchange(objm_cluster_lease_t *lease, objm_request_t *req,
+                               objm_response_t **resp) {
+    *resp = NULL;
+    if (objm_client_send_request(lease->conn, req) < 0 ||
+        objm_client_recv_response(lease->conn, resp) < 0) {
+        if (errno == 0) errno = EPIPE;
+        return OP_BROKEN;
+    }
+    if ((*resp)->status != OBJM_STATUS_OK) {
+        set_status_errno((*resp)->status);
+        objm_response_free(*resp);
+        *resp = NULL;
+        return OP_REFUSED;
+    }
+    return OP_DONE;
+}
+
+/**
+ * Run an operation on the URI's node
+ *
+ * A pooled connection that breaks is retried once on a fresh connection
+ * to the same node; ejection is left to failures of fresh connections.
+ */
+static int cluster_run(objm_cluster_t *cluster, const char *uri, cluster_op_fn fn,
+                       void *arg) {
+    if (!cluster || !uri) {
+        errno = EINVAL;
+        return -1;
+    }
+    
+    objm_cluster_lease_t lease;
+    if (objm_cluster_acquire(cluster, uri, &lease) < 0) return -1;
+    
+    for (;;) {
+        op_result_t result = fn(&lease, uri, arg);
+        int saved = errno;
+        bool retry = (result == OP_BROKEN && lease.reused);
+        int node_id = lease.node;
+        
+        objm_cluster_release(cluster, &lease, result == OP_BROKEN);
+        if (result == OP_DONE) return 0;
+        if (!retry || node_acquire(cluster, node_id, false, &lease) < 0) {
+            errno = saved;
+            return -1;
+        }
+    }
+}
+
+static op_result_t op_get(objm_cluster_lease_t *lease, const char *uri, void *arg) {
+    int *fd_out = arg;
+    objm_request_t req = {
+        .op = OBJM_OP_GET,
+        .mode = lease->mode,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri)
+    };
+    
+    objm_response_t *resp;
+    op_result_t result = op_exchange(lease, &req, &resp);
+    if (result != OP_DONE) return result;
+    
+    if (lease->mode == OBJM_MODE_FDPASS) {
+        *fd_out = resp->fd;
+        resp->fd = -1;
+        objm_response_free(resp);
+        if (*fd_out < 0) {
+            errno = EIO;
+            return OP_BROKEN;  /* The reply lost its descriptor */
+        }
+        return OP_DONE;
+    }
+    
+    bool chunked = (resp->content_len == OBJM_CONTENT_CHUNKED);
+    objm_response_free(resp);
+    if (!chunked) {
+        errno = EPROTO;
+        return OP_BROKEN;
+    }
+    
+    /* Spool the body: the caller gets an FD, as from a local node. The
+     * body has to be consumed even if the memfd cannot be created. */
+    int fd = memfd_create("objmapper-get", MFD_CLOEXEC);
+    int ret = objm_recv_body(lease->conn, fd, lease->mode, NULL);
+    if (ret < 0) {
+        if (fd >= 0) close(fd);
+        if (errno == 0) errno = EPIPE;
+        return OP_BROKEN;
+    }
+    if (fd < 0) {
+        errno = ENOMEM;
+        return OP_REFUSED;
+    }
+    
+    *fd_out = fd;
+    return OP_DONE;
+}
+
+int objm_cluster_get(objm_cluster_t *cluster, const char *uri, int *fd_out) {
+    if (!fd_out) {
+        errno = EINVAL;
+        return -1;
+    }
+    *fd_out = -1;
+    return cluster_run(cluster, uri, op_get, fd_out);
+}
+
+typedef struct {
+    int src_fd;
+    uint64_t written;
+} put_args_t;
+
+/* Local PUT: the server passes a writer FD, the data goes straight in */
+static op_result_t op_put_fdpass(objm_cluster_lease_t *lease, const char *uri,
+                                 put_args_t *args) {
+    objm_request_t req = {
+        .op = OBJM_OP_PUT,
+        .mode = OBJM_MODE_FDPASS,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri)
+    };
+    
+    objm_response_t *resp;
+    op_result_t result = op_exchange(lease, &req, &resp);
+    if (result != OP_DONE) return result;
+    
+    int dst_fd = resp->fd;
+    resp->fd = -1;
+    objm_response_free(resp);
+    if (dst_fd < 0) {
+        errno = EIO;
+        return OP_BROKEN;
+    }
+    
+    /* Whole file from offset 0, like a streamed body */
+    char buffer[64 * 1024];
+    off_t off = 0;
+    ssize_t n;
+    while ((n = pread(args->src_fd, buffer, sizeof(buffer), off)) > 0) {
+        for (ssize_t done = 0; done < n; ) {
+            ssize_t m = pwrite(dst_fd, buffer + done, n - done, off + done);
+            if (m < 0) {
+                if (errno == EINTR) continue;
+                close(dst_fd);
+                return OP_REFUSED;
+            }
+            done += m;
+        }
+        off += n;
+    }
+    close(dst_fd);
+    if (n < 0) return OP_REFUSED;
+    
+    args->written = off;
+    return OP_DONE;
+}
+
+/* Remote PUT: the file follows the request as a chunked body */
+static op_result_t op_put_stream(objm_cluster_lease_t *lease, const char *uri,
+                                 put_args_t *args) {
+    objm_request_t req = {
+        .op = OBJM_OP_PUT,
+        .flags = OBJM_REQ_BODY,
+        .mode = lease->mode,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri)
+    };
+    
+    if (objm_client_send_request(lease->conn, &req) < 0 ||
+        objm_send_body(lease->conn, args->src_fd, lease->mode, &args->written) < 0) {
+        if (errno == 0) errno = EPIPE;
+        return OP_BROKEN;
+    }
+    
+    objm_response_t *resp = NULL;
+    if (objm_client_recv_response(lease->conn, &resp) < 0) {
+        if (errno == 0) errno = EPIPE;
+        return OP_BROKEN;
+    }
+    if (resp->status != OBJM_STATUS_OK) {
+        set_status_errno(resp->status);
+        objm_response_free(resp);
+        return OP_REFUSED;
+    }
+    
+    /* The acknowledgement is an empty streamed body */
+    bool chunked = (resp->content_len == OBJM_CONTENT_CHUNKED);
+    objm_response_free(resp);
+    if (chunked && objm_recv_body(lease->conn, -1, lease->mode, NULL) < 0) {
+        if (errno == 0) errno = EPIPE;
+        return OP_BROKEN;
+    }
+    return OP_DONE;
+}
+
+static op_result_t op_put(objm_cluster_lease_t *lease, const char *uri, void *arg) {
+    return lease->mode == OBJM_MODE_FDPASS ? op_put_fdpass(lease, uri, arg)
+                                           : op_put_stream(lease, uri, arg);
+}
+
+int objm_cluster_put(objm_cluster_t *cluster, const char *uri, int src_fd,
+                     uint64_t *written) {
+    put_args_t args = { .src_fd = src_fd };
+    int ret = cluster_run(cluster, uri, op_put, &args);
+    if (ret == 0 && written) *written = args.written;
+    return ret;
+}
+
+static op_result_t op_delete(objm_cluster_lease_t *lease, const char *uri, void *arg) {
+    (void)arg;
+    objm_request_t req = {
+        .op = OBJM_OP_DELETE,
+        .mode = OBJM_MODE_FDPASS,
+        .uri = (char *)uri,
+        .uri_len = strlen(uri)
+    };
+    
+    objm_response_t *resp;
+    op_result_t result = op_exchange(lease, &req, &resp);
+    if (result == OP_DONE) objm_response_free(resp);
+    return result;
+}
+
+int objm_cluster_delete(objm_cluster_t *cluster, const char *uri) {
+    return cluster_run(cluster, uri, op_delete, NULL);
+}
@@ -0,0 +1,228 @@
+/**
+ * @file cluster.h
+ * @brief Client-side routing across several objmapper servers
+ *
+ * Spreads the URI space over a set of nodes without a proxy hop:
+ * - Weighted rendezvous (highest random weight) hashing: every client that
+ *   knows the same node names and weights picks the same node for a URI,
+ *   and adding or ejecting a node only moves the keys it wins or owned
+ * - A pool of established V2 connections per node
+ * - Health tracking: nodes that keep failing are ejected for an
+ *   exponentially growing backoff, then probed by live traffic again
+ * - Unix socket nodes (the local server) pass FDs; TCP nodes stream
+ *   bodies with COPY or SPLICE
+ */
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include "../protocol/protocol.h"
+#include "../transport/transport.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Limits */
+#define OBJM_CLUSTER_MAX_NODES       64
+#define OBJM_CLUSTER_NAME_MAX        128
+
+/* Defaults (objm_cluster_config_t fields left 0) */
+#define OBJM_CLUSTER_POOL_SIZE       8        /* Idle connections kept per node */
+#define OBJM_CLUSTER_EJECT_FAILURES  3        /* Consecutive failures to eject */
+#define OBJM_CLUSTER_EJECT_BASE_US   (500 * 1000ULL)       /* First ejection */
+#define OBJM_CLUSTER_EJECT_MAX_US    (30 * 1000 * 1000ULL) /* Backoff cap */
+
+typedef struct objm_cluster objm_cluster_t;
+typedef struct objm_cluster_link objm_cluster_link_t;
+
+/**
+ * Cluster-wide settings
+ */
+typedef struct {
+    size_t pool_size;                /* Idle connections kept per node */
+    char remote_mode;                /* TCP transfer mode: OBJM_MODE_COPY/SPLICE */
+    unsigned eject_failures;         /* Consecutive failures before ejection */
+    uint64_t eject_base_us;          /* First ejection period */
+    uint64_t eject_max_us;           /* Longest ejection period */
+} objm_cluster_config_t;
+
+/**
+ * One server
+ */
+typedef struct {
+    const char *name;                /* Identity on the ring (NULL = address) */
+    uint32_t weight;                 /* Relative share of the keys (0 = 1) */
+    transport_config_t transport;    /* TRANSPORT_UNIX or TRANSPORT_TCP */
+} objm_cluster_node_config_t;
+
+/**
+ * Node health snapshot
+ */
+typedef struct {
+    const char *name;
+    uint32_t weight;
+    bool local;                      /* Unix socket: FD passing */
+    bool ejected;                    /* Skipped by routing right now */
+    unsigned failures;               /* Consecutive failures */
+    unsigned ejections;              /* Ejections since the last success */
+    size_t idle;                     /* Pooled connections */
+} objm_cluster_node_status_t;
+
+/**
+ * An exclusively held connection to the node that owns a URI
+ */
+typedef struct {
+    objm_connection_t *conn;         /* V2 connection, handshake done */
+    int node;                        /* Node index */
+    char mode;                       /* Transfer mode for this node */
+    bool reused;                     /* Came from the pool (may be stale) */
+    objm_cluster_link_t *link;       /* Private */
+} objm_cluster_lease_t;
+
+/* ============================================================================
+ * Membership
+ * ============================================================================ */
+
+/**
+ * Create an empty cluster
+ *
+ * @param config Settings (NULL = defaults)
+ * @return Cluster handle, or NULL on error
+ */
+objm_cluster_t *objm_cluster_create(const objm_cluster_config_t *config);
+
+/**
+ * Add a node
+ *
+ * Nodes are added before the cluster is shared between threads. Clients
+ * agree on placement when they use the same names and weights; the
+ * transport may differ (the local server is reached over its Unix socket,
+ * the same node over TCP from elsewhere).
+ *
+ * @param cluster Cluster handle
+ * @param node Node configuration (strings are copied)
+ * @return Node index, or -1 on error
+ */
+int objm_cluster_add_node(objm_cluster_t *cluster, const objm_cluster_node_config_t *node);
+
+/**
+ * Add a node from a spec string
+ *
+ * [name=]unix:/path/to/socket[@weight] or [name=]tcp:host:port[@weight]
+ *
+ * @param cluster Cluster handle
+ * @param spec Node spec
+ * @return Node index, or -1 on error
+ */
+int objm_cluster_add_node_spec(objm_cluster_t *cluster, const char *spec);
+
+/**
+ * Close every pooled connection and free the cluster
+ *
+ * @param cluster Cluster handle
+ */
+void objm_cluster_destroy(objm_cluster_t *cluster);
+
+/**
+ * @param cluster Cluster handle
+ * @return Number of nodes
+ */
+size_t objm_cluster_num_nodes(const objm_cluster_t *cluster);
+
+/**
+ * Get a node's health
+ *
+ * @param cluster Cluster handle
+ * @param node Node index
+ * @param status Output snapshot
+ * @return 0 on success, -1 on error
+ */
+int objm_cluster_node_status(objm_cluster_t *cluster, int node,
+                             objm_cluster_node_status_t *status);
+
+/* ============================================================================
+ * Routing
+ * ============================================================================ */
+
+/**
+ * Pick the node that owns a URI
+ *
+ * The healthy node with the highest weighted score. If every node is
+ * ejected the best node overall is returned, so requests keep probing.
+ *
+ * @param cluster Cluster handle
+ * @param uri Object URI
+ * @return Node index, or -1 if the cluster is empty
+ */
+int objm_cluster_route(objm_cluster_t *cluster, const char *uri);
+
+/**
+ * Borrow a connection to the node that owns a URI
+ *
+ * A pooled connection is reused when there is one, otherwise a new one is
+ * connected and handshaken. A connect failure counts against the node.
+ *
+ * @param cluster Cluster handle
+ * @param uri Object URI
+ * @param lease Output lease
+ * @return 0 on success, -1 on error
+ */
+int objm_cluster_acquire(objm_cluster_t *cluster, const char *uri,
+                         objm_cluster_lease_t *lease);
+
+/**
+ * Return a borrowed connection
+ *
+ * @param cluster Cluster handle
+ * @param lease Lease from objm_cluster_acquire()
+ * @param failed The connection broke (it is closed and counts against the
+ *               node); error replies from a healthy server are not failures
+ */
+void objm_cluster_release(objm_cluster_t *cluster, objm_cluster_lease_t *lease,
+                          bool failed);
+
+/* ============================================================================
+ * Object Operations
+ * ============================================================================
+ *
+ * Return 0 on success or -1 with errno set: ENOENT for a missing object,
+ * EIO for other server errors, the transport's errno for broken nodes.
+ * A request that fails on a pooled connection is retried once on a fresh
+ * one, since the server may have closed it while idle. Writes to a dead
+ * node raise SIGPIPE: callers ignore it (signal(SIGPIPE, SIG_IGN)).
+ */
+
+/**
+ * Open an object for reading
+ *
+ * Local nodes pass the object's FD. Remote objects are streamed into a
+ * memfd, so the caller gets a readable FD either way.
+ *
+ * @param cluster Cluster handle
+ * @param uri Object URI
+ * @param fd_out Output FD (caller closes; read with pread())
+ * @return 0 on success, -1 on error
+ */
+int objm_cluster_get(objm_cluster_t *cluster, const char *uri, int *fd_out);
+
+/**
+ * Store an object
+ *
+ * @param cluster Cluster handle
+ * @param uri Object URI
+ * @param src_fd Regular file, stored whole from offset 0
+ * @param written Output byte count (can be NULL)
+ * @return 0 on success, -1 on error
+ */
+int objm_cluster_put(objm_cluster_t *cluster, const char *uri, int src_fd,
+                     uint64_t *written);
+
+/**
+ * Delete an object
+ *
+ * @param cluster Cluster handle
+ * @param uri Object URI
+ * @return 0 on success, -1 on error
+ */
+int objm_cluster_delete(objm_cluster_t *cluster, const char *uri);
+
+#endif /* CLUSTER_H */
@@ -0,0 +1,827 @@
+/**
+ * @file test_cluster.c
+ * @brief Test suite for the cluster client
+ */
+
+#define _GNU_SOURCE
+#include "cluster.h"
+#include "async.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define TEST_SOCKET    "/tmp/objmapper_test_cluster.sock"
+#define DEAD_SOCKET    "/tmp/objmapper_test_cluster_dead.sock"
+#define ASYNC_SOCKET   "/tmp/objmapper_test_cluster_async.sock"
+#define RING_SOCKET    "/tmp/objmapper_test_cluster_ring.sock"
+#define TEST_KEYS      20000
+#define STORE_SLOTS    16
+
+/* ============================================================================
+ * Minimal server: one in-memory store per listener
+ * ============================================================================ */
+
+typedef struct {
+    pthread_mutex_t lock;
+    char uris[STORE_SLOTS][64];
+    int fds[STORE_SLOTS];            /* memfds, -1 = free */
+    atomic_int requests;
+    atomic_bool drop_after_request;  /* Close the connection (stale pool) */
+    atomic_int connections;
+    bool tcp;
+    int listen_fd;
+    
+    /* Set before the first client connects */
+    uint16_t pipeline;               /* Depth granted (0 = 1, no pipelining) */
+    bool ooo;                        /* Serve each request on its own thread */
+    bool ring;                       /* Offer the shared-memory ring */
+    atomic_int ring_sessions;        /* Connections that negotiated it */
+} test_store_t;
+
+typedef struct {
+    test_store_t *store;
+    int fd;
+    atomic_int workers;              /* OOO requests still being served */
+} test_conn_t;
+
+static int store_find(test_store_t *store, const char *uri) {
+    for (int i = 0; i < STORE_SLOTS; i++) {
+        if (store->fds[i] >= 0 && strcmp(store->uris[i], uri) == 0) return i;
+    }
+    return -1;
+}
+
+/* Replace (or add) an object; takes ownership of fd */
+static void store_set(test_store_t *store, const char *uri, int fd) {
+    pthread_mutex_lock(&store->lock);
+    int slot = store_find(store, uri);
+    if (slot >= 0) {
+        close(store->fds[slot]);
+    } else {
+        for (slot = 0; store->fds[slot] >= 0; slot++) {}
+        snprintf(store->uris[slot], sizeof(store->uris[slot]), "%s", uri);
+    }
+    store->fds[slot] = fd;
+    pthread_mutex_unlock(&store->lock);
+}
+
+/* Duplicate of an object's FD, or -1 */
+static int store_get(test_store_t *store, const char *uri) {
+    pthread_mutex_lock(&store->lock);
+    int slot = store_find(store, uri);
+    int fd = slot >= 0 ? dup(store->fds[slot]) : -1;
+    pthread_mutex_unlock(&store->lock);
+    return fd;
+}
+
+static bool store_delete(test_store_t *store, const char *uri) {
+    pthread_mutex_lock(&store->lock);
+    int slot = store_find(store, uri);
+    if (slot >= 0) {
+        close(store->fds[slot]);
+        store->fds[slot] = -1;
+    }
+    pthread_mutex_unlock(&store->lock);
+    return slot >= 0;
+}
+
+static void serve_request(test_store_t *store, objm_connection_t *conn,
+                          const objm_request_t *req) {
+    objm_response_t resp = { .request_id = req->id, .status = OBJM_STATUS_OK, .fd = -1 };
+    
+    if (store->tcp && req->mode == OBJM_MODE_FDPASS && req->op != OBJM_OP_DELETE) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INVALID_MODE, "No FD passing");
+        return;
+    }
+    
+    switch (req->op) {
+    case OBJM_OP_GET: {
+        int fd = store_get(store, req->uri);
+        if (fd < 0) {
+            objm_server_send_error(conn, req->id, OBJM_STATUS_NOT_FOUND, "Not found");
+        } else if (req->mode == OBJM_MODE_FDPASS) {
+            resp.fd = fd;
+            objm_server_send_response(conn, &resp);
+        } else {
+            objm_server_send_stream(conn, req->id, fd, req->mode);
+        }
+        if (fd >= 0) close(fd);
+        break;
+    }
+    case OBJM_OP_PUT: {
+        int fd = memfd_create("test-object", MFD_CLOEXEC);
+        assert(fd >= 0);
+        if (req->flags & OBJM_REQ_BODY) {
+            assert(objm_recv_body(conn, fd, req->mode, NULL) == 0);
+            store_set(store, req->uri, fd);
+            objm_server_send_stream(conn, req->id, -1, req->mode);
+        } else {
+            resp.fd = fd;
+            objm_server_send_response(conn, &resp);
+            store_set(store, req->uri, fd);
+        }
+        break;
+    }
+    case OBJM_OP_DELETE:
+        if (store_delete(store, req->uri)) {
+            resp.content_len = OBJM_CONTENT_NONE;
+            objm_server_send_response(conn, &resp);
+        } else {
+            objm_server_send_error(conn, req->id, OBJM_STATUS_NOT_FOUND, "Not found");
+        }
+        break;
+    default:
+        objm_server_send_error(conn, req->id, OBJM_STATUS_UNSUPPORTED_OP, NULL);
+        break;
+    }
+}
+
+typedef struct {
+    test_conn_t *tc;
+    objm_connection_t *conn;
+    objm_request_t *req;
+} test_work_t;
+
+/* Out-of-order reply: a random delay reorders requests in flight together */
+static void *work_thread(void *arg) {
+    test_work_t *work = arg;
+    usleep(rand() % 2000);
+    serve_request(work->tc->store, work->conn, work->req);
+    objm_request_free(work->req);
+    atomic_fetch_sub(&work->tc->workers, 1);
+    free(work);
+    return NULL;
+}
+
+static void *conn_thread(void *arg) {
+    test_conn_t *tc = arg;
+    test_store_t *store = tc->store;
+    objm_connection_t *conn = objm_server_create(tc->fd);
+    objm_hello_t hello = { .capabilities = OBJM_CAP_BATCH, .max_pipeline = 1 };
+    if (store->pipeline > 1) {
+        hello.capabilities |= OBJM_CAP_PIPELINING | (store->ooo ? OBJM_CAP_OOO_REPLIES : 0);
+        hello.max_pipeline = store->pipeline;
+    }
+    if (store->ring) hello.capabilities |= OBJM_CAP_SHM_RING;
+    
+    atomic_fetch_add(&store->connections, 1);
+    if (conn && objm_server_handshake(conn, &hello, NULL) == 0) {
+        if (objm_has_capability(conn, OBJM_CAP_SHM_RING)) {
+            atomic_fetch_add(&store->ring_sessions, 1);
+        }
+        for (;;) {
+            objm_request_t *req = NULL;
+            int ret = objm_server_recv_request(conn, &req);
+            if (ret == 1) {
+                objm_server_send_close_ack(conn, 0);
+                break;
+            }
+            if (ret < 0) break;
+            
+            if (store->ooo && !(req->flags & OBJM_REQ_BODY)) {
+                test_work_t *work = malloc(sizeof(*work));
+                assert(work != NULL);
+                *work = (test_work_t){ .tc = tc, .conn = conn, .req = req };
+                atomic_fetch_add(&tc->workers, 1);
+                pthread_t thread;
+                assert(pthread_create(&thread, NULL, work_thread, work) == 0);
+                pthread_detach(thread);
+            } else {
+                serve_request(store, conn, req);
+                objm_request_free(req);
+            }
+            atomic_fetch_add(&store->requests, 1);
+            if (atomic_exchange(&store->drop_after_request, false)) break;
+        }
+    }
+    
+    while (atomic_load(&tc->workers) > 0) usleep(100);
+    if (conn) objm_server_destroy(conn);
+    close(tc->fd);
+    free(tc);
+    return NULL;
+}
+
+static void *accept_thread(void *arg) {
+    test_store_t *store = arg;
+    for (;;) {
+        int fd = accept4(store->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return NULL;
+        }
+        
+        test_conn_t *tc = calloc(1, sizeof(*tc));
+        assert(tc != NULL);
+        tc->store = store;
+        tc->fd = fd;
+        
+        pthread_t thread;
+        assert(pthread_create(&thread, NULL, conn_thread, tc) == 0);
+        pthread_detach(thread);
+    }
+}
+
+/* Listen on a Unix socket path, or on a loopback TCP port if path is NULL */
+static void store_start(test_store_t *store, const char *path, uint16_t *port_out) {
+    memset(store, 0, sizeof(*store));
+    pthread_mutex_init(&store->lock, NULL);
+    for (int i = 0; i < STORE_SLOTS; i++) store->fds[i] = -1;
+    store->tcp = (path == NULL);
+    
+    if (store->tcp) {
+        store->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in addr = { .sin_family = AF_INET };
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        assert(bind(store->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+        socklen_t len = sizeof(addr);
+        assert(getsockname(store->listen_fd, (struct sockaddr *)&addr, &len) == 0);
+        *port_out = ntohs(addr.sin_port);
+    } else {
+        store->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+        unlink(path);
+        assert(bind(store->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    }
+    assert(listen(store->listen_fd, 16) == 0);
+    
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, accept_thread, store) == 0);
+    pthread_detach(thread);
+}
+
+/* ============================================================================
+ * Tests
+ * ============================================================================ */
+
+static void key_name(char *buf, size_t size, int i) {
+    snprintf(buf, size, "/bucket/object-%d", i);
+}
+
+static void test_node_specs(void) {
+    printf("Testing node specs...\n");
+    
+    objm_cluster_t *cluster = objm_cluster_create(NULL);
+    assert(cluster != NULL);
+    
+    assert(objm_cluster_add_node_spec(cluster, "unix:/tmp/a.sock") == 0);
+    assert(objm_cluster_add_node_spec(cluster, "b=tcp:10.0.0.2:9000@3") == 1);
+    assert(objm_cluster_add_node_spec(cluster, "tcp:node3.example:9000") == 2);
+    assert(objm_cluster_add_node_spec(cluster, "tcp:host") < 0);
+    assert(objm_cluster_add_node_spec(cluster, "tcp:host:0") < 0);
+    assert(objm_cluster_add_node_spec(cluster, "udp:host:9000") < 0);
+    assert(objm_cluster_add_node_spec(cluster, "c=unix:/tmp/c.sock@0") < 0);
+    assert(objm_cluster_add_node_spec(cluster, "b=unix:/tmp/b.sock") < 0);  /* Same name */
+    assert(objm_cluster_num_nodes(cluster) == 3);
+    
+    objm_cluster_node_status_t status;
+    assert(objm_cluster_node_status(cluster, 0, &status) == 0);
+    assert(strcmp(status.name, "unix:/tmp/a.sock") == 0);
+    assert(status.local && status.weight == 1 && !status.ejected);
+    assert(objm_cluster_node_status(cluster, 1, &status) == 0);
+    assert(strcmp(status.name, "b") == 0);
+    assert(!status.local && status.weight == 3);
+    assert(objm_cluster_node_status(cluster, 3, &status) < 0);
+    
+    objm_cluster_destroy(cluster);
+    printf("✓ Node spec test passed\n\n");
+}
+
+static void test_routing(void) {
+    printf("Testing weighted rendezvous routing...\n");
+    
+    objm_cluster_t *cluster = objm_cluster_create(NULL);
+    assert(objm_cluster_add_node_spec(cluster, "n0=unix:/tmp/n0.sock") == 0);
+    assert(objm_cluster_add_node_spec(cluster, "n1=unix:/tmp/n1.sock") == 1);
+    assert(objm_cluster_add_node_spec(cluster, "n2=unix:/tmp/n2.sock@2") == 2);
+    
+    static int placement[TEST_KEYS];
+    int counts[4] = {0};
+    char key[64];
+    for (int i = 0; i < TEST_KEYS; i++) {
+        key_name(key, sizeof(key), i);
+        placement[i] = objm_cluster_route(cluster, key);
+        assert(placement[i] >= 0 && placement[i] < 3);
+        counts[placement[i]]++;
+    }
+    
+    /* Shares follow the weights (1:1:2) within a few percent */
+    assert(abs(counts[0] - TEST_KEYS / 4) < TEST_KEYS / 40);
+    assert(abs(counts[1] - TEST_KEYS / 4) < TEST_KEYS / 40);
+    assert(abs(counts[2] - TEST_KEYS / 2) < TEST_KEYS / 40);
+    printf("  ✓ Key shares %d/%d/%d for weights 1/1/2\n", counts[0], counts[1], counts[2]);
+    
+    /* Placement depends on names, not on the order nodes were added */
+    objm_cluster_t *reordered = objm_cluster_create(NULL);
+    assert(objm_cluster_add_node_spec(reordered, "n2=tcp:10.0.0.3:9000@2") == 0);
+    assert(objm_cluster_add_node_spec(reordered, "n0=tcp:10.0.0.1:9000") == 1);
+    assert(objm_cluster_add_node_spec(reordered, "n1=tcp:10.0.0.2:9000") == 2);
+    static const int remap[3] = {1, 2, 0};
+    for (int i = 0; i < TEST_KEYS; i++) {
+        key_name(key, sizeof(key), i);
+        assert(objm_cluster_route(reordered, key) == remap[placement[i]]);
+    }
+    objm_cluster_destroy(reordered);
+    printf("  ✓ Clients agree on placement by node name\n");
+    
+    /* A new node only takes keys; nothing moves between old nodes */
+    assert(objm_cluster_add_node_spec(cluster, "n3=unix:/tmp/n3.sock") == 3);
+    int moved = 0;
+    for (int i = 0; i < TEST_KEYS; i++) {
+        key_name(key, sizeof(key), i);
+        int node = objm_cluster_route(cluster, key);
+        if (node != placement[i]) {
+            assert(node == 3);
+            moved++;
+        }
+    }
+    assert(abs(moved - TEST_KEYS / 5) < TEST_KEYS / 40);
+    printf("  ✓ Adding a node moves %d keys (%.1f%%), all to it\n",
+           moved, 100.0 * moved / TEST_KEYS);
+    
+    objm_cluster_destroy(cluster);
+    printf("✓ Routing test passed\n\n");
+}
+
+static void test_ejection(void) {
+    printf("Testing node ejection...\n");
+    
+    unlink(DEAD_SOCKET);
+    objm_cluster_config_t config = {
+        .eject_failures = 2,
+        .eject_base_us = 100 * 1000,
+        .eject_max_us = 1000 * 1000
+    };
+    objm_cluster_t *cluster = objm_cluster_create(&config);
+    assert(objm_cluster_add_node_spec(cluster, "live=unix:" TEST_SOCKET) == 0);
+    assert(objm_cluster_add_node_spec(cluster, "dead=unix:" DEAD_SOCKET) == 1);
+    
+    /* One key on each node */
+    char dead_key[64] = "", live_key[64] = "";
+    for (int i = 0; !dead_key[0] || !live_key[0]; i++) {
+        char key[64];
+        key_name(key, sizeof(key), i);
+        int node = objm_cluster_route(cluster, key);
+        strcpy(node == 1 ? dead_key : live_key, key);
+    }
+    
+    int fd;
+    assert(objm_cluster_get(cluster, dead_key, &fd) < 0);
+    objm_cluster_node_status_t status;
+    assert(objm_cluster_node_status(cluster, 1, &status) == 0);
+    assert(status.failures == 1 && !status.ejected);
+    
+    assert(objm_cluster_get(cluster, dead_key, &fd) < 0);
+    assert(objm_cluster_node_status(cluster, 1, &status) == 0);
+    assert(status.ejected && status.ejections == 1);
+    
+    /* Its keys fail over; nobody else's move */
+    assert(objm_cluster_route(cluster, dead_key) == 0);
+    assert(objm_cluster_route(cluster, live_key) == 0);
+    printf("  ✓ Repeated failures eject the node, its keys fail over\n");
+    
+    /* After the backoff the next request probes it, and one more failure
+     * ejects it for twice as long */
+    usleep(150 * 1000);
+    assert(objm_cluster_route(cluster, dead_key) == 1);
+    assert(objm_cluster_get(cluster, dead_key, &fd) < 0);
+    assert(objm_cluster_node_status(cluster, 1, &status) == 0);
+    assert(status.ejected && status.ejections == 2);
+    usleep(150 * 1000);
+    assert(objm_cluster_route(cluster, dead_key) == 0);
+    usleep(100 * 1000);
+    assert(objm_cluster_route(cluster, dead_key) == 1);
+    printf("  ✓ Ejected nodes are probed again with exponential backoff\n");
+    
+    /* With every node out, routing still picks the owner */
+    objm_cluster_t *lonely = objm_cluster_create(&config);
+    assert(objm_cluster_add_node_spec(lonely, "unix:" DEAD_SOCKET) == 0);
+    assert(objm_cluster_get(lonely, "/x", &fd) < 0);
+    assert(objm_cluster_get(lonely, "/x", &fd) < 0);
+    assert(objm_cluster_node_status(lonely, 0, &status) == 0 && status.ejected);
+    assert(objm_cluster_route(lonely, "/x") == 0);
+    objm_cluster_destroy(lonely);
+    
+    objm_cluster_destroy(cluster);
+    printf("✓ Ejection test passed\n\n");
+}
+
+static void test_operations(void) {
+    printf("Testing operations over Unix and TCP nodes...\n");
+    
+    static test_store_t local_store, remote_store;
+    uint16_t port = 0;
+    store_start(&local_store, TEST_SOCKET, NULL);
+    store_start(&remote_store, NULL, &port);
+    
+    objm_cluster_t *cluster = objm_cluster_create(NULL);
+    char spec[128];
+    assert(objm_cluster_add_node_spec(cluster, "local=unix:" TEST_SOCKET) == 0);
+    snprintf(spec, sizeof(spec), "remote=tcp:127.0.0.1:%u", port);
+    assert(objm_cluster_add_node_spec(cluster, spec) == 1);
+    
+    char local_key[64] = "", remote_key[64] = "";
+    for (int i = 0; !local_key[0] || !remote_key[0]; i++) {
+        char key[64];
+        key_name(key, sizeof(key), i);
+        strcpy(objm_cluster_route(cluster, key) == 0 ? local_key : remote_key, key);
+    }
+    
+    char path[] = "/tmp/objmapper_test_cluster_src.XXXXXX";
+    int src = mkstemp(path);
+    assert(src >= 0);
+    unlink(path);
+    const char *data = "clustered contents";
+    assert(write(src, data, strlen(data)) == (ssize_t)strlen(data));
+    
+    /* Each object lands only on its owner */
+    uint64_t written;
+    assert(objm_cluster_put(cluster, local_key, src, &written) == 0);
+    assert(written == strlen(data));
+    assert(objm_cluster_put(cluster, remote_key, src, &written) == 0);
+    assert(written == strlen(data));
+    int fd = store_get(&local_store, local_key);
+    assert(fd >= 0);
+    close(fd);
+    assert(store_get(&remote_store, local_key) < 0);
+    fd = store_get(&remote_store, remote_key);
+    assert(fd >= 0);
+    close(fd);
+    assert(store_get(&local_store, remote_key) < 0);
+    
+    /* Local GETs get the object's own FD, remote ones a spooled copy */
+    char buf[64];
+    const char *keys[2] = { local_key, remote_key };
+    for (int i = 0; i < 2; i++) {
+        assert(objm_cluster_get(cluster, keys[i], &fd) == 0);
+        memset(buf, 0, sizeof(buf));
+        assert(pread(fd, buf, sizeof(buf), 0) == (ssize_t)strlen(data));
+        assert(strcmp(buf, data) == 0);
+        close(fd);
+    }
+    printf("  ✓ FD passing to the Unix node, streaming to the TCP node\n");
+    
+    /* Connections are pooled */
+    objm_cluster_node_status_t status;
+    assert(objm_cluster_node_status(cluster, 1, &status) == 0);
+    assert(status.idle == 1 && status.failures == 0);
+    
+    /* The server dropping an idle connection is not a node failure */
+    atomic_store(&remote_store.drop_after_request, true);
+    assert(objm_cluster_get(cluster, remote_key, &fd) == 0);
+    close(fd);
+    assert(objm_cluster_get(cluster, remote_key, &fd) == 0);
+    close(fd);
+    assert(objm_cluster_node_status(cluster, 1, &status) == 0);
+    assert(status.idle == 1 && status.failures == 0 && !status.ejected);
+    printf("  ✓ Stale pooled connections are replaced transparently\n");
+    
+    /* Server errors are reported, not counted against the node */
+    assert(objm_cluster_delete(cluster, remote_key) == 0);
+    errno = 0;
+    assert(objm_cluster_get(cluster, remote_key, &fd) < 0 && errno == ENOENT);
+    assert(objm_cluster_delete(cluster, local_key) == 0);
+    errno = 0;
+    assert(objm_cluster_delete(cluster, local_key) < 0 && errno == ENOENT);
+    assert(objm_cluster_node_status(cluster, 0, &status) == 0 && status.failures == 0);
+    assert(objm_cluster_node_status(cluster, 1, &status) == 0 && status.failures == 0);
+    
+    close(src);
+    objm_cluster_destroy(cluster);
+    printf("✓ Operations test passed\n\n");
+}
+
+/* Store an object in a test store directly */
+static void store_put_string(test_store_t *store, const char *uri, const char *data) {
+    int fd = memfd_create("test-object", MFD_CLOEXEC);
+    assert(fd >= 0);
+    assert(write(fd, data, strlen(data)) == (ssize_t)strlen(data));
+    store_set(store, uri, fd);
+}
+
+/* Check a GET result against the object's expected contents */
+static void check_get(const objm_async_result_t *r, const char *expect) {
+    assert(r->error == 0 && r->resp != NULL);
+    if (!expect) {
+        assert(r->resp->status == OBJM_STATUS_NOT_FOUND);
+        return;
+    }
+    assert(r->resp->status == OBJM_STATUS_OK && r->resp->fd >= 0);
+    char buf[64] = {0};
+    assert(pread(r->resp->fd, buf, sizeof(buf), 0) == (ssize_t)strlen(expect));
+    assert(strcmp(buf, expect) == 0);
+}
+
+static atomic_int g_async_deleted;
+
+static void count_delete(const objm_async_result_t *r) {
+    assert(r->error == 0 && r->op == OBJM_OP_DELETE);
+    if (r->resp->status == OBJM_STATUS_OK) atomic_fetch_add(&g_async_deleted, 1);
+    objm_response_free(r->resp);
+}
+
+static void test_async(void) {
+    printf("Testing the asynchronous client...\n");
+    
+    static test_store_t local_store, remote_store;
+    uint16_t port = 0;
+    store_start(&local_store, ASYNC_SOCKET, NULL);
+    local_store.pipeline = 64;
+    local_store.ooo = true;
+    store_start(&remote_store, NULL, &port);
+    remote_store.pipeline = 64;
+    
+    char uris[8][32], data[8][32];
+    for (int i = 0; i < 8; i++) {
+        snprintf(uris[i], sizeof(uris[i]), "/async/object-%d", i);
+        snprintf(data[i], sizeof(data[i]), "async contents %d", i);
+        store_put_string(&local_store, uris[i], data[i]);
+        store_put_string(&remote_store, uris[i], data[i]);
+    }
+    
+    /* 400 GETs (every tenth one missing) from one thread, one submit call */
+    enum { NUM_OPS = 400 };
+    static char names[NUM_OPS][32];
+    objm_async_op_t ops[NUM_OPS];
+    for (int i = 0; i < NUM_OPS; i++) {
+        if (i % 10 == 9) snprintf(names[i], sizeof(names[i]), "/async/missing-%d", i);
+        else snprintf(names[i], sizeof(names[i]), "%s", uris[i % 8]);
+        ops[i] = (objm_async_op_t){ .op = OBJM_OP_GET, .uri = names[i],
+                                    .arg = (void *)(intptr_t)i };
+    }
+    
+    objm_async_config_t config = {
+        .transport = { .type = TRANSPORT_UNIX, .unix_cfg.path = ASYNC_SOCKET },
+        .connections = 2,
+        .depth = 32
+    };
+    objm_async_t *client = objm_async_create(&config);
+    assert(client != NULL);
+    assert(objm_async_submit(client, ops, NUM_OPS) == NUM_OPS);
+    
+    objm_async_result_t results[64];
+    int seen[NUM_OPS] = {0};
+    int completed = 0;
+    while (completed < NUM_OPS) {
+        size_t n = objm_async_reap(client, results, 64, 5000);
+        assert(n > 0);
+        for (size_t k = 0; k < n; k++) {
+            int i = (int)(intptr_t)results[k].arg;
+            assert(results[k].op == OBJM_OP_GET && !seen[i]);
+            seen[i] = 1;
+            check_get(&results[k], i % 10 == 9 ? NULL : data[i % 8]);
+            objm_response_free(results[k].resp);
+        }
+        completed += n;
+    }
+    assert(objm_async_outstanding(client) == 0);
+    assert(objm_async_reap(client, results, 64, 0) == 0);
+    assert(atomic_load(&local_store.connections) <= 2);
+    printf("  ✓ %d pipelined GETs over %d connections, replies out of order\n",
+           NUM_OPS, atomic_load(&local_store.connections));
+    
+    /* FD pass PUT: the result is the writer FD */
+    objm_async_op_t put = { .op = OBJM_OP_PUT, .uri = "/async/put" };
+    assert(objm_async_submit(client, &put, 1) == 1);
+    assert(objm_async_reap(client, results, 1, 5000) == 1);
+    assert(results[0].resp->status == OBJM_STATUS_OK && results[0].resp->fd >= 0);
+    assert(write(results[0].resp->fd, "written", 7) == 7);
+    objm_response_free(results[0].resp);
+    
+    objm_async_op_t get = { .op = OBJM_OP_GET, .uri = "/async/put" };
+    assert(objm_async_submit(client, &get, 1) == 1);
+    assert(objm_async_reap(client, results, 1, 5000) == 1);
+    check_get(&results[0], "written");
+    objm_response_free(results[0].resp);
+    
+    /* Callback delivery */
+    objm_async_op_t dels[8];
+    for (int i = 0; i < 8; i++) {
+        dels[i] = (objm_async_op_t){ .op = OBJM_OP_DELETE, .uri = uris[i], .cb = count_delete };
+    }
+    assert(objm_async_submit(client, dels, 8) == 8);
+    objm_async_drain(client);
+    assert(atomic_load(&g_async_deleted) == 8);
+    printf("  ✓ PUT writer FDs, callbacks and drain\n");
+    
+    /* Streaming PUTs need a body after the request: refused up front */
+    objm_async_destroy(client);
+    config.transport = (transport_config_t){
+        .type = TRANSPORT_TCP, .tcp_cfg = { .host = "127.0.0.1", .port = port }
+    };
+    client = objm_async_create(&config);
+    assert(client != NULL);
+    errno = 0;
+    assert(objm_async_submit(client, &put, 1) == 0 && errno == EINVAL);
+    
+    /* Remote GETs are spooled into a memfd */
+    assert(objm_async_submit(client, ops, 100) == 100);
+    for (completed = 0; completed < 100; ) {
+        size_t n = objm_async_reap(client, results, 64, 5000);
+        assert(n > 0);
+        for (size_t k = 0; k < n; k++) {
+            int i = (int)(intptr_t)results[k].arg;
+            check_get(&results[k], i % 10 == 9 ? NULL : data[i % 8]);
+            objm_response_free(results[k].resp);
+        }
+        completed += n;
+    }
+    printf("  ✓ Streamed replies over TCP\n");
+    
+    /* A dropped session fails its requests; the next submit reconnects */
+    atomic_store(&remote_store.drop_after_request, true);
+    assert(objm_async_submit(client, ops, 32) == 32);
+    int failed = 0;
+    for (completed = 0; completed < 32; ) {
+        size_t n = objm_async_reap(client, results, 64, 5000);
+        assert(n > 0);
+        for (size_t k = 0; k < n; k++) {
+            if (results[k].error) {
+                assert(results[k].resp == NULL);
+                failed++;
+            }
+            objm_response_free(results[k].resp);
+        }
+        completed += n;
+    }
+    assert(failed > 0);
+    assert(objm_async_submit(client, ops, 1) == 1);
+    assert(objm_async_reap(client, results, 1, 5000) == 1);
+    check_get(&results[0], data[0]);
+    objm_response_free(results[0].resp);
+    objm_async_destroy(client);
+    
+    /* Nothing listening */
+    unlink(DEAD_SOCKET);
+    config.transport = (transport_config_t){ .type = TRANSPORT_UNIX, .unix_cfg.path = DEAD_SOCKET };
+    client = objm_async_create(&config);
+    errno = 0;
+    assert(objm_async_submit(client, ops, 4) == 0 && errno != 0);
+    objm_async_destroy(client);
+    printf("  ✓ Broken sessions fail their requests and reconnect\n");
+    
+    printf("✓ Asynchronous client test passed\n\n");
+}
+
+static void test_shm_ring(void) {
+    printf("Testing the shared-memory ring transport...\n");
+    
+    static test_store_t store;
+    store_start(&store, RING_SOCKET, NULL);
+    store.pipeline = 64;
+    store.ooo = true;
+    store.ring = true;
+    
+    /* Synchronous cluster client: replies in the ring, FDs on the socket */
+    objm_cluster_t *cluster = objm_cluster_create(NULL);
+    assert(objm_cluster_add_node_spec(cluster, "unix:" RING_SOCKET) == 0);
+    
+    int src = memfd_create("ring-src", MFD_CLOEXEC);
+    const char *data = "ring contents";
+    assert(write(src, data, strlen(data)) == (ssize_t)strlen(data));
+    uint64_t written;
+    assert(objm_cluster_put(cluster, "/ring/object", src, &written) == 0);
+    assert(written == strlen(data));
+    close(src);
+    
+    char buf[64];
+    for (int i = 0; i < 100; i++) {
+        int fd;
+        assert(objm_cluster_get(cluster, "/ring/object", &fd) == 0);
+        memset(buf, 0, sizeof(buf));
+        assert(pread(fd, buf, sizeof(buf), 0) == (ssize_t)strlen(data));
+        assert(strcmp(buf, data) == 0);
+        close(fd);
+    }
+    assert(objm_cluster_delete(cluster, "/ring/object") == 0);
+    objm_cluster_destroy(cluster);
+    assert(atomic_load(&store.ring_sessions) == atomic_load(&store.connections));
+    printf("  ✓ Cluster PUT/GET/DELETE through the ring\n");
+    
+    /* Pipelined out-of-order replies: their FDs are matched up in order */
+    char uris[8][32], contents[8][32];
+    for (int i = 0; i < 8; i++) {
+        snprintf(uris[i], sizeof(uris[i]), "/ring/object-%d", i);
+        snprintf(contents[i], sizeof(contents[i]), "ring contents %d", i);
+        store_put_string(&store, uris[i], contents[i]);
+    }
+    
+    enum { NUM_OPS = 400 };
+    objm_async_op_t ops[NUM_OPS];
+    for (int i = 0; i < NUM_OPS; i++) {
+        ops[i] = (objm_async_op_t){ .op = OBJM_OP_GET, .uri = uris[i % 8],
+                                    .arg = (void *)(intptr_t)i };
+    }
+    objm_async_config_t config = {
+        .transport = { .type = TRANSPORT_UNIX, .unix_cfg.path = RING_SOCKET },
+        .connections = 2,
+        .depth = 32
+    };
+    objm_async_t *client = objm_async_create(&config);
+    assert(client != NULL);
+    assert(objm_async_submit(client, ops, NUM_OPS) == NUM_OPS);
+    
+    objm_async_result_t results[64];
+    for (int completed = 0; completed < NUM_OPS; ) {
+        size_t n = objm_async_reap(client, results, 64, 5000);
+        assert(n > 0);
+        for (size_t k = 0; k < n; k++) {
+            int i = (int)(intptr_t)results[k].arg;
+            check_get(&results[k], contents[i % 8]);
+            objm_response_free(results[k].resp);
+        }
+        completed += n;
+    }
+    objm_async_destroy(client);
+    assert(atomic_load(&store.ring_sessions) == atomic_load(&store.connections));
+    printf("  ✓ %d pipelined GETs with out-of-order replies\n", NUM_OPS);
+    
+    /* Streamed bodies several times the ring's size wrap around it */
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", RING_SOCKET);
+    assert(connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    
+    objm_connection_t *conn = objm_client_create(sock, OBJM_PROTO_V2);
+    objm_hello_t hello = { .capabilities = OBJM_CAP_SHM_RING, .max_pipeline = 1 };
+    objm_params_t params;
+    assert(objm_client_hello(conn, &hello, &params) == 0);
+    assert(params.capabilities & OBJM_CAP_SHM_RING);
+    
+    size_t size = 3 * OBJM_RING_SIZE + 123;
+    uint8_t *body = malloc(size);
+    assert(body != NULL);
+    for (size_t i = 0; i < size; i++) body[i] = (uint8_t)(i * 7);
+    int body_fd = memfd_create("ring-body", MFD_CLOEXEC);
+    assert(write(body_fd, body, size) == (ssize_t)size);
+    
+    objm_request_t req = { .id = 1, .op = OBJM_OP_PUT, .flags = OBJM_REQ_BODY,
+                           .mode = OBJM_MODE_COPY, .uri = "/ring/large", .uri_len = 11 };
+    uint64_t len;
+    assert(objm_client_send_request(conn, &req) == 0);
+    assert(objm_send_body(conn, body_fd, OBJM_MODE_COPY, &len) == 0 && len == size);
+    objm_response_t *resp;
+    assert(objm_client_recv_response(conn, &resp) == 0);
+    assert(resp->status == OBJM_STATUS_OK && resp->content_len == OBJM_CONTENT_CHUNKED);
+    assert(objm_recv_body(conn, -1, OBJM_MODE_COPY, &len) == 0 && len == 0);
+    objm_response_free(resp);
+    close(body_fd);
+    
+    req = (objm_request_t){ .id = 2, .op = OBJM_OP_GET, .mode = OBJM_MODE_COPY,
+                            .uri = "/ring/large", .uri_len = 11 };
+    assert(objm_client_send_request(conn, &req) == 0);
+    assert(objm_client_recv_response(conn, &resp) == 0);
+    assert(resp->status == OBJM_STATUS_OK && resp->content_len == OBJM_CONTENT_CHUNKED);
+    int copy = memfd_create("ring-copy", MFD_CLOEXEC);
+    assert(objm_recv_body(conn, copy, OBJM_MODE_COPY, &len) == 0 && len == size);
+    objm_response_free(resp);
+    
+    uint8_t *check = malloc(size);
+    assert(check != NULL);
+    assert(pread(copy, check, size, 0) == (ssize_t)size);
+    assert(memcmp(check, body, size) == 0);
+    free(check);
+    free(body);
+    close(copy);
+    
+    assert(objm_client_close(conn, OBJM_CLOSE_NORMAL) == 0);
+    objm_client_destroy(conn);
+    close(sock);
+    printf("  ✓ %zu-byte body streamed both ways\n", size);
+    
+    printf("✓ Shared-memory ring test passed\n\n");
+}
+
+int main(void) {
+    printf("=== objmapper Cluster Tests ===\n\n");
+    
+    signal(SIGPIPE, SIG_IGN);
+    
+    test_node_specs();
+    test_routing();
+    test_ejection();
+    test_operations();
+    test_async();
+    test_shm_ring();
+    
+    unlink(TEST_SOCKET);
+    unlink(ASYNC_SOCKET);
+    unlink(RING_SOCKET);
+    
+    printf("=== All tests passed! ===\n");
+    return 0;
+}
@@ -15,6 +15,17 @@
 #include <math.h>
 #include <dirent.h>
 #include <endian.h>
+#include <sched.h>
+#include <limits.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 /* ============================================================================
  * Internal helpers
@@ -29,16 +40,79 @@ static uint64_t get_monotonic_us(void) {
     return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
 }
 
+/* wyhash secrets (odd, balanced bit counts) */
+#define HASH_P0 0xa0761d6478bd642fULL
+#define HASH_P1 0xe7037ed1a0b428dbULL
+#define HASH_P2 0x8ebc6af09c88c6e3ULL
+#define HASH_P3 0x589965cc75374cc3ULL
+
+static inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static inline uint64_t hash_read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t hash_read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
 /**
- * FNV-1a hash
+ * wyhash-style hash (seed 0)
+ * Long URIs that share a prefix cost one multiply per 16 bytes instead of a
+ * multiply per byte.
  */
-uint64_t index_hash_string(const char *str) {
-    uint64_t hash = 14695981039346656037ULL;
-    while (*str) {
-        hash ^= (uint64_t)(unsigned char)*str++;
-        hash *= 1099511628211ULL;
+uint64_t index_hash_bytes(const void *key, size_t len) {
+    const uint8_t *p = key;
+    uint64_t seed = hash_mix(HASH_P0, HASH_P1);
+    uint64_t a, b;
+    
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t mid = (len >> 3) << 2;
+            a = (hash_read32(p) << 32) | hash_read32(p + mid);
+            b = (hash_read32(p + len - 4) << 32) | hash_read32(p + len - 4 - mid);
+        } else if (len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = hash_mix(hash_read64(p) ^ HASH_P1, hash_read64(p + 8) ^ seed);
+                seed1 = hash_mix(hash_read64(p + 16) ^ HASH_P2, hash_read64(p + 24) ^ seed1);
+                seed2 = hash_mix(hash_read64(p + 32) ^ HASH_P3, hash_read64(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (i > 16) {
+            seed = hash_mix(hash_read64(p) ^ HASH_P1, hash_read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        /* Last 16 bytes, overlapping what was already mixed */
+        a = hash_read64(p + i - 16);
+        b = hash_read64(p + i - 8);
     }
-    return hash;
+    
+    __uint128_t r = (__uint128_t)(a ^ HASH_P1) * (b ^ seed);
+    return hash_mix((uint64_t)r ^ HASH_P0 ^ len, (uint64_t)(r >> 64) ^ HASH_P1);
+}
+
+uint64_t index_hash_string(const char *str) {
+    return index_hash_bytes(str, strlen(str));
 }
 
 /**
@@ -56,36 +130,587 @@ size_t index_next_power_of_2(size_t n) {
     return n;
 }
 
+/* ============================================================================
+ * Epoch-Based Reclamation
+ * ============================================================================
+ *
+ * Classic three-epoch EBR. Each thread owns a record whose local_epoch is 0
+ * outside read sections and a snapshot of the global epoch inside one. The
+ * global epoch only advances when every active record has observed the
+ * current value, so anything retired at epoch e is unreachable by all
+ * readers once the global epoch reaches e + 2.
+ *
+ * Readers touch only their own cache line. Retirement is a write-path
+ * operation and goes through one mutex-protected limbo list; every
+ * EPOCH_COLLECT_INTERVAL retires it tries to advance and reclaim. A retire
+ * inside a read section (an FD cache eviction during a lookup) leaves the
+ * collection to the thread's index_epoch_exit().
+ */
+
+#define EPOCH_COLLECT_INTERVAL 64
+
+typedef struct epoch_record {
+    atomic_uint_fast64_t local_epoch;   /* 0 = not in a read section */
+    unsigned nesting;                   /* Owner thread only */
+    bool collect_due;                   /* Owner: collect on leaving the section */
+    atomic_int in_use;                  /* Owned by a live thread */
+    struct epoch_record *next;          /* Registry (append-only) */
+} __attribute__((aligned(64))) epoch_record_t;
+
+typedef struct epoch_retired {
+    void (*reclaim)(void *);
+    void *ptr;
+    uint64_t epoch;
+    struct epoch_retired *next;
+} epoch_retired_t;
+
+static struct {
+    atomic_uint_fast64_t global_epoch;
+    atomic_uintptr_t records;           /* epoch_record_t list head */
+    
+    pthread_mutex_t limbo_lock;
+    epoch_retired_t *limbo_head;        /* Oldest first */
+    epoch_retired_t *limbo_tail;
+    size_t limbo_count;
+    size_t since_collect;
+} g_epoch = {
+    .global_epoch = 1,
+    .records = 0,
+    .limbo_lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static pthread_key_t g_epoch_key;
+static pthread_once_t g_epoch_key_once = PTHREAD_ONCE_INIT;
+static __thread epoch_record_t *t_epoch_record;
+
+static void epoch_thread_exit(void *arg) {
+    epoch_record_t *rec = arg;
+    rec->nesting = 0;
+    rec->collect_due = false;
+    atomic_store(&rec->local_epoch, 0);
+    atomic_store(&rec->in_use, 0);
+}
+
+static void epoch_key_init(void) {
+    pthread_key_create(&g_epoch_key, epoch_thread_exit);
+}
+
+static epoch_record_t *epoch_register(void) {
+    pthread_once(&g_epoch_key_once, epoch_key_init);
+    
+    /* Reuse a record left by an exited thread */
+    epoch_record_t *rec = (epoch_record_t *)atomic_load(&g_epoch.records);
+    for (; rec; rec = rec->next) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&rec->in_use, &expected, 1)) break;
+    }
+    
+    if (!rec) {
+        rec = aligned_alloc(64, sizeof(*rec));
+        if (!rec) abort();  /* Cannot read safely without a record */
+        memset(rec, 0, sizeof(*rec));
+        atomic_init(&rec->local_epoch, 0);
+        atomic_init(&rec->in_use, 1);
+        
+        uintptr_t head = atomic_load(&g_epoch.records);
+        do {
+            rec->next = (epoch_record_t *)head;
+        } while (!atomic_compare_exchange_weak(&g_epoch.records, &head, (uintptr_t)rec));
+    }
+    
+    rec->nesting = 0;
+    rec->collect_due = false;
+    pthread_setspecific(g_epoch_key, rec);
+    t_epoch_record = rec;
+    return rec;
+}
+
+static void epoch_collect(void);
+
+void index_epoch_enter(void) {
+    epoch_record_t *rec = t_epoch_record;
+    if (!rec) rec = epoch_register();
+    
+    if (rec->nesting++ == 0) {
+        /* seq_cst store orders the announcement before our traversal */
+        atomic_store(&rec->local_epoch, atomic_load(&g_epoch.global_epoch));
+    }
+}
+
+void index_epoch_exit(void) {
+    epoch_record_t *rec = t_epoch_record;
+    if (!rec || rec->nesting == 0) return;
+    
+    if (--rec->nesting == 0) {
+        atomic_store_explicit(&rec->local_epoch, 0, memory_order_release);
+        if (rec->collect_due) {
+            rec->collect_due = false;
+            epoch_collect();
+        }
+    }
+}
+
+/**
+ * Advance the global epoch if all active readers have caught up
+ */
+static uint64_t epoch_try_advance(void) {
+    uint64_t epoch = atomic_load(&g_epoch.global_epoch);
+    
+    for (epoch_record_t *rec = (epoch_record_t *)atomic_load(&g_epoch.records);
+         rec; rec = rec->next) {
+        uint64_t local = atomic_load(&rec->local_epoch);
+        if (local != 0 && local != epoch) return epoch;
+    }
+    
+    atomic_compare_exchange_strong(&g_epoch.global_epoch, &epoch, epoch + 1);
+    return atomic_load(&g_epoch.global_epoch);
+}
+
+/**
+ * Reclaim everything retired at least two epochs ago
+ */
+static void epoch_collect(void) {
+    uint64_t epoch = epoch_try_advance();
+    
+    pthread_mutex_lock(&g_epoch.limbo_lock);
+    epoch_retired_t *ready = NULL;
+    epoch_retired_t **tail = &ready;
+    while (g_epoch.limbo_head && g_epoch.limbo_head->epoch + 2 <= epoch) {
+        epoch_retired_t *item = g_epoch.limbo_head;
+        g_epoch.limbo_head = item->next;
+        g_epoch.limbo_count--;
+        item->next = NULL;
+        *tail = item;
+        tail = &item->next;
+    }
+    if (!g_epoch.limbo_head) g_epoch.limbo_tail = NULL;
+    g_epoch.since_collect = 0;
+    pthread_mutex_unlock(&g_epoch.limbo_lock);
+    
+    /* Callbacks may retire more objects, so run them unlocked */
+    while (ready) {
+        epoch_retired_t *next = ready->next;
+        ready->reclaim(ready->ptr);
+        free(ready);
+        ready = next;
+    }
+}
+
+void index_epoch_retire(void (*reclaim)(void *), void *ptr) {
+    if (!reclaim) return;
+    
+    epoch_retired_t *item = malloc(sizeof(*item));
+    if (!item) {
+        /* No memory to defer with: wait out the readers instead */
+        index_epoch_synchronize();
+        reclaim(ptr);
+        return;
+    }
+    
+    item->reclaim = reclaim;
+    item->ptr = ptr;
+    item->next = NULL;
+    
+    pthread_mutex_lock(&g_epoch.limbo_lock);
+    item->epoch = atomic_load(&g_epoch.global_epoch);
+    if (g_epoch.limbo_tail) g_epoch.limbo_tail->next = item;
+    else g_epoch.limbo_head = item;
+    g_epoch.limbo_tail = item;
+    g_epoch.limbo_count++;
+    int collect = ++g_epoch.since_collect >= EPOCH_COLLECT_INTERVAL;
+    pthread_mutex_unlock(&g_epoch.limbo_lock);
+    
+    /* Never reclaim from inside a read section: we may hold a retiree */
+    epoch_record_t *rec = t_epoch_record;
+    if (!collect) return;
+    if (rec && rec->nesting != 0) {
+        rec->collect_due = true;
+    } else {
+        epoch_collect();
+    }
+}
+
+void index_epoch_synchronize(void) {
+    for (;;) {
+        epoch_collect();
+        
+        pthread_mutex_lock(&g_epoch.limbo_lock);
+        int empty = (g_epoch.limbo_head == NULL);
+        pthread_mutex_unlock(&g_epoch.limbo_lock);
+        
+        if (empty) return;
+        sched_yield();
+    }
+}
+
+size_t index_epoch_pending(void) {
+    pthread_mutex_lock(&g_epoch.limbo_lock);
+    size_t count = g_epoch.limbo_count;
+    pthread_mutex_unlock(&g_epoch.limbo_lock);
+    return count;
+}
+
+/* Reclaim callback for cached descriptors */
+static void epoch_close_fd(void *ptr) {
+    close((int)(intptr_t)ptr);
+}
+
+/* ============================================================================
+ * Entry Slab and Backend Roots
+ * ============================================================================
+ *
+ * Entries are INDEX_ENTRY_SLOT_SIZE slots bump-allocated from INDEX_SLAB_BYTES
+ * chunks: no malloc header per object, 64-byte alignment for the hot/cold
+ * split, and only pages that were handed out become resident. Freed slots go
+ * to a per-thread magazine (spilling half to the shared list when full), so
+ * creating and reclaiming entries rarely takes the slab lock. Chunks are
+ * kept for the life of the process.
+ */
+
+_Static_assert(sizeof(index_entry_t) <= INDEX_ENTRY_SLOT_SIZE,
+               "index_entry_t must fit its slab slot");
+_Static_assert(INDEX_ENTRY_SLOT_SIZE % 64 == 0,
+               "slab slots must keep cache-line alignment");
+
+typedef struct slab_slot {
+    struct slab_slot *next;
+} slab_slot_t;
+
+typedef struct {
+    slab_slot_t *head;
+    size_t count;
+} slab_magazine_t;
+
+static struct {
+    pthread_mutex_t lock;
+    slab_slot_t *free_list;          /* Spilled and flushed slots */
+    char *bump;                      /* Unused tail of the newest chunk */
+    char *bump_end;
+    size_t chunks;
+} g_slab = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+static pthread_key_t g_slab_key;
+static pthread_once_t g_slab_key_once = PTHREAD_ONCE_INIT;
+static __thread slab_magazine_t t_magazine;
+static __thread bool t_magazine_registered;
+
+/* Splice a list of @count slots onto the shared free list (lock held) */
+static void slab_push_locked(slab_slot_t *head, slab_slot_t *tail) {
+    tail->next = g_slab.free_list;
+    g_slab.free_list = head;
+}
+
+static void slab_thread_exit(void *arg) {
+    slab_magazine_t *mag = arg;
+    if (!mag->head) return;
+    
+    slab_slot_t *tail = mag->head;
+    while (tail->next) tail = tail->next;
+    
+    pthread_mutex_lock(&g_slab.lock);
+    slab_push_locked(mag->head, tail);
+    pthread_mutex_unlock(&g_slab.lock);
+    mag->head = NULL;
+    mag->count = 0;
+}
+
+static void slab_key_init(void) {
+    pthread_key_create(&g_slab_key, slab_thread_exit);
+}
+
+static slab_magazine_t *slab_magazine(void) {
+    if (!t_magazine_registered) {
+        /* Hand the magazine back to the shared list when the thread exits */
+        pthread_once(&g_slab_key_once, slab_key_init);
+        pthread_setspecific(g_slab_key, &t_magazine);
+        t_magazine_registered = true;
+    }
+    return &t_magazine;
+}
+
+/* Refill an empty magazine: shared free slots first, then fresh ones */
+static void slab_refill(slab_magazine_t *mag) {
+    pthread_mutex_lock(&g_slab.lock);
+    
+    while (mag->count < INDEX_SLAB_MAGAZINE / 2 && g_slab.free_list) {
+        slab_slot_t *slot = g_slab.free_list;
+        g_slab.free_list = slot->next;
+        slot->next = mag->head;
+        mag->head = slot;
+        mag->count++;
+    }
+    
+    while (mag->count < INDEX_SLAB_MAGAZINE / 2) {
+        if (g_slab.bump == g_slab.bump_end) {
+            void *chunk = mmap(NULL, INDEX_SLAB_BYTES, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (chunk == MAP_FAILED) break;
+            g_slab.bump = chunk;
+            g_slab.bump_end = g_slab.bump + INDEX_SLAB_BYTES;
+            g_slab.chunks++;
+        }
+        slab_slot_t *slot = (slab_slot_t *)g_slab.bump;
+        g_slab.bump += INDEX_ENTRY_SLOT_SIZE;
+        slot->next = mag->head;
+        mag->head = slot;
+        mag->count++;
+    }
+    
+    pthread_mutex_unlock(&g_slab.lock);
+}
+
+static void *slab_alloc(void) {
+    slab_magazine_t *mag = slab_magazine();
+    if (!mag->head) slab_refill(mag);
+    
+    slab_slot_t *slot = mag->head;
+    if (!slot) return NULL;
+    mag->head = slot->next;
+    mag->count--;
+    return slot;
+}
+
+static void slab_free(void *ptr) {
+    slab_magazine_t *mag = slab_magazine();
+    slab_slot_t *slot = ptr;
+    slot->next = mag->head;
+    mag->head = slot;
+    mag->count++;
+    
+    if (mag->count < INDEX_SLAB_MAGAZINE) return;
+    
+    /* Full: keep the most recently freed (cache-warm) half */
+    slab_slot_t *keep_tail = mag->head;
+    for (size_t i = 1; i < INDEX_SLAB_MAGAZINE / 2; i++) {
+        keep_tail = keep_tail->next;
+    }
+    slab_slot_t *spill = keep_tail->next;
+    slab_slot_t *spill_tail = spill;
+    while (spill_tail->next) spill_tail = spill_tail->next;
+    keep_tail->next = NULL;
+    mag->count = INDEX_SLAB_MAGAZINE / 2;
+    
+    pthread_mutex_lock(&g_slab.lock);
+    slab_push_locked(spill, spill_tail);
+    pthread_mutex_unlock(&g_slab.lock);
+}
+
+/*
+ * An entry's location is a tagged word: an interned root with
+ * LOCATION_ROOTED set (path = root + URI), an owned descriptor shifted
+ * past LOCATION_ANON, or an owned path string. Interned roots are never
+ * freed, so a rooted entry can outlive its index.
+ */
+#define LOCATION_ROOTED ((uintptr_t)1)
+#define LOCATION_ANON   ((uintptr_t)2)
+#define LOCATION_TAGS   (LOCATION_ROOTED | LOCATION_ANON)
+
+static inline uintptr_t anon_location(int fd) {
+    return ((uintptr_t)fd << 2) | LOCATION_ANON;
+}
+
+static inline int location_fd(uintptr_t loc) {
+    return (int)(loc >> 2);
+}
+
+/* Reclaim a location that was replaced; openers may still be using it */
+static void location_retire(uintptr_t loc) {
+    if (loc & LOCATION_ANON) {
+        index_epoch_retire(epoch_close_fd, (void *)(intptr_t)location_fd(loc));
+    } else if (!(loc & LOCATION_ROOTED)) {
+        index_epoch_retire(free, (void *)loc);
+    }
+}
+
+typedef struct index_root {
+    struct index_root *next;
+    size_t len;
+    char path[];
+} index_root_t;
+
+static struct {
+    pthread_mutex_t lock;
+    index_root_t *head;
+} g_roots = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+static const index_root_t *root_intern(const char *path) {
+    pthread_mutex_lock(&g_roots.lock);
+    
+    index_root_t *root;
+    for (root = g_roots.head; root; root = root->next) {
+        if (strcmp(root->path, path) == 0) break;
+    }
+    
+    if (!root) {
+        size_t len = strlen(path);
+        root = malloc(sizeof(*root) + len + 1);
+        if (root) {
+            root->len = len;
+            memcpy(root->path, path, len + 1);
+            root->next = g_roots.head;
+            g_roots.head = root;
+        }
+    }
+    
+    pthread_mutex_unlock(&g_roots.lock);
+    return root;
+}
+
+/* Rooted location for @path in @backend_id, or 0 if it is not derivable */
+static uintptr_t root_location(global_index_t *idx, uint32_t backend_id,
+                               const char *uri, const char *path) {
+    if (backend_id >= INDEX_MAX_ROOTS) return 0;
+    
+    const index_root_t *root = (const index_root_t *)atomic_load_explicit(
+        &idx->roots[backend_id], memory_order_acquire);
+    if (!root || strncmp(path, root->path, root->len) != 0 ||
+        strcmp(path + root->len, uri) != 0) {
+        return 0;
+    }
+    return (uintptr_t)root | LOCATION_ROOTED;
+}
+
+/* Drop the stored path of a freshly indexed entry if its root derives it */
+static void entry_adopt_root(global_index_t *idx, index_entry_t *entry) {
+    uintptr_t loc = atomic_load_explicit(&entry->location, memory_order_acquire);
+    if (loc & LOCATION_TAGS) return;
+    
+    uintptr_t rooted = root_location(idx, entry->backend_id, entry->uri,
+                                     (const char *)loc);
+    if (rooted && atomic_compare_exchange_strong(&entry->location, &loc, rooted)) {
+        /* A backend index may already have published the entry */
+        index_epoch_retire(free, (void *)loc);
+    }
+}
+
+int global_index_set_backend_root(global_index_t *idx, uint32_t backend_id,
+                                  const char *root) {
+    if (!idx || !root || backend_id >= INDEX_MAX_ROOTS) return -1;
+    
+    const index_root_t *interned = root_intern(root);
+    if (!interned) return -1;
+    
+    atomic_store_explicit(&idx->roots[backend_id], (uintptr_t)interned,
+                          memory_order_release);
+    return 0;
+}
+
+int index_entry_path(const index_entry_t *entry, char *buf, size_t size) {
+    if (!entry || !buf || size == 0) return -1;
+    
+    /* Keeps a replaced path string alive while it is copied */
+    index_epoch_enter();
+    uintptr_t loc = atomic_load_explicit((atomic_uintptr_t *)&entry->location,
+                                         memory_order_acquire);
+    int n;
+    if (loc & LOCATION_ROOTED) {
+        const index_root_t *root = (const index_root_t *)(loc & ~LOCATION_ROOTED);
+        n = snprintf(buf, size, "%s%s", root->path, entry->uri);
+    } else if (loc & LOCATION_ANON) {
+        n = snprintf(buf, size, "/proc/self/fd/%d", location_fd(loc));
+    } else {
+        n = snprintf(buf, size, "%s", (const char *)loc);
+    }
+    index_epoch_exit();
+    
+    return (n < 0 || (size_t)n >= size) ? -1 : 0;
+}
+
+int index_entry_anon_fd(const index_entry_t *entry) {
+    if (!entry) return -1;
+    
+    uintptr_t loc = atomic_load_explicit((atomic_uintptr_t *)&entry->location,
+                                         memory_order_acquire);
+    return (loc & LOCATION_ANON) ? location_fd(loc) : -1;
+}
+
+/**
+ * Open a private read-only FD on an entry's current location
+ * Caller is inside an epoch section.
+ * 
+ * An anonymous object is reopened through /proc so the FD gets its own
+ * read-only description; once sealed nothing can modify it and a dup() of
+ * the object descriptor is just as safe.
+ */
+static int entry_open_readonly(const index_entry_t *entry) {
+    uintptr_t loc = atomic_load_explicit((atomic_uintptr_t *)&entry->location,
+                                         memory_order_acquire);
+    char path[PATH_MAX];
+    
+    if (loc & LOCATION_ANON) {
+        if (entry->flags & INDEX_FLAG_SEALED) {
+            return fcntl(location_fd(loc), F_DUPFD_CLOEXEC, 0);
+        }
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", location_fd(loc));
+    } else if (index_entry_path(entry, path, sizeof(path)) < 0) {
+        return -1;
+    }
+    
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
 /* ============================================================================
  * Index Entry Implementation
  * ============================================================================ */
 
-index_entry_t *index_entry_create(const char *uri, uint32_t backend_id,
-                                  const char *backend_path) {
-    index_entry_t *entry = calloc(1, sizeof(*entry));
+/* Allocate an entry at loc (ownership of loc taken only on success) */
+static index_entry_t *entry_alloc(const char *uri, uint32_t backend_id, uintptr_t loc) {
+    index_entry_t *entry = slab_alloc();
     if (!entry) return NULL;
+    memset(entry, 0, sizeof(*entry));
     
-    entry->uri = strdup(uri);
-    entry->backend_path = strdup(backend_path);
-    
-    if (!entry->uri || !entry->backend_path) {
-        free(entry->uri);
-        free(entry->backend_path);
-        free(entry);
-        return NULL;
+    size_t uri_len = strlen(uri);
+    if (uri_len < INDEX_URI_INLINE) {
+        memcpy(entry->uri_inline, uri, uri_len + 1);
+        entry->uri = entry->uri_inline;
+    } else {
+        entry->uri = strdup(uri);
+        if (!entry->uri) {
+            slab_free(entry);
+            return NULL;
+        }
     }
     
-    entry->uri_hash = index_hash_string(uri);
+    entry->uri_len = (uint32_t)uri_len;
+    atomic_init(&entry->location, loc);
+    entry->uri_hash = index_hash_bytes(uri, uri_len);
     entry->backend_id = backend_id;
+    entry->home_backend_id = backend_id;
     
     atomic_init(&entry->fd, -1);
-    atomic_init(&entry->fd_refcount, 0);
     atomic_init(&entry->fd_generation, 0);
+    atomic_init(&entry->fd_recent, 0);
     atomic_init(&entry->access_count, 0);
     atomic_init(&entry->last_access, 0);
+    atomic_init(&entry->reader_node, 0);
     atomic_init(&entry->entry_refcount, 1);  /* Start with 1 reference */
     atomic_init(&entry->next, (uintptr_t)NULL);
+    atomic_init(&entry->backend_next, (uintptr_t)NULL);
+    
+    return entry;
+}
+
+index_entry_t *index_entry_create(const char *uri, uint32_t backend_id,
+                                  const char *backend_path) {
+    /* The path is owned until a global index with a matching root adopts
+     * the entry (global_index_insert) */
+    char *path = strdup(backend_path);
+    if (!path) return NULL;
+    
+    index_entry_t *entry = entry_alloc(uri, backend_id, (uintptr_t)path);
+    if (!entry) free(path);
+    return entry;
+}
+
+index_entry_t *index_entry_create_anon(const char *uri, uint32_t backend_id, int fd) {
+    if (fd < 0) return NULL;
     
+    index_entry_t *entry = entry_alloc(uri, backend_id, anon_location(fd));
+    if (!entry) close(fd);
     return entry;
 }
 
@@ -95,19 +720,43 @@ void index_entry_get(index_entry_t *entry) {
     }
 }
 
+bool index_entry_tryget(index_entry_t *entry) {
+    if (!entry) return false;
+    
+    int count = atomic_load(&entry->entry_refcount);
+    while (count > 0) {
+        if (atomic_compare_exchange_weak(&entry->entry_refcount, &count, count + 1)) {
+            return true;
+        }
+    }
+    return false;  /* Retired: a reader found it just before reclamation */
+}
+
+/* Reclaim callback for retired entries */
+static void entry_reclaim(void *ptr) {
+    index_entry_t *entry = ptr;
+    
+    int fd = atomic_load(&entry->fd);
+    if (fd >= 0) {
+        close(fd);
+    }
+    uintptr_t loc = atomic_load(&entry->location);
+    if (loc & LOCATION_ANON) {
+        close(location_fd(loc));
+    } else if (!(loc & LOCATION_ROOTED)) {
+        free((void *)loc);
+    }
+    if (entry->uri != entry->uri_inline) free(entry->uri);
+    slab_free(entry);
+}
+
 void index_entry_put(index_entry_t *entry) {
     if (!entry) return;
     
     int prev = atomic_fetch_sub(&entry->entry_refcount, 1);
     if (prev == 1) {
-        /* Last reference - free entry */
-        int fd = atomic_load(&entry->fd);
-        if (fd >= 0) {
-            close(fd);
-        }
-        free(entry->uri);
-        free(entry->backend_path);
-        free(entry);
+        /* Last reference: lock-free readers may still be traversing it */
+        index_epoch_retire(entry_reclaim, entry);
     }
 }
 
@@ -121,7 +770,9 @@ int index_entry_open_fd(index_entry_t *entry) {
     }
     
     /* Open file */
-    fd = open(entry->backend_path, O_RDONLY);
+    index_epoch_enter();
+    fd = entry_open_readonly(entry);
+    index_epoch_exit();
     if (fd < 0) {
         return -1;
     }
@@ -141,25 +792,63 @@ int index_entry_open_fd(index_entry_t *entry) {
 void index_entry_close_fd(index_entry_t *entry) {
     if (!entry) return;
     
-    /* Only close if no references */
-    int refcount = atomic_load(&entry->fd_refcount);
-    if (refcount > 0) {
-        return;  /* Still in use */
-    }
-    
-    /* Close FD atomically */
+    /* Readers may be between load and dup: defer the close */
     int fd = atomic_exchange(&entry->fd, -1);
     if (fd >= 0) {
-        close(fd);
         atomic_fetch_add(&entry->fd_generation, 1);
+        index_epoch_retire(epoch_close_fd, (void *)(intptr_t)fd);
     }
 }
 
+/* Per-thread access sampling and stripe choice */
+static __thread uint32_t t_access_tick;
+static __thread uint32_t t_access_stripe;   /* Stripe + 1; 0 = unassigned */
+static __thread int t_access_node = -1;
+static atomic_uint g_access_stripe_next;
+
 void index_entry_record_access(index_entry_t *entry) {
     if (!entry) return;
     
-    atomic_fetch_add(&entry->access_count, 1);
-    atomic_store(&entry->last_access, get_monotonic_us());
+    /* Plain loads keep the line shared; only a sample of hits writes it */
+    if (++t_access_tick % INDEX_ACCESS_SAMPLE == 0) {
+        atomic_fetch_add_explicit(&entry->access_count, INDEX_ACCESS_SAMPLE,
+                                  memory_order_relaxed);
+    }
+    
+    uint64_t now = get_monotonic_us();
+    uint64_t last = atomic_load_explicit(&entry->last_access, memory_order_relaxed);
+    if (now - last >= INDEX_ACCESS_GRAIN_US) {
+        atomic_store_explicit(&entry->last_access, now, memory_order_relaxed);
+    }
+    
+    if (t_access_node >= 0) {
+        /* Boyer-Moore majority vote; a settled entry is not written */
+        unsigned old = atomic_load_explicit(&entry->reader_node, memory_order_relaxed);
+        unsigned cand = old & 0xff, votes = old >> 8;
+        unsigned mine = (unsigned)t_access_node + 1;
+        unsigned vote = old;
+        if (cand == mine) {
+            if (votes < INDEX_NODE_VOTES_MAX) vote = cand | (votes + 1) << 8;
+        } else {
+            vote = votes > 1 ? cand | (votes - 1) << 8 : mine | 1 << 8;
+        }
+        if (vote != old) {
+            atomic_store_explicit(&entry->reader_node, vote, memory_order_relaxed);
+        }
+    }
+}
+
+void index_set_thread_node(int node) {
+    t_access_node = (node >= 0 && node < 255) ? node : -1;
+}
+
+int index_entry_reader_node(const index_entry_t *entry, uint32_t *votes_out) {
+    if (!entry) return -1;
+    
+    unsigned vote = atomic_load_explicit(&entry->reader_node, memory_order_relaxed);
+    if ((vote & 0xff) == 0) return -1;
+    if (votes_out) *votes_out = vote >> 8;
+    return (int)(vote & 0xff) - 1;
 }
 
 float index_calculate_hotness(const index_entry_t *entry, uint64_t current_time,
@@ -169,8 +858,9 @@ float index_calculate_hotness(const index_entry_t *entry, uint64_t current_time,
     uint64_t last_access = atomic_load(&entry->last_access);
     if (last_access == 0) return 0.0f;
     
-    /* Time since last access in seconds */
-    uint64_t age_us = current_time - last_access;
+    /* Time since last access in seconds (accesses after current_time count
+     * as now) */
+    uint64_t age_us = current_time > last_access ? current_time - last_access : 0;
     double age_secs = age_us / 1000000.0;
     
     /* Exponential decay: score = exp(-0.693 * age / halflife) */
@@ -188,95 +878,836 @@ float index_calculate_hotness(const index_entry_t *entry, uint64_t current_time,
 }
 
 /* ============================================================================
- * FD Reference Implementation
- * ============================================================================ */
+ * Access Frequency (TinyLFU sketch)
+ * ============================================================================
+ *
+ * Lookups do not touch the sketch directly: each appends the entry's URI
+ * hash to its thread's stripe, and whoever finds a stripe half full applies
+ * all stripes under the sketch lock (trylock, so no lookup ever waits).
+ */
 
-int fd_ref_acquire(fd_ref_t *fd_ref) {
-    if (!fd_ref || !fd_ref->entry) return -1;
+static const uint64_t sketch_seeds[INDEX_SKETCH_DEPTH] = {
+    0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+    0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL,
+};
+
+static int sketch_init(index_sketch_t *sketch, size_t num_buckets) {
+    size_t width = index_next_power_of_2(num_buckets);
+    if (width < INDEX_SKETCH_MIN_WIDTH) width = INDEX_SKETCH_MIN_WIDTH;
+    if (width > INDEX_SKETCH_MAX_WIDTH) width = INDEX_SKETCH_MAX_WIDTH;
+    
+    sketch->row_words = width / 16;
+    sketch->table = calloc(INDEX_SKETCH_DEPTH * sketch->row_words,
+                           sizeof(*sketch->table));
+    if (!sketch->table) return -1;
+    
+    sketch->additions = 0;
+    sketch->age_period = (uint64_t)width * INDEX_SKETCH_AGE_FACTOR;
+    atomic_init(&sketch->agings, 0);
+    pthread_mutex_init(&sketch->lock, NULL);
+    return 0;
+}
+
+static void sketch_destroy(index_sketch_t *sketch) {
+    free(sketch->table);
+    pthread_mutex_destroy(&sketch->lock);
+}
+
+/* Word and nibble shift of the counter for hash in row */
+static inline atomic_uint_fast64_t *sketch_counter(const index_sketch_t *sketch,
+                                                   uint64_t hash, int row,
+                                                   unsigned *shift) {
+    uint64_t x = (hash ^ sketch_seeds[row]) * sketch_seeds[row];
+    x ^= x >> 32;
+    *shift = (unsigned)(x & 15) * 4;
+    return &sketch->table[row * sketch->row_words + ((x >> 4) & (sketch->row_words - 1))];
+}
+
+/* Halve every counter (sketch lock held) */
+static void sketch_age(index_sketch_t *sketch) {
+    size_t words = INDEX_SKETCH_DEPTH * sketch->row_words;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w = atomic_load_explicit(&sketch->table[i], memory_order_relaxed);
+        atomic_store_explicit(&sketch->table[i], (w >> 1) & 0x7777777777777777ULL,
+                              memory_order_relaxed);
+    }
+    sketch->additions /= 2;
+    atomic_fetch_add(&sketch->agings, 1);
+}
+
+/* Count one access (sketch lock held) */
+static void sketch_increment(index_sketch_t *sketch, uint64_t hash) {
+    bool added = false;
+    
+    for (int row = 0; row < INDEX_SKETCH_DEPTH; row++) {
+        unsigned shift;
+        atomic_uint_fast64_t *word = sketch_counter(sketch, hash, row, &shift);
+        uint64_t w = atomic_load_explicit(word, memory_order_relaxed);
+        if (((w >> shift) & 15) < INDEX_FREQ_MAX) {
+            atomic_store_explicit(word, w + (1ULL << shift), memory_order_relaxed);
+            added = true;
+        }
+    }
     
-    index_entry_t *entry = fd_ref->entry;
+    if (added && ++sketch->additions >= sketch->age_period) {
+        sketch_age(sketch);
+    }
+}
+
+static uint32_t sketch_estimate(const index_sketch_t *sketch, uint64_t hash) {
+    uint32_t freq = INDEX_FREQ_MAX;
+    
+    for (int row = 0; row < INDEX_SKETCH_DEPTH; row++) {
+        unsigned shift;
+        atomic_uint_fast64_t *word = sketch_counter(sketch, hash, row, &shift);
+        uint32_t c = (atomic_load_explicit(word, memory_order_relaxed) >> shift) & 15;
+        if (c < freq) freq = c;
+    }
     
-    /* Fast path: FD already open */
-    int fd = atomic_load(&entry->fd);
-    if (fd >= 0) {
-        /* Increment refcount */
-        atomic_fetch_add(&entry->fd_refcount, 1);
+    return freq;
+}
+
+/* Apply all published accesses of every stripe (sketch lock held) */
+static void access_drain_locked(global_index_t *idx) {
+    for (size_t i = 0; i < INDEX_ACCESS_STRIPES; i++) {
+        index_access_stripe_t *stripe = &idx->access_stripes[i];
+        unsigned tail = atomic_load_explicit(&stripe->tail, memory_order_relaxed);
+        unsigned head = atomic_load_explicit(&stripe->head, memory_order_acquire);
         
-        /* Verify FD is still valid */
-        int current_fd = atomic_load(&entry->fd);
-        if (current_fd >= 0) {
-            fd_ref->fd = current_fd;
-            fd_ref->generation = atomic_load(&entry->fd_generation);
-            return current_fd;
+        for (; tail != head; tail++) {
+            atomic_uint_fast64_t *slot = &stripe->slots[tail % INDEX_ACCESS_RING];
+            uint64_t hash = atomic_exchange_explicit(slot, 0, memory_order_acquire);
+            if (hash == 0) break;  /* Reserved but not yet written */
+            sketch_increment(&idx->sketch, hash);
         }
         
-        /* Race: FD closed, retry */
-        atomic_fetch_sub(&entry->fd_refcount, 1);
-    }
-    
-    /* Slow path: Need to open FD */
-    if (index_entry_open_fd(entry) < 0) {
-        return -1;
+        atomic_store_explicit(&stripe->tail, tail, memory_order_release);
     }
-    
-    /* Acquire reference */
-    atomic_fetch_add(&entry->fd_refcount, 1);
-    fd_ref->fd = atomic_load(&entry->fd);
-    fd_ref->generation = atomic_load(&entry->fd_generation);
-    
-    return fd_ref->fd;
 }
 
-void fd_ref_release(fd_ref_t *fd_ref) {
-    if (!fd_ref || !fd_ref->entry) return;
-    
-    index_entry_t *entry = fd_ref->entry;
+/* Lookup hit: sampled entry counters plus a buffered sketch increment */
+static void access_record(global_index_t *idx, index_entry_t *entry) {
+    index_entry_record_access(entry);
     
-    /* Close FD if we have one */
-    if (fd_ref->fd >= 0) {
-        close(fd_ref->fd);
-        /* Decrement FD refcount */
-        atomic_fetch_sub(&entry->fd_refcount, 1);
+    if (t_access_stripe == 0) {
+        t_access_stripe = atomic_fetch_add(&g_access_stripe_next, 1) % INDEX_ACCESS_STRIPES + 1;
     }
+    index_access_stripe_t *stripe = &idx->access_stripes[t_access_stripe - 1];
+    
+    unsigned head = atomic_load_explicit(&stripe->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&stripe->tail, memory_order_acquire);
+    if (head - tail >= INDEX_ACCESS_RING) return;  /* Full: drop */
+    if (!atomic_compare_exchange_strong_explicit(&stripe->head, &head, head + 1,
+                                                 memory_order_relaxed,
+                                                 memory_order_relaxed)) {
+        return;  /* Lost the slot to another thread on this stripe: drop */
+    }
+    atomic_store_explicit(&stripe->slots[head % INDEX_ACCESS_RING], entry->uri_hash | 1,
+                          memory_order_release);
     
-    /* Release entry reference */
-    index_entry_put(entry);
-    
-    fd_ref->entry = NULL;
-    fd_ref->fd = -1;
+    if (head + 1 - tail >= INDEX_ACCESS_RING / 2 &&
+        pthread_mutex_trylock(&idx->sketch.lock) == 0) {
+        access_drain_locked(idx);
+        pthread_mutex_unlock(&idx->sketch.lock);
+    }
 }
 
-int fd_ref_dup(fd_ref_t *fd_ref) {
-    if (!fd_ref || fd_ref->fd < 0) return -1;
+void global_index_drain_accesses(global_index_t *idx) {
+    if (!idx) return;
     
-    return dup(fd_ref->fd);
+    pthread_mutex_lock(&idx->sketch.lock);
+    access_drain_locked(idx);
+    pthread_mutex_unlock(&idx->sketch.lock);
 }
 
-/* ============================================================================
- * Global Index Implementation
- * ============================================================================ */
+uint32_t global_index_frequency(global_index_t *idx, const index_entry_t *entry) {
+    if (!idx || !entry) return 0;
+    return sketch_estimate(&idx->sketch, entry->uri_hash | 1);
+}
 
-global_index_t *global_index_create(size_t num_buckets, size_t max_open_fds) {
-    global_index_t *idx = calloc(1, sizeof(*idx));
-    if (!idx) return NULL;
+float global_index_hotness(global_index_t *idx, const index_entry_t *entry,
+                           uint64_t current_time, uint32_t decay_halflife) {
+    if (!idx || !entry) return 0.0f;
+    
+    uint64_t last_access = atomic_load(&entry->last_access);
+    if (last_access == 0) return 0.0f;
+    
+    uint64_t age_us = current_time > last_access ? current_time - last_access : 0;
+    double time_factor = exp(-0.693 * (age_us / 1000000.0) / decay_halflife);
+    double freq_factor = (double)global_index_frequency(idx, entry) / INDEX_FREQ_MAX;
+    
+    /* Same 70/30 split as index_calculate_hotness() */
+    float hotness = 0.7f * time_factor + 0.3f * freq_factor;
+    return hotness > 1.0f ? 1.0f : hotness;
+}
+
+/* ============================================================================
+ * FD Cache
+ * ============================================================================
+ *
+ * Each entry caches one O_RDONLY descriptor. Lookups hand out dup()s of it,
+ * so the hot path is an atomic load plus dup() with no VFS path walk.
+ *
+ * Closing protocol: the closer swaps entry->fd to -1 and retires the old
+ * number to the epoch domain. Readers load and dup inside an epoch section,
+ * so the descriptor is not close()d - and its number cannot be reused -
+ * until every reader that could have loaded it has left. Neither side
+ * writes a shared counter.
+ *
+ * Eviction is CLOCK (second chance) over an LRU list ordered by open time:
+ * hits only set fd_recent, so lru_lock is never taken on a cache hit.
+ */
+
+/**
+ * Close an entry's cached FD (safe against concurrent readers)
+ */
+static void fd_cache_close(global_index_t *idx, index_entry_t *entry) {
+    int fd = atomic_exchange(&entry->fd, -1);
+    if (fd < 0) return;
+    
+    atomic_fetch_add(&entry->fd_generation, 1);
+    index_epoch_retire(epoch_close_fd, (void *)(intptr_t)fd);
+    
+    if (idx) {
+        atomic_fetch_sub(&idx->num_open_fds, 1);
+        atomic_fetch_add(&idx->stat_fd_closes, 1);
+    }
+}
+
+/* LRU list helpers - caller holds idx->lru_lock */
+
+static void lru_link_head(global_index_t *idx, index_entry_t *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = idx->lru_head;
+    if (idx->lru_head) idx->lru_head->lru_prev = entry;
+    idx->lru_head = entry;
+    if (!idx->lru_tail) idx->lru_tail = entry;
+    entry->lru_linked = 1;
+}
+
+static void lru_unlink(global_index_t *idx, index_entry_t *entry) {
+    if (!entry->lru_linked) return;
+    
+    if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+    else idx->lru_head = entry->lru_next;
+    if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+    else idx->lru_tail = entry->lru_prev;
+    
+    entry->lru_prev = entry->lru_next = NULL;
+    entry->lru_linked = 0;
+}
+
+/**
+ * Evict one cached FD, giving recently hit entries a second chance
+ * Caller holds idx->lru_lock.
+ * 
+ * @return 0 if an FD was evicted, -1 if the list is empty
+ */
+static int lru_evict_one(global_index_t *idx) {
+    size_t budget = 2 * atomic_load(&idx->num_open_fds) + 1;
+    
+    while (idx->lru_tail && budget-- > 0) {
+        index_entry_t *victim = idx->lru_tail;
+        lru_unlink(idx, victim);
+        
+        if (atomic_exchange(&victim->fd_recent, 0) && budget > 0) {
+            lru_link_head(idx, victim);
+            continue;
+        }
+        
+        fd_cache_close(idx, victim);
+        atomic_fetch_add(&idx->stat_fd_evictions, 1);
+        return 0;
+    }
+    
+    return -1;
+}
+
+/**
+ * Drop an entry's cached FD and LRU linkage
+ * 
+ * @param closed Nonzero if the entry is leaving the index (never re-cache)
+ */
+static void fd_cache_drop(global_index_t *idx, index_entry_t *entry, int closed) {
+    pthread_mutex_lock(&idx->lru_lock);
+    if (closed) entry->fd_cache_closed = 1;
+    lru_unlink(idx, entry);
+    fd_cache_close(idx, entry);
+    pthread_mutex_unlock(&idx->lru_lock);
+}
+
+/**
+ * Cache an FD opened at generation gen and return one for the caller
+ * Caller is inside an epoch section.
+ * 
+ * The cache keeps fd and the caller gets a dup; if the entry moved,
+ * was removed or no descriptor is left, fd itself is handed out uncached.
+ */
+static int fd_cache_install(global_index_t *idx, index_entry_t *entry, int fd, int gen) {
+    if (idx->max_open_fds == 0) {
+        return fd;
+    }
+    
+    pthread_mutex_lock(&idx->lru_lock);
+    
+    if (entry->fd_cache_closed || atomic_load(&entry->fd_generation) != gen) {
+        /* Removed or relocated while we were opening: hand out with the
+         * old generation (holders re-acquire), don't cache */
+        pthread_mutex_unlock(&idx->lru_lock);
+        return fd;
+    }
+    
+    int cached = atomic_load(&entry->fd);
+    if (cached >= 0) {
+        /* Lost the race to another opener; their FD is stable under lru_lock */
+        int dup_fd = fcntl(cached, F_DUPFD_CLOEXEC, 0);
+        pthread_mutex_unlock(&idx->lru_lock);
+        close(fd);
+        return dup_fd;
+    }
+    
+    while (atomic_load(&idx->num_open_fds) >= idx->max_open_fds) {
+        if (lru_evict_one(idx) < 0) break;
+    }
+    
+    int dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (dup_fd < 0) {
+        pthread_mutex_unlock(&idx->lru_lock);
+        return fd;  /* Out of FDs: serve uncached */
+    }
+    
+    atomic_store(&entry->fd, fd);
+    atomic_fetch_add(&idx->num_open_fds, 1);
+    lru_link_head(idx, entry);
+    
+    pthread_mutex_unlock(&idx->lru_lock);
+    return dup_fd;
+}
+
+/**
+ * Get a private FD for entry, served from the cache when possible
+ * Caller is inside an epoch section.
+ * 
+ * @param generation Output: entry fd_generation the FD belongs to
+ * @return Private read-only FD (caller closes), or -1 on error
+ */
+static int fd_cache_get(global_index_t *idx, index_entry_t *entry, int *generation,
+                        uint64_t *open_ns) {
+    /* Fast path: dup the cached FD. The generation is loaded first: a
+     * close swaps the FD out before bumping it, so an FD replaced after
+     * this load is tagged stale, never the other way round. */
+    int gen = atomic_load(&entry->fd_generation);
+    int cached = atomic_load(&entry->fd);
+    if (cached >= 0) {
+        *generation = gen;
+        int fd = fcntl(cached, F_DUPFD_CLOEXEC, 0);
+        
+        if (fd >= 0) {
+            if (!atomic_load_explicit(&entry->fd_recent, memory_order_relaxed)) {
+                atomic_store_explicit(&entry->fd_recent, 1, memory_order_relaxed);
+            }
+            atomic_fetch_add(&idx->stat_fd_cache_hits, 1);
+        }
+        return fd;
+    }
+    
+    /* Slow path: open by path and populate the cache. The generation
+     * sampled above lets a concurrent relocation be detected below. */
+    /* A sealed anonymous object needs no cache slot: dup() it directly */
+    if ((entry->flags & INDEX_FLAG_SEALED) && index_entry_anon_fd(entry) >= 0) {
+        *generation = gen;
+        int fd = entry_open_readonly(entry);
+        if (fd >= 0) atomic_fetch_add(&idx->stat_fd_cache_hits, 1);
+        return fd;
+    }
+    
+    struct timespec t0, t1;
+    if (open_ns) clock_gettime(CLOCK_MONOTONIC, &t0);
+    int fd = entry_open_readonly(entry);
+    if (fd < 0) return -1;
+    atomic_fetch_add(&idx->stat_fd_opens, 1);
+    if (open_ns) {
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        *open_ns = (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000ULL +
+                   (uint64_t)t1.tv_nsec - (uint64_t)t0.tv_nsec;
+    }
+    
+    *generation = gen;
+    return fd_cache_install(idx, entry, fd, gen);
+}
+
+/* ============================================================================
+ * FD Reference Implementation
+ * ============================================================================ */
+
+int fd_ref_acquire(fd_ref_t *fd_ref) {
+    if (!fd_ref || !fd_ref->entry) return -1;
+    
+    index_entry_t *entry = fd_ref->entry;
+    
+    if (fd_ref->fd >= 0) {
+        /* Uncached handles (e.g. fresh writers) keep their FD */
+        if (!fd_ref->idx ||
+            fd_ref->generation == atomic_load(&entry->fd_generation)) {
+            return fd_ref->fd;
+        }
+        
+        /* Entry was relocated: the held FD points at the old location */
+        close(fd_ref->fd);
+        fd_ref->fd = -1;
+    }
+    
+    index_epoch_enter();
+    if (fd_ref->idx) {
+        fd_ref->fd = fd_cache_get(fd_ref->idx, entry, &fd_ref->generation, NULL);
+    } else {
+        fd_ref->generation = atomic_load(&entry->fd_generation);
+        fd_ref->fd = entry_open_readonly(entry);
+    }
+    index_epoch_exit();
+    
+    return fd_ref->fd;
+}
+
+void fd_ref_release(fd_ref_t *fd_ref) {
+    if (!fd_ref || !fd_ref->entry) return;
+    
+    /* The handle owns its FD outright */
+    if (fd_ref->fd >= 0) {
+        close(fd_ref->fd);
+    }
+    
+    /* Release entry reference */
+    index_entry_put(fd_ref->entry);
+    
+    fd_ref->entry = NULL;
+    fd_ref->fd = -1;
+    fd_ref->idx = NULL;
+}
+
+int fd_ref_dup(fd_ref_t *fd_ref) {
+    if (!fd_ref || fd_ref->fd < 0) return -1;
+    
+    return dup(fd_ref->fd);
+}
+
+/* ============================================================================
+ * Global Index Implementation
+ * ============================================================================ */
+
+/* Group tags: the low 7 hash bits when full, high bit set otherwise */
+#define TAG_EMPTY   0x80
+#define TAG_DELETED 0xfe
+
+static inline uint8_t hash_tag(uint64_t hash) {
+    return hash & 0x7f;
+}
+
+/* Groups are picked by the hash bits above the tag */
+static inline size_t hash_group(const index_table_t *table, uint64_t hash) {
+    return (hash >> 7) & (table->num_groups - 1);
+}
+
+/*
+ * Tag compares over a whole group. The result has one bit per matching slot
+ * (the slot is ctz >> GROUP_BITS_SHIFT), iterated with GROUP_BITS_NEXT.
+ * Readers load tags while a writer may store one; a stale tag only costs a
+ * miss on a concurrently inserted key, since every match is checked against
+ * the entry published in the slot.
+ */
+#if defined(__SSE2__)
+
+typedef __m128i group_ctrl_t;
+typedef uint32_t group_bits_t;
+#define GROUP_BITS_SHIFT 0
+#define GROUP_BITS_ALL   0xffffu
+
+static inline group_ctrl_t group_load(const index_group_t *group) {
+    return _mm_load_si128((const __m128i *)group->tags);
+}
+
+static inline group_bits_t ctrl_match(group_ctrl_t ctrl, uint8_t tag) {
+    return (group_bits_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+}
+
+static inline group_bits_t ctrl_empty(group_ctrl_t ctrl) {
+    return ctrl_match(ctrl, TAG_EMPTY);
+}
+
+static inline group_bits_t ctrl_free(group_ctrl_t ctrl) {
+    return (group_bits_t)_mm_movemask_epi8(ctrl);  /* High bit: empty or deleted */
+}
+
+#elif defined(__ARM_NEON)
+
+typedef uint8x16_t group_ctrl_t;
+typedef uint64_t group_bits_t;
+#define GROUP_BITS_SHIFT 2
+#define GROUP_BITS_ALL   0x8888888888888888ULL
+
+/* No movemask: narrow each lane to a nibble and keep its top bit */
+static inline group_bits_t neon_bits(uint8x16_t lanes) {
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(lanes), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & GROUP_BITS_ALL;
+}
+
+static inline group_ctrl_t group_load(const index_group_t *group) {
+    return vld1q_u8(group->tags);
+}
+
+static inline group_bits_t ctrl_match(group_ctrl_t ctrl, uint8_t tag) {
+    return neon_bits(vceqq_u8(ctrl, vdupq_n_u8(tag)));
+}
+
+static inline group_bits_t ctrl_empty(group_ctrl_t ctrl) {
+    return ctrl_match(ctrl, TAG_EMPTY);
+}
+
+static inline group_bits_t ctrl_free(group_ctrl_t ctrl) {
+    return neon_bits(vtstq_u8(ctrl, vdupq_n_u8(0x80)));
+}
+
+#else
+
+typedef struct { uint8_t tags[INDEX_GROUP_SLOTS]; } group_ctrl_t;
+typedef uint32_t group_bits_t;
+#define GROUP_BITS_SHIFT 0
+#define GROUP_BITS_ALL   0xffffu
+
+static inline group_ctrl_t group_load(const index_group_t *group) {
+    group_ctrl_t ctrl;
+    for (int i = 0; i < INDEX_GROUP_SLOTS; i++) {
+        ctrl.tags[i] = __atomic_load_n(&group->tags[i], __ATOMIC_RELAXED);
+    }
+    return ctrl;
+}
+
+static inline group_bits_t ctrl_match(group_ctrl_t ctrl, uint8_t tag) {
+    group_bits_t bits = 0;
+    for (int i = 0; i < INDEX_GROUP_SLOTS; i++) {
+        bits |= (group_bits_t)(ctrl.tags[i] == tag) << i;
+    }
+    return bits;
+}
+
+static inline group_bits_t ctrl_empty(group_ctrl_t ctrl) {
+    return ctrl_match(ctrl, TAG_EMPTY);
+}
+
+static inline group_bits_t ctrl_free(group_ctrl_t ctrl) {
+    group_bits_t bits = 0;
+    for (int i = 0; i < INDEX_GROUP_SLOTS; i++) {
+        bits |= (group_bits_t)(ctrl.tags[i] >> 7) << i;
+    }
+    return bits;
+}
+
+#endif
+
+#define GROUP_BITS_NEXT(bits) ((bits) & ((bits) - 1))
+
+static inline unsigned group_bits_slot(group_bits_t bits) {
+    return (unsigned)__builtin_ctzll(bits) >> GROUP_BITS_SHIFT;
+}
+
+static index_table_t *index_table_alloc(index_table_mode_t mode, size_t num_buckets) {
+    if (mode == INDEX_TABLE_GROUPED) {
+        size_t num_groups = num_buckets / INDEX_GROUP_SLOTS;
+        if (num_groups == 0) num_groups = 1;
+        
+        /* One allocation; groups start on a cache line */
+        size_t header = (sizeof(index_table_t) + 63) & ~(size_t)63;
+        void *mem;
+        if (posix_memalign(&mem, 64, header + num_groups * sizeof(index_group_t)) != 0) {
+            return NULL;
+        }
+        
+        index_table_t *table = mem;
+        memset(table, 0, sizeof(*table));
+        table->num_buckets = num_groups * INDEX_GROUP_SLOTS;
+        table->num_groups = num_groups;
+        table->groups = (index_group_t *)((char *)mem + header);
+        for (size_t g = 0; g < num_groups; g++) {
+            memset(table->groups[g].tags, TAG_EMPTY, INDEX_GROUP_SLOTS);
+            for (int s = 0; s < INDEX_GROUP_SLOTS; s++) {
+                atomic_init(&table->groups[g].slots[s], (uintptr_t)NULL);
+            }
+        }
+        return table;
+    }
+    
+    index_table_t *table = calloc(1, sizeof(*table) +
+                                  num_buckets * sizeof(atomic_uintptr_t));
+    if (!table) return NULL;
+    
+    table->num_buckets = num_buckets;
+    for (size_t i = 0; i < num_buckets; i++) {
+        atomic_init(&table->buckets[i], (uintptr_t)NULL);
+    }
+    
+    return table;
+}
+
+static inline index_table_mode_t table_mode(const index_table_t *table) {
+    return table->groups ? INDEX_TABLE_GROUPED : INDEX_TABLE_CHAINED;
+}
+
+static inline index_shard_t *shard_for_hash(global_index_t *idx, uint64_t hash) {
+    return &idx->shards[hash >> (64 - INDEX_SHARD_BITS)];
+}
+
+static inline atomic_uintptr_t *table_bucket(index_table_t *table, uint64_t hash) {
+    return &table->buckets[hash & (table->num_buckets - 1)];
+}
+
+static inline bool entry_matches(const index_entry_t *entry, uint64_t hash,
+                                 const char *uri, size_t len) {
+    return entry->uri_hash == hash && entry->uri_len == len &&
+           memcmp(entry->uri, uri, len) == 0;
+}
+
+/**
+ * Probe a grouped table (lock-free; also used by writers)
+ * Stops at the first group with an empty slot: the key would have been
+ * placed there or earlier.
+ */
+static index_entry_t *group_find(index_table_t *table, uint64_t hash,
+                                 const char *uri, size_t len,
+                                 atomic_uintptr_t **slot_out) {
+    uint8_t tag = hash_tag(hash);
+    size_t g = hash_group(table, hash);
+    
+    for (size_t step = 1; step <= table->num_groups; step++) {
+        index_group_t *group = &table->groups[g];
+        group_ctrl_t ctrl = group_load(group);
+        
+        for (group_bits_t bits = ctrl_match(ctrl, tag); bits; bits = GROUP_BITS_NEXT(bits)) {
+            atomic_uintptr_t *slot = &group->slots[group_bits_slot(bits)];
+            index_entry_t *entry = (index_entry_t *)atomic_load(slot);
+            if (entry && entry_matches(entry, hash, uri, len)) {
+                if (slot_out) *slot_out = slot;
+                return entry;
+            }
+        }
+        
+        if (ctrl_empty(ctrl)) break;
+        g = (g + step) & (table->num_groups - 1);  /* Triangular: visits every group */
+    }
+    
+    return NULL;
+}
+
+/**
+ * Place an entry in the first free slot of its probe sequence (shard lock held)
+ */
+static int group_insert(index_table_t *table, index_entry_t *entry) {
+    size_t g = hash_group(table, entry->uri_hash);
+    
+    for (size_t step = 1; step <= table->num_groups; step++) {
+        index_group_t *group = &table->groups[g];
+        group_bits_t bits = ctrl_free(group_load(group));
+        
+        if (bits) {
+            unsigned s = group_bits_slot(bits);
+            if (group->tags[s] == TAG_EMPTY) table->used_slots++;
+            
+            /* Slot before tag: a reader matching the tag finds the entry */
+            atomic_store(&group->slots[s], (uintptr_t)entry);
+            __atomic_store_n(&group->tags[s], hash_tag(entry->uri_hash), __ATOMIC_RELEASE);
+            return 0;
+        }
+        g = (g + step) & (table->num_groups - 1);
+    }
+    
+    return -1;  /* Full; growth keeps this from happening */
+}
+
+/**
+ * Free the slot holding an entry (shard lock held)
+ * A group that still has an empty slot ends every probe through it, so the
+ * slot can become empty again; otherwise it is left deleted.
+ */
+static void group_clear(index_table_t *table, atomic_uintptr_t *slot) {
+    size_t offset = (size_t)((char *)slot - (char *)table->groups);
+    index_group_t *group = &table->groups[offset / sizeof(index_group_t)];
+    unsigned s = (unsigned)(slot - group->slots);
+    
+    uint8_t tag = TAG_DELETED;
+    if (ctrl_empty(group_load(group))) {
+        tag = TAG_EMPTY;
+        table->used_slots--;
+    }
+    __atomic_store_n(&group->tags[s], tag, __ATOMIC_RELEASE);
+    atomic_store(slot, (uintptr_t)NULL);
+}
+
+/**
+ * Find an entry in one table
+ * Fills link with the chain link or group slot pointing at it.
+ */
+static index_entry_t *table_find(index_table_t *table, uint64_t hash,
+                                 const char *uri, size_t len,
+                                 atomic_uintptr_t **link_out) {
+    if (table->groups) {
+        return group_find(table, hash, uri, len, link_out);
+    }
+    
+    atomic_uintptr_t *link = table_bucket(table, hash);
+    index_entry_t *entry;
+    
+    while ((entry = (index_entry_t *)atomic_load(link)) != NULL) {
+        if (entry_matches(entry, hash, uri, len)) {
+            if (link_out) *link_out = link;
+            return entry;
+        }
+        link = &entry->next;
+    }
+    
+    return NULL;
+}
+
+/* Move every entry of one old group into the current table */
+static void group_move(index_table_t *table, index_group_t *group) {
+    for (int s = 0; s < INDEX_GROUP_SLOTS; s++) {
+        if (group->tags[s] & 0x80) continue;
+        
+        index_entry_t *entry = (index_entry_t *)atomic_load(&group->slots[s]);
+        if (group_insert(table, entry) != 0) continue;  /* Stays reachable here */
+        
+        __atomic_store_n(&group->tags[s], TAG_DELETED, __ATOMIC_RELEASE);
+        atomic_store(&group->slots[s], (uintptr_t)NULL);
+    }
+}
+
+/**
+ * Move up to INDEX_REHASH_STEP buckets from the old table (shard lock held)
+ */
+static void shard_rehash_step(index_shard_t *shard) {
+    index_table_t *old = (index_table_t *)atomic_load(&shard->old_table);
+    if (!old) return;
+    
+    index_table_t *table = (index_table_t *)atomic_load(&shard->table);
+    size_t units = old->groups ? old->num_groups : old->num_buckets;
+    
+    for (int step = 0; step < INDEX_REHASH_STEP && shard->rehash_pos < units; step++) {
+        if (old->groups) {
+            index_group_t *group = &old->groups[shard->rehash_pos++];
+            if (ctrl_free(group_load(group)) == GROUP_BITS_ALL) continue;  /* No entries */
+            
+            atomic_fetch_add(&shard->resize_seq, 1);  /* Odd: readers may miss */
+            group_move(table, group);
+            atomic_fetch_add(&shard->resize_seq, 1);
+            continue;
+        }
+        
+        atomic_uintptr_t *src = &old->buckets[shard->rehash_pos++];
+        if (!atomic_load(src)) continue;
+        
+        atomic_fetch_add(&shard->resize_seq, 1);  /* Odd: readers may be misled */
+        
+        index_entry_t *entry;
+        while ((entry = (index_entry_t *)atomic_load(src)) != NULL) {
+            atomic_store(src, atomic_load(&entry->next));
+            
+            atomic_uintptr_t *dst = table_bucket(table, entry->uri_hash);
+            atomic_store(&entry->next, atomic_load(dst));
+            atomic_store(dst, (uintptr_t)entry);
+        }
+        
+        atomic_fetch_add(&shard->resize_seq, 1);
+    }
+    
+    if (shard->rehash_pos == units) {
+        /* Readers may still be walking the old bucket array */
+        atomic_store(&shard->old_table, (uintptr_t)NULL);
+        index_epoch_retire(free, old);
+    }
+}
+
+/**
+ * Start growing a shard that exceeds the load factor (shard lock held)
+ */
+static void shard_maybe_grow(global_index_t *idx, index_shard_t *shard) {
+    if (atomic_load(&shard->old_table)) return;  /* Already resizing */
+    
+    index_table_t *table = (index_table_t *)atomic_load(&shard->table);
+    size_t num_buckets = table->num_buckets * 2;
+    
+    if (table->groups) {
+        /* Deleted slots count: they lengthen probes until a rebuild */
+        if (table->used_slots * 8 <= table->num_buckets * INDEX_GROUP_MAX_LOAD) return;
+        if (atomic_load(&shard->num_entries) * 2 < table->num_buckets) {
+            num_buckets = table->num_buckets;  /* Mostly deleted: rebuild in place */
+        }
+    } else if (atomic_load(&shard->num_entries) <= table->num_buckets * INDEX_MAX_LOAD_FACTOR) {
+        return;
+    }
+    
+    index_table_t *bigger = index_table_alloc(table_mode(table), num_buckets);
+    if (!bigger) return;  /* Keep running with longer chains */
+    
+    /* Publish old first so readers that see the new table also search it */
+    shard->rehash_pos = 0;
+    atomic_store(&shard->old_table, (uintptr_t)table);
+    atomic_store(&shard->table, (uintptr_t)bigger);
+    atomic_fetch_add(&idx->stat_resizes, 1);
+}
+
+/**
+ * Find an entry in either table (shard lock held)
+ */
+static index_entry_t *shard_find(index_shard_t *shard, uint64_t hash,
+                                 const char *uri, size_t len,
+                                 index_table_t **table_out, atomic_uintptr_t **link_out) {
+    index_table_t *tables[2] = {
+        (index_table_t *)atomic_load(&shard->table),
+        (index_table_t *)atomic_load(&shard->old_table)
+    };
+    
+    for (int t = 0; t < 2 && tables[t]; t++) {
+        index_entry_t *entry = table_find(tables[t], hash, uri, len, link_out);
+        if (entry) {
+            if (table_out) *table_out = tables[t];
+            return entry;
+        }
+    }
+    
+    return NULL;
+}
+
+global_index_t *global_index_create_mode(size_t num_buckets, size_t max_open_fds,
+                                         index_table_mode_t mode) {
+    global_index_t *idx = calloc(1, sizeof(*idx));
+    if (!idx) return NULL;
     
-    /* Round to power of 2 */
-    idx->num_buckets = index_next_power_of_2(num_buckets);
     idx->max_open_fds = max_open_fds;
     
-    /* Allocate buckets */
-    idx->buckets = calloc(idx->num_buckets, sizeof(atomic_uintptr_t));
-    if (!idx->buckets) {
-        free(idx);
-        return NULL;
+    /* Split the initial buckets across shards (power of 2 each) */
+    size_t shard_buckets = index_next_power_of_2(num_buckets / INDEX_NUM_SHARDS);
+    if (shard_buckets < INDEX_MIN_SHARD_BUCKETS) {
+        shard_buckets = INDEX_MIN_SHARD_BUCKETS;
     }
     
-    /* Initialize atomics */
-    for (size_t i = 0; i < idx->num_buckets; i++) {
-        atomic_init(&idx->buckets[i], (uintptr_t)NULL);
+    for (size_t i = 0; i < INDEX_NUM_SHARDS; i++) {
+        index_shard_t *shard = &idx->shards[i];
+        
+        index_table_t *table = index_table_alloc(mode, shard_buckets);
+        if (!table) {
+            for (size_t j = 0; j < i; j++) {
+                free((void *)atomic_load(&idx->shards[j].table));
+                pthread_mutex_destroy(&idx->shards[j].write_lock);
+            }
+            free(idx);
+            return NULL;
+        }
+        
+        atomic_init(&shard->table, (uintptr_t)table);
+        atomic_init(&shard->old_table, (uintptr_t)NULL);
+        atomic_init(&shard->resize_seq, 0);
+        atomic_init(&shard->num_entries, 0);
+        pthread_mutex_init(&shard->write_lock, NULL);
     }
     
-    atomic_init(&idx->num_entries, 0);
     atomic_init(&idx->num_open_fds, 0);
     atomic_init(&idx->stat_lookups, 0);
     atomic_init(&idx->stat_hits, 0);
@@ -285,30 +1716,128 @@ global_index_t *global_index_create(size_t num_buckets, size_t max_open_fds) {
     atomic_init(&idx->stat_fd_opens, 0);
     atomic_init(&idx->stat_fd_closes, 0);
     atomic_init(&idx->stat_fd_evictions, 0);
+    atomic_init(&idx->stat_resizes, 0);
+    for (size_t i = 0; i < INDEX_MAX_ROOTS; i++) {
+        atomic_init(&idx->roots[i], 0);
+    }
     
-    pthread_mutex_init(&idx->write_lock, NULL);
     pthread_mutex_init(&idx->lru_lock, NULL);
     
+    idx->access_stripes = aligned_alloc(64, INDEX_ACCESS_STRIPES * sizeof(index_access_stripe_t));
+    if (!idx->access_stripes || sketch_init(&idx->sketch, num_buckets) < 0 ||
+        index_prefix_init(&idx->prefix) < 0) {
+        free(idx->access_stripes);
+        idx->access_stripes = NULL;
+        global_index_destroy(idx);
+        return NULL;
+    }
+    for (size_t i = 0; i < INDEX_ACCESS_STRIPES; i++) {
+        index_access_stripe_t *stripe = &idx->access_stripes[i];
+        atomic_init(&stripe->head, 0);
+        atomic_init(&stripe->tail, 0);
+        for (size_t j = 0; j < INDEX_ACCESS_RING; j++) {
+            atomic_init(&stripe->slots[j], 0);
+        }
+    }
+    
     return idx;
 }
 
+global_index_t *global_index_create(size_t num_buckets, size_t max_open_fds) {
+    return global_index_create_mode(num_buckets, max_open_fds, INDEX_TABLE_GROUPED);
+}
+
 void global_index_destroy(global_index_t *idx) {
     if (!idx) return;
     
     /* Close all FDs and free entries */
-    for (size_t i = 0; i < idx->num_buckets; i++) {
-        index_entry_t *entry = (index_entry_t *)atomic_load(&idx->buckets[i]);
-        while (entry) {
-            index_entry_t *next = (index_entry_t *)atomic_load(&entry->next);
-            index_entry_put(entry);
-            entry = next;
+    for (size_t i = 0; i < INDEX_NUM_SHARDS; i++) {
+        index_shard_t *shard = &idx->shards[i];
+        index_table_t *tables[2] = {
+            (index_table_t *)atomic_load(&shard->table),
+            (index_table_t *)atomic_load(&shard->old_table)
+        };
+        
+        for (int t = 0; t < 2; t++) {
+            if (!tables[t]) continue;
+            for (size_t g = 0; g < tables[t]->num_groups; g++) {
+                index_group_t *group = &tables[t]->groups[g];
+                for (int s = 0; s < INDEX_GROUP_SLOTS; s++) {
+                    if (group->tags[s] & 0x80) continue;
+                    index_entry_put((index_entry_t *)atomic_load(&group->slots[s]));
+                }
+            }
+            for (size_t b = 0; !tables[t]->groups && b < tables[t]->num_buckets; b++) {
+                index_entry_t *entry = (index_entry_t *)atomic_load(&tables[t]->buckets[b]);
+                while (entry) {
+                    index_entry_t *next = (index_entry_t *)atomic_load(&entry->next);
+                    index_entry_put(entry);
+                    entry = next;
+                }
+            }
+            free(tables[t]);
         }
+        
+        pthread_mutex_destroy(&shard->write_lock);
     }
     
-    free(idx->buckets);
-    pthread_mutex_destroy(&idx->write_lock);
     pthread_mutex_destroy(&idx->lru_lock);
+    if (idx->access_stripes) {
+        free(idx->access_stripes);
+        sketch_destroy(&idx->sketch);
+    }
+    index_prefix_destroy(&idx->prefix);
     free(idx);
+    
+    /* Drain retired entries, tables and FDs */
+    index_epoch_synchronize();
+}
+
+/**
+ * Find entry without taking a reference
+ * Caller is inside an epoch section; the entry may already be retired.
+ */
+static index_entry_t *global_index_find_unlocked(global_index_t *idx, const char *uri) {
+    size_t len = strlen(uri);
+    uint64_t hash = index_hash_bytes(uri, len);
+    index_shard_t *shard = shard_for_hash(idx, hash);
+    
+    /* Lock-free read; a miss that overlapped a rehash move is retried */
+    for (;;) {
+        unsigned seq = atomic_load(&shard->resize_seq);
+        
+        index_table_t *table = (index_table_t *)atomic_load(&shard->table);
+        index_entry_t *entry = table_find(table, hash, uri, len, NULL);
+        
+        if (!entry) {
+            index_table_t *old = (index_table_t *)atomic_load(&shard->old_table);
+            if (old) {
+                entry = table_find(old, hash, uri, len, NULL);
+            }
+        }
+        
+        if (entry) {
+            return entry;
+        }
+        
+        if (!(seq & 1) && atomic_load(&shard->resize_seq) == seq) {
+            return NULL;
+        }
+        sched_yield();
+    }
+}
+
+/**
+ * Find entry and take a reference (caller releases)
+ */
+static index_entry_t *global_index_find(global_index_t *idx, const char *uri) {
+    index_epoch_enter();
+    index_entry_t *entry = global_index_find_unlocked(idx, uri);
+    if (entry && !index_entry_tryget(entry)) {
+        entry = NULL;  /* Being removed: treat as a miss */
+    }
+    index_epoch_exit();
+    return entry;
 }
 
 int global_index_lookup(global_index_t *idx, const char *uri, fd_ref_t *fd_ref) {
@@ -316,122 +1845,224 @@ int global_index_lookup(global_index_t *idx, const char *uri, fd_ref_t *fd_ref)
     
     atomic_fetch_add(&idx->stat_lookups, 1);
     
-    uint64_t hash = index_hash_string(uri);
-    size_t bucket = hash & (idx->num_buckets - 1);
+    index_entry_t *entry = global_index_find(idx, uri);
+    if (!entry) {
+        atomic_fetch_add(&idx->stat_misses, 1);
+        return -1;
+    }
     
-    /* Lock-free read using atomic load */
-    index_entry_t *entry = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
+    /* Prepare FD reference with a private dup of the cached FD */
+    fd_ref->entry = entry;
+    fd_ref->idx = idx;
+    index_epoch_enter();
+    fd_ref->fd = fd_cache_get(idx, entry, &fd_ref->generation, NULL);
+    index_epoch_exit();
     
-    while (entry) {
-        if (entry->uri_hash == hash && strcmp(entry->uri, uri) == 0) {
-            /* Found! Acquire entry reference */
-            index_entry_get(entry);
-            
-            /* Open FD if not already open */
-            int fd = -1;
-            if (entry->backend_path) {
-                fd = open(entry->backend_path, O_RDWR);
-                if (fd < 0) {
-                    /* Try read-only if read-write fails */
-                    fd = open(entry->backend_path, O_RDONLY);
-                }
-            }
-            
-            /* Prepare FD reference */
-            fd_ref->entry = entry;
-            fd_ref->fd = fd;
-            fd_ref->generation = 0;
-            
-            /* Record access */
-            index_entry_record_access(entry);
-            
-            /* Increment FD refcount if we opened it */
-            if (fd >= 0) {
-                atomic_fetch_add(&entry->fd_refcount, 1);
-            }
-            
-            atomic_fetch_add(&idx->stat_hits, 1);
-            return 0;
-        }
-        
-        entry = (index_entry_t *)atomic_load(&entry->next);
+    /* Record access */
+    access_record(idx, entry);
+    
+    atomic_fetch_add(&idx->stat_hits, 1);
+    return 0;
+}
+
+int global_index_lookup_fd(global_index_t *idx, const char *uri,
+                           index_entry_info_t *info_out) {
+    if (!idx || !uri) return -1;
+    
+    atomic_fetch_add(&idx->stat_lookups, 1);
+    
+    /* The epoch section keeps the entry alive: no refcount traffic */
+    index_epoch_enter();
+    
+    index_entry_t *entry = global_index_find_unlocked(idx, uri);
+    if (!entry) {
+        index_epoch_exit();
+        atomic_fetch_add(&idx->stat_misses, 1);
+        return -1;
     }
     
-    atomic_fetch_add(&idx->stat_misses, 1);
-    return -1;
+    int generation;
+    uint64_t open_ns = 0;
+    int fd = fd_cache_get(idx, entry, &generation, info_out ? &open_ns : NULL);
+    
+    if (info_out) {
+        info_out->backend_id = __atomic_load_n(&entry->backend_id, __ATOMIC_RELAXED);
+        info_out->size_bytes = entry->size_bytes;
+        info_out->mtime = entry->mtime;
+        info_out->flags = entry->flags;
+        info_out->generation = generation;
+        info_out->open_ns = open_ns;
+    }
+    access_record(idx, entry);
+    
+    index_epoch_exit();
+    
+    atomic_fetch_add(&idx->stat_hits, 1);
+    return fd;
+}
+
+int global_index_lookup_info(global_index_t *idx, const char *uri,
+                             index_entry_info_t *info_out) {
+    if (!idx || !uri || !info_out) return -1;
+    
+    atomic_fetch_add(&idx->stat_lookups, 1);
+    
+    index_epoch_enter();
+    
+    index_entry_t *entry = global_index_find_unlocked(idx, uri);
+    if (!entry) {
+        index_epoch_exit();
+        atomic_fetch_add(&idx->stat_misses, 1);
+        return -1;
+    }
+    
+    *info_out = (index_entry_info_t){
+        .backend_id = __atomic_load_n(&entry->backend_id, __ATOMIC_RELAXED),
+        .size_bytes = entry->size_bytes,
+        .mtime = entry->mtime,
+        .flags = entry->flags,
+    };
+    
+    index_epoch_exit();
+    
+    atomic_fetch_add(&idx->stat_hits, 1);
+    return 0;
+}
+
+int global_index_adopt_fd(global_index_t *idx, index_entry_t *entry, int fd,
+                          int generation, index_entry_info_t *info_out) {
+    if (!idx || !entry || fd < 0) return -1;
+    
+    atomic_fetch_add(&idx->stat_lookups, 1);
+    atomic_fetch_add(&idx->stat_fd_opens, 1);
+    
+    index_epoch_enter();
+    int out = fd_cache_install(idx, entry, fd, generation);
+    
+    if (info_out) {
+        info_out->backend_id = __atomic_load_n(&entry->backend_id, __ATOMIC_RELAXED);
+        info_out->size_bytes = entry->size_bytes;
+        info_out->mtime = entry->mtime;
+        info_out->flags = entry->flags;
+        info_out->generation = generation;
+    }
+    access_record(idx, entry);
+    
+    index_epoch_exit();
+    
+    atomic_fetch_add(&idx->stat_hits, 1);
+    return out;
+}
+
+index_entry_t *global_index_get_entry(global_index_t *idx, const char *uri) {
+    if (!idx || !uri) return NULL;
+    return global_index_find(idx, uri);
 }
 
 int global_index_insert(global_index_t *idx, index_entry_t *entry) {
     if (!idx || !entry) return -1;
     
-    /* Serialize writers */
-    pthread_mutex_lock(&idx->write_lock);
+    entry_adopt_root(idx, entry);
     
-    size_t bucket = entry->uri_hash & (idx->num_buckets - 1);
+    index_shard_t *shard = shard_for_hash(idx, entry->uri_hash);
+    
+    /* Serialize writers on this shard */
+    pthread_mutex_lock(&shard->write_lock);
+    
+    shard_rehash_step(shard);
     
     /* Check for duplicate */
-    index_entry_t *existing = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
-    while (existing) {
-        if (existing->uri_hash == entry->uri_hash && 
-            strcmp(existing->uri, entry->uri) == 0) {
-            pthread_mutex_unlock(&idx->write_lock);
-            return -1;  /* Duplicate */
-        }
-        existing = (index_entry_t *)atomic_load(&existing->next);
+    if (shard_find(shard, entry->uri_hash, entry->uri, entry->uri_len, NULL, NULL)) {
+        pthread_mutex_unlock(&shard->write_lock);
+        return -1;  /* Duplicate */
     }
     
-    /* Insert at head of collision chain */
-    index_entry_t *old_head = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
-    atomic_store(&entry->next, (uintptr_t)old_head);
+    /* Ordered alongside (under the shard lock, so per-URI order holds);
+     * a URI listed from a backend image is already there */
+    int listed = index_prefix_add(&idx->prefix, entry->uri, entry->uri_len,
+                                  entry->uri_hash);
+    if (listed < 0) {
+        pthread_mutex_unlock(&shard->write_lock);
+        return -1;
+    }
     
-    /* Atomic pointer update (becomes visible to readers) */
-    atomic_store(&idx->buckets[bucket], (uintptr_t)entry);
+    index_table_t *table = (index_table_t *)atomic_load(&shard->table);
+    if (table->groups) {
+        if (group_insert(table, entry) != 0) {
+            if (listed) {
+                index_prefix_remove(&idx->prefix, entry->uri, entry->uri_len,
+                                    entry->uri_hash);
+            }
+            pthread_mutex_unlock(&shard->write_lock);
+            return -1;
+        }
+    } else {
+        /* Insert at head of collision chain in the current table */
+        atomic_uintptr_t *head = table_bucket(table, entry->uri_hash);
+        atomic_store(&entry->next, atomic_load(head));
+        
+        /* Atomic pointer update (becomes visible to readers) */
+        atomic_store(head, (uintptr_t)entry);
+    }
     
-    atomic_fetch_add(&idx->num_entries, 1);
+    atomic_fetch_add(&shard->num_entries, 1);
+    shard_maybe_grow(idx, shard);
     
-    pthread_mutex_unlock(&idx->write_lock);
+    pthread_mutex_unlock(&shard->write_lock);
     return 0;
 }
 
 int global_index_remove(global_index_t *idx, const char *uri) {
     if (!idx || !uri) return -1;
     
-    pthread_mutex_lock(&idx->write_lock);
+    size_t len = strlen(uri);
+    uint64_t hash = index_hash_bytes(uri, len);
+    index_shard_t *shard = shard_for_hash(idx, hash);
     
-    uint64_t hash = index_hash_string(uri);
-    size_t bucket = hash & (idx->num_buckets - 1);
+    pthread_mutex_lock(&shard->write_lock);
     
-    atomic_uintptr_t *prev_next = &idx->buckets[bucket];
-    index_entry_t *entry = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
+    shard_rehash_step(shard);
     
-    while (entry) {
-        if (entry->uri_hash == hash && strcmp(entry->uri, uri) == 0) {
-            /* Unlink from chain */
-            index_entry_t *next = (index_entry_t *)atomic_load(&entry->next);
-            atomic_store(prev_next, (uintptr_t)next);
-            
-            /* Close FD if open */
-            int fd = atomic_exchange(&entry->fd, -1);
-            if (fd >= 0) {
-                close(fd);
-                atomic_fetch_sub(&idx->num_open_fds, 1);
-            }
-            
-            /* Release entry (will be freed when refcount reaches 0) */
-            index_entry_put(entry);
-            
-            atomic_fetch_sub(&idx->num_entries, 1);
-            
-            pthread_mutex_unlock(&idx->write_lock);
-            return 0;
-        }
-        
-        prev_next = &entry->next;
-        entry = (index_entry_t *)atomic_load(&entry->next);
+    index_table_t *table;
+    atomic_uintptr_t *link;
+    index_entry_t *entry = shard_find(shard, hash, uri, len, &table, &link);
+    if (!entry) {
+        pthread_mutex_unlock(&shard->write_lock);
+        return -1;
     }
     
-    pthread_mutex_unlock(&idx->write_lock);
-    return -1;
+    /* Unlink from chain or free the group slot */
+    if (table->groups) {
+        group_clear(table, link);
+    } else {
+        atomic_store(link, atomic_load(&entry->next));
+    }
+    
+    index_prefix_remove(&idx->prefix, uri, len, hash);
+    
+    /* Close cached FD; in-flight lookups will not re-cache it */
+    fd_cache_drop(idx, entry, 1);
+    
+    /* Release entry (will be freed when refcount reaches 0) */
+    index_entry_put(entry);
+    
+    atomic_fetch_sub(&shard->num_entries, 1);
+    
+    pthread_mutex_unlock(&shard->write_lock);
+    return 0;
+}
+
+/* Publish new_loc for entry; lock-free openers may hold the old one */
+static void entry_relocate(global_index_t *idx, index_entry_t *entry,
+                           uint32_t backend_id, uintptr_t new_loc) {
+    uintptr_t old_loc = atomic_exchange(&entry->location, new_loc);
+    __atomic_store_n(&entry->backend_id, backend_id, __ATOMIC_RELAXED);
+    location_retire(old_loc);
+    
+    /* Bump the generation before dropping the FD so an opener that read
+     * the old path cannot cache it; held refs re-acquire */
+    atomic_fetch_add(&entry->fd_generation, 1);
+    fd_cache_drop(idx, entry, 0);
 }
 
 int global_index_update_backend(global_index_t *idx, const char *uri,
@@ -439,27 +2070,38 @@ int global_index_update_backend(global_index_t *idx, const char *uri,
     if (!idx || !uri || !backend_path) return -1;
     
     /* Lookup entry */
-    fd_ref_t ref;
-    if (global_index_lookup(idx, uri, &ref) < 0) {
+    index_entry_t *entry = global_index_find(idx, uri);
+    if (!entry) {
         return -1;
     }
     
-    index_entry_t *entry = ref.entry;
-    
-    /* Close old FD */
-    int fd = atomic_exchange(&entry->fd, -1);
-    if (fd >= 0) {
-        close(fd);
-        atomic_fetch_sub(&idx->num_open_fds, 1);
-        atomic_fetch_add(&entry->fd_generation, 1);
+    uintptr_t new_loc = root_location(idx, backend_id, uri, backend_path);
+    if (!new_loc) {
+        char *new_path = strdup(backend_path);
+        if (!new_path) {
+            index_entry_put(entry);
+            return -1;
+        }
+        new_loc = (uintptr_t)new_path;
     }
     
-    /* Update backend info */
-    free(entry->backend_path);
-    entry->backend_path = strdup(backend_path);
-    entry->backend_id = backend_id;
+    entry_relocate(idx, entry, backend_id, new_loc);
+    index_entry_put(entry);
+    
+    return 0;
+}
+
+int global_index_update_backend_anon(global_index_t *idx, const char *uri,
+                                     uint32_t backend_id, int fd) {
+    if (!idx || !uri || fd < 0) return -1;
+    
+    index_entry_t *entry = global_index_find(idx, uri);
+    if (!entry) {
+        return -1;
+    }
     
-    fd_ref_release(&ref);
+    entry_relocate(idx, entry, backend_id, anon_location(fd));
+    index_entry_put(entry);
     
     return 0;
 }
@@ -467,7 +2109,15 @@ int global_index_update_backend(global_index_t *idx, const char *uri,
 void global_index_get_stats(global_index_t *idx, index_stats_t *stats) {
     if (!idx || !stats) return;
     
-    stats->num_entries = atomic_load(&idx->num_entries);
+    stats->num_entries = 0;
+    stats->num_buckets = 0;
+    for (size_t i = 0; i < INDEX_NUM_SHARDS; i++) {
+        index_shard_t *shard = &idx->shards[i];
+        index_table_t *table = (index_table_t *)atomic_load(&shard->table);
+        stats->num_entries += atomic_load(&shard->num_entries);
+        stats->num_buckets += table->num_buckets;
+    }
+    stats->num_resizes = atomic_load(&idx->stat_resizes);
     stats->num_open_fds = atomic_load(&idx->num_open_fds);
     stats->lookups = atomic_load(&idx->stat_lookups);
     stats->hits = atomic_load(&idx->stat_hits);
@@ -476,11 +2126,13 @@ void global_index_get_stats(global_index_t *idx, index_stats_t *stats) {
     stats->fd_opens = atomic_load(&idx->stat_fd_opens);
     stats->fd_closes = atomic_load(&idx->stat_fd_closes);
     stats->fd_evictions = atomic_load(&idx->stat_fd_evictions);
+    stats->sketch_agings = atomic_load(&idx->sketch.agings);
     
     stats->hit_rate = stats->lookups > 0 ? 
         (double)stats->hits / stats->lookups : 0.0;
-    stats->fd_cache_rate = stats->fd_opens > 0 ?
-        (double)stats->fd_cache_hits / stats->fd_opens : 0.0;
+    uint64_t fd_requests = stats->fd_cache_hits + stats->fd_opens;
+    stats->fd_cache_rate = fd_requests > 0 ?
+        (double)stats->fd_cache_hits / fd_requests : 0.0;
 }
 
 /* ============================================================================
@@ -530,7 +2182,7 @@ void backend_index_destroy(backend_index_t *idx) {
     for (size_t i = 0; i < idx->num_buckets; i++) {
         index_entry_t *entry = (index_entry_t *)atomic_load(&idx->buckets[i]);
         while (entry) {
-            index_entry_t *next = (index_entry_t *)atomic_load(&entry->next);
+            index_entry_t *next = (index_entry_t *)atomic_load(&entry->backend_next);
             index_entry_put(entry);
             entry = next;
         }
@@ -554,354 +2206,1323 @@ int backend_index_insert(backend_index_t *idx, index_entry_t *entry) {
     
     /* Insert at head */
     index_entry_t *old_head = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
-    atomic_store(&entry->next, (uintptr_t)old_head);
+    atomic_store(&entry->backend_next, (uintptr_t)old_head);
     atomic_store(&idx->buckets[bucket], (uintptr_t)entry);
     
-    atomic_fetch_add(&idx->num_entries, 1);
-    atomic_store(&idx->dirty, 1);
+    atomic_fetch_add(&idx->num_entries, 1);
+    atomic_store(&idx->dirty, 1);
+    
+    pthread_mutex_unlock(&idx->write_lock);
+    return 0;
+}
+
+size_t backend_index_insert_bulk(backend_index_t *idx, index_entry_t **entries,
+                                 size_t count) {
+    if (!idx || !entries || count == 0) return 0;
+    
+    pthread_mutex_lock(&idx->write_lock);
+    
+    for (size_t i = 0; i < count; i++) {
+        index_entry_t *entry = entries[i];
+        size_t bucket = entry->uri_hash & (idx->num_buckets - 1);
+        
+        index_entry_get(entry);
+        atomic_store(&entry->backend_next, atomic_load(&idx->buckets[bucket]));
+        atomic_store(&idx->buckets[bucket], (uintptr_t)entry);
+    }
+    
+    atomic_fetch_add(&idx->num_entries, count);
+    atomic_store(&idx->dirty, 1);
+    
+    pthread_mutex_unlock(&idx->write_lock);
+    return count;
+}
+
+index_entry_t *backend_index_lookup(backend_index_t *idx, const char *uri) {
+    if (!idx || !uri) return NULL;
+    
+    atomic_fetch_add(&idx->stat_lookups, 1);
+    
+    uint64_t hash = index_hash_string(uri);
+    size_t bucket = hash & (idx->num_buckets - 1);
+    
+    index_epoch_enter();
+    index_entry_t *entry = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
+    
+    while (entry) {
+        if (entry->uri_hash == hash && strcmp(entry->uri, uri) == 0) {
+            atomic_fetch_add(&idx->stat_hits, 1);
+            break;
+        }
+        entry = (index_entry_t *)atomic_load(&entry->backend_next);
+    }
+    index_epoch_exit();
+    
+    return entry;
+}
+
+int backend_index_remove(backend_index_t *idx, const char *uri) {
+    if (!idx || !uri) return -1;
+    
+    pthread_mutex_lock(&idx->write_lock);
+    
+    uint64_t hash = index_hash_string(uri);
+    size_t bucket = hash & (idx->num_buckets - 1);
+    
+    atomic_uintptr_t *prev_next = &idx->buckets[bucket];
+    index_entry_t *entry = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
+    
+    while (entry) {
+        if (entry->uri_hash == hash && strcmp(entry->uri, uri) == 0) {
+            index_entry_t *next = (index_entry_t *)atomic_load(&entry->backend_next);
+            atomic_store(prev_next, (uintptr_t)next);
+            
+            index_entry_put(entry);
+            atomic_fetch_sub(&idx->num_entries, 1);
+            atomic_store(&idx->dirty, 1);
+            
+            pthread_mutex_unlock(&idx->write_lock);
+            return 0;
+        }
+        
+        prev_next = &entry->backend_next;
+        entry = (index_entry_t *)atomic_load(&entry->backend_next);
+    }
+    
+    pthread_mutex_unlock(&idx->write_lock);
+    return -1;
+}
+
+size_t backend_index_collect(backend_index_t *idx, size_t *cursor,
+                             index_entry_t **entries_out, size_t max_entries) {
+    if (!idx || !cursor || !entries_out || max_entries == 0) return 0;
+    
+    size_t count = 0;
+    size_t bucket = *cursor < idx->num_buckets ? *cursor : 0;
+    
+    /* Writers unlink and put under write_lock, so holding it keeps the
+     * chains and the entries on them alive while we take references */
+    pthread_mutex_lock(&idx->write_lock);
+    
+    while (bucket < idx->num_buckets) {
+        index_entry_t *head = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
+        
+        size_t len = 0;
+        for (index_entry_t *e = head; e; e = (index_entry_t *)atomic_load(&e->backend_next)) {
+            len++;
+        }
+        
+        /* Leave a bucket that does not fit for the next batch */
+        if (count > 0 && count + len > max_entries) break;
+        
+        for (index_entry_t *e = head; e && count < max_entries;
+             e = (index_entry_t *)atomic_load(&e->backend_next)) {
+            index_entry_get(e);
+            entries_out[count++] = e;
+        }
+        
+        bucket++;
+        if (count == max_entries) break;
+    }
+    
+    pthread_mutex_unlock(&idx->write_lock);
+    
+    *cursor = bucket < idx->num_buckets ? bucket : 0;
+    return count;
+}
+
+/* ============================================================================
+ * Persistent Index Image
+ * ============================================================================ */
+
+#define INDEX_BYTE_ORDER  0x01020304u
+
+_Static_assert(sizeof(index_image_slot_t) == 64, "image slot must be one cache line");
+
+static uint32_t crc32_table[256];
+static pthread_once_t crc32_once = PTHREAD_ONCE_INIT;
+
+static void crc32_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        crc32_table[i] = c;
+    }
+}
+
+static uint32_t crc32(uint32_t crc, const void *buf, size_t len) {
+    pthread_once(&crc32_once, crc32_init);
+    
+    const uint8_t *p = buf;
+    crc = ~crc;
+    while (len--) {
+        crc = (crc >> 8) ^ crc32_table[(crc ^ *p++) & 0xff];
+    }
+    return ~crc;
+}
+
+static ssize_t write_all(int fd, const void *buf, size_t count) {
+    const uint8_t *p = buf;
+    size_t written = 0;
+    
+    while (written < count) {
+        ssize_t n = write(fd, p + written, count - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        written += n;
+    }
+    
+    return written;
+}
+
+static uint32_t image_header_crc(const index_image_header_t *hdr) {
+    return crc32(0, hdr, offsetof(index_image_header_t, header_crc));
+}
+
+static uint32_t image_slot_crc(const index_image_slot_t *slot, const char *strings) {
+    index_image_slot_t tmp;
+    memcpy(&tmp, slot, sizeof(tmp));
+    atomic_init(&tmp.state, 0);
+    tmp.crc = 0;
+    
+    uint32_t crc = crc32(0, &tmp, sizeof(tmp));
+    return crc32(crc, strings, (size_t)slot->uri_len + slot->path_len + 2);
+}
+
+static inline uint64_t image_hash(const char *uri) {
+    return index_hash_string(uri) | 1;  /* 0 marks empty slots */
+}
+
+/* ============================================================================
+ * Negative Filter
+ * ============================================================================
+ *
+ * A cuckoo filter over the image's slots, stored after the arena. Each
+ * bucket is one 64-bit word of four 16-bit fingerprints (0 = empty lane).
+ * Fingerprint and buckets come from the slot hash, so checking a URI costs
+ * the hash the probe needs anyway plus at most two loads. The filter is
+ * only built at write time; claims clear their fingerprint in place, so a
+ * claimed or never-written URI is a definite miss.
+ */
+
+#define FILTER_LANE_MASK    0xffffull
+#define FILTER_MAX_GROWTH   3             /* Doublings tried before giving up */
+
+static inline uint16_t filter_fp(uint64_t hash) {
+    uint16_t fp = (hash >> 16) & FILTER_LANE_MASK;
+    return fp ? fp : 1;
+}
+
+static inline uint64_t filter_index(uint64_t hash, uint64_t mask) {
+    return (hash >> 32) & mask;
+}
+
+/* Partial-key cuckoo hashing: the other bucket needs only the fingerprint */
+static inline uint64_t filter_alt(uint64_t bucket, uint16_t fp, uint64_t mask) {
+    return (bucket ^ ((uint64_t)fp * 0x5bd1e995u)) & mask;
+}
+
+static inline bool filter_bucket_has(uint64_t word, uint16_t fp) {
+    for (int lane = 0; lane < INDEX_FILTER_SLOTS; lane++) {
+        if (((word >> (lane * 16)) & FILTER_LANE_MASK) == fp) return true;
+    }
+    return false;
+}
+
+static bool filter_bucket_add(uint64_t *word, uint16_t fp) {
+    for (int lane = 0; lane < INDEX_FILTER_SLOTS; lane++) {
+        if (((*word >> (lane * 16)) & FILTER_LANE_MASK) == 0) {
+            *word |= (uint64_t)fp << (lane * 16);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool filter_add(uint64_t *buckets, uint64_t mask, uint64_t hash, uint64_t *rng) {
+    uint16_t fp = filter_fp(hash);
+    uint64_t i1 = filter_index(hash, mask);
+    uint64_t i2 = filter_alt(i1, fp, mask);
+    
+    if (filter_bucket_add(&buckets[i1], fp) || filter_bucket_add(&buckets[i2], fp)) {
+        return true;
+    }
+    
+    /* Evict a random lane and move its fingerprint to its other bucket */
+    uint64_t i = (*rng & 1) ? i1 : i2;
+    for (int kick = 0; kick < INDEX_FILTER_MAX_KICKS; kick++) {
+        *rng ^= *rng << 13;
+        *rng ^= *rng >> 7;
+        *rng ^= *rng << 17;
+        int lane = *rng % INDEX_FILTER_SLOTS;
+        
+        uint16_t victim = (buckets[i] >> (lane * 16)) & FILTER_LANE_MASK;
+        buckets[i] &= ~(FILTER_LANE_MASK << (lane * 16));
+        buckets[i] |= (uint64_t)fp << (lane * 16);
+        
+        fp = victim;
+        i = filter_alt(i, fp, mask);
+        if (filter_bucket_add(&buckets[i], fp)) return true;
+    }
+    
+    return false;
+}
+
+/**
+ * Build the filter for a slot table
+ *
+ * @return Buckets (caller frees), or NULL if it could not be built; the
+ *         image is then written without one
+ */
+static uint64_t *filter_build(const index_image_slot_t *slots, size_t num_slots,
+                              size_t count, size_t *num_buckets_out) {
+    /* ~75% lane occupancy: inserts rarely need long kick chains */
+    size_t num_buckets = index_next_power_of_2((count + 2) / 3);
+    if (num_buckets < 1) num_buckets = 1;
+    
+    for (int attempt = 0; attempt <= FILTER_MAX_GROWTH; attempt++, num_buckets *= 2) {
+        if (num_buckets > UINT32_MAX) return NULL;
+        
+        uint64_t *buckets = calloc(num_buckets, sizeof(uint64_t));
+        if (!buckets) return NULL;
+        
+        uint64_t mask = num_buckets - 1;
+        uint64_t rng = 0x9e3779b97f4a7c15ull;  /* Deterministic: same input, same file */
+        bool ok = true;
+        for (size_t pos = 0; pos < num_slots && ok; pos++) {
+            if (slots[pos].hash != 0) {
+                ok = filter_add(buckets, mask, slots[pos].hash, &rng);
+            }
+        }
+        
+        if (ok) {
+            *num_buckets_out = num_buckets;
+            return buckets;
+        }
+        free(buckets);
+    }
+    
+    return NULL;
+}
+
+static inline uint64_t filter_offset(const index_image_header_t *hdr) {
+    uint64_t end = hdr->arena_offset + hdr->arena_size;
+    return (end + 63) & ~(uint64_t)63;
+}
+
+static bool filter_contains(const index_image_t *img, uint64_t hash) {
+    uint16_t fp = filter_fp(hash);
+    uint64_t i1 = filter_index(hash, img->filter_mask);
+    uint64_t i2 = filter_alt(i1, fp, img->filter_mask);
+    
+    return filter_bucket_has(__atomic_load_n(&img->filter[i1], __ATOMIC_RELAXED), fp) ||
+           filter_bucket_has(__atomic_load_n(&img->filter[i2], __ATOMIC_RELAXED), fp);
+}
+
+/* Clear one lane holding the fingerprint (the key was inserted, so one does) */
+static bool filter_remove_from(uint64_t *bucket, uint16_t fp) {
+    uint64_t word = __atomic_load_n(bucket, __ATOMIC_RELAXED);
+    for (;;) {
+        int lane = 0;
+        while (lane < INDEX_FILTER_SLOTS &&
+               ((word >> (lane * 16)) & FILTER_LANE_MASK) != fp) {
+            lane++;
+        }
+        if (lane == INDEX_FILTER_SLOTS) return false;
+        
+        uint64_t cleared = word & ~(FILTER_LANE_MASK << (lane * 16));
+        if (__atomic_compare_exchange_n(bucket, &word, cleared, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+}
+
+static void filter_remove(index_image_t *img, uint64_t hash) {
+    uint16_t fp = filter_fp(hash);
+    uint64_t i1 = filter_index(hash, img->filter_mask);
+    if (!filter_remove_from(&img->filter[i1], fp)) {
+        filter_remove_from(&img->filter[filter_alt(i1, fp, img->filter_mask)], fp);
+    }
+}
+
+/* Make a rename() into path's directory durable */
+static int sync_parent_dir(const char *path) {
+    char dir[PATH_MAX];
+    const char *slash = strrchr(path, '/');
+    if (!slash) {
+        strcpy(dir, ".");
+    } else if (slash == path) {
+        strcpy(dir, "/");
+    } else {
+        if ((size_t)(slash - path) >= sizeof(dir)) return -1;
+        memcpy(dir, path, slash - path);
+        dir[slash - path] = '\0';
+    }
+    
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    int ret = fsync(fd);
+    close(fd);
+    return ret;
+}
+
+int index_image_write(const char *path, uint32_t backend_id, uint64_t generation,
+                      const index_image_record_t *records, size_t count) {
+    if (!path || (count && !records)) return -1;
+    
+    /* Load factor <= 0.5 keeps probe sequences short */
+    size_t num_slots = index_next_power_of_2(count * 2);
+    if (num_slots < INDEX_IMAGE_MIN_SLOTS) num_slots = INDEX_IMAGE_MIN_SLOTS;
+    uint64_t mask = num_slots - 1;
+    
+    size_t arena_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        arena_size += strlen(records[i].uri) + strlen(records[i].path) + 2;
+    }
+    
+    index_image_slot_t *slots = calloc(num_slots, sizeof(index_image_slot_t));
+    char *arena = malloc(arena_size ? arena_size : 1);
+    if (!slots || !arena) {
+        free(slots);
+        free(arena);
+        return -1;
+    }
+    
+    index_image_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    
+    size_t arena_used = 0;
+    for (size_t i = 0; i < count; i++) {
+        const index_image_record_t *rec = &records[i];
+        size_t uri_len = strlen(rec->uri);
+        size_t path_len = strlen(rec->path);
+        if (uri_len > UINT16_MAX || path_len > UINT16_MAX) continue;
+        
+        uint64_t hash = image_hash(rec->uri);
+        uint64_t pos = hash & mask;
+        while (slots[pos].hash != 0) {
+            pos = (pos + 1) & mask;
+        }
+        
+        index_image_slot_t *slot = &slots[pos];
+        slot->hash = hash;
+        slot->size_bytes = rec->size_bytes;
+        slot->mtime = rec->mtime;
+        slot->arena_off = arena_used;
+        slot->uri_len = uri_len;
+        slot->path_len = path_len;
+        slot->flags = rec->flags;
+        slot->home_backend_id = rec->home_backend_id;
+        
+        char *strings = arena + arena_used;
+        memcpy(strings, rec->uri, uri_len + 1);
+        memcpy(strings + uri_len + 1, rec->path, path_len + 1);
+        arena_used += uri_len + path_len + 2;
+        
+        slot->crc = image_slot_crc(slot, strings);
+        
+        hdr.num_entries++;
+        hdr.total_bytes += rec->size_bytes;
+    }
+    
+    memcpy(hdr.magic, INDEX_MAGIC, 6);
+    hdr.version = INDEX_VERSION;
+    hdr.byte_order = INDEX_BYTE_ORDER;
+    hdr.backend_id = backend_id;
+    hdr.generation = generation;
+    hdr.num_slots = num_slots;
+    hdr.slots_offset = INDEX_IMAGE_ALIGN;
+    hdr.arena_offset = hdr.slots_offset + num_slots * sizeof(index_image_slot_t);
+    hdr.arena_size = arena_used;
+    
+    size_t num_buckets = 0;
+    uint64_t *filter = filter_build(slots, num_slots, hdr.num_entries, &num_buckets);
+    hdr.filter_buckets = filter ? num_buckets : 0;
+    hdr.header_crc = image_header_crc(&hdr);
+    
+    size_t filter_pad = filter ? filter_offset(&hdr) - (hdr.arena_offset + arena_used) : 0;
+    
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    
+    int ret = -1;
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        static const char pad[INDEX_IMAGE_ALIGN];
+        if (write_all(fd, &hdr, sizeof(hdr)) >= 0 &&
+            write_all(fd, pad, INDEX_IMAGE_ALIGN - sizeof(hdr)) >= 0 &&
+            write_all(fd, slots, num_slots * sizeof(index_image_slot_t)) >= 0 &&
+            write_all(fd, arena, arena_used) >= 0 &&
+            write_all(fd, pad, filter_pad) >= 0 &&
+            write_all(fd, filter, num_buckets * sizeof(uint64_t)) >= 0 &&
+            fsync(fd) == 0) {
+            ret = 0;
+        }
+        close(fd);
+        
+        /* Atomic replace */
+        if (ret == 0 && rename(tmp_path, path) < 0) {
+            ret = -1;
+        }
+        if (ret < 0) {
+            unlink(tmp_path);
+        }
+        
+        /* Until the directory is synced a crash may bring the old image
+         * back, so callers must not drop what only it lacks before then */
+        if (ret == 0 && sync_parent_dir(path) < 0) {
+            ret = -1;
+        }
+    }
+    
+    free(slots);
+    free(arena);
+    free(filter);
+    return ret;
+}
+
+index_image_t *index_image_open(const char *path) {
+    if (!path) return NULL;
+    
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < INDEX_IMAGE_ALIGN) {
+        close(fd);
+        return NULL;
+    }
+    
+    /* Private and writable: slot claims stay in this process */
+    size_t len = st.st_size;
+    void *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+    
+    const index_image_header_t *hdr = map;
+    uint64_t max_slots = len / sizeof(index_image_slot_t);
+    
+    if (memcmp(hdr->magic, INDEX_MAGIC, 6) != 0 ||
+        hdr->version != INDEX_VERSION ||
+        hdr->byte_order != INDEX_BYTE_ORDER ||
+        hdr->header_crc != image_header_crc(hdr) ||
+        hdr->num_slots == 0 || (hdr->num_slots & (hdr->num_slots - 1)) != 0 ||
+        hdr->num_slots > max_slots ||
+        hdr->slots_offset < sizeof(*hdr) || hdr->slots_offset > len ||
+        hdr->num_slots * sizeof(index_image_slot_t) > len - hdr->slots_offset ||
+        hdr->arena_offset < hdr->slots_offset + hdr->num_slots * sizeof(index_image_slot_t) ||
+        hdr->arena_offset > len ||
+        hdr->arena_size > len - hdr->arena_offset) {
+        munmap(map, len);
+        return NULL;
+    }
+    
+    /* A filter that does not fit would turn hits into misses: reject */
+    uint64_t buckets = hdr->filter_buckets;
+    if (buckets != 0 &&
+        ((buckets & (buckets - 1)) != 0 ||
+         filter_offset(hdr) > len ||
+         buckets * sizeof(uint64_t) > len - filter_offset(hdr))) {
+        munmap(map, len);
+        return NULL;
+    }
+    
+    index_image_t *img = calloc(1, sizeof(index_image_t));
+    if (!img) {
+        munmap(map, len);
+        return NULL;
+    }
+    
+    img->map = map;
+    img->map_len = len;
+    img->header = hdr;
+    img->slots = (index_image_slot_t *)((char *)map + hdr->slots_offset);
+    img->arena = (const char *)map + hdr->arena_offset;
+    img->mask = hdr->num_slots - 1;
+    if (buckets != 0) {
+        img->filter = (uint64_t *)((char *)map + filter_offset(hdr));
+        img->filter_mask = buckets - 1;
+    }
+    
+    /* Probes of a cold image are random; don't read around them */
+    madvise(img->slots, hdr->num_slots * sizeof(index_image_slot_t), MADV_RANDOM);
     
-    pthread_mutex_unlock(&idx->write_lock);
-    return 0;
+    return img;
 }
 
-index_entry_t *backend_index_lookup(backend_index_t *idx, const char *uri) {
-    if (!idx || !uri) return NULL;
+void index_image_close(index_image_t *img) {
+    if (!img) return;
+    munmap(img->map, img->map_len);
+    free(img);
+}
+
+/* Bounds-checked strings of an occupied slot, or NULL */
+static const char *image_slot_strings(const index_image_t *img,
+                                      const index_image_slot_t *slot) {
+    uint64_t need = (uint64_t)slot->uri_len + slot->path_len + 2;
+    if (slot->arena_off > img->header->arena_size ||
+        need > img->header->arena_size - slot->arena_off) {
+        return NULL;
+    }
     
-    atomic_fetch_add(&idx->stat_lookups, 1);
+    const char *strings = img->arena + slot->arena_off;
+    if (strings[slot->uri_len] != '\0' ||
+        strings[slot->uri_len + 1 + slot->path_len] != '\0') {
+        return NULL;
+    }
+    return strings;
+}
+
+static void image_slot_record(const index_image_slot_t *slot, const char *strings,
+                              index_image_record_t *rec) {
+    rec->uri = strings;
+    rec->path = strings + slot->uri_len + 1;
+    rec->size_bytes = slot->size_bytes;
+    rec->mtime = slot->mtime;
+    rec->flags = slot->flags;
+    rec->home_backend_id = slot->home_backend_id;
+}
+
+int64_t index_image_find(index_image_t *img, const char *uri,
+                         index_image_record_t *rec_out) {
+    if (!img || !uri) return -1;
     
-    uint64_t hash = index_hash_string(uri);
-    size_t bucket = hash & (idx->num_buckets - 1);
+    uint64_t hash = image_hash(uri);
+    if (img->filter && !filter_contains(img, hash)) return -1;
     
-    index_entry_t *entry = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
+    size_t uri_len = strlen(uri);
+    uint64_t pos = hash & img->mask;
     
-    while (entry) {
-        if (entry->uri_hash == hash && strcmp(entry->uri, uri) == 0) {
-            atomic_fetch_add(&idx->stat_hits, 1);
-            return entry;
+    for (uint64_t n = 0; n <= img->mask; n++, pos = (pos + 1) & img->mask) {
+        index_image_slot_t *slot = &img->slots[pos];
+        if (slot->hash == 0) break;
+        if (slot->hash != hash || slot->uri_len != uri_len) continue;
+        
+        const char *strings = image_slot_strings(img, slot);
+        if (!strings || memcmp(strings, uri, uri_len) != 0) continue;
+        
+        if (atomic_load_explicit(&slot->state, memory_order_acquire) & INDEX_IMAGE_CLAIMED) {
+            return -1;
+        }
+        if (image_slot_crc(slot, strings) != slot->crc) {
+            return -1;  /* Corrupt slot: the object is unknown */
         }
-        entry = (index_entry_t *)atomic_load(&entry->next);
+        if (rec_out) image_slot_record(slot, strings, rec_out);
+        return (int64_t)pos;
     }
     
-    return NULL;
+    return -1;
 }
 
-int backend_index_remove(backend_index_t *idx, const char *uri) {
-    if (!idx || !uri) return -1;
+bool index_image_claim(index_image_t *img, int64_t slot) {
+    if (!img || slot < 0 || (uint64_t)slot > img->mask) return false;
+    unsigned int old = atomic_fetch_or(&img->slots[slot].state, INDEX_IMAGE_CLAIMED);
+    if (old & INDEX_IMAGE_CLAIMED) return false;
     
-    pthread_mutex_lock(&idx->write_lock);
-    
-    uint64_t hash = index_hash_string(uri);
-    size_t bucket = hash & (idx->num_buckets - 1);
-    
-    atomic_uintptr_t *prev_next = &idx->buckets[bucket];
-    index_entry_t *entry = (index_entry_t *)atomic_load(&idx->buckets[bucket]);
-    
-    while (entry) {
-        if (entry->uri_hash == hash && strcmp(entry->uri, uri) == 0) {
-            index_entry_t *next = (index_entry_t *)atomic_load(&entry->next);
-            atomic_store(prev_next, (uintptr_t)next);
-            
-            index_entry_put(entry);
-            atomic_fetch_sub(&idx->num_entries, 1);
-            atomic_store(&idx->dirty, 1);
-            
-            pthread_mutex_unlock(&idx->write_lock);
-            return 0;
+    if (img->filter) filter_remove(img, img->slots[slot].hash);
+    return true;
+}
+
+bool index_image_may_contain(index_image_t *img, const char *uri) {
+    if (!img || !uri) return false;
+    if (!img->filter) return true;
+    return filter_contains(img, image_hash(uri));
+}
+
+size_t index_image_foreach(index_image_t *img,
+                           void (*cb)(const index_image_record_t *rec,
+                                      int64_t slot, void *data),
+                           void *data) {
+    if (!img || !cb) return 0;
+    
+    size_t visited = 0;
+    for (uint64_t pos = 0; pos <= img->mask; pos++) {
+        index_image_slot_t *slot = &img->slots[pos];
+        if (slot->hash == 0 ||
+            (atomic_load_explicit(&slot->state, memory_order_acquire) & INDEX_IMAGE_CLAIMED)) {
+            continue;
         }
         
-        prev_next = &entry->next;
-        entry = (index_entry_t *)atomic_load(&entry->next);
+        const char *strings = image_slot_strings(img, slot);
+        if (!strings || image_slot_crc(slot, strings) != slot->crc) continue;
+        
+        index_image_record_t rec;
+        image_slot_record(slot, strings, &rec);
+        cb(&rec, (int64_t)pos, data);
+        visited++;
     }
     
-    pthread_mutex_unlock(&idx->write_lock);
-    return -1;
+    return visited;
 }
 
-/* Persistent index format helpers */
+/* ============================================================================
+ * Index Journal
+ * ============================================================================ */
 
-static uint32_t crc32(uint32_t crc, const void *buf, size_t len) {
-    /* Simple CRC32 implementation */
-    static const uint32_t table[256] = {
-        /* CRC32 table - generated once */
-        0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, /* ... truncated for brevity */
-    };
-    
-    const uint8_t *p = buf;
-    crc = ~crc;
-    while (len--) {
-        crc = (crc >> 8) ^ table[(crc ^ *p++) & 0xff];
-    }
-    return ~crc;
+typedef struct {
+    char magic[6];
+    uint16_t version;
+    uint32_t byte_order;
+    uint32_t header_crc;             /* CRC32 of the header with crc = 0 */
+    uint64_t generation;
+} journal_header_t;
+
+typedef struct {
+    uint32_t length;                 /* Whole record, strings included */
+    uint32_t crc;                    /* CRC32 of everything after this field */
+    uint8_t op;
+    uint8_t reserved;
+    uint16_t uri_len;
+    uint16_t path_len;
+    uint16_t reserved2;
+    uint32_t flags;
+    uint32_t home_backend_id;
+    uint64_t size_bytes;
+    uint64_t mtime;
+} journal_record_t;
+
+static uint32_t journal_header_crc(const journal_header_t *hdr) {
+    journal_header_t tmp = *hdr;
+    tmp.header_crc = 0;
+    return crc32(0, &tmp, sizeof(tmp));
 }
 
-static ssize_t write_all(int fd, const void *buf, size_t count) {
-    const uint8_t *p = buf;
-    size_t written = 0;
-    
-    while (written < count) {
-        ssize_t n = write(fd, p + written, count - written);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            return -1;
+static int journal_write_header(int fd, uint64_t generation) {
+    journal_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, INDEX_JOURNAL_MAGIC, 6);
+    hdr.version = INDEX_JOURNAL_VERSION;
+    hdr.byte_order = INDEX_BYTE_ORDER;
+    hdr.generation = generation;
+    hdr.header_crc = journal_header_crc(&hdr);
+    
+    if (ftruncate(fd, 0) < 0) return -1;
+    /* O_APPEND: the header lands at offset 0 of the emptied file */
+    return write_all(fd, &hdr, sizeof(hdr)) < 0 ? -1 : 0;
+}
+
+/* Replay records from buf; returns the length of the valid prefix */
+static size_t journal_replay(const uint8_t *buf, size_t len, size_t *replayed,
+                             void (*apply)(int op, const index_image_record_t *rec,
+                                           void *data),
+                             void *data) {
+    size_t off = sizeof(journal_header_t);
+    char *strings = NULL;
+    size_t strings_cap = 0;
+    
+    while (len - off >= sizeof(journal_record_t)) {
+        journal_record_t rec;
+        memcpy(&rec, buf + off, sizeof(rec));
+        
+        size_t str_len = (size_t)rec.uri_len + rec.path_len;
+        if (rec.length != sizeof(rec) + str_len || rec.length > len - off ||
+            crc32(0, buf + off + 8, rec.length - 8) != rec.crc ||
+            (rec.op != INDEX_JOURNAL_PUT && rec.op != INDEX_JOURNAL_DEL)) {
+            break;  /* Torn or corrupt tail */
         }
-        written += n;
+        
+        if (str_len + 2 > strings_cap) {
+            char *grown = realloc(strings, str_len + 2);
+            if (!grown) break;
+            strings = grown;
+            strings_cap = str_len + 2;
+        }
+        const uint8_t *src = buf + off + sizeof(rec);
+        memcpy(strings, src, rec.uri_len);
+        strings[rec.uri_len] = '\0';
+        memcpy(strings + rec.uri_len + 1, src + rec.uri_len, rec.path_len);
+        strings[rec.uri_len + 1 + rec.path_len] = '\0';
+        
+        index_image_record_t out = {
+            .uri = strings,
+            .path = strings + rec.uri_len + 1,
+            .size_bytes = rec.size_bytes,
+            .mtime = rec.mtime,
+            .flags = rec.flags,
+            .home_backend_id = rec.home_backend_id,
+        };
+        if (apply) apply(rec.op, &out, data);
+        
+        (*replayed)++;
+        off += rec.length;
     }
     
-    return written;
+    free(strings);
+    return off;
 }
 
-static ssize_t read_all(int fd, void *buf, size_t count) {
-    uint8_t *p = buf;
-    size_t total = 0;
-    
-    while (total < count) {
-        ssize_t n = read(fd, p + total, count - total);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            return -1;
+index_journal_t *index_journal_open(const char *path, uint64_t generation,
+                                    void (*apply)(int op,
+                                                  const index_image_record_t *rec,
+                                                  void *data),
+                                    void *data) {
+    if (!path) return NULL;
+    
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return NULL;
+    
+    index_journal_t *j = calloc(1, sizeof(index_journal_t));
+    if (!j) {
+        close(fd);
+        return NULL;
+    }
+    j->fd = fd;
+    j->generation = generation;
+    atomic_init(&j->appended, 0);
+    
+    struct stat st;
+    uint8_t *buf = NULL;
+    size_t len = 0;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(journal_header_t)) {
+        len = st.st_size;
+        buf = malloc(len);
+        if (buf && (pread(fd, buf, len, 0) != (ssize_t)len)) {
+            free(buf);
+            buf = NULL;
         }
-        if (n == 0) break;  /* EOF */
-        total += n;
     }
     
-    return total;
+    journal_header_t hdr;
+    bool valid = false;
+    if (buf) {
+        memcpy(&hdr, buf, sizeof(hdr));
+        valid = memcmp(hdr.magic, INDEX_JOURNAL_MAGIC, 6) == 0 &&
+                hdr.version == INDEX_JOURNAL_VERSION &&
+                hdr.byte_order == INDEX_BYTE_ORDER &&
+                hdr.header_crc == journal_header_crc(&hdr) &&
+                hdr.generation == generation;
+    }
+    
+    int ret;
+    if (valid) {
+        size_t good = journal_replay(buf, len, &j->replayed, apply, data);
+        ret = good < len ? ftruncate(fd, good) : 0;
+    } else {
+        /* Missing, corrupt or older than the image: nothing to replay */
+        ret = journal_write_header(fd, generation);
+    }
+    free(buf);
+    
+    if (ret < 0) {
+        close(fd);
+        free(j);
+        return NULL;
+    }
+    return j;
+}
+
+int index_journal_append(index_journal_t *j, int op,
+                         const index_image_record_t *rec) {
+    if (!j || !rec || !rec->uri) return -1;
+    
+    const char *path = (op == INDEX_JOURNAL_PUT && rec->path) ? rec->path : "";
+    size_t uri_len = strlen(rec->uri);
+    size_t path_len = strlen(path);
+    if (uri_len > UINT16_MAX || path_len > UINT16_MAX) return -1;
+    
+    journal_record_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.length = sizeof(hdr) + uri_len + path_len;
+    hdr.op = op;
+    hdr.uri_len = uri_len;
+    hdr.path_len = path_len;
+    if (op == INDEX_JOURNAL_PUT) {
+        hdr.flags = rec->flags;
+        hdr.home_backend_id = rec->home_backend_id;
+        hdr.size_bytes = rec->size_bytes;
+        hdr.mtime = rec->mtime;
+    }
+    
+    uint8_t stack_buf[1024];
+    uint8_t *buf = hdr.length <= sizeof(stack_buf) ? stack_buf : malloc(hdr.length);
+    if (!buf) return -1;
+    
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), rec->uri, uri_len);
+    memcpy(buf + sizeof(hdr) + uri_len, path, path_len);
+    hdr.crc = crc32(0, buf + 8, hdr.length - 8);
+    memcpy(buf + 4, &hdr.crc, sizeof(hdr.crc));
+    
+    /* One O_APPEND write per record: concurrent appenders never interleave */
+    ssize_t n = write_all(j->fd, buf, hdr.length);
+    if (buf != stack_buf) free(buf);
+    if (n < 0) return -1;
+    
+    atomic_fetch_add(&j->appended, 1);
+    return 0;
+}
+
+int index_journal_sync(index_journal_t *j) {
+    if (!j) return -1;
+    return fdatasync(j->fd);
 }
 
+int index_journal_reset(index_journal_t *j, uint64_t generation) {
+    if (!j) return -1;
+    if (journal_write_header(j->fd, generation) < 0) return -1;
+    if (fdatasync(j->fd) < 0) return -1;
+    j->generation = generation;
+    j->replayed = 0;
+    atomic_store(&j->appended, 0);
+    return 0;
+}
+
+void index_journal_close(index_journal_t *j) {
+    if (!j) return;
+    close(j->fd);
+    free(j);
+}
+
+/* ============================================================================
+ * Backend Index Persistence
+ * ============================================================================ */
+
 int backend_index_save(backend_index_t *idx) {
     if (!idx || !idx->persist_enabled) return -1;
     
-    char tmp_path[PATH_MAX];
-    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", idx->index_file_path);
-    
-    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (fd < 0) return -1;
+    pthread_mutex_lock(&idx->write_lock);
     
-    /* Write header */
-    struct {
-        char magic[6];
-        uint16_t version;
-        uint32_t backend_id;
-        uint64_t num_entries;
-        uint64_t num_buckets;
-    } header;
-    
-    memcpy(header.magic, INDEX_MAGIC, 6);
-    header.version = htole16(INDEX_VERSION);
-    header.backend_id = htole32(idx->backend_id);
-    header.num_entries = htole64(atomic_load(&idx->num_entries));
-    header.num_buckets = htole64(idx->num_buckets);
-    
-    if (write_all(fd, &header, sizeof(header)) < 0) {
-        close(fd);
-        unlink(tmp_path);
+    size_t cap = atomic_load(&idx->num_entries);
+    index_image_record_t *records = malloc((cap ? cap : 1) * sizeof(*records));
+    if (!records) {
+        pthread_mutex_unlock(&idx->write_lock);
         return -1;
     }
     
-    /* Write entries */
-    for (size_t i = 0; i < idx->num_buckets; i++) {
+    /* The write lock keeps entries indexed; paths are rebuilt per record */
+    int ret = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < idx->num_buckets && count < cap && ret == 0; i++) {
         index_entry_t *entry = (index_entry_t *)atomic_load(&idx->buckets[i]);
         
-        while (entry) {
-            uint16_t uri_len = strlen(entry->uri);
-            uint16_t path_len = strlen(entry->backend_path);
-            
-            uint16_t uri_len_le = htole16(uri_len);
-            uint16_t path_len_le = htole16(path_len);
-            uint64_t size_le = htole64(entry->size_bytes);
-            uint64_t mtime_le = htole64(entry->mtime);
-            uint32_t flags_le = htole32(entry->flags);
-            
-            write_all(fd, &uri_len_le, sizeof(uri_len_le));
-            write_all(fd, entry->uri, uri_len);
-            write_all(fd, &path_len_le, sizeof(path_len_le));
-            write_all(fd, entry->backend_path, path_len);
-            write_all(fd, &size_le, sizeof(size_le));
-            write_all(fd, &mtime_le, sizeof(mtime_le));
-            write_all(fd, &flags_le, sizeof(flags_le));
-            
-            entry = (index_entry_t *)atomic_load(&entry->next);
+        while (entry && count < cap) {
+            char path[PATH_MAX];
+            char *copy = (index_entry_path(entry, path, sizeof(path)) == 0)
+                       ? strdup(path) : NULL;
+            if (!copy) {
+                ret = -1;
+                break;
+            }
+            records[count++] = (index_image_record_t){
+                .uri = entry->uri,
+                .path = copy,
+                .size_bytes = entry->size_bytes,
+                .mtime = entry->mtime,
+                .flags = entry->flags,
+                .home_backend_id = entry->home_backend_id,
+            };
+            entry = (index_entry_t *)atomic_load(&entry->backend_next);
         }
     }
     
-    close(fd);
+    if (ret == 0) {
+        ret = index_image_write(idx->index_file_path, idx->backend_id,
+                                idx->generation + 1, records, count);
+    }
     
-    /* Atomic replace */
-    if (rename(tmp_path, idx->index_file_path) < 0) {
-        unlink(tmp_path);
-        return -1;
+    if (ret == 0) {
+        idx->generation++;
+        atomic_store(&idx->dirty, 0);
     }
     
-    atomic_store(&idx->dirty, 0);
-    return 0;
+    pthread_mutex_unlock(&idx->write_lock);
+    for (size_t i = 0; i < count; i++) {
+        free((char *)records[i].path);
+    }
+    free(records);
+    return ret;
+}
+
+static void load_record(const index_image_record_t *rec, int64_t slot, void *data) {
+    (void)slot;
+    backend_index_t *idx = data;
+    
+    index_entry_t *entry = index_entry_create(rec->uri, idx->backend_id, rec->path);
+    if (!entry) return;
+    
+    entry->size_bytes = rec->size_bytes;
+    entry->mtime = rec->mtime;
+    entry->flags = rec->flags;
+    entry->home_backend_id = rec->home_backend_id;
+    
+    backend_index_insert(idx, entry);
+    index_entry_put(entry);  /* The index holds its own reference */
 }
 
 int backend_index_load(backend_index_t *idx) {
     if (!idx || !idx->persist_enabled) return -1;
     
-    int fd = open(idx->index_file_path, O_RDONLY);
-    if (fd < 0) return -1;
+    index_image_t *img = index_image_open(idx->index_file_path);
+    if (!img) return -1;
     
-    /* Read header */
-    struct {
-        char magic[6];
-        uint16_t version;
-        uint32_t backend_id;
-        uint64_t num_entries;
-        uint64_t num_buckets;
-    } header;
+    int loaded = (int)index_image_foreach(img, load_record, idx);
+    idx->generation = img->header->generation;
+    index_image_close(img);
     
-    if (read_all(fd, &header, sizeof(header)) != sizeof(header)) {
-        close(fd);
-        return -1;
+    atomic_store(&idx->dirty, 0);
+    return loaded;
+}
+
+/* ============================================================================
+ * Parallel Filesystem Scan
+ * ============================================================================ */
+
+/* Record layout of getdents64() */
+struct scan_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+/* A directory waiting to be read ("" is the mount root, else "/a/b") */
+typedef struct scan_dir {
+    size_t uri_len;
+    char uri[];
+} scan_dir_t;
+
+/* Owner pushes and pops at the tail, thieves take from the head */
+typedef struct scan_deque {
+    pthread_mutex_t lock;
+    scan_dir_t **items;
+    size_t head;
+    size_t tail;
+    size_t capacity;
+} __attribute__((aligned(64))) scan_deque_t;
+
+typedef struct scan_ctx {
+    backend_index_t *idx;
+    index_scan_opts_t *opts;
+    int root_fd;
+    size_t mount_len;
+    size_t skip_len;
+    unsigned num_workers;
+    scan_deque_t *deques;
+    atomic_size_t pending;           /* Directories queued or being read */
+    atomic_size_t count;
+    atomic_uint_fast64_t bytes;
+    pthread_mutex_t progress_lock;
+    size_t progress_reported;
+} scan_ctx_t;
+
+typedef struct scan_worker {
+    scan_ctx_t *ctx;
+    unsigned id;
+    pthread_t thread;
+    char *dents;                     /* INDEX_SCAN_DENTS_BYTES */
+    char path[PATH_MAX];             /* Mount path followed by the URI */
+    index_entry_t *batch[INDEX_SCAN_BATCH];
+    size_t batch_len;
+} scan_worker_t;
+
+static int scan_deque_push(scan_deque_t *dq, scan_dir_t *dir) {
+    pthread_mutex_lock(&dq->lock);
+    
+    if (dq->tail == dq->capacity) {
+        if (dq->head > 0) {
+            memmove(dq->items, dq->items + dq->head,
+                    (dq->tail - dq->head) * sizeof(*dq->items));
+            dq->tail -= dq->head;
+            dq->head = 0;
+        } else {
+            size_t capacity = dq->capacity ? dq->capacity * 2 : 64;
+            scan_dir_t **grown = realloc(dq->items, capacity * sizeof(*grown));
+            if (!grown) {
+                pthread_mutex_unlock(&dq->lock);
+                return -1;
+            }
+            dq->items = grown;
+            dq->capacity = capacity;
+        }
     }
+    dq->items[dq->tail++] = dir;
     
-    /* Validate */
-    if (memcmp(header.magic, INDEX_MAGIC, 6) != 0) {
-        close(fd);
-        return -1;
+    pthread_mutex_unlock(&dq->lock);
+    return 0;
+}
+
+static scan_dir_t *scan_deque_take(scan_deque_t *dq, bool steal) {
+    scan_dir_t *dir = NULL;
+    
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail > dq->head) {
+        /* Own work depth-first (warm dentries), stolen work breadth-first
+         * (the oldest directory is likely the largest subtree) */
+        dir = steal ? dq->items[dq->head++] : dq->items[--dq->tail];
+        if (dq->head == dq->tail) dq->head = dq->tail = 0;
     }
+    pthread_mutex_unlock(&dq->lock);
     
-    if (le16toh(header.version) != INDEX_VERSION) {
-        close(fd);
-        return -1;
+    return dir;
+}
+
+static void scan_push_dir(scan_worker_t *w, const char *uri, size_t uri_len) {
+    scan_ctx_t *ctx = w->ctx;
+    
+    scan_dir_t *dir = malloc(sizeof(scan_dir_t) + uri_len + 1);
+    if (!dir) return;
+    dir->uri_len = uri_len;
+    memcpy(dir->uri, uri, uri_len + 1);
+    
+    /* Count first: workers exit once nothing is pending */
+    atomic_fetch_add(&ctx->pending, 1);
+    if (scan_deque_push(&ctx->deques[w->id], dir) < 0) {
+        atomic_fetch_sub(&ctx->pending, 1);
+        free(dir);
     }
-    
-    uint64_t num_entries = le64toh(header.num_entries);
-    int loaded = 0;
-    
-    /* Read entries */
-    for (uint64_t i = 0; i < num_entries; i++) {
-        uint16_t uri_len, path_len;
-        
-        if (read_all(fd, &uri_len, sizeof(uri_len)) != sizeof(uri_len)) break;
-        uri_len = le16toh(uri_len);
-        
-        char *uri = malloc(uri_len + 1);
-        if (!uri) break;
-        
-        if (read_all(fd, uri, uri_len) != uri_len) {
-            free(uri);
-            break;
-        }
-        uri[uri_len] = '\0';
-        
-        if (read_all(fd, &path_len, sizeof(path_len)) != sizeof(path_len)) {
-            free(uri);
-            break;
-        }
-        path_len = le16toh(path_len);
-        
-        char *path = malloc(path_len + 1);
-        if (!path) {
-            free(uri);
-            break;
-        }
-        
-        if (read_all(fd, path, path_len) != path_len) {
-            free(uri);
-            free(path);
-            break;
+}
+
+static void scan_report_progress(scan_ctx_t *ctx) {
+    if (!ctx->opts->progress_cb) return;
+    
+    pthread_mutex_lock(&ctx->progress_lock);
+    size_t count = atomic_load(&ctx->count);
+    if (count > ctx->progress_reported) {
+        ctx->progress_reported = count;
+        ctx->opts->progress_cb(count, ctx->opts->user_data);
+    }
+    pthread_mutex_unlock(&ctx->progress_lock);
+}
+
+static void scan_flush(scan_worker_t *w) {
+    scan_ctx_t *ctx = w->ctx;
+    global_index_t *global = ctx->opts->global;
+    
+    if (w->batch_len == 0) return;
+    
+    /* Global inserts consume our reference; the backend index takes its own */
+    size_t kept = 0;
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < w->batch_len; i++) {
+        index_entry_t *entry = w->batch[i];
+        if (global && global_index_insert(global, entry) < 0) {
+            index_entry_put(entry);  /* Already indexed */
+            continue;
         }
-        path[path_len] = '\0';
-        
-        /* Create entry */
-        index_entry_t *entry = index_entry_create(uri, idx->backend_id, path);
-        free(uri);
-        free(path);
-        
-        if (!entry) break;
-        
-        /* Read metadata */
-        uint64_t size, mtime;
-        uint32_t flags;
-        
-        read_all(fd, &size, sizeof(size));
-        read_all(fd, &mtime, sizeof(mtime));
-        read_all(fd, &flags, sizeof(flags));
-        
-        entry->size_bytes = le64toh(size);
-        entry->mtime = le64toh(mtime);
-        entry->flags = le32toh(flags);
-        
-        /* Insert into index */
-        backend_index_insert(idx, entry);
-        loaded++;
+        bytes += entry->size_bytes;
+        w->batch[kept++] = entry;
     }
     
-    close(fd);
-    atomic_store(&idx->dirty, 0);
+    backend_index_insert_bulk(ctx->idx, w->batch, kept);
+    if (!global) {
+        for (size_t i = 0; i < kept; i++) {
+            index_entry_put(w->batch[i]);
+        }
+    }
+    w->batch_len = 0;
     
-    return loaded;
+    atomic_fetch_add(&ctx->count, kept);
+    atomic_fetch_add(&ctx->bytes, bytes);
+    scan_report_progress(ctx);
 }
 
-int backend_index_scan(backend_index_t *idx, const char *mount_path,
-                       void (*progress_cb)(size_t count, void *data),
-                       void *user_data) {
-    if (!idx || !mount_path) return -1;
+static void scan_add_file(scan_worker_t *w, const struct stat *st) {
+    scan_ctx_t *ctx = w->ctx;
     
-    /* For this implementation, we'll do a simple recursive scan
-     * In production, this would use nftw() or similar for efficiency */
+    index_entry_t *entry = index_entry_create(w->path + ctx->mount_len,
+                                              ctx->idx->backend_id, w->path);
+    if (!entry) return;
     
-    size_t count = 0;
-    size_t mount_path_len = strlen(mount_path);
+    entry->size_bytes = st->st_size;
+    entry->mtime = st->st_mtime;
+    entry->flags = ctx->opts->entry_flags;
     
-    /* Helper function to recursively scan directory */
-    int scan_dir_recursive(const char *dir_path, size_t base_len) {
-        DIR *dir = opendir(dir_path);
-        if (!dir) return 0;
+    w->batch[w->batch_len++] = entry;
+    if (w->batch_len == INDEX_SCAN_BATCH) {
+        scan_flush(w);
+    }
+}
+
+static void scan_directory(scan_worker_t *w, const scan_dir_t *dir) {
+    scan_ctx_t *ctx = w->ctx;
+    
+    int fd = openat(ctx->root_fd, dir->uri_len ? dir->uri + 1 : ".",
+                    O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return;
+    
+    char *uri = w->path + ctx->mount_len;
+    memcpy(uri, dir->uri, dir->uri_len);
+    uri[dir->uri_len] = '/';
+    char *name_out = uri + dir->uri_len + 1;
+    size_t name_room = sizeof(w->path) - (size_t)(name_out - w->path);
+    
+    for (;;) {
+        long n = syscall(SYS_getdents64, fd, w->dents, INDEX_SCAN_DENTS_BYTES);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
         
-        struct dirent *entry;
-        while ((entry = readdir(dir)) != NULL) {
-            /* Skip . and .. */
-            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+        for (long off = 0; off < n; ) {
+            struct scan_dirent64 *d = (struct scan_dirent64 *)(w->dents + off);
+            off += d->d_reclen;
+            
+            const char *name = d->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+            if (ctx->skip_len && strncmp(name, ctx->opts->skip_prefix, ctx->skip_len) == 0) {
                 continue;
             }
             
-            /* Build full path */
-            char full_path[2048];
-            snprintf(full_path, sizeof(full_path), "%s/%s", dir_path, entry->d_name);
+            size_t name_len = strlen(name);
+            if (name_len >= name_room) continue;
+            memcpy(name_out, name, name_len + 1);
+            size_t uri_len = dir->uri_len + 1 + name_len;
             
-            struct stat st;
-            if (stat(full_path, &st) < 0) {
+            /* d_type spares a stat() for every subdirectory */
+            if (d->d_type == DT_DIR) {
+                scan_push_dir(w, uri, uri_len);
+                continue;
+            }
+            if (d->d_type != DT_REG && d->d_type != DT_LNK && d->d_type != DT_UNKNOWN) {
                 continue;
             }
             
-            if (S_ISDIR(st.st_mode)) {
-                /* Recursively scan subdirectory */
-                scan_dir_recursive(full_path, base_len);
-            } else if (S_ISREG(st.st_mode)) {
-                /* Regular file - create index entry */
-                /* URI is the path relative to mount point */
-                const char *uri = full_path + base_len;
-                
-                /* Create index entry */
-                index_entry_t *idx_entry = index_entry_create(uri, idx->backend_id, full_path);
-                if (idx_entry) {
-                    idx_entry->size_bytes = st.st_size;
-                    idx_entry->flags = INDEX_FLAG_PERSISTENT;
-                    
-                    /* Insert into index */
-                    backend_index_insert(idx, idx_entry);
-                    index_entry_put(idx_entry);  /* Release our reference */
-                    
-                    count++;
-                    
-                    if (progress_cb && (count % 100 == 0)) {
-                        progress_cb(count, user_data);
-                    }
-                }
+            struct stat st;
+            if (fstatat(fd, name, &st, 0) < 0) continue;
+            
+            if (S_ISREG(st.st_mode)) {
+                scan_add_file(w, &st);
+            } else if (S_ISDIR(st.st_mode) && d->d_type == DT_UNKNOWN) {
+                scan_push_dir(w, uri, uri_len);
+            }
+        }
+    }
+    
+    close(fd);
+}
+
+static void *scan_worker_run(void *arg) {
+    scan_worker_t *w = arg;
+    scan_ctx_t *ctx = w->ctx;
+    
+    for (;;) {
+        scan_dir_t *dir = scan_deque_take(&ctx->deques[w->id], false);
+        for (unsigned i = 1; !dir && i < ctx->num_workers; i++) {
+            dir = scan_deque_take(&ctx->deques[(w->id + i) % ctx->num_workers], true);
+        }
+        
+        if (!dir) {
+            /* Idle until the last directory in flight is finished */
+            if (atomic_load(&ctx->pending) == 0) break;
+            sched_yield();
+            continue;
+        }
+        
+        scan_directory(w, dir);
+        free(dir);
+        atomic_fetch_sub(&ctx->pending, 1);
+    }
+    
+    scan_flush(w);
+    return NULL;
+}
+
+static unsigned scan_default_threads(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    
+    /* Threads mostly wait on metadata reads: oversubscribe for queue depth */
+    long threads = cpus * 2;
+    return threads > INDEX_SCAN_MAX_THREADS ? INDEX_SCAN_MAX_THREADS : (unsigned)threads;
+}
+
+int backend_index_scan_parallel(backend_index_t *idx, const char *mount_path,
+                                index_scan_opts_t *opts) {
+    if (!idx || !mount_path || !opts) return -1;
+    
+    opts->bytes_indexed = 0;
+    
+    scan_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.idx = idx;
+    ctx.opts = opts;
+    ctx.mount_len = strlen(mount_path);
+    ctx.skip_len = opts->skip_prefix ? strlen(opts->skip_prefix) : 0;
+    ctx.num_workers = opts->num_threads ? opts->num_threads : scan_default_threads();
+    if (ctx.num_workers > INDEX_SCAN_MAX_THREADS) ctx.num_workers = INDEX_SCAN_MAX_THREADS;
+    atomic_init(&ctx.pending, 0);
+    atomic_init(&ctx.count, 0);
+    atomic_init(&ctx.bytes, 0);
+    
+    if (ctx.mount_len + 2 >= PATH_MAX) return -1;
+    
+    ctx.root_fd = open(mount_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (ctx.root_fd < 0) return -1;
+    
+    ctx.deques = calloc(ctx.num_workers, sizeof(scan_deque_t));
+    scan_worker_t *workers = calloc(ctx.num_workers, sizeof(scan_worker_t));
+    if (!ctx.deques || !workers) {
+        free(ctx.deques);
+        free(workers);
+        close(ctx.root_fd);
+        return -1;
+    }
+    
+    pthread_mutex_init(&ctx.progress_lock, NULL);
+    for (unsigned i = 0; i < ctx.num_workers; i++) {
+        pthread_mutex_init(&ctx.deques[i].lock, NULL);
+        workers[i].ctx = &ctx;
+        workers[i].id = i;
+        workers[i].dents = malloc(INDEX_SCAN_DENTS_BYTES);
+        memcpy(workers[i].path, mount_path, ctx.mount_len);
+    }
+    
+    int ret = 0;
+    if (!workers[0].dents) {
+        ret = -1;
+    } else {
+        /* The caller is worker 0; helpers missing a buffer or thread just
+         * leave their share to be stolen */
+        scan_push_dir(&workers[0], "", 0);
+        
+        for (unsigned i = 1; i < ctx.num_workers; i++) {
+            if (!workers[i].dents ||
+                pthread_create(&workers[i].thread, NULL, scan_worker_run, &workers[i]) != 0) {
+                free(workers[i].dents);
+                workers[i].dents = NULL;
             }
         }
         
-        closedir(dir);
-        return 0;
+        scan_worker_run(&workers[0]);
+        
+        for (unsigned i = 1; i < ctx.num_workers; i++) {
+            if (workers[i].dents) pthread_join(workers[i].thread, NULL);
+        }
     }
     
-    scan_dir_recursive(mount_path, mount_path_len);
+    for (unsigned i = 0; i < ctx.num_workers; i++) {
+        free(workers[i].dents);
+        free(ctx.deques[i].items);
+        pthread_mutex_destroy(&ctx.deques[i].lock);
+    }
+    free(workers);
+    free(ctx.deques);
+    pthread_mutex_destroy(&ctx.progress_lock);
+    close(ctx.root_fd);
+    
+    if (ret < 0) return -1;
     
-    if (progress_cb) {
-        progress_cb(count, user_data);
+    if (opts->progress_cb) {
+        opts->progress_cb(atomic_load(&ctx.count), opts->user_data);
     }
     
-    return (int)count;
+    opts->bytes_indexed = atomic_load(&ctx.bytes);
+    return (int)atomic_load(&ctx.count);
+}
+
+int backend_index_scan(backend_index_t *idx, const char *mount_path,
+                       void (*progress_cb)(size_t count, void *data),
+                       void *user_data) {
+    index_scan_opts_t opts = {
+        .entry_flags = INDEX_FLAG_PERSISTENT,
+        .progress_cb = progress_cb,
+        .user_data = user_data,
+    };
+    return backend_index_scan_parallel(idx, mount_path, &opts);
 }
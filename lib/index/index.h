@@ -8,8 +8,10 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <stdatomic.h>
 #include <pthread.h>
+#include "prefix.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,11 +26,48 @@ typedef struct fd_ref fd_ref_t;
 /* ============================================================================
  * Constants
  * ============================================================================ */
-
+ 
 #define INDEX_DEFAULT_BUCKETS  (1024 * 1024)  /* 1M buckets */
 #define INDEX_MAX_OPEN_FDS     10000          /* Max cached FDs */
+#define INDEX_SHARD_BITS       6              /* 64 global index shards */
+#define INDEX_NUM_SHARDS       (1 << INDEX_SHARD_BITS)
+#define INDEX_MIN_SHARD_BUCKETS 16            /* Initial per-shard floor */
+#define INDEX_MAX_LOAD_FACTOR  1              /* Grow a shard above 1 entry/bucket */
+#define INDEX_REHASH_STEP      8              /* Old buckets (or groups) moved per write */
+#define INDEX_GROUP_SLOTS      16             /* Slots per probe group (one SIMD compare) */
+#define INDEX_GROUP_MAX_LOAD   7              /* Grow a grouped table above 7/8 used slots */
 #define INDEX_MAGIC            "OBJIDX"
-#define INDEX_VERSION          1
+#define INDEX_VERSION          3              /* mmap-able slot table + arena, wyhash */
+#define INDEX_IMAGE_ALIGN      4096           /* Slot table offset (page) */
+#define INDEX_IMAGE_MIN_SLOTS  16
+#define INDEX_FILTER_SLOTS     4              /* 16-bit fingerprints per filter bucket */
+#define INDEX_FILTER_MAX_KICKS 500            /* Cuckoo relocations before growing */
+#define INDEX_JOURNAL_MAGIC    "OBJJNL"
+#define INDEX_JOURNAL_VERSION  1
+#define INDEX_SCAN_MAX_THREADS 32             /* Cap for the parallel scanner */
+#define INDEX_SCAN_BATCH       256            /* Entries per bulk insert */
+#define INDEX_SCAN_DENTS_BYTES (64 * 1024)    /* getdents64 buffer per worker */
+#define INDEX_ENTRY_SLOT_SIZE  256            /* Slab slot per entry */
+#define INDEX_SLAB_BYTES       (1024 * 1024)  /* Slots are carved from 1MB chunks */
+#define INDEX_SLAB_MAGAZINE    64             /* Free slots cached per thread */
+#define INDEX_MAX_ROOTS        64             /* Backend ids with a derivable path */
+#define INDEX_ACCESS_SAMPLE    16             /* Entry counters written every Nth access */
+#define INDEX_ACCESS_GRAIN_US  1000           /* last_access resolution */
+#define INDEX_NODE_VOTES_MAX   15             /* Reader node vote saturation */
+#define INDEX_ACCESS_STRIPES   16             /* Access buffers (threads spread over them) */
+#define INDEX_ACCESS_RING      64             /* Buffered accesses per stripe */
+#define INDEX_SKETCH_DEPTH     4              /* Count-min rows */
+#define INDEX_SKETCH_MIN_WIDTH (16 * 1024)    /* Counters per row */
+#define INDEX_SKETCH_MAX_WIDTH (4 * 1024 * 1024)
+#define INDEX_SKETCH_AGE_FACTOR 10            /* Halve counters every width * N increments */
+#define INDEX_FREQ_MAX         15             /* 4-bit sketch counters */
+
+/* Journal record types */
+#define INDEX_JOURNAL_PUT      1              /* Object created or changed */
+#define INDEX_JOURNAL_DEL      2              /* Object left the backend */
+
+/* Image slot states (live only in a private mapping, 0 on disk) */
+#define INDEX_IMAGE_CLAIMED    0x01           /* Superseded by an in-memory entry */
 
 /* Object flags */
 #define INDEX_FLAG_EPHEMERAL   0x01  /* Volatile storage only */
@@ -36,75 +75,183 @@ typedef struct fd_ref fd_ref_t;
 #define INDEX_FLAG_PINNED      0x04  /* Cannot evict/migrate */
 #define INDEX_FLAG_ENCRYPTED   0x08  /* Encrypted at rest */
 #define INDEX_FLAG_COMPRESSED  0x10  /* Compressed */
+#define INDEX_FLAG_CACHED      0x20  /* Cache copy; durable copy on home backend */
+#define INDEX_FLAG_SEALED      0x40  /* Anonymous object sealed against writes */
+#define INDEX_FLAG_UNSETTLED   0x80  /* Handed to an FD writer: size and mtime
+                                      * are only known from the file */
+#define INDEX_FLAG_CHUNKED     0x100 /* Manifest of an object stored as chunk objects */
 
 /* ============================================================================
  * Types
  * ============================================================================ */
-
+ 
 /**
  * Index entry (hash table node)
- * Lock-free reads via RCU, coordinated writes
+ * Lock-free reads inside epoch sections, coordinated writes. Memory, the
+ * cached FD and replaced backend paths are reclaimed through the epoch
+ * scheme, so a reader that found an entry may use it until it exits.
+ * 
+ * Entries live in INDEX_ENTRY_SLOT_SIZE slab slots. Everything a lookup
+ * reads comes first; the counters written on every access sit on their own
+ * cache line so hits on one entry do not invalidate its lookup fields in
+ * other cores. URIs shorter than INDEX_URI_INLINE are stored in the slot.
  */
 struct index_entry {
-    /* Key */
-    char *uri;                       /* Object URI (owned) */
+    /* ---- Read-mostly: chain walk, key compare, FD, metadata ---- */
+    atomic_uintptr_t next;           /* Next in global collision chain (atomic for RCU) */
     uint64_t uri_hash;               /* Precomputed hash */
+    char *uri;                       /* Object URI (uri_inline or owned copy) */
     
-    /* Location */
+    /* Location. Normally the path is not stored: it is the backend root
+     * registered with global_index_set_backend_root() plus the URI. Read it
+     * with index_entry_path(). Anonymous objects store their memfd. */
+    atomic_uintptr_t location;       /* Tagged root or memfd, or owned full path */
     uint32_t backend_id;             /* Backend where object lives */
-    char *backend_path;              /* Full path to object */
+    uint32_t home_backend_id;        /* Durable copy (differs when CACHED) */
     
-    /* File descriptor state */
-    atomic_int fd;                   /* Open FD (-1 if closed) */
-    atomic_int fd_refcount;          /* FD reference count */
-    atomic_int fd_generation;        /* Generation for reopen detection */
+    /* File descriptor state (shared read-only FD cache) */
+    atomic_int fd;                   /* Cached O_RDONLY FD (-1 if closed) */
+    atomic_int fd_generation;        /* Bumped on close/evict/relocation */
     
     /* Object metadata */
     uint64_t size_bytes;             /* Object size */
     uint64_t mtime;                  /* Modification time */
     uint32_t flags;                  /* Object flags */
+    uint32_t uri_len;                /* strlen(uri) */
     
-    /* Access tracking */
-    atomic_uint_fast64_t access_count;  /* Total accesses */
-    atomic_uint_fast64_t last_access;   /* Last access timestamp (monotonic) */
-    float hotness_score;             /* Cached hotness (updated periodically) */
+    atomic_uintptr_t backend_next;   /* Next in backend index collision chain */
     
-    /* Entry lifecycle */
-    atomic_int entry_refcount;       /* Entry reference count */
+    /* FD cache LRU linkage (protected by global_index lru_lock) */
+    index_entry_t *lru_prev;
+    index_entry_t *lru_next;
+    int lru_linked;                  /* On the FD cache LRU list */
+    int fd_cache_closed;             /* Removed from index: never cache again */
+    
+    /* ---- Write-hot: touched by every hit ---- */
+    atomic_int fd_recent __attribute__((aligned(64)));  /* CLOCK bit, set on cache hit */
+    atomic_int entry_refcount;       /* Entry reference count (0 = retired) */
+    atomic_uint_fast64_t access_count;  /* Total accesses (sampled, approximate) */
+    atomic_uint_fast64_t last_access;   /* Last access (monotonic, INDEX_ACCESS_GRAIN_US) */
+    float hotness_score;             /* Cached hotness (updated periodically) */
+    atomic_uint reader_node;         /* Majority reader node vote (node + 1, votes << 8) */
     
-    /* Hash table linkage */
-    atomic_uintptr_t next;           /* Next in collision chain (atomic for RCU) */
+    /* Inline URI storage, up to the end of the slab slot */
+    char uri_inline[];
 };
 
 /**
  * FD reference handle
- * Holds reference to entry and FD, ensures FD stays valid
+ * Holds reference to entry and a private FD owned by the handle.
+ * 
+ * FDs from lookups are dup()s of the entry's cached O_RDONLY descriptor and
+ * therefore share its file offset: readers must use pread()/mmap(), not
+ * read(). FDs from backend_create_object() are private O_RDWR descriptors.
  */
 struct fd_ref {
     index_entry_t *entry;            /* Associated entry */
-    int fd;                          /* Cached FD value */
-    int generation;                  /* Generation when acquired */
+    int fd;                          /* Private FD (closed on release) */
+    int generation;                  /* Entry fd_generation when acquired */
+    global_index_t *idx;             /* Owning index (NULL = uncached) */
 };
 
+/**
+ * Global index table layout
+ */
+typedef enum {
+    INDEX_TABLE_GROUPED = 0,         /* Open-addressed groups with 1-byte tags (default) */
+    INDEX_TABLE_CHAINED              /* Bucket array of collision chains */
+} index_table_mode_t;
+
+/**
+ * Probe group of a grouped table
+ *
+ * Each tag holds the low 7 bits of the entry's hash, or one of the empty or
+ * deleted markers (high bit set), so a probe compares all tags of a group
+ * at once. A writer publishes the slot before its tag; readers only use a
+ * tag as a hint and always compare the entry itself. Within one table an
+ * empty tag is never recreated in a group that has lost all its empties,
+ * which keeps lock-free probes from stopping short of a present key.
+ */
+typedef struct index_group {
+    uint8_t tags[INDEX_GROUP_SLOTS];
+    atomic_uintptr_t slots[INDEX_GROUP_SLOTS];
+} __attribute__((aligned(16))) index_group_t;
+
+/**
+ * Table of one global index shard
+ */
+typedef struct index_table {
+    size_t num_buckets;              /* Chain heads, or slots when grouped (power of 2) */
+    size_t num_groups;               /* Probe groups, 0 for a chained table */
+    size_t used_slots;               /* Grouped: full or deleted slots (shard lock) */
+    index_group_t *groups;           /* Grouped: probe groups (same allocation) */
+    atomic_uintptr_t buckets[];      /* Chained: entry lists (atomic for RCU) */
+} index_table_t;
+
+/**
+ * Global index shard
+ * 
+ * Writers serialize on the shard lock. Growth is incremental: when the load
+ * factor is exceeded a table of twice the size becomes current and every
+ * subsequent write moves INDEX_REHASH_STEP buckets from the old one. Moving
+ * an entry relinks it, so a lock-free reader walking the old chain may be
+ * carried into the new one; resize_seq is odd while a bucket moves and
+ * readers retry a miss that overlapped a move. Grouped tables drain the same
+ * way, a group at a time, and are also rebuilt at the same size when
+ * deleted slots rather than entries fill them.
+ */
+typedef struct index_shard {
+    pthread_mutex_t write_lock;      /* Serializes writers on this shard */
+    atomic_uintptr_t table;          /* Current index_table_t (inserts go here) */
+    atomic_uintptr_t old_table;      /* Table being drained, or 0 */
+    size_t rehash_pos;               /* Next old bucket to move */
+    atomic_uint resize_seq;          /* Odd while a bucket is being moved */
+    atomic_size_t num_entries;       /* Entries in this shard */
+} __attribute__((aligned(64))) index_shard_t;
+
 /**
  * Global index
- * RCU-protected hash table for fast lookups
+ * Sharded RCU-style hash table for fast lookups; the shard is picked by the
+ * top INDEX_SHARD_BITS of the URI hash and the bucket by the low bits.
+ */
+/**
+ * Access buffer stripe
+ * Multi-producer ring of URI hashes. Producers reserve a slot by moving
+ * head; the drainer (holding the sketch lock) consumes up to tail. A full
+ * stripe drops accesses rather than wait.
  */
+typedef struct index_access_stripe {
+    atomic_uint head __attribute__((aligned(64)));
+    atomic_uint tail;
+    atomic_uint_fast64_t slots[INDEX_ACCESS_RING];  /* hash | 1; 0 = empty */
+} index_access_stripe_t;
+
+/**
+ * Count-min sketch of recent access frequency
+ * INDEX_SKETCH_DEPTH rows of 4-bit counters, 16 per word. Only the lock
+ * holder writes; estimates read the words lock-free. Every counter is
+ * halved once width * INDEX_SKETCH_AGE_FACTOR increments were applied,
+ * so the estimate tracks the recent window rather than all time.
+ */
+typedef struct index_sketch {
+    atomic_uint_fast64_t *table;     /* depth * row_words words */
+    size_t row_words;                /* Power of 2 */
+    uint64_t additions;              /* Increments since the last aging */
+    uint64_t age_period;             /* Increments between agings */
+    pthread_mutex_t lock;            /* Drains and aging */
+    atomic_uint_fast64_t agings;
+} index_sketch_t;
+
 struct global_index {
     /* Hash table */
-    atomic_uintptr_t *buckets;       /* Array of entry lists (atomic for RCU) */
-    size_t num_buckets;              /* Number of buckets (power of 2) */
-    atomic_size_t num_entries;       /* Total entries */
-    
-    /* Write coordination */
-    pthread_mutex_t write_lock;      /* Serializes writers */
+    index_shard_t shards[INDEX_NUM_SHARDS];
     
     /* FD management */
     size_t max_open_fds;             /* Max FDs to cache */
     atomic_size_t num_open_fds;      /* Currently open FDs */
     
-    /* LRU for FD eviction */
-    pthread_mutex_t lru_lock;        /* Protects LRU list */
+    /* LRU for FD eviction (CLOCK second chance: hits only set fd_recent) */
+    pthread_mutex_t lru_lock;        /* Protects LRU list and cache fills */
     index_entry_t *lru_head;         /* LRU list head (MRU) */
     index_entry_t *lru_tail;         /* LRU list tail (LRU) */
     
@@ -116,8 +263,23 @@ struct global_index {
     atomic_uint_fast64_t stat_fd_opens;
     atomic_uint_fast64_t stat_fd_closes;
     atomic_uint_fast64_t stat_fd_evictions;
+    atomic_uint_fast64_t stat_resizes;
+    
+    /* Backend roots (interned, never freed): path = root + URI */
+    atomic_uintptr_t roots[INDEX_MAX_ROOTS];
+    
+    /* Access frequency (TinyLFU): lookups append URI hashes to a stripe
+     * (owned by a few threads), batches are applied to the sketch */
+    index_access_stripe_t *access_stripes;  /* INDEX_ACCESS_STRIPES */
+    index_sketch_t sketch;
+    
+    /* Every URI in byte order, for prefix iteration (prefix.h) */
+    index_prefix_t prefix;
 };
 
+/* Bytes of URI (including the NUL) that fit in an entry's slab slot */
+#define INDEX_URI_INLINE (INDEX_ENTRY_SLOT_SIZE - offsetof(struct index_entry, uri_inline))
+
 /**
  * Backend index
  * Per-backend index with optional persistence
@@ -134,6 +296,7 @@ struct backend_index {
     char *index_file_path;           /* Path to persistent index */
     int persist_enabled;             /* Whether to persist */
     atomic_int dirty;                /* Needs sync to disk */
+    uint64_t generation;             /* Image generation last saved or loaded */
     
     /* Statistics */
     atomic_uint_fast64_t stat_lookups;
@@ -148,6 +311,8 @@ struct backend_index {
  */
 typedef struct {
     uint64_t num_entries;
+    uint64_t num_buckets;            /* Buckets (or slots) in current shard tables */
+    uint64_t num_resizes;            /* Shard table growths */
     uint64_t num_open_fds;
     uint64_t lookups;
     uint64_t hits;
@@ -156,23 +321,147 @@ typedef struct {
     uint64_t fd_opens;
     uint64_t fd_closes;
     uint64_t fd_evictions;
+    uint64_t sketch_agings;          /* Frequency sketch halvings */
     double hit_rate;
     double fd_cache_rate;
 } index_stats_t;
 
+/**
+ * Entry metadata snapshot (for unpinned lookups)
+ */
+typedef struct {
+    uint32_t backend_id;
+    uint64_t size_bytes;
+    uint64_t mtime;
+    uint32_t flags;
+    int generation;                  /* fd_generation the FD belongs to */
+    uint64_t open_ns;                /* Time spent in open(), 0 = cached FD */
+} index_entry_info_t;
+
+/**
+ * Persistent index image header (first page of the file)
+ *
+ * The image is used in place through a private mapping, so every field is
+ * stored in host byte order; byte_order rejects images from other hosts.
+ */
+typedef struct index_image_header {
+    char magic[6];                   /* INDEX_MAGIC */
+    uint16_t version;                /* INDEX_VERSION */
+    uint32_t byte_order;             /* 0x01020304 as stored by the writer */
+    uint32_t backend_id;             /* Backend the image describes */
+    uint64_t generation;             /* Journal generation it supersedes */
+    uint64_t num_slots;              /* Slot table size (power of 2) */
+    uint64_t num_entries;            /* Occupied slots */
+    uint64_t total_bytes;            /* Sum of object sizes */
+    uint64_t slots_offset;           /* File offset of the slot table */
+    uint64_t arena_offset;           /* File offset of the string arena */
+    uint64_t arena_size;             /* String arena length */
+    uint32_t filter_buckets;         /* Negative filter after the arena (0 = none) */
+    uint32_t header_crc;             /* CRC32 of the fields above */
+} index_image_header_t;
+
+/**
+ * Persistent index image slot (open addressing, linear probing)
+ *
+ * One cache line per probe. Strings live in the arena as URI, NUL, path,
+ * NUL. The checksum is verified when a slot is used, not when the image is
+ * opened, so startup touches only the header page.
+ */
+typedef struct index_image_slot {
+    uint64_t hash;                   /* URI hash with bit 0 set, 0 = empty */
+    uint64_t size_bytes;
+    uint64_t mtime;
+    uint64_t arena_off;              /* Offset of the URI in the arena */
+    uint16_t uri_len;
+    uint16_t path_len;
+    uint32_t flags;                  /* INDEX_FLAG_* */
+    uint32_t home_backend_id;
+    atomic_uint state;               /* INDEX_IMAGE_* (private to a mapping) */
+    uint32_t crc;                    /* CRC32 of the slot (state, crc = 0) + strings */
+    uint8_t reserved[12];
+} index_image_slot_t;
+
+/**
+ * Object record exchanged with images and journals
+ * Strings point into the image, the journal buffer or the caller's entry.
+ */
+typedef struct index_image_record {
+    const char *uri;
+    const char *path;
+    uint64_t size_bytes;
+    uint64_t mtime;
+    uint32_t flags;
+    uint32_t home_backend_id;
+} index_image_record_t;
+
+/**
+ * Mapped persistent index image
+ */
+typedef struct index_image {
+    void *map;                       /* MAP_PRIVATE mapping of the file */
+    size_t map_len;
+    const index_image_header_t *header;
+    index_image_slot_t *slots;
+    const char *arena;
+    uint64_t mask;                   /* num_slots - 1 */
+    uint64_t *filter;                /* Cuckoo filter buckets in the mapping, or NULL */
+    uint64_t filter_mask;            /* filter_buckets - 1 */
+} index_image_t;
+
+/**
+ * Append-only journal of mutations since the image was written
+ */
+typedef struct index_journal {
+    int fd;                          /* O_APPEND descriptor */
+    uint64_t generation;             /* Image generation it extends */
+    size_t replayed;                 /* Records replayed at open */
+    atomic_uint_fast64_t appended;   /* Records appended since open/reset */
+} index_journal_t;
+
+/**
+ * Parallel filesystem scan options
+ */
+typedef struct index_scan_opts {
+    global_index_t *global;          /* Also index here (NULL = backend only) */
+    uint32_t entry_flags;            /* INDEX_FLAG_* for new entries */
+    const char *skip_prefix;         /* Skip names with this prefix (NULL = none) */
+    unsigned num_threads;            /* Workers (0 = twice the online CPUs) */
+    void (*progress_cb)(size_t count, void *data);  /* Called serialized */
+    void *user_data;
+    uint64_t bytes_indexed;          /* Output: total size of indexed files */
+} index_scan_opts_t;
+
 /* ============================================================================
  * Global Index API
  * ============================================================================ */
-
+ 
 /**
  * Create global index
+ * Uses the grouped table layout; see global_index_create_mode().
  * 
- * @param num_buckets Number of hash buckets (will be rounded to power of 2)
+ * @param num_buckets Initial hash buckets, split across shards (each
+ *                    shard rounds to a power of 2 and grows on demand)
  * @param max_open_fds Maximum open FDs to cache
  * @return Global index, or NULL on error
  */
 global_index_t *global_index_create(size_t num_buckets, size_t max_open_fds);
 
+/**
+ * Create global index with an explicit table layout
+ * 
+ * INDEX_TABLE_GROUPED probes 16-slot groups of 1-byte hash tags with one
+ * SIMD compare (SSE2/NEON, scalar elsewhere) and touches an entry only on a
+ * tag match. INDEX_TABLE_CHAINED keeps a linked chain per bucket. Both keep
+ * lock-free reads; num_buckets counts slots for a grouped table.
+ * 
+ * @param num_buckets Initial hash buckets, split across shards
+ * @param max_open_fds Maximum open FDs to cache
+ * @param mode Table layout
+ * @return Global index, or NULL on error
+ */
+global_index_t *global_index_create_mode(size_t num_buckets, size_t max_open_fds,
+                                         index_table_mode_t mode);
+                                         
 /**
  * Destroy global index
  * Closes all FDs and frees memory.
@@ -181,9 +470,30 @@ global_index_t *global_index_create(size_t num_buckets, size_t max_open_fds);
  */
 void global_index_destroy(global_index_t *idx);
 
+/**
+ * Register the directory a backend stores its objects under
+ * 
+ * Entries inserted or relocated into that backend whose path is exactly
+ * root + URI stop storing the path; index_entry_path() rebuilds it. Roots
+ * are interned process-wide and never freed, so entries may outlive the
+ * index.
+ * 
+ * @param idx Global index
+ * @param backend_id Backend ID (below INDEX_MAX_ROOTS)
+ * @param root Mount path, without trailing slash (URIs start with '/')
+ * @return 0 on success, -1 on error
+ */
+int global_index_set_backend_root(global_index_t *idx, uint32_t backend_id,
+                                  const char *root);
+                                  
 /**
  * Lookup object and get FD reference (lock-free)
  * 
+ * On a cache hit the returned FD is a dup() of the entry's cached read-only
+ * descriptor (no path walk). On a miss the object is opened O_RDONLY and
+ * the descriptor cached, evicting the least recently used one when
+ * max_open_fds is reached. fd_ref->fd is -1 if the file cannot be opened.
+ * 
  * @param idx Global index
  * @param uri Object URI
  * @param fd_ref Output: FD reference (must be released with fd_ref_release)
@@ -191,6 +501,64 @@ void global_index_destroy(global_index_t *idx);
  */
 int global_index_lookup(global_index_t *idx, const char *uri, fd_ref_t *fd_ref);
 
+/**
+ * Lookup object and return a private FD without pinning the entry
+ * 
+ * Same FD semantics as global_index_lookup(), but the entry's reference
+ * count is never touched: the whole lookup runs inside one epoch section.
+ * Use when only the descriptor (and a metadata snapshot) is needed.
+ * 
+ * @param idx Global index
+ * @param uri Object URI
+ * @param info_out Output: metadata snapshot (may be NULL)
+ * @return Private FD (caller closes), or -1 if not found or not openable
+ */
+int global_index_lookup_fd(global_index_t *idx, const char *uri,
+                           index_entry_info_t *info_out);
+                           
+/**
+ * Hand the index an FD opened outside it (e.g. by an async I/O engine)
+ * 
+ * Counts as a lookup hit and an access, like global_index_lookup_fd().
+ * The descriptor is cached unless the entry moved or was removed after
+ * generation was sampled, in which case it is returned uncached.
+ * 
+ * @param idx Global index
+ * @param entry Entry the caller holds a reference on
+ * @param fd Read-only FD on the entry's location (ownership taken)
+ * @param generation entry->fd_generation sampled before the open
+ * @param info_out Output: metadata snapshot (may be NULL; open_ns untouched)
+ * @return Private FD (caller closes), or -1 on error
+ */
+int global_index_adopt_fd(global_index_t *idx, index_entry_t *entry, int fd,
+                          int generation, index_entry_info_t *info_out);
+                          
+/**
+ * Read an object's metadata without touching its FD
+ * 
+ * Lock-free like global_index_lookup_fd(), but no FD is opened or
+ * duplicated and the access is not recorded: for revalidation and STAT,
+ * which must not make an object look hot.
+ * 
+ * @param idx Global index
+ * @param uri Object URI
+ * @param info_out Output: metadata snapshot (generation and open_ns are 0)
+ * @return 0 on success, -1 if not found
+ */
+int global_index_lookup_info(global_index_t *idx, const char *uri,
+                             index_entry_info_t *info_out);
+                             
+/**
+ * Lookup entry without opening or duplicating any FD
+ * Does not count as an access.
+ * 
+ * @param idx Global index
+ * @param uri Object URI
+ * @return Entry with a reference held (release with index_entry_put),
+ *         or NULL if not found
+ */
+index_entry_t *global_index_get_entry(global_index_t *idx, const char *uri);
+
 /**
  * Insert entry into global index
  * Takes ownership of entry.
@@ -221,7 +589,19 @@ int global_index_remove(global_index_t *idx, const char *uri);
  */
 int global_index_update_backend(global_index_t *idx, const char *uri,
                                 uint32_t backend_id, const char *backend_path);
-
+                                
+/**
+ * Move an entry to an anonymous object (for migrations into memory)
+ * 
+ * @param idx Global index
+ * @param uri Object URI
+ * @param backend_id New backend ID
+ * @param fd Object descriptor (ownership taken on success)
+ * @return 0 on success, -1 if not found
+ */
+int global_index_update_backend_anon(global_index_t *idx, const char *uri,
+                                     uint32_t backend_id, int fd);
+                                     
 /**
  * Get index statistics
  * 
@@ -233,19 +613,21 @@ void global_index_get_stats(global_index_t *idx, index_stats_t *stats);
 /* ============================================================================
  * FD Reference API
  * ============================================================================ */
-
+ 
 /**
  * Acquire FD from reference
- * Increments refcount and ensures FD is open.
+ * Returns the handle's private FD, obtaining one from the FD cache if the
+ * handle has none or if the entry was relocated since it was acquired
+ * (fd_generation changed).
  * 
  * @param fd_ref FD reference from lookup
- * @return File descriptor, or -1 on error
+ * @return File descriptor (owned by fd_ref), or -1 on error
  */
 int fd_ref_acquire(fd_ref_t *fd_ref);
 
 /**
  * Release FD reference
- * Decrements refcount. Must be called when done with FD.
+ * Closes the handle's private FD and drops the entry reference.
  * 
  * @param fd_ref FD reference
  */
@@ -263,7 +645,7 @@ int fd_ref_dup(fd_ref_t *fd_ref);
 /* ============================================================================
  * Backend Index API
  * ============================================================================ */
-
+ 
 /**
  * Create backend index
  * 
@@ -275,7 +657,7 @@ int fd_ref_dup(fd_ref_t *fd_ref);
 backend_index_t *backend_index_create(uint32_t backend_id,
                                       const char *index_file_path,
                                       size_t num_buckets);
-
+                                      
 /**
  * Destroy backend index
  * 
@@ -285,6 +667,7 @@ void backend_index_destroy(backend_index_t *idx);
 
 /**
  * Load persistent index from disk
+ * Materializes every slot of the image; see index_image_open() for lazy use.
  * 
  * @param idx Backend index
  * @return Number of entries loaded, or -1 on error
@@ -292,7 +675,7 @@ void backend_index_destroy(backend_index_t *idx);
 int backend_index_load(backend_index_t *idx);
 
 /**
- * Save index to disk
+ * Save index to disk as an image
  * 
  * @param idx Backend index
  * @return 0 on success, -1 on error
@@ -301,6 +684,7 @@ int backend_index_save(backend_index_t *idx);
 
 /**
  * Scan backend filesystem and populate index
+ * Runs backend_index_scan_parallel() with default options.
  * 
  * @param idx Backend index
  * @param mount_path Backend mount path
@@ -311,7 +695,36 @@ int backend_index_save(backend_index_t *idx);
 int backend_index_scan(backend_index_t *idx, const char *mount_path,
                        void (*progress_cb)(size_t count, void *data),
                        void *user_data);
-
+                       
+/**
+ * Scan a backend filesystem with a pool of threads
+ * 
+ * Directories go through per-worker work-stealing queues. Each one is read
+ * with getdents64() through a descriptor opened relative to the mount, and
+ * files are stat()ed relative to that descriptor (directories known from
+ * d_type are not stat()ed at all). Entries are inserted in batches; when
+ * opts->global is set a URI already indexed there is skipped. Symlinked
+ * files are indexed, symlinked directories are not followed.
+ * 
+ * @param idx Backend index (entries get its backend_id)
+ * @param mount_path Backend mount path
+ * @param opts Options (bytes_indexed is written back)
+ * @return Number of objects indexed, or -1 on error
+ */
+int backend_index_scan_parallel(backend_index_t *idx, const char *mount_path,
+                                index_scan_opts_t *opts);
+                                
+/**
+ * Insert a batch of entries into the backend index under one lock
+ * 
+ * @param idx Backend index
+ * @param entries Entries to insert (each shares ownership with caller)
+ * @param count Number of entries
+ * @return Number of entries inserted
+ */
+size_t backend_index_insert_bulk(backend_index_t *idx, index_entry_t **entries,
+                                 size_t count);
+                                 
 /**
  * Insert entry into backend index
  * 
@@ -324,6 +737,9 @@ int backend_index_insert(backend_index_t *idx, index_entry_t *entry);
 /**
  * Lookup in backend index
  * 
+ * The returned pointer is not referenced: callers must be inside an epoch
+ * section or hold a lock that excludes removal (e.g. the backend lock).
+ * 
  * @param idx Backend index
  * @param uri Object URI
  * @return Index entry, or NULL if not found
@@ -339,10 +755,173 @@ index_entry_t *backend_index_lookup(backend_index_t *idx, const char *uri);
  */
 int backend_index_remove(backend_index_t *idx, const char *uri);
 
+/**
+ * Collect a batch of entries for incremental iteration
+ * 
+ * Walks buckets starting at *cursor and stores referenced entries until
+ * max_entries is reached or the table ends. Whole buckets are collected,
+ * so *cursor always lands on a bucket boundary (a single bucket longer
+ * than max_entries is truncated); it wraps to 0 after the last bucket.
+ * Callers must index_entry_put() every returned entry.
+ * 
+ * @param idx Backend index
+ * @param cursor Bucket cursor (in/out, start at 0)
+ * @param entries_out Array of at least max_entries slots
+ * @param max_entries Batch size
+ * @return Number of entries stored
+ */
+size_t backend_index_collect(backend_index_t *idx, size_t *cursor,
+                             index_entry_t **entries_out, size_t max_entries);
+                             
+/* ============================================================================
+ * Persistent Index Image API
+ * ============================================================================
+ *
+ * A backend's index is persisted as an image that is mapped and probed in
+ * place: opening it validates the header only, and slots are checksummed
+ * and turned into index entries as lookups first reach them. Mutations
+ * after the image was written go to a journal that records its generation;
+ * a stale journal (older generation) is discarded, a torn tail is cut.
+ */
+ 
+/**
+ * Write an image to path (via path.tmp, fsync and rename)
+ * 
+ * The directory is fsynced after the rename: once this returns, a crash
+ * can no longer bring back the previous image.
+ * 
+ * @param path Image file path
+ * @param backend_id Backend the records belong to
+ * @param generation Generation stored in the header
+ * @param records Records with unique URIs
+ * @param count Number of records
+ * @return 0 on success, -1 on error
+ */
+int index_image_write(const char *path, uint32_t backend_id, uint64_t generation,
+                      const index_image_record_t *records, size_t count);
+                      
+/**
+ * Map an image and validate its header
+ * 
+ * @param path Image file path
+ * @return Image, or NULL if missing, foreign or corrupt
+ */
+index_image_t *index_image_open(const char *path);
+
+/**
+ * Unmap an image
+ * Records returned by it become invalid.
+ * 
+ * @param img Image
+ */
+void index_image_close(index_image_t *img);
+
+/**
+ * Find the unclaimed slot of a URI
+ * Slots failing their checksum are treated as absent.
+ * 
+ * @param img Image
+ * @param uri Object URI
+ * @param rec_out Output: record (strings point into the mapping)
+ * @return Slot number, or -1 if not found
+ */
+int64_t index_image_find(index_image_t *img, const char *uri,
+                         index_image_record_t *rec_out);
+                         
+/**
+ * Mark a slot as superseded so it is never returned again
+ * 
+ * @param img Image
+ * @param slot Slot from index_image_find()
+ * @return true if this call claimed it, false if it already was
+ */
+bool index_image_claim(index_image_t *img, int64_t slot);
+
+/**
+ * Check the image's negative filter
+ * A cuckoo filter over the unclaimed slots: false means the URI is
+ * definitely not in the image. Images without a filter always say maybe.
+ * 
+ * @param img Image
+ * @param uri Object URI
+ * @return false if the URI is absent, true if it may be present
+ */
+bool index_image_may_contain(index_image_t *img, const char *uri);
+
+/**
+ * Visit every valid unclaimed slot
+ * 
+ * @param img Image
+ * @param cb Callback (record strings point into the mapping)
+ * @param data User data for callback
+ * @return Number of slots visited
+ */
+size_t index_image_foreach(index_image_t *img,
+                           void (*cb)(const index_image_record_t *rec,
+                                      int64_t slot, void *data),
+                           void *data);
+                           
+/**
+ * Open a journal, replaying the records that extend generation
+ * 
+ * A journal of another generation is reset to an empty one for generation.
+ * Replay stops at the first truncated or corrupt record and the file is cut
+ * there, so later appends stay reachable.
+ * 
+ * @param path Journal file path
+ * @param generation Generation of the image being restored
+ * @param apply Replay callback (may be NULL)
+ * @param data User data for callback
+ * @return Journal ready for appends, or NULL on error
+ */
+index_journal_t *index_journal_open(const char *path, uint64_t generation,
+                                    void (*apply)(int op,
+                                                  const index_image_record_t *rec,
+                                                  void *data),
+                                    void *data);
+                                    
+/**
+ * Append one record (a single write(); not synced, see index_journal_sync())
+ * 
+ * @param j Journal
+ * @param op INDEX_JOURNAL_PUT or INDEX_JOURNAL_DEL
+ * @param rec Record (only uri is used for DEL)
+ * @return 0 on success, -1 on error
+ */
+int index_journal_append(index_journal_t *j, int op,
+                         const index_image_record_t *rec);
+                         
+/**
+ * Make every record appended so far durable (fdatasync)
+ * 
+ * @param j Journal
+ * @return 0 on success, -1 on error
+ */
+int index_journal_sync(index_journal_t *j);
+
+/**
+ * Truncate a journal after a new image was written (synced on return)
+ * 
+ * Call only once the image is durable (index_image_write() returned):
+ * a journal of the new generation is discarded against the old image.
+ * 
+ * @param j Journal
+ * @param generation Generation of the new image
+ * @return 0 on success, -1 on error
+ */
+int index_journal_reset(index_journal_t *j, uint64_t generation);
+
+/**
+ * Close a journal
+ * 
+ * @param j Journal
+ */
+void index_journal_close(index_journal_t *j);
+
 /* ============================================================================
  * Index Entry API
  * ============================================================================ */
-
+ 
 /**
  * Create index entry
  * 
@@ -353,17 +932,64 @@ int backend_index_remove(backend_index_t *idx, const char *uri);
  */
 index_entry_t *index_entry_create(const char *uri, uint32_t backend_id,
                                   const char *backend_path);
+                                  
+/**
+ * Create index entry for an anonymous object
+ * 
+ * The descriptor (typically a memfd) is the object: the entry owns it and
+ * closes it when reclaimed. Read-only FDs are reopened from it, or dup()ed
+ * once the entry is INDEX_FLAG_SEALED; no path is ever walked.
+ * 
+ * @param uri Object URI
+ * @param backend_id Backend ID
+ * @param fd Object descriptor (ownership taken, also on error)
+ * @return Index entry, or NULL on error
+ */
+index_entry_t *index_entry_create_anon(const char *uri, uint32_t backend_id, int fd);
+
+/**
+ * Get the descriptor of an anonymous entry
+ * 
+ * @param entry Index entry (caller holds the lock that keeps it in place,
+ *              or an epoch section)
+ * @return The entry's own descriptor (do not close), or -1 if it has a path
+ */
+int index_entry_anon_fd(const index_entry_t *entry);
+
+/**
+ * Get the filesystem path of an entry's current location
+ * 
+ * Safe against a concurrent relocation: the result is either the old or
+ * the new path. For anonymous entries this is /proc/self/fd/<fd>, which
+ * this process can open but which is not persistent.
+ * 
+ * @param entry Index entry (caller holds a reference or an epoch section)
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @return 0 on success, -1 if the path does not fit
+ */
+int index_entry_path(const index_entry_t *entry, char *buf, size_t size);
 
 /**
- * Acquire reference to entry (RCU-safe)
+ * Acquire reference to entry
+ * Caller must already hold a reference (or the lock that keeps it indexed).
  * 
  * @param entry Index entry
  */
 void index_entry_get(index_entry_t *entry);
 
+/**
+ * Acquire reference to an entry found inside an epoch section
+ * Fails if the last reference is already gone (entry is being retired).
+ * 
+ * @param entry Index entry
+ * @return true if a reference was taken
+ */
+bool index_entry_tryget(index_entry_t *entry);
+
 /**
  * Release reference to entry
- * When refcount reaches zero, entry is freed.
+ * When refcount reaches zero, entry is retired (freed after a grace period).
  * 
  * @param entry Index entry
  */
@@ -379,7 +1005,7 @@ int index_entry_open_fd(index_entry_t *entry);
 
 /**
  * Close FD for entry
- * Only closes if refcount is zero.
+ * The descriptor itself is closed after a grace period.
  * 
  * @param entry Index entry
  */
@@ -388,14 +1014,113 @@ void index_entry_close_fd(index_entry_t *entry);
 /**
  * Record access to entry (updates access count and time)
  * 
+ * Sampled so hot entries stay read-mostly: the count moves in steps of
+ * INDEX_ACCESS_SAMPLE on every INDEX_ACCESS_SAMPLE-th call of a thread,
+ * and the time is only stored once it is INDEX_ACCESS_GRAIN_US stale.
+ * Global index lookups call this and also feed the frequency sketch.
+ * 
  * @param entry Index entry
  */
 void index_entry_record_access(index_entry_t *entry);
 
+/**
+ * Set the memory node of the calling thread
+ * 
+ * Accesses recorded by a thread with a node vote for it as the entry's
+ * reader node (a saturating majority vote, stored only when it changes).
+ * Threads without one (the default, -1) do not vote.
+ * 
+ * @param node NUMA node, or -1
+ */
+void index_set_thread_node(int node);
+
+/**
+ * Node that reads an entry most
+ * 
+ * @param entry Index entry
+ * @param votes_out Output: vote margin, 1 to INDEX_NODE_VOTES_MAX (may be NULL)
+ * @return Node, or -1 if no thread with a node has read the entry
+ */
+int index_entry_reader_node(const index_entry_t *entry, uint32_t *votes_out);
+
+/**
+ * Apply every buffered access to the frequency sketch
+ * Lookups drain full stripes themselves; call this before reading
+ * estimates that must include the latest accesses.
+ * 
+ * @param idx Global index
+ */
+void global_index_drain_accesses(global_index_t *idx);
+
+/**
+ * Estimated recent access frequency of an entry
+ * 
+ * @param idx Global index
+ * @param entry Index entry
+ * @return Count-min estimate, 0 to INDEX_FREQ_MAX
+ */
+uint32_t global_index_frequency(global_index_t *idx, const index_entry_t *entry);
+
+/**
+ * Hotness score from recency and sketch frequency
+ * Like index_calculate_hotness(), with the frequency term taken from the
+ * aged sketch (relative to INDEX_FREQ_MAX) instead of the lifetime count.
+ * 
+ * @param idx Global index
+ * @param entry Index entry
+ * @param current_time Current time (monotonic)
+ * @param decay_halflife Decay half-life in seconds
+ * @return Hotness score (0.0-1.0)
+ */
+float global_index_hotness(global_index_t *idx, const index_entry_t *entry,
+                           uint64_t current_time, uint32_t decay_halflife);
+                           
+/* ============================================================================
+ * Epoch-Based Reclamation
+ * ============================================================================
+ *
+ * One process-wide domain shared by the global and backend indexes. Readers
+ * bracket lock-free traversals with index_epoch_enter()/index_epoch_exit();
+ * both are wait-free and may nest. Writers unlink an object first and then
+ * retire it; it is reclaimed once every thread that might have seen it has
+ * left its read section.
+ */
+ 
+/**
+ * Enter a read section (registers the calling thread on first use)
+ */
+void index_epoch_enter(void);
+
+/**
+ * Leave a read section
+ * Leaving the outermost section runs any collection a retire inside it
+ * deferred.
+ */
+void index_epoch_exit(void);
+
+/**
+ * Defer reclaim(ptr) until no reader can still reference ptr
+ * 
+ * @param reclaim Reclaim callback (free, close wrapper, ...)
+ * @param ptr Object passed to reclaim
+ */
+void index_epoch_retire(void (*reclaim)(void *), void *ptr);
+
+/**
+ * Wait until everything retired so far has been reclaimed
+ * Must not be called from inside a read section.
+ */
+void index_epoch_synchronize(void);
+
+/**
+ * Number of retired objects not yet reclaimed
+ */
+size_t index_epoch_pending(void);
+
 /* ============================================================================
  * Utility Functions
  * ============================================================================ */
-
+ 
 /**
  * Calculate hotness score for entry
  * Based on time-decayed access frequency.
@@ -407,7 +1132,7 @@ void index_entry_record_access(index_entry_t *entry);
  */
 float index_calculate_hotness(const index_entry_t *entry, uint64_t current_time,
                               uint32_t decay_halflife);
-
+                              
 /**
  * Hash string to uint64_t
  * 
@@ -416,6 +1141,17 @@ float index_calculate_hotness(const index_entry_t *entry, uint64_t current_time,
  */
 uint64_t index_hash_string(const char *str);
 
+/**
+ * Hash a byte range to uint64_t
+ * wyhash-style: 8 bytes at a time through a 64x64->128 multiply. The value
+ * is stored in index images, so changing it requires an INDEX_VERSION bump.
+ * 
+ * @param key Bytes to hash
+ * @param len Number of bytes
+ * @return Hash value
+ */
+uint64_t index_hash_bytes(const void *key, size_t len);
+
 /**
  * Round up to next power of 2
  * 
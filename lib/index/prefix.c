@@ -0,0 +1,526 @@
+/**
+ * @file prefix.c
+ * @brief Ordered URI index for prefix listings and purges
+ *
+ * Every add and remove takes the next index sequence number, under its
+ * shard's lock. An iterator's snapshot is the sequence when it opened, with
+ * every shard locked, so each change is either complete or not yet
+ * numbered. A URI lifetime is visible to the iterator if it was added at or
+ * before the snapshot and not removed by then. Lifetimes no open snapshot
+ * falls inside are dropped; a node with none left leaves its skip list.
+ * 
+ * The open iterator list changes only with every shard write-locked, so a
+ * writer reads it under its own shard's lock alone.
+ * 
+ * An iterator keeps a copy of the next URI it will return from each shard.
+ * Nothing it can see changes after the snapshot, so that head stays the
+ * shard's next visible URI, and a batch locks only the shards it takes
+ * URIs from. Exhausted shards are never locked again.
+ */
+
+#define _GNU_SOURCE
+#include "prefix.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Byte order of two keys */
+static int bytes_cmp(const char *a, size_t alen, const char *b, size_t blen) {
+    int c = memcmp(a, b, alen < blen ? alen : blen);
+    if (c != 0) return c;
+    return (alen > blen) - (alen < blen);
+}
+
+/* Order of a node's key against key */
+static int key_cmp(const index_prefix_node_t *node, const char *key, size_t len) {
+    return bytes_cmp(node->key, node->len, key, len);
+}
+
+/* Shard of a key, from the index's URI hash (bits the hash shards don't use) */
+static index_prefix_shard_t *shard_for(index_prefix_t *index, uint64_t hash) {
+    return &index->shards[(hash >> 32) % INDEX_PREFIX_SHARDS];
+}
+
+/* Write-lock every shard, in order (iterator open and close) */
+static void lock_all(index_prefix_t *index) {
+    for (int i = 0; i < INDEX_PREFIX_SHARDS; i++) {
+        pthread_rwlock_wrlock(&index->shards[i].lock);
+    }
+}
+
+static void unlock_all(index_prefix_t *index) {
+    for (int i = INDEX_PREFIX_SHARDS - 1; i >= 0; i--) {
+        pthread_rwlock_unlock(&index->shards[i].lock);
+    }
+}
+
+/**
+ * First node not below key
+ *
+ * @param update Output: the last node below key on every level (may be NULL)
+ */
+static index_prefix_node_t *seek(index_prefix_shard_t *shard, const char *key, size_t len,
+                                 index_prefix_node_t **update) {
+    index_prefix_node_t *node = shard->head;
+    for (int level = shard->height - 1; level >= 0; level--) {
+        while (node->next[level] && key_cmp(node->next[level], key, len) < 0) {
+            node = node->next[level];
+        }
+        if (update) update[level] = node;
+    }
+    return node->next[0];
+}
+
+static index_prefix_node_t *node_alloc(int height, const char *key, size_t len) {
+    index_prefix_node_t *node = malloc(sizeof(*node) + height * sizeof(node->next[0]) +
+                                       len + 1);
+    if (!node) return NULL;
+    
+    memset(node, 0, sizeof(*node) + height * sizeof(node->next[0]));
+    node->height = height;
+    node->len = len;
+    node->key = (char *)&node->next[height];
+    memcpy(node->key, key, len);
+    node->key[len] = '\0';
+    return node;
+}
+
+static void node_free(index_prefix_node_t *node) {
+    index_prefix_life_t *life = node->life.older;
+    while (life) {
+        index_prefix_life_t *older = life->older;
+        free(life);
+        life = older;
+    }
+    free(node);
+}
+
+/* 1 + 1 level in 4 (xorshift64; caller holds the shard's write lock) */
+static int random_height(index_prefix_shard_t *shard) {
+    uint64_t x = shard->rng;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    shard->rng = x;
+    
+    int height = 1;
+    while (height < INDEX_PREFIX_MAX_LEVEL && (x & 3) == 0) {
+        height++;
+        x >>= 2;
+    }
+    return height;
+}
+
+static bool life_visible(const index_prefix_life_t *life, uint64_t snapshot) {
+    return life->added <= snapshot && (life->removed == 0 || life->removed > snapshot);
+}
+
+static bool node_visible(const index_prefix_node_t *node, uint64_t snapshot) {
+    for (const index_prefix_life_t *life = &node->life; life; life = life->older) {
+        if (life_visible(life, snapshot)) return true;
+    }
+    return false;
+}
+
+/* Present, or visible to an open iterator (caller holds a shard lock) */
+static bool life_needed(const index_prefix_t *index, const index_prefix_life_t *life) {
+    if (life->removed == 0) return true;
+    for (const index_prefix_iter_t *iter = index->iters; iter; iter = iter->next) {
+        if (life_visible(life, iter->snapshot)) return true;
+    }
+    return false;
+}
+
+/**
+ * Drop the lifetimes nobody needs
+ *
+ * @return true if none is left (the node can go)
+ */
+static bool prune(index_prefix_t *index, index_prefix_node_t *node) {
+    index_prefix_life_t **link = &node->life.older;
+    while (*link) {
+        index_prefix_life_t *life = *link;
+        if (life_needed(index, life)) {
+            link = &life->older;
+            continue;
+        }
+        *link = life->older;
+        free(life);
+    }
+    
+    if (!life_needed(index, &node->life) && node->life.older) {
+        index_prefix_life_t *older = node->life.older;
+        node->life = *older;
+        free(older);
+    }
+    return !life_needed(index, &node->life);
+}
+
+static void unlink_node(index_prefix_shard_t *shard, index_prefix_node_t *node,
+                        index_prefix_node_t **update) {
+    for (int level = 0; level < node->height; level++) {
+        update[level]->next[level] = node->next[level];
+    }
+    while (shard->height > 1 && !shard->head->next[shard->height - 1]) {
+        shard->height--;
+    }
+}
+
+/* Free the tombstones no open iterator can see (caller holds the write lock) */
+static void sweep(index_prefix_t *index, index_prefix_shard_t *shard) {
+    index_prefix_node_t **link = &shard->tombstones;
+    while (*link) {
+        index_prefix_node_t *node = *link;
+        bool dead = prune(index, node);
+        if (!dead && (node->life.removed != 0 || node->life.older)) {
+            link = &node->next_tomb;
+            continue;
+        }
+    
+        *link = node->next_tomb;
+        node->tomb_listed = false;
+        shard->num_tombstones--;
+    
+        if (dead) {
+            index_prefix_node_t *update[INDEX_PREFIX_MAX_LEVEL];
+            seek(shard, node->key, node->len, update);
+            unlink_node(shard, node, update);
+            node_free(node);
+        }
+    }
+}
+
+int index_prefix_init(index_prefix_t *index) {
+    if (!index) return -1;
+    
+    memset(index, 0, sizeof(*index));
+    for (int i = 0; i < INDEX_PREFIX_SHARDS; i++) {
+        index_prefix_shard_t *shard = &index->shards[i];
+        shard->head = node_alloc(INDEX_PREFIX_MAX_LEVEL, "", 0);
+        if (!shard->head) {
+            index_prefix_destroy(index);
+            return -1;
+        }
+        shard->height = 1;
+        shard->rng = 0x9E3779B97F4A7C15ULL ^ (uintptr_t)shard;
+        pthread_rwlock_init(&shard->lock, NULL);
+    }
+    atomic_init(&index->seq, 0);
+    return 0;
+}
+
+void index_prefix_destroy(index_prefix_t *index) {
+    if (!index) return;
+    
+    for (int i = 0; i < INDEX_PREFIX_SHARDS; i++) {
+        index_prefix_shard_t *shard = &index->shards[i];
+        if (!shard->head) continue;
+    
+        index_prefix_node_t *node = shard->head->next[0];
+        while (node) {
+            index_prefix_node_t *next = node->next[0];
+            node_free(node);
+            node = next;
+        }
+        free(shard->head);
+        shard->head = NULL;
+        pthread_rwlock_destroy(&shard->lock);
+    }
+}
+
+int index_prefix_add(index_prefix_t *index, const char *key, size_t len, uint64_t hash) {
+    if (!index || !key) return -1;
+    
+    index_prefix_shard_t *shard = shard_for(index, hash);
+    index_prefix_node_t *update[INDEX_PREFIX_MAX_LEVEL];
+    
+    pthread_rwlock_wrlock(&shard->lock);
+    
+    index_prefix_node_t *node = seek(shard, key, len, update);
+    if (node && key_cmp(node, key, len) == 0) {
+        if (node->life.removed == 0) {
+            pthread_rwlock_unlock(&shard->lock);
+            return 0;
+        }
+    
+        /* Back after a remove: keep the old lifetime for iterators that see it */
+        if (life_needed(index, &node->life)) {
+            index_prefix_life_t *older = malloc(sizeof(*older));
+            if (!older) {
+                pthread_rwlock_unlock(&shard->lock);
+                return -1;
+            }
+            *older = node->life;
+            node->life.older = older;
+        }
+        node->life.added = atomic_fetch_add(&index->seq, 1) + 1;
+        node->life.removed = 0;
+        shard->num_keys++;
+        pthread_rwlock_unlock(&shard->lock);
+        return 1;
+    }
+    
+    int height = random_height(shard);
+    node = node_alloc(height, key, len);
+    if (!node) {
+        pthread_rwlock_unlock(&shard->lock);
+        return -1;
+    }
+    
+    for (int level = shard->height; level < height; level++) {
+        update[level] = shard->head;
+    }
+    if (height > shard->height) shard->height = height;
+    
+    for (int level = 0; level < height; level++) {
+        node->next[level] = update[level]->next[level];
+        update[level]->next[level] = node;
+    }
+    node->life.added = atomic_fetch_add(&index->seq, 1) + 1;
+    shard->num_keys++;
+    
+    pthread_rwlock_unlock(&shard->lock);
+    return 1;
+}
+
+int index_prefix_remove(index_prefix_t *index, const char *key, size_t len, uint64_t hash) {
+    if (!index || !key) return 0;
+    
+    index_prefix_shard_t *shard = shard_for(index, hash);
+    index_prefix_node_t *update[INDEX_PREFIX_MAX_LEVEL];
+    
+    pthread_rwlock_wrlock(&shard->lock);
+    
+    index_prefix_node_t *node = seek(shard, key, len, update);
+    if (!node || key_cmp(node, key, len) != 0 || node->life.removed != 0) {
+        pthread_rwlock_unlock(&shard->lock);
+        return 0;
+    }
+    
+    node->life.removed = atomic_fetch_add(&index->seq, 1) + 1;
+    shard->num_keys--;
+    
+    /* A node already on the tombstone list is left to the next sweep */
+    if (!node->tomb_listed) {
+        if (prune(index, node)) {
+            unlink_node(shard, node, update);
+            node_free(node);
+        } else {
+            node->next_tomb = shard->tombstones;
+            node->tomb_listed = true;
+            shard->tombstones = node;
+            shard->num_tombstones++;
+        }
+    }
+    
+    pthread_rwlock_unlock(&shard->lock);
+    return 1;
+}
+
+bool index_prefix_contains(index_prefix_t *index, const char *key, uint64_t hash) {
+    if (!index || !key) return false;
+    
+    size_t len = strlen(key);
+    index_prefix_shard_t *shard = shard_for(index, hash);
+    
+    pthread_rwlock_rdlock(&shard->lock);
+    index_prefix_node_t *node = seek(shard, key, len, NULL);
+    bool present = node && key_cmp(node, key, len) == 0 && node->life.removed == 0;
+    pthread_rwlock_unlock(&shard->lock);
+    
+    return present;
+}
+
+void index_prefix_counts(index_prefix_t *index, size_t *keys_out,
+                         size_t *tombstones_out) {
+    if (!index) return;
+    
+    size_t keys = 0, tombstones = 0;
+    for (int i = 0; i < INDEX_PREFIX_SHARDS; i++) {
+        index_prefix_shard_t *shard = &index->shards[i];
+        pthread_rwlock_rdlock(&shard->lock);
+        keys += shard->num_keys;
+        tombstones += shard->num_tombstones;
+        pthread_rwlock_unlock(&shard->lock);
+    }
+    if (keys_out) *keys_out = keys;
+    if (tombstones_out) *tombstones_out = tombstones;
+}
+
+static bool iter_covers(const index_prefix_iter_t *iter, const index_prefix_node_t *node) {
+    return node->len >= iter->prefix_len &&
+           memcmp(node->key, iter->prefix, iter->prefix_len) == 0;
+}
+
+/* First URI from node on that the iterator returns, NULL past the prefix */
+static index_prefix_node_t *iter_visible(const index_prefix_iter_t *iter,
+                                         index_prefix_node_t *node) {
+    for (; node && iter_covers(iter, node); node = node->next[0]) {
+        if (node_visible(node, iter->snapshot)) return node;
+    }
+    return NULL;
+}
+
+/* Make node a shard's head, NULL once it has nothing left (false if out
+ * of memory) */
+static bool iter_set_head(index_prefix_iter_t *iter, int i, const index_prefix_node_t *node) {
+    iter->heads[i] = NULL;
+    if (!node) return true;
+    
+    iter->heads[i] = malloc(node->len + 1);
+    if (!iter->heads[i]) return false;
+    memcpy(iter->heads[i], node->key, node->len + 1);
+    iter->head_lens[i] = node->len;
+    return true;
+}
+
+index_prefix_iter_t *index_prefix_iter_open(index_prefix_t *index, const char *prefix) {
+    if (!index || !prefix) return NULL;
+    
+    index_prefix_iter_t *iter = calloc(1, sizeof(*iter));
+    if (!iter) return NULL;
+    
+    iter->prefix = strdup(prefix);
+    if (!iter->prefix) {
+        free(iter);
+        return NULL;
+    }
+    iter->prefix_len = strlen(prefix);
+    iter->index = index;
+    
+    /* With every shard locked no change is half done */
+    lock_all(index);
+    iter->snapshot = atomic_load(&index->seq);
+    bool ok = true;
+    for (int i = 0; i < INDEX_PREFIX_SHARDS && ok; i++) {
+        index_prefix_shard_t *shard = &index->shards[i];
+        ok = iter_set_head(iter, i, iter_visible(iter, seek(shard, iter->prefix,
+                                                            iter->prefix_len, NULL)));
+    }
+    if (ok) {
+        iter->next = index->iters;
+        if (index->iters) index->iters->prev = iter;
+        index->iters = iter;
+    }
+    unlock_all(index);
+    
+    if (!ok) {
+        for (int i = 0; i < INDEX_PREFIX_SHARDS; i++) free(iter->heads[i]);
+        free(iter->prefix);
+        free(iter);
+        return NULL;
+    }
+    return iter;
+}
+
+/* A shard's place in the merge: its node once locked, else its head */
+typedef struct merge_pos {
+    const char *key;
+    size_t len;
+    int shard;
+} merge_pos_t;
+
+/* Restore the min-heap of shard positions below slot i */
+static void heap_down(merge_pos_t *heap, size_t n, size_t i) {
+    while (1) {
+        size_t least = i, left = 2 * i + 1, right = left + 1;
+        if (left < n && bytes_cmp(heap[left].key, heap[left].len,
+                                  heap[least].key, heap[least].len) < 0) least = left;
+        if (right < n && bytes_cmp(heap[right].key, heap[right].len,
+                                   heap[least].key, heap[least].len) < 0) least = right;
+        if (least == i) return;
+    
+        merge_pos_t pos = heap[i];
+        heap[i] = heap[least];
+        heap[least] = pos;
+        i = least;
+    }
+}
+
+size_t index_prefix_iter_next(index_prefix_iter_t *iter, char **keys, size_t max) {
+    if (!iter || !keys || max == 0 || iter->done) return 0;
+    
+    index_prefix_t *index = iter->index;
+    index_prefix_node_t *nodes[INDEX_PREFIX_SHARDS] = { NULL };
+    bool locked[INDEX_PREFIX_SHARDS] = { false };
+    merge_pos_t heap[INDEX_PREFIX_SHARDS];
+    int highest = -1;
+    size_t heads = 0, count = 0;
+    
+    for (int i = 0; i < INDEX_PREFIX_SHARDS; i++) {
+        if (!iter->heads[i]) continue;
+        heap[heads++] = (merge_pos_t){ iter->heads[i], iter->head_lens[i], i };
+    }
+    for (size_t i = heads / 2; i-- > 0;) heap_down(heap, heads, i);
+    
+    /* Merge the shards, least first. A shard is locked when the merge first
+     * reaches its head and stays locked for the rest of the batch. */
+    while (count < max && heads > 0) {
+        int i = heap[0].shard;
+        char *key;
+        if (!locked[i]) {
+            /* Shards are locked in order, as iterator open and close do;
+             * one below a held lock is only tried, and ends the batch if busy */
+            pthread_rwlock_t *lock = &index->shards[i].lock;
+            if (i < highest ? pthread_rwlock_tryrdlock(lock) != 0
+                            : pthread_rwlock_rdlock(lock) != 0) break;
+            locked[i] = true;
+            if (i > highest) highest = i;
+    
+            /* The head is visible to the snapshot, so it is still there */
+            nodes[i] = seek(&index->shards[i], iter->heads[i], iter->head_lens[i], NULL);
+            key = iter->heads[i];
+            iter->heads[i] = NULL;
+        } else {
+            key = malloc(nodes[i]->len + 1);
+            if (!key) break;
+            memcpy(key, nodes[i]->key, nodes[i]->len + 1);
+        }
+        keys[count++] = key;
+    
+        nodes[i] = iter_visible(iter, nodes[i]->next[0]);
+        if (nodes[i]) {
+            heap[0] = (merge_pos_t){ nodes[i]->key, nodes[i]->len, i };
+        } else {
+            heap[0] = heap[--heads];
+        }
+        heap_down(heap, heads, 0);
+    }
+    
+    /* Where each locked shard resumes */
+    bool ok = true, more = false;
+    for (int i = 0; i < INDEX_PREFIX_SHARDS; i++) {
+        if (locked[i]) {
+            if (ok) ok = iter_set_head(iter, i, nodes[i]);
+            pthread_rwlock_unlock(&index->shards[i].lock);
+        }
+        if (iter->heads[i]) more = true;
+    }
+    
+    /* Cannot resume after a failed copy: end here rather than repeat */
+    if (!ok || !more) iter->done = true;
+    return count;
+}
+
+void index_prefix_iter_close(index_prefix_iter_t *iter) {
+    if (!iter) return;
+    
+    index_prefix_t *index = iter->index;
+    
+    lock_all(index);
+    if (iter->prev) {
+        iter->prev->next = iter->next;
+    } else {
+        index->iters = iter->next;
+    }
+    if (iter->next) iter->next->prev = iter->prev;
+    for (int i = 0; i < INDEX_PREFIX_SHARDS; i++) {
+        if (index->shards[i].tombstones) sweep(index, &index->shards[i]);
+    }
+    unlock_all(index);
+    
+    for (int i = 0; i < INDEX_PREFIX_SHARDS; i++) {
+        free(iter->heads[i]);
+    }
+    free(iter->prefix);
+    free(iter);
+}
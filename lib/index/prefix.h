@@ -0,0 +1,188 @@
+/**
+ * @file prefix.h
+ * @brief Ordered URI index for prefix listings and purges
+ *
+ * Skip lists of the URIs in the global index, kept beside the hash shards.
+ * URIs are spread over INDEX_PREFIX_SHARDS of them by their index hash
+ * (index_hash_bytes()), each with its own lock, so inserts and removes of
+ * different URIs rarely wait for each other. Lookups never touch them (nor
+ * do overwrites that keep the URI). Iterators merge the shards to walk the
+ * URIs under a prefix in byte order, locking only the shards a batch
+ * takes URIs from, and see the set as it was when they were opened: a URI added later is skipped, and a URI removed later stays
+ * behind as a tombstone until no open iterator can see it. Tombstones are
+ * swept when the last iterator that needs them closes, so with no iterator
+ * open a remove frees its node at once.
+ */
+
+#ifndef OBJMAPPER_PREFIX_H
+#define OBJMAPPER_PREFIX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Skip list levels (1 in 4 nodes climbs a level: enough for 4^24 URIs) */
+#define INDEX_PREFIX_MAX_LEVEL 24
+
+/* Skip lists (and locks) the URIs are spread over */
+#define INDEX_PREFIX_SHARDS 16
+
+/**
+ * One stretch of time a URI was present, in index sequence numbers
+ */
+typedef struct index_prefix_life {
+    uint64_t added;                  /* Sequence it (re)appeared at */
+    uint64_t removed;                /* Sequence it went at, 0 = present */
+    struct index_prefix_life *older; /* Earlier lifetime an iterator still sees */
+} index_prefix_life_t;
+
+typedef struct index_prefix_node {
+    index_prefix_life_t life;        /* Newest lifetime */
+    struct index_prefix_node *next_tomb;  /* Tombstone list linkage */
+    bool tomb_listed;
+    uint8_t height;                  /* Links in next[] */
+    uint32_t len;
+    char *key;                       /* NUL-terminated, after the links */
+    struct index_prefix_node *next[];
+} index_prefix_node_t;
+
+typedef struct index_prefix_iter index_prefix_iter_t;
+
+/**
+ * One skip list of the set
+ */
+typedef struct index_prefix_shard {
+    pthread_rwlock_t lock;           /* Writers: add/remove, sweeps */
+    index_prefix_node_t *head;       /* Sentinel with INDEX_PREFIX_MAX_LEVEL links */
+    int height;                      /* Levels in use */
+    uint64_t rng;                    /* Level draws (xorshift) */
+    size_t num_keys;                 /* Present URIs */
+    size_t num_tombstones;           /* Nodes on the tombstone list */
+    index_prefix_node_t *tombstones; /* Nodes with removed lifetimes */
+} __attribute__((aligned(64))) index_prefix_shard_t;
+
+/**
+ * Ordered URI set with snapshot iterators
+ */
+typedef struct index_prefix {
+    index_prefix_shard_t shards[INDEX_PREFIX_SHARDS];
+    atomic_uint_fast64_t seq;        /* Bumped by every add and remove */
+    index_prefix_iter_t *iters;      /* Open iterators (changed with every shard
+                                      * write-locked, read under any one) */
+} index_prefix_t;
+
+/**
+ * Batched iterator over the URIs under a prefix, at one snapshot
+ */
+struct index_prefix_iter {
+    index_prefix_t *index;
+    uint64_t snapshot;               /* Index sequence when opened */
+    char *prefix;
+    size_t prefix_len;
+    char *heads[INDEX_PREFIX_SHARDS];     /* Next URI of each shard (NULL = none) */
+    uint32_t head_lens[INDEX_PREFIX_SHARDS];
+    bool done;
+    index_prefix_iter_t *prev;       /* Open iterator list */
+    index_prefix_iter_t *next;
+};
+
+/**
+ * Initialize an empty prefix index
+ *
+ * @param index Index to initialize
+ * @return 0 on success, -1 on error
+ */
+int index_prefix_init(index_prefix_t *index);
+
+/**
+ * Free a prefix index (no iterator may be open)
+ *
+ * @param index Index from index_prefix_init() (or zeroed)
+ */
+void index_prefix_destroy(index_prefix_t *index);
+
+/**
+ * Add a URI
+ *
+ * @param index Prefix index
+ * @param key URI
+ * @param len URI length
+ * @param hash index_hash_bytes() of the URI (picks its shard)
+ * @return 1 if added, 0 if already present, -1 on allocation failure
+ */
+int index_prefix_add(index_prefix_t *index, const char *key, size_t len, uint64_t hash);
+
+/**
+ * Remove a URI
+ *
+ * @param index Prefix index
+ * @param key URI
+ * @param len URI length
+ * @param hash index_hash_bytes() of the URI
+ * @return 1 if removed, 0 if absent
+ */
+int index_prefix_remove(index_prefix_t *index, const char *key, size_t len, uint64_t hash);
+
+/**
+ * Whether a URI is present
+ *
+ * @param index Prefix index
+ * @param key URI
+ * @param hash index_hash_bytes() of the URI
+ * @return true if present
+ */
+bool index_prefix_contains(index_prefix_t *index, const char *key, uint64_t hash);
+
+/**
+ * Present URIs and tombstones
+ *
+ * @param index Prefix index
+ * @param keys_out Output: present URIs (may be NULL)
+ * @param tombstones_out Output: nodes kept for open iterators (may be NULL)
+ */
+void index_prefix_counts(index_prefix_t *index, size_t *keys_out,
+                         size_t *tombstones_out);
+
+/**
+ * Open an iterator over the URIs starting with prefix
+ *
+ * The snapshot is taken here; index changes afterwards are invisible to
+ * the iterator, and removed URIs it can see are kept until it closes.
+ *
+ * @param index Prefix index
+ * @param prefix URI prefix ("" for every URI)
+ * @return Iterator, NULL on error
+ */
+index_prefix_iter_t *index_prefix_iter_open(index_prefix_t *index, const char *prefix);
+
+/**
+ * Next batch of URIs, in byte order
+ *
+ * Only the shards the batch takes URIs from are read-locked, each from
+ * its first URI of the batch to the batch's end.
+ *
+ * @param iter Iterator
+ * @param keys Output: up to max URIs (caller frees each)
+ * @param max Batch size
+ * @return URIs returned, 0 once the prefix is exhausted
+ */
+size_t index_prefix_iter_next(index_prefix_iter_t *iter, char **keys, size_t max);
+
+/**
+ * Close an iterator, sweeping tombstones no other iterator needs
+ *
+ * @param iter Iterator (NULL is ignored)
+ */
+void index_prefix_iter_close(index_prefix_iter_t *iter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OBJMAPPER_PREFIX_H */
@@ -9,6 +9,10 @@
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <dirent.h>
 
 static void test_basic_operations(void) {
     printf("Testing basic operations...\n");
@@ -141,6 +145,44 @@ static void test_fd_lifecycle(void) {
     /* Release FD */
     fd_ref_release(&ref);
     
+    /* Lock-free lookups report the time spent in open(), none once cached */
+    index_entry_info_t info;
+    index_entry_t *other = index_entry_create("/test/file2", 1, test_file);
+    assert(other != NULL);
+    assert(global_index_insert(idx, other) == 0);
+    int opened_fd = global_index_lookup_fd(idx, "/test/file2", &info);
+    assert(opened_fd >= 0);
+    assert(info.open_ns > 0);
+    close(opened_fd);
+    
+    int cached_fd = global_index_lookup_fd(idx, "/test/file", &info);
+    assert(cached_fd >= 0);
+    assert(info.open_ns == 0);
+    close(cached_fd);
+    
+    printf("  ✓ Lookups report open() time only on a cache miss\n");
+    
+    /* Metadata-only lookups open nothing and record no access */
+    index_entry_t *meta_only = index_entry_create("/test/file3", 1, test_file);
+    assert(meta_only != NULL);
+    meta_only->size_bytes = 9;
+    meta_only->mtime = 1234;
+    meta_only->flags = INDEX_FLAG_UNSETTLED;
+    assert(global_index_insert(idx, meta_only) == 0);
+    
+    index_stats_t before, after;
+    global_index_get_stats(idx, &before);
+    assert(global_index_lookup_info(idx, "/test/file3", &info) == 0);
+    assert(info.size_bytes == 9 && info.mtime == 1234);
+    assert(info.flags == INDEX_FLAG_UNSETTLED && info.backend_id == 1);
+    assert(global_index_lookup_info(idx, "/test/missing", &info) == -1);
+    global_index_get_stats(idx, &after);
+    assert(after.fd_opens == before.fd_opens);
+    assert(atomic_load(&meta_only->fd) == -1);
+    assert(atomic_load(&meta_only->access_count) == 0);
+    
+    printf("  ✓ Metadata lookups leave the FD cache alone\n");
+    
     /* Cleanup */
     global_index_destroy(idx);
     unlink(test_file);
@@ -148,6 +190,146 @@ static void test_fd_lifecycle(void) {
     printf("✓ FD lifecycle passed\n\n");
 }
 
+static void test_fd_cache(void) {
+    printf("Testing FD cache...\n");
+    
+    /* Three files, room for two cached FDs */
+    const char *files[3] = {
+        "/tmp/objmapper_test_fdc0.txt",
+        "/tmp/objmapper_test_fdc1.txt",
+        "/tmp/objmapper_test_fdc2.txt"
+    };
+    for (int i = 0; i < 3; i++) {
+        int fd = open(files[i], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        assert(fd >= 0);
+        char c = '0' + i;
+        write(fd, &c, 1);
+        close(fd);
+    }
+    
+    global_index_t *idx = global_index_create(64, 2);
+    assert(idx != NULL);
+    
+    for (int i = 0; i < 3; i++) {
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/fdc/%d", i);
+        assert(global_index_insert(idx, index_entry_create(uri, 1, files[i])) == 0);
+    }
+    
+    /* First lookup opens, second is served from the cache */
+    fd_ref_t ref;
+    assert(global_index_lookup(idx, "/fdc/0", &ref) == 0);
+    assert(ref.fd >= 0);
+    fd_ref_release(&ref);
+    
+    assert(global_index_lookup(idx, "/fdc/0", &ref) == 0);
+    char c = 0;
+    assert(pread(ref.fd, &c, 1, 0) == 1 && c == '0');
+    fd_ref_release(&ref);
+    
+    index_stats_t stats;
+    global_index_get_stats(idx, &stats);
+    assert(stats.fd_opens == 1);
+    assert(stats.fd_cache_hits == 1);
+    assert(stats.num_open_fds == 1);
+    
+    printf("  ✓ Repeat lookups dup the cached FD\n");
+    
+    /* Filling past max_open_fds evicts */
+    assert(global_index_lookup(idx, "/fdc/1", &ref) == 0);
+    fd_ref_release(&ref);
+    assert(global_index_lookup(idx, "/fdc/2", &ref) == 0);
+    fd_ref_release(&ref);
+    
+    global_index_get_stats(idx, &stats);
+    assert(stats.num_open_fds == 2);
+    assert(stats.fd_evictions == 1);
+    
+    printf("  ✓ LRU eviction respects max_open_fds\n");
+    
+    /* Relocation bumps the generation; held refs re-acquire at the new path */
+    assert(global_index_lookup(idx, "/fdc/2", &ref) == 0);
+    int gen = ref.generation;
+    assert(global_index_update_backend(idx, "/fdc/2", 2, files[1]) == 0);
+    assert(atomic_load(&ref.entry->fd_generation) != gen);
+    
+    int fd = fd_ref_acquire(&ref);
+    assert(fd >= 0);
+    assert(pread(fd, &c, 1, 0) == 1 && c == '1');
+    fd_ref_release(&ref);
+    
+    printf("  ✓ Generation check follows relocation\n");
+    
+    global_index_destroy(idx);
+    for (int i = 0; i < 3; i++) {
+        unlink(files[i]);
+    }
+    
+    printf("✓ FD cache passed\n\n");
+}
+
+
+static int count_open_fds(void) {
+    DIR *d = opendir("/proc/self/fd");
+    assert(d != NULL);
+    int n = 0;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        if (de->d_name[0] != '.') n++;
+    }
+    closedir(d);
+    return n - 1;  /* The directory stream's own FD */
+}
+
+static void test_fd_cache_eviction_closes(void) {
+    printf("Testing FD cache eviction closes descriptors...\n");
+    
+    /* Read-only workload: every eviction happens inside a lookup */
+    enum { NFILES = 1000, MAX_FDS = 16 };
+    char path[64];
+    global_index_t *idx = global_index_create(2048, MAX_FDS);
+    assert(idx != NULL);
+    
+    for (int i = 0; i < NFILES; i++) {
+        snprintf(path, sizeof(path), "/tmp/objmapper_test_fde%d.txt", i);
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        assert(fd >= 0);
+        close(fd);
+        
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/fde/%d", i);
+        assert(global_index_insert(idx, index_entry_create(uri, 1, path)) == 0);
+    }
+    
+    int baseline = count_open_fds();
+    
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < NFILES; i++) {
+            char uri[32];
+            snprintf(uri, sizeof(uri), "/fde/%d", i);
+            fd_ref_t ref;
+            assert(global_index_lookup(idx, uri, &ref) == 0);
+            fd_ref_release(&ref);
+        }
+    }
+    
+    /* Cache plus whatever is still waiting out its grace period */
+    int open_now = count_open_fds();
+    assert(open_now <= baseline + MAX_FDS + 4 * 64);
+    assert(index_epoch_pending() <= 4 * 64);
+    
+    printf("  ✓ %d lookups left %d extra FDs open\n",
+           2 * NFILES, open_now - baseline);
+    
+    global_index_destroy(idx);
+    for (int i = 0; i < NFILES; i++) {
+        snprintf(path, sizeof(path), "/tmp/objmapper_test_fde%d.txt", i);
+        unlink(path);
+    }
+    
+    printf("✓ FD cache eviction passed\n\n");
+}
+
 static void test_backend_index(void) {
     printf("Testing backend index...\n");
     
@@ -244,14 +426,905 @@ static void test_concurrent_lookup(void) {
     printf("✓ Concurrent lookup test passed\n\n");
 }
 
+/* Shared state for the growth test readers */
+static global_index_t *g_growth_idx;
+static atomic_int g_growth_done;
+static atomic_int g_growth_misses;
+
+static void *growth_reader(void *arg) {
+    (void)arg;
+    char uri[32];
+    
+    while (!atomic_load(&g_growth_done)) {
+        for (int i = 0; i < 64; i++) {
+            snprintf(uri, sizeof(uri), "/stable/%d", i);
+            index_entry_t *entry = global_index_get_entry(g_growth_idx, uri);
+            if (!entry) {
+                atomic_fetch_add(&g_growth_misses, 1);
+                continue;
+            }
+            index_entry_put(entry);
+        }
+    }
+    
+    return NULL;
+}
+
+static void test_index_growth(index_table_mode_t mode) {
+    printf("Testing incremental shard growth (%s)...\n",
+           mode == INDEX_TABLE_GROUPED ? "grouped" : "chained");
+    
+    /* Smallest tables so every shard resizes repeatedly */
+    g_growth_idx = global_index_create_mode(16, 0, mode);
+    assert(g_growth_idx != NULL);
+    
+    char uri[32];
+    for (int i = 0; i < 64; i++) {
+        snprintf(uri, sizeof(uri), "/stable/%d", i);
+        assert(global_index_insert(g_growth_idx, index_entry_create(uri, 1, "/tmp/x")) == 0);
+    }
+    
+    /* Lock-free readers must never miss a key while tables are rehashed */
+    atomic_store(&g_growth_done, 0);
+    atomic_store(&g_growth_misses, 0);
+    pthread_t readers[4];
+    for (int i = 0; i < 4; i++) {
+        assert(pthread_create(&readers[i], NULL, growth_reader, NULL) == 0);
+    }
+    
+    const int count = 50000;
+    for (int i = 0; i < count; i++) {
+        snprintf(uri, sizeof(uri), "/grow/%d", i);
+        assert(global_index_insert(g_growth_idx, index_entry_create(uri, 1, "/tmp/x")) == 0);
+    }
+    
+    atomic_store(&g_growth_done, 1);
+    for (int i = 0; i < 4; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    assert(atomic_load(&g_growth_misses) == 0);
+    
+    printf("  ✓ No reader misses during rehash\n");
+    
+    index_stats_t stats;
+    global_index_get_stats(g_growth_idx, &stats);
+    assert(stats.num_entries == (uint64_t)count + 64);
+    assert(stats.num_resizes > 0);
+    assert(stats.num_buckets * INDEX_MAX_LOAD_FACTOR * 2 >= stats.num_entries);
+    
+    /* Everything is still reachable and duplicates are still rejected */
+    for (int i = 0; i < count; i++) {
+        snprintf(uri, sizeof(uri), "/grow/%d", i);
+        index_entry_t *entry = global_index_get_entry(g_growth_idx, uri);
+        assert(entry != NULL);
+        index_entry_put(entry);
+    }
+    
+    index_entry_t *dup = index_entry_create("/grow/7", 1, "/tmp/x");
+    assert(global_index_insert(g_growth_idx, dup) < 0);
+    index_entry_put(dup);
+    
+    for (int i = 0; i < count; i += 2) {
+        snprintf(uri, sizeof(uri), "/grow/%d", i);
+        assert(global_index_remove(g_growth_idx, uri) == 0);
+    }
+    global_index_get_stats(g_growth_idx, &stats);
+    assert(stats.num_entries == (uint64_t)count / 2 + 64);
+    
+    printf("  ✓ Tables grew to %lu buckets in %lu resizes\n",
+           (unsigned long)stats.num_buckets, (unsigned long)stats.num_resizes);
+    
+    global_index_destroy(g_growth_idx);
+    printf("✓ Shard growth test passed\n\n");
+}
+
+static void test_grouped_table(void) {
+    printf("Testing grouped table and hash...\n");
+    
+    /* Every prefix of a long URI, and every one-byte change, hashes apart */
+    char uri[160];
+    memset(uri, 'c', sizeof(uri) - 1);
+    uri[sizeof(uri) - 1] = '\0';
+    uint64_t seen[sizeof(uri)];
+    for (size_t len = 0; len < sizeof(uri); len++) {
+        seen[len] = index_hash_bytes(uri, len);
+        for (size_t j = 0; j < len; j++) {
+            assert(seen[j] != seen[len]);
+        }
+    }
+    assert(index_hash_string(uri) == index_hash_bytes(uri, strlen(uri)));
+    uint64_t base = index_hash_bytes(uri, sizeof(uri) - 1);
+    for (size_t i = 0; i < sizeof(uri) - 1; i++) {
+        uri[i] = 'd';
+        assert(index_hash_bytes(uri, sizeof(uri) - 1) != base);
+        uri[i] = 'c';
+    }
+    
+    printf("  ✓ Hash separates prefixes and single-byte changes\n");
+    
+    /* Churn a constant live set: deleted slots are recycled or rebuilt away */
+    global_index_t *idx = global_index_create(16, 0);
+    assert(idx != NULL);
+    
+    const int live = 2000;
+    for (int round = 0; round < 40; round++) {
+        for (int i = 0; i < live; i++) {
+            snprintf(uri, sizeof(uri), "/cache/tenant/%d/object/%d", round, i);
+            assert(global_index_insert(idx, index_entry_create(uri, 1, "/tmp/x")) == 0);
+            if (round > 0) {
+                snprintf(uri, sizeof(uri), "/cache/tenant/%d/object/%d", round - 1, i);
+                assert(global_index_remove(idx, uri) == 0);
+            }
+        }
+        for (int i = 0; i < live; i += 7) {
+            snprintf(uri, sizeof(uri), "/cache/tenant/%d/object/%d", round, i);
+            index_entry_t *entry = global_index_get_entry(idx, uri);
+            assert(entry != NULL && strcmp(entry->uri, uri) == 0);
+            index_entry_put(entry);
+            snprintf(uri, sizeof(uri), "/cache/tenant/%d/object/%d", round + 1, i);
+            assert(global_index_get_entry(idx, uri) == NULL);
+        }
+    }
+    
+    index_stats_t stats;
+    global_index_get_stats(idx, &stats);
+    assert(stats.num_entries == (uint64_t)live);
+    assert(stats.num_buckets <= (uint64_t)live * 8);
+    
+    printf("  ✓ %d live entries in %lu slots after 40 churn rounds\n",
+           live, (unsigned long)stats.num_buckets);
+    
+    global_index_destroy(idx);
+    printf("✓ Grouped table test passed\n\n");
+}
+
+static global_index_t *g_epoch_idx;
+static atomic_int g_epoch_done;
+static atomic_int g_epoch_bad_reads;
+
+static void *epoch_reader(void *arg) {
+    (void)arg;
+    char uri[32];
+    
+    while (!atomic_load(&g_epoch_done)) {
+        for (int i = 0; i < 16; i++) {
+            snprintf(uri, sizeof(uri), "/churn/%d", i);
+            
+            index_entry_info_t info;
+            int fd = global_index_lookup_fd(g_epoch_idx, uri, &info);
+            if (fd >= 0) {
+                /* A recycled FD number would read something else */
+                char c = 0;
+                if (pread(fd, &c, 1, 0) != 1 || (c != 'A' && c != 'B')) {
+                    atomic_fetch_add(&g_epoch_bad_reads, 1);
+                }
+                close(fd);
+            }
+            
+            fd_ref_t ref;
+            if (global_index_lookup(g_epoch_idx, uri, &ref) == 0) {
+                fd_ref_acquire(&ref);
+                fd_ref_release(&ref);
+            }
+        }
+    }
+    
+    return NULL;
+}
+
+static void test_epoch_reclamation(void) {
+    printf("Testing epoch-based reclamation...\n");
+    
+    const char *path_a = "/tmp/test_index_epoch_a";
+    const char *path_b = "/tmp/test_index_epoch_b";
+    int fd = open(path_a, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    assert(fd >= 0 && write(fd, "A", 1) == 1);
+    close(fd);
+    fd = open(path_b, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    assert(fd >= 0 && write(fd, "B", 1) == 1);
+    close(fd);
+    
+    /* Tiny FD cache so readers constantly race evictions */
+    g_epoch_idx = global_index_create(16, 4);
+    assert(g_epoch_idx != NULL);
+    
+    char uri[32];
+    for (int i = 0; i < 16; i++) {
+        snprintf(uri, sizeof(uri), "/churn/%d", i);
+        assert(global_index_insert(g_epoch_idx, index_entry_create(uri, 1, path_a)) == 0);
+    }
+    
+    atomic_store(&g_epoch_done, 0);
+    atomic_store(&g_epoch_bad_reads, 0);
+    pthread_t readers[4];
+    for (int i = 0; i < 4; i++) {
+        assert(pthread_create(&readers[i], NULL, epoch_reader, NULL) == 0);
+    }
+    
+    /* Writer churns entries, paths and cached FDs under the readers */
+    for (int round = 0; round < 2000; round++) {
+        snprintf(uri, sizeof(uri), "/churn/%d", round % 16);
+        if (round % 3 == 0) {
+            assert(global_index_remove(g_epoch_idx, uri) == 0);
+            assert(global_index_insert(g_epoch_idx, index_entry_create(uri, 1, path_a)) == 0);
+        } else {
+            assert(global_index_update_backend(g_epoch_idx, uri, 2,
+                                               (round & 1) ? path_b : path_a) == 0);
+        }
+    }
+    
+    atomic_store(&g_epoch_done, 1);
+    for (int i = 0; i < 4; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    assert(atomic_load(&g_epoch_bad_reads) == 0);
+    
+    printf("  ✓ Readers never saw a recycled FD\n");
+    
+    /* Lock-free lookups take no entry reference */
+    index_entry_t *entry = global_index_get_entry(g_epoch_idx, "/churn/1");
+    assert(entry != NULL);
+    int refs = atomic_load(&entry->entry_refcount);
+    fd = global_index_lookup_fd(g_epoch_idx, "/churn/1", NULL);
+    assert(fd >= 0);
+    assert(atomic_load(&entry->entry_refcount) == refs);
+    close(fd);
+    index_entry_put(entry);
+    assert(global_index_lookup_fd(g_epoch_idx, "/churn/missing", NULL) < 0);
+    
+    global_index_destroy(g_epoch_idx);
+    assert(index_epoch_pending() == 0);
+    
+    printf("  ✓ Retired entries, paths and FDs drained\n");
+    
+    unlink(path_a);
+    unlink(path_b);
+    printf("✓ Epoch reclamation test passed\n\n");
+}
+
+static int g_replay_puts;
+static int g_replay_dels;
+
+static void count_replay(int op, const index_image_record_t *rec, void *data) {
+    (void)data;
+    assert(rec->uri[0] == '/');
+    if (op == INDEX_JOURNAL_PUT) g_replay_puts++;
+    else g_replay_dels++;
+}
+
+static void test_index_image(void) {
+    printf("Testing index image and journal...\n");
+    
+    const char *img_path = "/tmp/objmapper_test_image.idx";
+    const char *jnl_path = "/tmp/objmapper_test_image.journal";
+    unlink(jnl_path);
+    
+    index_image_record_t records[100];
+    char uris[100][32], paths[100][48];
+    for (int i = 0; i < 100; i++) {
+        snprintf(uris[i], sizeof(uris[i]), "/img/obj%d", i);
+        snprintf(paths[i], sizeof(paths[i]), "/mnt/backend/img/obj%d", i);
+        records[i] = (index_image_record_t){
+            .uri = uris[i], .path = paths[i], .size_bytes = i * 10, .flags = INDEX_FLAG_PERSISTENT,
+        };
+    }
+    assert(index_image_write(img_path, 3, 7, records, 100) == 0);
+    
+    index_image_t *img = index_image_open(img_path);
+    assert(img != NULL);
+    assert(img->header->num_entries == 100);
+    assert(img->header->generation == 7);
+    assert(img->header->total_bytes == 49500);
+    
+    index_image_record_t rec;
+    int64_t slot = index_image_find(img, "/img/obj42", &rec);
+    assert(slot >= 0);
+    assert(rec.size_bytes == 420);
+    assert(strcmp(rec.path, "/mnt/backend/img/obj42") == 0);
+    assert(index_image_find(img, "/img/missing", NULL) == -1);
+    
+    /* Claimed slots are gone for this mapping only */
+    assert(index_image_claim(img, slot));
+    assert(!index_image_claim(img, slot));
+    assert(index_image_find(img, "/img/obj42", NULL) == -1);
+    index_image_close(img);
+    
+    img = index_image_open(img_path);
+    assert(index_image_find(img, "/img/obj42", NULL) >= 0);
+    
+    /* Find the arena offset of one URI and corrupt it on disk */
+    slot = index_image_find(img, "/img/obj7", NULL);
+    off_t bad = img->header->arena_offset + img->slots[slot].arena_off + 5;
+    index_image_close(img);
+    
+    int fd = open(img_path, O_WRONLY);
+    assert(fd >= 0);
+    assert(pwrite(fd, "X", 1, bad) == 1);
+    close(fd);
+    
+    img = index_image_open(img_path);
+    assert(img != NULL);  /* Header still valid: slots are checked lazily */
+    assert(index_image_find(img, "/img/obj7", NULL) == -1);
+    assert(index_image_find(img, "/img/obj8", NULL) >= 0);
+    index_image_close(img);
+    
+    printf("  ✓ Image probe, claim and slot checksums work\n");
+    
+    fd = open(img_path, O_WRONLY);
+    assert(pwrite(fd, "X", 1, 20) == 1);
+    close(fd);
+    assert(index_image_open(img_path) == NULL);
+    unlink(img_path);
+    
+    printf("  ✓ Corrupt header is rejected\n");
+    
+    /* Journal: records survive reopen, torn tails are cut */
+    index_journal_t *j = index_journal_open(jnl_path, 7, NULL, NULL);
+    assert(j != NULL);
+    assert(index_journal_append(j, INDEX_JOURNAL_PUT, &records[1]) == 0);
+    assert(index_journal_append(j, INDEX_JOURNAL_DEL, &records[2]) == 0);
+    assert(write(j->fd, "torn", 4) == 4);
+    index_journal_close(j);
+    
+    j = index_journal_open(jnl_path, 7, count_replay, NULL);
+    assert(j != NULL);
+    assert(j->replayed == 2 && g_replay_puts == 1 && g_replay_dels == 1);
+    assert(index_journal_append(j, INDEX_JOURNAL_PUT, &records[3]) == 0);
+    index_journal_close(j);
+    
+    g_replay_puts = g_replay_dels = 0;
+    j = index_journal_open(jnl_path, 7, count_replay, NULL);
+    assert(j->replayed == 3 && g_replay_puts == 2);
+    index_journal_close(j);
+    
+    /* A journal from an older image is discarded */
+    j = index_journal_open(jnl_path, 8, count_replay, NULL);
+    assert(j != NULL && j->replayed == 0);
+    index_journal_close(j);
+    unlink(jnl_path);
+    
+    printf("  ✓ Journal replay and generation checks work\n");
+    
+    printf("✓ Index image passed\n\n");
+}
+
+static void test_image_filter(void) {
+    printf("Testing image negative filter...\n");
+    
+    const char *img_path = "/tmp/objmapper_test_filter.idx";
+    const int n = 20000;
+    
+    index_image_record_t *records = calloc(n, sizeof(*records));
+    char (*uris)[32] = calloc(n, 32);
+    assert(records && uris);
+    for (int i = 0; i < n; i++) {
+        snprintf(uris[i], 32, "/filter/obj%d", i);
+        records[i] = (index_image_record_t){ .uri = uris[i], .path = uris[i] };
+    }
+    assert(index_image_write(img_path, 1, 1, records, n) == 0);
+    
+    index_image_t *img = index_image_open(img_path);
+    assert(img != NULL);
+    assert(img->filter != NULL && img->header->filter_buckets > 0);
+    
+    /* No false negatives */
+    for (int i = 0; i < n; i++) {
+        assert(index_image_may_contain(img, uris[i]));
+    }
+    
+    int false_positives = 0;
+    char uri[32];
+    for (int i = 0; i < n; i++) {
+        snprintf(uri, sizeof(uri), "/filter/missing%d", i);
+        if (index_image_may_contain(img, uri)) {
+            false_positives++;
+            assert(index_image_find(img, uri, NULL) == -1);
+        }
+    }
+    printf("  False positives: %d / %d\n", false_positives, n);
+    assert(false_positives < n / 100);
+    printf("  ✓ Present keys pass, absent keys are filtered\n");
+    
+    /* Claims delete from the filter; the other keys stay visible */
+    for (int i = 0; i < n; i += 2) {
+        int64_t slot = index_image_find(img, uris[i], NULL);
+        assert(slot >= 0);
+        assert(index_image_claim(img, slot));
+    }
+    int claimed_maybe = 0;
+    for (int i = 0; i < n; i++) {
+        if (i % 2) {
+            assert(index_image_find(img, uris[i], NULL) >= 0);
+        } else if (index_image_may_contain(img, uris[i])) {
+            claimed_maybe++;  /* Fingerprint shared with a live key */
+        }
+    }
+    assert(claimed_maybe < n / 100);
+    printf("  ✓ Claimed keys leave the filter\n");
+    
+    /* Images written before filters existed always say maybe */
+    img->filter = NULL;
+    snprintf(uri, sizeof(uri), "/filter/missing");
+    assert(index_image_may_contain(img, uri));
+    assert(index_image_find(img, uris[1], NULL) >= 0);
+    index_image_close(img);
+    
+    /* A truncated filter is not trusted */
+    struct stat st;
+    assert(stat(img_path, &st) == 0);
+    assert(truncate(img_path, st.st_size - 8) == 0);
+    assert(index_image_open(img_path) == NULL);
+    unlink(img_path);
+    printf("  ✓ Filter-less images pass, truncated filters are rejected\n");
+    
+    free(records);
+    free(uris);
+    printf("✓ Image filter passed\n\n");
+}
+
+static atomic_size_t g_scan_progress;
+
+static void scan_progress(size_t count, void *data) {
+    (void)data;
+    assert(count >= atomic_load(&g_scan_progress));  /* Serialized, monotonic */
+    atomic_store(&g_scan_progress, count);
+}
+
+static void test_entry_layout(void) {
+    printf("Testing entry layout and slab...\n");
+    
+    /* Lookup fields and per-hit counters never share a cache line */
+    assert(sizeof(index_entry_t) <= INDEX_ENTRY_SLOT_SIZE);
+    size_t cold_end = offsetof(index_entry_t, fd_cache_closed);
+    assert(cold_end / 64 < offsetof(index_entry_t, fd_recent) / 64);
+    assert(offsetof(index_entry_t, fd_recent) % 64 == 0);
+    
+    global_index_t *idx = global_index_create(1024, 100);
+    assert(global_index_set_backend_root(idx, 1, "/mnt/a") == 0);
+    assert(global_index_set_backend_root(idx, 2, "/mnt/b") == 0);
+    
+    index_entry_t *e = index_entry_create("/x/y", 1, "/mnt/a/x/y");
+    assert(e != NULL);
+    assert(((uintptr_t)e % 64) == 0);
+    assert(e->uri == e->uri_inline && e->uri_len == 4);
+    assert(global_index_insert(idx, e) == 0);
+    
+    /* Adopted by the root: the path is rebuilt, not stored */
+    char path[256];
+    assert((atomic_load(&e->location) & 1) != 0);
+    assert(index_entry_path(e, path, sizeof(path)) == 0);
+    assert(strcmp(path, "/mnt/a/x/y") == 0);
+    assert(index_entry_path(e, path, 5) < 0);
+    
+    /* Relocations keep a path only when the root cannot derive it */
+    assert(global_index_update_backend(idx, "/x/y", 2, "/tmp/spill/y") == 0);
+    assert((atomic_load(&e->location) & 1) == 0);
+    assert(index_entry_path(e, path, sizeof(path)) == 0);
+    assert(strcmp(path, "/tmp/spill/y") == 0);
+    assert(global_index_update_backend(idx, "/x/y", 2, "/mnt/b/x/y") == 0);
+    assert((atomic_load(&e->location) & 1) != 0);
+    assert(index_entry_path(e, path, sizeof(path)) == 0);
+    assert(strcmp(path, "/mnt/b/x/y") == 0);
+    
+    printf("  ✓ Paths derived from backend roots\n");
+    
+    /* URIs that do not fit the slot are stored out of line */
+    char long_uri[INDEX_URI_INLINE + 32];
+    memset(long_uri, 'u', sizeof(long_uri) - 1);
+    long_uri[0] = '/';
+    long_uri[sizeof(long_uri) - 1] = '\0';
+    snprintf(path, sizeof(path), "/mnt/a%s", long_uri);
+    index_entry_t *big = index_entry_create(long_uri, 1, path);
+    assert(big != NULL && big->uri != big->uri_inline);
+    assert(global_index_insert(idx, big) == 0);
+    index_entry_t *found = global_index_get_entry(idx, long_uri);
+    assert(found == big);
+    index_entry_put(found);
+    
+    printf("  ✓ Inline and out-of-line URIs\n");
+    
+    /* Reclaimed slots are reused */
+    global_index_destroy(idx);
+    index_epoch_synchronize();
+    index_entry_t *again = index_entry_create("/again", 0, "/p");
+    assert(again == e || again == big);
+    index_entry_put(again);
+    index_epoch_synchronize();
+    
+    printf("  ✓ Slab slots recycled\n");
+    printf("✓ Entry layout test passed\n\n");
+}
+
+static void test_parallel_scan(void) {
+    printf("Testing parallel scan...\n");
+    
+    const char *root = "/tmp/objmapper_test_scan";
+    char path[256];
+    assert(system("rm -rf /tmp/objmapper_test_scan") == 0);
+    mkdir(root, 0755);
+    
+    /* 40 directories x 30 files, nested two levels, plus skipped names */
+    int files = 0;
+    for (int d = 0; d < 40; d++) {
+        snprintf(path, sizeof(path), "%s/d%d", root, d % 8);
+        mkdir(path, 0755);
+        snprintf(path, sizeof(path), "%s/d%d/s%d", root, d % 8, d);
+        mkdir(path, 0755);
+        for (int f = 0; f < 30; f++) {
+            snprintf(path, sizeof(path), "%s/d%d/s%d/f%d", root, d % 8, d, f);
+            int fd = open(path, O_WRONLY | O_CREAT, 0644);
+            assert(fd >= 0);
+            assert(write(fd, "0123456789", f % 11) == f % 11);
+            close(fd);
+            files++;
+        }
+    }
+    snprintf(path, sizeof(path), "%s/.objmapper.idx", root);
+    close(open(path, O_WRONLY | O_CREAT, 0644));
+    snprintf(path, sizeof(path), "%s/link", root);
+    assert(symlink("d0/s0/f5", path) == 0);
+    files++;
+    
+    backend_index_t *bidx = backend_index_create(2, NULL, 4096);
+    global_index_t *gidx = global_index_create(1024, 100);
+    assert(global_index_set_backend_root(gidx, 2, root) == 0);
+    
+    /* Pre-indexed URIs are left alone */
+    index_entry_t *pre = index_entry_create("/d1/s1/f1", 7, "/elsewhere");
+    assert(global_index_insert(gidx, pre) == 0);
+    
+    index_scan_opts_t opts = {
+        .global = gidx,
+        .entry_flags = INDEX_FLAG_PERSISTENT,
+        .skip_prefix = ".objmapper.",
+        .num_threads = 4,
+        .progress_cb = scan_progress,
+    };
+    int count = backend_index_scan_parallel(bidx, root, &opts);
+    assert(count == files - 1);
+    assert(atomic_load(&g_scan_progress) == (size_t)count);
+    assert(atomic_load(&bidx->num_entries) == (size_t)count);
+    
+    index_entry_t *found = backend_index_lookup(bidx, "/d3/s11/f7");
+    assert(found != NULL && found->size_bytes == 7 && found->backend_id == 2);
+    assert(index_entry_path(found, path, sizeof(path)) == 0);
+    assert(strcmp(path, "/tmp/objmapper_test_scan/d3/s11/f7") == 0);
+    assert(index_entry_path(pre, path, sizeof(path)) == 0);
+    assert(strcmp(path, "/elsewhere") == 0);
+    assert(backend_index_lookup(bidx, "/link") != NULL);
+    assert(backend_index_lookup(bidx, "/.objmapper.idx") == NULL);
+    assert(backend_index_lookup(bidx, "/d1/s1/f1") == NULL);
+    
+    index_entry_t *g = global_index_get_entry(gidx, "/d7/s39/f29");
+    assert(g != NULL && g == backend_index_lookup(bidx, "/d7/s39/f29"));
+    index_entry_put(g);
+    
+    printf("  ✓ %d files indexed with 4 workers\n", count);
+    
+    global_index_destroy(gidx);
+    backend_index_destroy(bidx);
+    
+    /* Default options, backend index only */
+    bidx = backend_index_create(2, NULL, 4096);
+    assert(backend_index_scan(bidx, root, NULL, NULL) == files + 1);
+    backend_index_destroy(bidx);
+    
+    printf("  ✓ Default scan agrees\n");
+    
+    assert(system("rm -rf /tmp/objmapper_test_scan") == 0);
+    printf("✓ Parallel scan passed\n\n");
+}
+
+/* Shared state for the access frequency test readers */
+static global_index_t *g_access_idx;
+
+static void *access_reader(void *arg) {
+    (void)arg;
+    for (int i = 0; i < 1000; i++) {
+        fd_ref_t ref;
+        assert(global_index_lookup(g_access_idx, "/freq/hot", &ref) == 0);
+        fd_ref_release(&ref);
+    }
+    return NULL;
+}
+
+static void test_access_frequency(void) {
+    printf("Testing access frequency sketch...\n");
+    
+    global_index_t *idx = global_index_create(1024, 100);
+    assert(idx != NULL);
+    
+    const char *uris[] = { "/freq/hot", "/freq/once", "/freq/never" };
+    for (int i = 0; i < 3; i++) {
+        index_entry_t *entry = index_entry_create(uris[i], 1, "/tmp/objmapper_freq_none");
+        assert(global_index_insert(idx, entry) == 0);
+    }
+    
+    fd_ref_t ref;
+    for (int i = 0; i < 10; i++) {
+        assert(global_index_lookup(idx, "/freq/hot", &ref) == 0);
+        fd_ref_release(&ref);
+    }
+    assert(global_index_lookup_fd(idx, "/freq/once", NULL) < 0);
+    
+    /* Buffered until a stripe fills up or someone drains */
+    global_index_drain_accesses(idx);
+    
+    index_entry_t *hot = global_index_get_entry(idx, "/freq/hot");
+    index_entry_t *once = global_index_get_entry(idx, "/freq/once");
+    index_entry_t *never = global_index_get_entry(idx, "/freq/never");
+    assert(global_index_frequency(idx, hot) == 10);
+    assert(global_index_frequency(idx, once) == 1);
+    assert(global_index_frequency(idx, never) == 0);
+    assert(atomic_load(&hot->last_access) != 0);
+    assert(atomic_load(&never->last_access) == 0);
+    
+    uint64_t now = atomic_load(&hot->last_access);
+    assert(global_index_hotness(idx, hot, now, 60) > global_index_hotness(idx, once, now, 60));
+    assert(global_index_hotness(idx, never, now, 60) == 0.0f);
+    
+    printf("  ✓ Lookups feed the sketch through the access buffers\n");
+    
+    /* Threads with a node vote for it; the majority wins, settled votes stop writing */
+    uint32_t votes;
+    assert(index_entry_reader_node(hot, NULL) == -1);
+    index_set_thread_node(1);
+    for (int i = 0; i < 3; i++) index_entry_record_access(once);
+    assert(index_entry_reader_node(once, &votes) == 1 && votes == 3);
+    index_set_thread_node(0);
+    for (int i = 0; i < 5; i++) index_entry_record_access(once);
+    assert(index_entry_reader_node(once, &votes) == 0 && votes == 3);
+    for (int i = 0; i < 2 * INDEX_NODE_VOTES_MAX; i++) index_entry_record_access(once);
+    assert(index_entry_reader_node(once, &votes) == 0 && votes == INDEX_NODE_VOTES_MAX);
+    index_set_thread_node(-1);
+    index_entry_record_access(hot);
+    assert(index_entry_reader_node(hot, NULL) == -1);
+    
+    printf("  ✓ Reader node follows the majority of node-declared readers\n");
+    
+    /* Readers on several threads: counters saturate, nothing corrupts */
+    g_access_idx = idx;
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        assert(pthread_create(&threads[i], NULL, access_reader, NULL) == 0);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    global_index_drain_accesses(idx);
+    assert(global_index_frequency(idx, hot) == INDEX_FREQ_MAX);
+    assert(global_index_frequency(idx, never) == 0);
+    
+    printf("  ✓ Concurrent readers saturate at %d\n", INDEX_FREQ_MAX);
+    
+    /* Ten accesses per counter of a row age every counter */
+    char uri[32];
+    for (int i = 0; i < INDEX_SKETCH_MIN_WIDTH; i++) {
+        snprintf(uri, sizeof(uri), "/freq/bulk/%d", i);
+        assert(global_index_insert(idx, index_entry_create(uri, 1, "/tmp/none")) == 0);
+    }
+    for (int round = 0; round < 12; round++) {
+        for (int i = 0; i < INDEX_SKETCH_MIN_WIDTH; i++) {
+            snprintf(uri, sizeof(uri), "/freq/bulk/%d", i);
+            assert(global_index_lookup_fd(idx, uri, NULL) < 0);
+        }
+        global_index_drain_accesses(idx);
+    }
+    
+    index_stats_t stats;
+    global_index_get_stats(idx, &stats);
+    assert(stats.sketch_agings >= 1);
+    assert(global_index_frequency(idx, hot) <= INDEX_FREQ_MAX / 2);
+    
+    printf("  ✓ Aging halves old frequencies (%lu agings)\n", stats.sketch_agings);
+    
+    index_entry_put(hot);
+    index_entry_put(once);
+    index_entry_put(never);
+    global_index_destroy(idx);
+    printf("✓ Access frequency test passed\n\n");
+}
+
+static int prefix_insert(global_index_t *idx, const char *uri) {
+    index_entry_t *entry = index_entry_create(uri, 1, "/tmp/objmapper_prefix_none");
+    assert(entry != NULL);
+    if (global_index_insert(idx, entry) == 0) return 0;
+    index_entry_put(entry);
+    return -1;
+}
+
+/* Drain an iterator in batches of batch into one string, "uri uri ..." */
+static void prefix_drain(index_prefix_iter_t *iter, size_t batch, char *out, size_t size) {
+    char *keys[16];
+    size_t n;
+    out[0] = '\0';
+    while ((n = index_prefix_iter_next(iter, keys, batch)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (out[0]) strncat(out, " ", size - strlen(out) - 1);
+            strncat(out, keys[i], size - strlen(out) - 1);
+            free(keys[i]);
+        }
+    }
+}
+
+static global_index_t *g_prefix_idx;
+static atomic_int g_prefix_stop;
+
+/* Adds and removes /churn/ URIs until told to stop */
+static void *prefix_churn(void *arg) {
+    (void)arg;
+    char uri[32];
+    for (unsigned i = 0; !atomic_load(&g_prefix_stop); i++) {
+        snprintf(uri, sizeof(uri), "/churn/%03u", i % 200);
+        if (prefix_insert(g_prefix_idx, uri) < 0) {
+            global_index_remove(g_prefix_idx, uri);
+        }
+    }
+    return NULL;
+}
+
+static pthread_rwlock_t *g_held_lock;
+static atomic_int g_lock_state;  /* 1 = held, 2 = release */
+
+static void *hold_shard_thread(void *arg) {
+    (void)arg;
+    pthread_rwlock_wrlock(g_held_lock);
+    atomic_store(&g_lock_state, 1);
+    while (atomic_load(&g_lock_state) != 2) usleep(1000);
+    pthread_rwlock_unlock(g_held_lock);
+    return NULL;
+}
+
+static void test_prefix_index(void) {
+    printf("Testing prefix index and snapshot iterators...\n");
+    
+    global_index_t *idx = global_index_create(1024, 100);
+    assert(idx != NULL);
+    
+    const char *uris[] = { "/a/2", "/b/1", "/a/10", "/a", "/a/1", "/ab" };
+    for (int i = 0; i < 6; i++) {
+        assert(prefix_insert(idx, uris[i]) == 0);
+    }
+    assert(index_prefix_contains(&idx->prefix, "/a/10", index_hash_string("/a/10")));
+    assert(!index_prefix_contains(&idx->prefix, "/a/", index_hash_string("/a/")));
+    
+    char out[4096];
+    index_prefix_iter_t *iter = index_prefix_iter_open(&idx->prefix, "/a/");
+    prefix_drain(iter, 2, out, sizeof(out));
+    index_prefix_iter_close(iter);
+    assert(strcmp(out, "/a/1 /a/10 /a/2") == 0);
+    
+    iter = index_prefix_iter_open(&idx->prefix, "");
+    prefix_drain(iter, 16, out, sizeof(out));
+    index_prefix_iter_close(iter);
+    assert(strcmp(out, "/a /a/1 /a/10 /a/2 /ab /b/1") == 0);
+    
+    iter = index_prefix_iter_open(&idx->prefix, "/zz");
+    prefix_drain(iter, 16, out, sizeof(out));
+    index_prefix_iter_close(iter);
+    assert(out[0] == '\0');
+    
+    printf("  ✓ Prefix ranges come out in byte order, in batches\n");
+    
+    /* Changes after the snapshot are invisible to the iterator */
+    iter = index_prefix_iter_open(&idx->prefix, "/a/");
+    char *keys[16];
+    assert(index_prefix_iter_next(iter, keys, 1) == 1);
+    assert(strcmp(keys[0], "/a/1") == 0);
+    free(keys[0]);
+    
+    assert(global_index_remove(idx, "/a/10") == 0);
+    assert(global_index_remove(idx, "/a/1") == 0);
+    assert(prefix_insert(idx, "/a/3") == 0);
+    assert(global_index_remove(idx, "/a/2") == 0);
+    assert(prefix_insert(idx, "/a/2") == 0);  /* Back, as a new lifetime */
+    assert(!index_prefix_contains(&idx->prefix, "/a/10", index_hash_string("/a/10")));
+    
+    size_t num_keys, tombstones;
+    index_prefix_counts(&idx->prefix, &num_keys, &tombstones);
+    assert(num_keys == 5 && tombstones == 3);
+    
+    /* A later iterator sees the index as it is now */
+    index_prefix_iter_t *later = index_prefix_iter_open(&idx->prefix, "/a/");
+    prefix_drain(later, 16, out, sizeof(out));
+    assert(strcmp(out, "/a/2 /a/3") == 0);
+    
+    prefix_drain(iter, 1, out, sizeof(out));
+    assert(strcmp(out, "/a/10 /a/2") == 0);
+    index_prefix_iter_close(iter);
+    index_prefix_iter_close(later);
+    
+    index_prefix_counts(&idx->prefix, &num_keys, &tombstones);
+    assert(num_keys == 5 && tombstones == 0);
+    
+    /* With no iterator open a remove frees the node at once */
+    assert(global_index_remove(idx, "/a/3") == 0);
+    index_prefix_counts(&idx->prefix, &num_keys, &tombstones);
+    assert(num_keys == 4 && tombstones == 0);
+    
+    printf("  ✓ Iterators keep their snapshot; tombstones go when they close\n");
+    
+    /* Batches interleave with writers: every stable URI once, in order */
+    char uri[32];
+    for (int i = 0; i < 500; i++) {
+        snprintf(uri, sizeof(uri), "/churn/%03d", i);
+        if (i >= 200) assert(prefix_insert(idx, uri) == 0);
+    }
+    
+    g_prefix_idx = idx;
+    atomic_store(&g_prefix_stop, 0);
+    pthread_t churn;
+    assert(pthread_create(&churn, NULL, prefix_churn, NULL) == 0);
+    
+    for (int round = 0; round < 20; round++) {
+        iter = index_prefix_iter_open(&idx->prefix, "/churn/");
+        char last[32] = "";
+        int stable = 0;
+        size_t n;
+        while ((n = index_prefix_iter_next(iter, keys, 7)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                assert(strcmp(keys[i], last) > 0);
+                snprintf(last, sizeof(last), "%s", keys[i]);
+                if (atoi(keys[i] + 7) >= 200) stable++;
+                free(keys[i]);
+            }
+        }
+        index_prefix_iter_close(iter);
+        assert(stable == 300);
+    }
+    
+    atomic_store(&g_prefix_stop, 1);
+    pthread_join(churn, NULL);
+    
+    index_prefix_counts(&idx->prefix, NULL, &tombstones);
+    assert(tombstones == 0);
+    
+    printf("  ✓ Concurrent adds and removes between batches\n");
+    
+    /* A batch locks only the shards it takes URIs from */
+    assert(prefix_insert(idx, "/solo/x") == 0);
+    int solo = (index_hash_string("/solo/x") >> 32) % INDEX_PREFIX_SHARDS;
+    iter = index_prefix_iter_open(&idx->prefix, "/solo/");
+    g_held_lock = &idx->prefix.shards[(solo + 1) % INDEX_PREFIX_SHARDS].lock;
+    pthread_t holder;
+    assert(pthread_create(&holder, NULL, hold_shard_thread, NULL) == 0);
+    while (atomic_load(&g_lock_state) != 1) usleep(1000);
+    
+    alarm(10);  /* A batch waiting for the held shard never returns */
+    prefix_drain(iter, 4, out, sizeof(out));
+    assert(strcmp(out, "/solo/x") == 0);
+    alarm(0);
+    
+    atomic_store(&g_lock_state, 2);
+    pthread_join(holder, NULL);
+    index_prefix_iter_close(iter);
+    
+    printf("  ✓ Batches leave other shards unlocked\n");
+    
+    global_index_destroy(idx);
+    printf("✓ Prefix index test passed\n\n");
+}
+
 int main(void) {
     printf("=== objmapper Index Tests ===\n\n");
     
     test_basic_operations();
     test_collisions();
     test_fd_lifecycle();
+    test_fd_cache();
+    test_fd_cache_eviction_closes();
+    test_entry_layout();
     test_backend_index();
+    test_index_image();
+    test_image_filter();
+    test_parallel_scan();
     test_concurrent_lookup();
+    test_index_growth(INDEX_TABLE_GROUPED);
+    test_index_growth(INDEX_TABLE_CHAINED);
+    test_grouped_table();
+    test_epoch_reclamation();
+    test_access_frequency();
+    test_prefix_index();
     
     printf("=== All tests passed! ===\n");
     return 0;
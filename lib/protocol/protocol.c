@@ -3,7 +3,9 @@
  * @brief objmapper wire protocol implementation
  */
 
+#define _GNU_SOURCE
 #include "protocol.h"
+#include "shmring.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -11,7 +13,14 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <endian.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/uio.h>
 #include <arpa/inet.h>
 
@@ -19,6 +28,48 @@
  * Internal structures
  * ============================================================================ */
 
+/**
+ * Server-side request storage
+ * 
+ * Every request handed out by the server API is one of these. Slots with
+ * room for OBJM_REQUEST_POOL_URI bytes return to the connection's pool;
+ * longer URIs and multi-GET batches get an exact-size slot that is freed.
+ */
+typedef struct request_slot {
+    objm_request_t req;              /* Handed to the caller (first member) */
+    struct request_slot *next;       /* Pool free list */
+    struct objm_connection *pool;    /* Owning pool, NULL if not pooled */
+    size_t cap;                      /* Bytes of data[] */
+    _Alignas(8) char data[];         /* URI, or multi-GET URI table + strings */
+} request_slot_t;
+
+/**
+ * Server output the socket or ring did not take (non-blocking connections)
+ * 
+ * A message segment holds the unsent bytes and the descriptors that ride
+ * on the first of them (socket only). A body segment streams a file range
+ * as chunks, framing included, from a duplicate of the file's descriptor.
+ * Descriptors are duplicates owned by the queue.
+ */
+typedef struct out_seg {
+    struct out_seg *next;
+    int file;                        /* Body source (-1 = message) */
+    off_t off;                       /* Body: next file offset */
+    size_t len;                      /* Message bytes / body file bytes left */
+    size_t chunk_left;               /* Body: file bytes left in this chunk */
+    uint8_t frame[4];                /* Body: this chunk's length */
+    size_t frame_pos;                /* Body: frame bytes sent */
+    size_t frame_len;                /* Body: frame bytes to send */
+    size_t nfds;                     /* Message: descriptors not yet sent */
+    int *fds;
+    uint8_t *data;                   /* Message: unsent bytes */
+} out_seg_t;
+
+typedef struct out_queue {
+    out_seg_t *head;
+    out_seg_t *tail;
+} out_queue_t;
+
 struct objm_connection {
     int fd;                     /* Socket file descriptor */
     objm_version_t version;     /* Protocol version */
@@ -34,6 +85,42 @@ struct objm_connection {
     objm_callbacks_t callbacks;
     void *user_data;
     
+    /* Serializes whole responses when several threads reply (OOO) */
+    pthread_mutex_t send_lock;
+    
+    /* Server receive state: requests are parsed out of rbuf */
+    int nonblocking;            /* 1 if socket is O_NONBLOCK */
+    uint8_t *rbuf;              /* Receive buffer */
+    size_t rbuf_cap;            /* Allocated (grows for multi-GET batches) */
+    size_t rbuf_pos;            /* Start of unparsed bytes */
+    size_t rbuf_len;            /* End of buffered bytes */
+    
+    /* Request pool: taken by the receiving thread, returned from any */
+    request_slot_t *req_free;   /* Receiving thread's free slots */
+    atomic_uintptr_t req_returned;  /* Slots released since (lock-free stack) */
+    
+    /* Shared-memory ring (OBJM_CAP_SHM_RING): messages go through the
+     * ring, the socket only carries batches of descriptors */
+    shmring_t *ring;
+    int ring_fds[OBJM_MAX_BATCH];   /* Server: queued to send; client: received */
+    uint8_t ring_fd_owned[OBJM_MAX_BATCH];  /* Server: close once sent */
+    size_t ring_fd_next;        /* Client: next descriptor to hand out */
+    size_t ring_nfds;           /* Descriptors in ring_fds */
+    int corked;                 /* Server: owned descriptors wait for uncork */
+    
+    /* Server output queues (non-blocking connections, send_lock) */
+    out_queue_t out;            /* Waiting for the socket */
+    out_queue_t ring_out;       /* Waiting for room in the ring */
+    size_t out_bytes;           /* Bytes queued, body files included */
+    
+    /* Server body receive in progress (objm_server_try_recv_body()) */
+    int body_active;
+    uint32_t body_left;         /* Bytes left in the current chunk */
+    uint8_t body_hdr[4];        /* Chunk length being read */
+    size_t body_hdr_len;
+    off_t body_off;             /* Body bytes landed so far */
+    int body_pipe[2];           /* SPLICE: socket -> pipe -> file */
+    
     /* Error state */
     char error[256];
 };
@@ -42,6 +129,44 @@ struct objm_connection {
  * Internal helpers
  * ============================================================================ */
 
+/**
+ * Wait until a non-blocking socket can accept more data
+ */
+static int wait_writable(int fd) {
+    struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+    
+    while (1) {
+        int ret = poll(&pfd, 1, -1);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            return -1;
+        }
+        return 0;
+    }
+}
+
+/**
+ * Wait until a non-blocking socket has data (or EOF) to read
+ */
+static int wait_readable(int fd) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    
+    while (1) {
+        int ret = poll(&pfd, 1, -1);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (pfd.revents & (POLLERR | POLLNVAL)) {
+            return -1;
+        }
+        return 0;
+    }
+}
+
 static int send_all(int fd, const void *buf, size_t len) {
     const uint8_t *ptr = buf;
     size_t remaining = len;
@@ -50,6 +175,9 @@ static int send_all(int fd, const void *buf, size_t len) {
         ssize_t sent = write(fd, ptr, remaining);
         if (sent < 0) {
             if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && wait_writable(fd) == 0) {
+                continue;
+            }
             return -1;
         }
         ptr += sent;
@@ -58,6 +186,57 @@ static int send_all(int fd, const void *buf, size_t len) {
     return 0;
 }
 
+/**
+ * Send iovecs with one sendmsg, attaching descriptors to the first byte
+ * 
+ * The descriptors only go with the first call; a short write is finished
+ * without them. iov is consumed.
+ */
+static int send_iov(int sock, struct iovec *iov, int iovcnt,
+                    const int *fds, size_t nfds) {
+    char control[CMSG_SPACE(OBJM_MAX_BATCH * sizeof(int))];
+    struct msghdr msg = {0};
+    
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    if (nfds > 0) {
+        memset(control, 0, CMSG_SPACE(nfds * sizeof(int)));
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(nfds * sizeof(int));
+        
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(nfds * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), fds, nfds * sizeof(int));
+    }
+    
+    while (msg.msg_iovlen > 0) {
+        ssize_t n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && wait_writable(sock) == 0) {
+                continue;
+            }
+            return -1;
+        }
+        
+        msg.msg_control = NULL;
+        msg.msg_controllen = 0;
+        
+        while (msg.msg_iovlen > 0 && (size_t)n >= msg.msg_iov->iov_len) {
+            n -= msg.msg_iov->iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if (msg.msg_iovlen > 0) {
+            msg.msg_iov->iov_base = (uint8_t *)msg.msg_iov->iov_base + n;
+            msg.msg_iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
 static int recv_all(int fd, void *buf, size_t len) {
     uint8_t *ptr = buf;
     size_t remaining = len;
@@ -78,11 +257,11 @@ static int recv_all(int fd, void *buf, size_t len) {
     return 0;
 }
 
-static int send_fd(int sock, int fd_to_send) {
+static int recv_fd(int sock) {
     struct msghdr msg = {0};
     struct iovec iov[1];
     char control[CMSG_SPACE(sizeof(int))];
-    char dummy = 'X';
+    char dummy;
     
     iov[0].iov_base = &dummy;
     iov[0].iov_len = 1;
@@ -92,44 +271,69 @@ static int send_fd(int sock, int fd_to_send) {
     msg.msg_control = control;
     msg.msg_controllen = sizeof(control);
     
-    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
-    cmsg->cmsg_level = SOL_SOCKET;
-    cmsg->cmsg_type = SCM_RIGHTS;
-    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
-    memcpy(CMSG_DATA(cmsg), &fd_to_send, sizeof(int));
+    if (recvmsg(sock, &msg, 0) < 0) {
+        return -1;
+    }
     
-    if (sendmsg(sock, &msg, 0) < 0) {
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS) {
         return -1;
     }
-    return 0;
+    
+    int fd;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    return fd;
 }
 
-static int recv_fd(int sock) {
+/**
+ * Read up to len bytes in one recvmsg, collecting any passed FDs
+ * 
+ * Descriptors ride on the first byte of the message that carries them,
+ * so this must be the first read of every V2 response.
+ * 
+ * @return Bytes read, 0 on EOF, -1 on error
+ */
+static ssize_t recv_with_fds(int sock, void *buf, size_t len,
+                             int *fds, size_t max_fds, size_t *nfds) {
+    char control[CMSG_SPACE(OBJM_MAX_BATCH * sizeof(int))];
+    struct iovec iov = { .iov_base = buf, .iov_len = len };
     struct msghdr msg = {0};
-    struct iovec iov[1];
-    char control[CMSG_SPACE(sizeof(int))];
-    char dummy;
-    
-    iov[0].iov_base = &dummy;
-    iov[0].iov_len = 1;
     
-    msg.msg_iov = iov;
+    msg.msg_iov = &iov;
     msg.msg_iovlen = 1;
     msg.msg_control = control;
-    msg.msg_controllen = sizeof(control);
+    msg.msg_controllen = CMSG_SPACE(max_fds * sizeof(int));
     
-    if (recvmsg(sock, &msg, 0) < 0) {
-        return -1;
+    *nfds = 0;
+    
+    ssize_t n;
+    while ((n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC)) < 0) {
+        if (errno != EINTR) return -1;
     }
     
-    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
-    if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS) {
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; i++) {
+            int fd;
+            memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            if (*nfds < max_fds) fds[(*nfds)++] = fd;
+            else close(fd);
+        }
+    }
+    
+    if (msg.msg_flags & MSG_CTRUNC) {
+        /* Some descriptors were dropped: the batch cannot be matched up */
+        for (size_t i = 0; i < *nfds; i++) close(fds[i]);
+        *nfds = 0;
+        errno = EMSGSIZE;
         return -1;
     }
     
-    int fd;
-    memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
-    return fd;
+    return n;
 }
 
 static void set_error(objm_connection_t *conn, const char *fmt, ...) {
@@ -139,6 +343,490 @@ static void set_error(objm_connection_t *conn, const char *fmt, ...) {
     va_end(args);
 }
 
+/* ============================================================================
+ * Server output queue
+ * ============================================================================
+ *
+ * Replies on a non-blocking server connection never wait for the socket,
+ * or for room in a shared-memory ring. What they do not take at once is
+ * queued behind anything queued before it, and objm_server_flush() sends
+ * it when the event loop reports the socket writable or the ring's space
+ * doorbell rings. All of it runs under send_lock.
+ */
+
+static int ring_flush_fds(objm_connection_t *conn);
+
+/**
+ * One sendmsg that does not wait (descriptors on the first byte)
+ * 
+ * @return Bytes sent (0 if the socket is full), -1 on error
+ */
+static ssize_t send_iov_now(int sock, const struct iovec *iov, int iovcnt,
+                            const int *fds, size_t nfds) {
+    char control[CMSG_SPACE(OBJM_MAX_BATCH * sizeof(int))];
+    struct msghdr msg = {0};
+    
+    msg.msg_iov = (struct iovec *)iov;
+    msg.msg_iovlen = iovcnt;
+    if (nfds > 0) {
+        memset(control, 0, CMSG_SPACE(nfds * sizeof(int)));
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(nfds * sizeof(int));
+        
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(nfds * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), fds, nfds * sizeof(int));
+    }
+    
+    while (1) {
+        ssize_t n = sendmsg(sock, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n >= 0) return n;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        return -1;
+    }
+}
+
+/**
+ * Write what fits without waiting, to the ring or the socket
+ * 
+ * @return Bytes written (0 if full), -1 on error
+ */
+static ssize_t out_write(objm_connection_t *conn, const out_queue_t *q,
+                         const void *buf, size_t len, const int *fds, size_t nfds) {
+    struct iovec iov = { .iov_base = (void *)buf, .iov_len = len };
+    if (q == &conn->ring_out) return shmring_writev(conn->ring, &iov, 1);
+    return send_iov_now(conn->fd, &iov, 1, fds, nfds);
+}
+
+static void out_seg_free(out_seg_t *seg) {
+    if (seg->file >= 0) close(seg->file);
+    for (size_t i = 0; i < seg->nfds; i++) close(seg->fds[i]);
+    free(seg);
+}
+
+static void out_append(objm_connection_t *conn, out_queue_t *q, out_seg_t *seg) {
+    if (q->tail) q->tail->next = seg;
+    else q->head = seg;
+    q->tail = seg;
+    conn->out_bytes += seg->len;
+}
+
+/**
+ * Queue the bytes of iov past skip, with duplicates of fds
+ */
+static int out_push_message(objm_connection_t *conn, out_queue_t *q,
+                            const struct iovec *iov, int iovcnt, size_t skip,
+                            const int *fds, size_t nfds) {
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+    len -= skip;
+    
+    out_seg_t *seg = malloc(sizeof(*seg) + nfds * sizeof(int) + len);
+    if (!seg) return -1;
+    *seg = (out_seg_t){ .file = -1, .len = len };
+    seg->fds = (int *)(seg + 1);
+    seg->data = (uint8_t *)(seg->fds + nfds);
+    
+    for (; seg->nfds < nfds; seg->nfds++) {
+        seg->fds[seg->nfds] = fcntl(fds[seg->nfds], F_DUPFD_CLOEXEC, 0);
+        if (seg->fds[seg->nfds] < 0) {
+            out_seg_free(seg);
+            return -1;
+        }
+    }
+    
+    uint8_t *dst = seg->data;
+    for (int i = 0; i < iovcnt; i++) {
+        size_t part = iov[i].iov_len;
+        const uint8_t *src = iov[i].iov_base;
+        if (skip >= part) {
+            skip -= part;
+            continue;
+        }
+        memcpy(dst, src + skip, part - skip);
+        dst += part - skip;
+        skip = 0;
+    }
+    
+    out_append(conn, q, seg);
+    return 0;
+}
+
+/**
+ * Queue len bytes of fd from off as a chunked body's chunks
+ */
+static int out_push_body(objm_connection_t *conn, out_queue_t *q, int fd,
+                         off_t off, size_t len) {
+    out_seg_t *seg = malloc(sizeof(*seg));
+    if (!seg) return -1;
+    *seg = (out_seg_t){ .file = fcntl(fd, F_DUPFD_CLOEXEC, 0), .off = off, .len = len };
+    if (seg->file < 0) {
+        free(seg);
+        return -1;
+    }
+    out_append(conn, q, seg);
+    return 0;
+}
+
+/**
+ * Move body bytes of the current chunk: sendfile() into the socket, or
+ * read and copied into the ring
+ * 
+ * @return Bytes moved (0 if full), -1 on error
+ */
+static ssize_t out_body_write(objm_connection_t *conn, const out_queue_t *q,
+                              out_seg_t *seg) {
+    while (1) {
+        ssize_t n;
+        if (q == &conn->ring_out) {
+            uint8_t buf[64 * 1024];
+            size_t want = seg->chunk_left < sizeof(buf) ? seg->chunk_left : sizeof(buf);
+            n = pread(seg->file, buf, want, seg->off);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return -1;  /* Error, or the file shrank */
+            n = out_write(conn, q, buf, n, NULL, 0);
+            if (n > 0) seg->off += n;
+            return n;
+        }
+        
+        n = sendfile(conn->fd, seg->file, &seg->off, seg->chunk_left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        if (n == 0) return -1;  /* The file shrank under us */
+        return n;
+    }
+}
+
+/**
+ * Send what the socket or ring takes of a segment
+ * 
+ * @return 0 once it is all sent, OBJM_AGAIN if full, -1 on error
+ */
+static int out_seg_send(objm_connection_t *conn, const out_queue_t *q, out_seg_t *seg) {
+    if (seg->file < 0) {
+        while (seg->len > 0) {
+            ssize_t n = out_write(conn, q, seg->data, seg->len, seg->fds, seg->nfds);
+            if (n < 0) return -1;
+            if (n == 0) return OBJM_AGAIN;
+            
+            for (size_t i = 0; i < seg->nfds; i++) close(seg->fds[i]);
+            seg->nfds = 0;
+            seg->data += n;
+            seg->len -= n;
+            conn->out_bytes -= n;
+        }
+        return 0;
+    }
+    
+    while (seg->len > 0 || seg->frame_pos < seg->frame_len) {
+        ssize_t n;
+        if (seg->frame_pos < seg->frame_len) {
+            n = out_write(conn, q, seg->frame + seg->frame_pos,
+                          seg->frame_len - seg->frame_pos, NULL, 0);
+            if (n < 0) return -1;
+            if (n == 0) return OBJM_AGAIN;
+            seg->frame_pos += n;
+            continue;
+        }
+        
+        if (seg->chunk_left == 0) {
+            uint32_t chunk = seg->len < OBJM_STREAM_CHUNK ? seg->len : OBJM_STREAM_CHUNK;
+            uint32_t chunk_be = htonl(chunk);
+            memcpy(seg->frame, &chunk_be, sizeof(chunk_be));
+            seg->frame_pos = 0;
+            seg->frame_len = sizeof(chunk_be);
+            seg->chunk_left = chunk;
+            continue;
+        }
+        
+        n = out_body_write(conn, q, seg);
+        if (n < 0) return -1;
+        if (n == 0) return OBJM_AGAIN;
+        seg->chunk_left -= n;
+        seg->len -= n;
+        conn->out_bytes -= n;
+    }
+    return 0;
+}
+
+/**
+ * Send one queue until it is empty or full
+ */
+static int out_queue_flush(objm_connection_t *conn, out_queue_t *q) {
+    while (q->head) {
+        out_seg_t *seg = q->head;
+        int ret = out_seg_send(conn, q, seg);
+        if (ret < 0) {
+            set_error(conn, "Failed to send queued output");
+            return -1;
+        }
+        if (ret == OBJM_AGAIN) return OBJM_AGAIN;
+        
+        q->head = seg->next;
+        if (!q->head) q->tail = NULL;
+        out_seg_free(seg);
+    }
+    return 0;
+}
+
+static void out_queue_drop(out_queue_t *q) {
+    while (q->head) {
+        out_seg_t *seg = q->head;
+        q->head = seg->next;
+        out_seg_free(seg);
+    }
+    q->tail = NULL;
+}
+
+/**
+ * Send queued output until the socket and ring are full (send_lock held)
+ * 
+ * A full ring is armed to ring the space doorbell once the client reads.
+ * 
+ * @return 0 once nothing waits for the socket, OBJM_AGAIN if output waits
+ *         for it to become writable, -1 on error
+ */
+static int out_flush_locked(objm_connection_t *conn) {
+    int ret;
+    while ((ret = out_queue_flush(conn, &conn->ring_out)) == OBJM_AGAIN) {
+        /* The client may be blocked on a descriptor instead of reading */
+        if (ring_flush_fds(conn) < 0) return -1;
+        if (!shmring_arm_writable(conn->ring)) break;
+    }
+    if (ret < 0) return -1;
+    return out_queue_flush(conn, &conn->out);
+}
+
+/**
+ * Send a message on the socket (ring connections too), descriptors on its
+ * first byte
+ * 
+ * The descriptors stay the caller's. A non-blocking server connection
+ * queues what the socket does not take at once, behind any queued output.
+ */
+static int sock_send_msg(objm_connection_t *conn, struct iovec *iov, int iovcnt,
+                         const int *fds, size_t nfds) {
+    if (!conn->nonblocking) return send_iov(conn->fd, iov, iovcnt, fds, nfds);
+    
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+    
+    size_t sent = 0;
+    if (!conn->out.head) {
+        ssize_t n = send_iov_now(conn->fd, iov, iovcnt, fds, nfds);
+        if (n < 0) return -1;
+        sent = n;
+    }
+    if (sent == len) return 0;
+    
+    /* Descriptors left with the first byte */
+    return out_push_message(conn, &conn->out, iov, iovcnt, sent,
+                            sent > 0 ? NULL : fds, sent > 0 ? 0 : nfds);
+}
+
+/**
+ * Copy a message into the ring, queueing what does not fit (server,
+ * non-blocking)
+ */
+static int ring_send_msg(objm_connection_t *conn, const struct iovec *iov, int iovcnt) {
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+    
+    size_t sent = 0;
+    if (!conn->ring_out.head) {
+        ssize_t n = shmring_writev(conn->ring, iov, iovcnt);
+        if (n < 0) return -1;
+        sent = n;
+    }
+    if (sent == len) return 0;
+    
+    return out_push_message(conn, &conn->ring_out, iov, iovcnt, sent, NULL, 0);
+}
+
+/* ============================================================================
+ * Shared-memory ring (OBJM_CAP_SHM_RING)
+ * ============================================================================
+ *
+ * Once negotiated, every message of the connection - the unchanged V2
+ * framing, bodies included - goes through the ring. Reply descriptors
+ * still need the socket: the server queues them and sends a batch in one
+ * sendmsg, one carrier byte per descriptor. They are queued in the order
+ * their replies entered the ring, so the client takes them first-in
+ * first-out as it parses replies that carry one.
+ */
+
+/**
+ * Send the queued descriptors (server, send_lock held)
+ * 
+ * The batch is dropped on failure as well: the connection is unusable.
+ */
+static int ring_flush_fds(objm_connection_t *conn) {
+    if (conn->ring_nfds == 0) return 0;
+    
+    char carriers[OBJM_MAX_BATCH];
+    memset(carriers, 'X', conn->ring_nfds);
+    struct iovec iov = { .iov_base = carriers, .iov_len = conn->ring_nfds };
+    int ret = sock_send_msg(conn, &iov, 1, conn->ring_fds, conn->ring_nfds);
+    
+    for (size_t i = 0; i < conn->ring_nfds; i++) {
+        if (conn->ring_fd_owned[i]) close(conn->ring_fds[i]);
+    }
+    conn->ring_nfds = 0;
+    return ret;
+}
+
+/**
+ * Queue a reply's descriptor (server, send_lock held)
+ * 
+ * An owned descriptor is closed once sent, or here if the queue cannot
+ * take it.
+ */
+static int ring_queue_fd(objm_connection_t *conn, int fd, int owned) {
+    if (conn->ring_nfds == OBJM_MAX_BATCH && ring_flush_fds(conn) < 0) {
+        if (owned) close(fd);
+        return -1;
+    }
+    conn->ring_fds[conn->ring_nfds] = fd;
+    conn->ring_fd_owned[conn->ring_nfds] = owned;
+    conn->ring_nfds++;
+    return 0;
+}
+
+/**
+ * Flush queued descriptors from the receiving side (server)
+ * 
+ * Called before the server waits for more requests: the client may need
+ * a descriptor before it sends them.
+ */
+static int ring_release_fds(objm_connection_t *conn) {
+    pthread_mutex_lock(&conn->send_lock);
+    int ret = ring_flush_fds(conn);
+    pthread_mutex_unlock(&conn->send_lock);
+    return ret;
+}
+
+/**
+ * Take the next reply descriptor (client)
+ */
+static int ring_take_fd(objm_connection_t *conn) {
+    while (conn->ring_fd_next == conn->ring_nfds) {
+        /* recvmsg stops after a message with descriptors: one batch each */
+        char carriers[OBJM_MAX_BATCH];
+        size_t nfds;
+        ssize_t n = recv_with_fds(conn->fd, carriers, sizeof(carriers),
+                                  conn->ring_fds, OBJM_MAX_BATCH, &nfds);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) &&
+            wait_readable(conn->fd) == 0) {
+            continue;
+        }
+        if (n <= 0) return -1;
+        conn->ring_fd_next = 0;
+        conn->ring_nfds = nfds;
+    }
+    return conn->ring_fds[conn->ring_fd_next++];
+}
+
+/**
+ * Copy iovecs into the ring, waiting for room as needed (iov is consumed)
+ * 
+ * The server holds send_lock. Before it waits for room it sends its queued
+ * descriptors: the client may be blocked on one instead of reading. A
+ * non-blocking server connection never waits: the rest is queued.
+ */
+static int ring_send_iov(objm_connection_t *conn, struct iovec *iov, int iovcnt) {
+    if (conn->nonblocking) return ring_send_msg(conn, iov, iovcnt);
+    
+    while (1) {
+        while (iovcnt > 0 && iov->iov_len == 0) {
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt == 0) return 0;
+        
+        ssize_t n = shmring_writev(conn->ring, iov, iovcnt);
+        if (n < 0) return -1;
+        if (n == 0) {
+            if (conn->is_server && ring_flush_fds(conn) < 0) return -1;
+            if (shmring_wait_writable(conn->ring, conn->fd) < 0) return -1;
+            continue;
+        }
+        
+        while ((size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+            if (iovcnt == 0) return 0;
+        }
+        iov->iov_base = (uint8_t *)iov->iov_base + n;
+        iov->iov_len -= n;
+    }
+}
+
+static int ring_recv_all(objm_connection_t *conn, void *buf, size_t len) {
+    uint8_t *ptr = buf;
+    
+    while (len > 0) {
+        ssize_t n = shmring_read(conn->ring, ptr, len);
+        if (n < 0) return -1;
+        if (n == 0) {
+            if (conn->is_server && ring_release_fds(conn) < 0) return -1;
+            if (shmring_wait_readable(conn->ring, conn->fd) < 0) return -1;
+            continue;
+        }
+        ptr += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* Message I/O through the ring when there is one, else the socket */
+
+static int conn_send_iov(objm_connection_t *conn, struct iovec *iov, int iovcnt) {
+    if (conn->ring) return ring_send_iov(conn, iov, iovcnt);
+    return sock_send_msg(conn, iov, iovcnt, NULL, 0);
+}
+
+static int conn_send_all(objm_connection_t *conn, const void *buf, size_t len) {
+    struct iovec iov = { .iov_base = (void *)buf, .iov_len = len };
+    return conn_send_iov(conn, &iov, 1);
+}
+
+/**
+ * Queue file extents as one chunked body and send what the socket or ring
+ * takes (server, non-blocking)
+ */
+static int stream_extents_queue(objm_connection_t *conn, const objm_extent_t *extents,
+                                size_t count) {
+    out_queue_t *q = conn->ring ? &conn->ring_out : &conn->out;
+    for (size_t i = 0; i < count; i++) {
+        if (extents[i].length > 0 &&
+            out_push_body(conn, q, extents[i].fd, extents[i].offset,
+                          extents[i].length) < 0) {
+            set_error(conn, "Failed to queue body");
+            return -1;
+        }
+    }
+    
+    /* Terminating zero-length chunk */
+    uint32_t end = 0;
+    if (conn_send_all(conn, &end, sizeof(end)) < 0) {
+        set_error(conn, "Failed to queue body");
+        return -1;
+    }
+    return out_flush_locked(conn) < 0 ? -1 : 0;
+}
+
+static int conn_recv_all(objm_connection_t *conn, void *buf, size_t len) {
+    if (conn->ring) return ring_recv_all(conn, buf, len);
+    return recv_all(conn->fd, buf, len);
+}
+
 /* ============================================================================
  * Client API
  * ============================================================================ */
@@ -150,6 +838,7 @@ objm_connection_t *objm_client_create(int fd, objm_version_t version) {
     conn->fd = fd;
     conn->version = version;
     conn->is_server = 0;
+    pthread_mutex_init(&conn->send_lock, NULL);
     conn->next_request_id = 1;
     
     /* Default params */
@@ -170,7 +859,8 @@ int objm_client_hello(objm_connection_t *conn, const objm_hello_t *hello,
     uint8_t hello_msg[9];
     memcpy(hello_msg, OBJM_MAGIC, OBJM_MAGIC_LEN);
     hello_msg[4] = OBJM_VERSION_2;
-    *(uint16_t *)(hello_msg + 5) = htons(hello->capabilities);
+    *(uint16_t *)(hello_msg + 5) = htons(hello->capabilities | OBJM_CAP_INLINE_FD |
+                                         OBJM_CAP_OPCODES);
     *(uint16_t *)(hello_msg + 7) = htons(hello->max_pipeline);
     
     if (send_all(conn->fd, hello_msg, sizeof(hello_msg)) < 0) {
@@ -178,20 +868,30 @@ int objm_client_hello(objm_connection_t *conn, const objm_hello_t *hello,
         return -1;
     }
     
-    /* Receive HELLO_ACK: magic(4) + version(1) + caps(2) + max_pipeline(2) + backend_parallelism(1) */
+    /* Receive HELLO_ACK: magic(4) + version(1) + caps(2) + max_pipeline(2) + backend_parallelism(1)
+     * A granted OBJM_CAP_SHM_RING brings the ring's descriptors along */
     uint8_t ack_msg[10];
-    if (recv_all(conn->fd, ack_msg, sizeof(ack_msg)) < 0) {
+    int fds[SHMRING_NUM_FDS];
+    size_t nfds = 0;
+    ssize_t got = recv_with_fds(conn->fd, ack_msg, sizeof(ack_msg),
+                                fds, SHMRING_NUM_FDS, &nfds);
+    if (got <= 0 ||
+        ((size_t)got < sizeof(ack_msg) &&
+         recv_all(conn->fd, ack_msg + got, sizeof(ack_msg) - got) < 0)) {
+        for (size_t i = 0; i < nfds; i++) close(fds[i]);
         set_error(conn, "Failed to receive HELLO_ACK");
         return -1;
     }
     
     /* Validate magic and version */
     if (memcmp(ack_msg, OBJM_MAGIC, OBJM_MAGIC_LEN) != 0) {
+        for (size_t i = 0; i < nfds; i++) close(fds[i]);
         set_error(conn, "Invalid HELLO_ACK magic");
         return -1;
     }
     
     if (ack_msg[4] != OBJM_VERSION_2) {
+        for (size_t i = 0; i < nfds; i++) close(fds[i]);
         set_error(conn, "Version mismatch");
         return -1;
     }
@@ -202,9 +902,25 @@ int objm_client_hello(objm_connection_t *conn, const objm_hello_t *hello,
     conn->params.max_pipeline = ntohs(*(uint16_t *)(ack_msg + 7));
     conn->params.backend_parallelism = ack_msg[9];
     
-    /* Allocate pending response array for OOO */
-    if (conn->params.capabilities & OBJM_CAP_OOO_REPLIES) {
-        conn->pending_capacity = conn->params.max_pipeline;
+    if (conn->params.capabilities & OBJM_CAP_SHM_RING) {
+        /* Everything after the handshake goes through the ring */
+        if (nfds != SHMRING_NUM_FDS) {
+            for (size_t i = 0; i < nfds; i++) close(fds[i]);
+            set_error(conn, "HELLO_ACK is missing the ring descriptors");
+            return -1;
+        }
+        conn->ring = shmring_attach(fds);
+        if (!conn->ring) {
+            set_error(conn, "Failed to map the shared-memory ring");
+            return -1;
+        }
+    } else {
+        for (size_t i = 0; i < nfds; i++) close(fds[i]);
+    }
+    
+    /* Allocate pending response array for OOO */
+    if (conn->params.capabilities & OBJM_CAP_OOO_REPLIES) {
+        conn->pending_capacity = conn->params.max_pipeline;
         conn->pending_responses = calloc(conn->pending_capacity, sizeof(objm_response_t *));
         if (!conn->pending_responses) {
             set_error(conn, "Failed to allocate pending response buffer");
@@ -220,31 +936,88 @@ int objm_client_hello(objm_connection_t *conn, const objm_hello_t *hello,
 }
 
 int objm_client_send_request(objm_connection_t *conn, const objm_request_t *req) {
-    if (!conn || !req) return -1;
-    
-    if (conn->version == OBJM_PROTO_V1) {
-        /* V1: mode(1) + uri_len(2) + uri */
-        uint8_t header[3];
-        header[0] = req->mode;
-        *(uint16_t *)(header + 1) = htons(req->uri_len);
+    return objm_client_send_requests(conn, req, 1);
+}
+
+int objm_client_send_requests(objm_connection_t *conn, const objm_request_t *reqs,
+                              size_t count) {
+    if (!conn || (count && !reqs)) return -1;
+    
+    /* Header and URI of each request are two iovecs of one sendmsg, plus
+     * two for the conditions of a conditional one and one for a range */
+    uint8_t headers[OBJM_SEND_BATCH][OBJM_V2_REQUEST_HEADER];
+    uint16_t cond_lens[OBJM_SEND_BATCH];
+    uint64_t ranges[OBJM_SEND_BATCH][3];
+    struct iovec iov[OBJM_SEND_BATCH * 5];
+    
+    for (size_t base = 0; base < count; base += OBJM_SEND_BATCH) {
+        size_t n = count - base < OBJM_SEND_BATCH ? count - base : OBJM_SEND_BATCH;
+        size_t iovcnt = 0;
         
-        if (send_all(conn->fd, header, sizeof(header)) < 0 ||
-            send_all(conn->fd, req->uri, req->uri_len) < 0) {
-            set_error(conn, "Failed to send V1 request");
-            return -1;
+        for (size_t i = 0; i < n; i++) {
+            const objm_request_t *req = &reqs[base + i];
+            uint8_t *header = headers[i];
+            size_t header_len;
+            
+            if (conn->version == OBJM_PROTO_V1) {
+                /* V1: mode(1) + uri_len(2) + uri */
+                header[0] = req->mode;
+                *(uint16_t *)(header + 1) = htons(req->uri_len);
+                header_len = 3;
+            } else if (conn->params.capabilities & OBJM_CAP_OPCODES) {
+                /* V2: msg_type(1) + request_id(4) + op(1) + flags(1) + mode(1)
+                 *     + uri_len(2) + uri */
+                header[0] = OBJM_MSG_REQUEST;
+                *(uint32_t *)(header + 1) = htonl(req->id);
+                header[5] = req->op;
+                header[6] = req->flags;
+                header[7] = req->mode;
+                *(uint16_t *)(header + 8) = htons(req->uri_len);
+                header_len = OBJM_V2_REQUEST_HEADER;
+            } else {
+                /* Peer without OBJM_CAP_OPCODES: no op byte, URI conventions */
+                if (req->op != OBJM_OP_AUTO) {
+                    set_error(conn, "Peer does not support operation codes");
+                    return -1;
+                }
+                header[0] = OBJM_MSG_REQUEST;
+                *(uint32_t *)(header + 1) = htonl(req->id);
+                header[5] = req->flags;
+                header[6] = req->mode;
+                *(uint16_t *)(header + 7) = htons(req->uri_len);
+                header_len = OBJM_V2_REQUEST_HEADER_NO_OP;
+            }
+            
+            iov[iovcnt++] = (struct iovec){ .iov_base = header, .iov_len = header_len };
+            iov[iovcnt++] = (struct iovec){ .iov_base = req->uri, .iov_len = req->uri_len };
+            
+            if (conn->version == OBJM_PROTO_V2 && (req->flags & OBJM_REQ_CONDITIONAL)) {
+                if (req->conditions_len > OBJM_MAX_CONDITIONS ||
+                    (req->conditions_len && !req->conditions)) {
+                    set_error(conn, "Invalid request conditions");
+                    return -1;
+                }
+                cond_lens[i] = htons(req->conditions_len);
+                iov[iovcnt++] = (struct iovec){ .iov_base = &cond_lens[i], .iov_len = 2 };
+                iov[iovcnt++] = (struct iovec){ .iov_base = req->conditions,
+                                                .iov_len = req->conditions_len };
+            }
+            
+            if (conn->version == OBJM_PROTO_V2 && (req->flags & OBJM_REQ_RANGE)) {
+                ranges[i][0] = htobe64(req->range_offset);
+                ranges[i][1] = htobe64(req->range_length);
+                ranges[i][2] = htobe64(req->range_total);
+                size_t total_len = (req->flags & OBJM_REQ_TOTAL) ? OBJM_TOTAL_BYTES : 0;
+                iov[iovcnt++] = (struct iovec){
+                    .iov_base = ranges[i],
+                    .iov_len = OBJM_RANGE_BYTES + total_len
+                };
+            }
         }
-    } else {
-        /* V2: msg_type(1) + request_id(4) + flags(1) + mode(1) + uri_len(2) + uri */
-        uint8_t header[9];
-        header[0] = OBJM_MSG_REQUEST;
-        *(uint32_t *)(header + 1) = htonl(req->id);
-        header[5] = req->flags;
-        header[6] = req->mode;
-        *(uint16_t *)(header + 7) = htons(req->uri_len);
         
-        if (send_all(conn->fd, header, sizeof(header)) < 0 ||
-            send_all(conn->fd, req->uri, req->uri_len) < 0) {
-            set_error(conn, "Failed to send V2 request");
+        if (conn_send_iov(conn, iov, iovcnt) < 0) {
+            set_error(conn, "Failed to send %s request",
+                      conn->version == OBJM_PROTO_V1 ? "V1" : "V2");
             return -1;
         }
     }
@@ -252,68 +1025,233 @@ int objm_client_send_request(objm_connection_t *conn, const objm_request_t *req)
     return 0;
 }
 
-int objm_client_recv_response(objm_connection_t *conn, objm_response_t **resp) {
-    if (!conn || !resp) return -1;
+int objm_client_send_multi_get(objm_connection_t *conn, uint32_t request_id,
+                               uint8_t flags, char mode,
+                               const char *const *uris, size_t count) {
+    if (!conn || !uris || count == 0 || count > OBJM_MAX_BATCH ||
+        conn->version != OBJM_PROTO_V2) {
+        return -1;
+    }
     
-    objm_response_t *r = calloc(1, sizeof(*r));
-    if (!r) return -1;
+    /* msg_type(1) + request_id(4) + flags(1) + mode(1) + count(2)
+     * + count * (uri_len(2) + uri) */
+    size_t total = 9;
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(uris[i]);
+        if (len > OBJM_MAX_URI_LEN) {
+            set_error(conn, "URI too long");
+            return -1;
+        }
+        total += 2 + len;
+    }
+    if (total > OBJM_MAX_BATCH_BYTES) {
+        set_error(conn, "Multi-GET request too large");
+        return -1;
+    }
+    
+    uint8_t *msg = malloc(total);
+    if (!msg) return -1;
+    
+    msg[0] = OBJM_MSG_MULTI_REQUEST;
+    *(uint32_t *)(msg + 1) = htonl(request_id);
+    msg[5] = flags;
+    msg[6] = mode;
+    *(uint16_t *)(msg + 7) = htons(count);
+    
+    size_t off = 9;
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(uris[i]);
+        *(uint16_t *)(msg + off) = htons(len);
+        memcpy(msg + off + 2, uris[i], len);
+        off += 2 + len;
+    }
+    
+    int ret = conn_send_all(conn, msg, total);
+    free(msg);
+    
+    if (ret < 0) {
+        set_error(conn, "Failed to send multi-GET request");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Receive the rest of a multi-GET response
+ * 
+ * @param head First bytes of the message, already read
+ * @param got Number of bytes in head
+ */
+static int recv_multi_response(objm_connection_t *conn, objm_response_t *r,
+                               const uint8_t *head, size_t got,
+                               int *fds, size_t nfds) {
+    /* msg_type(1) + request_id(4) + count(2) + count * (status(1) + content_len(8)) */
+    uint8_t buf[7 + OBJM_MAX_BATCH * 9];
+    memcpy(buf, head, got);
+    
+    if (got < 7 && conn_recv_all(conn, buf + got, 7 - got) < 0) {
+        set_error(conn, "Failed to receive multi-GET response header");
+        return -1;
+    }
+    
+    size_t count = ntohs(*(uint16_t *)(buf + 5));
+    if (count > OBJM_MAX_BATCH) {
+        set_error(conn, "Multi-GET response too large");
+        return -1;
+    }
+    
+    size_t have = got > 7 ? got : 7;
+    size_t total = 7 + count * 9;
+    if (have < total && conn_recv_all(conn, buf + have, total - have) < 0) {
+        set_error(conn, "Failed to receive multi-GET items");
+        return -1;
+    }
+    const uint8_t *items = buf + 7;
+    
+    r->request_id = ntohl(*(uint32_t *)(buf + 1));
+    r->status = OBJM_STATUS_OK;
+    r->num_items = count;
+    r->items = calloc(count ? count : 1, sizeof(*r->items));
+    if (!r->items) return -1;
+    
+    /* FDs arrive in item order, one per item that carries one */
+    size_t next_fd = 0;
+    for (size_t i = 0; i < count; i++) {
+        objm_response_t *item = &r->items[i];
+        item->request_id = r->request_id;
+        item->status = items[i * 9];
+        item->content_len = be64toh(*(uint64_t *)(items + i * 9 + 1));
+        item->fd = -1;
+        
+        if (item->status == OBJM_STATUS_OK && item->content_len == 0) {
+            if (conn->ring) item->fd = ring_take_fd(conn);
+            else if (next_fd < nfds) item->fd = fds[next_fd++];
+            if (item->fd < 0) {
+                set_error(conn, "Multi-GET response is missing descriptors");
+                return -1;
+            }
+        }
+    }
+    
+    /* Surplus descriptors would leak */
+    while (next_fd < nfds) close(fds[next_fd++]);
+    return 0;
+}
+
+/**
+ * Allocate a response with room for its metadata in the same block
+ */
+static objm_response_t *response_alloc(size_t metadata_len) {
+    objm_response_t *r = calloc(1, sizeof(*r) + metadata_len + 1);
+    if (!r) return NULL;
     
     r->fd = -1;
+    r->metadata_len = metadata_len;
+    if (metadata_len > 0) r->metadata = (uint8_t *)(r + 1);
+    return r;
+}
+
+int objm_client_recv_response(objm_connection_t *conn, objm_response_t **resp) {
+    if (!conn || !resp) return -1;
+    
+    uint8_t header[16];
+    uint32_t request_id = 0;
+    uint8_t status;
+    uint64_t content_len;
+    size_t metadata_len;
+    int fds[OBJM_MAX_BATCH];
+    size_t nfds = 0;
     
     if (conn->version == OBJM_PROTO_V1) {
         /* V1: status(1) + content_len(8) + metadata_len(2) */
-        uint8_t header[11];
-        if (recv_all(conn->fd, header, sizeof(header)) < 0) {
-            free(r);
+        if (recv_all(conn->fd, header, 11) < 0) {
             set_error(conn, "Failed to receive V1 response header");
             return -1;
         }
         
-        r->status = header[0];
-        r->content_len = be64toh(*(uint64_t *)(header + 1));
-        r->metadata_len = ntohs(*(uint16_t *)(header + 9));
+        status = header[0];
+        content_len = be64toh(*(uint64_t *)(header + 1));
+        metadata_len = ntohs(*(uint16_t *)(header + 9));
     } else {
-        /* V2: msg_type(1) + request_id(4) + status(1) + content_len(8) + metadata_len(2) */
-        uint8_t header[16];
-        if (recv_all(conn->fd, header, sizeof(header)) < 0) {
-            free(r);
+        /* V2: msg_type(1) + request_id(4) + status(1) + content_len(8) + metadata_len(2)
+         * A multi-GET response is never shorter, so the first recvmsg may
+         * take the whole header; descriptors ride on its first byte. */
+        ssize_t got;
+        if (conn->ring) {
+            got = ring_recv_all(conn, header, sizeof(header)) < 0 ? -1 : (ssize_t)sizeof(header);
+        } else {
+            got = recv_with_fds(conn->fd, header, sizeof(header),
+                                fds, OBJM_MAX_BATCH, &nfds);
+        }
+        if (got <= 0) {
+            set_error(conn, "Failed to receive V2 response header");
+            return -1;
+        }
+        
+        if (header[0] == OBJM_MSG_MULTI_RESPONSE) {
+            objm_response_t *r = response_alloc(0);
+            if (!r || recv_multi_response(conn, r, header, got, fds, nfds) < 0) {
+                for (size_t i = 0; i < nfds; i++) {
+                    int owned = 0;
+                    for (size_t j = 0; r && j < r->num_items && r->items; j++) {
+                        if (r->items[j].fd == fds[i]) owned = 1;
+                    }
+                    if (!owned) close(fds[i]);
+                }
+                objm_response_free(r);
+                return -1;
+            }
+            *resp = r;
+            return 0;
+        }
+        
+        if ((size_t)got < sizeof(header) &&
+            recv_all(conn->fd, header + got, sizeof(header) - got) < 0) {
+            for (size_t i = 0; i < nfds; i++) close(fds[i]);
             set_error(conn, "Failed to receive V2 response header");
             return -1;
         }
         
         if (header[0] != OBJM_MSG_RESPONSE) {
-            free(r);
+            for (size_t i = 0; i < nfds; i++) close(fds[i]);
             set_error(conn, "Unexpected message type: %d", header[0]);
             return -1;
         }
         
-        r->request_id = ntohl(*(uint32_t *)(header + 1));
-        r->status = header[5];
-        r->content_len = be64toh(*(uint64_t *)(header + 6));
-        r->metadata_len = ntohs(*(uint16_t *)(header + 14));
+        request_id = ntohl(*(uint32_t *)(header + 1));
+        status = header[5];
+        content_len = be64toh(*(uint64_t *)(header + 6));
+        metadata_len = ntohs(*(uint16_t *)(header + 14));
     }
     
-    /* Receive metadata if present */
-    if (r->metadata_len > 0) {
-        r->metadata = malloc(r->metadata_len);
-        if (!r->metadata) {
-            free(r);
-            return -1;
-        }
-        if (recv_all(conn->fd, r->metadata, r->metadata_len) < 0) {
-            free(r->metadata);
-            free(r);
-            set_error(conn, "Failed to receive metadata");
-            return -1;
-        }
+    /* FD pass replies end in a one-byte carrier (streamed bodies have none) */
+    int has_fd = (status == OBJM_STATUS_OK && content_len == 0);
+    int inline_fd = has_fd && nfds > 0;
+    for (size_t i = inline_fd ? 1 : 0; i < nfds; i++) close(fds[i]);
+    
+    objm_response_t *r = response_alloc(metadata_len);
+    if (!r) {
+        if (inline_fd) close(fds[0]);
+        return -1;
+    }
+    r->request_id = request_id;
+    r->status = status;
+    r->content_len = content_len;
+    
+    /* Metadata and, when the FD came with the header, the carrier byte */
+    size_t tail = metadata_len + (inline_fd ? 1 : 0);
+    if (inline_fd) r->fd = fds[0];
+    if (tail > 0 && conn_recv_all(conn, (uint8_t *)(r + 1), tail) < 0) {
+        objm_response_free(r);
+        set_error(conn, "Failed to receive metadata");
+        return -1;
     }
     
-    /* Receive FD for FD pass mode */
-    if (r->status == OBJM_STATUS_OK && r->content_len == 0) {
-        r->fd = recv_fd(conn->fd);
+    /* Ring, or server without OBJM_CAP_INLINE_FD: the FD comes on its own */
+    if (has_fd && !inline_fd) {
+        r->fd = conn->ring ? ring_take_fd(conn) : recv_fd(conn->fd);
         if (r->fd < 0) {
-            free(r->metadata);
-            free(r);
+            objm_response_free(r);
             set_error(conn, "Failed to receive file descriptor");
             return -1;
         }
@@ -323,6 +1261,27 @@ int objm_client_recv_response(objm_connection_t *conn, objm_response_t **resp) {
     return 0;
 }
 
+/**
+ * Drain a streamed body into a memfd so the response can be stored
+ */
+static int buffer_streamed_body(objm_connection_t *conn, objm_response_t *r) {
+    int fd = memfd_create("objm-body", MFD_CLOEXEC);
+    if (fd < 0) {
+        set_error(conn, "Failed to buffer streamed body");
+        return -1;
+    }
+    
+    uint64_t len;
+    if (objm_recv_body(conn, fd, OBJM_MODE_COPY, &len) < 0) {
+        close(fd);
+        return -1;
+    }
+    
+    r->fd = fd;
+    r->content_len = len;
+    return 0;
+}
+
 int objm_client_recv_response_for(objm_connection_t *conn, uint32_t request_id,
                                    objm_response_t **resp) {
     if (!conn || !resp || conn->version != OBJM_PROTO_V2) {
@@ -348,6 +1307,14 @@ int objm_client_recv_response_for(objm_connection_t *conn, uint32_t request_id,
             return 0;
         }
         
+        /* A streamed body sits in front of the next header: park it */
+        if (r->status == OBJM_STATUS_OK &&
+            r->content_len == OBJM_CONTENT_CHUNKED &&
+            buffer_streamed_body(conn, r) < 0) {
+            objm_response_free(r);
+            return -1;
+        }
+        
         /* Store for later */
         if (r->request_id < conn->pending_capacity) {
             conn->pending_responses[r->request_id] = r;
@@ -363,13 +1330,13 @@ int objm_client_close(objm_connection_t *conn, uint8_t reason) {
     
     if (conn->version == OBJM_PROTO_V2) {
         uint8_t close_msg[2] = {OBJM_MSG_CLOSE, reason};
-        if (send_all(conn->fd, close_msg, sizeof(close_msg)) < 0) {
+        if (conn_send_all(conn, close_msg, sizeof(close_msg)) < 0) {
             return -1;
         }
         
         /* Wait for CLOSE_ACK */
         uint8_t ack[6];
-        if (recv_all(conn->fd, ack, sizeof(ack)) < 0) {
+        if (conn_recv_all(conn, ack, sizeof(ack)) < 0) {
             return -1;
         }
         
@@ -381,94 +1348,1022 @@ int objm_client_close(objm_connection_t *conn, uint8_t reason) {
     return 0;
 }
 
-void objm_client_destroy(objm_connection_t *conn) {
-    if (!conn) return;
+void objm_client_destroy(objm_connection_t *conn) {
+    if (!conn) return;
+    
+    if (conn->pending_responses) {
+        for (size_t i = 0; i < conn->pending_capacity; i++) {
+            if (conn->pending_responses[i]) {
+                objm_response_free(conn->pending_responses[i]);
+            }
+        }
+        free(conn->pending_responses);
+    }
+    
+    /* Descriptors received but never claimed by a reply */
+    while (conn->ring_fd_next < conn->ring_nfds) {
+        close(conn->ring_fds[conn->ring_fd_next++]);
+    }
+    shmring_destroy(conn->ring);
+    
+    pthread_mutex_destroy(&conn->send_lock);
+    free(conn);
+}
+
+/* ============================================================================
+ * Server API
+ * ============================================================================ */
+
+objm_connection_t *objm_server_create(int fd) {
+    objm_connection_t *conn = calloc(1, sizeof(*conn));
+    if (!conn) return NULL;
+    
+    conn->rbuf = malloc(OBJM_RECV_BUFFER_SIZE);
+    if (!conn->rbuf) {
+        free(conn);
+        return NULL;
+    }
+    conn->rbuf_cap = OBJM_RECV_BUFFER_SIZE;
+    
+    conn->fd = fd;
+    conn->is_server = 1;
+    conn->body_pipe[0] = conn->body_pipe[1] = -1;
+    atomic_init(&conn->req_returned, (uintptr_t)NULL);
+    pthread_mutex_init(&conn->send_lock, NULL);
+    
+    return conn;
+}
+
+/**
+ * Negotiate parameters from a client's HELLO and send the HELLO_ACK
+ * 
+ * OBJM_CAP_SHM_RING is granted on Unix sockets only; the ring is created
+ * here and its descriptors ride on the ACK.
+ */
+static int server_hello_ack(objm_connection_t *conn, const objm_hello_t *hello,
+                            uint16_t client_caps, uint16_t client_pipeline) {
+    conn->params.version = OBJM_PROTO_V2;
+    conn->params.capabilities = client_caps & (hello->capabilities | OBJM_CAP_INLINE_FD |
+                                               OBJM_CAP_OPCODES);
+    conn->params.max_pipeline = (client_pipeline < hello->max_pipeline) ?
+                                 client_pipeline : hello->max_pipeline;
+    conn->params.backend_parallelism = hello->backend_parallelism;
+    
+    int fds[SHMRING_NUM_FDS];
+    size_t nfds = 0;
+    if (conn->params.capabilities & OBJM_CAP_SHM_RING) {
+        int domain = -1;
+        socklen_t domain_len = sizeof(domain);
+        if (getsockopt(conn->fd, SOL_SOCKET, SO_DOMAIN, &domain, &domain_len) == 0 &&
+            domain == AF_UNIX) {
+            conn->ring = shmring_create(OBJM_RING_SIZE);
+        }
+        if (conn->ring && shmring_get_fds(conn->ring, fds) == 0) {
+            nfds = SHMRING_NUM_FDS;
+        } else {
+            shmring_destroy(conn->ring);
+            conn->ring = NULL;
+            conn->params.capabilities &= ~OBJM_CAP_SHM_RING;
+        }
+    }
+    
+    /* HELLO_ACK: magic(4) + version(1) + caps(2) + max_pipeline(2) + backend_parallelism(1) */
+    uint8_t ack_msg[10];
+    memcpy(ack_msg, OBJM_MAGIC, OBJM_MAGIC_LEN);
+    ack_msg[4] = OBJM_VERSION_2;
+    *(uint16_t *)(ack_msg + 5) = htons(conn->params.capabilities);
+    *(uint16_t *)(ack_msg + 7) = htons(conn->params.max_pipeline);
+    ack_msg[9] = conn->params.backend_parallelism;
+    
+    struct iovec iov = { .iov_base = ack_msg, .iov_len = sizeof(ack_msg) };
+    if (sock_send_msg(conn, &iov, 1, fds, nfds) < 0) {
+        set_error(conn, "Failed to send HELLO_ACK");
+        return -1;
+    }
+    
+    conn->version = OBJM_PROTO_V2;
+    return 0;
+}
+
+int objm_server_handshake(objm_connection_t *conn, const objm_hello_t *hello,
+                          objm_params_t *params) {
+    if (!conn || !conn->is_server) return -1;
+    
+    /* Peek first byte to detect version */
+    uint8_t first_byte;
+    ssize_t n = recv(conn->fd, &first_byte, 1, MSG_PEEK);
+    if (n != 1) {
+        set_error(conn, "Failed to peek first byte");
+        return -1;
+    }
+    
+    /* Check for V2 HELLO (starts with 'O' from "OBJM") */
+    if (first_byte == 'O') {
+        /* V2 handshake */
+        uint8_t hello_msg[9];
+        if (recv_all(conn->fd, hello_msg, sizeof(hello_msg)) < 0) {
+            set_error(conn, "Failed to receive HELLO");
+            return -1;
+        }
+        
+        /* Validate */
+        if (memcmp(hello_msg, OBJM_MAGIC, OBJM_MAGIC_LEN) != 0 ||
+            hello_msg[4] != OBJM_VERSION_2) {
+            set_error(conn, "Invalid HELLO message");
+            return -1;
+        }
+        
+        uint16_t client_caps = ntohs(*(uint16_t *)(hello_msg + 5));
+        uint16_t client_pipeline = ntohs(*(uint16_t *)(hello_msg + 7));
+        
+        /* Negotiate capabilities, send HELLO_ACK */
+        if (server_hello_ack(conn, hello, client_caps, client_pipeline) < 0) {
+            return -1;
+        }
+    } else {
+        /* V1 - no handshake */
+        conn->version = OBJM_PROTO_V1;
+        conn->params.version = OBJM_PROTO_V1;
+        conn->params.capabilities = 0;
+        conn->params.max_pipeline = 1;
+        conn->params.backend_parallelism = 1;
+    }
+    
+    if (params) {
+        *params = conn->params;
+    }
+    
+    return 0;
+}
+
+/* ============================================================================
+ * Streamed bodies (COPY / SPLICE)
+ * ============================================================================ */
+
+static inline size_t rbuf_avail(const objm_connection_t *conn) {
+    return conn->rbuf_len - conn->rbuf_pos;
+}
+
+static inline const uint8_t *rbuf_data(const objm_connection_t *conn) {
+    return conn->rbuf + conn->rbuf_pos;
+}
+
+/**
+ * Drop consumed bytes from the front of the receive buffer
+ */
+static void rbuf_consume(objm_connection_t *conn, size_t len) {
+    conn->rbuf_pos += len;
+    if (conn->rbuf_pos == conn->rbuf_len) {
+        conn->rbuf_pos = 0;
+        conn->rbuf_len = 0;
+    }
+}
+
+/**
+ * Read body bytes, draining the receive buffer first
+ * 
+ * The request parser may already have pulled part of a PUT body into rbuf
+ * along with the request in front of it.
+ */
+static int body_read(objm_connection_t *conn, void *buf, size_t len) {
+    uint8_t *ptr = buf;
+    
+    if (rbuf_avail(conn) > 0) {
+        size_t take = rbuf_avail(conn) < len ? rbuf_avail(conn) : len;
+        memcpy(ptr, rbuf_data(conn), take);
+        rbuf_consume(conn, take);
+        ptr += take;
+        len -= take;
+    }
+    
+    if (conn->ring) return len > 0 ? ring_recv_all(conn, ptr, len) : 0;
+    
+    while (len > 0) {
+        ssize_t n = read(conn->fd, ptr, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) &&
+                wait_readable(conn->fd) == 0) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) return -1;  /* Peer closed mid-body */
+        ptr += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * Move len bytes of fd, starting at *off, into the socket
+ */
+static int stream_chunk_out(int sock, int fd, int pipefd[2], char mode,
+                            off_t *off, size_t len) {
+    while (len > 0) {
+        ssize_t n;
+        if (mode == OBJM_MODE_SPLICE) {
+            /* File -> pipe, then pipe -> socket: pages are never copied */
+            n = splice(fd, off, pipefd[1], NULL, len, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return -1;  /* Error, or the file shrank */
+            
+            for (ssize_t left = n; left > 0; ) {
+                ssize_t m = splice(pipefd[0], NULL, sock, NULL, left,
+                                   SPLICE_F_MOVE | SPLICE_F_MORE);
+                if (m < 0) {
+                    if (errno == EINTR) continue;
+                    if (errno == EAGAIN && wait_writable(sock) == 0) continue;
+                    return -1;
+                }
+                left -= m;
+            }
+        } else {
+            n = sendfile(sock, fd, off, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN && wait_writable(sock) == 0) continue;
+                return -1;
+            }
+            if (n == 0) return -1;  /* The file shrank under us */
+        }
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * Copy len bytes of fd, starting at *off, into the ring
+ */
+static int ring_chunk_out(objm_connection_t *conn, int fd, off_t *off, size_t len) {
+    uint8_t buf[64 * 1024];
+    
+    while (len > 0) {
+        ssize_t n = pread(fd, buf, len < sizeof(buf) ? len : sizeof(buf), *off);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;  /* Error, or the file shrank */
+        if (conn_send_all(conn, buf, n) < 0) return -1;
+        *off += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * Send file extents, back to back, as one chunked body (caller serializes
+ * the socket)
+ */
+static int stream_extents_out(objm_connection_t *conn, const objm_extent_t *extents,
+                              size_t count, char mode) {
+    int pipefd[2] = { -1, -1 };
+    int ret = -1;
+    
+    if (conn->nonblocking) return stream_extents_queue(conn, extents, count);
+    
+    uint64_t size = 0;
+    for (size_t i = 0; i < count; i++) size += extents[i].length;
+    
+    if (mode == OBJM_MODE_SPLICE && size > 0 && !conn->ring &&
+        pipe2(pipefd, O_CLOEXEC) < 0) {
+        set_error(conn, "Failed to create splice pipe");
+        return -1;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        off_t off = extents[i].offset;
+        uint64_t end = extents[i].offset + extents[i].length;
+        
+        while ((uint64_t)off < end) {
+            uint64_t left = end - off;
+            uint32_t chunk = left < OBJM_STREAM_CHUNK ? left : OBJM_STREAM_CHUNK;
+            uint32_t chunk_be = htonl(chunk);
+            
+            int ret_chunk = conn_send_all(conn, &chunk_be, sizeof(chunk_be));
+            if (ret_chunk == 0) {
+                ret_chunk = conn->ring ?
+                            ring_chunk_out(conn, extents[i].fd, &off, chunk) :
+                            stream_chunk_out(conn->fd, extents[i].fd, pipefd, mode,
+                                             &off, chunk);
+            }
+            if (ret_chunk < 0) {
+                set_error(conn, "Failed to stream body");
+                goto out;
+            }
+        }
+    }
+    
+    /* Terminating zero-length chunk */
+    uint32_t end = 0;
+    if (conn_send_all(conn, &end, sizeof(end)) < 0) {
+        set_error(conn, "Failed to stream body");
+        goto out;
+    }
+    
+    ret = 0;
+    
+out:
+    if (pipefd[0] >= 0) {
+        close(pipefd[0]);
+        close(pipefd[1]);
+    }
+    return ret;
+}
+
+/**
+ * The whole of fd as an extent (none for fd < 0)
+ */
+static int file_extent(objm_connection_t *conn, int fd, objm_extent_t *extent,
+                       size_t *count) {
+    *extent = (objm_extent_t){ .fd = fd, .offset = 0, .length = 0 };
+    *count = 0;
+    if (fd < 0) return 0;
+    
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        set_error(conn, "Streamed body must be a regular file");
+        return -1;
+    }
+    extent->length = st.st_size;
+    *count = 1;
+    return 0;
+}
+
+/**
+ * Send fd's contents as a chunked body (caller serializes the socket)
+ */
+static int stream_out(objm_connection_t *conn, int fd, char mode, uint64_t *sent) {
+    objm_extent_t extent;
+    size_t count;
+    if (file_extent(conn, fd, &extent, &count) < 0 ||
+        stream_extents_out(conn, &extent, count, mode) < 0) {
+        return -1;
+    }
+    
+    if (sent) *sent = extent.length;
+    return 0;
+}
+
+/**
+ * Land len body bytes from the socket in fd at *off (or drop them)
+ */
+static int stream_chunk_in(objm_connection_t *conn, int fd, int pipefd[2],
+                           char mode, off_t *off, size_t len) {
+    uint8_t buf[64 * 1024];
+    
+    /* Bytes already buffered by the request parser come first; ring
+     * bodies are always copied */
+    while (len > 0 && (rbuf_avail(conn) > 0 || mode != OBJM_MODE_SPLICE || fd < 0 ||
+                       conn->ring)) {
+        size_t want = len < sizeof(buf) ? len : sizeof(buf);
+        if (body_read(conn, buf, want) < 0) return -1;
+        if (fd >= 0) {
+            for (size_t done = 0; done < want; ) {
+                ssize_t n = pwrite(fd, buf + done, want - done, *off + done);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    return -1;
+                }
+                done += n;
+            }
+        }
+        *off += want;
+        len -= want;
+    }
+    
+    /* SPLICE: socket -> pipe -> file without a userspace copy */
+    while (len > 0) {
+        ssize_t n = splice(conn->fd, NULL, pipefd[1], NULL, len,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN && wait_readable(conn->fd) == 0) continue;
+            return -1;
+        }
+        if (n == 0) return -1;  /* Peer closed mid-body */
+        
+        for (ssize_t left = n; left > 0; ) {
+            ssize_t m = splice(pipefd[0], NULL, fd, off, left, SPLICE_F_MOVE);
+            if (m < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            left -= m;
+        }
+        len -= n;
+    }
+    return 0;
+}
+
+int objm_send_body(objm_connection_t *conn, int fd, char mode, uint64_t *sent) {
+    if (!conn || (mode != OBJM_MODE_COPY && mode != OBJM_MODE_SPLICE)) {
+        return -1;
+    }
+    return stream_out(conn, fd, mode, sent);
+}
+
+int objm_send_body_extents(objm_connection_t *conn, const objm_extent_t *extents,
+                           size_t count, char mode, uint64_t *sent) {
+    if (!conn || (count > 0 && !extents) ||
+        (mode != OBJM_MODE_COPY && mode != OBJM_MODE_SPLICE)) {
+        return -1;
+    }
+    if (stream_extents_out(conn, extents, count, mode) < 0) return -1;
+    
+    if (sent) {
+        *sent = 0;
+        for (size_t i = 0; i < count; i++) *sent += extents[i].length;
+    }
+    return 0;
+}
+
+int objm_recv_body(objm_connection_t *conn, int fd, char mode, uint64_t *received) {
+    if (!conn || (mode != OBJM_MODE_COPY && mode != OBJM_MODE_SPLICE)) {
+        return -1;
+    }
+    
+    int pipefd[2] = { -1, -1 };
+    if (mode == OBJM_MODE_SPLICE && fd >= 0 && !conn->ring &&
+        pipe2(pipefd, O_CLOEXEC) < 0) {
+        set_error(conn, "Failed to create splice pipe");
+        return -1;
+    }
+    
+    off_t off = 0;
+    int ret = 0;
+    
+    while (1) {
+        uint32_t chunk_be;
+        if (body_read(conn, &chunk_be, sizeof(chunk_be)) < 0) {
+            ret = -1;
+            break;
+        }
+        
+        uint32_t chunk = ntohl(chunk_be);
+        if (chunk == 0) break;
+        
+        if (stream_chunk_in(conn, fd, pipefd, mode, &off, chunk) < 0) {
+            ret = -1;
+            break;
+        }
+    }
+    
+    if (pipefd[0] >= 0) {
+        close(pipefd[0]);
+        close(pipefd[1]);
+    }
+    
+    if (ret < 0) {
+        set_error(conn, "Failed to receive body");
+        return -1;
+    }
+    if (received) *received = off;
+    return 0;
+}
+
+/**
+ * Take up to len body bytes without waiting (server, non-blocking)
+ * 
+ * An empty ring is armed first, like an idle request stream.
+ * 
+ * @return Bytes taken (0 if none have arrived), -1 on error or EOF
+ */
+static ssize_t body_take(objm_connection_t *conn, void *buf, size_t len) {
+    if (rbuf_avail(conn) > 0) {
+        size_t take = rbuf_avail(conn) < len ? rbuf_avail(conn) : len;
+        memcpy(buf, rbuf_data(conn), take);
+        rbuf_consume(conn, take);
+        return take;
+    }
+    
+    if (conn->ring) {
+        while (1) {
+            ssize_t n = shmring_read(conn->ring, buf, len);
+            if (n != 0) return n;
+            if (ring_release_fds(conn) < 0) return -1;
+            if (!shmring_arm(conn->ring)) return 0;
+        }
+    }
+    
+    while (1) {
+        ssize_t n = read(conn->fd, buf, len);
+        if (n > 0) return n;
+        if (n == 0) return -1;  /* Peer closed mid-body */
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        return -1;
+    }
+}
+
+/**
+ * Land up to len bytes of the current chunk in fd (or drop them)
+ * 
+ * @return Bytes landed (0 if none have arrived), -1 on error
+ */
+static ssize_t body_take_chunk(objm_connection_t *conn, int fd, size_t len) {
+    if (rbuf_avail(conn) > 0 || conn->body_pipe[0] < 0) {
+        uint8_t buf[64 * 1024];
+        ssize_t n = body_take(conn, buf, len < sizeof(buf) ? len : sizeof(buf));
+        if (n <= 0 || fd < 0) return n;
+        for (ssize_t done = 0; done < n; ) {
+            ssize_t m = pwrite(fd, buf + done, n - done, conn->body_off + done);
+            if (m < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            done += m;
+        }
+        return n;
+    }
+    
+    /* SPLICE: socket -> pipe -> file without a userspace copy */
+    ssize_t n;
+    while ((n = splice(conn->fd, NULL, conn->body_pipe[1], NULL, len,
+                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK)) < 0) {
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN) return 0;
+        return -1;
+    }
+    if (n == 0) return -1;  /* Peer closed mid-body */
+    
+    off_t off = conn->body_off;
+    for (ssize_t left = n; left > 0; ) {
+        ssize_t m = splice(conn->body_pipe[0], NULL, fd, &off, left, SPLICE_F_MOVE);
+        if (m < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        left -= m;
+    }
+    return n;
+}
+
+static void body_end(objm_connection_t *conn) {
+    if (conn->body_pipe[0] >= 0) {
+        close(conn->body_pipe[0]);
+        close(conn->body_pipe[1]);
+        conn->body_pipe[0] = conn->body_pipe[1] = -1;
+    }
+    conn->body_active = 0;
+}
+
+int objm_server_try_recv_body(objm_connection_t *conn, int fd, char mode,
+                              uint64_t *received) {
+    if (!conn || !conn->nonblocking ||
+        (mode != OBJM_MODE_COPY && mode != OBJM_MODE_SPLICE)) {
+        return -1;
+    }
+    
+    if (!conn->body_active) {
+        if (mode == OBJM_MODE_SPLICE && fd >= 0 && !conn->ring &&
+            pipe2(conn->body_pipe, O_CLOEXEC) < 0) {
+            set_error(conn, "Failed to create splice pipe");
+            return -1;
+        }
+        conn->body_active = 1;
+        conn->body_left = 0;
+        conn->body_hdr_len = 0;
+        conn->body_off = 0;
+    }
+    
+    while (1) {
+        ssize_t n;
+        if (conn->body_left == 0) {
+            n = body_take(conn, conn->body_hdr + conn->body_hdr_len,
+                          sizeof(conn->body_hdr) - conn->body_hdr_len);
+            if (n > 0) {
+                conn->body_hdr_len += n;
+                if (conn->body_hdr_len < sizeof(conn->body_hdr)) continue;
+                
+                uint32_t chunk_be;
+                memcpy(&chunk_be, conn->body_hdr, sizeof(chunk_be));
+                conn->body_hdr_len = 0;
+                conn->body_left = ntohl(chunk_be);
+                if (conn->body_left == 0) {
+                    /* Terminating zero-length chunk */
+                    if (received) *received = conn->body_off;
+                    body_end(conn);
+                    return 0;
+                }
+                continue;
+            }
+        } else {
+            n = body_take_chunk(conn, fd, conn->body_left);
+            if (n > 0) {
+                conn->body_off += n;
+                conn->body_left -= n;
+                continue;
+            }
+        }
+        
+        if (n == 0) return OBJM_AGAIN;
+        set_error(conn, "Failed to receive body");
+        body_end(conn);
+        return -1;
+    }
+}
+
+/* ============================================================================
+ * Request pool
+ * ============================================================================ */
+
+/**
+ * Take a request slot with room for cap bytes (receiving thread only)
+ */
+static objm_request_t *request_alloc(objm_connection_t *conn, size_t cap) {
+    request_slot_t *slot = NULL;
+    
+    if (cap <= OBJM_REQUEST_POOL_URI + 1) {
+        if (!conn->req_free) {
+            /* Take everything released since the last refill */
+            conn->req_free = (request_slot_t *)atomic_exchange(&conn->req_returned,
+                                                               (uintptr_t)NULL);
+        }
+        slot = conn->req_free;
+        if (slot) {
+            conn->req_free = slot->next;
+        } else {
+            slot = malloc(sizeof(*slot) + OBJM_REQUEST_POOL_URI + 1);
+            if (!slot) return NULL;
+            slot->pool = conn;
+            slot->cap = OBJM_REQUEST_POOL_URI + 1;
+        }
+    } else {
+        slot = malloc(sizeof(*slot) + cap);
+        if (!slot) return NULL;
+        slot->pool = NULL;
+        slot->cap = cap;
+    }
+    
+    memset(&slot->req, 0, sizeof(slot->req));
+    return &slot->req;
+}
+
+/**
+ * Return a request slot to its pool (any thread)
+ */
+static void request_release(objm_request_t *req) {
+    request_slot_t *slot = (request_slot_t *)req;
+    objm_connection_t *conn = slot->pool;
+    
+    if (!conn) {
+        free(slot);
+        return;
+    }
+    
+    /* Push only: the receiving thread takes the whole stack at once */
+    uintptr_t head = atomic_load(&conn->req_returned);
+    do {
+        slot->next = (request_slot_t *)head;
+    } while (!atomic_compare_exchange_weak(&conn->req_returned, &head,
+                                           (uintptr_t)slot));
+}
+
+static void request_pool_destroy(objm_connection_t *conn) {
+    request_slot_t *lists[2] = {
+        conn->req_free,
+        (request_slot_t *)atomic_exchange(&conn->req_returned, (uintptr_t)NULL)
+    };
+    
+    for (int i = 0; i < 2; i++) {
+        while (lists[i]) {
+            request_slot_t *next = lists[i]->next;
+            free(lists[i]);
+            lists[i] = next;
+        }
+    }
+    conn->req_free = NULL;
+}
+
+/* ============================================================================
+ * Multi-GET requests
+ * ============================================================================ */
+
+/**
+ * Parse a complete multi-GET request from a contiguous buffer
+ * 
+ * Header: msg_type(1) + request_id(4) + flags(1) + mode(1) + count(2),
+ * then count * (uri_len(2) + uri). The URI table and strings share one
+ * allocation with the request.
+ * 
+ * @return 0 on success, OBJM_AGAIN if incomplete, -1 on error
+ */
+static int multi_request_parse(objm_connection_t *conn, const uint8_t *p,
+                               size_t avail, objm_request_t **req,
+                               size_t *consumed) {
+    if (avail < 9) return OBJM_AGAIN;
+    
+    if (!(conn->params.capabilities & OBJM_CAP_BATCH)) {
+        set_error(conn, "Multi-GET without negotiated batch capability");
+        return -1;
+    }
+    
+    size_t count = ntohs(*(const uint16_t *)(p + 7));
+    if (count == 0 || count > OBJM_MAX_BATCH) {
+        set_error(conn, "Invalid multi-GET count: %zu", count);
+        return -1;
+    }
+    
+    /* Walk the entries first so nothing is allocated until it all arrived */
+    size_t off = 9;
+    for (size_t i = 0; i < count; i++) {
+        if (off + 2 > avail) return OBJM_AGAIN;
+        size_t len = ntohs(*(const uint16_t *)(p + off));
+        if (len > OBJM_MAX_URI_LEN) {
+            set_error(conn, "URI too long");
+            return -1;
+        }
+        off += 2 + len;
+        if (off > OBJM_MAX_BATCH_BYTES) {
+            set_error(conn, "Multi-GET request too large");
+            return -1;
+        }
+        if (off > avail) return OBJM_AGAIN;
+    }
+    
+    /* Strings plus their NULs fit in the encoded size */
+    size_t table = count * sizeof(char *);
+    objm_request_t *r = request_alloc(conn, table + off);
+    if (!r) return -1;
+    
+    request_slot_t *slot = (request_slot_t *)r;
+    r->uris = (char **)slot->data;
+    r->id = ntohl(*(const uint32_t *)(p + 1));
+    r->op = OBJM_OP_GET;
+    r->flags = p[5];
+    r->mode = p[6];
+    
+    char *str = slot->data + table;
+    off = 9;
+    for (size_t i = 0; i < count; i++) {
+        size_t len = ntohs(*(const uint16_t *)(p + off));
+        memcpy(str, p + off + 2, len);
+        str[len] = '\0';
+        r->uris[r->num_uris++] = str;
+        str += len + 1;
+        off += 2 + len;
+    }
+    r->uri = r->uris[0];
+    r->uri_len = strlen(r->uri);
+    
+    *req = r;
+    *consumed = off;
+    return 0;
+}
+
+/* ============================================================================
+ * Server receive
+ * ============================================================================ */
+
+/**
+ * Read available bytes into the receive buffer
+ * 
+ * One read takes as much as fits, so pipelined requests arrive together.
+ * 
+ * @return 0 if data was read, OBJM_AGAIN if the socket (or ring) is
+ *         drained, 1 on EOF, -1 on error
+ */
+static int rbuf_fill(objm_connection_t *conn) {
+    /* Move a partial message to the front once the tail runs short */
+    if (conn->rbuf_pos > 0 && conn->rbuf_cap - conn->rbuf_len < conn->rbuf_cap / 4) {
+        conn->rbuf_len -= conn->rbuf_pos;
+        memmove(conn->rbuf, conn->rbuf + conn->rbuf_pos, conn->rbuf_len);
+        conn->rbuf_pos = 0;
+    }
+    
+    if (conn->rbuf_len == conn->rbuf_cap) {
+        /* Only a multi-GET outgrows the default buffer */
+        if (conn->rbuf_cap >= OBJM_MAX_BATCH_BYTES) {
+            set_error(conn, "Receive buffer overflow");
+            return -1;
+        }
+        size_t cap = conn->rbuf_cap * 2;
+        if (cap > OBJM_MAX_BATCH_BYTES) cap = OBJM_MAX_BATCH_BYTES;
+        uint8_t *rbuf = realloc(conn->rbuf, cap);
+        if (!rbuf) {
+            set_error(conn, "Failed to grow receive buffer");
+            return -1;
+        }
+        conn->rbuf = rbuf;
+        conn->rbuf_cap = cap;
+    }
+    size_t space = conn->rbuf_cap - conn->rbuf_len;
+    
+    if (conn->ring) {
+        ssize_t n = shmring_read(conn->ring, conn->rbuf + conn->rbuf_len, space);
+        if (n < 0) {
+            set_error(conn, "Shared-memory ring corrupted");
+            return -1;
+        }
+        if (n == 0) return OBJM_AGAIN;
+        conn->rbuf_len += n;
+        return 0;
+    }
+    
+    while (1) {
+        ssize_t n = read(conn->fd, conn->rbuf + conn->rbuf_len, space);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return OBJM_AGAIN;
+            return -1;
+        }
+        if (n == 0) return 1;
+        conn->rbuf_len += n;
+        return 0;
+    }
+}
+
+/**
+ * Parse one request from the receive buffer
+ * 
+ * The URI is copied into a pooled request slot rather than pointing into
+ * rbuf: requests handed to other threads outlive the buffer contents.
+ * 
+ * @return 0 on success, OBJM_AGAIN if incomplete, 1 on CLOSE, -1 on error
+ */
+static int rbuf_parse_request(objm_connection_t *conn, objm_request_t **req) {
+    const uint8_t *p = rbuf_data(conn);
+    size_t avail = rbuf_avail(conn);
+    int opcodes = (conn->params.capabilities & OBJM_CAP_OPCODES) != 0;
+    size_t header_len = (conn->version == OBJM_PROTO_V1) ? 3 :
+                        opcodes ? OBJM_V2_REQUEST_HEADER : OBJM_V2_REQUEST_HEADER_NO_OP;
+    
+    if (conn->version == OBJM_PROTO_V2 && avail >= 1 && p[0] == OBJM_MSG_CLOSE) {
+        /* msg_type(1) + reason(1) */
+        if (avail < 2) return OBJM_AGAIN;
+        rbuf_consume(conn, 2);
+        return 1;
+    }
+    
+    if (conn->version == OBJM_PROTO_V2 && avail >= 1 &&
+        p[0] == OBJM_MSG_MULTI_REQUEST) {
+        size_t consumed;
+        int ret = multi_request_parse(conn, p, avail, req, &consumed);
+        if (ret == 0) rbuf_consume(conn, consumed);
+        return ret;
+    }
+    
+    if (avail < header_len) return OBJM_AGAIN;
+    
+    uint8_t mode, op = OBJM_OP_AUTO, flags = 0;
+    uint32_t id = 0;
+    size_t uri_len;
+    
+    if (conn->version == OBJM_PROTO_V1) {
+        mode = p[0];
+        uri_len = ntohs(*(const uint16_t *)(p + 1));
+    } else {
+        if (p[0] != OBJM_MSG_REQUEST) {
+            set_error(conn, "Unexpected message type: %d", p[0]);
+            return -1;
+        }
+        id = ntohl(*(const uint32_t *)(p + 1));
+        const uint8_t *rest = p + 5;
+        if (opcodes) op = *rest++;
+        flags = rest[0];
+        mode = rest[1];
+        uri_len = ntohs(*(const uint16_t *)(rest + 2));
+    }
+    
+    if (uri_len > OBJM_MAX_URI_LEN) {
+        set_error(conn, "URI too long");
+        return -1;
+    }
+    
+    if (avail < header_len + uri_len) return OBJM_AGAIN;
+    
+    /* Conditions: cond_len(2) + TLVs, stored after the URI */
+    size_t cond_len = 0, cond_off = header_len + uri_len;
+    if (flags & OBJM_REQ_CONDITIONAL) {
+        if (avail < cond_off + 2) return OBJM_AGAIN;
+        cond_len = ntohs(*(const uint16_t *)(p + cond_off));
+        if (cond_len > OBJM_MAX_CONDITIONS) {
+            set_error(conn, "Request conditions too long");
+            return -1;
+        }
+        cond_off += 2;
+        if (avail < cond_off + cond_len) return OBJM_AGAIN;
+    }
+    
+    /* Range: offset(8) + length(8) [+ total(8)] after the conditions */
+    size_t range_off = cond_off + cond_len, range_len = 0;
+    if ((flags & OBJM_REQ_TOTAL) && !(flags & OBJM_REQ_RANGE)) {
+        set_error(conn, "Object total without a range");
+        return -1;
+    }
+    if (flags & OBJM_REQ_RANGE) {
+        range_len = OBJM_RANGE_BYTES + ((flags & OBJM_REQ_TOTAL) ? OBJM_TOTAL_BYTES : 0);
+        if (avail < range_off + range_len) return OBJM_AGAIN;
+    }
+    
+    objm_request_t *r = request_alloc(conn, uri_len + 1 + cond_len);
+    if (!r) return -1;
+    
+    r->uri = ((request_slot_t *)r)->data;
+    r->id = id;
+    r->op = op;
+    r->flags = flags;
+    r->mode = mode;
+    r->uri_len = uri_len;
+    memcpy(r->uri, p + header_len, uri_len);
+    r->uri[uri_len] = '\0';
+    if (flags & OBJM_REQ_CONDITIONAL) {
+        r->conditions = (uint8_t *)r->uri + uri_len + 1;
+        r->conditions_len = cond_len;
+        memcpy(r->conditions, p + cond_off, cond_len);
+    }
+    if (flags & OBJM_REQ_RANGE) {
+        uint64_t be[2];
+        memcpy(be, p + range_off, sizeof(be));
+        r->range_offset = be64toh(be[0]);
+        r->range_length = be64toh(be[1]);
+    }
+    if (flags & OBJM_REQ_TOTAL) {
+        uint64_t be;
+        memcpy(&be, p + range_off + OBJM_RANGE_BYTES, sizeof(be));
+        r->range_total = be64toh(be);
+    }
+    
+    rbuf_consume(conn, range_off + range_len);
+    
+    *req = r;
+    return 0;
+}
+
+int objm_server_recv_request(objm_connection_t *conn, objm_request_t **req) {
+    if (!conn || !req) return -1;
     
-    if (conn->pending_responses) {
-        for (size_t i = 0; i < conn->pending_capacity; i++) {
-            if (conn->pending_responses[i]) {
-                objm_response_free(conn->pending_responses[i]);
+    while (1) {
+        int ret = rbuf_parse_request(conn, req);
+        if (ret != OBJM_AGAIN) return ret;
+        
+        ret = rbuf_fill(conn);
+        if (ret == OBJM_AGAIN && conn->ring) {
+            if (ring_release_fds(conn) < 0 ||
+                shmring_wait_readable(conn->ring, conn->fd) < 0) {
+                return -1;
             }
+            continue;
         }
-        free(conn->pending_responses);
+        if (ret == OBJM_AGAIN) {
+            /* Socket was switched to O_NONBLOCK */
+            if (wait_readable(conn->fd) < 0) return -1;
+            continue;
+        }
+        if (ret != 0) return -1;  /* EOF or error */
     }
-    
-    free(conn);
-}
-
-/* ============================================================================
- * Server API
- * ============================================================================ */
-
-objm_connection_t *objm_server_create(int fd) {
-    objm_connection_t *conn = calloc(1, sizeof(*conn));
-    if (!conn) return NULL;
-    
-    conn->fd = fd;
-    conn->is_server = 1;
-    
-    return conn;
 }
 
-int objm_server_handshake(objm_connection_t *conn, const objm_hello_t *hello,
-                          objm_params_t *params) {
+int objm_server_set_nonblocking(objm_connection_t *conn) {
     if (!conn || !conn->is_server) return -1;
+    if (conn->nonblocking) return 0;
     
-    /* Peek first byte to detect version */
-    uint8_t first_byte;
-    ssize_t n = recv(conn->fd, &first_byte, 1, MSG_PEEK);
-    if (n != 1) {
-        set_error(conn, "Failed to peek first byte");
+    int flags = fcntl(conn->fd, F_GETFL);
+    if (flags < 0 || fcntl(conn->fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        set_error(conn, "Failed to set O_NONBLOCK");
         return -1;
     }
     
-    /* Check for V2 HELLO (starts with 'O' from "OBJM") */
-    if (first_byte == 'O') {
-        /* V2 handshake */
-        uint8_t hello_msg[9];
-        if (recv_all(conn->fd, hello_msg, sizeof(hello_msg)) < 0) {
-            set_error(conn, "Failed to receive HELLO");
-            return -1;
-        }
-        
-        /* Validate */
-        if (memcmp(hello_msg, OBJM_MAGIC, OBJM_MAGIC_LEN) != 0 ||
-            hello_msg[4] != OBJM_VERSION_2) {
-            set_error(conn, "Invalid HELLO message");
-            return -1;
+    conn->nonblocking = 1;
+    return 0;
+}
+
+int objm_server_try_handshake(objm_connection_t *conn, const objm_hello_t *hello,
+                              objm_params_t *params) {
+    if (!conn || !conn->is_server || !conn->nonblocking || !hello) return -1;
+    
+    while (1) {
+        if (rbuf_avail(conn) >= 1 && rbuf_data(conn)[0] != 'O') {
+            /* V1 - no handshake, first byte is the request mode */
+            conn->version = OBJM_PROTO_V1;
+            conn->params.version = OBJM_PROTO_V1;
+            conn->params.capabilities = 0;
+            conn->params.max_pipeline = 1;
+            conn->params.backend_parallelism = 1;
+            break;
         }
         
-        uint16_t client_caps = ntohs(*(uint16_t *)(hello_msg + 5));
-        uint16_t client_pipeline = ntohs(*(uint16_t *)(hello_msg + 7));
-        
-        /* Negotiate capabilities */
-        conn->params.version = OBJM_PROTO_V2;
-        conn->params.capabilities = client_caps & hello->capabilities;
-        conn->params.max_pipeline = (client_pipeline < hello->max_pipeline) ?
-                                     client_pipeline : hello->max_pipeline;
-        conn->params.backend_parallelism = hello->backend_parallelism;
-        
-        /* Send HELLO_ACK */
-        uint8_t ack_msg[10];
-        memcpy(ack_msg, OBJM_MAGIC, OBJM_MAGIC_LEN);
-        ack_msg[4] = OBJM_VERSION_2;
-        *(uint16_t *)(ack_msg + 5) = htons(conn->params.capabilities);
-        *(uint16_t *)(ack_msg + 7) = htons(conn->params.max_pipeline);
-        ack_msg[9] = conn->params.backend_parallelism;
-        
-        if (send_all(conn->fd, ack_msg, sizeof(ack_msg)) < 0) {
-            set_error(conn, "Failed to send HELLO_ACK");
-            return -1;
+        if (rbuf_avail(conn) >= 9) {
+            /* V2 HELLO: magic(4) + version(1) + caps(2) + max_pipeline(2) */
+            const uint8_t *hello_msg = rbuf_data(conn);
+            
+            if (memcmp(hello_msg, OBJM_MAGIC, OBJM_MAGIC_LEN) != 0 ||
+                hello_msg[4] != OBJM_VERSION_2) {
+                set_error(conn, "Invalid HELLO message");
+                return -1;
+            }
+            
+            uint16_t client_caps = ntohs(*(const uint16_t *)(hello_msg + 5));
+            uint16_t client_pipeline = ntohs(*(const uint16_t *)(hello_msg + 7));
+            rbuf_consume(conn, 9);
+            
+            if (server_hello_ack(conn, hello, client_caps, client_pipeline) < 0) {
+                return -1;
+            }
+            break;
         }
         
-        conn->version = OBJM_PROTO_V2;
-    } else {
-        /* V1 - no handshake */
-        conn->version = OBJM_PROTO_V1;
-        conn->params.version = OBJM_PROTO_V1;
-        conn->params.capabilities = 0;
-        conn->params.max_pipeline = 1;
-        conn->params.backend_parallelism = 1;
+        int ret = rbuf_fill(conn);
+        if (ret != 0) return ret;
     }
     
     if (params) {
@@ -478,146 +2373,259 @@ int objm_server_handshake(objm_connection_t *conn, const objm_hello_t *hello,
     return 0;
 }
 
-int objm_server_recv_request(objm_connection_t *conn, objm_request_t **req) {
-    if (!conn || !req) return -1;
+int objm_server_try_recv_request(objm_connection_t *conn, objm_request_t **req) {
+    if (!conn || !req || !conn->nonblocking) return -1;
     
-    objm_request_t *r = calloc(1, sizeof(*r));
-    if (!r) return -1;
-    
-    if (conn->version == OBJM_PROTO_V1) {
-        /* V1: mode(1) + uri_len(2) + uri */
-        uint8_t header[3];
-        if (recv_all(conn->fd, header, sizeof(header)) < 0) {
-            free(r);
-            return -1;
-        }
-        
-        r->mode = header[0];
-        r->uri_len = ntohs(*(uint16_t *)(header + 1));
-        
-        if (r->uri_len > OBJM_MAX_URI_LEN) {
-            free(r);
-            set_error(conn, "URI too long");
-            return -1;
-        }
-        
-        r->uri = malloc(r->uri_len + 1);
-        if (!r->uri) {
-            free(r);
-            return -1;
-        }
-        
-        if (recv_all(conn->fd, r->uri, r->uri_len) < 0) {
-            free(r->uri);
-            free(r);
-            return -1;
-        }
-        r->uri[r->uri_len] = '\0';
-        
-    } else {
-        /* V2: msg_type(1) + request_id(4) + flags(1) + mode(1) + uri_len(2) + uri */
-        uint8_t header[9];
-        if (recv_all(conn->fd, header, sizeof(header)) < 0) {
-            free(r);
-            return -1;
-        }
-        
-        /* Check for CLOSE message */
-        if (header[0] == OBJM_MSG_CLOSE) {
-            free(r);
-            return 1;  /* Connection closing */
-        }
-        
-        if (header[0] != OBJM_MSG_REQUEST) {
-            free(r);
-            set_error(conn, "Unexpected message type: %d", header[0]);
-            return -1;
-        }
-        
-        r->id = ntohl(*(uint32_t *)(header + 1));
-        r->flags = header[5];
-        r->mode = header[6];
-        r->uri_len = ntohs(*(uint16_t *)(header + 7));
-        
-        if (r->uri_len > OBJM_MAX_URI_LEN) {
-            free(r);
-            set_error(conn, "URI too long");
-            return -1;
-        }
+    while (1) {
+        int ret = rbuf_parse_request(conn, req);
+        if (ret != OBJM_AGAIN) return ret;
         
-        r->uri = malloc(r->uri_len + 1);
-        if (!r->uri) {
-            free(r);
-            return -1;
+        ret = rbuf_fill(conn);
+        if (ret == 1) {
+            /* EOF between messages is a clean close; mid-message is an error */
+            return rbuf_avail(conn) == 0 ? 1 : -1;
         }
-        
-        if (recv_all(conn->fd, r->uri, r->uri_len) < 0) {
-            free(r->uri);
-            free(r);
-            return -1;
+        if (ret == OBJM_AGAIN && conn->ring) {
+            /* About to sleep: hand out descriptors, then ask for the
+             * doorbell (unless requests arrive while spinning) */
+            if (ring_release_fds(conn) < 0) return -1;
+            if (shmring_arm(conn->ring)) continue;
         }
-        r->uri[r->uri_len] = '\0';
+        if (ret != 0) return ret;
     }
-    
-    *req = r;
-    return 0;
 }
 
-int objm_server_send_response(objm_connection_t *conn, const objm_response_t *resp) {
-    if (!conn || !resp) return -1;
+/**
+ * Send one reply; the caller holds send_lock
+ * 
+ * Header and metadata leave in one sendmsg. When the client negotiated
+ * OBJM_CAP_INLINE_FD the descriptor and its carrier byte join them;
+ * otherwise the carrier follows in its own message as before. On a ring
+ * the descriptor is queued; a borrowed one (owned = 0) or an uncorked
+ * connection sends the queue at once.
+ */
+static int send_response_locked(objm_connection_t *conn, const objm_response_t *resp,
+                                int owned) {
+    uint8_t header[16];
+    size_t header_len;
     
     if (conn->version == OBJM_PROTO_V1) {
         /* V1: status(1) + content_len(8) + metadata_len(2) + metadata */
-        uint8_t header[11];
         header[0] = resp->status;
         *(uint64_t *)(header + 1) = htobe64(resp->content_len);
         *(uint16_t *)(header + 9) = htons(resp->metadata_len);
-        
-        if (send_all(conn->fd, header, sizeof(header)) < 0) {
-            return -1;
-        }
-        
-        if (resp->metadata_len > 0 && resp->metadata) {
-            if (send_all(conn->fd, resp->metadata, resp->metadata_len) < 0) {
-                return -1;
-            }
-        }
-        
-        /* Send FD if FD pass mode */
-        if (resp->status == OBJM_STATUS_OK && resp->fd >= 0) {
-            if (send_fd(conn->fd, resp->fd) < 0) {
-                return -1;
-            }
-        }
-        
+        header_len = 11;
     } else {
         /* V2: msg_type(1) + request_id(4) + status(1) + content_len(8) + metadata_len(2) */
-        uint8_t header[16];
         header[0] = OBJM_MSG_RESPONSE;
         *(uint32_t *)(header + 1) = htonl(resp->request_id);
         header[5] = resp->status;
         *(uint64_t *)(header + 6) = htobe64(resp->content_len);
         *(uint16_t *)(header + 14) = htons(resp->metadata_len);
-        
-        if (send_all(conn->fd, header, sizeof(header)) < 0) {
-            return -1;
+        header_len = 16;
+    }
+    
+    struct iovec iov[3];
+    int iovcnt = 0;
+    iov[iovcnt++] = (struct iovec){ .iov_base = header, .iov_len = header_len };
+    if (resp->metadata_len > 0 && resp->metadata) {
+        iov[iovcnt++] = (struct iovec){ .iov_base = resp->metadata,
+                                        .iov_len = resp->metadata_len };
+    }
+    
+    /* Send FD if FD pass mode */
+    int has_fd = resp->status == OBJM_STATUS_OK && resp->fd >= 0;
+    int ret;
+    
+    if (conn->ring) {
+        ret = ring_send_iov(conn, iov, iovcnt);
+        if (ret == 0 && has_fd) {
+            ret = ring_queue_fd(conn, resp->fd, owned);
+            if (ret == 0 && (!owned || !conn->corked)) ret = ring_flush_fds(conn);
+            return ret;
         }
-        
-        if (resp->metadata_len > 0 && resp->metadata) {
-            if (send_all(conn->fd, resp->metadata, resp->metadata_len) < 0) {
-                return -1;
-            }
+    } else if (has_fd && (conn->params.capabilities & OBJM_CAP_INLINE_FD)) {
+        char carrier = 'X';
+        iov[iovcnt++] = (struct iovec){ .iov_base = &carrier, .iov_len = 1 };
+        ret = sock_send_msg(conn, iov, iovcnt, &resp->fd, 1);
+    } else {
+        ret = sock_send_msg(conn, iov, iovcnt, NULL, 0);
+        if (ret == 0 && has_fd) {
+            char carrier = 'X';
+            struct iovec carrier_iov = { .iov_base = &carrier, .iov_len = 1 };
+            ret = sock_send_msg(conn, &carrier_iov, 1, &resp->fd, 1);
         }
-        
-        /* Send FD if FD pass mode */
-        if (resp->status == OBJM_STATUS_OK && resp->fd >= 0) {
-            if (send_fd(conn->fd, resp->fd) < 0) {
-                return -1;
-            }
+    }
+    
+    if (owned && resp->fd >= 0) close(resp->fd);
+    return ret;
+}
+
+int objm_server_send_response(objm_connection_t *conn, const objm_response_t *resp) {
+    if (!conn || !resp) return -1;
+    
+    /* Header, metadata and SCM_RIGHTS byte must not interleave with
+     * another thread's reply on the same socket */
+    pthread_mutex_lock(&conn->send_lock);
+    int ret = send_response_locked(conn, resp, 0);
+    pthread_mutex_unlock(&conn->send_lock);
+    
+    return ret;
+}
+
+int objm_server_send_response_owned(objm_connection_t *conn, const objm_response_t *resp) {
+    if (!conn || !resp) {
+        if (resp && resp->fd >= 0) close(resp->fd);
+        return -1;
+    }
+    
+    pthread_mutex_lock(&conn->send_lock);
+    int ret = send_response_locked(conn, resp, 1);
+    pthread_mutex_unlock(&conn->send_lock);
+    
+    return ret;
+}
+
+void objm_server_cork(objm_connection_t *conn) {
+    if (!conn || !conn->ring) return;
+    
+    pthread_mutex_lock(&conn->send_lock);
+    conn->corked = 1;
+    pthread_mutex_unlock(&conn->send_lock);
+}
+
+int objm_server_uncork(objm_connection_t *conn) {
+    if (!conn) return -1;
+    if (!conn->ring) return 0;
+    
+    pthread_mutex_lock(&conn->send_lock);
+    conn->corked = 0;
+    int ret = ring_flush_fds(conn);
+    pthread_mutex_unlock(&conn->send_lock);
+    
+    return ret;
+}
+
+int objm_server_send_multi_response(objm_connection_t *conn, uint32_t request_id,
+                                    const objm_response_t *items, size_t count) {
+    if (!conn || !items || count == 0 || count > OBJM_MAX_BATCH ||
+        conn->version != OBJM_PROTO_V2) {
+        return -1;
+    }
+    
+    /* msg_type(1) + request_id(4) + count(2) + count * (status(1) + content_len(8)) */
+    uint8_t buf[7 + OBJM_MAX_BATCH * 9];
+    int fds[OBJM_MAX_BATCH];
+    size_t nfds = 0;
+    
+    buf[0] = OBJM_MSG_MULTI_RESPONSE;
+    *(uint32_t *)(buf + 1) = htonl(request_id);
+    *(uint16_t *)(buf + 5) = htons(count);
+    
+    for (size_t i = 0; i < count; i++) {
+        int has_fd = items[i].status == OBJM_STATUS_OK && items[i].fd >= 0;
+        buf[7 + i * 9] = items[i].status;
+        *(uint64_t *)(buf + 7 + i * 9 + 1) =
+            htobe64(has_fd ? 0 : items[i].content_len);
+        if (has_fd) fds[nfds++] = items[i].fd;
+    }
+    size_t len = 7 + count * 9;
+    
+    /* Headers and every descriptor go out in a single sendmsg */
+    struct iovec iov = { .iov_base = buf, .iov_len = len };
+    
+    pthread_mutex_lock(&conn->send_lock);
+    int ret;
+    if (conn->ring) {
+        /* Descriptors are borrowed: they leave before this returns */
+        ret = ring_send_iov(conn, &iov, 1);
+        for (size_t i = 0; ret == 0 && i < nfds; i++) {
+            ret = ring_queue_fd(conn, fds[i], 0);
         }
+        if (ret == 0) ret = ring_flush_fds(conn);
+    } else {
+        ret = sock_send_msg(conn, &iov, 1, fds, nfds);
     }
+    pthread_mutex_unlock(&conn->send_lock);
     
-    return 0;
+    if (ret < 0) set_error(conn, "Failed to send multi-GET response");
+    return ret;
+}
+
+/**
+ * Streamed reply: header with size (and encoding, unless identity), body
+ */
+static int send_stream_reply(objm_connection_t *conn, uint32_t request_id,
+                             const objm_extent_t *extents, size_t count,
+                             char mode, uint8_t encoding,
+                             const uint8_t *extra, size_t extra_len) {
+    if (!conn || (mode != OBJM_MODE_COPY && mode != OBJM_MODE_SPLICE) ||
+        extra_len > OBJM_MAX_METADATA - 16 || (count && !extents)) {
+        return -1;
+    }
+    
+    uint64_t size = 0;
+    for (size_t i = 0; i < count; i++) size += extents[i].length;
+    
+    uint8_t meta[OBJM_MAX_METADATA];
+    size_t meta_len = objm_metadata_add_size(meta, 0, size);
+    if (encoding != OBJM_ENCODING_IDENTITY) {
+        meta_len = objm_metadata_add_encoding(meta, meta_len, encoding);
+    }
+    if (extra_len > 0) {
+        memcpy(meta + meta_len, extra, extra_len);
+        meta_len += extra_len;
+    }
+    
+    objm_response_t resp = {
+        .request_id = request_id,
+        .status = OBJM_STATUS_OK,
+        .fd = -1,
+        .content_len = OBJM_CONTENT_CHUNKED,
+        .metadata = meta,
+        .metadata_len = meta_len,
+        .error_msg = NULL
+    };
+    
+    /* The body is part of the reply: nothing may interleave with it */
+    pthread_mutex_lock(&conn->send_lock);
+    int ret = send_response_locked(conn, &resp, 0);
+    if (ret == 0) ret = stream_extents_out(conn, extents, count, mode);
+    pthread_mutex_unlock(&conn->send_lock);
+    
+    return ret;
+}
+
+int objm_server_send_stream(objm_connection_t *conn, uint32_t request_id,
+                            int fd, char mode) {
+    return objm_server_send_stream_meta(conn, request_id, fd, mode,
+                                        OBJM_ENCODING_IDENTITY, NULL, 0);
+}
+
+int objm_server_send_stream_encoded(objm_connection_t *conn, uint32_t request_id,
+                                    int fd, char mode, uint8_t encoding) {
+    return objm_server_send_stream_meta(conn, request_id, fd, mode, encoding, NULL, 0);
+}
+
+int objm_server_send_stream_meta(objm_connection_t *conn, uint32_t request_id,
+                                 int fd, char mode, uint8_t encoding,
+                                 const uint8_t *metadata, size_t metadata_len) {
+    if (!conn) return -1;
+    
+    objm_extent_t extent;
+    size_t count;
+    if (file_extent(conn, fd, &extent, &count) < 0) return -1;
+    return send_stream_reply(conn, request_id, &extent, count, mode, encoding,
+                             metadata, metadata ? metadata_len : 0);
+}
+
+int objm_server_send_stream_extents(objm_connection_t *conn, uint32_t request_id,
+                                    const objm_extent_t *extents, size_t count,
+                                    char mode, const uint8_t *metadata,
+                                    size_t metadata_len) {
+    return send_stream_reply(conn, request_id, extents, count, mode,
+                             OBJM_ENCODING_IDENTITY, metadata,
+                             metadata ? metadata_len : 0);
 }
 
 int objm_server_send_error(objm_connection_t *conn, uint32_t request_id,
@@ -628,22 +2636,15 @@ int objm_server_send_error(objm_connection_t *conn, uint32_t request_id,
     resp.fd = -1;
     
     /* Add error message as metadata if provided */
+    uint8_t meta[OBJM_MAX_METADATA];
     if (error_msg) {
         size_t msg_len = strlen(error_msg);
-        resp.metadata = objm_metadata_create(msg_len + 10);
-        if (resp.metadata) {
-            resp.metadata_len = objm_metadata_add(resp.metadata, 0, 0xFF,
-                                                   error_msg, msg_len);
-        }
-    }
-    
-    int ret = objm_server_send_response(conn, &resp);
-    
-    if (resp.metadata) {
-        free(resp.metadata);
+        if (msg_len > OBJM_MAX_METADATA - 3) msg_len = OBJM_MAX_METADATA - 3;
+        resp.metadata = meta;
+        resp.metadata_len = objm_metadata_add(meta, 0, 0xFF, error_msg, msg_len);
     }
     
-    return ret;
+    return objm_server_send_response(conn, &resp);
 }
 
 int objm_server_send_close_ack(objm_connection_t *conn, uint32_t outstanding) {
@@ -656,11 +2657,45 @@ int objm_server_send_close_ack(objm_connection_t *conn, uint32_t outstanding) {
     ack[1] = 0;  /* Reserved */
     *(uint32_t *)(ack + 2) = htonl(outstanding);
     
-    return send_all(conn->fd, ack, sizeof(ack));
+    pthread_mutex_lock(&conn->send_lock);
+    int ret = conn_send_all(conn, ack, sizeof(ack));
+    pthread_mutex_unlock(&conn->send_lock);
+    
+    return ret;
+}
+
+int objm_server_flush(objm_connection_t *conn) {
+    if (!conn) return -1;
+    
+    pthread_mutex_lock(&conn->send_lock);
+    int ret = out_flush_locked(conn);
+    pthread_mutex_unlock(&conn->send_lock);
+    
+    return ret;
+}
+
+size_t objm_server_pending(objm_connection_t *conn) {
+    if (!conn) return 0;
+    
+    pthread_mutex_lock(&conn->send_lock);
+    size_t pending = conn->out_bytes;
+    pthread_mutex_unlock(&conn->send_lock);
+    
+    return pending;
 }
 
 void objm_server_destroy(objm_connection_t *conn) {
     if (!conn) return;
+    out_queue_drop(&conn->out);
+    out_queue_drop(&conn->ring_out);
+    for (size_t i = 0; i < conn->ring_nfds; i++) {
+        if (conn->ring_fd_owned[i]) close(conn->ring_fds[i]);
+    }
+    body_end(conn);
+    shmring_destroy(conn->ring);
+    pthread_mutex_destroy(&conn->send_lock);
+    request_pool_destroy(conn);
+    free(conn->rbuf);
     free(conn);
 }
 
@@ -683,6 +2718,14 @@ int objm_get_fd(objm_connection_t *conn) {
     return conn ? conn->fd : -1;
 }
 
+int objm_get_doorbell_fd(objm_connection_t *conn) {
+    return conn && conn->ring ? shmring_doorbell_fd(conn->ring) : -1;
+}
+
+int objm_get_space_fd(objm_connection_t *conn) {
+    return conn && conn->ring ? shmring_space_fd(conn->ring) : -1;
+}
+
 void objm_set_callbacks(objm_connection_t *conn, const objm_callbacks_t *callbacks,
                         void *user_data) {
     if (!conn) return;
@@ -696,8 +2739,8 @@ void objm_set_callbacks(objm_connection_t *conn, const objm_callbacks_t *callbac
 
 void objm_request_free(objm_request_t *req) {
     if (!req) return;
-    free(req->uri);
-    free(req);
+    /* URIs live in the request's slot */
+    request_release(req);
 }
 
 void objm_response_free(objm_response_t *resp) {
@@ -705,7 +2748,16 @@ void objm_response_free(objm_response_t *resp) {
     if (resp->fd >= 0) {
         close(resp->fd);
     }
-    free(resp->metadata);
+    if (resp->items) {
+        for (size_t i = 0; i < resp->num_items; i++) {
+            if (resp->items[i].fd >= 0) close(resp->items[i].fd);
+            free(resp->items[i].metadata);
+            free(resp->items[i].error_msg);
+        }
+        free(resp->items);
+    }
+    /* Received metadata shares the response's allocation */
+    if (resp->metadata != (uint8_t *)(resp + 1)) free(resp->metadata);
     free(resp->error_msg);
     free(resp);
 }
@@ -743,6 +2795,27 @@ size_t objm_metadata_add_backend(uint8_t *metadata, size_t current_len, uint8_t
     return objm_metadata_add(metadata, current_len, OBJM_META_BACKEND, &backend_id, 1);
 }
 
+size_t objm_metadata_add_encoding(uint8_t *metadata, size_t current_len, uint8_t encoding) {
+    return objm_metadata_add(metadata, current_len, OBJM_META_ENCODING, &encoding, 1);
+}
+
+size_t objm_metadata_add_etag(uint8_t *metadata, size_t current_len, const char *etag) {
+    if (!etag) return 0;
+    return objm_metadata_add(metadata, current_len, OBJM_META_ETAG, etag, strlen(etag));
+}
+
+size_t objm_metadata_add_range(uint8_t *metadata, size_t current_len,
+                               uint64_t offset, uint64_t length, uint64_t size) {
+    uint64_t range_be[3] = { htobe64(offset), htobe64(length), htobe64(size) };
+    return objm_metadata_add(metadata, current_len, OBJM_META_RANGE, range_be,
+                             sizeof(range_be));
+}
+
+size_t objm_metadata_add_count(uint8_t *metadata, size_t current_len, uint64_t count) {
+    uint64_t count_be = htobe64(count);
+    return objm_metadata_add(metadata, current_len, OBJM_META_COUNT, &count_be, 8);
+}
+
 int objm_metadata_parse(const uint8_t *metadata, size_t metadata_len,
                         objm_metadata_entry_t **entries, size_t *num_entries) {
     if (!metadata || !entries || !num_entries) return -1;
@@ -807,11 +2880,13 @@ void objm_metadata_free_entries(objm_metadata_entry_t *entries, size_t num_entri
 const char *objm_status_name(uint8_t status) {
     switch (status) {
         case OBJM_STATUS_OK: return "OK";
+        case OBJM_STATUS_NOT_MODIFIED: return "NOT_MODIFIED";
         case OBJM_STATUS_NOT_FOUND: return "NOT_FOUND";
         case OBJM_STATUS_INVALID_REQUEST: return "INVALID_REQUEST";
         case OBJM_STATUS_INVALID_MODE: return "INVALID_MODE";
         case OBJM_STATUS_URI_TOO_LONG: return "URI_TOO_LONG";
         case OBJM_STATUS_UNSUPPORTED_OP: return "UNSUPPORTED_OP";
+        case OBJM_STATUS_INVALID_RANGE: return "INVALID_RANGE";
         case OBJM_STATUS_INTERNAL_ERROR: return "INTERNAL_ERROR";
         case OBJM_STATUS_STORAGE_ERROR: return "STORAGE_ERROR";
         case OBJM_STATUS_OUT_OF_MEMORY: return "OUT_OF_MEMORY";
@@ -833,6 +2908,20 @@ const char *objm_mode_name(char mode) {
     }
 }
 
+const char *objm_op_name(uint8_t op) {
+    switch (op) {
+        case OBJM_OP_AUTO: return "AUTO";
+        case OBJM_OP_GET: return "GET";
+        case OBJM_OP_PUT: return "PUT";
+        case OBJM_OP_DELETE: return "DELETE";
+        case OBJM_OP_STAT: return "STAT";
+        case OBJM_OP_LIST: return "LIST";
+        case OBJM_OP_STATS: return "STATS";
+        case OBJM_OP_PURGE: return "PURGE";
+        default: return "UNKNOWN";
+    }
+}
+
 int objm_capability_names(uint16_t capabilities, char *buffer, size_t size) {
     int written = 0;
     int first = 1;
@@ -857,6 +2946,21 @@ int objm_capability_names(uint16_t capabilities, char *buffer, size_t size) {
                            "%sMULTIPLEXING", first ? "" : "|");
         first = 0;
     }
+    if (capabilities & OBJM_CAP_BATCH) {
+        written += snprintf(buffer + written, size - written,
+                           "%sBATCH", first ? "" : "|");
+        first = 0;
+    }
+    if (capabilities & OBJM_CAP_SHM_RING) {
+        written += snprintf(buffer + written, size - written,
+                           "%sSHM_RING", first ? "" : "|");
+        first = 0;
+    }
+    if (capabilities & OBJM_CAP_OPCODES) {
+        written += snprintf(buffer + written, size - written,
+                           "%sOPCODES", first ? "" : "|");
+        first = 0;
+    }
     
     return written;
 }
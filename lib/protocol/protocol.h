@@ -20,7 +20,7 @@ extern "C" {
 /* ============================================================================
  * Constants
  * ============================================================================ */
-
+ 
 #define OBJM_MAGIC "OBJM"
 #define OBJM_MAGIC_LEN 4
 
@@ -30,28 +30,57 @@ extern "C" {
 /* Capability flags */
 #define OBJM_CAP_OOO_REPLIES    0x0001  /* Can handle out-of-order responses */
 #define OBJM_CAP_PIPELINING     0x0002  /* Can send pipelined requests */
-#define OBJM_CAP_COMPRESSION    0x0004  /* Reserved for future */
+#define OBJM_CAP_COMPRESSION    0x0004  /* Streamed GET bodies may come in the
+                                         * stored gzip form (OBJM_META_ENCODING) */
 #define OBJM_CAP_MULTIPLEXING   0x0008  /* Reserved for future */
-
+#define OBJM_CAP_BATCH          0x0010  /* Multi-GET with batched FD passing */
+#define OBJM_CAP_INLINE_FD      0x0020  /* Reply FD rides on the header's sendmsg
+                                         * (negotiated by the library itself) */
+#define OBJM_CAP_SHM_RING       0x0040  /* Messages through a shared-memory ring,
+                                         * the Unix socket only carries FDs */
+#define OBJM_CAP_OPCODES        0x0080  /* Request header carries an op byte
+                                         * (negotiated by the library itself) */
+                                         
 /* Request flags */
 #define OBJM_REQ_ORDERED   0x01  /* Force in-order response */
 #define OBJM_REQ_PRIORITY  0x02  /* High priority request */
+#define OBJM_REQ_BODY      0x04  /* Chunked body follows (COPY/SPLICE PUT) */
+#define OBJM_REQ_CONDITIONAL 0x08  /* Conditions follow the URI (V2 GET) */
+#define OBJM_REQ_RANGE     0x10  /* Byte range follows the URI (V2 GET, PUT part) */
+#define OBJM_REQ_TOTAL     0x20  /* Object size follows the range (V2 first PUT part) */
+
+/* Operation codes (V2 request header; V1 requests are always AUTO) */
+#define OBJM_OP_AUTO       0x00  /* Legacy: get-or-create, /delete/ and /list URIs;
+                                    * the only op without OBJM_CAP_OPCODES */
+#define OBJM_OP_GET        0x01  /* Read an existing object */
+#define OBJM_OP_PUT        0x02  /* Create or replace an object */
+#define OBJM_OP_DELETE     0x03  /* Remove an object */
+#define OBJM_OP_STAT       0x04  /* Metadata only, no FD or body */
+#define OBJM_OP_LIST       0x05  /* List objects (management) */
+#define OBJM_OP_STATS      0x06  /* Server statistics report (management) */
+#define OBJM_OP_PURGE      0x07  /* Delete every object under a URI prefix (management) */
 
 /* Message types */
 #define OBJM_MSG_REQUEST    0x01
 #define OBJM_MSG_RESPONSE   0x02
 #define OBJM_MSG_CLOSE      0x03
 #define OBJM_MSG_CLOSE_ACK  0x04
+#define OBJM_MSG_MULTI_REQUEST   0x05  /* Multi-GET (OBJM_CAP_BATCH) */
+#define OBJM_MSG_MULTI_RESPONSE  0x06  /* All results + FDs in one sendmsg */
 
 /* Status codes */
 #define OBJM_STATUS_OK              0x00
 
+/* Conditional GET: object unchanged, validators in the metadata */
+#define OBJM_STATUS_NOT_MODIFIED    0x30
+
 /* Client errors (4xx equivalent) */
 #define OBJM_STATUS_NOT_FOUND       0x01
 #define OBJM_STATUS_INVALID_REQUEST 0x02
 #define OBJM_STATUS_INVALID_MODE    0x03
 #define OBJM_STATUS_URI_TOO_LONG    0x04
 #define OBJM_STATUS_UNSUPPORTED_OP  0x05
+#define OBJM_STATUS_INVALID_RANGE   0x06  /* Range outside the object, or misaligned part */
 
 /* Server errors (5xx equivalent) */
 #define OBJM_STATUS_INTERNAL_ERROR  0x10
@@ -77,6 +106,13 @@ extern "C" {
 #define OBJM_META_MIME      0x04  /* MIME type (variable string) */
 #define OBJM_META_BACKEND   0x05  /* Backend path ID (1 byte) */
 #define OBJM_META_LATENCY   0x06  /* Processing latency (4 bytes, μs) */
+#define OBJM_META_ENCODING  0x07  /* Body encoding (1 byte, OBJM_ENCODING_*) */
+#define OBJM_META_RANGE     0x08  /* Object bytes held: offset, length, object size (24 bytes) */
+#define OBJM_META_COUNT     0x09  /* Objects affected, e.g. by a purge (8 bytes) */
+
+/* Body encodings (OBJM_CAP_COMPRESSION) */
+#define OBJM_ENCODING_IDENTITY  0x00  /* Plain bytes (also: no OBJM_META_ENCODING) */
+#define OBJM_ENCODING_GZIP      0x01  /* One gzip member (RFC 1952) */
 
 /* Close reasons */
 #define OBJM_CLOSE_NORMAL    0x00
@@ -88,11 +124,50 @@ extern "C" {
 #define OBJM_MAX_URI_LEN     4096
 #define OBJM_MAX_PIPELINE    1000
 #define OBJM_MAX_METADATA    1024
+#define OBJM_MAX_BATCH       253    /* URIs per multi-GET (Linux SCM_MAX_FD) */
+#define OBJM_MAX_BATCH_BYTES (64 * 1024)  /* Largest multi-GET request */
+#define OBJM_SEND_BATCH      128    /* Requests per sendmsg in objm_client_send_requests() */
+
+/* Streamed bodies (COPY/SPLICE): content_len marker and chunk size */
+#define OBJM_CONTENT_CHUNKED UINT64_MAX
+#define OBJM_CONTENT_NONE    (UINT64_MAX - 1)  /* Reply has no FD and no body */
+#define OBJM_STREAM_CHUNK    (1024 * 1024)
+
+/* V2 request: msg_type(1) + request_id(4) + op(1) + flags(1) + mode(1) + uri_len(2);
+ * the op byte is only sent once both sides negotiated OBJM_CAP_OPCODES */
+#define OBJM_V2_REQUEST_HEADER 10
+#define OBJM_V2_REQUEST_HEADER_NO_OP 9
+
+/* OBJM_REQ_CONDITIONAL: cond_len(2) + conditions (metadata TLVs) after the URI */
+#define OBJM_MAX_CONDITIONS  256
+
+/* OBJM_REQ_RANGE: offset(8) + length(8) after the URI and any conditions */
+#define OBJM_RANGE_BYTES     16
+
+/* OBJM_REQ_TOTAL: total(8) after the range */
+#define OBJM_TOTAL_BYTES     8
+
+/* Multipart PUT: parts start at multiples of this, and all but the last
+ * are this long (the reference server stores each part as one chunk) */
+#define OBJM_PART_SIZE       (8 * 1024 * 1024)
+
+/* Server receive buffer: filled by large reads, requests parsed from it
+ * (holds several pipelined requests, and at least one maximal one) */
+#define OBJM_RECV_BUFFER_SIZE (16 * 1024)
+
+/* Requests with URIs up to this length come from the connection's pool */
+#define OBJM_REQUEST_POOL_URI 512
+
+/* Shared-memory ring (OBJM_CAP_SHM_RING): bytes per direction */
+#define OBJM_RING_SIZE (64 * 1024)
+
+/* Return code for non-blocking operations that need more data */
+#define OBJM_AGAIN           2
 
 /* ============================================================================
  * Types
  * ============================================================================ */
-
+ 
 /**
  * Protocol version
  */
@@ -111,16 +186,24 @@ typedef struct objm_connection objm_connection_t;
  */
 typedef struct {
     uint32_t id;           /* Request ID (V2 only) */
+    uint8_t op;            /* Operation code (V2 only, OBJM_OP_AUTO for V1) */
     uint8_t flags;         /* Request flags */
     char mode;             /* Operation mode ('1', '2', '3') */
     char *uri;             /* URI string (caller owns) */
     size_t uri_len;        /* URI length */
+    char **uris;           /* Multi-GET: all URIs (uri == uris[0]) */
+    size_t num_uris;       /* Multi-GET: URI count (0 = single request) */
+    uint8_t *conditions;   /* OBJM_REQ_CONDITIONAL: metadata TLVs (caller owns) */
+    size_t conditions_len; /* Conditions length */
+    uint64_t range_offset; /* OBJM_REQ_RANGE: first byte */
+    uint64_t range_length; /* OBJM_REQ_RANGE: bytes (0 = to the end) */
+    uint64_t range_total;  /* OBJM_REQ_TOTAL: size of the whole object */
 } objm_request_t;
 
 /**
  * Response handle
  */
-typedef struct {
+typedef struct objm_response {
     uint32_t request_id;   /* Matching request ID */
     uint8_t status;        /* Status code */
     int fd;                /* File descriptor (for FD pass mode, -1 otherwise) */
@@ -128,6 +211,8 @@ typedef struct {
     uint8_t *metadata;     /* Optional metadata (caller must free) */
     size_t metadata_len;   /* Metadata length */
     char *error_msg;       /* Error message if status != OK (caller must free) */
+    struct objm_response *items;  /* Multi-GET: per-URI results, in request order */
+    size_t num_items;      /* Multi-GET: result count (0 = single response) */
 } objm_response_t;
 
 /**
@@ -158,6 +243,15 @@ typedef struct {
     uint8_t *data;         /* Data bytes (caller must free) */
 } objm_metadata_entry_t;
 
+/**
+ * Part of a file to stream (objm_server_send_stream_extents())
+ */
+typedef struct {
+    int fd;                /* Regular file */
+    uint64_t offset;       /* First byte in the file */
+    uint64_t length;       /* Bytes */
+} objm_extent_t;
+
 /**
  * Connection callbacks (for async operation)
  */
@@ -178,7 +272,7 @@ typedef struct {
 /* ============================================================================
  * Client API
  * ============================================================================ */
-
+ 
 /**
  * Create a new client connection
  * 
@@ -198,19 +292,68 @@ objm_connection_t *objm_client_create(int fd, objm_version_t version);
  */
 int objm_client_hello(objm_connection_t *conn, const objm_hello_t *hello, 
                       objm_params_t *params);
-
+                      
 /**
  * Send a request
  * 
+ * A V2 GET with OBJM_REQ_CONDITIONAL carries req->conditions, built with
+ * the metadata helpers: OBJM_META_ETAG entries (if-none-match, "*" matches
+ * any version) and/or OBJM_META_MTIME (if-modified-since). The server then
+ * answers OBJM_STATUS_NOT_MODIFIED, with no FD or body, when an ETag
+ * matches or, without ETags, when the object is not newer than the time.
+ * 
+ * With OBJM_REQ_RANGE, a GET asks for req->range_length bytes (0 = up to
+ * the end) from req->range_offset, and a PUT with a body stores it as the
+ * part of the object starting at range_offset (a multiple of
+ * OBJM_PART_SIZE; see docs/PROTOCOL.md for multipart uploads). The first
+ * part may add OBJM_REQ_TOTAL with req->range_total, the size of the new
+ * version: a shorter one then replaces a longer one without a DELETE.
+ * 
  * @param conn Connection handle
  * @param req Request to send
  * @return 0 on success, -1 on error
  */
 int objm_client_send_request(objm_connection_t *conn, const objm_request_t *req);
 
+/**
+ * Send several requests with as few writes as possible
+ * 
+ * Up to OBJM_SEND_BATCH requests go out in one sendmsg(), so a pipelined
+ * burst costs one syscall instead of two per request. Requests that need a
+ * body (OBJM_REQ_BODY) must be sent on their own, followed by the body.
+ * 
+ * @param conn Connection handle
+ * @param reqs Requests to send, in order
+ * @param count Number of requests
+ * @return 0 on success, -1 on error (some requests may have been sent)
+ */
+int objm_client_send_requests(objm_connection_t *conn, const objm_request_t *reqs,
+                              size_t count);
+                              
+/**
+ * Send a multi-GET request (V2, requires OBJM_CAP_BATCH)
+ * 
+ * The reply is a single response whose items[] hold one result per URI,
+ * in request order. All found objects' FDs arrive in one sendmsg.
+ * 
+ * @param conn Connection handle
+ * @param request_id Request ID
+ * @param flags Request flags
+ * @param mode Operation mode (only OBJM_MODE_FDPASS is batched)
+ * @param uris URIs to fetch
+ * @param count Number of URIs (1 to OBJM_MAX_BATCH)
+ * @return 0 on success, -1 on error
+ */
+int objm_client_send_multi_get(objm_connection_t *conn, uint32_t request_id,
+                               uint8_t flags, char mode,
+                               const char *const *uris, size_t count);
+                               
 /**
  * Receive a response (blocking)
  * 
+ * A response with content_len OBJM_CONTENT_CHUNKED carries no FD; its
+ * body must be read with objm_recv_body() before the next response.
+ * 
  * @param conn Connection handle
  * @param resp Output: response (caller must free with objm_response_free)
  * @return 0 on success, -1 on error
@@ -220,6 +363,10 @@ int objm_client_recv_response(objm_connection_t *conn, objm_response_t **resp);
 /**
  * Receive a specific response by request ID (V2 OOO mode)
  * 
+ * Another request's streamed reply met on the way is buffered in an
+ * anonymous memfd: it is stored with that fd and content_len set to the
+ * body size instead of OBJM_CONTENT_CHUNKED.
+ * 
  * @param conn Connection handle
  * @param request_id Request ID to wait for
  * @param resp Output: response (caller must free)
@@ -227,6 +374,54 @@ int objm_client_recv_response(objm_connection_t *conn, objm_response_t **resp);
  */
 int objm_client_recv_response_for(objm_connection_t *conn, uint32_t request_id,
                                    objm_response_t **resp);
+                                   
+/**
+ * Stream a regular file as a chunked body (COPY or SPLICE mode)
+ * 
+ * Body: repeated chunk_len(4) + data, ended by a zero-length chunk. The
+ * whole file is sent from offset 0 with sendfile() (COPY) or splice()
+ * through a pipe (SPLICE), so the data never enters userspace and the
+ * descriptor's file offset is not touched. Clients call this right after
+ * a request carrying OBJM_REQ_BODY.
+ * 
+ * @param conn Connection handle
+ * @param fd Source file (-1 for an empty body)
+ * @param mode OBJM_MODE_COPY or OBJM_MODE_SPLICE
+ * @param sent Output: payload bytes sent (may be NULL)
+ * @return 0 on success, -1 on error (the stream is unusable afterwards)
+ */
+int objm_send_body(objm_connection_t *conn, int fd, char mode, uint64_t *sent);
+
+/**
+ * Stream parts of files as one chunked body (COPY or SPLICE mode)
+ * 
+ * Like objm_send_body(), for e.g. one part of a file in a multipart PUT.
+ * 
+ * @param conn Connection handle
+ * @param extents Parts of the body, in order (regular files)
+ * @param count Number of extents (0 for an empty body)
+ * @param mode OBJM_MODE_COPY or OBJM_MODE_SPLICE
+ * @param sent Output: payload bytes sent (may be NULL)
+ * @return 0 on success, -1 on error (the stream is unusable afterwards)
+ */
+int objm_send_body_extents(objm_connection_t *conn, const objm_extent_t *extents,
+                           size_t count, char mode, uint64_t *sent);
+
+/**
+ * Receive a chunked body into a file (COPY or SPLICE mode)
+ * 
+ * Client side this follows a response whose content_len is
+ * OBJM_CONTENT_CHUNKED; server side it follows a request with
+ * OBJM_REQ_BODY. Data is written from offset 0 with pwrite() (COPY) or
+ * spliced from the socket (SPLICE).
+ * 
+ * @param conn Connection handle
+ * @param fd Destination file (-1 to discard the body)
+ * @param mode OBJM_MODE_COPY or OBJM_MODE_SPLICE
+ * @param received Output: payload bytes received (may be NULL)
+ * @return 0 on success, -1 on error (the stream is unusable afterwards)
+ */
+int objm_recv_body(objm_connection_t *conn, int fd, char mode, uint64_t *received);
 
 /**
  * Close connection gracefully
@@ -247,7 +442,7 @@ void objm_client_destroy(objm_connection_t *conn);
 /* ============================================================================
  * Server API
  * ============================================================================ */
-
+ 
 /**
  * Create a new server connection
  * 
@@ -266,25 +461,247 @@ objm_connection_t *objm_server_create(int fd);
  */
 int objm_server_handshake(objm_connection_t *conn, const objm_hello_t *hello,
                           objm_params_t *params);
-
+                          
 /**
  * Receive a request (blocking)
  * 
+ * Parses from the connection's receive buffer, which is refilled by large
+ * reads, so pipelined requests cost one read() between them.
+ * 
  * @param conn Connection handle
  * @param req Output: request (caller must free with objm_request_free)
  * @return 0 on success, -1 on error, 1 on connection close
  */
 int objm_server_recv_request(objm_connection_t *conn, objm_request_t **req);
 
+/**
+ * Switch server connection to non-blocking (event-driven) operation
+ * 
+ * Puts the socket in O_NONBLOCK mode; the connection-owned receive buffer
+ * is kept across partial messages. After this, use objm_server_try_handshake() and
+ * objm_server_try_recv_request() instead of the blocking variants.
+ * Replies never wait for the socket either: what it does not take is
+ * queued and sent by objm_server_flush(), and so is ring data that does not
+ * fit in the ring.
+ * 
+ * @param conn Connection handle
+ * @return 0 on success, -1 on error
+ */
+int objm_server_set_nonblocking(objm_connection_t *conn);
+
+/**
+ * Resumable handshake for non-blocking connections
+ * 
+ * Consumes whatever bytes are available. Call again when the socket
+ * becomes readable until it returns something other than OBJM_AGAIN.
+ * 
+ * @param conn Connection handle (non-blocking)
+ * @param hello Server hello parameters (for V2)
+ * @param params Output: negotiated parameters (can be NULL)
+ * @return 0 on success, OBJM_AGAIN if more data is needed, 1 on connection
+ *         close, -1 on error
+ */
+int objm_server_try_handshake(objm_connection_t *conn, const objm_hello_t *hello,
+                              objm_params_t *params);
+                              
+/**
+ * Resumable request receive for non-blocking connections
+ * 
+ * Parses the next complete request from the receive buffer, reading from
+ * the socket as needed. Partial messages are kept across calls.
+ * 
+ * @param conn Connection handle (non-blocking)
+ * @param req Output: request (caller must free with objm_request_free)
+ * @return 0 on success, OBJM_AGAIN if no complete request is available,
+ *         1 on connection close, -1 on error
+ */
+int objm_server_try_recv_request(objm_connection_t *conn, objm_request_t **req);
+
+/**
+ * Resumable body receive for non-blocking connections
+ * 
+ * Like objm_recv_body() for the body following a request with
+ * OBJM_REQ_BODY, but it lands whatever bytes are available and returns.
+ * Call again with the same fd and mode when the connection becomes
+ * readable, until it returns something other than OBJM_AGAIN; nothing
+ * else may be received meanwhile.
+ * 
+ * @param conn Connection handle (non-blocking)
+ * @param fd Destination file (-1 to discard the body)
+ * @param mode OBJM_MODE_COPY or OBJM_MODE_SPLICE
+ * @param received Output: payload bytes received, once complete (may be NULL)
+ * @return 0 once the body is complete, OBJM_AGAIN if more data is needed,
+ *         -1 on error (the stream is unusable afterwards)
+ */
+int objm_server_try_recv_body(objm_connection_t *conn, int fd, char mode,
+                              uint64_t *received);
+
 /**
  * Send a response
  * 
+ * Thread-safe: concurrent senders on one connection are serialized per
+ * response, so V2 out-of-order replies can come from any thread.
+ * 
  * @param conn Connection handle
  * @param resp Response to send
  * @return 0 on success, -1 on error
  */
 int objm_server_send_response(objm_connection_t *conn, const objm_response_t *resp);
 
+/**
+ * Send a response and hand its FD over to the connection
+ * 
+ * Like objm_server_send_response(), but resp->fd is owned by the library
+ * from here on and closed on every path. On a shared-memory ring
+ * connection that is corked, the descriptor is queued and shipped with
+ * the others in one sendmsg when the connection is uncorked.
+ * 
+ * @param conn Connection handle
+ * @param resp Response to send (resp->fd is consumed)
+ * @return 0 on success, -1 on error
+ */
+int objm_server_send_response_owned(objm_connection_t *conn, const objm_response_t *resp);
+
+/**
+ * Send queued output of a non-blocking connection
+ * 
+ * Replies, streamed bodies included, are queued in order when the socket
+ * or the shared-memory ring is full. Call this when the socket becomes
+ * writable again (EPOLLOUT), when the ring's space doorbell fires
+ * (objm_get_space_fd()) and after replying. Ring output that still does
+ * not fit has the doorbell armed; only socket output is reported.
+ * A no-op on blocking connections.
+ * 
+ * @param conn Connection handle
+ * @return 0 if nothing waits for the socket, OBJM_AGAIN if output waits for
+ *         it to become writable, -1 on error
+ */
+int objm_server_flush(objm_connection_t *conn);
+
+/**
+ * Bytes of queued output (streamed bodies included)
+ * 
+ * Event loops stop reading requests from a client that does not read its
+ * replies once this grows past their limit.
+ * 
+ * @param conn Connection handle
+ * @return Bytes queued
+ */
+size_t objm_server_pending(objm_connection_t *conn);
+
+/**
+ * Hold back owned reply FDs (shared-memory ring connections)
+ * 
+ * Replies still go into the ring at once; only the descriptors of
+ * objm_server_send_response_owned() wait, so a pass over a burst of
+ * requests passes all of them in one sendmsg. The library flushes early
+ * when the batch is full and before it waits on the peer. A no-op on
+ * socket connections.
+ * 
+ * @param conn Connection handle
+ */
+void objm_server_cork(objm_connection_t *conn);
+
+/**
+ * Stop holding back reply FDs and send the ones queued
+ * 
+ * @param conn Connection handle
+ * @return 0 on success, -1 on error
+ */
+int objm_server_uncork(objm_connection_t *conn);
+
+/**
+ * Send a multi-GET response
+ * 
+ * Headers for every item and the FDs of all OK items go out in a single
+ * sendmsg, so a batch costs one syscall and one wakeup on each side.
+ * Thread-safe like objm_server_send_response(). Item metadata and error
+ * messages are not transmitted.
+ * 
+ * @param conn Connection handle (V2)
+ * @param request_id Request ID
+ * @param items Per-URI results (fd >= 0 and status OK to pass an FD)
+ * @param count Number of items (at most OBJM_MAX_BATCH)
+ * @return 0 on success, -1 on error
+ */
+int objm_server_send_multi_response(objm_connection_t *conn, uint32_t request_id,
+                                    const objm_response_t *items, size_t count);
+                                    
+/**
+ * Send an OK response followed by a streamed body (COPY/SPLICE modes)
+ * 
+ * The header carries content_len OBJM_CONTENT_CHUNKED and the body size
+ * as OBJM_META_SIZE; the body follows as in objm_send_body(). Header and
+ * body are sent under the connection's send lock, so concurrent replies
+ * cannot interleave with the stream.
+ * 
+ * @param conn Connection handle
+ * @param request_id Request ID
+ * @param fd Object to stream (-1 for an empty body, e.g. a PUT ack)
+ * @param mode OBJM_MODE_COPY or OBJM_MODE_SPLICE
+ * @return 0 on success, -1 on error (the connection must be dropped)
+ */
+int objm_server_send_stream(objm_connection_t *conn, uint32_t request_id,
+                            int fd, char mode);
+
+/**
+ * Send an OK response followed by a streamed body in a given encoding
+ * 
+ * As objm_server_send_stream(), with OBJM_META_ENCODING in the header;
+ * OBJM_META_SIZE is the size of the encoded body. Only for connections
+ * that negotiated OBJM_CAP_COMPRESSION.
+ * 
+ * @param conn Connection handle
+ * @param request_id Request ID
+ * @param fd Encoded object to stream
+ * @param mode OBJM_MODE_COPY or OBJM_MODE_SPLICE
+ * @param encoding OBJM_ENCODING_*
+ * @return 0 on success, -1 on error (the connection must be dropped)
+ */
+int objm_server_send_stream_encoded(objm_connection_t *conn, uint32_t request_id,
+                                    int fd, char mode, uint8_t encoding);
+
+/**
+ * Send an OK response followed by a streamed body, with extra metadata
+ * 
+ * As objm_server_send_stream_encoded(); metadata (at most
+ * OBJM_MAX_METADATA - 16 bytes) follows OBJM_META_SIZE and
+ * OBJM_META_ENCODING in the header.
+ * 
+ * @param conn Connection handle
+ * @param request_id Request ID
+ * @param fd Object to stream
+ * @param mode OBJM_MODE_COPY or OBJM_MODE_SPLICE
+ * @param encoding OBJM_ENCODING_* (IDENTITY adds no OBJM_META_ENCODING)
+ * @param metadata Extra metadata entries (may be NULL)
+ * @param metadata_len Extra metadata length
+ * @return 0 on success, -1 on error (the connection must be dropped)
+ */
+int objm_server_send_stream_meta(objm_connection_t *conn, uint32_t request_id,
+                                 int fd, char mode, uint8_t encoding,
+                                 const uint8_t *metadata, size_t metadata_len);
+
+/**
+ * Send an OK response followed by a streamed body made of file extents
+ * 
+ * The extents are sent back to back as one body (a byte range, or an
+ * object stored in several files); OBJM_META_SIZE is their total length
+ * and metadata (at most OBJM_MAX_METADATA - 16 bytes) follows it.
+ * 
+ * @param conn Connection handle
+ * @param request_id Request ID
+ * @param extents Parts of the body, in order
+ * @param count Number of extents (0 for an empty body)
+ * @param mode OBJM_MODE_COPY or OBJM_MODE_SPLICE
+ * @param metadata Extra metadata entries (may be NULL)
+ * @param metadata_len Extra metadata length
+ * @return 0 on success, -1 on error (the connection must be dropped)
+ */
+int objm_server_send_stream_extents(objm_connection_t *conn, uint32_t request_id,
+                                    const objm_extent_t *extents, size_t count,
+                                    char mode, const uint8_t *metadata,
+                                    size_t metadata_len);
+                            
 /**
  * Send an error response
  * 
@@ -296,7 +713,7 @@ int objm_server_send_response(objm_connection_t *conn, const objm_response_t *re
  */
 int objm_server_send_error(objm_connection_t *conn, uint32_t request_id,
                            uint8_t status, const char *error_msg);
-
+                           
 /**
  * Send close acknowledgment
  * 
@@ -309,6 +726,8 @@ int objm_server_send_close_ack(objm_connection_t *conn, uint32_t outstanding);
 /**
  * Destroy server connection (frees resources, does NOT close socket)
  * 
+ * Every request received on the connection must have been freed first.
+ * 
  * @param conn Connection handle
  */
 void objm_server_destroy(objm_connection_t *conn);
@@ -316,7 +735,7 @@ void objm_server_destroy(objm_connection_t *conn);
 /* ============================================================================
  * Common Utilities
  * ============================================================================ */
-
+ 
 /**
  * Get negotiated connection parameters
  * 
@@ -343,6 +762,31 @@ int objm_has_capability(objm_connection_t *conn, uint16_t capability);
  */
 int objm_get_fd(objm_connection_t *conn);
 
+/**
+ * Get the shared-memory ring's doorbell (OBJM_CAP_SHM_RING)
+ * 
+ * On a ring connection requests do not make the socket readable. Event
+ * loops watch this eventfd as well (edge-triggered, it is never drained);
+ * it fires when the peer writes after objm_server_try_recv_request()
+ * returned OBJM_AGAIN. The socket itself then only reports hangup.
+ * 
+ * @param conn Connection handle
+ * @return Doorbell FD, or -1 if the connection has no ring
+ */
+int objm_get_doorbell_fd(objm_connection_t *conn);
+
+/**
+ * Get the shared-memory ring's space doorbell (OBJM_CAP_SHM_RING)
+ * 
+ * Fires (edge-triggered, it is never drained) when the client reads from
+ * a reply ring that objm_server_flush() left full. Event loops watch it
+ * alongside the doorbell and flush when it fires.
+ * 
+ * @param conn Connection handle
+ * @return Space doorbell FD, or -1 if the connection has no ring
+ */
+int objm_get_space_fd(objm_connection_t *conn);
+
 /**
  * Set connection callbacks (for async operation)
  * 
@@ -352,10 +796,13 @@ int objm_get_fd(objm_connection_t *conn);
  */
 void objm_set_callbacks(objm_connection_t *conn, const objm_callbacks_t *callbacks,
                         void *user_data);
-
+                        
 /**
  * Free request structure
  * 
+ * Requests from a server connection go back to its request pool; this may
+ * be called from any thread, but before objm_server_destroy().
+ * 
  * @param req Request to free
  */
 void objm_request_free(objm_request_t *req);
@@ -370,7 +817,7 @@ void objm_response_free(objm_response_t *resp);
 /* ============================================================================
  * Metadata Utilities
  * ============================================================================ */
-
+ 
 /**
  * Create metadata buffer
  * 
@@ -391,7 +838,7 @@ uint8_t *objm_metadata_create(size_t estimated_size);
  */
 size_t objm_metadata_add(uint8_t *metadata, size_t current_len,
                          uint8_t type, const void *data, size_t len);
-
+                         
 /**
  * Add size metadata
  */
@@ -407,6 +854,28 @@ size_t objm_metadata_add_mtime(uint8_t *metadata, size_t current_len, uint64_t m
  */
 size_t objm_metadata_add_backend(uint8_t *metadata, size_t current_len, uint8_t backend_id);
 
+/**
+ * Add body encoding metadata (OBJM_ENCODING_*)
+ */
+size_t objm_metadata_add_encoding(uint8_t *metadata, size_t current_len, uint8_t encoding);
+
+/**
+ * Add ETag metadata (NUL-terminated string)
+ */
+size_t objm_metadata_add_etag(uint8_t *metadata, size_t current_len, const char *etag);
+
+/**
+ * Add range metadata: the reply holds object bytes [offset, offset + length)
+ * of an object of size bytes
+ */
+size_t objm_metadata_add_range(uint8_t *metadata, size_t current_len,
+                               uint64_t offset, uint64_t length, uint64_t size);
+
+/**
+ * Add count metadata (objects a request affected)
+ */
+size_t objm_metadata_add_count(uint8_t *metadata, size_t current_len, uint64_t count);
+
 /**
  * Parse metadata buffer into entries
  * 
@@ -418,7 +887,7 @@ size_t objm_metadata_add_backend(uint8_t *metadata, size_t current_len, uint8_t
  */
 int objm_metadata_parse(const uint8_t *metadata, size_t metadata_len,
                         objm_metadata_entry_t **entries, size_t *num_entries);
-
+                        
 /**
  * Get metadata entry by type
  * 
@@ -429,7 +898,7 @@ int objm_metadata_parse(const uint8_t *metadata, size_t metadata_len,
  */
 const objm_metadata_entry_t *objm_metadata_get(const objm_metadata_entry_t *entries,
                                                 size_t num_entries, uint8_t type);
-
+                                                
 /**
  * Free metadata entries
  * 
@@ -441,7 +910,7 @@ void objm_metadata_free_entries(objm_metadata_entry_t *entries, size_t num_entri
 /* ============================================================================
  * Helper Functions
  * ============================================================================ */
-
+ 
 /**
  * Get status code name
  * 
@@ -458,6 +927,14 @@ const char *objm_status_name(uint8_t status);
  */
 const char *objm_mode_name(char mode);
 
+/**
+ * Get operation name
+ * 
+ * @param op Operation code
+ * @return Operation name string
+ */
+const char *objm_op_name(uint8_t op);
+
 /**
  * Get capability names
  * 
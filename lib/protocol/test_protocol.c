@@ -0,0 +1,716 @@
+/**
+ * @file test_protocol.c
+ * @brief Test suite for the wire protocol library
+ * 
+ * Both ends of a connection run in this process over a socketpair; the
+ * side that would block (usually the client) runs on its own thread.
+ */
+
+#define _GNU_SOURCE
+#include "protocol.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+/* A memfd holding len bytes of data */
+static int memfd_with(const void *data, size_t len) {
+    int fd = memfd_create("test_protocol", MFD_CLOEXEC);
+    assert(fd >= 0);
+    assert(write(fd, data, len) == (ssize_t)len);
+    return fd;
+}
+
+/* Whole contents of a file, NUL-terminated (caller frees) */
+static char *read_all(int fd, size_t *len_out) {
+    off_t size = lseek(fd, 0, SEEK_END);
+    assert(size >= 0);
+    char *buf = malloc(size + 1);
+    assert(buf != NULL);
+    assert(pread(fd, buf, size, 0) == size);
+    buf[size] = '\0';
+    if (len_out) *len_out = size;
+    return buf;
+}
+
+/* Wait for a descriptor to become ready (POLLIN or POLLOUT) */
+static void wait_for(int fd, short events) {
+    struct pollfd pfd = { .fd = fd, .events = events };
+    assert(poll(&pfd, 1, 5000) == 1);
+}
+
+typedef struct {
+    objm_connection_t *conn;
+    objm_hello_t hello;
+    objm_params_t params;
+    int ret;
+} hello_arg_t;
+
+static void *client_hello_thread(void *arg) {
+    hello_arg_t *h = arg;
+    h->ret = objm_client_hello(h->conn, &h->hello, &h->params);
+    return NULL;
+}
+
+/**
+ * Connect a V2 client and server over a socketpair
+ * 
+ * The server side is left non-blocking, as the epoll workers use it.
+ */
+static void connect_v2(const objm_hello_t *client_hello, const objm_hello_t *server_hello,
+                       objm_connection_t **client, objm_connection_t **server,
+                       objm_params_t *params) {
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    
+    *client = objm_client_create(sv[0], OBJM_PROTO_V2);
+    *server = objm_server_create(sv[1]);
+    assert(*client != NULL && *server != NULL);
+    assert(objm_server_set_nonblocking(*server) == 0);
+    
+    hello_arg_t h = { .conn = *client, .hello = *client_hello };
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, client_hello_thread, &h) == 0);
+    
+    int ret;
+    while ((ret = objm_server_try_handshake(*server, server_hello, NULL)) == OBJM_AGAIN) {
+        wait_for(sv[1], POLLIN);
+    }
+    assert(ret == 0);
+    
+    pthread_join(thread, NULL);
+    assert(h.ret == 0);
+    if (params) *params = h.params;
+}
+
+static void close_pair(objm_connection_t *client, objm_connection_t *server) {
+    int cfd = objm_get_fd(client), sfd = objm_get_fd(server);
+    objm_client_destroy(client);
+    objm_server_destroy(server);
+    close(cfd);
+    close(sfd);
+}
+
+static void test_handshake_resumes(void) {
+    printf("Testing non-blocking handshake...\n");
+    
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    objm_connection_t *server = objm_server_create(sv[1]);
+    assert(server != NULL);
+    assert(objm_server_set_nonblocking(server) == 0);
+    
+    objm_hello_t server_hello = { .capabilities = OBJM_CAP_OOO_REPLIES,
+                                  .max_pipeline = 64, .backend_parallelism = 2 };
+    
+    /* Nothing sent yet */
+    assert(objm_server_try_handshake(server, &server_hello, NULL) == OBJM_AGAIN);
+    
+    /* HELLO: magic(4) + version(1) + caps(2) + max_pipeline(2), one byte at a time */
+    uint8_t hello[9] = { 'O', 'B', 'J', 'M', OBJM_VERSION_2, 0, OBJM_CAP_OOO_REPLIES, 0, 8 };
+    objm_params_t params;
+    for (size_t i = 0; i < sizeof(hello); i++) {
+        assert(write(sv[0], &hello[i], 1) == 1);
+        int ret = objm_server_try_handshake(server, &server_hello, &params);
+        assert(ret == (i + 1 < sizeof(hello) ? OBJM_AGAIN : 0));
+    }
+    assert(params.version == OBJM_PROTO_V2);
+    assert(params.capabilities == OBJM_CAP_OOO_REPLIES);
+    assert(params.max_pipeline == 8);
+    
+    uint8_t ack[10];
+    assert(read(sv[0], ack, sizeof(ack)) == sizeof(ack));
+    assert(memcmp(ack, OBJM_MAGIC, OBJM_MAGIC_LEN) == 0);
+    assert(ack[9] == 2);
+    printf("  ✓ HELLO split across reads is assembled\n");
+    
+    objm_server_destroy(server);
+    close(sv[0]);
+    close(sv[1]);
+    printf("✓ Handshake test passed\n\n");
+}
+
+#define QUEUE_REPLIES 400
+#define QUEUE_BODY (256 * 1024)
+
+typedef struct {
+    objm_connection_t *conn;
+    int failures;
+} reader_arg_t;
+
+/* Client side of the reply queue test: every reply, in order */
+static void *reply_reader_thread(void *arg) {
+    reader_arg_t *r = arg;
+    
+    for (uint32_t id = 1; id <= QUEUE_REPLIES; id++) {
+        objm_response_t *resp;
+        if (objm_client_recv_response(r->conn, &resp) < 0 || resp->request_id != id) {
+            r->failures++;
+            return NULL;
+        }
+        
+        if (id % 50 == 0) {
+            /* FD reply */
+            char want[32];
+            snprintf(want, sizeof(want), "object %u", id);
+            char *got = resp->fd >= 0 ? read_all(resp->fd, NULL) : NULL;
+            if (!got || strcmp(got, want) != 0) r->failures++;
+            free(got);
+        } else if (id % 50 == 25) {
+            /* Streamed body */
+            int fd = memfd_create("body", MFD_CLOEXEC);
+            uint64_t len = 0;
+            if (resp->content_len != OBJM_CONTENT_CHUNKED ||
+                objm_recv_body(r->conn, fd, OBJM_MODE_COPY, &len) < 0 ||
+                len != QUEUE_BODY) {
+                r->failures++;
+            } else {
+                char *body = read_all(fd, NULL);
+                for (size_t i = 0; i < QUEUE_BODY; i++) {
+                    if (body[i] != (char)(i * 7 + id)) {
+                        r->failures++;
+                        break;
+                    }
+                }
+                free(body);
+            }
+            close(fd);
+        } else if (resp->status != OBJM_STATUS_NOT_FOUND) {
+            r->failures++;
+        }
+        objm_response_free(resp);
+    }
+    return NULL;
+}
+
+static void test_reply_queue(void) {
+    printf("Testing replies queued behind a full socket...\n");
+    
+    objm_hello_t hello = { .capabilities = 0, .max_pipeline = 1 };
+    objm_connection_t *client, *server;
+    connect_v2(&hello, &hello, &client, &server, NULL);
+    
+    int sock = objm_get_fd(server);
+    int small = 4096;
+    assert(setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &small, sizeof(small)) == 0);
+    
+    char *body = malloc(QUEUE_BODY);
+    assert(body != NULL);
+    
+    /* Nobody reads yet: every reply must return at once, queued */
+    alarm(10);  /* A reply waiting for the socket never returns */
+    for (uint32_t id = 1; id <= QUEUE_REPLIES; id++) {
+        if (id % 50 == 0) {
+            char data[32];
+            int len = snprintf(data, sizeof(data), "object %u", id);
+            objm_response_t resp = { .request_id = id, .status = OBJM_STATUS_OK,
+                                     .fd = memfd_with(data, len) };
+            assert(objm_server_send_response_owned(server, &resp) == 0);
+        } else if (id % 50 == 25) {
+            for (size_t i = 0; i < QUEUE_BODY; i++) body[i] = (char)(i * 7 + id);
+            int fd = memfd_with(body, QUEUE_BODY);
+            assert(objm_server_send_stream(server, id, fd, OBJM_MODE_COPY) == 0);
+            close(fd);  /* The queue streams from its own duplicate */
+        } else {
+            assert(objm_server_send_error(server, id, OBJM_STATUS_NOT_FOUND, "not here") == 0);
+        }
+    }
+    alarm(0);
+    free(body);
+    
+    assert(objm_server_pending(server) > QUEUE_BODY);
+    assert(objm_server_flush(server) == OBJM_AGAIN);
+    printf("  ✓ Replies queue instead of blocking (%zu bytes pending)\n",
+           objm_server_pending(server));
+    
+    /* Drain as an event loop would: flush whenever the socket has room */
+    reader_arg_t r = { .conn = client };
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, reply_reader_thread, &r) == 0);
+    
+    int ret;
+    while ((ret = objm_server_flush(server)) == OBJM_AGAIN) {
+        wait_for(sock, POLLOUT);
+    }
+    assert(ret == 0);
+    assert(objm_server_pending(server) == 0);
+    
+    pthread_join(thread, NULL);
+    assert(r.failures == 0);
+    printf("  ✓ Queued replies, FDs and bodies arrive intact and in order\n");
+    
+    close_pair(client, server);
+    printf("✓ Reply queue test passed\n\n");
+}
+
+#define OOO_REQUESTS 64
+#define OOO_SENDERS 4
+
+typedef struct {
+    objm_connection_t *conn;
+    int sender;
+} sender_arg_t;
+
+/* One of several threads answering its share of the requests, last first */
+static void *ooo_sender_thread(void *arg) {
+    sender_arg_t *s = arg;
+    
+    for (uint32_t id = OOO_REQUESTS; id >= 1; id--) {
+        if (id % OOO_SENDERS != (uint32_t)s->sender) continue;
+        
+        if (id % 2 == 0) {
+            char data[32];
+            int len = snprintf(data, sizeof(data), "object %u", id);
+            objm_response_t resp = { .request_id = id, .status = OBJM_STATUS_OK,
+                                     .fd = memfd_with(data, len) };
+            assert(objm_server_send_response_owned(s->conn, &resp) == 0);
+        } else {
+            assert(objm_server_send_error(s->conn, id, OBJM_STATUS_NOT_FOUND, "not here") == 0);
+        }
+    }
+    return NULL;
+}
+
+static void test_ooo_replies(void) {
+    printf("Testing pipelined requests with out-of-order replies...\n");
+    
+    objm_hello_t client_hello = { .capabilities = OBJM_CAP_OOO_REPLIES | OBJM_CAP_PIPELINING,
+                                  .max_pipeline = 128 };
+    objm_hello_t server_hello = { .capabilities = OBJM_CAP_OOO_REPLIES | OBJM_CAP_PIPELINING,
+                                  .max_pipeline = 128, .backend_parallelism = 1 };
+    objm_connection_t *client, *server;
+    objm_params_t params;
+    connect_v2(&client_hello, &server_hello, &client, &server, &params);
+    assert(params.capabilities & OBJM_CAP_OOO_REPLIES);
+    assert(params.capabilities & OBJM_CAP_PIPELINING);
+    assert(params.max_pipeline == 128);
+    
+    /* The whole pipeline in one burst */
+    objm_request_t reqs[OOO_REQUESTS];
+    char uris[OOO_REQUESTS][32];
+    for (int i = 0; i < OOO_REQUESTS; i++) {
+        snprintf(uris[i], sizeof(uris[i]), "/ooo/%d", i + 1);
+        reqs[i] = (objm_request_t){ .id = i + 1, .op = OBJM_OP_GET, .mode = OBJM_MODE_FDPASS,
+                                    .flags = i == 10 ? OBJM_REQ_ORDERED : 0,
+                                    .uri = uris[i], .uri_len = strlen(uris[i]) };
+    }
+    assert(objm_client_send_requests(client, reqs, OOO_REQUESTS) == 0);
+    
+    for (int i = 0; i < OOO_REQUESTS; i++) {
+        objm_request_t *req;
+        int ret;
+        while ((ret = objm_server_try_recv_request(server, &req)) == OBJM_AGAIN) {
+            wait_for(objm_get_fd(server), POLLIN);
+        }
+        assert(ret == 0);
+        assert(req->id == (uint32_t)i + 1 && req->op == OBJM_OP_GET);
+        assert(req->flags == (i == 10 ? OBJM_REQ_ORDERED : 0));
+        assert(strcmp(req->uri, uris[i]) == 0);
+        objm_request_free(req);
+    }
+    printf("  ✓ Pipelined requests parsed in order\n");
+    
+    /* Replies from several threads at once, none in request order */
+    pthread_t threads[OOO_SENDERS];
+    sender_arg_t args[OOO_SENDERS];
+    for (int t = 0; t < OOO_SENDERS; t++) {
+        args[t] = (sender_arg_t){ .conn = server, .sender = t };
+        assert(pthread_create(&threads[t], NULL, ooo_sender_thread, &args[t]) == 0);
+    }
+    for (int t = 0; t < OOO_SENDERS; t++) pthread_join(threads[t], NULL);
+    assert(objm_server_flush(server) == 0);
+    
+    /* Every reply found by ID, the others parked meanwhile */
+    for (uint32_t id = 1; id <= OOO_REQUESTS; id++) {
+        objm_response_t *resp;
+        assert(objm_client_recv_response_for(client, id, &resp) == 0);
+        assert(resp->request_id == id);
+        if (id % 2 == 0) {
+            char want[32];
+            snprintf(want, sizeof(want), "object %u", id);
+            assert(resp->status == OBJM_STATUS_OK && resp->fd >= 0);
+            char *got = read_all(resp->fd, NULL);
+            assert(strcmp(got, want) == 0);
+            free(got);
+        } else {
+            assert(resp->status == OBJM_STATUS_NOT_FOUND);
+        }
+        objm_response_free(resp);
+    }
+    printf("  ✓ Concurrent replies stay whole and match by request ID\n");
+    
+    /* CLOSE is shorter than a request header */
+    uint8_t close_msg[2] = { OBJM_MSG_CLOSE, OBJM_CLOSE_NORMAL };
+    assert(write(objm_get_fd(client), close_msg, sizeof(close_msg)) == 2);
+    objm_request_t *req;
+    int ret;
+    while ((ret = objm_server_try_recv_request(server, &req)) == OBJM_AGAIN) {
+        wait_for(objm_get_fd(server), POLLIN);
+    }
+    assert(ret == 1);
+    printf("  ✓ CLOSE ends the request stream\n");
+    
+    close_pair(client, server);
+    printf("✓ Out-of-order reply test passed\n\n");
+}
+
+static void test_multi_get(void) {
+    printf("Testing multi-GET...\n");
+    
+    objm_hello_t hello = { .capabilities = OBJM_CAP_BATCH, .max_pipeline = 1 };
+    objm_connection_t *client, *server;
+    objm_params_t params;
+    connect_v2(&hello, &hello, &client, &server, &params);
+    assert(params.capabilities & OBJM_CAP_BATCH);
+    
+    /* A full batch with long URIs outgrows the receive buffer */
+    static char uri_buf[OBJM_MAX_BATCH][128];
+    const char *uris[OBJM_MAX_BATCH];
+    for (int i = 0; i < OBJM_MAX_BATCH; i++) {
+        snprintf(uri_buf[i], sizeof(uri_buf[i]), "/multi/%0100d", i);
+        uris[i] = uri_buf[i];
+    }
+    assert(objm_client_send_multi_get(client, 7, 0, OBJM_MODE_FDPASS,
+                                      uris, OBJM_MAX_BATCH) == 0);
+    
+    objm_request_t *req;
+    int ret;
+    while ((ret = objm_server_try_recv_request(server, &req)) == OBJM_AGAIN) {
+        wait_for(objm_get_fd(server), POLLIN);
+    }
+    assert(ret == 0);
+    assert(req->id == 7 && req->num_uris == OBJM_MAX_BATCH);
+    for (int i = 0; i < OBJM_MAX_BATCH; i++) assert(strcmp(req->uris[i], uris[i]) == 0);
+    objm_request_free(req);
+    printf("  ✓ A batch larger than the receive buffer parsed as one request\n");
+    
+    /* Every third object missing; the others pass their FD */
+    objm_response_t items[OBJM_MAX_BATCH];
+    for (int i = 0; i < OBJM_MAX_BATCH; i++) {
+        items[i] = (objm_response_t){ .status = OBJM_STATUS_NOT_FOUND, .fd = -1 };
+        if (i % 3 == 0) continue;
+        char data[32];
+        int len = snprintf(data, sizeof(data), "object %d", i);
+        items[i].status = OBJM_STATUS_OK;
+        items[i].fd = memfd_with(data, len);
+    }
+    assert(objm_server_send_multi_response(server, 7, items, OBJM_MAX_BATCH) == 0);
+    for (int i = 0; i < OBJM_MAX_BATCH; i++) {
+        if (items[i].fd >= 0) close(items[i].fd);
+    }
+    
+    objm_response_t *resp;
+    assert(objm_client_recv_response(client, &resp) == 0);
+    assert(resp->request_id == 7 && resp->num_items == OBJM_MAX_BATCH);
+    for (int i = 0; i < OBJM_MAX_BATCH; i++) {
+        objm_response_t *item = &resp->items[i];
+        if (i % 3 == 0) {
+            assert(item->status == OBJM_STATUS_NOT_FOUND && item->fd < 0);
+            continue;
+        }
+        char want[32];
+        snprintf(want, sizeof(want), "object %d", i);
+        assert(item->status == OBJM_STATUS_OK && item->fd >= 0);
+        char *got = read_all(item->fd, NULL);
+        assert(strcmp(got, want) == 0);
+        free(got);
+    }
+    objm_response_free(resp);
+    printf("  ✓ Results and FDs arrive in request order\n");
+    close_pair(client, server);
+    
+    /* Not negotiated: a protocol error, not a misparsed request */
+    hello.capabilities = 0;
+    connect_v2(&hello, &hello, &client, &server, NULL);
+    assert(objm_client_send_multi_get(client, 1, 0, OBJM_MODE_FDPASS, uris, 2) == 0);
+    while ((ret = objm_server_try_recv_request(server, &req)) == OBJM_AGAIN) {
+        wait_for(objm_get_fd(server), POLLIN);
+    }
+    assert(ret == -1);
+    printf("  ✓ Multi-GET without OBJM_CAP_BATCH is refused\n");
+    
+    close_pair(client, server);
+    printf("✓ Multi-GET test passed\n\n");
+}
+
+#define BODY_SIZE (4 * 1024 * 1024 + 123)
+
+typedef struct {
+    objm_connection_t *conn;
+    char mode;
+    int body_fd;
+    int ret;
+} put_arg_t;
+
+/* Client side: a streamed PUT, then a request right behind its body */
+static void *put_sender_thread(void *arg) {
+    put_arg_t *p = arg;
+    
+    objm_request_t reqs[2] = {
+        { .id = 1, .op = OBJM_OP_PUT, .flags = OBJM_REQ_BODY, .mode = p->mode,
+          .uri = "/put/big", .uri_len = 8 },
+        { .id = 2, .op = OBJM_OP_STAT, .mode = p->mode, .uri = "/put/next", .uri_len = 9 },
+    };
+    uint64_t sent = 0;
+    p->ret = -1;
+    if (objm_client_send_request(p->conn, &reqs[0]) < 0) return NULL;
+    if (objm_send_body(p->conn, p->body_fd, p->mode, &sent) < 0 || sent != BODY_SIZE) return NULL;
+    if (objm_client_send_request(p->conn, &reqs[1]) < 0) return NULL;
+    p->ret = 0;
+    return NULL;
+}
+
+static void test_streamed_put(void) {
+    printf("Testing streamed PUT bodies on a non-blocking connection...\n");
+    
+    char *body = malloc(BODY_SIZE);
+    assert(body != NULL);
+    for (size_t i = 0; i < BODY_SIZE; i++) body[i] = (char)(i * 31 + (i >> 12));
+    int src = memfd_with(body, BODY_SIZE);
+    
+    const char modes[] = { OBJM_MODE_COPY, OBJM_MODE_SPLICE };
+    for (size_t m = 0; m < sizeof(modes); m++) {
+        objm_hello_t hello = { .capabilities = 0, .max_pipeline = 1 };
+        objm_connection_t *client, *server;
+        connect_v2(&hello, &hello, &client, &server, NULL);
+        int sock = objm_get_fd(server);
+        int small = 4096;
+        assert(setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small)) == 0);
+        
+        put_arg_t p = { .conn = client, .mode = modes[m], .body_fd = src };
+        pthread_t thread;
+        assert(pthread_create(&thread, NULL, put_sender_thread, &p) == 0);
+        
+        objm_request_t *req;
+        int ret;
+        while ((ret = objm_server_try_recv_request(server, &req)) == OBJM_AGAIN) {
+            wait_for(sock, POLLIN);
+        }
+        assert(ret == 0);
+        assert(req->id == 1 && (req->flags & OBJM_REQ_BODY));
+        objm_request_free(req);
+        
+        /* The body lands piece by piece; each call returns when the
+         * socket runs dry instead of waiting for the rest */
+        int dst = memfd_create("put", MFD_CLOEXEC);
+        uint64_t received = 0;
+        int waits = 0;
+        while ((ret = objm_server_try_recv_body(server, dst, modes[m], &received)) == OBJM_AGAIN) {
+            waits++;
+            wait_for(sock, POLLIN);
+        }
+        assert(ret == 0);
+        assert(waits > 0);
+        assert(received == BODY_SIZE);
+        
+        size_t len;
+        char *got = read_all(dst, &len);
+        assert(len == BODY_SIZE && memcmp(got, body, BODY_SIZE) == 0);
+        free(got);
+        close(dst);
+        
+        /* Parsing picks up right after the body */
+        while ((ret = objm_server_try_recv_request(server, &req)) == OBJM_AGAIN) {
+            wait_for(sock, POLLIN);
+        }
+        assert(ret == 0);
+        assert(req->id == 2 && strcmp(req->uri, "/put/next") == 0);
+        objm_request_free(req);
+        
+        pthread_join(thread, NULL);
+        assert(p.ret == 0);
+        printf("  ✓ %s body received in pieces, then the next request\n",
+               objm_mode_name(modes[m]));
+        
+        close_pair(client, server);
+    }
+    
+    close(src);
+    free(body);
+    printf("✓ Streamed PUT test passed\n\n");
+}
+
+/* Receive one request, waiting for the socket as an event loop would */
+static objm_request_t *next_request(objm_connection_t *server) {
+    objm_request_t *req;
+    int ret;
+    while ((ret = objm_server_try_recv_request(server, &req)) == OBJM_AGAIN) {
+        wait_for(objm_get_fd(server), POLLIN);
+    }
+    assert(ret == 0);
+    return req;
+}
+
+#define POOL_REQUESTS 64
+
+typedef struct {
+    objm_request_t **reqs;
+    size_t count;
+} free_arg_t;
+
+static void *free_requests_thread(void *arg) {
+    free_arg_t *f = arg;
+    for (size_t i = f->count; i-- > 0;) objm_request_free(f->reqs[i]);
+    return NULL;
+}
+
+static void test_buffered_requests(void) {
+    printf("Testing buffered request parsing...\n");
+    
+    objm_hello_t hello = { .capabilities = 0, .max_pipeline = 1 };
+    objm_connection_t *client, *server;
+    connect_v2(&hello, &hello, &client, &server, NULL);
+    int cfd = objm_get_fd(client), sfd = objm_get_fd(server);
+    
+    /* Plain, conditional and ranged requests, captured off the wire */
+    uint8_t cond[64];
+    size_t cond_len = objm_metadata_add_etag(cond, 0, "\"v1\"");
+    objm_request_t reqs[3] = {
+        { .id = 1, .op = OBJM_OP_GET, .mode = OBJM_MODE_FDPASS,
+          .uri = "/buf/a", .uri_len = 6 },
+        { .id = 2, .op = OBJM_OP_GET, .mode = OBJM_MODE_FDPASS, .flags = OBJM_REQ_CONDITIONAL,
+          .uri = "/buf/b", .uri_len = 6, .conditions = cond, .conditions_len = cond_len },
+        { .id = 3, .op = OBJM_OP_GET, .mode = OBJM_MODE_COPY, .flags = OBJM_REQ_RANGE,
+          .uri = "/buf/c", .uri_len = 6, .range_offset = 4096, .range_length = 100 },
+    };
+    assert(objm_client_send_requests(client, reqs, 3) == 0);
+    
+    uint8_t wire[256];
+    ssize_t wire_len = read(sfd, wire, sizeof(wire));
+    assert(wire_len > 0);
+    
+    /* Fed back one byte at a time, each request completes on its last byte */
+    objm_request_t *got[3];
+    size_t parsed = 0;
+    for (ssize_t i = 0; i < wire_len; i++) {
+        assert(write(cfd, &wire[i], 1) == 1);
+        int ret = objm_server_try_recv_request(server, &got[parsed]);
+        assert(ret == 0 || ret == OBJM_AGAIN);
+        if (ret == 0) parsed++;
+    }
+    assert(parsed == 3);
+    assert(objm_server_try_recv_request(server, &got[0]) == OBJM_AGAIN);
+    
+    assert(got[0]->id == 1 && strcmp(got[0]->uri, "/buf/a") == 0);
+    assert(got[1]->id == 2 && (got[1]->flags & OBJM_REQ_CONDITIONAL));
+    assert(got[1]->conditions_len == cond_len &&
+           memcmp(got[1]->conditions, cond, cond_len) == 0);
+    assert(got[2]->id == 3 && got[2]->mode == OBJM_MODE_COPY);
+    assert(got[2]->range_offset == 4096 && got[2]->range_length == 100);
+    for (int i = 0; i < 3; i++) objm_request_free(got[i]);
+    printf("  ✓ Requests split at every byte are reassembled\n");
+    
+    /* Requests freed by another thread go back to the connection's pool */
+    objm_request_t *first[POOL_REQUESTS], *second[POOL_REQUESTS];
+    objm_request_t burst[POOL_REQUESTS];
+    char uris[POOL_REQUESTS][32];
+    for (int round = 0; round < 2; round++) {
+        objm_request_t **held = round == 0 ? first : second;
+        for (int i = 0; i < POOL_REQUESTS; i++) {
+            snprintf(uris[i], sizeof(uris[i]), "/pool/%d/%d", round, i);
+            burst[i] = (objm_request_t){ .id = i, .op = OBJM_OP_GET, .mode = OBJM_MODE_FDPASS,
+                                         .uri = uris[i], .uri_len = strlen(uris[i]) };
+        }
+        assert(objm_client_send_requests(client, burst, POOL_REQUESTS) == 0);
+        for (int i = 0; i < POOL_REQUESTS; i++) {
+            held[i] = next_request(server);
+            assert(strcmp(held[i]->uri, uris[i]) == 0);
+        }
+        if (round == 1) break;
+        
+        free_arg_t f = { .reqs = first, .count = POOL_REQUESTS };
+        pthread_t thread;
+        assert(pthread_create(&thread, NULL, free_requests_thread, &f) == 0);
+        pthread_join(thread, NULL);
+    }
+    for (int i = 0; i < POOL_REQUESTS; i++) {
+        bool reused = false;
+        for (int j = 0; j < POOL_REQUESTS && !reused; j++) reused = second[i] == first[j];
+        assert(reused);
+        objm_request_free(second[i]);
+    }
+    printf("  ✓ Freed requests are reused, whichever thread freed them\n");
+    
+    close_pair(client, server);
+    printf("✓ Buffered request test passed\n\n");
+}
+
+static void test_inline_fd(void) {
+    printf("Testing single-sendmsg FD replies...\n");
+    
+    /* The library offers OBJM_CAP_INLINE_FD on both ends by itself */
+    objm_hello_t hello = { .capabilities = 0, .max_pipeline = 1 };
+    objm_connection_t *client, *server;
+    objm_params_t params;
+    connect_v2(&hello, &hello, &client, &server, &params);
+    assert(params.capabilities & OBJM_CAP_INLINE_FD);
+    
+    uint8_t meta[32];
+    size_t meta_len = objm_metadata_add_size(meta, 0, 5);
+    objm_response_t resp = { .request_id = 9, .status = OBJM_STATUS_OK,
+                             .fd = memfd_with("hello", 5),
+                             .metadata = meta, .metadata_len = meta_len };
+    assert(objm_server_send_response_owned(server, &resp) == 0);
+    
+    /* Header, metadata, carrier byte and descriptor: one message */
+    uint8_t buf[128];
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1,
+                          .msg_control = control, .msg_controllen = sizeof(control) };
+    ssize_t n = recvmsg(objm_get_fd(client), &msg, 0);
+    assert(n == (ssize_t)(16 + meta_len + 1));
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    assert(cmsg && cmsg->cmsg_type == SCM_RIGHTS);
+    int fd;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(fd));
+    char *got = read_all(fd, NULL);
+    assert(strcmp(got, "hello") == 0);
+    free(got);
+    close(fd);
+    printf("  ✓ FD reply arrives with its header in one message\n");
+    close_pair(client, server);
+    
+    /* A client that does not know the bit keeps the old framing */
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    server = objm_server_create(sv[1]);
+    assert(server != NULL);
+    assert(objm_server_set_nonblocking(server) == 0);
+    uint8_t old_hello[9] = { 'O', 'B', 'J', 'M', OBJM_VERSION_2, 0, 0, 0, 1 };
+    assert(write(sv[0], old_hello, sizeof(old_hello)) == sizeof(old_hello));
+    int ret;
+    while ((ret = objm_server_try_handshake(server, &hello, &params)) == OBJM_AGAIN) {
+        wait_for(sv[1], POLLIN);
+    }
+    assert(ret == 0);
+    assert(!(params.capabilities & OBJM_CAP_INLINE_FD));
+    printf("  ✓ Not granted to clients that did not ask for it\n");
+    
+    objm_server_destroy(server);
+    close(sv[0]);
+    close(sv[1]);
+    printf("✓ Inline FD test passed\n\n");
+}
+
+int main(void) {
+    printf("=== objmapper Protocol Tests ===\n\n");
+    
+    test_handshake_resumes();
+    test_reply_queue();
+    test_ooo_replies();
+    test_multi_get();
+    test_streamed_put();
+    test_buffered_requests();
+    test_inline_fd();
+    
+    printf("=== All tests passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,434 @@
+/**
+ * @file shmring.c
+ * @brief Shared-memory request/response ring implementation
+ *
+ * Layout of the memfd: a control page, then the request ring, then the
+ * reply ring. Each ring has a producer index (bytes published) and a
+ * consumer index (bytes released) on their own cache lines; both only
+ * grow, and positions are taken modulo the power-of-two size, so a peer
+ * scribbling over the indexes can garble messages but never make either
+ * side touch memory outside the mapping.
+ *
+ * Doorbells: a side about to sleep sets a WANT bit in its own flag word
+ * and rechecks the ring; the other side publishes, then checks the flag
+ * and writes the eventfd only if the bit was set. A full fence on both
+ * sides between the store and the load means one of them always sees the
+ * other, so no wakeup is lost and a busy ring costs no syscalls.
+ */
+
+#define _GNU_SOURCE
+#include "shmring.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SHMRING_MAGIC   0x4742524fu     /* "ORBG" */
+#define SHMRING_VERSION 1
+#define SHMRING_MAX_SIZE (1ULL << 30)
+
+/* Adaptive spinning: pause iterations before sleeping */
+#define SPIN_MIN   16
+#define SPIN_INIT  256
+#define SPIN_MAX   4096
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define cpu_relax() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define cpu_relax() atomic_signal_fence(memory_order_seq_cst)
+#endif
+
+enum { DIR_REQUEST = 0, DIR_REPLY = 1 };    /* Ring directions */
+enum { SIDE_SERVER = 0, SIDE_CLIENT = 1 };  /* Doorbell owners */
+enum { SPIN_RECV = 0, SPIN_SEND = 1 };
+
+#define WANT_DATA  0x1u                     /* Sleeping until its ring fills */
+#define WANT_SPACE 0x2u                     /* Sleeping until its ring drains */
+
+/* One doorbell per WANT bit: a side's reader and writer may be different
+ * threads, and one draining the other's wakeup would strand it */
+enum { BELL_DATA = 0, BELL_SPACE = 1 };
+#define BELL_FOR(want) ((want) == WANT_DATA ? BELL_DATA : BELL_SPACE)
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t head;     /* Bytes published (producer) */
+    _Alignas(64) _Atomic uint64_t tail;     /* Bytes released (consumer) */
+} ring_index_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;                          /* Bytes per direction */
+    struct {
+        _Alignas(64) _Atomic uint32_t want;  /* WANT_* bits of a sleeping side */
+    } waiting[2];
+    ring_index_t dir[2];
+} ring_shared_t;
+
+struct shmring {
+    ring_shared_t *shared;
+    size_t map_len;
+    uint8_t *data[2];                       /* Ring bytes by direction */
+    uint64_t size;
+    uint64_t mask;
+    int side;                               /* SIDE_SERVER or SIDE_CLIENT */
+    int rx, tx;                             /* Directions this side reads/writes */
+    int memfd;                              /* Server only (-1 once attached) */
+    int bell[2][2];                         /* Doorbells by side and BELL_* */
+    unsigned spin[2];                       /* Spin budgets: SPIN_RECV, SPIN_SEND */
+};
+
+static size_t data_offset(void) {
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) page = 4096;
+    return (sizeof(ring_shared_t) + page - 1) & ~((size_t)page - 1);
+}
+
+static void ring_setup(shmring_t *ring, int side) {
+    size_t off = data_offset();
+    ring->mask = ring->size - 1;
+    ring->data[DIR_REQUEST] = (uint8_t *)ring->shared + off;
+    ring->data[DIR_REPLY] = (uint8_t *)ring->shared + off + ring->size;
+    ring->side = side;
+    ring->rx = (side == SIDE_SERVER) ? DIR_REQUEST : DIR_REPLY;
+    ring->tx = (side == SIDE_SERVER) ? DIR_REPLY : DIR_REQUEST;
+    /* With one CPU the peer cannot make progress while we spin */
+    unsigned budget = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SPIN_INIT : 0;
+    ring->spin[SPIN_RECV] = budget;
+    ring->spin[SPIN_SEND] = budget;
+}
+
+shmring_t *shmring_create(size_t size) {
+    uint64_t ring_size = SHMRING_MIN_SIZE;
+    while (ring_size < size && ring_size < SHMRING_MAX_SIZE) ring_size <<= 1;
+
+    shmring_t *ring = calloc(1, sizeof(*ring));
+    if (!ring) return NULL;
+    ring->memfd = -1;
+    memset(ring->bell, -1, sizeof(ring->bell));
+    ring->size = ring_size;
+    ring->map_len = data_offset() + 2 * ring_size;
+
+    ring->memfd = memfd_create("objmapper-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (ring->memfd < 0 || ftruncate(ring->memfd, ring->map_len) < 0 ||
+        fcntl(ring->memfd, F_ADD_SEALS,
+              F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+        goto fail;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        int *bell = &ring->bell[i / 2][i % 2];
+        *bell = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (*bell < 0) goto fail;
+    }
+
+    void *map = mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     ring->memfd, 0);
+    if (map == MAP_FAILED) goto fail;
+    ring->shared = map;
+
+    /* A fresh memfd reads as zeros: indexes and flags start cleared */
+    ring->shared->magic = SHMRING_MAGIC;
+    ring->shared->version = SHMRING_VERSION;
+    ring->shared->size = ring_size;
+    ring_setup(ring, SIDE_SERVER);
+    return ring;
+
+fail:
+    {
+        int saved = errno;
+        shmring_destroy(ring);
+        errno = saved;
+    }
+    return NULL;
+}
+
+int shmring_get_fds(const shmring_t *ring, int fds[SHMRING_NUM_FDS]) {
+    if (!ring || !fds || ring->memfd < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    fds[0] = ring->memfd;
+    for (int i = 0; i < 4; i++) fds[1 + i] = ring->bell[i / 2][i % 2];
+    return 0;
+}
+
+shmring_t *shmring_attach(const int fds[SHMRING_NUM_FDS]) {
+    shmring_t *ring = calloc(1, sizeof(*ring));
+    if (!ring) {
+        for (int i = 0; i < SHMRING_NUM_FDS; i++) close(fds[i]);
+        return NULL;
+    }
+    ring->memfd = -1;
+    for (int i = 0; i < 4; i++) ring->bell[i / 2][i % 2] = fds[1 + i];
+
+    /* Nothing the server wrote is trusted before it is checked against
+     * the size of the file actually received */
+    struct stat st;
+    size_t off = data_offset();
+    if (fstat(fds[0], &st) < 0 || (size_t)st.st_size <= off) {
+        close(fds[0]);
+        errno = EPROTO;
+        goto fail;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    close(fds[0]);
+    if (map == MAP_FAILED) goto fail;
+    ring->shared = map;
+    ring->map_len = st.st_size;
+
+    uint64_t size = ring->shared->size;
+    if (ring->shared->magic != SHMRING_MAGIC ||
+        ring->shared->version != SHMRING_VERSION ||
+        size < SHMRING_MIN_SIZE || size > SHMRING_MAX_SIZE ||
+        (size & (size - 1)) != 0 || off + 2 * size != ring->map_len) {
+        errno = EPROTO;
+        goto fail;
+    }
+    ring->size = size;
+    ring_setup(ring, SIDE_CLIENT);
+    return ring;
+
+fail:
+    {
+        int saved = errno;
+        shmring_destroy(ring);
+        errno = saved;
+    }
+    return NULL;
+}
+
+void shmring_destroy(shmring_t *ring) {
+    if (!ring) return;
+    if (ring->shared) munmap(ring->shared, ring->map_len);
+    if (ring->memfd >= 0) close(ring->memfd);
+    for (int i = 0; i < 4; i++) {
+        if (ring->bell[i / 2][i % 2] >= 0) close(ring->bell[i / 2][i % 2]);
+    }
+    free(ring);
+}
+
+int shmring_doorbell_fd(const shmring_t *ring) {
+    return ring ? ring->bell[ring->side][BELL_DATA] : -1;
+}
+
+int shmring_space_fd(const shmring_t *ring) {
+    return ring ? ring->bell[ring->side][BELL_SPACE] : -1;
+}
+
+/* ============================================================================
+ * Doorbells
+ * ============================================================================ */
+
+/**
+ * Wake the peer if it sleeps on what this side just did
+ */
+static void ring_notify(shmring_t *ring, uint32_t want) {
+    int peer = !ring->side;
+    _Atomic uint32_t *flag = &ring->shared->waiting[peer].want;
+
+    /* Pairs with the fence in ring_sleep(): publish before looking */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!(atomic_load_explicit(flag, memory_order_relaxed) & want)) return;
+
+    if (atomic_fetch_and(flag, ~want) & want) {
+        uint64_t one = 1;
+        ssize_t n;
+        do {
+            n = write(ring->bell[peer][BELL_FOR(want)], &one, sizeof(one));
+        } while (n < 0 && errno == EINTR);
+    }
+}
+
+/* Bytes waiting in the incoming ring (corrupt indexes read as ready) */
+static bool ring_readable(const shmring_t *ring) {
+    const ring_index_t *ix = &ring->shared->dir[ring->rx];
+    return atomic_load_explicit(&ix->head, memory_order_acquire) !=
+           atomic_load_explicit(&ix->tail, memory_order_relaxed);
+}
+
+/* Room in the outgoing ring (corrupt indexes read as ready) */
+static bool ring_writable(const shmring_t *ring) {
+    const ring_index_t *ix = &ring->shared->dir[ring->tx];
+    uint64_t used = atomic_load_explicit(&ix->head, memory_order_relaxed) -
+                    atomic_load_explicit(&ix->tail, memory_order_acquire);
+    return used != ring->size;
+}
+
+/**
+ * Spin until ready() holds or the budget runs out
+ *
+ * A spin that pays off doubles the budget, one that does not halves it:
+ * a connection in a request/reply loop ends up polling, an idle one goes
+ * to sleep almost at once.
+ */
+static bool ring_spin(shmring_t *ring, int which, bool (*ready)(const shmring_t *)) {
+    unsigned budget = ring->spin[which];
+    if (budget == 0) return false;  /* Single CPU: never spin */
+
+    for (unsigned i = 0; i < budget; i++) {
+        cpu_relax();
+        if (ready(ring)) {
+            ring->spin[which] = budget * 2 < SPIN_MAX ? budget * 2 : SPIN_MAX;
+            return true;
+        }
+    }
+
+    ring->spin[which] = budget / 2 > SPIN_MIN ? budget / 2 : SPIN_MIN;
+    return false;
+}
+
+/**
+ * Sleep on the doorbell until ready() holds
+ */
+static int ring_sleep(shmring_t *ring, uint32_t want,
+                      bool (*ready)(const shmring_t *), int sock) {
+    _Atomic uint32_t *flag = &ring->shared->waiting[ring->side].want;
+    int bell = ring->bell[ring->side][BELL_FOR(want)];
+
+    for (;;) {
+        atomic_fetch_or(flag, want);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (ready(ring)) break;
+
+        struct pollfd pfd[2] = {
+            { .fd = bell, .events = POLLIN },
+            { .fd = sock, .events = 0 },   /* Hangup and errors only */
+        };
+        if (poll(pfd, sock >= 0 ? 2 : 1, -1) < 0 && errno != EINTR) {
+            atomic_fetch_and(flag, ~want);
+            return -1;
+        }
+
+        if (pfd[0].revents & POLLIN) {
+            uint64_t count;
+            ssize_t n = read(bell, &count, sizeof(count));
+            (void)n;  /* Drained; a stale count only means one spurious wakeup */
+        }
+        if (ready(ring)) break;
+
+        if (sock >= 0 && (pfd[1].revents & (POLLHUP | POLLERR | POLLNVAL))) {
+            atomic_fetch_and(flag, ~want);
+            errno = ECONNRESET;
+            return -1;
+        }
+    }
+
+    atomic_fetch_and(flag, ~want);
+    return 0;
+}
+
+/* ============================================================================
+ * Data
+ * ============================================================================ */
+
+ssize_t shmring_writev(shmring_t *ring, const struct iovec *iov, int iovcnt) {
+    ring_index_t *ix = &ring->shared->dir[ring->tx];
+    uint64_t head = atomic_load_explicit(&ix->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&ix->tail, memory_order_acquire);
+    uint64_t used = head - tail;
+
+    if (used > ring->size) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    uint8_t *data = ring->data[ring->tx];
+    size_t room = ring->size - used;
+    size_t done = 0;
+
+    for (int i = 0; i < iovcnt && done < room; i++) {
+        size_t len = iov[i].iov_len < room - done ? iov[i].iov_len : room - done;
+        const uint8_t *src = iov[i].iov_base;
+        uint64_t pos = (head + done) & ring->mask;
+        size_t first = len < ring->size - pos ? len : ring->size - pos;
+
+        memcpy(data + pos, src, first);
+        memcpy(data, src + first, len - first);
+        done += len;
+    }
+
+    if (done > 0) {
+        atomic_store_explicit(&ix->head, head + done, memory_order_release);
+        ring_notify(ring, WANT_DATA);
+    }
+    return done;
+}
+
+ssize_t shmring_read(shmring_t *ring, void *buf, size_t len) {
+    ring_index_t *ix = &ring->shared->dir[ring->rx];
+    uint64_t tail = atomic_load_explicit(&ix->tail, memory_order_relaxed);
+    uint64_t head = atomic_load_explicit(&ix->head, memory_order_acquire);
+    uint64_t avail = head - tail;
+
+    if (avail > ring->size) {
+        errno = EPROTO;
+        return -1;
+    }
+    if (avail == 0) return 0;
+
+    size_t n = len < avail ? len : avail;
+    const uint8_t *data = ring->data[ring->rx];
+    uint64_t pos = tail & ring->mask;
+    size_t first = n < ring->size - pos ? n : ring->size - pos;
+
+    memcpy(buf, data + pos, first);
+    memcpy((uint8_t *)buf + first, data, n - first);
+
+    atomic_store_explicit(&ix->tail, tail + n, memory_order_release);
+    ring_notify(ring, WANT_SPACE);
+
+    /* Found work without the doorbell: spare the peer a write() */
+    _Atomic uint32_t *flag = &ring->shared->waiting[ring->side].want;
+    if (atomic_load_explicit(flag, memory_order_relaxed) & WANT_DATA) {
+        atomic_fetch_and(flag, ~WANT_DATA);
+    }
+    return n;
+}
+
+int shmring_wait_readable(shmring_t *ring, int sock) {
+    if (ring_readable(ring) || ring_spin(ring, SPIN_RECV, ring_readable)) return 0;
+    return ring_sleep(ring, WANT_DATA, ring_readable, sock);
+}
+
+int shmring_wait_writable(shmring_t *ring, int sock) {
+    if (ring_writable(ring) || ring_spin(ring, SPIN_SEND, ring_writable)) return 0;
+    return ring_sleep(ring, WANT_SPACE, ring_writable, sock);
+}
+
+int shmring_arm(shmring_t *ring) {
+    if (ring_readable(ring) || ring_spin(ring, SPIN_RECV, ring_readable)) return 1;
+
+    _Atomic uint32_t *flag = &ring->shared->waiting[ring->side].want;
+    atomic_fetch_or(flag, WANT_DATA);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (ring_readable(ring)) {
+        atomic_fetch_and(flag, ~WANT_DATA);
+        return 1;
+    }
+    return 0;
+}
+
+int shmring_arm_writable(shmring_t *ring) {
+    if (ring_writable(ring)) return 1;
+
+    _Atomic uint32_t *flag = &ring->shared->waiting[ring->side].want;
+    atomic_fetch_or(flag, WANT_SPACE);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (ring_writable(ring)) {
+        atomic_fetch_and(flag, ~WANT_SPACE);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file shmring.h
+ * @brief Shared-memory request/response ring for local connections
+ *
+ * Two single-producer/single-consumer byte rings in one sealed memfd:
+ * requests flow client -> server, replies server -> client. Each side owns
+ * eventfd doorbells that the other side rings only while it sleeps, and
+ * waits spin (adaptively) before sleeping, so a busy connection moves
+ * messages without any syscall. The ring is created by the server and
+ * handed to the client over the Unix socket it was negotiated on.
+ */
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/* Descriptors that describe a ring: the memfd, then a data and a space
+ * doorbell for each side */
+#define SHMRING_NUM_FDS 5
+
+/* Smallest ring (bytes per direction, rounded up to a power of two) */
+#define SHMRING_MIN_SIZE 4096
+
+/* Ring handle (one per side) */
+typedef struct shmring shmring_t;
+
+/**
+ * Create a ring (server side)
+ *
+ * The memfd is sealed against resizing, so the peer cannot make the
+ * mapping fault under the server.
+ *
+ * @param size Bytes per direction (rounded up to a power of two)
+ * @return Ring handle on success, NULL on failure
+ */
+shmring_t *shmring_create(size_t size);
+
+/**
+ * Get the descriptors to pass to the client (server side)
+ *
+ * @param ring Ring handle
+ * @param fds Output: SHMRING_NUM_FDS descriptors (still owned by the ring)
+ * @return 0 on success, -1 on failure
+ */
+int shmring_get_fds(const shmring_t *ring, int fds[SHMRING_NUM_FDS]);
+
+/**
+ * Map a ring received from the server (client side)
+ *
+ * @param fds SHMRING_NUM_FDS descriptors; consumed, also on failure
+ * @return Ring handle on success, NULL on failure
+ */
+shmring_t *shmring_attach(const int fds[SHMRING_NUM_FDS]);
+
+/**
+ * Unmap the ring and close its descriptors
+ *
+ * @param ring Ring handle
+ */
+void shmring_destroy(shmring_t *ring);
+
+/**
+ * Get this side's doorbell (an eventfd, readable when the peer rang)
+ *
+ * Event loops watch it edge-triggered after shmring_arm() returned 0.
+ *
+ * @param ring Ring handle
+ * @return Doorbell file descriptor
+ */
+int shmring_doorbell_fd(const shmring_t *ring);
+
+/**
+ * Get this side's space doorbell (an eventfd, readable when the peer
+ * drained its incoming ring)
+ *
+ * Event loops watch it edge-triggered after shmring_arm_writable()
+ * returned 0.
+ *
+ * @param ring Ring handle
+ * @return Space doorbell file descriptor
+ */
+int shmring_space_fd(const shmring_t *ring);
+
+/**
+ * Copy as much of iov as fits into the outgoing ring (non-blocking)
+ *
+ * Everything copied is published at once; the peer's doorbell rings only
+ * if it is asleep waiting for data.
+ *
+ * @param ring Ring handle
+ * @param iov Buffers to copy, in order
+ * @param iovcnt Number of buffers
+ * @return Bytes copied (0 if the ring is full), -1 if the shared indexes
+ *         are corrupt
+ */
+ssize_t shmring_writev(shmring_t *ring, const struct iovec *iov, int iovcnt);
+
+/**
+ * Copy up to len bytes out of the incoming ring (non-blocking)
+ *
+ * @param ring Ring handle
+ * @param buf Destination
+ * @param len Buffer size
+ * @return Bytes copied (0 if the ring is empty), -1 if the shared indexes
+ *         are corrupt
+ */
+ssize_t shmring_read(shmring_t *ring, void *buf, size_t len);
+
+/**
+ * Wait until the incoming ring has data
+ *
+ * Spins for a while first, then sleeps on the doorbell. The socket the
+ * ring was negotiated on is watched for hangup.
+ *
+ * @param ring Ring handle
+ * @param sock Connection socket (-1 to not watch one)
+ * @return 0 when data is available, -1 on error or hangup
+ */
+int shmring_wait_readable(shmring_t *ring, int sock);
+
+/**
+ * Wait until the outgoing ring has room
+ *
+ * @param ring Ring handle
+ * @param sock Connection socket (-1 to not watch one)
+ * @return 0 when there is room, -1 on error or hangup
+ */
+int shmring_wait_writable(shmring_t *ring, int sock);
+
+/**
+ * Prepare an event loop to sleep until data arrives
+ *
+ * Spins for a while, then asks the peer to ring the doorbell on its next
+ * write. Must be called (and return 0) before waiting on the doorbell.
+ *
+ * @param ring Ring handle
+ * @return 1 if data is available now, 0 if armed
+ */
+int shmring_arm(shmring_t *ring);
+
+/**
+ * Prepare an event loop to sleep until the outgoing ring has room
+ *
+ * Does not spin: the peer may be busy for a long time. Asks it to ring
+ * the space doorbell on its next read.
+ *
+ * @param ring Ring handle
+ * @return 1 if there is room now, 0 if armed
+ */
+int shmring_arm_writable(shmring_t *ring);
+
+#endif /* SHMRING_H */
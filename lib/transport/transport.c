@@ -466,7 +466,7 @@ int transport_get_caps(transport_t *transport, transport_caps_t *caps)
 
 transport_type_t transport_get_type(transport_t *transport)
 {
-    return transport ? transport->type : -1;
+    return transport ? transport->type : (transport_type_t)-1;
 }
 
 void transport_close(transport_t *transport)
@@ -6,30 +6,75 @@
  * - Unix domain sockets for local IPC
  * - FD passing for zero-copy object access
  * - Backend manager for multi-tier storage
- * - objm protocol V1 (simple ordered requests)
+ * - objm protocol V1 (simple ordered requests) and V2 (pipelined, with
+ *   slow persistent-tier lookups answered out of order by a worker pool)
+ * - Event-driven core: N pinned epoll workers own non-blocking connections
+ *   (set OBJMAPPER_IO_MODE=threads for legacy thread-per-connection)
+ * - Optional TCP listener (OBJMAPPER_TCP_LISTEN=[host:]port) for remote
+ *   cluster clients, which stream bodies with COPY/SPLICE
+ * - io_uring engine for cold persistent-tier GETs (OBJMAPPER_AIO=0 turns
+ *   it off, OBJMAPPER_AIO_DEPTH sizes it)
+ * - Shared-memory request/reply rings for local clients that ask for them
+ *   (OBJMAPPER_SHM_RING=0 turns them off)
+ * - Compressed persistent tier (OBJMAPPER_COMPRESS=<level>, 1-9): FD pass
+ *   readers get plain bytes from the memory tier, streamed readers that
+ *   negotiated OBJM_CAP_COMPRESSION get the stored gzip bytes
+ * - NUMA: on multi-node hosts, one memory tier per node and epoll workers
+ *   pinned node by node (OBJMAPPER_NUMA=0 keeps a single tier)
+ * - Group-commit durability: persistent PUTs are acknowledged once a
+ *   commit round synced them (OBJMAPPER_COMMIT_US sets the round budget,
+ *   OBJMAPPER_CHECKPOINT_RECORDS the smallest journal worth a checkpoint,
+ *   OBJMAPPER_DURABLE=0 turns syncing off)
  */
 
+#define _GNU_SOURCE
+
 #include "lib/protocol/protocol.h"
 #include "lib/backend/backend.h"
+#include "lib/backend/aio.h"
+#include "lib/backend/chunk.h"
+#include "lib/backend/compress.h"
+#include "lib/backend/durable.h"
+#include "lib/backend/numa.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <signal.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
 #include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
 #include <pthread.h>
+#include <sched.h>
 
 /* ============================================================================
  * Configuration
  * ============================================================================ */
 
 #define DEFAULT_SOCKET_PATH "/tmp/objmapper.sock"
-#define LISTEN_BACKLOG 128
-#define MAX_CONCURRENT_CLIENTS 64
+#define LISTEN_BACKLOG 1024
+#define MAX_CONCURRENT_CLIENTS 64       /* Thread-per-connection mode only */
+
+/* Event-driven mode */
+#define MAX_EPOLL_WORKERS 64
+#define EPOLL_MAX_EVENTS 256
+#define EPOLL_WAIT_TIMEOUT_MS 200       /* Bounds shutdown latency */
+#define SERVER_OUTPUT_HIGH_WATER (256 * 1024)  /* Queued reply bytes that pause reading */
+
+/* V2 pipelining */
+#define SERVER_MAX_PIPELINE 128         /* In-flight requests per connection */
+#define MAX_SLOW_WORKERS 64
+#define DEFAULT_SLOW_WORKERS 8          /* Threads for blocking lookups */
 
 /* Backend configuration */
 /* Can be overridden for benchmarking with smaller limits */
@@ -42,237 +87,2167 @@
 #define CACHE_CHECK_INTERVAL_US (1000000)  /* 1 second */
 #define CACHE_HOTNESS_THRESHOLD 0.7
 
+/* ETag: quoted "<mtime>-<size>" in hex, NUL included */
+#define ETAG_MAX 40
+
 /* ============================================================================
  * Global State
  * ============================================================================ */
 
 static backend_manager_t *g_backend_mgr = NULL;
+static backend_aio_t *g_aio = NULL;
 static volatile sig_atomic_t g_running = 1;
-static int g_memory_backend_id = -1;
+static int g_memory_backend_id = -1;   /* Ephemeral and cache default */
 static int g_persistent_backend_id = -1;
 
-static struct {
-    atomic_size_t requests_total;
-    atomic_size_t gets;
-    atomic_size_t puts;
-    atomic_size_t deletes;
-    atomic_size_t errors;
-    atomic_size_t active_connections;
-} g_stats = {0};
+/* Memory tiers: g_memory_backend_id alone, or one per NUMA node */
+static int g_memory_backend_ids[BACKEND_NUMA_MAX_NODES];
+static int g_num_memory_backends = 0;
+static uint32_t g_numa_nodes = 0;       /* Nodes with a tier (0 = single tier) */
+
+/* Negotiated by every connection (V1 clients skip the handshake) */
+static objm_hello_t g_server_hello = {
+    .capabilities = OBJM_CAP_OOO_REPLIES | OBJM_CAP_PIPELINING | OBJM_CAP_BATCH |
+                    OBJM_CAP_SHM_RING | OBJM_CAP_COMPRESSION,
+    .max_pipeline = SERVER_MAX_PIPELINE,
+    .backend_parallelism = 2  /* Memory + persistent */
+};
+
+/* Per-connection, not per-request: stays a shared counter */
+static atomic_size_t g_active_connections = 0;
 
 /* ============================================================================
- * Request Handlers
- * ============================================================================ */
+ * Instrumentation
+ * ============================================================================
+ *
+ * Every thread that serves requests owns a stats block and is its only
+ * writer, so counting is a relaxed load/store on cache lines no other core
+ * writes. Readers (STATS requests, the periodic dump, shutdown) sum all
+ * blocks. A block whose thread exits is parked and handed to the next
+ * thread as is: counts are cumulative, so nothing is lost or counted twice.
+ *
+ * Latencies go into log-linear histograms: exact below LAT_SUB ns, then
+ * LAT_SUB buckets per power of two (12.5% worst-case error).
+ */
+
+#define LAT_SUB_BITS 3
+#define LAT_SUB      (1u << LAT_SUB_BITS)
+#define LAT_BUCKETS  ((64 - LAT_SUB_BITS + 1) * LAT_SUB)
+
+#define STATS_DUMP_POLL_US 100000       /* Bounds shutdown latency */
+
+typedef enum {
+    STAGE_RECV = 0,     /* Parse of a request already readable (epoll core) */
+    STAGE_LOOKUP,       /* Index lookup, excluding open() */
+    STAGE_OPEN,         /* open() on an FD cache miss */
+    STAGE_SEND_FD,      /* Reply carrying an FD (SCM_RIGHTS sendmsg) */
+    STAGE_REQUEST,      /* Whole dispatch, receive excluded */
+    NUM_STAGES
+} stats_stage_t;
+
+static const char *const STAGE_NAMES[NUM_STAGES] = {
+    "recv", "lookup", "open", "send_fd", "request"
+};
+
+typedef enum {
+    COUNTER_REQUESTS = 0,
+    COUNTER_GETS,
+    COUNTER_NOT_MODIFIED,   /* Conditional GETs answered without the object */
+    COUNTER_PUTS,
+    COUNTER_DELETES,
+    COUNTER_ERRORS,
+    NUM_COUNTERS
+} stats_counter_t;
+
+typedef struct {
+    atomic_uint_fast64_t buckets[LAT_BUCKETS];
+    atomic_uint_fast64_t count;
+    atomic_uint_fast64_t sum_ns;
+    atomic_uint_fast64_t max_ns;
+} lat_hist_t;
+
+typedef struct stats_block {
+    atomic_uint_fast64_t counters[NUM_COUNTERS];
+    lat_hist_t stages[NUM_STAGES];
+    atomic_bool in_use;
+    struct stats_block *next;           /* Registry (append-only) */
+} __attribute__((aligned(64))) stats_block_t;
+
+/* Aggregated view, private to the reader */
+typedef struct {
+    uint64_t counters[NUM_COUNTERS];
+    struct {
+        uint64_t buckets[LAT_BUCKETS];
+        uint64_t count;
+        uint64_t sum_ns;
+        uint64_t max_ns;
+    } stages[NUM_STAGES];
+} stats_snapshot_t;
+
+static atomic_uintptr_t g_stats_blocks = 0;
+static pthread_key_t g_stats_key;
+static pthread_once_t g_stats_key_once = PTHREAD_ONCE_INIT;
+static __thread stats_block_t *t_stats;
+
+/* Latency timing can be switched off (OBJMAPPER_LATENCY=0); counters stay */
+static bool g_latency_enabled = true;
+
+static void stats_thread_exit(void *arg) {
+    stats_block_t *block = arg;
+    atomic_store_explicit(&block->in_use, false, memory_order_release);
+}
+
+static void stats_key_init(void) {
+    pthread_key_create(&g_stats_key, stats_thread_exit);
+}
+
+static stats_block_t *stats_register(void) {
+    pthread_once(&g_stats_key_once, stats_key_init);
+    
+    /* Reuse a block parked by an exited thread */
+    stats_block_t *block = (stats_block_t *)atomic_load(&g_stats_blocks);
+    for (; block; block = block->next) {
+        bool expected = false;
+        if (!atomic_load_explicit(&block->in_use, memory_order_relaxed) &&
+            atomic_compare_exchange_strong(&block->in_use, &expected, true)) {
+            break;
+        }
+    }
+    
+    if (!block) {
+        block = aligned_alloc(64, sizeof(*block));
+        if (!block) return NULL;
+        memset(block, 0, sizeof(*block));
+        atomic_init(&block->in_use, true);
+        
+        uintptr_t head = atomic_load(&g_stats_blocks);
+        do {
+            block->next = (stats_block_t *)head;
+        } while (!atomic_compare_exchange_weak(&g_stats_blocks, &head,
+                                               (uintptr_t)block));
+    }
+    
+    pthread_setspecific(g_stats_key, block);
+    t_stats = block;
+    return block;
+}
+
+static inline stats_block_t *stats_local(void) {
+    stats_block_t *block = t_stats;
+    return block ? block : stats_register();
+}
+
+/* Single writer: no read-modify-write, no lock prefix */
+static inline void stats_bump(atomic_uint_fast64_t *c, uint64_t n) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n,
+                          memory_order_relaxed);
+}
+
+static void stats_count(stats_counter_t counter, uint64_t n) {
+    stats_block_t *block = stats_local();
+    if (block) stats_bump(&block->counters[counter], n);
+}
 
 /**
- * Handle GET request
+ * Start timing a stage
  * 
- * For FD pass mode (mode '1'):
- * - Lookup object in backend
- * - Send FD via SCM_RIGHTS
- * - Client can read directly from FD (zero-copy)
+ * @return Monotonic timestamp in ns, or 0 when latency timing is off
  */
-static int handle_get(objm_connection_t *conn, const objm_request_t *req) {
-    fd_ref_t ref;
+static inline uint64_t stats_clock(void) {
+    if (!g_latency_enabled) return 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static unsigned lat_bucket(uint64_t ns) {
+    if (ns < LAT_SUB) return (unsigned)ns;
+    unsigned msb = 63u - (unsigned)__builtin_clzll(ns);
+    unsigned group = msb - LAT_SUB_BITS + 1;
+    unsigned mantissa = (unsigned)(ns >> (msb - LAT_SUB_BITS)) & (LAT_SUB - 1);
+    return group * LAT_SUB + mantissa;
+}
+
+/* Highest value that falls into bucket @idx */
+static uint64_t lat_bucket_value(unsigned idx) {
+    unsigned group = idx / LAT_SUB;
+    uint64_t mantissa = idx % LAT_SUB;
+    if (group == 0) return mantissa;
+    return ((LAT_SUB + mantissa) << (group - 1)) + (1ULL << (group - 1)) - 1;
+}
+
+static void stats_record_ns(stats_stage_t stage, uint64_t ns) {
+    stats_block_t *block = stats_local();
+    if (!block) return;
     
-    /* Lookup object */
-    if (backend_get_object(g_backend_mgr, req->uri, &ref) < 0) {
-        objm_server_send_error(conn, req->id, OBJM_STATUS_NOT_FOUND,
-                              "Object not found");
-        return -1;
+    lat_hist_t *h = &block->stages[stage];
+    stats_bump(&h->buckets[lat_bucket(ns)], 1);
+    stats_bump(&h->count, 1);
+    stats_bump(&h->sum_ns, ns);
+    if (ns > atomic_load_explicit(&h->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&h->max_ns, ns, memory_order_relaxed);
+    }
+}
+
+/**
+ * Record the time since @start (a stats_clock() value) for a stage
+ */
+static void stats_record(stats_stage_t stage, uint64_t start) {
+    if (start == 0) return;
+    stats_record_ns(stage, stats_clock() - start);
+}
+
+static void stats_collect(stats_snapshot_t *snap) {
+    memset(snap, 0, sizeof(*snap));
+    
+    stats_block_t *block = (stats_block_t *)atomic_load(&g_stats_blocks);
+    for (; block; block = block->next) {
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            snap->counters[c] += atomic_load_explicit(&block->counters[c],
+                                                      memory_order_relaxed);
+        }
+        for (int s = 0; s < NUM_STAGES; s++) {
+            lat_hist_t *h = &block->stages[s];
+            uint64_t count = atomic_load_explicit(&h->count, memory_order_relaxed);
+            if (count == 0) continue;
+            
+            for (unsigned i = 0; i < LAT_BUCKETS; i++) {
+                snap->stages[s].buckets[i] +=
+                    atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+            }
+            snap->stages[s].count += count;
+            snap->stages[s].sum_ns += atomic_load_explicit(&h->sum_ns,
+                                                           memory_order_relaxed);
+            uint64_t max = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+            if (max > snap->stages[s].max_ns) snap->stages[s].max_ns = max;
+        }
+    }
+}
+
+static uint64_t snapshot_percentile(const stats_snapshot_t *snap,
+                                    stats_stage_t stage, double pct) {
+    uint64_t total = 0;
+    for (unsigned i = 0; i < LAT_BUCKETS; i++) {
+        total += snap->stages[stage].buckets[i];
     }
+    if (total == 0) return 0;
     
-    /* For FD pass mode, send the file descriptor */
-    if (req->mode == OBJM_MODE_FDPASS) {
-        /* Build response - for FD pass, content_len should be 0 
-         * (client gets size from fstat on the FD) */
-        objm_response_t resp = {
-            .request_id = req->id,
-            .status = OBJM_STATUS_OK,
-            .fd = ref.fd,
-            .content_len = 0,  /* FD pass doesn't use content_len */
-            .metadata = NULL,
-            .metadata_len = 0,
-            .error_msg = NULL
-        };
-        
-        /* Send response with FD */
-        int ret = objm_server_send_response(conn, &resp);
-        
-        /* Release our reference (client now owns the FD) */
-        fd_ref_release(&ref);
-        
-        if (ret < 0) {
+    /* Buckets and count are read separately: rank against the buckets */
+    uint64_t rank = (uint64_t)(pct / 100.0 * (double)total + 0.999999);
+    if (rank == 0) rank = 1;
+    
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < LAT_BUCKETS; i++) {
+        seen += snap->stages[stage].buckets[i];
+        if (seen >= rank) {
+            uint64_t v = lat_bucket_value(i);
+            uint64_t max = snap->stages[stage].max_ns;
+            return (max && v > max) ? max : v;
+        }
+    }
+    return snap->stages[stage].max_ns;
+}
+
+/**
+ * Status of the memory tier, summed over the per-node tiers
+ */
+static int memory_tier_status(uint64_t *capacity, uint64_t *used, size_t *objects) {
+    *capacity = *used = 0;
+    *objects = 0;
+    
+    for (int i = 0; i < g_num_memory_backends; i++) {
+        uint64_t c, u;
+        size_t n;
+        if (backend_get_status(g_backend_mgr, g_memory_backend_ids[i], &c, &u, &n, NULL) < 0) {
             return -1;
         }
-        
-        atomic_fetch_add(&g_stats.gets, 1);
-        return 0;
-    } else {
-        /* Copy mode not implemented yet */
-        fd_ref_release(&ref);
-        objm_server_send_error(conn, req->id, OBJM_STATUS_UNSUPPORTED_OP,
-                              "Only FD pass mode supported for GET");
+        *capacity += c;
+        *used += u;
+        *objects += n;
+    }
+    return g_num_memory_backends > 0 ? 0 : -1;
+}
+
+/**
+ * Write the statistics report as key=value lines
+ * 
+ * One line of counters, one per latency stage, one per backend, one per
+ * NUMA node with a memory tier and one for the index, so the report can
+ * be parsed line by line.
+ */
+static void stats_report(FILE *out) {
+    stats_snapshot_t *snap = malloc(sizeof(*snap));
+    if (!snap) return;
+    stats_collect(snap);
+    
+    fprintf(out, "requests_total=%llu gets=%llu not_modified=%llu puts=%llu "
+            "deletes=%llu errors=%llu active_connections=%zu\n",
+            (unsigned long long)snap->counters[COUNTER_REQUESTS],
+            (unsigned long long)snap->counters[COUNTER_GETS],
+            (unsigned long long)snap->counters[COUNTER_NOT_MODIFIED],
+            (unsigned long long)snap->counters[COUNTER_PUTS],
+            (unsigned long long)snap->counters[COUNTER_DELETES],
+            (unsigned long long)snap->counters[COUNTER_ERRORS],
+            atomic_load(&g_active_connections));
+    
+    for (int s = 0; s < NUM_STAGES; s++) {
+        uint64_t count = snap->stages[s].count;
+        fprintf(out, "stage=%s count=%llu mean_ns=%llu p50_ns=%llu p90_ns=%llu "
+                "p99_ns=%llu p999_ns=%llu max_ns=%llu\n",
+                STAGE_NAMES[s], (unsigned long long)count,
+                (unsigned long long)(count ? snap->stages[s].sum_ns / count : 0),
+                (unsigned long long)snapshot_percentile(snap, s, 50.0),
+                (unsigned long long)snapshot_percentile(snap, s, 90.0),
+                (unsigned long long)snapshot_percentile(snap, s, 99.0),
+                (unsigned long long)snapshot_percentile(snap, s, 99.9),
+                (unsigned long long)snap->stages[s].max_ns);
+    }
+    free(snap);
+    
+    if (!g_backend_mgr) return;
+    
+    uint64_t capacity, used;
+    size_t obj_count;
+    if (memory_tier_status(&capacity, &used, &obj_count) == 0) {
+        fprintf(out, "backend=memory objects=%zu used_bytes=%llu capacity_bytes=%llu\n",
+                obj_count, (unsigned long long)used, (unsigned long long)capacity);
+    }
+    if (backend_get_status(g_backend_mgr, g_persistent_backend_id, &capacity, &used,
+                           &obj_count, NULL) == 0) {
+        fprintf(out, "backend=persistent objects=%zu used_bytes=%llu capacity_bytes=%llu\n",
+                obj_count, (unsigned long long)used, (unsigned long long)capacity);
+    }
+    
+    for (int node = 0; node < BACKEND_NUMA_MAX_NODES; node++) {
+        numa_stats_t numa;
+        if (!(g_numa_nodes & (1u << node)) ||
+            backend_get_numa_stats(g_backend_mgr, node, &numa) < 0) {
+            continue;
+        }
+        fprintf(out, "numa node=%d backend=%d objects=%zu used_bytes=%llu "
+                "local_reads=%llu remote_reads=%llu\n", node, numa.backend_id,
+                numa.objects, (unsigned long long)numa.used_bytes,
+                (unsigned long long)numa.local_reads,
+                (unsigned long long)numa.remote_reads);
+    }
+    
+    durable_stats_t durable;
+    if (backend_durable_get_stats(g_backend_mgr, &durable) == 0) {
+        fprintf(out, "durable rounds=%llu waits=%llu data_syncs=%llu dir_syncs=%llu "
+                "journal_syncs=%llu errors=%llu checkpoints=%llu checkpoint_records=%llu\n",
+                (unsigned long long)durable.rounds, (unsigned long long)durable.waits,
+                (unsigned long long)durable.data_syncs, (unsigned long long)durable.dir_syncs,
+                (unsigned long long)durable.journal_syncs, (unsigned long long)durable.errors,
+                (unsigned long long)durable.checkpoints,
+                (unsigned long long)durable.checkpoint_records);
+    }
+    
+    index_stats_t idx;
+    global_index_get_stats(g_backend_mgr->global_index, &idx);
+    fprintf(out, "index entries=%llu lookups=%llu hits=%llu misses=%llu "
+            "fd_cache_hits=%llu fd_opens=%llu fd_evictions=%llu open_fds=%llu\n",
+            (unsigned long long)idx.num_entries, (unsigned long long)idx.lookups,
+            (unsigned long long)idx.hits, (unsigned long long)idx.misses,
+            (unsigned long long)idx.fd_cache_hits, (unsigned long long)idx.fd_opens,
+            (unsigned long long)idx.fd_evictions, (unsigned long long)idx.num_open_fds);
+}
+
+/**
+ * Look up an object's FD, timing the index and open() stages separately
+ * 
+ * With stored, a compressed object's FD reads its gzip form (see
+ * backend_get_stored_fd()); otherwise every FD reads plain bytes.
+ */
+static int lookup_object_fd(const char *uri, index_entry_info_t *info, bool stored) {
+    uint64_t start = stats_clock();
+    int fd = stored ? backend_get_stored_fd(g_backend_mgr, uri, info) :
+                      backend_get_object_fd(g_backend_mgr, uri, info);
+    
+    if (start) {
+        uint64_t elapsed = stats_clock() - start;
+        uint64_t open_ns = (fd >= 0) ? info->open_ns : 0;
+        stats_record_ns(STAGE_LOOKUP, elapsed > open_ns ? elapsed - open_ns : 0);
+        if (open_ns) stats_record_ns(STAGE_OPEN, open_ns);
+    }
+    return fd;
+}
+
+/**
+ * Send a reply that carries an FD, timing the sendmsg
+ * 
+ * With take, the FD is handed to the connection, which closes it: on a
+ * shared-memory ring it may then wait to go out with the rest of the
+ * worker's pass.
+ */
+static int send_fd_response(objm_connection_t *conn, const objm_response_t *resp,
+                            bool take) {
+    uint64_t start = stats_clock();
+    int ret = take ? objm_server_send_response_owned(conn, resp) :
+                     objm_server_send_response(conn, resp);
+    stats_record(STAGE_SEND_FD, start);
+    return ret;
+}
+
+/* ============================================================================
+ * Validators (size, mtime, ETag)
+ * ============================================================================
+ *
+ * GET, STAT and NOT_MODIFIED replies describe the object with OBJM_META_SIZE,
+ * OBJM_META_MTIME and OBJM_META_ETAG, taken from the index entry whenever it
+ * is authoritative, so revalidating an unchanged object opens nothing. The
+ * ETag is built from the mtime and the size of the representation sent: a
+ * compressed object's gzip form (OBJM_CAP_COMPRESSION) and its plain form
+ * have different ones, as in HTTP.
+ */
+
+typedef struct {
+    uint64_t size;                   /* Bytes of the representation */
+    uint64_t mtime;                  /* Seconds since the epoch */
+    char etag[ETAG_MAX];
+} object_validators_t;
+
+static void validators_set(object_validators_t *v, uint64_t size, uint64_t mtime) {
+    v->size = size;
+    v->mtime = mtime;
+    snprintf(v->etag, sizeof(v->etag), "\"%" PRIx64 "-%" PRIx64 "\"", mtime, size);
+}
+
+/**
+ * Whether a GET reply may carry a compressed object's stored gzip bytes
+ */
+static bool reply_may_encode(objm_connection_t *conn, const objm_request_t *req) {
+    return req->mode != OBJM_MODE_FDPASS &&
+           objm_has_capability(conn, OBJM_CAP_COMPRESSION);
+}
+
+/**
+ * Validators from the index alone
+ * 
+ * @return 0 if resolved, 1 if only the file can tell (an FD writer's object,
+ *         or the plain size of a compressed one), -1 if not found
+ */
+static int validators_from_index(const char *uri, bool encoded,
+                                 object_validators_t *v, index_entry_info_t *info) {
+    if (backend_stat_object(g_backend_mgr, uri, info) < 0) return -1;
+    if (info->flags & INDEX_FLAG_UNSETTLED) return 1;
+    if (backend_flags_compressed(info->flags) && !encoded) return 1;
+    
+    validators_set(v, info->size_bytes, info->mtime);
+    return 0;
+}
+
+/**
+ * Validators from an FD on the object's stored bytes
+ */
+static int validators_from_file(int fd, const index_entry_info_t *info, bool encoded,
+                                object_validators_t *v) {
+    struct stat st;
+    if (fstat(fd, &st) < 0) return -1;
+    
+    uint64_t size = st.st_size;
+    if (backend_flags_compressed(info->flags) && !encoded &&
+        backend_compressed_size(fd, &size) < 0) {
         return -1;
     }
+    
+    /* The index mtime is the commit's unless a writer still owns the file */
+    validators_set(v, size, (info->flags & INDEX_FLAG_UNSETTLED) ? (uint64_t)st.st_mtime
+                                                                 : info->mtime);
+    return 0;
 }
 
 /**
- * Handle PUT request
+ * Validators of an object, opening its stored bytes only if the index
+ * cannot answer
  * 
- * For FD pass mode:
- * - Create object in backend
- * - Send our FD to client via SCM_RIGHTS
- * - Client writes directly to FD
- * - Client closes FD when done
+ * @return OBJM_STATUS_OK, OBJM_STATUS_NOT_FOUND or OBJM_STATUS_STORAGE_ERROR
  */
-static int handle_put(objm_connection_t *conn, const objm_request_t *req) {
-    /* Determine if ephemeral or persistent */
-    bool ephemeral = (req->flags & OBJM_REQ_PRIORITY) ? true : false;
+static uint8_t object_validators(const char *uri, bool encoded,
+                                 object_validators_t *v, index_entry_info_t *info) {
+    int ret = validators_from_index(uri, encoded, v, info);
+    if (ret < 0) return OBJM_STATUS_NOT_FOUND;
+    if (ret == 0) return OBJM_STATUS_OK;
     
-    object_create_req_t create_req = {
-        .uri = req->uri,
-        .backend_id = -1,  /* Auto-select */
-        .ephemeral = ephemeral,
-        .size_hint = 0,
-        .flags = 0
-    };
+    int fd = lookup_object_fd(uri, info, true);
+    if (fd < 0) return OBJM_STATUS_NOT_FOUND;
+    ret = validators_from_file(fd, info, encoded, v);
+    close(fd);
+    return ret < 0 ? OBJM_STATUS_STORAGE_ERROR : OBJM_STATUS_OK;
+}
+
+/**
+ * Whether a strong or weak ("W/") ETag matches, by weak comparison
+ */
+static bool etag_matches(const uint8_t *tag, size_t len, const char *etag) {
+    if (len == 1 && tag[0] == '*') return true;
+    if (len >= 2 && tag[0] == 'W' && tag[1] == '/') {
+        tag += 2;
+        len -= 2;
+    }
+    return len == strlen(etag) && memcmp(tag, etag, len) == 0;
+}
+
+/**
+ * Evaluate an OBJM_REQ_CONDITIONAL request's conditions
+ * 
+ * As in HTTP: if ETags are given, any match means not modified and the
+ * time is ignored; otherwise the object is not modified unless it is newer
+ * than the given time. Malformed conditions never match.
+ */
+static bool request_not_modified(const objm_request_t *req,
+                                 const object_validators_t *v) {
+    if (!(req->flags & OBJM_REQ_CONDITIONAL)) return false;
     
-    fd_ref_t ref;
+    const uint8_t *p = req->conditions;
+    size_t left = req->conditions_len;
+    bool has_etag = false, etag_match = false, has_since = false;
+    uint64_t since = 0;
     
-    /* Check if object exists - delete old version */
-    if (backend_get_object(g_backend_mgr, req->uri, &ref) == 0) {
-        fd_ref_release(&ref);
-        backend_delete_object(g_backend_mgr, req->uri);
+    while (left > 0) {
+        if (left < 3) return false;
+        uint8_t type = p[0];
+        size_t len = ((size_t)p[1] << 8) | p[2];
+        if (left - 3 < len) return false;
+        const uint8_t *data = p + 3;
+        
+        if (type == OBJM_META_ETAG) {
+            has_etag = true;
+            etag_match = etag_match || etag_matches(data, len, v->etag);
+        } else if (type == OBJM_META_MTIME && len == 8) {
+            uint64_t be;
+            memcpy(&be, data, 8);
+            since = be64toh(be);
+            has_since = true;
+        }
+        p += 3 + len;
+        left -= 3 + len;
     }
     
-    /* Create new object */
-    if (backend_create_object(g_backend_mgr, &create_req, &ref) < 0) {
+    if (has_etag) return etag_match;
+    return has_since && v->mtime <= since;
+}
+
+/**
+ * Add size (optional), mtime and ETag metadata
+ */
+static size_t validators_metadata(uint8_t *meta, size_t len,
+                                  const object_validators_t *v, bool with_size) {
+    if (with_size) len = objm_metadata_add_size(meta, len, v->size);
+    len = objm_metadata_add_mtime(meta, len, v->mtime);
+    return objm_metadata_add_etag(meta, len, v->etag);
+}
+
+/**
+ * Answer a conditional GET whose object is unchanged: validators, no FD
+ */
+static int send_not_modified(objm_connection_t *conn, const objm_request_t *req,
+                             const object_validators_t *v) {
+    uint8_t meta[64];
+    objm_response_t resp = {
+        .request_id = req->id,
+        .status = OBJM_STATUS_NOT_MODIFIED,
+        .fd = -1,
+        .content_len = OBJM_CONTENT_NONE,
+        .metadata = meta,
+        .metadata_len = validators_metadata(meta, 0, v, true),
+        .error_msg = NULL
+    };
+    
+    if (objm_server_send_response(conn, &resp) < 0) return -1;
+    
+    stats_count(COUNTER_GETS, 1);
+    stats_count(COUNTER_NOT_MODIFIED, 1);
+    return 0;
+}
+
+/* ============================================================================
+ * Request Handlers
+ * ============================================================================ */
+
+/**
+ * Drop a connection whose streamed body failed mid-way
+ * 
+ * The byte stream can no longer be framed; shutting the socket down makes
+ * the connection's next receive see EOF and tear it down.
+ */
+static void stream_abort(objm_connection_t *conn) {
+    shutdown(objm_get_fd(conn), SHUT_RDWR);
+}
+
+/**
+ * Answer a GET with the object's FD or a streamed body (takes fd)
+ * 
+ * info describes what fd reads: with encoding OBJM_ENCODING_GZIP, a
+ * compressed object's stored bytes. Size, mtime and ETag go with the
+ * reply, so FD pass clients need no fstat(); a conditional request whose
+ * ETag or time still matches gets NOT_MODIFIED instead.
+ */
+static int send_get_reply(objm_connection_t *conn, const objm_request_t *req, int fd,
+                          const index_entry_info_t *info, uint8_t encoding) {
+    object_validators_t v;
+    bool encoded = encoding != OBJM_ENCODING_IDENTITY;
+    if (!(info->flags & INDEX_FLAG_UNSETTLED)) {
+        validators_set(&v, info->size_bytes, info->mtime);
+    } else if (validators_from_file(fd, info, encoded, &v) < 0) {
+        close(fd);
         objm_server_send_error(conn, req->id, OBJM_STATUS_STORAGE_ERROR,
-                              "Failed to create object");
+                              "Failed to stat object");
         return -1;
     }
     
-    /* For FD pass mode, send the FD to client for writing */
+    if (request_not_modified(req, &v)) {
+        close(fd);
+        return send_not_modified(conn, req, &v);
+    }
+    
+    uint8_t meta[64];
+    
+    /* For FD pass mode, send the file descriptor */
     if (req->mode == OBJM_MODE_FDPASS) {
+        /* content_len stays 0 for FD pass; the size is in the metadata */
         objm_response_t resp = {
             .request_id = req->id,
             .status = OBJM_STATUS_OK,
-            .fd = ref.fd,
-            .content_len = 0,
-            .metadata = NULL,
-            .metadata_len = 0,
+            .fd = fd,
+            .content_len = 0,  /* FD pass doesn't use content_len */
+            .metadata = meta,
+            .metadata_len = validators_metadata(meta, 0, &v, true),
             .error_msg = NULL
         };
         
-        int ret = objm_server_send_response(conn, &resp);
+        /* Send response with FD (the connection closes our copy) */
+        int ret = send_fd_response(conn, &resp, true);
+        
+        if (ret < 0) {
+            return -1;
+        }
         
-        /* Release our reference (client now owns the FD for writing) */
-        fd_ref_release(&ref);
+        stats_count(COUNTER_GETS, 1);
+        return 0;
+    } else if (req->mode == OBJM_MODE_COPY || req->mode == OBJM_MODE_SPLICE) {
+        /* The stream reply adds the body size itself */
+        size_t meta_len = validators_metadata(meta, 0, &v, false);
+        int ret = objm_server_send_stream_meta(conn, req->id, fd, req->mode,
+                                               encoding, meta, meta_len);
+        close(fd);
         
         if (ret < 0) {
-            /* Client will close FD, object remains but empty */
+            stream_abort(conn);
             return -1;
         }
         
-        atomic_fetch_add(&g_stats.puts, 1);
+        stats_count(COUNTER_GETS, 1);
         return 0;
     } else {
-        fd_ref_release(&ref);
-        objm_server_send_error(conn, req->id, OBJM_STATUS_UNSUPPORTED_OP,
-                              "Only FD pass mode supported for PUT");
+        close(fd);
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INVALID_MODE,
+                              "Unknown transfer mode");
         return -1;
     }
 }
 
 /**
- * Handle DELETE request
+ * Answer a GET for a byte range (OBJM_REQ_RANGE), or for a whole chunked
+ * object, which has no single FD
+ * 
+ * FD pass hands over the one FD holding the range's first byte (the whole
+ * object if it is plain, its chunk otherwise) and OBJM_META_RANGE says
+ * which object bytes it holds; streamed modes send exactly the range,
+ * chunk after chunk. Validators describe the whole object, as in HTTP.
  */
-static int handle_delete(objm_connection_t *conn, const objm_request_t *req) {
-    int ret = backend_delete_object(g_backend_mgr, req->uri);
+static int send_range_reply(objm_connection_t *conn, const objm_request_t *req) {
+    bool ranged = (req->flags & OBJM_REQ_RANGE) != 0;
+    bool fdpass = (req->mode == OBJM_MODE_FDPASS);
+    if (!fdpass && req->mode != OBJM_MODE_COPY && req->mode != OBJM_MODE_SPLICE) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INVALID_MODE,
+                              "Unknown transfer mode");
+        return -1;
+    }
     
-    if (ret == 0) {
+    uint64_t start = stats_clock();
+    backend_range_t range;
+    if (backend_get_range(g_backend_mgr, req->uri, ranged ? req->range_offset : 0,
+                          ranged ? req->range_length : 0, fdpass ? 1 : 0, &range) < 0) {
+        if (errno == ERANGE) {
+            objm_server_send_error(conn, req->id, OBJM_STATUS_INVALID_RANGE,
+                                  "Range starts past the end of the object");
+        } else if (errno == ENODATA) {
+            objm_server_send_error(conn, req->id, OBJM_STATUS_UNAVAILABLE,
+                                  "Part of the range is not written yet");
+        } else {
+            objm_server_send_error(conn, req->id, OBJM_STATUS_NOT_FOUND,
+                                  "Object not found");
+        }
+        return -1;
+    }
+    stats_record(STAGE_LOOKUP, start);
+    
+    /* An FD writer's object has no commit time in the index */
+    object_validators_t v;
+    struct stat st;
+    uint64_t mtime = range.info.mtime;
+    if ((range.info.flags & INDEX_FLAG_UNSETTLED) && fstat(range.extents[0].fd, &st) == 0) {
+        mtime = st.st_mtime;
+    }
+    validators_set(&v, range.size, mtime);
+    
+    if (request_not_modified(req, &v)) {
+        backend_range_release(&range);
+        return send_not_modified(conn, req, &v);
+    }
+    
+    uint8_t meta[128];
+    int ret;
+    if (fdpass) {
+        backend_extent_t *extent = &range.extents[0];
+        size_t meta_len = validators_metadata(meta, 0, &v, true);
         objm_response_t resp = {
             .request_id = req->id,
             .status = OBJM_STATUS_OK,
-            .fd = -1,
-            .content_len = 1,  /* Non-zero to indicate no FD in response */
-            .metadata = NULL,
-            .metadata_len = 0,
+            .fd = extent->fd,
+            .content_len = 0,
+            .metadata = meta,
+            .metadata_len = objm_metadata_add_range(meta, meta_len, extent->base,
+                                                    extent->span, range.size),
             .error_msg = NULL
         };
         
-        if (objm_server_send_response(conn, &resp) < 0) {
+        /* The connection closes the FD */
+        extent->fd = -1;
+        ret = send_fd_response(conn, &resp, true);
+    } else {
+        objm_extent_t *extents = calloc(range.num_extents, sizeof(*extents));
+        if (!extents) {
+            backend_range_release(&range);
+            objm_server_send_error(conn, req->id, OBJM_STATUS_OUT_OF_MEMORY,
+                                  "Out of memory");
             return -1;
         }
+        for (size_t i = 0; i < range.num_extents; i++) {
+            const backend_extent_t *extent = &range.extents[i];
+            extents[i] = (objm_extent_t){
+                .fd = extent->fd,
+                .offset = extent->offset - extent->base,
+                .length = extent->length
+            };
+        }
         
-        atomic_fetch_add(&g_stats.deletes, 1);
-        return 0;
-    } else {
-        objm_server_send_error(conn, req->id, OBJM_STATUS_NOT_FOUND,
-                              "Object not found");
+        /* The stream reply adds the body size itself */
+        size_t meta_len = validators_metadata(meta, 0, &v, false);
+        meta_len = objm_metadata_add_range(meta, meta_len, range.offset, range.length,
+                                           range.size);
+        ret = objm_server_send_stream_extents(conn, req->id, extents, range.num_extents,
+                                              req->mode, meta, meta_len);
+        free(extents);
+        if (ret < 0) stream_abort(conn);
+    }
+    
+    backend_range_release(&range);
+    if (ret < 0) return -1;
+    
+    stats_count(COUNTER_GETS, 1);
+    return 0;
+}
+
+/**
+ * Handle GET request
+ * 
+ * For FD pass mode (mode '1'):
+ * - Lookup object in backend
+ * - Send FD via SCM_RIGHTS
+ * - Client can read directly from FD (zero-copy)
+ * 
+ * For COPY ('2') and SPLICE ('3') modes, used where FDs cannot be passed
+ * (remote TCP clients), the object is streamed out of the backend FD by
+ * sendfile()/splice() as a chunked body. Clients that negotiated
+ * OBJM_CAP_COMPRESSION get a compressed object's stored gzip bytes as is.
+ * 
+ * A conditional GET (OBJM_REQ_CONDITIONAL) is checked first against the
+ * index, so an unchanged object is answered without being opened.
+ * 
+ * Range requests (OBJM_REQ_RANGE) and chunked objects are answered by
+ * send_range_reply().
+ */
+static int handle_get(objm_connection_t *conn, const objm_request_t *req) {
+    bool encoded_ok = reply_may_encode(conn, req);
+    
+    if (req->flags & OBJM_REQ_CONDITIONAL) {
+        object_validators_t v;
+        index_entry_info_t info;
+        uint8_t status = object_validators(req->uri, encoded_ok, &v, &info);
+        if (status == OBJM_STATUS_OK && request_not_modified(req, &v)) {
+            return send_not_modified(conn, req, &v);
+        }
+    }
+    if (req->flags & OBJM_REQ_RANGE) return send_range_reply(conn, req);
+    
+    /* Lookup object (lock-free, no entry reference held) */
+    index_entry_info_t info;
+    int fd = lookup_object_fd(req->uri, &info, encoded_ok);
+    if (fd >= 0 && backend_flags_chunked(info.flags)) {
+        close(fd);
+        return send_range_reply(conn, req);
+    }
+    if (fd < 0 && errno == EISDIR) return send_range_reply(conn, req);
+    if (fd < 0) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_NOT_FOUND,
+                              "Object not found");
         return -1;
     }
+    
+    uint8_t encoding = (encoded_ok && backend_flags_compressed(info.flags))
+                     ? OBJM_ENCODING_GZIP : OBJM_ENCODING_IDENTITY;
+    return send_get_reply(conn, req, fd, &info, encoding);
 }
 
 /**
- * Handle LIST request (disabled - should be management API)
+ * Handle multi-GET request
  * 
- * Note: LIST functionality should be implemented as a separate
- * management/admin interface, not as part of the main object
- * storage protocol. Use a dedicated management socket or REST API.
+ * Every hit's FD travels in the one SCM_RIGHTS message of the batch
+ * response; misses are reported per item and do not fail the batch. A
+ * chunked object has no single FD: its item is OBJM_STATUS_UNSUPPORTED_OP,
+ * and the client fetches it with a (range) GET.
  */
-static int handle_list(objm_connection_t *conn, const objm_request_t *req) {
-    (void)req;  /* Unused */
+static int handle_multi_get(objm_connection_t *conn, const objm_request_t *req) {
+    if (req->mode != OBJM_MODE_FDPASS) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_UNSUPPORTED_OP,
+                              "Only FD pass mode supported for multi-GET");
+        return -1;
+    }
+    
+    objm_response_t *items = calloc(req->num_uris, sizeof(*items));
+    if (!items) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_OUT_OF_MEMORY,
+                              "Out of memory");
+        return -1;
+    }
     
-    objm_server_send_error(conn, req->id, OBJM_STATUS_UNSUPPORTED_OP,
-                          "LIST is disabled - use management API");
-    return -1;
+    size_t found = 0;
+    for (size_t i = 0; i < req->num_uris; i++) {
+        items[i].request_id = req->id;
+        index_entry_info_t info;
+        errno = 0;  /* A miss need not set it */
+        items[i].fd = lookup_object_fd(req->uris[i], &info, false);
+        if (items[i].fd >= 0 && backend_flags_chunked(info.flags)) {
+            close(items[i].fd);
+            items[i].fd = -1;
+            errno = EISDIR;
+        }
+        if (items[i].fd >= 0) {
+            items[i].status = OBJM_STATUS_OK;
+            found++;
+        } else {
+            items[i].status = (errno == EISDIR) ? OBJM_STATUS_UNSUPPORTED_OP
+                                                : OBJM_STATUS_NOT_FOUND;
+        }
+    }
     
-    /* Original implementation disabled:
-    int backend_id = g_persistent_backend_id;
+    uint64_t send_start = stats_clock();
+    int ret = objm_server_send_multi_response(conn, req->id, items, req->num_uris);
+    stats_record(STAGE_SEND_FD, send_start);
     
-    if (req->uri && strncmp(req->uri, "/backend/", 9) == 0) {
-        backend_id = atoi(req->uri + 9);
+    /* Close our copies (the client owns the passed FDs) */
+    for (size_t i = 0; i < req->num_uris; i++) {
+        if (items[i].fd >= 0) close(items[i].fd);
     }
+    free(items);
     
-    char **uris = NULL;
-    size_t count = 0;
+    if (ret < 0) {
+        return -1;
+    }
     
-    if (backend_list_objects(g_backend_mgr, backend_id, &uris, &count) < 0) {
-        objm_server_send_error(conn, req->id, OBJM_STATUS_INTERNAL_ERROR,
-                              "Failed to list objects");
+    stats_count(COUNTER_GETS, found);
+    return 0;
+}
+
+/**
+ * Creation request of a PUT: ephemeral (memory tier) or persistent
+ */
+static object_create_req_t put_create_req(const objm_request_t *req) {
+    return (object_create_req_t){
+        .uri = req->uri,
+        .backend_id = -1,  /* Auto-select */
+        .ephemeral = (req->flags & OBJM_REQ_PRIORITY) ? true : false,
+        .size_hint = 0,
+        .flags = 0,
+        .replace = true,   /* Old version is only looked up if it exists */
+        .part_total = (req->flags & OBJM_REQ_TOTAL) ? req->range_total : 0
+    };
+}
+
+/**
+ * How a streamed PUT's body is moved
+ * 
+ * Body framing is the same for both modes; SPLICE only changes how the
+ * bytes are moved.
+ */
+static char put_body_mode(const objm_request_t *req) {
+    return (req->mode == OBJM_MODE_SPLICE) ? OBJM_MODE_SPLICE : OBJM_MODE_COPY;
+}
+
+/**
+ * Open the unpublished file a streamed PUT's body goes to
+ * 
+ * On failure put->fd is -1 and the client has its error; the body must
+ * still be consumed, so the next request on the connection is framed
+ * correctly.
+ */
+static void put_begin(objm_connection_t *conn, const objm_request_t *req,
+                      object_put_t *put) {
+    bool part = (req->flags & OBJM_REQ_RANGE) != 0;
+    
+    object_create_req_t create_req = put_create_req(req);
+    int begun = part ? backend_put_part_begin(g_backend_mgr, &create_req,
+                                              req->range_offset, put)
+                     : backend_put_begin(g_backend_mgr, &create_req, put);
+    if (begun == 0) return;
+    
+    bool misfit = part && errno == EINVAL;
+    put->fd = -1;
+    objm_server_send_error(conn, req->id,
+                          misfit ? OBJM_STATUS_INVALID_RANGE : OBJM_STATUS_STORAGE_ERROR,
+                          misfit ? "Part offset or total does not fit the object"
+                                 : "Failed to create object");
+}
+
+/**
+ * Check a received body against the part range it was sent for
+ * 
+ * @return 0 with put ready for put_commit_reply(), -1 if the request
+ *         failed (answered)
+ */
+static int put_check_received(objm_connection_t *conn, const objm_request_t *req,
+                              object_put_t *put, uint64_t received) {
+    if (put->fd < 0) return -1;  /* Never begun */
+    
+    if ((req->flags & OBJM_REQ_RANGE) && req->range_length > 0 &&
+        received != req->range_length) {
+        backend_put_abort(put);
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INVALID_REQUEST,
+                              "Part body does not match its range");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Receive a streamed PUT's body into an unpublished file (blocking)
+ * 
+ * @return 0 with put ready for put_commit_reply(), -1 if the request
+ *         failed (answered, or the connection was aborted)
+ */
+static int put_receive(objm_connection_t *conn, const objm_request_t *req,
+                       object_put_t *put, uint64_t *received) {
+    put_begin(conn, req, put);
+    
+    if (objm_recv_body(conn, put->fd, put_body_mode(req), received) < 0) {
+        /* Nothing was published: the old version stays */
+        if (put->fd >= 0) backend_put_abort(put);
+        stream_abort(conn);
+        return -1;
+    }
+    
+    return put_check_received(conn, req, put, *received);
+}
+
+/**
+ * Publish a received PUT body and acknowledge it (takes put)
+ * 
+ * A persistent object syncs its data here and then waits for a group
+ * commit round, so this runs in the slow-path pool rather than on the
+ * thread that read the body (see put_commit_submit()).
+ */
+static int put_commit_reply(objm_connection_t *conn, const objm_request_t *req,
+                            object_put_t *put, uint64_t received) {
+    bool part = (req->flags & OBJM_REQ_RANGE) != 0;
+    bool ephemeral = (req->flags & OBJM_REQ_PRIORITY) != 0;
+    
+    /* Unlike FD pass, the server saw every byte: the size is exact */
+    if (backend_put_commit(g_backend_mgr, put, received) < 0) {
+        bool misfit = part && errno == EINVAL;
+        objm_server_send_error(conn, req->id,
+                              misfit ? OBJM_STATUS_INVALID_RANGE : OBJM_STATUS_STORAGE_ERROR,
+                              misfit ? "Part longer than a part, or short but not last"
+                                     : "Failed to store object");
+        return -1;
+    }
+    
+    /* A persistent object is acknowledged once its round committed */
+    if (!ephemeral && backend_durable_wait(g_backend_mgr) < 0) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_STORAGE_ERROR,
+                              "Failed to sync object");
+        return -1;
+    }
+    
+    /* Empty streamed reply acknowledges the stored body */
+    if (objm_server_send_stream(conn, req->id, -1, put_body_mode(req)) < 0) {
+        stream_abort(conn);
+        return -1;
+    }
+    
+    stats_count(COUNTER_PUTS, 1);
+    return 0;
+}
+
+/**
+ * Handle PUT request
+ * 
+ * For FD pass mode:
+ * - Create object in backend
+ * - Send our FD to client via SCM_RIGHTS
+ * - Client writes directly to FD
+ * - Client closes FD when done
+ * 
+ * For COPY/SPLICE modes the request carries OBJM_REQ_BODY and the data
+ * follows it as a chunked body, received straight into the backend FD
+ * (put_receive()) and then published (put_commit_reply()).
+ * 
+ * With OBJM_REQ_RANGE the body is one part of a multipart upload: it is
+ * stored as the chunk at range_offset (see backend_put_part_begin()), and
+ * parts of one object may be sent in parallel on several connections. A
+ * first part with OBJM_REQ_TOTAL starts a new version of that size.
+ */
+static int handle_put(objm_connection_t *conn, const objm_request_t *req) {
+    bool streamed = (req->flags & OBJM_REQ_BODY) != 0;
+    bool part = (req->flags & OBJM_REQ_RANGE) != 0;
+    
+    if (!streamed && req->mode != OBJM_MODE_FDPASS) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INVALID_REQUEST,
+                              "Streamed PUT requires OBJM_REQ_BODY");
+        return -1;
+    }
+    if (part && !streamed) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INVALID_REQUEST,
+                              "Part PUT requires OBJM_REQ_BODY");
+        return -1;
+    }
+    
+    /* A streamed body goes to an unpublished file: readers see the old
+     * version until the commit swaps the new one in */
+    if (streamed) {
+        object_put_t put;
+        uint64_t received;
+        if (put_receive(conn, req, &put, &received) < 0) return -1;
+        return put_commit_reply(conn, req, &put, received);
+    }
+    
+    object_create_req_t create_req = put_create_req(req);
+    
+    fd_ref_t ref;
+    
+    /* Create new object */
+    if (backend_create_object(g_backend_mgr, &create_req, &ref) < 0) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_STORAGE_ERROR,
+                              "Failed to create object");
         return -1;
     }
     
+    /* For FD pass mode, send the FD to client for writing */
     objm_response_t resp = {
         .request_id = req->id,
         .status = OBJM_STATUS_OK,
-        .fd = -1,
-        .content_len = count,
+        .fd = ref.fd,
+        .content_len = 0,
         .metadata = NULL,
         .metadata_len = 0,
         .error_msg = NULL
     };
     
-    int ret = objm_server_send_response(conn, &resp);
+    int ret = send_fd_response(conn, &resp, false);
+    
+    /* Release our reference (client now owns the FD for writing) */
+    fd_ref_release(&ref);
+    
+    if (ret < 0) {
+        /* Client will close FD, object remains but empty */
+        return -1;
+    }
+    
+    stats_count(COUNTER_PUTS, 1);
+    return 0;
+}
+
+/**
+ * Handle legacy GET-or-create (OBJM_OP_AUTO, FD pass mode)
+ * 
+ * One index probe resolves an existing object; only a miss goes on to
+ * create it, and the client gets the writer FD.
+ */
+static int handle_get_or_create(objm_connection_t *conn, const objm_request_t *req) {
+    object_create_req_t create_req = {
+        .uri = req->uri,
+        .backend_id = -1,  /* Auto-select */
+        .ephemeral = (req->flags & OBJM_REQ_PRIORITY) ? true : false,
+        .size_hint = 0,
+        .flags = 0
+    };
+    
+    bool created;
+    int fd = backend_get_or_create_object_fd(g_backend_mgr, &create_req, &created);
+    if (fd < 0) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_STORAGE_ERROR,
+                              "Failed to create object");
+        return -1;
+    }
+    
+    objm_response_t resp = {
+        .request_id = req->id,
+        .status = OBJM_STATUS_OK,
+        .fd = fd,
+        .content_len = 0,
+        .metadata = NULL,
+        .metadata_len = 0,
+        .error_msg = NULL
+    };
+    
+    int ret = send_fd_response(conn, &resp, true);
+    
+    if (ret < 0) {
+        return -1;
+    }
+    
+    stats_count(created ? COUNTER_PUTS : COUNTER_GETS, 1);
+    return 0;
+}
+
+/**
+ * Answer a STAT with an object's validators, or its lookup's error
+ */
+static int send_stat_reply(objm_connection_t *conn, const objm_request_t *req,
+                           uint8_t status, const object_validators_t *v,
+                           const index_entry_info_t *info) {
+    if (status != OBJM_STATUS_OK) {
+        objm_server_send_error(conn, req->id, status,
+                              status == OBJM_STATUS_NOT_FOUND ? "Object not found"
+                                                              : "Failed to stat object");
+        return -1;
+    }
+    
+    uint8_t meta[64];
+    size_t meta_len = validators_metadata(meta, 0, v, true);
+    meta_len = objm_metadata_add_backend(meta, meta_len, info->backend_id);
+    
+    objm_response_t resp = {
+        .request_id = req->id,
+        .status = OBJM_STATUS_OK,
+        .fd = -1,
+        .content_len = OBJM_CONTENT_NONE,
+        .metadata = meta,
+        .metadata_len = meta_len,
+        .error_msg = NULL
+    };
+    
+    return objm_server_send_response(conn, &resp);
+}
+
+/**
+ * Handle STAT request
+ * 
+ * Replies with size, mtime, ETag and backend as metadata; no FD, no body.
+ * The index answers unless an FD writer still owns the object or it is
+ * stored compressed (its plain size is in the file's header).
+ */
+static int handle_stat(objm_connection_t *conn, const objm_request_t *req) {
+    object_validators_t v;
+    index_entry_info_t info;
+    uint8_t status = object_validators(req->uri, false, &v, &info);
+    return send_stat_reply(conn, req, status, &v, &info);
+}
+
+/**
+ * Handle DELETE request
+ */
+static int handle_delete(objm_connection_t *conn, const objm_request_t *req,
+                         const char *uri) {
+    int ret = backend_delete_object(g_backend_mgr, uri);
+    
+    if (ret == 0) {
+        objm_response_t resp = {
+            .request_id = req->id,
+            .status = OBJM_STATUS_OK,
+            .fd = -1,
+            .content_len = OBJM_CONTENT_NONE,
+            .metadata = NULL,
+            .metadata_len = 0,
+            .error_msg = NULL
+        };
+        
+        if (objm_server_send_response(conn, &resp) < 0) {
+            return -1;
+        }
+        
+        stats_count(COUNTER_DELETES, 1);
+        return 0;
+    } else {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_NOT_FOUND,
+                              "Object not found");
+        return -1;
+    }
+}
+
+/* Objects read from the prefix index per LIST batch */
+#define LIST_BATCH 256
+
+/**
+ * Reply with a rendered report: passed like an object FD (FD pass mode)
+ * or streamed as a body (COPY/SPLICE)
+ */
+static int send_report(objm_connection_t *conn, const objm_request_t *req, int fd) {
+    int ret;
+    if (req->mode == OBJM_MODE_COPY || req->mode == OBJM_MODE_SPLICE) {
+        ret = objm_server_send_stream(conn, req->id, fd, req->mode);
+        if (ret < 0) stream_abort(conn);
+    } else {
+        objm_response_t resp = {
+            .request_id = req->id,
+            .status = OBJM_STATUS_OK,
+            .fd = fd,
+            .content_len = 0,
+            .metadata = NULL,
+            .metadata_len = 0,
+            .error_msg = NULL
+        };
+        ret = objm_server_send_response(conn, &resp);
+    }
+    close(fd);
+    return ret;
+}
+
+/**
+ * Handle LIST request
+ * 
+ * The URI is a prefix ("/" lists everything); legacy "/list" lists
+ * everything and "/backend/<id>" one backend's objects. The objects come
+ * from the prefix index in batches, a "size mtime backend uri" line each,
+ * and are written to a memfd as they come: no list of every URI is built.
+ */
+static int handle_list(objm_connection_t *conn, const objm_request_t *req) {
+    const char *prefix = req->uri;
+    int backend_id = -1;
+    if (req->op == OBJM_OP_AUTO) {
+        prefix = "";
+        if (strncmp(req->uri, "/backend/", 9) == 0) backend_id = atoi(req->uri + 9);
+    }
+    
+    backend_list_t *list = backend_list_open(g_backend_mgr, prefix);
+    int fd = list ? memfd_create("objmapper-list", MFD_CLOEXEC) : -1;
+    FILE *out = (fd >= 0) ? fdopen(dup(fd), "w") : NULL;
+    if (!out) {
+        if (fd >= 0) close(fd);
+        backend_list_close(list);
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INTERNAL_ERROR,
+                              "Failed to list objects");
+        return -1;
+    }
+    
+    backend_list_item_t items[LIST_BATCH];
+    size_t n;
+    while ((n = backend_list_next(list, items, LIST_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (backend_id < 0 || items[i].info.backend_id == (uint32_t)backend_id) {
+                fprintf(out, "%llu %llu %u %s\n",
+                        (unsigned long long)items[i].info.size_bytes,
+                        (unsigned long long)items[i].info.mtime,
+                        items[i].info.backend_id, items[i].uri);
+            }
+            free(items[i].uri);
+        }
+    }
+    backend_list_close(list);
+    
+    if (fclose(out) != 0) {
+        close(fd);
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INTERNAL_ERROR,
+                              "Failed to list objects");
+        return -1;
+    }
+    return send_report(conn, req, fd);
+}
+
+/**
+ * Handle PURGE request
+ * 
+ * Deletes every object whose URI starts with the request URI, in batches;
+ * lookups and other requests carry on meanwhile. The reply carries the
+ * number of objects deleted as OBJM_META_COUNT.
+ */
+static int handle_purge(objm_connection_t *conn, const objm_request_t *req) {
+    size_t purged;
+    if (backend_purge_prefix(g_backend_mgr, req->uri, &purged) < 0) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INTERNAL_ERROR,
+                              "Purge failed");
+        return -1;
+    }
+    stats_count(COUNTER_DELETES, purged);
+    
+    uint8_t meta[16];
+    objm_response_t resp = {
+        .request_id = req->id,
+        .status = OBJM_STATUS_OK,
+        .fd = -1,
+        .content_len = OBJM_CONTENT_NONE,
+        .metadata = meta,
+        .metadata_len = objm_metadata_add_count(meta, 0, purged),
+        .error_msg = NULL
+    };
+    return objm_server_send_response(conn, &resp);
+}
+
+/**
+ * Handle STATS request
+ * 
+ * The report is rendered into a memfd, which is passed like an object FD
+ * (FD pass mode) or streamed as a body (COPY/SPLICE).
+ */
+static int handle_server_stats(objm_connection_t *conn, const objm_request_t *req) {
+    int fd = memfd_create("objmapper-stats", MFD_CLOEXEC);
+    FILE *out = (fd >= 0) ? fdopen(dup(fd), "w") : NULL;
+    if (!out) {
+        if (fd >= 0) close(fd);
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INTERNAL_ERROR,
+                              "Failed to render statistics");
+        return -1;
+    }
+    stats_report(out);
+    fclose(out);
+    
+    return send_report(conn, req, fd);
+}
+
+/* ============================================================================
+ * Request Dispatch
+ * ============================================================================ */
+
+/* Would the reply to this request carry a descriptor? */
+static bool request_passes_fd(const objm_request_t *req) {
+    if (req->mode != OBJM_MODE_FDPASS) return false;
+    if (req->num_uris > 0) return true;
+    
+    switch (req->op) {
+    case OBJM_OP_DELETE:
+    case OBJM_OP_STAT:
+    case OBJM_OP_PURGE:
+        return false;
+    default:
+        return true;
+    }
+}
+
+/**
+ * Route one request to its handler
+ * 
+ * Shared by the thread-per-connection and event-driven cores.
+ */
+static void dispatch_request(objm_connection_t *conn, objm_request_t *req,
+                             bool can_pass_fds) {
+    uint64_t start = stats_clock();
+    stats_count(COUNTER_REQUESTS, 1);
+    
+    int ret;
+    
+    /* A TCP peer would get the reply without its descriptor: refuse
+     * before a handler opens or creates anything */
+    if (!can_pass_fds && request_passes_fd(req)) {
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INVALID_MODE,
+                              "FD pass requires a Unix socket");
+        ret = -1;
+        goto done;
+    }
+    
+    if (req->num_uris > 0) {
+        /* Multi-GET: read-only, never falls through to PUT */
+        ret = handle_multi_get(conn, req);
+        goto done;
+    }
+    
+    switch (req->op) {
+    case OBJM_OP_GET:
+        ret = handle_get(conn, req);
+        break;
+    case OBJM_OP_PUT:
+        ret = handle_put(conn, req);
+        break;
+    case OBJM_OP_DELETE:
+        ret = handle_delete(conn, req, req->uri);
+        break;
+    case OBJM_OP_STAT:
+        ret = handle_stat(conn, req);
+        break;
+    case OBJM_OP_LIST:
+        ret = handle_list(conn, req);
+        break;
+    case OBJM_OP_STATS:
+        ret = handle_server_stats(conn, req);
+        break;
+    case OBJM_OP_PURGE:
+        ret = handle_purge(conn, req);
+        break;
+    case OBJM_OP_AUTO:
+        /* V1 and legacy V2 clients: the operation is implied by the URI
+         * and, for FD pass, by whether the object exists */
+        if (req->flags & OBJM_REQ_BODY) {
+            /* Streamed PUT: the body follows, whether or not the URI exists */
+            ret = handle_put(conn, req);
+        } else if (strncmp(req->uri, "/delete/", 8) == 0) {
+            ret = handle_delete(conn, req, req->uri + 7);  /* Keep the '/' */
+        } else if (strcmp(req->uri, "/list") == 0 ||
+                   strncmp(req->uri, "/backend/", 9) == 0) {
+            ret = handle_list(conn, req);
+        } else if (req->mode == OBJM_MODE_FDPASS) {
+            ret = handle_get_or_create(conn, req);
+        } else {
+            /* Streamed modes only create with OBJM_REQ_BODY */
+            ret = handle_get(conn, req);
+        }
+        break;
+    default:
+        objm_server_send_error(conn, req->id, OBJM_STATUS_INVALID_REQUEST,
+                              "Unknown operation");
+        ret = -1;
+        break;
+    }
+    
+done:
+    if (ret < 0) {
+        stats_count(COUNTER_ERRORS, 1);
+    }
+    stats_record(STAGE_REQUEST, start);
+}
+
+/* ============================================================================
+ * Pipelined Dispatch (V2 out-of-order replies)
+ * ============================================================================
+ *
+ * Requests are read in order. Memory-tier hits, misses and mutations are
+ * answered inline; on connections that negotiated OBJM_CAP_OOO_REPLIES,
+ * lookups that would hit a slow device go to a shared pool of blocking
+ * workers and are answered (by request ID) whenever they finish, so one
+ * cold disk GET does not hold up the hits queued behind it.
+ *
+ * Backpressure: at most `depth` offloaded requests per connection. When
+ * the limit is reached the connection stops reading (epoll interest is
+ * dropped, or the connection thread waits) until a slot frees up.
+ * OBJM_REQ_ORDERED requests and CLOSE wait for everything in flight.
+ * A persistent PUT's commit always runs in the pool; where replies must
+ * stay in order, the connection reads nothing else until it is answered.
+ */
+
+/**
+ * Per-connection state
+ * 
+ * A few hundred bytes plus the protocol receive buffer, instead of a
+ * thread stack per client. Thread-per-connection mode uses it too, with
+ * epoll_fd = -1.
+ */
+typedef struct event_conn {
+    int fd;
+    int doorbell_fd;                 /* Shared-memory ring's eventfd (-1 = none) */
+    int space_fd;                    /* Its space doorbell (-1 = none) */
+    bool can_pass_fds;               /* Unix socket (not TCP) */
+    objm_connection_t *conn;
+    objm_params_t params;
+    bool handshake_done;
+    struct event_conn *prev;         /* Worker connection list */
+    struct event_conn *next;
+    
+    /* Lifetime: owner + one reference per offloaded request */
+    atomic_int refs;
+    
+    /* Pipeline state (lock) */
+    pthread_mutex_t lock;
+    pthread_cond_t slot_freed;       /* Thread mode: a stall may have cleared */
+    int epoll_fd;                    /* Owning worker's epoll (-1 = none) */
+    unsigned in_flight;              /* Offloaded, not yet answered */
+    unsigned depth;                  /* Negotiated in-flight limit */
+    bool paused;                     /* Read interest dropped */
+    bool rearmed;                    /* EPOLLOUT armed to resume the worker */
+    bool want_write;                 /* Replies queued: EPOLLOUT armed to flush */
+    bool closing;                    /* Worker side: closes once replies are out */
+    bool close_pending;              /* CLOSE received, draining */
+    bool serial;                     /* In-order pooled commit: drain first */
+    objm_request_t *held;            /* ORDERED request waiting for drain */
+    struct slow_job *body;           /* Worker side: PUT whose body is arriving */
+} event_conn_t;
+
+typedef struct slow_job {
+    event_conn_t *ec;
+    objm_request_t *req;
+    int fd;                          /* Opened by the io_uring engine, or -1 */
+    index_entry_info_t info;         /* What fd reads */
+    uint64_t start;                  /* Engine GETs and PUTs: submit time for STAGE_REQUEST */
+    object_put_t put;                /* Received PUT body to commit (fd -1 = none) */
+    uint64_t received;               /* Its size */
+    struct slow_job *next;
+} slow_job_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    slow_job_t *head;
+    slow_job_t *tail;
+    bool stop;
+    pthread_t threads[MAX_SLOW_WORKERS];
+    int num_threads;
+} g_slow_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static event_conn_t *conn_create(int fd) {
+    event_conn_t *ec = calloc(1, sizeof(*ec));
+    if (!ec) return NULL;
+    
+    ec->fd = fd;
+    ec->doorbell_fd = -1;
+    ec->space_fd = -1;
+    ec->conn = objm_server_create(fd);
+    if (!ec->conn) {
+        free(ec);
+        return NULL;
+    }
+    
+    int domain = AF_UNIX;
+    socklen_t domain_len = sizeof(domain);
+    getsockopt(fd, SOL_SOCKET, SO_DOMAIN, &domain, &domain_len);
+    ec->can_pass_fds = (domain == AF_UNIX);
+    
+    atomic_init(&ec->refs, 1);
+    pthread_mutex_init(&ec->lock, NULL);
+    pthread_cond_init(&ec->slot_freed, NULL);
+    ec->epoll_fd = -1;
+    ec->depth = 1;
+    
+    atomic_fetch_add(&g_active_connections, 1);
+    return ec;
+}
+
+static void conn_get(event_conn_t *ec) {
+    atomic_fetch_add(&ec->refs, 1);
+}
+
+/**
+ * Drop a reference; the last one closes the socket
+ * 
+ * The socket outlives its owner while offloaded replies are pending, so
+ * its FD number cannot be reused under a worker that is still sending.
+ */
+static void conn_put(event_conn_t *ec) {
+    if (atomic_fetch_sub(&ec->refs, 1) != 1) return;
+    
+    if (ec->held) objm_request_free(ec->held);
+    objm_server_destroy(ec->conn);
+    close(ec->fd);
+    pthread_cond_destroy(&ec->slot_freed);
+    pthread_mutex_destroy(&ec->lock);
+    free(ec);
+    
+    atomic_fetch_sub(&g_active_connections, 1);
+}
+
+/**
+ * Record negotiated parameters after the handshake
+ */
+static void conn_set_params(event_conn_t *ec) {
+    unsigned depth = ec->params.max_pipeline;
+    if (depth == 0) depth = 1;
+    if (depth > SERVER_MAX_PIPELINE) depth = SERVER_MAX_PIPELINE;
+    ec->depth = depth;
+    
+    printf("Client connected (V%d", ec->params.version);
+    if (ec->params.capabilities & OBJM_CAP_OOO_REPLIES) {
+        printf(", pipeline %u, out-of-order", depth);
+    }
+    if (ec->params.capabilities & OBJM_CAP_SHM_RING) {
+        printf(", shared-memory ring");
+    }
+    printf(")\n");
+}
+
+/**
+ * Whether the connection may take its next request (lock held)
+ */
+static bool pipeline_ready_locked(const event_conn_t *ec) {
+    /* A client that does not read its replies gets no more */
+    if (objm_server_pending(ec->conn) >= SERVER_OUTPUT_HIGH_WATER) return false;
+    if (ec->held || ec->close_pending || ec->serial) return ec->in_flight == 0;
+    return ec->in_flight < ec->depth;
+}
+
+/**
+ * Set epoll interest for a worker-owned connection (lock held)
+ */
+static void pipeline_arm_locked(event_conn_t *ec, uint32_t events) {
+    if (ec->epoll_fd < 0) return;
+    
+    /* Queued replies need room; a closing connection waits for nothing else */
+    if (ec->closing) events = 0;
+    else events |= EPOLLRDHUP;
+    if (ec->want_write) events |= EPOLLOUT;
+    
+    struct epoll_event ev = { .events = events, .data.ptr = ec };
+    epoll_ctl(ec->epoll_fd, EPOLL_CTL_MOD, ec->fd, &ev);
+}
+
+/**
+ * Worker side: check for a stall before taking the next request
+ * 
+ * @return true if the connection may proceed, false if it is now paused
+ */
+static bool pipeline_try_proceed(event_conn_t *ec) {
+    pthread_mutex_lock(&ec->lock);
+    
+    bool ready = pipeline_ready_locked(ec);
+    if (!ready && !ec->paused) {
+        /* Stop reading; a completing request re-arms us */
+        ec->paused = true;
+        ec->rearmed = false;
+        pipeline_arm_locked(ec, 0);
+    } else if (ready && ec->rearmed) {
+        ec->rearmed = false;
+        pipeline_arm_locked(ec, EPOLLIN);
+    }
+    
+    pthread_mutex_unlock(&ec->lock);
+    return ready;
+}
+
+/**
+ * Thread side: wait until the connection may take its next request
+ */
+static void pipeline_wait(event_conn_t *ec) {
+    pthread_mutex_lock(&ec->lock);
+    while (!pipeline_ready_locked(ec)) {
+        pthread_cond_wait(&ec->slot_freed, &ec->lock);
+    }
+    pthread_mutex_unlock(&ec->lock);
+}
+
+/**
+ * An offloaded request has been answered
+ */
+static void pipeline_complete(event_conn_t *ec) {
+    pthread_mutex_lock(&ec->lock);
+    
+    ec->in_flight--;
+    if (ec->in_flight == 0) ec->serial = false;
+    if (ec->paused && pipeline_ready_locked(ec)) {
+        /* EPOLLOUT fires at once on a writable socket, waking the worker
+         * even when the requests it still has to parse are already
+         * buffered in userspace */
+        ec->paused = false;
+        ec->rearmed = true;
+        pipeline_arm_locked(ec, EPOLLIN | EPOLLOUT);
+    }
+    pthread_cond_broadcast(&ec->slot_freed);
+    
+    pthread_mutex_unlock(&ec->lock);
+}
+
+/**
+ * Send queued replies, watching for room (EPOLLOUT) while some remain
+ * 
+ * Ring replies that do not fit wait for the space doorbell instead, which
+ * stays registered. Also resumes a pipeline paused on
+ * SERVER_OUTPUT_HIGH_WATER once the queue has drained below it.
+ * 
+ * @return 0 if nothing waits for the socket, OBJM_AGAIN if replies do,
+ *         -1 on error
+ */
+static int conn_flush(event_conn_t *ec) {
+    pthread_mutex_lock(&ec->lock);
+    
+    int ret = objm_server_flush(ec->conn);
+    bool want_write = (ret == OBJM_AGAIN);
+    bool resume = ec->paused && !ec->closing && pipeline_ready_locked(ec);
+    if (resume) {
+        ec->paused = false;
+        ec->rearmed = true;
+    }
+    if (resume || want_write != ec->want_write) {
+        ec->want_write = want_write;
+        uint32_t events = ec->paused ? 0 : EPOLLIN;
+        if (ec->rearmed) events |= EPOLLOUT;
+        pipeline_arm_locked(ec, events);
+    }
+    
+    pthread_mutex_unlock(&ec->lock);
+    return ret;
+}
+
+/**
+ * Reply to a GET whose object the io_uring engine opened (takes fd)
+ */
+static void aio_get_reply(event_conn_t *ec, const objm_request_t *req, int fd,
+                          const index_entry_info_t *info, uint64_t start) {
+    stats_count(COUNTER_REQUESTS, 1);
+    if (send_get_reply(ec->conn, req, fd, info, OBJM_ENCODING_IDENTITY) < 0) {
+        stats_count(COUNTER_ERRORS, 1);
+    }
+    stats_record(STAGE_REQUEST, start);
+}
+
+/**
+ * Publish and acknowledge a PUT body the socket's worker received
+ */
+static void put_commit_job(slow_job_t *job) {
+    if (put_commit_reply(job->ec->conn, job->req, &job->put, job->received) < 0) {
+        stats_count(COUNTER_ERRORS, 1);
+    }
+    stats_record(STAGE_REQUEST, job->start);
+}
+
+/**
+ * An offloaded job has been answered: release everything it held
+ */
+static void slow_job_finish(slow_job_t *job) {
+    objm_request_free(job->req);
+    conn_flush(job->ec);  /* A failure shows up as a hangup on the worker */
+    pipeline_complete(job->ec);
+    conn_put(job->ec);
+    free(job);
+}
+
+static void *slow_worker_thread(void *arg) {
+    (void)arg;
+    
+    pthread_mutex_lock(&g_slow_pool.lock);
+    while (!g_slow_pool.stop) {
+        slow_job_t *job = g_slow_pool.head;
+        if (!job) {
+            pthread_cond_wait(&g_slow_pool.cond, &g_slow_pool.lock);
+            continue;
+        }
+        
+        g_slow_pool.head = job->next;
+        if (!g_slow_pool.head) g_slow_pool.tail = NULL;
+        pthread_mutex_unlock(&g_slow_pool.lock);
+        
+        if (job->fd >= 0) {
+            aio_get_reply(job->ec, job->req, job->fd, &job->info, job->start);
+        } else if (job->put.fd >= 0) {
+            put_commit_job(job);
+        } else {
+            dispatch_request(job->ec->conn, job->req, job->ec->can_pass_fds);
+        }
+        slow_job_finish(job);
+        
+        pthread_mutex_lock(&g_slow_pool.lock);
+    }
+    pthread_mutex_unlock(&g_slow_pool.lock);
+    
+    return NULL;
+}
+
+static int slow_pool_start(int num_threads) {
+    if (num_threads > MAX_SLOW_WORKERS) num_threads = MAX_SLOW_WORKERS;
+    
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&g_slow_pool.threads[i], NULL, slow_worker_thread, NULL) != 0) {
+            perror("pthread_create");
+            break;
+        }
+        g_slow_pool.num_threads++;
+    }
+    
+    if (g_slow_pool.num_threads > 0) {
+        printf("Slow-path pool: %d workers for out-of-order lookups\n",
+               g_slow_pool.num_threads);
+    }
+    return 0;
+}
+
+static void slow_pool_stop(void) {
+    pthread_mutex_lock(&g_slow_pool.lock);
+    g_slow_pool.stop = true;
+    pthread_cond_broadcast(&g_slow_pool.cond);
+    pthread_mutex_unlock(&g_slow_pool.lock);
+    
+    for (int i = 0; i < g_slow_pool.num_threads; i++) {
+        pthread_join(g_slow_pool.threads[i], NULL);
+    }
+    g_slow_pool.num_threads = 0;
+    
+    /* Drop what never ran; the connections are going away */
+    while (g_slow_pool.head) {
+        slow_job_t *job = g_slow_pool.head;
+        g_slow_pool.head = job->next;
+        if (job->fd >= 0) close(job->fd);
+        if (job->put.fd >= 0) backend_put_abort(&job->put);
+        slow_job_finish(job);
+    }
+    g_slow_pool.tail = NULL;
+}
+
+/**
+ * Take a pipeline slot and a connection reference for an offloaded request
+ * 
+ * @return Job owning req, or NULL (run it inline)
+ */
+static slow_job_t *slow_job_create(event_conn_t *ec, objm_request_t *req) {
+    slow_job_t *job = malloc(sizeof(*job));
+    if (!job) return NULL;
+    
+    pthread_mutex_lock(&ec->lock);
+    ec->in_flight++;
+    pthread_mutex_unlock(&ec->lock);
+    conn_get(ec);
+    
+    job->ec = ec;
+    job->req = req;
+    job->fd = -1;
+    job->start = 0;
+    job->put = (object_put_t){ .fd = -1 };
+    job->received = 0;
+    job->next = NULL;
+    return job;
+}
+
+/**
+ * Give back a job that was never queued (req goes back to the caller)
+ */
+static void slow_job_cancel(slow_job_t *job) {
+    pthread_mutex_lock(&job->ec->lock);
+    job->ec->in_flight--;
+    pthread_mutex_unlock(&job->ec->lock);
+    conn_put(job->ec);
+    free(job);
+}
+
+static void slow_pool_enqueue(slow_job_t *job) {
+    pthread_mutex_lock(&g_slow_pool.lock);
+    if (g_slow_pool.tail) g_slow_pool.tail->next = job;
+    else g_slow_pool.head = job;
+    g_slow_pool.tail = job;
+    pthread_cond_signal(&g_slow_pool.cond);
+    pthread_mutex_unlock(&g_slow_pool.lock);
+}
+
+/**
+ * Queue a request on the slow-path pool
+ * 
+ * @return 0 if queued (the pool owns req), -1 to run it inline
+ */
+static int slow_pool_submit(event_conn_t *ec, objm_request_t *req) {
+    if (g_slow_pool.num_threads == 0) return -1;
+    
+    slow_job_t *job = slow_job_create(ec, req);
+    if (!job) return -1;
+    
+    slow_pool_enqueue(job);
+    return 0;
+}
+
+/**
+ * Whether a received PUT body is committed in the pool
+ * 
+ * The data sync and the group commit round that follow a persistent PUT
+ * would hold up every other connection of an epoll worker. An ephemeral
+ * PUT never waits for a round.
+ */
+static bool put_pooled(const objm_request_t *req) {
+    return g_slow_pool.num_threads > 0 && !(req->flags & OBJM_REQ_PRIORITY);
+}
+
+/**
+ * Commit a received PUT body in the pool, or inline if it cannot block
+ * 
+ * Without out-of-order replies, and for an ORDERED PUT, the connection
+ * reads nothing more until the commit is answered, so its replies stay
+ * in order while the worker serves its other connections.
+ */
+static void put_commit_submit(slow_job_t *job) {
+    event_conn_t *ec = job->ec;
+    if (!put_pooled(job->req)) {
+        put_commit_job(job);
+        slow_job_finish(job);
+        return;
+    }
+    
+    if (!(ec->params.capabilities & OBJM_CAP_OOO_REPLIES) ||
+        (job->req->flags & OBJM_REQ_ORDERED)) {
+        pthread_mutex_lock(&ec->lock);
+        ec->serial = true;
+        pthread_mutex_unlock(&ec->lock);
+    }
+    slow_pool_enqueue(job);
+}
+
+/**
+ * Start a streamed PUT on an epoll worker (takes req)
+ * 
+ * Its body is received as the socket delivers it (put_body_continue()),
+ * ahead of anything else the connection sent; the worker never waits for
+ * it.
+ * 
+ * @return 0 if started, -1 if out of memory
+ */
+static int put_body_begin(event_conn_t *ec, objm_request_t *req) {
+    slow_job_t *job = slow_job_create(ec, req);
+    if (!job) return -1;
+    job->start = stats_clock();
+    stats_count(COUNTER_REQUESTS, 1);
+    
+    put_begin(ec->conn, req, &job->put);
+    ec->body = job;
+    return 0;
+}
+
+/**
+ * Receive what has arrived of a PUT's body; commit it once complete
+ * 
+ * @return 0 once the body is in, OBJM_AGAIN if more must arrive, -1 to
+ *         close the connection
+ */
+static int put_body_continue(event_conn_t *ec) {
+    slow_job_t *job = ec->body;
+    int ret = objm_server_try_recv_body(ec->conn, job->put.fd,
+                                        put_body_mode(job->req), &job->received);
+    if (ret == OBJM_AGAIN) return OBJM_AGAIN;
+    ec->body = NULL;
+    
+    if (ret == 0 &&
+        put_check_received(ec->conn, job->req, &job->put, job->received) == 0) {
+        put_commit_submit(job);
+        return 0;
+    }
+    
+    /* Nothing was published: the old version stays */
+    if (ret < 0 && job->put.fd >= 0) backend_put_abort(&job->put);
+    stats_count(COUNTER_ERRORS, 1);
+    stats_record(STAGE_REQUEST, job->start);
+    slow_job_finish(job);
+    return ret < 0 ? -1 : 0;
+}
+
+/**
+ * Receive a streamed PUT's body and commit it off the reading path
+ * 
+ * Only the thread reading the socket may consume the body. An epoll
+ * worker takes it in as it arrives; a connection thread receives it here
+ * and leaves a pooled commit to the pool.
+ * 
+ * @return 0 if handled (started, queued, or failed and answered), -1 to
+ *         run it inline
+ */
+static int put_submit(event_conn_t *ec, objm_request_t *req) {
+    if (req->num_uris > 0) return -1;
+    if (req->op != OBJM_OP_PUT && req->op != OBJM_OP_AUTO) return -1;
+    if (ec->epoll_fd >= 0) {
+        if (put_body_begin(ec, req) == 0) return 0;
+        
+        /* The body cannot be skipped without its state: drop the connection */
+        stats_count(COUNTER_ERRORS, 1);
+        stream_abort(ec->conn);
+        objm_request_free(req);
+        return 0;
+    }
+    if (!put_pooled(req)) return -1;
+    
+    slow_job_t *job = slow_job_create(ec, req);
+    if (!job) return -1;
+    job->start = stats_clock();
+    stats_count(COUNTER_REQUESTS, 1);
+    
+    if (put_receive(ec->conn, req, &job->put, &job->received) < 0) {
+        stats_count(COUNTER_ERRORS, 1);
+        stats_record(STAGE_REQUEST, job->start);
+        slow_job_finish(job);
+        return 0;
+    }
+    
+    put_commit_submit(job);
+    return 0;
+}
+
+/**
+ * Engine completion (reaper thread): answer FD pass GETs here
+ * 
+ * Streamed bodies go to the slow-path pool with the FD, so a slow reader
+ * cannot hold up the ring. A failed open is retried through the normal
+ * dispatch there: the object may have moved, vanished or, for a legacy
+ * get-or-create, need creating.
+ */
+static void aio_get_done(void *arg, const backend_aio_result_t *result) {
+    slow_job_t *job = arg;
+    bool pooled = g_slow_pool.num_threads > 0;
+    
+    if (result->fd >= 0) {
+        if (g_latency_enabled) stats_record_ns(STAGE_OPEN, result->info.open_ns);
+        if (job->req->mode == OBJM_MODE_FDPASS || !pooled) {
+            aio_get_reply(job->ec, job->req, result->fd, &result->info, job->start);
+            slow_job_finish(job);
+            return;
+        }
+        job->fd = result->fd;
+        job->info = result->info;
+    }
+    
+    if (pooled) {
+        slow_pool_enqueue(job);
+        return;
+    }
+    dispatch_request(job->ec->conn, job->req, job->ec->can_pass_fds);
+    slow_job_finish(job);
+}
+
+/**
+ * Whether a request is a plain single-object read the engine can open
+ */
+static bool request_is_aio_get(const event_conn_t *ec, const objm_request_t *req) {
+    if (req->num_uris > 0 || (req->flags & (OBJM_REQ_BODY | OBJM_REQ_RANGE))) return false;
+    if (req->mode == OBJM_MODE_FDPASS && !ec->can_pass_fds) return false;
+    
+    if (req->op == OBJM_OP_GET) return true;
+    return req->op == OBJM_OP_AUTO && req->mode == OBJM_MODE_FDPASS &&
+           strncmp(req->uri, "/delete/", 8) != 0 && strcmp(req->uri, "/list") != 0 &&
+           strncmp(req->uri, "/backend/", 9) != 0;
+}
+
+/**
+ * Open a cold persistent-tier object through the io_uring engine
+ * 
+ * Epoll workers batch their submissions until the end of an event loop
+ * pass; thread-per-connection readers submit at once.
+ * 
+ * @return 0 if queued (the engine owns req), -1 otherwise
+ */
+static int aio_submit(event_conn_t *ec, objm_request_t *req) {
+    if (!g_aio || !request_is_aio_get(ec, req)) return -1;
+    
+    slow_job_t *job = slow_job_create(ec, req);
+    if (!job) return -1;
+    job->start = stats_clock();
+    
+    unsigned flags = (req->mode != OBJM_MODE_FDPASS) ? BACKEND_AIO_WARM : 0;
+    if (ec->epoll_fd >= 0) flags |= BACKEND_AIO_MORE;
+    
+    if (backend_aio_open(g_aio, req->uri, flags, aio_get_done, job) < 0) {
+        slow_job_cancel(job);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Whether every object a request touches can be served without blocking
+ */
+static bool request_is_fast(const objm_request_t *req) {
+    /* Listings and purges walk many objects */
+    if (req->op == OBJM_OP_LIST || req->op == OBJM_OP_PURGE) return false;
+    if (req->num_uris == 0) {
+        return backend_object_is_fast(g_backend_mgr, req->uri);
+    }
+    for (size_t i = 0; i < req->num_uris; i++) {
+        if (!backend_object_is_fast(g_backend_mgr, req->uris[i])) return false;
+    }
+    return true;
+}
+
+/**
+ * Answer a request from the index alone: a STAT it can describe, or a
+ * conditional GET for an unchanged object
+ * 
+ * Neither opens anything, so both are answered inline whatever tier the
+ * object is on. The validators of the one lookup that decides it go
+ * straight into the reply.
+ * 
+ * @return true if answered (req stays the caller's), false to dispatch it
+ */
+static bool index_only_reply(const event_conn_t *ec, const objm_request_t *req) {
+    if (req->num_uris > 0) return false;
+    if (req->op != OBJM_OP_STAT &&
+        !(req->op == OBJM_OP_GET && (req->flags & OBJM_REQ_CONDITIONAL))) return false;
+    if (!ec->can_pass_fds && request_passes_fd(req)) return false;  /* Refused there */
+    
+    uint64_t start = stats_clock();
+    object_validators_t v;
+    index_entry_info_t info;
+    int ret;
+    if (req->op == OBJM_OP_STAT) {
+        int found = validators_from_index(req->uri, false, &v, &info);
+        if (found == 1) return false;
+        stats_count(COUNTER_REQUESTS, 1);
+        ret = send_stat_reply(ec->conn, req,
+                              found < 0 ? OBJM_STATUS_NOT_FOUND : OBJM_STATUS_OK,
+                              &v, &info);
+    } else {
+        bool encoded = reply_may_encode(ec->conn, req);
+        if (validators_from_index(req->uri, encoded, &v, &info) != 0 ||
+            !request_not_modified(req, &v)) return false;
+        stats_count(COUNTER_REQUESTS, 1);
+        ret = send_not_modified(ec->conn, req, &v);
+    }
+    
+    if (ret < 0) stats_count(COUNTER_ERRORS, 1);
+    stats_record(STAGE_REQUEST, start);
+    return true;
+}
+
+/**
+ * Run or queue one received request (takes ownership of req)
+ */
+static void pipeline_submit(event_conn_t *ec, objm_request_t *req) {
+    if (ec->params.capabilities & OBJM_CAP_OOO_REPLIES) {
+        if (req->flags & OBJM_REQ_ORDERED) {
+            pthread_mutex_lock(&ec->lock);
+            bool drained = (ec->in_flight == 0);
+            if (!drained) ec->held = req;
+            pthread_mutex_unlock(&ec->lock);
+            if (!drained) return;  /* Runs once everything before it replied */
+        } else if (req->flags & OBJM_REQ_BODY) {
+            if (put_submit(ec, req) == 0) return;
+        } else if (index_only_reply(ec, req)) {
+            /* Revalidations and STATs never wait behind a disk */
+            objm_request_free(req);
+            return;
+        } else if ((!request_is_fast(req) || req->mode != OBJM_MODE_FDPASS) &&
+                   (aio_submit(ec, req) == 0 || slow_pool_submit(ec, req) == 0)) {
+            /* Cold lookups and streamed GETs don't hold up the hits */
+            return;
+        }
+    } else if ((req->flags & OBJM_REQ_BODY) && put_submit(ec, req) == 0) {
+        return;
+    }
+    
+    dispatch_request(ec->conn, req, ec->can_pass_fds);
+    objm_request_free(req);
+}
+
+/**
+ * CLOSE received: stop taking requests until every reply is out
+ */
+static void pipeline_begin_close(event_conn_t *ec) {
+    pthread_mutex_lock(&ec->lock);
+    ec->close_pending = true;
+    pthread_mutex_unlock(&ec->lock);
+}
+
+/**
+ * Run a held ORDERED request once the pipeline has drained
+ * 
+ * @return true if one was run
+ */
+static bool pipeline_run_held(event_conn_t *ec) {
+    pthread_mutex_lock(&ec->lock);
+    objm_request_t *req = ec->held;
+    ec->held = NULL;
+    pthread_mutex_unlock(&ec->lock);
     
-    for (size_t i = 0; i < count; i++) {
-        free(uris[i]);
-    }
-    free(uris);
+    if (!req) return false;
     
-    return ret;
-    */
+    if ((req->flags & OBJM_REQ_BODY) && put_submit(ec, req) == 0) return true;
+    dispatch_request(ec->conn, req, ec->can_pass_fds);
+    objm_request_free(req);
+    return true;
 }
 
 /* ============================================================================
- * Client Connection Handler
+ * Client Connection Handler (thread-per-connection mode)
  * ============================================================================ */
 
 typedef struct {
     int client_fd;
-    struct sockaddr_un client_addr;
+    struct sockaddr_storage client_addr;
 } client_info_t;
 
 static void *client_thread(void *arg) {
@@ -280,159 +2255,520 @@ static void *client_thread(void *arg) {
     int client_fd = info->client_fd;
     free(info);
     
-    atomic_fetch_add(&g_stats.active_connections, 1);
-    
     /* Create protocol connection */
-    objm_connection_t *conn = objm_server_create(client_fd);
-    if (!conn) {
+    event_conn_t *ec = conn_create(client_fd);
+    if (!ec) {
         fprintf(stderr, "Failed to create server connection\n");
         close(client_fd);
-        atomic_fetch_sub(&g_stats.active_connections, 1);
         return NULL;
     }
     
     /* Perform handshake - will auto-detect V1 or V2 */
-    objm_hello_t hello = {
-        .capabilities = 0,  /* V1 protocol */
-        .max_pipeline = 1,
-        .backend_parallelism = 2  /* Memory + persistent */
-    };
-    
-    objm_params_t params;
-    if (objm_server_handshake(conn, &hello, &params) < 0) {
+    if (objm_server_handshake(ec->conn, &g_server_hello, &ec->params) < 0) {
         fprintf(stderr, "Handshake failed\n");
-        objm_server_destroy(conn);
-        close(client_fd);
-        atomic_fetch_sub(&g_stats.active_connections, 1);
+        conn_put(ec);
         return NULL;
     }
     
-    printf("Client connected (V%d)\n", params.version);
+    conn_set_params(ec);
     
     /* Request handling loop */
     while (g_running) {
+        pipeline_wait(ec);
+        
+        if (ec->close_pending) {
+            /* Every reply is out: safe to acknowledge */
+            objm_server_send_close_ack(ec->conn, 0);
+            break;
+        }
+        if (pipeline_run_held(ec)) continue;
+        
         objm_request_t *req = NULL;
-        int ret = objm_server_recv_request(conn, &req);
+        int ret = objm_server_recv_request(ec->conn, &req);
         
         if (ret == 1) {
             /* Clean connection close */
             printf("Client disconnected gracefully\n");
-            break;
+            pipeline_begin_close(ec);
+            continue;
         }
         
         if (ret < 0) {
             /* For V1, socket close is normal - don't treat as error */
-            if (params.version == OBJM_PROTO_V1) {
+            if (ec->params.version == OBJM_PROTO_V1) {
                 printf("Client disconnected\n");
             } else {
                 fprintf(stderr, "Error receiving request\n");
-                atomic_fetch_add(&g_stats.errors, 1);
+                stats_count(COUNTER_ERRORS, 1);
             }
             break;
         }
         
-        atomic_fetch_add(&g_stats.requests_total, 1);
+        pipeline_submit(ec, req);
+    }
+    
+    conn_put(ec);
+    
+    printf("Client connection closed\n");
+    return NULL;
+}
+
+/* ============================================================================
+ * Event-Driven Core (epoll workers)
+ * ============================================================================ */
+
+typedef struct event_worker {
+    int id;
+    int cpu;                         /* Pinned CPU (-1 = unpinned) */
+    int node;                        /* NUMA node it runs on (-1 = no tiers per node) */
+    int epoll_fd;
+    pthread_t thread;
+    
+    /* Connections owned by this worker (for shutdown) */
+    pthread_mutex_t conns_lock;
+    event_conn_t *conns;
+    atomic_size_t num_conns;
+} event_worker_t;
+
+static event_worker_t g_workers[MAX_EPOLL_WORKERS];
+static int g_num_workers = 0;
+
+static void event_conn_close(event_worker_t *w, event_conn_t *ec) {
+    /* Detach from epoll under the pipeline lock so completions stop
+     * re-arming; offloaded requests may still hold references */
+    pthread_mutex_lock(&ec->lock);
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_DEL, ec->fd, NULL);
+    if (ec->doorbell_fd >= 0) {
+        /* The client holds the same eventfd: closing ours would not
+         * drop the registration */
+        epoll_ctl(w->epoll_fd, EPOLL_CTL_DEL, ec->doorbell_fd, NULL);
+    }
+    if (ec->space_fd >= 0) {
+        epoll_ctl(w->epoll_fd, EPOLL_CTL_DEL, ec->space_fd, NULL);
+    }
+    ec->epoll_fd = -1;
+    pthread_mutex_unlock(&ec->lock);
+    shutdown(ec->fd, SHUT_RDWR);
+    
+    if (ec->body) {
+        /* Hung up mid-body: nothing was published */
+        if (ec->body->put.fd >= 0) backend_put_abort(&ec->body->put);
+        stats_count(COUNTER_ERRORS, 1);
+        slow_job_finish(ec->body);
+        ec->body = NULL;
+    }
+    
+    pthread_mutex_lock(&w->conns_lock);
+    if (ec->prev) ec->prev->next = ec->next;
+    else w->conns = ec->next;
+    if (ec->next) ec->next->prev = ec->prev;
+    pthread_mutex_unlock(&w->conns_lock);
+    
+    atomic_fetch_sub(&w->num_conns, 1);
+    conn_put(ec);
+}
+
+/**
+ * Stop reading and close once every queued reply is out
+ * 
+ * @return 0 to keep the connection until then, -1 to close it now
+ */
+static int event_conn_finish(event_conn_t *ec) {
+    if (objm_server_pending(ec->conn) == 0) return -1;
+    
+    pthread_mutex_lock(&ec->lock);
+    ec->closing = true;
+    pipeline_arm_locked(ec, 0);
+    pthread_mutex_unlock(&ec->lock);
+    return 0;
+}
+
+/**
+ * Drive one readable connection as far as buffered input allows
+ * 
+ * @return 0 to keep the connection, -1 to close it
+ */
+static int event_conn_service(event_conn_t *ec) {
+    if (ec->closing) return 0;  /* Only its replies are still moving */
+    
+    if (!ec->handshake_done) {
+        int ret = objm_server_try_handshake(ec->conn, &g_server_hello, &ec->params);
+        if (ret == OBJM_AGAIN) return 0;
+        if (ret != 0) {
+            if (ret < 0) fprintf(stderr, "Handshake failed\n");
+            return -1;
+        }
+        ec->handshake_done = true;
+        conn_set_params(ec);
+        
+        /* Ring requests ring the doorbell, not the socket. Edge-triggered:
+         * the service loop reads until the ring is empty and arms it. The
+         * space doorbell rings once a full reply ring has room again. */
+        int doorbell = objm_get_doorbell_fd(ec->conn);
+        if (doorbell >= 0) {
+            struct epoll_event ev = { .events = EPOLLIN | EPOLLET, .data.ptr = ec };
+            if (epoll_ctl(ec->epoll_fd, EPOLL_CTL_ADD, doorbell, &ev) < 0) return -1;
+            ec->doorbell_fd = doorbell;
+            
+            int space = objm_get_space_fd(ec->conn);
+            if (epoll_ctl(ec->epoll_fd, EPOLL_CTL_ADD, space, &ev) < 0) return -1;
+            ec->space_fd = space;
+        }
+    }
+    
+    /* Drain everything buffered: with level-triggered epoll, bytes already
+     * pulled into the receive buffer would not raise another event. */
+    while (g_running) {
+        if (ec->body) {
+            /* A body comes before anything sent after it */
+            int ret = put_body_continue(ec);
+            if (ret == OBJM_AGAIN) return 0;
+            if (ret < 0) return -1;
+            continue;
+        }
+        if (!pipeline_try_proceed(ec)) return 0;  /* Paused until a slot frees */
+        
+        if (ec->close_pending) {
+            if (objm_server_send_close_ack(ec->conn, 0) < 0) return -1;
+            return event_conn_finish(ec);
+        }
+        if (pipeline_run_held(ec)) continue;
+        
+        objm_request_t *req = NULL;
+        uint64_t recv_start = stats_clock();
+        int ret = objm_server_try_recv_request(ec->conn, &req);
+        
+        if (ret == OBJM_AGAIN) return 0;
+        if (ret == 0) stats_record(STAGE_RECV, recv_start);
+        
+        if (ret == 1) {
+            if (ec->params.version == OBJM_PROTO_V2) {
+                /* Acknowledge once every outstanding reply is out */
+                printf("Client disconnected gracefully\n");
+                pipeline_begin_close(ec);
+                continue;
+            }
+            printf("Client disconnected\n");
+            return event_conn_finish(ec);
+        }
+        
+        if (ret < 0) {
+            fprintf(stderr, "Error receiving request\n");
+            stats_count(COUNTER_ERRORS, 1);
+            return -1;
+        }
         
-        /* Determine operation from URI pattern
-         * - GET: URI starts with / and exists
-         * - PUT: URI starts with / and doesn't exist, or mode is FDPASS for write
-         * - DELETE: URI starts with /delete/
-         * - LIST: URI is /list or /backend/N
-         */
+        pipeline_submit(ec, req);
+    }
+    
+    return 0;
+}
+
+static void *event_worker_thread(void *arg) {
+    event_worker_t *w = (event_worker_t *)arg;
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    
+    if (w->node >= 0) {
+        /* Its allocations, reads and new objects stay on the node */
+        backend_numa_bind_thread(w->node, w->cpu);
+    } else if (w->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    
+    while (g_running) {
+        int n = epoll_wait(w->epoll_fd, events, EPOLL_MAX_EVENTS,
+                           EPOLL_WAIT_TIMEOUT_MS);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
         
-        if (strncmp(req->uri, "/delete/", 8) == 0) {
-            /* DELETE */
-            char *real_uri = req->uri + 7;  /* Skip "/delete" */
-            char uri_copy[OBJM_MAX_URI_LEN];
-            strncpy(uri_copy, real_uri, sizeof(uri_copy) - 1);
-            uri_copy[sizeof(uri_copy) - 1] = '\0';
+        for (int i = 0; i < n; i++) {
+            event_conn_t *ec = events[i].data.ptr;
+            if (!ec) continue;  /* Closed earlier in this batch */
             
-            free(req->uri);
-            req->uri = strdup(uri_copy);
+            /* Read first: a peer may send its last request and hang up.
+             * EPOLLOUT means a paused pipeline was re-armed, or that
+             * queued replies have room (the space doorbell, in a ring). */
+            uint32_t ready = events[i].events & (EPOLLIN | EPOLLOUT);
             
-            if (handle_delete(conn, req) < 0) {
-                atomic_fetch_add(&g_stats.errors, 1);
-            }
-        } else if (strcmp(req->uri, "/list") == 0 || 
-                   strncmp(req->uri, "/backend/", 9) == 0) {
-            /* LIST */
-            if (handle_list(conn, req) < 0) {
-                atomic_fetch_add(&g_stats.errors, 1);
+            /* Ring replies' FDs leave in one sendmsg after the pass */
+            objm_server_cork(ec->conn);
+            int ret = ready ? event_conn_service(ec) : -1;
+            if (objm_server_uncork(ec->conn) < 0) ret = -1;
+            
+            /* What the socket did not take waits for EPOLLOUT, what the
+             * ring did not take for its space doorbell */
+            if (ret == 0) {
+                int flushed = conn_flush(ec);
+                if (flushed < 0) ret = -1;
+                if (flushed == 0 && ec->closing &&
+                    objm_server_pending(ec->conn) == 0) ret = -1;
             }
-        } else {
-            /* GET or PUT - check if object exists */
-            fd_ref_t ref;
-            bool exists = (backend_get_object(g_backend_mgr, req->uri, &ref) == 0);
-            if (exists) {
-                fd_ref_release(&ref);
+            
+            /* A ring connection's socket only ever reports hangup */
+            bool hangup = ec->doorbell_fd >= 0 &&
+                          (events[i].events & (EPOLLRDHUP | EPOLLHUP));
+            if (ret == 0 && !hangup) {
+                continue;
             }
             
-            /* For FD pass mode:
-             * - If exists: GET (read)
-             * - If not exists: PUT (create + write)
-             * 
-             * This is a simplification. Real implementation would use:
-             * - Separate GET/PUT operations
-             * - Or flags in metadata to distinguish
-             */
+            if (!ready || (ret == 0 && hangup)) {
+                printf("Client disconnected\n");
+            }
+            event_conn_close(w, ec);
+            printf("Client connection closed\n");
             
-            if (exists) {
-                /* GET */
-                if (handle_get(conn, req) < 0) {
-                    atomic_fetch_add(&g_stats.errors, 1);
-                }
-            } else {
-                /* PUT */
-                if (handle_put(conn, req) < 0) {
-                    atomic_fetch_add(&g_stats.errors, 1);
-                }
+            /* A ring connection has three registrations: its socket and
+             * its doorbells may all be in this batch */
+            for (int j = i + 1; j < n; j++) {
+                if (events[j].data.ptr == ec) events[j].data.ptr = NULL;
             }
         }
         
-        objm_request_free(req);
+        /* Cold opens queued by this pass reach the disk together */
+        if (g_aio) backend_aio_flush(g_aio);
     }
     
-    objm_server_destroy(conn);
-    close(client_fd);
-    atomic_fetch_sub(&g_stats.active_connections, 1);
+    /* Shutdown: drop remaining connections */
+    while (w->conns) {
+        event_conn_close(w, w->conns);
+    }
     
-    printf("Client connection closed\n");
     return NULL;
 }
 
+/**
+ * Hand an accepted socket to the least loaded worker
+ */
+static int event_dispatch_accept(int client_fd) {
+    event_worker_t *w = &g_workers[0];
+    for (int i = 1; i < g_num_workers; i++) {
+        if (atomic_load(&g_workers[i].num_conns) < atomic_load(&w->num_conns)) {
+            w = &g_workers[i];
+        }
+    }
+    
+    event_conn_t *ec = conn_create(client_fd);
+    if (!ec) {
+        close(client_fd);
+        return -1;
+    }
+    
+    if (objm_server_set_nonblocking(ec->conn) < 0) {
+        conn_put(ec);
+        return -1;
+    }
+    ec->epoll_fd = w->epoll_fd;
+    
+    pthread_mutex_lock(&w->conns_lock);
+    ec->next = w->conns;
+    if (w->conns) w->conns->prev = ec;
+    w->conns = ec;
+    pthread_mutex_unlock(&w->conns_lock);
+    
+    atomic_fetch_add(&w->num_conns, 1);
+    
+    /* Registration publishes ec to the worker; nothing touches it after */
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = ec };
+    if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+        pthread_mutex_lock(&w->conns_lock);
+        if (ec->next) ec->next->prev = NULL;
+        w->conns = ec->next;
+        pthread_mutex_unlock(&w->conns_lock);
+        atomic_fetch_sub(&w->num_conns, 1);
+        conn_put(ec);
+        return -1;
+    }
+    
+    return 0;
+}
+
+/**
+ * Place worker i: node by node in turn with per-node tiers, so the least
+ * loaded worker rotates over the nodes; CPU i otherwise
+ */
+static void event_worker_place(event_worker_t *w, int i, int num_workers, long ncpu) {
+    w->node = -1;
+    w->cpu = (num_workers <= ncpu) ? i : -1;
+    if (!g_numa_nodes) return;
+    
+    int nodes[BACKEND_NUMA_MAX_NODES];
+    int num_nodes = 0;
+    for (int node = 0; node < BACKEND_NUMA_MAX_NODES; node++) {
+        if (g_numa_nodes & (1u << node)) nodes[num_nodes++] = node;
+    }
+    w->node = nodes[i % num_nodes];
+    
+    /* The (i / num_nodes)-th CPU of the node, if it has that many */
+    int rank = i / num_nodes;
+    w->cpu = -1;
+    for (long cpu = 0; cpu < ncpu; cpu++) {
+        if (backend_numa_cpu_node((int)cpu) == w->node && rank-- == 0) {
+            w->cpu = (int)cpu;
+            break;
+        }
+    }
+}
+
+static int event_workers_start(int num_workers) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 1) ncpu = 1;
+    
+    if (num_workers <= 0) num_workers = (int)ncpu;
+    if (num_workers > MAX_EPOLL_WORKERS) num_workers = MAX_EPOLL_WORKERS;
+    
+    for (int i = 0; i < num_workers; i++) {
+        event_worker_t *w = &g_workers[i];
+        w->id = i;
+        event_worker_place(w, i, num_workers, ncpu);
+        w->conns = NULL;
+        atomic_init(&w->num_conns, 0);
+        pthread_mutex_init(&w->conns_lock, NULL);
+        
+        w->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (w->epoll_fd < 0) {
+            perror("epoll_create1");
+            return -1;
+        }
+        
+        if (pthread_create(&w->thread, NULL, event_worker_thread, w) != 0) {
+            perror("pthread_create");
+            close(w->epoll_fd);
+            return -1;
+        }
+        
+        g_num_workers++;
+    }
+    
+    printf("Event-driven core: %d epoll workers%s\n", g_num_workers,
+           g_workers[0].node >= 0 ? " (pinned per NUMA node)" :
+           g_workers[0].cpu >= 0 ? " (pinned)" : "");
+    return 0;
+}
+
+static void event_workers_stop(void) {
+    for (int i = 0; i < g_num_workers; i++) {
+        pthread_join(g_workers[i].thread, NULL);
+        close(g_workers[i].epoll_fd);
+        pthread_mutex_destroy(&g_workers[i].conns_lock);
+    }
+    g_num_workers = 0;
+}
+
+/**
+ * Raise the soft fd limit so connections are bounded by fds, not threads
+ */
+static void raise_fd_limit(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
 /* ============================================================================
  * Backend Initialization
  * ============================================================================ */
 
-static int init_backends(const char *memory_path, const char *persistent_path) {
-    /* Create backend manager */
-    g_backend_mgr = backend_manager_create(8192, 2000);
-    if (!g_backend_mgr) {
-        fprintf(stderr, "Failed to create backend manager\n");
-        return -1;
+/**
+ * Restore a backend index from its image, or rebuild it from the files
+ */
+static int load_backend_index(int backend_id, const char *label) {
+    int count = backend_manager_restore(g_backend_mgr, backend_id);
+    if (count >= 0) {
+        printf("Restored %s backend index: %d objects\n", label, count);
+        return count;
     }
     
-    printf("Backend manager created (8192 buckets, 2000 max FDs)\n");
+    count = backend_manager_scan(g_backend_mgr, backend_id);
+    if (count < 0) return -1;
+    printf("Scanned %s backend: %d objects found\n", label, count);
     
-    /* Register memory backend */
-    mkdir(memory_path, 0755);
+    if (backend_manager_checkpoint(g_backend_mgr, backend_id) < 0) {
+        fprintf(stderr, "Warning: failed to save %s backend index\n", label);
+    }
+    return count;
+}
+
+/**
+ * Register a memory tier: tmpfs files, or memfds with no paths at all
+ * 
+ * A tier of a NUMA node (node >= 0) lives in its own subdirectory and has
+ * its pages placed on the node.
+ */
+static int register_memory_backend(const char *memory_path, bool anon_memory,
+                                   int node, uint64_t capacity) {
+    char path[1024];
+    char name[64];
+    if (node < 0) {
+        snprintf(path, sizeof(path), "%s", memory_path);
+        snprintf(name, sizeof(name), "Memory Cache");
+    } else {
+        snprintf(path, sizeof(path), "%s/node%d", memory_path, node);
+        snprintf(name, sizeof(name), "Memory Cache (node %d)", node);
+    }
+    if (!anon_memory) mkdir(path, 0755);
     
-    g_memory_backend_id = backend_manager_register(g_backend_mgr,
-        BACKEND_TYPE_MEMORY,
-        memory_path,
-        "Memory Cache",
-        MEMORY_CACHE_SIZE,
+    int backend_id = backend_manager_register(g_backend_mgr,
+        anon_memory ? BACKEND_TYPE_MEMFD : BACKEND_TYPE_MEMORY,
+        anon_memory ? "memfd" : path,
+        name,
+        capacity,
         BACKEND_FLAG_EPHEMERAL_ONLY | BACKEND_FLAG_ENABLED |
         BACKEND_FLAG_MIGRATION_SRC | BACKEND_FLAG_MIGRATION_DST);
     
-    if (g_memory_backend_id < 0) {
+    if (backend_id < 0) {
         fprintf(stderr, "Failed to register memory backend\n");
         return -1;
     }
+    if (node >= 0 && backend_manager_set_numa_node(g_backend_mgr, backend_id, node) < 0) {
+        fprintf(stderr, "Failed to bind memory backend to node %d\n", node);
+        return -1;
+    }
     
     printf("Registered memory backend (ID %d): %s, %.1f GB\n",
-           g_memory_backend_id, memory_path,
-           MEMORY_CACHE_SIZE / (1024.0 * 1024.0 * 1024.0));
+           backend_id, anon_memory ? "memfd" : path,
+           capacity / (1024.0 * 1024.0 * 1024.0));
+    
+    g_memory_backend_ids[g_num_memory_backends++] = backend_id;
+    return backend_id;
+}
+
+static int init_backends(const char *memory_path, const char *persistent_path,
+                         bool anon_memory, bool numa) {
+    /* Create backend manager */
+    g_backend_mgr = backend_manager_create(8192, 2000);
+    if (!g_backend_mgr) {
+        fprintf(stderr, "Failed to create backend manager\n");
+        return -1;
+    }
+    
+    printf("Backend manager created (8192 buckets, 2000 max FDs)\n");
+    
+    /* One memory tier per node, so hits read local memory; the capacity
+     * is split between them */
+    uint32_t nodes = 0;
+    int num_nodes = numa ? backend_numa_nodes(&nodes) : 1;
+    if (num_nodes > 1) {
+        if (!anon_memory) mkdir(memory_path, 0755);
+        for (int node = 0; node < BACKEND_NUMA_MAX_NODES; node++) {
+            if (!(nodes & (1u << node))) continue;
+            if (register_memory_backend(memory_path, anon_memory, node,
+                                        MEMORY_CACHE_SIZE / num_nodes) < 0) {
+                return -1;
+            }
+        }
+        g_numa_nodes = nodes;
+    } else if (register_memory_backend(memory_path, anon_memory, -1,
+                                       MEMORY_CACHE_SIZE) < 0) {
+        return -1;
+    }
+    g_memory_backend_id = g_memory_backend_ids[0];
     
     /* Register persistent backend */
     mkdir(persistent_path, 0755);
@@ -459,19 +2795,21 @@ static int init_backends(const char *memory_path, const char *persistent_path) {
     backend_manager_set_ephemeral(g_backend_mgr, g_memory_backend_id);
     backend_manager_set_cache(g_backend_mgr, g_memory_backend_id);
     
+    /* Multipart uploads send one chunk per part */
+    backend_set_chunk_size(g_backend_mgr, OBJM_PART_SIZE);
+    
     printf("Backend roles: default=%d, ephemeral=%d, cache=%d\n",
            g_persistent_backend_id, g_memory_backend_id, g_memory_backend_id);
-    
-    /* Scan backends to rebuild index from existing files */
-    int memory_count = backend_manager_scan(g_backend_mgr, g_memory_backend_id);
-    if (memory_count >= 0) {
-        printf("Scanned memory backend: %d objects found\n", memory_count);
+    if (g_numa_nodes) {
+        printf("NUMA: %d memory tiers, ephemeral objects and promotions follow the "
+               "reading node\n", g_num_memory_backends);
     }
     
-    int persistent_count = backend_manager_scan(g_backend_mgr, g_persistent_backend_id);
-    if (persistent_count >= 0) {
-        printf("Scanned persistent backend: %d objects found\n", persistent_count);
+    /* Map the saved indexes; scan (and save) only where there is none */
+    for (int i = 0; i < g_num_memory_backends && !anon_memory; i++) {
+        load_backend_index(g_memory_backend_ids[i], "memory");
     }
+    load_backend_index(g_persistent_backend_id, "persistent");
     
     /* Start automatic caching */
     if (backend_start_caching(g_backend_mgr, CACHE_CHECK_INTERVAL_US,
@@ -517,27 +2855,64 @@ static void setup_signals(void) {
  * ============================================================================ */
 
 static void print_stats(void) {
+    stats_snapshot_t *snap = malloc(sizeof(*snap));
+    if (!snap) return;
+    stats_collect(snap);
+    
     printf("\n=== Server Statistics ===\n");
-    printf("Total requests:      %zu\n", g_stats.requests_total);
-    printf("  GET:               %zu\n", g_stats.gets);
-    printf("  PUT:               %zu\n", g_stats.puts);
-    printf("  DELETE:            %zu\n", g_stats.deletes);
-    printf("  Errors:            %zu\n", g_stats.errors);
-    printf("Active connections:  %zu\n", g_stats.active_connections);
+    printf("Total requests:      %llu\n",
+           (unsigned long long)snap->counters[COUNTER_REQUESTS]);
+    printf("  GET:               %llu\n",
+           (unsigned long long)snap->counters[COUNTER_GETS]);
+    printf("    not modified:    %llu\n",
+           (unsigned long long)snap->counters[COUNTER_NOT_MODIFIED]);
+    printf("  PUT:               %llu\n",
+           (unsigned long long)snap->counters[COUNTER_PUTS]);
+    printf("  DELETE:            %llu\n",
+           (unsigned long long)snap->counters[COUNTER_DELETES]);
+    printf("  Errors:            %llu\n",
+           (unsigned long long)snap->counters[COUNTER_ERRORS]);
+    printf("Active connections:  %zu\n", atomic_load(&g_active_connections));
+    
+    if (g_latency_enabled) {
+        printf("\nLatency (us):        %10s %10s %10s %10s %10s\n",
+               "count", "p50", "p99", "p99.9", "max");
+        for (int st = 0; st < NUM_STAGES; st++) {
+            printf("  %-17s  %10llu %10.1f %10.1f %10.1f %10.1f\n", STAGE_NAMES[st],
+                   (unsigned long long)snap->stages[st].count,
+                   snapshot_percentile(snap, st, 50.0) / 1000.0,
+                   snapshot_percentile(snap, st, 99.0) / 1000.0,
+                   snapshot_percentile(snap, st, 99.9) / 1000.0,
+                   snap->stages[st].max_ns / 1000.0);
+        }
+    }
+    free(snap);
     
     if (g_backend_mgr) {
         uint64_t capacity, used;
         size_t obj_count;
         double utilization;
         
-        if (backend_get_status(g_backend_mgr, g_memory_backend_id,
-                              &capacity, &used, &obj_count, &utilization) == 0) {
+        if (memory_tier_status(&capacity, &used, &obj_count) == 0) {
             printf("\nMemory backend:\n");
             printf("  Objects:           %zu\n", obj_count);
             printf("  Used:              %.2f MB / %.2f MB\n",
                    used / (1024.0 * 1024.0),
                    capacity / (1024.0 * 1024.0));
-            printf("  Utilization:       %.1f%%\n", utilization * 100.0);
+            printf("  Utilization:       %.1f%%\n",
+                   capacity ? used * 100.0 / capacity : 0.0);
+        }
+        
+        for (int node = 0; node < BACKEND_NUMA_MAX_NODES; node++) {
+            numa_stats_t numa;
+            if (!(g_numa_nodes & (1u << node)) ||
+                backend_get_numa_stats(g_backend_mgr, node, &numa) < 0) {
+                continue;
+            }
+            printf("  Node %d:            %zu objects, %.2f MB, reads %llu local / "
+                   "%llu remote\n", node, numa.objects, numa.used_bytes / (1024.0 * 1024.0),
+                   (unsigned long long)numa.local_reads,
+                   (unsigned long long)numa.remote_reads);
         }
         
         if (backend_get_status(g_backend_mgr, g_persistent_backend_id,
@@ -552,10 +2927,77 @@ static void print_stats(void) {
     }
 }
 
+/**
+ * Periodic report (OBJMAPPER_STATS_INTERVAL seconds)
+ */
+static void *stats_dump_thread(void *arg) {
+    uint64_t interval_us = (uint64_t)(uintptr_t)arg * 1000000ULL;
+    uint64_t waited = 0;
+    
+    while (g_running) {
+        usleep(STATS_DUMP_POLL_US);
+        waited += STATS_DUMP_POLL_US;
+        if (waited < interval_us) continue;
+        waited = 0;
+        
+        flockfile(stdout);
+        printf("--- stats ---\n");
+        stats_report(stdout);
+        fflush(stdout);
+        funlockfile(stdout);
+    }
+    return NULL;
+}
+
 /* ============================================================================
  * Main Server Loop
  * ============================================================================ */
 
+/**
+ * Listen for remote cluster clients on [host:]port
+ *
+ * @return Listening socket, or -1 on error
+ */
+static int open_tcp_listener(const char *spec) {
+    char host[256] = "";
+    const char *port = spec;
+    const char *colon = strrchr(spec, ':');
+    if (colon) {
+        snprintf(host, sizeof(host), "%.*s", (int)(colon - spec), spec);
+        port = colon + 1;
+    }
+    
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+        .ai_flags = AI_PASSIVE
+    };
+    struct addrinfo *res;
+    int err = getaddrinfo(host[0] ? host : NULL, port, &hints, &res);
+    if (err != 0) {
+        fprintf(stderr, "TCP listen %s: %s\n", spec, gai_strerror(err));
+        return -1;
+    }
+    
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) < 0 ||
+            listen(fd, LISTEN_BACKLOG) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    
+    if (fd < 0) perror("TCP listen");
+    return fd;
+}
+
 int main(int argc, char **argv) {
     const char *socket_path = DEFAULT_SOCKET_PATH;
     const char *memory_path = "/tmp/objmapper_memory";
@@ -565,15 +3007,64 @@ int main(int argc, char **argv) {
     if (argc > 2) memory_path = argv[2];
     if (argc > 3) persistent_path = argv[3];
     
+    /* I/O model: "epoll" (default) or "threads" */
+    const char *io_mode = getenv("OBJMAPPER_IO_MODE");
+    bool use_threads = io_mode && strcmp(io_mode, "threads") == 0;
+    const char *workers_env = getenv("OBJMAPPER_WORKERS");
+    int num_workers = workers_env ? atoi(workers_env) : 0;
+    const char *latency_env = getenv("OBJMAPPER_LATENCY");
+    g_latency_enabled = !(latency_env && strcmp(latency_env, "0") == 0);
+    const char *interval_env = getenv("OBJMAPPER_STATS_INTERVAL");
+    int stats_interval = interval_env ? atoi(interval_env) : 0;
+    /* Memory tier: "tmpfs" (default, at memory_path) or "memfd" */
+    const char *memory_env = getenv("OBJMAPPER_MEMORY_BACKEND");
+    bool anon_memory = memory_env && strcmp(memory_env, "memfd") == 0;
+    const char *ring_env = getenv("OBJMAPPER_SHM_RING");
+    if (ring_env && atoi(ring_env) == 0) {
+        g_server_hello.capabilities &= ~OBJM_CAP_SHM_RING;
+    }
+    const char *compress_env = getenv("OBJMAPPER_COMPRESS");
+    int compress_level = compress_env ? atoi(compress_env) : 0;
+    const char *numa_env = getenv("OBJMAPPER_NUMA");
+    bool numa = !(numa_env && atoi(numa_env) == 0);
+    
     printf("objmapper server starting\n");
     printf("Socket: %s\n", socket_path);
     
     setup_signals();
+    raise_fd_limit();
     
     /* Initialize backends */
-    if (init_backends(memory_path, persistent_path) < 0) {
+    if (init_backends(memory_path, persistent_path, anon_memory, numa) < 0) {
         return 1;
     }
+    if (compress_level > 0) {
+        if (backend_set_compression(g_backend_mgr, g_persistent_backend_id,
+                                    compress_level) == 0) {
+            printf("Persistent backend compression: level %d\n", compress_level);
+        } else {
+            fprintf(stderr, "Warning: invalid compression level %d\n", compress_level);
+        }
+    }
+    
+    /* Persistent writes are synced in group commit rounds */
+    const char *durable_env = getenv("OBJMAPPER_DURABLE");
+    if (!durable_env || atoi(durable_env) != 0) {
+        const char *commit_env = getenv("OBJMAPPER_COMMIT_US");
+        const char *ckpt_env = getenv("OBJMAPPER_CHECKPOINT_RECORDS");
+        backend_durable_config_t durable_config = {
+            .budget_us = commit_env ? strtoull(commit_env, NULL, 10) : 0,
+            .checkpoint_records = ckpt_env ? strtoull(ckpt_env, NULL, 10) : 0,
+        };
+        if (backend_durable_start(g_backend_mgr, &durable_config) == 0) {
+            printf("Group commit: persistent writes synced in rounds of up to %lluus\n",
+                   (unsigned long long)(durable_config.budget_us ? durable_config.budget_us
+                                        : BACKEND_DURABLE_DEFAULT_BUDGET_US));
+        } else {
+            fprintf(stderr, "Warning: group commit unavailable, persistent writes "
+                    "are not synced\n");
+        }
+    }
     
     /* Create Unix socket */
     int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
@@ -609,21 +3100,104 @@ int main(int argc, char **argv) {
         return 1;
     }
     
+    /* Remote clients: bodies are streamed, FD pass is refused */
+    const char *tcp_env = getenv("OBJMAPPER_TCP_LISTEN");
+    int tcp_fd = -1;
+    if (tcp_env && tcp_env[0] && (tcp_fd = open_tcp_listener(tcp_env)) < 0) {
+        close(listen_fd);
+        unlink(socket_path);
+        cleanup_backends();
+        return 1;
+    }
+    
+    const char *slow_env = getenv("OBJMAPPER_SLOW_WORKERS");
+    slow_pool_start(slow_env ? atoi(slow_env) : DEFAULT_SLOW_WORKERS);
+    
+    const char *aio_env = getenv("OBJMAPPER_AIO");
+    if (!aio_env || atoi(aio_env) != 0) {
+        const char *depth_env = getenv("OBJMAPPER_AIO_DEPTH");
+        backend_aio_config_t aio_config = {
+            .depth = depth_env ? (unsigned)atoi(depth_env) : 0
+        };
+        g_aio = backend_aio_create(g_backend_mgr, &aio_config);
+        if (g_aio) {
+            printf("io_uring engine: cold persistent-tier GETs opened asynchronously\n");
+        } else {
+            printf("io_uring unavailable (%s), cold GETs use the slow-path pool\n",
+                   strerror(errno));
+        }
+    }
+    
+    if (!use_threads && event_workers_start(num_workers) < 0) {
+        g_running = 0;
+        event_workers_stop();
+        backend_aio_destroy(g_aio);
+        slow_pool_stop();
+        close(listen_fd);
+        if (tcp_fd >= 0) close(tcp_fd);
+        unlink(socket_path);
+        cleanup_backends();
+        return 1;
+    }
+    
+    pthread_t stats_thread;
+    bool stats_thread_started = stats_interval > 0 &&
+        pthread_create(&stats_thread, NULL, stats_dump_thread,
+                       (void *)(uintptr_t)stats_interval) == 0;
+    
     printf("Listening on %s\n", socket_path);
+    if (tcp_fd >= 0) printf("Listening on tcp %s\n", tcp_env);
     printf("Press Ctrl+C to stop\n\n");
     
+    struct pollfd listeners[2] = {
+        { .fd = listen_fd, .events = POLLIN },
+        { .fd = tcp_fd, .events = POLLIN },
+    };
+    nfds_t num_listeners = (tcp_fd >= 0) ? 2 : 1;
+    
     /* Accept loop */
     while (g_running) {
-        struct sockaddr_un client_addr;
+        int ready = listen_fd;
+        if (num_listeners > 1) {
+            if (poll(listeners, num_listeners, -1) < 0) {
+                if (errno == EINTR) continue;
+                perror("poll");
+                break;
+            }
+            /* Unix first, TCP on the next pass */
+            ready = (listeners[0].revents & POLLIN) ? listen_fd : tcp_fd;
+        }
+        
+        struct sockaddr_storage client_addr;
         socklen_t client_len = sizeof(client_addr);
         
-        int client_fd = accept(listen_fd, (struct sockaddr *)&client_addr, &client_len);
+        int client_fd = accept4(ready, (struct sockaddr *)&client_addr,
+                                &client_len, SOCK_CLOEXEC);
         if (client_fd < 0) {
             if (errno == EINTR) continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                /* Out of fds: back off instead of spinning */
+                usleep(10000);
+                continue;
+            }
             perror("accept");
             break;
         }
         
+        if (ready == tcp_fd) {
+            /* Replies are small writes the client is waiting for */
+            int one = 1;
+            setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        
+        if (!use_threads) {
+            /* Takes ownership of client_fd */
+            if (event_dispatch_accept(client_fd) < 0) {
+                fprintf(stderr, "Failed to register connection\n");
+            }
+            continue;
+        }
+        
         /* Spawn thread for client */
         client_info_t *info = malloc(sizeof(*info));
         if (!info) {
@@ -650,15 +3224,25 @@ int main(int argc, char **argv) {
     
     printf("\nShutting down...\n");
     
+    g_running = 0;
+    if (stats_thread_started) pthread_join(stats_thread, NULL);
+    event_workers_stop();
+    slow_pool_stop();
+    
     /* Wait for active connections to finish */
     printf("Waiting for %zu active connections to close...\n",
-           g_stats.active_connections);
+           atomic_load(&g_active_connections));
     
-    while (g_stats.active_connections > 0) {
+    while (atomic_load(&g_active_connections) > 0) {
         usleep(100000);  /* 100ms */
     }
     
+    /* No submitters are left; in-flight opens held their connections */
+    backend_aio_destroy(g_aio);
+    g_aio = NULL;
+    
     close(listen_fd);
+    if (tcp_fd >= 0) close(tcp_fd);
     unlink(socket_path);
     cleanup_backends();
     
@@ -0,0 +1,68 @@
+#!/bin/bash
+# Behaviour tests of the server, driven through the client
+
+set -e
+
+TEST_DIR=$(mktemp -d)
+SOCKET="$TEST_DIR/objmapper.sock"
+SERVER_PID=""
+
+# Cleanup on exit
+cleanup() {
+    if [ -n "$SERVER_PID" ]; then
+        kill $SERVER_PID 2>/dev/null || true
+        wait $SERVER_PID 2>/dev/null || true
+    fi
+    rm -rf "$TEST_DIR"
+}
+trap cleanup EXIT
+
+fail() {
+    echo "✗ $1"
+    echo "--- server log ---"
+    cat "$TEST_DIR/server.log"
+    exit 1
+}
+
+mkdir -p "$TEST_DIR/memory" "$TEST_DIR/persistent"
+
+echo "Starting server..."
+OBJMAPPER_WORKERS=1 ./server "$SOCKET" "$TEST_DIR/memory" "$TEST_DIR/persistent" \
+    > "$TEST_DIR/server.log" 2>&1 &
+SERVER_PID=$!
+
+for i in $(seq 50); do
+    [ -S "$SOCKET" ] && break
+    sleep 0.1
+done
+[ -S "$SOCKET" ] || fail "server did not start"
+
+# Multi-GET: a chunked object is not reported as missing
+echo "Test: multi-GET of a chunked object"
+echo "small object" > "$TEST_DIR/small"
+head -c $((9 * 1024 * 1024)) /dev/urandom > "$TEST_DIR/big"
+./client "$SOCKET" -m copy put /t/small "$TEST_DIR/small" > /dev/null
+./client "$SOCKET" -m copy mput /t/big "$TEST_DIR/big" > /dev/null
+
+OUT=$(./client "$SOCKET" mget /t/small /t/big /t/missing || true)
+echo "$OUT" | grep -q "/t/small: 13 bytes" || fail "plain object not returned: $OUT"
+echo "$OUT" | grep -q "/t/big: chunked" || fail "chunked object misreported: $OUT"
+echo "$OUT" | grep -q "/t/missing: not found" || fail "miss misreported: $OUT"
+echo "✓ Chunked objects are told apart from misses"
+
+# Load generator: an open loop holds the offered rate, whatever the latency
+echo "Test: open-loop load generator"
+OUT=$(./benchmark load -S "$SOCKET" -c 2 -r 400 -d 2 -k 200 -s 1024 -M 50 2>/dev/null) ||
+    fail "load run failed: $OUT"
+echo "$OUT" | grep -q "^mode=open_loop .* failed_connections=0" || fail "bad summary: $OUT"
+RATE=$(echo "$OUT" | sed -n 's/.* achieved_rate=\([0-9]*\).*/\1/p' | head -1)
+[ -n "$RATE" ] && [ "$RATE" -ge 300 ] && [ "$RATE" -le 500 ] ||
+    fail "achieved rate ${RATE:-?} is not near the offered 400: $OUT"
+for TIER in memory persistent; do
+    echo "$OUT" | grep -q "^op=get tier=$TIER count=[1-9][0-9]* .* errors=0 " ||
+        fail "no clean GETs on the $TIER tier: $OUT"
+done
+echo "✓ Offered rate held, per-tier results reported"
+
+echo ""
+echo "All server tests passed!"